@@ -0,0 +1,98 @@
+#include "BenchPlatform.hpp"
+#include "hap/AccessoryServer.hpp"
+#include "hap/mock/MockNetwork.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace hap;
+
+namespace {
+
+// The whole IP server on the mock platform: requests go in through the
+// loopback network on the benchmark thread, responses are only counted
+struct ServerFixture {
+    bench::FastCrypto crypto;
+    mock::MockNetwork network;
+    mock::MockStorage storage;
+    mock::MockSystem system;
+    std::unique_ptr<AccessoryServer> server;
+
+    ServerFixture() {
+        network.set_capture(false);
+
+        AccessoryServer::Config config;
+        config.crypto = &crypto;
+        config.network = &network;
+        config.storage = &storage;
+        config.system = &system;
+        config.accessory_id = "11:22:33:44:55:66";
+        config.setup_code = "123-45-678";
+        config.device_name = "Bench Light";
+        server = std::make_unique<AccessoryServer>(config);
+        server->add_accessory(bench::make_light(1));
+        server->start();
+    }
+};
+
+std::string pair_verify_m1() {
+    // kTLVType_State = M1, kTLVType_PublicKey = 32 bytes
+    std::string body = {0x06, 0x01, 0x01, 0x03, 0x20};
+    body.append(32, '\x11');
+    return "POST /pair-verify HTTP/1.1\r\n"
+           "Host: lights.local:8080\r\n"
+           "Content-Type: application/pairing+tlv8\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "\r\n" + body;
+}
+
+} // namespace
+
+// Parse, route and the 470 answer for a request that needs a session
+static void BM_AccessoryServer_UnverifiedRequest(benchmark::State& state) {
+    ServerFixture fixture;
+    const std::string request = "GET /accessories HTTP/1.1\r\nHost: lights.local:8080\r\n\r\n";
+    for (auto _ : state) {
+        fixture.network.deliver(1, request);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * request.size()));
+    state.counters["sent_bytes"] = benchmark::Counter(static_cast<double>(fixture.network.sent_bytes(1)),
+                                                      benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_AccessoryServer_UnverifiedRequest);
+
+// Pair Verify M1 -> M2 through the plaintext pairing path
+static void BM_AccessoryServer_PairVerifyM1(benchmark::State& state) {
+    ServerFixture fixture;
+    const std::string request = pair_verify_m1();
+    for (auto _ : state) {
+        fixture.network.deliver(1, request);
+    }
+    state.counters["sent_bytes"] = benchmark::Counter(static_cast<double>(fixture.network.sent_bytes(1)),
+                                                      benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_AccessoryServer_PairVerifyM1);
+
+// Connection setup and teardown without any request
+static void BM_AccessoryServer_ConnectClose(benchmark::State& state) {
+    ServerFixture fixture;
+    const std::string request = "GET /accessories HTTP/1.1\r\nHost: lights.local:8080\r\n\r\n";
+    uint32_t id = 1;
+    for (auto _ : state) {
+        fixture.network.deliver(id, request);
+        fixture.network.close(id);
+        ++id;
+    }
+}
+BENCHMARK(BM_AccessoryServer_ConnectClose);
+
+// tick() on an idle server, the virtual clock moving 10 ms per call
+static void BM_AccessoryServer_IdleTick(benchmark::State& state) {
+    ServerFixture fixture;
+    for (auto _ : state) {
+        fixture.system.advance(10);
+        fixture.server->tick();
+    }
+}
+BENCHMARK(BM_AccessoryServer_IdleTick);
@@ -0,0 +1,54 @@
+#include "BenchPlatform.hpp"
+#include "hap/core/AttributeDatabase.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace hap;
+using namespace hap::core;
+
+static std::unique_ptr<AttributeDatabase> make_database(size_t accessories) {
+    auto db = std::make_unique<AttributeDatabase>();
+    for (size_t aid = 1; aid <= accessories; ++aid) {
+        db->add_accessory(bench::make_light(aid));
+    }
+    return db;
+}
+
+static void BM_AttributeDatabase_ToJson(benchmark::State& state) {
+    auto db = make_database(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto json = db->to_json_string();
+        benchmark::DoNotOptimize(json.data());
+    }
+}
+BENCHMARK(BM_AttributeDatabase_ToJson)->Arg(1)->Arg(10)->Arg(150);
+
+static void BM_AttributeDatabase_ToCachedJson(benchmark::State& state) {
+    auto db = make_database(static_cast<size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto json = db->to_cached_json_string();
+        benchmark::DoNotOptimize(json.data());
+    }
+}
+BENCHMARK(BM_AttributeDatabase_ToCachedJson)->Arg(1)->Arg(10)->Arg(150);
+
+static void BM_AttributeDatabase_FindCharacteristic(benchmark::State& state) {
+    auto db = make_database(static_cast<size_t>(state.range(0)));
+
+
+    // Every (aid, iid) pair in the database, visited round-robin
+    std::vector<std::pair<uint64_t, uint64_t>> keys;
+    for (const auto& acc : db->accessories()) {
+        for (const auto& svc : acc->services()) {
+            for (const auto& ch : svc->characteristics()) {
+                keys.emplace_back(acc->aid(), ch->iid());
+            }
+        }
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        const auto& [aid, iid] = keys[next];
+        next = next + 1 == keys.size() ? 0 : next + 1;
+        benchmark::DoNotOptimize(db->find_characteristic(aid, iid));
+    }
+}
+BENCHMARK(BM_AttributeDatabase_FindCharacteristic)->Arg(1)->Arg(10)->Arg(150);
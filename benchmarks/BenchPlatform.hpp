@@ -0,0 +1,77 @@
+#pragma once
+
+#include "hap/core/Accessory.hpp"
+#include "hap/platform/CryptoSRP.hpp"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Network, BLE, storage and clock come from the mock platform layer
+// (hap/mock), so runs are free of I/O and timer noise.
+namespace hap::bench {
+
+/**
+ * @brief Near-free stand-in for the platform crypto.
+ *
+ * The "AEAD" XORs with one key byte and writes a constant tag, so timings
+ * show the library's framing, nonce and buffer overhead rather than the
+ * cipher (see examples/linux/bench for the OpenSSL backend).
+ */
+class FastCrypto : public platform::CryptoSRP {
+public:
+    void sha512(std::span<const uint8_t>, std::span<uint8_t, 64> output) override {
+        std::fill(output.begin(), output.end(), 0);
+    }
+    void hkdf_sha512(std::span<const uint8_t>, std::span<const uint8_t>, std::span<const uint8_t>,
+                     std::span<uint8_t> output) override {
+        std::fill(output.begin(), output.end(), 0);
+    }
+    void ed25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 64>) override {}
+    void ed25519_sign(std::span<const uint8_t, 64>, std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
+    bool ed25519_verify(std::span<const uint8_t, 32>, std::span<const uint8_t>,
+                        std::span<const uint8_t, 64>) override { return true; }
+    void x25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 32>) override {}
+    void x25519_shared_secret(std::span<const uint8_t, 32>, std::span<const uint8_t, 32>,
+                              std::span<uint8_t, 32>) override {}
+
+    bool chacha20_poly1305_encrypt_and_tag(std::span<const uint8_t, 32> key, std::span<const uint8_t, 12>,
+                                           std::span<const uint8_t>, std::span<const uint8_t> plaintext,
+                                           std::span<uint8_t> ciphertext, std::span<uint8_t, 16> tag) override {
+        for (size_t i = 0; i < plaintext.size(); ++i) ciphertext[i] = plaintext[i] ^ key[0];
+        std::fill(tag.begin(), tag.end(), 0x5A);
+        return true;
+    }
+    bool chacha20_poly1305_decrypt_and_verify(std::span<const uint8_t, 32> key, std::span<const uint8_t, 12>,
+                                              std::span<const uint8_t>, std::span<const uint8_t> ciphertext,
+                                              std::span<const uint8_t, 16>, std::span<uint8_t> plaintext) override {
+        for (size_t i = 0; i < ciphertext.size(); ++i) plaintext[i] = ciphertext[i] ^ key[0];
+        return true;
+    }
+
+    std::unique_ptr<platform::SRPSession> srp_new_verifier(std::string_view, std::string_view) override { return nullptr; }
+    std::array<uint8_t, 16> srp_get_salt(platform::SRPSession*) override { return {}; }
+    std::vector<uint8_t> srp_get_public_key(platform::SRPSession*) override { return {}; }
+    bool srp_set_client_public_key(platform::SRPSession*, std::span<const uint8_t>) override { return false; }
+    bool srp_verify_client_proof(platform::SRPSession*, std::span<const uint8_t>) override { return false; }
+    std::vector<uint8_t> srp_get_server_proof(platform::SRPSession*) override { return {}; }
+    std::vector<uint8_t> srp_get_session_key(platform::SRPSession*) override { return {}; }
+};
+
+/// Accessory Information plus a Lightbulb with On and Brightness
+inline std::shared_ptr<core::Accessory> make_light(uint64_t aid) {
+    using namespace core;
+    auto acc = std::make_shared<Accessory>(aid);
+    auto info = std::make_shared<Service>(0x3E, "AccessoryInformation");
+    info->add_characteristic(std::make_shared<Characteristic>(0x23, Format::String, std::vector{Permission::PairedRead}));
+    acc->add_service(info);
+
+    auto bulb = std::make_shared<Service>(0x43, "Lightbulb");
+    bulb->add_characteristic(std::make_shared<Characteristic>(0x25, Format::Bool,
+        std::vector{Permission::PairedRead, Permission::PairedWrite, Permission::Notify}));
+    bulb->add_characteristic(std::make_shared<Characteristic>(0x08, Format::Int,
+        std::vector{Permission::PairedRead, Permission::PairedWrite}));
+    acc->add_service(bulb);
+    return acc;
+}
+
+} // namespace hap::bench
@@ -0,0 +1,98 @@
+#include "BenchPlatform.hpp"
+#include "hap/mock/MockBle.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include "hap/core/AttributeDatabase.hpp"
+#include "hap/pairing/PairingStore.hpp"
+#include "hap/transport/BleTransport.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace hap;
+using namespace hap::transport;
+
+namespace {
+
+constexpr const char* kOnCharUUID = "00000025-0000-1000-8000-0026BB765291";
+constexpr const char* kCharIidDescUUID = "DC46F0FE-81D2-4616-B5D9-6ABDD796939A";
+
+// One Lightbulb accessory served over BLE, driven through its GATT callbacks
+struct BleFixture {
+    bench::FastCrypto crypto;
+    mock::MockStorage storage;
+    mock::MockSystem system;
+    mock::MockBle ble;
+    core::AttributeDatabase db;
+    pairing::PairingStore pairings{&storage};
+    std::unique_ptr<PairingEndpoints> endpoints;
+    std::unique_ptr<BleTransport> transport;
+    platform::Ble::CharacteristicDefinition* on_char = nullptr;
+    uint16_t on_iid = 0;
+
+    BleFixture() {
+        db.add_accessory(bench::make_light(1));
+
+        PairingEndpoints::Config pe_config;
+        pe_config.crypto = &crypto;
+        pe_config.pairing_store = &pairings;
+        pe_config.system = &system;
+        pe_config.accessory_id = "11:22:33:44:55:66";
+        pe_config.setup_code = "123-45-678";
+        endpoints = std::make_unique<PairingEndpoints>(pe_config);
+
+        BleTransport::Config config;
+        config.ble = &ble;
+        config.crypto = &crypto;
+        config.database = &db;
+        config.pairing_endpoints = endpoints.get();
+        config.system = &system;
+        config.storage = &storage;
+        config.pairing_store = &pairings;
+        config.accessory_id = "11:22:33:44:55:66";
+        config.device_name = "Bench Light";
+        transport = std::make_unique<BleTransport>(config);
+        transport->start();
+
+        on_char = ble.find_characteristic(kOnCharUUID);
+        auto* iid_desc = ble.find_descriptor(kOnCharUUID, kCharIidDescUUID);
+        if (iid_desc && iid_desc->on_read) {
+            auto iid = iid_desc->on_read(1);
+            on_iid = static_cast<uint16_t>(iid[0] | (iid[1] << 8));
+        }
+    }
+
+    /// One request PDU in, its response PDU out
+    size_t transact(uint8_t opcode, uint8_t tid) {
+        uint8_t pdu[] = {0x00, opcode, tid, static_cast<uint8_t>(on_iid), static_cast<uint8_t>(on_iid >> 8)};
+        on_char->on_write(1, pdu, true);
+        return on_char->on_read(1).size();
+    }
+};
+
+} // namespace
+
+static void BM_BleTransport_SignatureRead(benchmark::State& state) {
+    BleFixture fixture;
+    if (!fixture.on_char) {
+        state.SkipWithError("On characteristic not registered");
+        return;
+    }
+    uint8_t tid = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.transact(0x01, ++tid));
+    }
+}
+BENCHMARK(BM_BleTransport_SignatureRead);
+
+// Unsecured, so this measures the request path up to the authorization check
+static void BM_BleTransport_CharacteristicRead(benchmark::State& state) {
+    BleFixture fixture;
+    if (!fixture.on_char) {
+        state.SkipWithError("On characteristic not registered");
+        return;
+    }
+    uint8_t tid = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.transact(0x03, ++tid));
+    }
+}
+BENCHMARK(BM_BleTransport_CharacteristicRead);
@@ -0,0 +1,84 @@
+#include "hap/transport/ConnectionContext.hpp"
+#include "hap/transport/HTTP.hpp"
+#include "hap/transport/Router.hpp"
+#include <benchmark/benchmark.h>
+#include <string>
+
+using namespace hap::transport;
+
+static const std::string kPutRequest =
+    "PUT /characteristics HTTP/1.1\r\n"
+    "Host: lights.local:8080\r\n"
+    "Content-Type: application/hap+json\r\n"
+    "Content-Length: 58\r\n"
+    "\r\n"
+    "{\"characteristics\":[{\"aid\":1,\"iid\":10,\"value\":true,\"ev\":1}]}";
+
+static void BM_HTTPParser_Feed(benchmark::State& state) {
+    std::span<const uint8_t> bytes(reinterpret_cast<const uint8_t*>(kPutRequest.data()), kPutRequest.size());
+    HTTPParser parser;
+    for (auto _ : state) {
+        bool complete = parser.feed(bytes);
+        benchmark::DoNotOptimize(complete);
+        auto request = parser.take_request();
+        benchmark::DoNotOptimize(request);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_HTTPParser_Feed);
+
+// Same request split into TCP-sized pieces
+static void BM_HTTPParser_FeedFragmented(benchmark::State& state) {
+    std::span<const uint8_t> bytes(reinterpret_cast<const uint8_t*>(kPutRequest.data()), kPutRequest.size());
+    const size_t piece = static_cast<size_t>(state.range(0));
+    HTTPParser parser;
+    for (auto _ : state) {
+        for (size_t offset = 0; offset < bytes.size(); offset += piece) {
+            if (parser.feed(bytes.subspan(offset, std::min(piece, bytes.size() - offset)))) {
+                auto request = parser.take_request();
+                benchmark::DoNotOptimize(request);
+            }
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_HTTPParser_FeedFragmented)->Arg(16)->Arg(64);
+
+static void BM_HTTPBuilder_Build(benchmark::State& state) {
+    Response response{Status::OK};
+    response.set_header("Content-Type", "application/hap+json");
+    response.set_body(std::string(static_cast<size_t>(state.range(0)), 'x'));
+    for (auto _ : state) {
+        auto bytes = HTTPBuilder::build(response);
+        benchmark::DoNotOptimize(bytes.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * state.range(0)));
+}
+BENCHMARK(BM_HTTPBuilder_Build)->Arg(64)->Arg(4096);
+
+namespace {
+struct BenchEndpoints {
+    Response handle(const Request&, ConnectionContext&) { return Response{Status::NoContent}; }
+};
+} // namespace
+
+// Lookup plus handler call; Arg(0) binds the handler statically, Arg(1) through std::function
+static void BM_Router_Dispatch(benchmark::State& state) {
+    Router router;
+    BenchEndpoints endpoints;
+    if (state.range(0) == 0) {
+        router.add_route<&BenchEndpoints::handle>(Method::GET, "/characteristics", &endpoints);
+    } else {
+        router.add_route(Method::GET, "/characteristics", [&endpoints](const Request& req, ConnectionContext& ctx) {
+            return endpoints.handle(req, ctx);
+        });
+    }
+    Request request;
+    request.path = "/characteristics";
+    ConnectionContext ctx(nullptr, nullptr, 1);
+    for (auto _ : state) {
+        auto response = router.dispatch(request, ctx);
+        benchmark::DoNotOptimize(response);
+    }
+}
+BENCHMARK(BM_Router_Dispatch)->Arg(0)->Arg(1);
@@ -0,0 +1,32 @@
+#include "hap/core/TLV8.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace hap::core;
+
+// Shaped like Pair Setup M3: state, a 384-byte public key (fragmented) and a proof
+static std::vector<TLV> pairing_message() {
+    return {
+        TLV(0x06, std::vector<uint8_t>{0x03}),
+        TLV(0x03, std::vector<uint8_t>(384, 0xA5)),
+        TLV(0x04, std::vector<uint8_t>(64, 0x5A)),
+    };
+}
+
+static void BM_TLV8_Encode(benchmark::State& state) {
+    auto tlvs = pairing_message();
+    for (auto _ : state) {
+        auto bytes = TLV8::encode(tlvs);
+        benchmark::DoNotOptimize(bytes.data());
+    }
+}
+BENCHMARK(BM_TLV8_Encode);
+
+static void BM_TLV8_Parse(benchmark::State& state) {
+    auto bytes = TLV8::encode(pairing_message());
+    for (auto _ : state) {
+        auto tlvs = TLV8::parse(bytes);
+        benchmark::DoNotOptimize(tlvs.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+BENCHMARK(BM_TLV8_Parse);
@@ -0,0 +1,40 @@
+#include "hap/common/TaskScheduler.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace hap;
+using namespace hap::common;
+
+// Many periodic tasks with spread-out intervals; each tick advances 10 ms,
+// so only a few are due per call
+static void BM_TaskScheduler_Tick(benchmark::State& state) {
+    mock::MockSystem system;
+    TaskScheduler scheduler(&system);
+    const auto tasks = static_cast<uint32_t>(state.range(0));
+    uint64_t runs = 0;
+    for (uint32_t i = 0; i < tasks; ++i) {
+        scheduler.schedule_periodic(100 + (i * 37) % 5000, [&runs] { ++runs; });
+    }
+    
+    uint64_t now = 0;
+    for (auto _ : state) {
+        now += 10;
+        scheduler.tick(now);
+    }
+    benchmark::DoNotOptimize(runs);
+    state.counters["runs/tick"] = benchmark::Counter(static_cast<double>(runs) / static_cast<double>(state.iterations()));
+}
+BENCHMARK(BM_TaskScheduler_Tick)->Arg(10)->Arg(100)->Arg(1000);
+
+// tick() with nothing due, the common case on an idle accessory
+static void BM_TaskScheduler_IdleTick(benchmark::State& state) {
+    mock::MockSystem system;
+    TaskScheduler scheduler(&system);
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        scheduler.schedule_periodic(1000000, [] {});
+    }
+    for (auto _ : state) {
+        scheduler.tick(1);
+    }
+}
+BENCHMARK(BM_TaskScheduler_IdleTick)->Arg(1000);
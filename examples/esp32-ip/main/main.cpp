@@ -74,6 +74,14 @@ extern "C" void app_main() {
   config.setup_code = "111-22-333";
   config.category_id = hap::core::AccessoryCategory::DoorLock;
 
+#if !CONFIG_FREERTOS_UNICORE
+  // Wi-Fi and lwIP stay on core 0 and only queue received bytes; pairing
+  // and frame encryption run on a worker pinned to core 1
+  config.worker_threads = 1;
+  config.worker_core = 1;
+  config.worker_stack_bytes = 8192;
+#endif
+
   static hap::AccessoryServer server(std::move(config));
 
   auto accessory = std::make_shared<hap::core::Accessory>(1);
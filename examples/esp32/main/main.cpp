@@ -87,6 +87,11 @@ extern "C" void app_main() {
 
     ESP_LOGI(TAG, "Starting Server...");
     server.start();
+
+    // No core split for BLE: a controller reads right after its write is
+    // acknowledged, so most transactions (pair-setup, pair-verify, session
+    // encryption) run inside the GATT read on the NimBLE host task; tick()
+    // only drains what no read has asked for yet, plus timers and events
     while (true) {
         vTaskDelay(pdMS_TO_TICKS(100));
         server.tick();
@@ -0,0 +1,104 @@
+// ChaCha20-Poly1305 throughput for HAP frames: the previous per-call EVP
+// setup against LinuxCrypto's cached cipher/context, single-frame and
+// batched through SecureSession.
+//
+//   ./hap_aead_bench [payload_bytes] [iterations]
+
+#include "LinuxCrypto.hpp"
+#include "hap/transport/SecureSession.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// The implementation LinuxCrypto used before: new context and implicit fetch per frame
+static bool reference_encrypt(std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+                              std::span<const uint8_t> aad, std::span<const uint8_t> plaintext,
+                              std::span<uint8_t> ciphertext, std::span<uint8_t, 16> tag) {
+    EVP_CIPHER_CTX* ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) return false;
+    int len;
+    EVP_EncryptInit_ex(ctx, EVP_chacha20_poly1305(), nullptr, key.data(), nonce.data());
+    if (!aad.empty()) EVP_EncryptUpdate(ctx, nullptr, &len, aad.data(), aad.size());
+    EVP_EncryptUpdate(ctx, ciphertext.data(), &len, plaintext.data(), plaintext.size());
+    EVP_EncryptFinal_ex(ctx, ciphertext.data() + len, &len);
+    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, tag.data());
+    EVP_CIPHER_CTX_free(ctx);
+    return true;
+}
+
+static void report(const char* name, size_t bytes, Clock::duration elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    std::printf("%-34s %9.1f MB/s  %8.2f us/frame\n", name, bytes / seconds / 1e6,
+                seconds * 1e6 / (bytes / static_cast<double>(hap::transport::SecureSession::MAX_FRAME_PAYLOAD)));
+}
+
+static Clock::duration time_it(size_t iterations, const std::function<void()>& body) {
+    auto start = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) body();
+    return Clock::now() - start;
+}
+
+int main(int argc, char** argv) {
+    size_t payload = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64 * 1024;
+    size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000;
+    constexpr size_t kFrame = hap::transport::SecureSession::MAX_FRAME_PAYLOAD;
+
+    linux_pal::LinuxCrypto crypto;
+    std::array<uint8_t, 32> key{};
+    std::array<uint8_t, 12> nonce{};
+    std::array<uint8_t, 2> aad{0x00, 0x04};
+    std::array<uint8_t, 16> tag{};
+    std::vector<uint8_t> plaintext(payload, 'x');
+    std::vector<uint8_t> ciphertext(payload);
+    size_t total = payload * iterations;
+
+    std::printf("%zu-byte payload, %zu iterations, %s\n\n", payload, iterations, OpenSSL_version(OPENSSL_VERSION));
+
+    report("reference (ctx per frame)", total, time_it(iterations, [&]() {
+        for (size_t off = 0; off < payload; off += kFrame) {
+            size_t n = std::min(kFrame, payload - off);
+            reference_encrypt(key, nonce, aad, std::span(plaintext).subspan(off, n),
+                              std::span(ciphertext).subspan(off, n), tag);
+        }
+    }));
+
+    report("LinuxCrypto encrypt_and_tag", total, time_it(iterations, [&]() {
+        for (size_t off = 0; off < payload; off += kFrame) {
+            size_t n = std::min(kFrame, payload - off);
+            crypto.chacha20_poly1305_encrypt_and_tag(key, nonce, aad, std::span(plaintext).subspan(off, n),
+                                                     std::span(ciphertext).subspan(off, n), tag);
+        }
+    }));
+
+    hap::transport::SecureSession accessory(&crypto, key, key);
+    hap::transport::SecureSession controller(&crypto, key, key);
+    std::vector<uint8_t> sealed;
+    std::vector<uint8_t> opened;
+    sealed.reserve(hap::transport::SecureSession::sealed_size(payload));
+    opened.reserve(payload);
+
+    report("SecureSession encrypt (batched)", total, time_it(iterations, [&]() {
+        sealed.clear();
+        accessory.encrypt_frames_into(plaintext, sealed);
+    }));
+
+    accessory.reset();
+    bool ok = true;
+    auto decrypt_time = time_it(iterations, [&]() {
+        sealed.clear();
+        accessory.encrypt_frames_into(plaintext, sealed);
+        opened.clear();
+        ok = controller.decrypt_all_frames_into(sealed, opened) == payload && ok;
+    });
+    report("SecureSession encrypt+decrypt", total, decrypt_time);
+
+    if (!ok) {
+        std::printf("round trip FAILED\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,552 @@
+// Load test: N simulated controllers against an in-process AccessoryServer
+// on LinuxNetwork, over real loopback sockets.
+//
+// The accessory keys and controllers are pre-provisioned in the pairing
+// store (HAP allows 16 pairings, so larger runs share identities); each
+// controller runs a full Pair Verify, checking the accessory's signature,
+// subscribe to Brightness and then issue GET/PUT /characteristics at the
+// given per-controller rates while a driver thread changes Brightness at the
+// event rate. Reports throughput, p50/p99 request latency, event counts and
+// process CPU (server and controllers together).
+//
+//   ./hap_load_test [--controllers N] [--seconds S] [--get-rate HZ]
+//                   [--put-rate HZ] [--event-rate HZ] [--workers W] [--port P]
+
+#include "LinuxCrypto.hpp"
+#include "LinuxNetwork.hpp"
+#include "LinuxStorage.hpp"
+#include "LinuxSystem.hpp"
+#include "hap/AccessoryServer.hpp"
+#include "hap/core/Accessory.hpp"
+#include "hap/core/TLV8.hpp"
+#include "hap/pairing/PairingStore.hpp"
+#include "hap/pairing/TLVTypes.hpp"
+#include "hap/transport/SecureSession.hpp"
+#include "hap/types/ServiceTypes.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using hap::pairing::PairingState;
+using hap::pairing::TLVType;
+
+namespace {
+
+constexpr std::string_view kAccessoryId = "12:34:56:78:9A:BC";
+
+struct Options {
+    size_t controllers = 8;
+    double seconds = 10;
+    double get_rate = 20;    // Per controller
+    double put_rate = 5;     // Per controller
+    double event_rate = 10;  // Brightness changes on the accessory side
+    size_t workers = 2;
+    uint16_t port = 18080;
+};
+
+struct Identity {
+    std::string id;
+    std::array<uint8_t, 32> ltpk{};
+    std::array<uint8_t, 64> ltsk{};
+};
+
+struct Results {
+    std::mutex mutex;
+    std::vector<uint32_t> verify_us;
+    std::vector<uint32_t> get_us;
+    std::vector<uint32_t> put_us;
+    uint64_t events = 0;
+    uint64_t failures = 0;
+};
+
+template <size_t N>
+std::span<const uint8_t> label(const char (&text)[N]) {
+    return std::span(reinterpret_cast<const uint8_t*>(text), N - 1);
+}
+
+std::array<uint8_t, 12> nonce_of(const char (&tag)[9]) {
+    std::array<uint8_t, 12> nonce{};
+    std::copy_n(tag, 8, nonce.begin() + 4);
+    return nonce;
+}
+
+uint32_t elapsed_us(Clock::time_point start) {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+}
+
+/**
+ * @brief One controller connection: plaintext until Pair Verify, then HAP frames.
+ */
+class Controller {
+public:
+    struct Message {
+        bool event = false;
+        int status = 0;
+        std::string body;
+    };
+
+    Controller(uint16_t port, const Identity& identity, const std::array<uint8_t, 32>& accessory_ltpk)
+        : identity_(identity), accessory_ltpk_(accessory_ltpk) {
+        fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd_);
+            fd_ = -1;
+            return;
+        }
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    ~Controller() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool connected() const { return fd_ >= 0; }
+    uint64_t events() const { return events_; }
+
+    bool pair_verify() {
+        std::array<uint8_t, 32> public_key, private_key;
+        crypto_.x25519_generate_keypair(public_key, private_key);
+
+        std::vector<hap::core::TLV> m1;
+        m1.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M1));
+        m1.emplace_back(static_cast<uint8_t>(TLVType::PublicKey), std::span<const uint8_t>(public_key));
+        auto m2 = pairing_request(hap::core::TLV8::encode(m1));
+        if (!m2) return false;
+
+        hap::core::TLV8View m2_tlvs(*m2);
+        auto accessory_key = m2_tlvs.find(static_cast<uint8_t>(TLVType::PublicKey));
+        auto m2_encrypted = m2_tlvs.find(static_cast<uint8_t>(TLVType::EncryptedData));
+        if (!accessory_key || accessory_key->size() != 32 || !m2_encrypted || m2_encrypted->size() < 16) {
+            return false;
+        }
+        std::array<uint8_t, 32> accessory_public;
+        std::copy(accessory_key->begin(), accessory_key->end(), accessory_public.begin());
+
+        std::array<uint8_t, 32> shared;
+        crypto_.x25519_shared_secret(private_key, accessory_public, shared);
+        std::array<uint8_t, 32> verify_key;
+        crypto_.hkdf_sha512(shared, label("Pair-Verify-Encrypt-Salt"), label("Pair-Verify-Encrypt-Info"), verify_key);
+
+        size_t sub_size = m2_encrypted->size() - 16;
+        std::vector<uint8_t> sub(sub_size);
+        if (!crypto_.chacha20_poly1305_decrypt_and_verify(
+                verify_key, nonce_of("PV-Msg02"), {}, m2_encrypted->first(sub_size),
+                m2_encrypted->subspan(sub_size).first<16>(), sub)) {
+            return false;
+        }
+        hap::core::TLV8View m2_sub(sub);
+        auto accessory_signature = m2_sub.find(static_cast<uint8_t>(TLVType::Signature));
+        if (!accessory_signature || accessory_signature->size() != 64) return false;
+        std::vector<uint8_t> accessory_info(accessory_public.begin(), accessory_public.end());
+        accessory_info.insert(accessory_info.end(), kAccessoryId.begin(), kAccessoryId.end());
+        accessory_info.insert(accessory_info.end(), public_key.begin(), public_key.end());
+        if (!crypto_.ed25519_verify(accessory_ltpk_, accessory_info, accessory_signature->first<64>())) {
+            return false;
+        }
+
+        std::vector<uint8_t> info(public_key.begin(), public_key.end());
+        info.insert(info.end(), identity_.id.begin(), identity_.id.end());
+        info.insert(info.end(), accessory_public.begin(), accessory_public.end());
+        std::array<uint8_t, 64> signature;
+        crypto_.ed25519_sign(identity_.ltsk, info, signature);
+
+        std::vector<hap::core::TLV> m3_sub;
+        m3_sub.emplace_back(static_cast<uint8_t>(TLVType::Identifier), identity_.id);
+        m3_sub.emplace_back(static_cast<uint8_t>(TLVType::Signature), std::span<const uint8_t>(signature));
+        auto plain = hap::core::TLV8::encode(m3_sub);
+        std::vector<uint8_t> encrypted(plain.size() + 16);
+        std::array<uint8_t, 16> tag;
+        crypto_.chacha20_poly1305_encrypt_and_tag(verify_key, nonce_of("PV-Msg03"), {}, plain,
+                                                  std::span(encrypted).first(plain.size()), tag);
+        std::copy(tag.begin(), tag.end(), encrypted.begin() + plain.size());
+
+        std::vector<hap::core::TLV> m3;
+        m3.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M3));
+        m3.emplace_back(static_cast<uint8_t>(TLVType::EncryptedData), encrypted);
+        auto m4 = pairing_request(hap::core::TLV8::encode(m3));
+        if (!m4) return false;
+        hap::core::TLV8View m4_tlvs(*m4);
+        if (m4_tlvs.find(static_cast<uint8_t>(TLVType::Error))) return false;
+
+        // Controller writes with the accessory's read key and reads with its write key
+        std::array<uint8_t, 32> read_key, write_key;
+        crypto_.hkdf_sha512(shared, label("Control-Salt"), label("Control-Read-Encryption-Key"), read_key);
+        crypto_.hkdf_sha512(shared, label("Control-Salt"), label("Control-Write-Encryption-Key"), write_key);
+        session_ = std::make_unique<hap::transport::SecureSession>(&crypto_, write_key, read_key);
+        return true;
+    }
+
+    /**
+     * @brief Send a request and wait for its response; events seen meanwhile are counted.
+     */
+    std::optional<Message> request(std::string_view method, std::string_view path, std::string_view body = {}) {
+        std::string head = std::string(method) + " " + std::string(path) + " HTTP/1.1\r\nHost: load-test\r\n";
+        if (!body.empty()) {
+            head += "Content-Type: application/hap+json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        head += "\r\n";
+        head += body;
+        if (!send_all(std::span(reinterpret_cast<const uint8_t*>(head.data()), head.size()))) {
+            return std::nullopt;
+        }
+        while (true) {
+            auto message = next_message(-1);
+            if (!message) return std::nullopt;
+            if (!message->event) return message;
+        }
+    }
+
+    /**
+     * @brief Count events until the deadline.
+     */
+    bool pump_until(Clock::time_point deadline) {
+        while (true) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+            if (remaining <= 0) return true;
+            auto message = next_message(static_cast<int>(remaining));
+            if (!message && !timed_out_) return false;
+        }
+    }
+
+private:
+    std::optional<std::vector<uint8_t>> pairing_request(const std::vector<uint8_t>& tlv) {
+        std::string head = "POST /pair-verify HTTP/1.1\r\nHost: load-test\r\n"
+                           "Content-Type: application/pairing+tlv8\r\nContent-Length: " +
+                           std::to_string(tlv.size()) + "\r\n\r\n";
+        std::vector<uint8_t> data(head.begin(), head.end());
+        data.insert(data.end(), tlv.begin(), tlv.end());
+        if (!send_all(data)) return std::nullopt;
+        auto message = next_message(-1);
+        if (!message || message->status != 200) return std::nullopt;
+        return std::vector<uint8_t>(message->body.begin(), message->body.end());
+    }
+
+    bool send_all(std::span<const uint8_t> data) {
+        std::vector<uint8_t> sealed;
+        if (session_) {
+            if (!session_->encrypt_frames_into(data, sealed)) return false;
+            data = sealed;
+        }
+        while (!data.empty()) {
+            ssize_t sent = send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+            if (sent <= 0) return false;
+            data = data.subspan(static_cast<size_t>(sent));
+        }
+        return true;
+    }
+
+    // Next complete response or event; nullopt on error, or on timeout with timed_out_ set
+    std::optional<Message> next_message(int timeout_ms) {
+        timed_out_ = false;
+        while (true) {
+            if (auto message = take_message()) {
+                if (message->event) ++events_;
+                return message;
+            }
+            pollfd pfd{fd_, POLLIN, 0};
+            int ready = poll(&pfd, 1, timeout_ms);
+            if (ready == 0) {
+                timed_out_ = true;
+                return std::nullopt;
+            }
+            uint8_t buffer[4096];
+            ssize_t received = ready > 0 ? recv(fd_, buffer, sizeof(buffer), 0) : -1;
+            if (received <= 0) return std::nullopt;
+            std::span<const uint8_t> data(buffer, static_cast<size_t>(received));
+            if (session_) {
+                if (!session_->decrypt_all_frames_into(data, plain_)) return std::nullopt;
+            } else {
+                plain_.insert(plain_.end(), data.begin(), data.end());
+            }
+        }
+    }
+
+    std::optional<Message> take_message() {
+        std::string_view text(reinterpret_cast<const char*>(plain_.data()), plain_.size());
+        size_t head_end = text.find("\r\n\r\n");
+        if (head_end == std::string_view::npos) return std::nullopt;
+        std::string_view head = text.substr(0, head_end);
+
+        size_t length = 0;
+        if (size_t pos = head.find("Content-Length: "); pos != std::string_view::npos) {
+            length = std::strtoul(std::string(head.substr(pos + 16, 10)).c_str(), nullptr, 10);
+        }
+        size_t total = head_end + 4 + length;
+        if (plain_.size() < total) return std::nullopt;
+
+        Message message;
+        message.event = head.starts_with("EVENT/1.0");
+        if (!message.event && head.size() > 12) {
+            message.status = std::atoi(std::string(head.substr(9, 3)).c_str());
+        }
+        message.body.assign(text.substr(head_end + 4, length));
+        plain_.erase(plain_.begin(), plain_.begin() + static_cast<std::ptrdiff_t>(total));
+        return message;
+    }
+
+    const Identity& identity_;
+    const std::array<uint8_t, 32>& accessory_ltpk_;
+    linux_pal::LinuxCrypto crypto_;  // Per controller: LinuxCrypto reuses cipher contexts
+    int fd_ = -1;
+    std::unique_ptr<hap::transport::SecureSession> session_;
+    std::vector<uint8_t> plain_;
+    uint64_t events_ = 0;
+    bool timed_out_ = false;
+};
+
+void run_controller(const Options& options, const Identity& identity, const std::array<uint8_t, 32>& accessory_ltpk,
+                    uint64_t brightness_iid, Clock::time_point end, Results& results) {
+    std::vector<uint32_t> verify_us, get_us, put_us;
+    uint64_t failures = 0;
+    Controller controller(options.port, identity, accessory_ltpk);
+
+    auto start = Clock::now();
+    if (!controller.connected() || !controller.pair_verify()) {
+        std::lock_guard lock(results.mutex);
+        ++results.failures;
+        return;
+    }
+    verify_us.push_back(elapsed_us(start));
+
+    std::string id = "1." + std::to_string(brightness_iid);
+    std::string subscribe = R"({"characteristics":[{"aid":1,"iid":)" + std::to_string(brightness_iid) + R"(,"ev":true}]})";
+    if (!controller.request("PUT", "/characteristics", subscribe)) ++failures;
+
+    // Both kinds of request on their own fixed schedule, interleaved by due time
+    using Duration = Clock::duration;
+    auto period = [](double rate) {
+        return rate > 0 ? std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1.0 / rate))
+                        : Duration::max();
+    };
+    Duration get_period = period(options.get_rate);
+    Duration put_period = period(options.put_rate);
+    auto next_get = get_period == Duration::max() ? Clock::time_point::max() : Clock::now() + get_period;
+    auto next_put = put_period == Duration::max() ? Clock::time_point::max() : Clock::now() + put_period;
+    int value = 0;
+
+    while (Clock::now() < end) {
+        auto due = std::min({next_get, next_put, end});
+        if (!controller.pump_until(due)) {
+            ++failures;
+            break;
+        }
+        if (due == end) break;
+
+        auto sent = Clock::now();
+        bool is_get = next_get <= next_put;
+        std::optional<Controller::Message> response;
+        if (is_get) {
+            response = controller.request("GET", "/characteristics?id=" + id);
+            next_get += get_period;
+        } else {
+            value = (value + 7) % 101;
+            std::string body = R"({"characteristics":[{"aid":1,"iid":)" + std::to_string(brightness_iid) +
+                               R"(,"value":)" + std::to_string(value) + "}]}";
+            response = controller.request("PUT", "/characteristics", body);
+            next_put += put_period;
+        }
+        if (!response) {
+            ++failures;
+            break;
+        }
+        if (response->status >= 300) ++failures;
+        (is_get ? get_us : put_us).push_back(elapsed_us(sent));
+    }
+
+    std::lock_guard lock(results.mutex);
+    results.verify_us.insert(results.verify_us.end(), verify_us.begin(), verify_us.end());
+    results.get_us.insert(results.get_us.end(), get_us.begin(), get_us.end());
+    results.put_us.insert(results.put_us.end(), put_us.begin(), put_us.end());
+    results.events += controller.events();
+    results.failures += failures;
+}
+
+uint32_t percentile(std::vector<uint32_t>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(rank), samples.end());
+    return samples[rank];
+}
+
+void report(const char* name, std::vector<uint32_t>& samples, double seconds) {
+    std::printf("%-12s %8zu  %9.1f/s  p50 %7u us  p99 %7u us\n", name, samples.size(),
+                static_cast<double>(samples.size()) / seconds, percentile(samples, 50), percentile(samples, 99));
+}
+
+double cpu_seconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto seconds = [](const timeval& tv) { return static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec) / 1e6; };
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view flag = argv[i];
+        double value = std::strtod(argv[i + 1], nullptr);
+        if (flag == "--controllers") options.controllers = static_cast<size_t>(value);
+        else if (flag == "--seconds") options.seconds = value;
+        else if (flag == "--get-rate") options.get_rate = value;
+        else if (flag == "--put-rate") options.put_rate = value;
+        else if (flag == "--event-rate") options.event_rate = value;
+        else if (flag == "--workers") options.workers = static_cast<size_t>(value);
+        else if (flag == "--port") options.port = static_cast<uint16_t>(value);
+        else std::fprintf(stderr, "Ignoring unknown option %s\n", argv[i]);
+    }
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options = parse_options(argc, argv);
+
+    linux_pal::LinuxSystem system;
+    system.set_log_level(hap::platform::System::LogLevel::Warning);
+    linux_pal::LinuxCrypto crypto;
+    linux_pal::LinuxNetwork network;
+    auto storage_path = std::filesystem::temp_directory_path() / "hap_load_test.log";
+    std::filesystem::remove(storage_path);
+    linux_pal::LinuxStorage::Options storage_options;
+    storage_options.fsync = linux_pal::LinuxStorage::FsyncPolicy::Never;
+    linux_pal::LinuxStorage storage(storage_path.string(), storage_options);
+
+    // Pre-provisioned controllers; more connections than pairings share identities
+    std::vector<Identity> identities(std::min(options.controllers, hap::pairing::PairingStore::kMaxPairings));
+    std::array<uint8_t, 32> accessory_ltpk;
+    {
+        hap::pairing::PairingStore pairings(&storage);
+        accessory_ltpk = pairings.ensure_long_term_keys(crypto).ltpk;
+        for (size_t i = 0; i < identities.size(); ++i) {
+            char id[37];
+            std::snprintf(id, sizeof(id), "00000000-0000-4000-8000-%012zx", i + 1);
+            identities[i].id = id;
+            crypto.ed25519_generate_keypair(identities[i].ltpk, identities[i].ltsk);
+            pairings.add(identities[i].id, identities[i].ltpk);
+        }
+    }
+
+    hap::AccessoryServer::Config config;
+    config.crypto = &crypto;
+    config.network = &network;
+    config.storage = &storage;
+    config.system = &system;
+    config.accessory_id = std::string(kAccessoryId);
+    config.setup_code = "111-22-333";
+    config.device_name = "Load Test";
+    config.port = options.port;
+    config.max_connections = options.controllers;
+    config.worker_threads = options.workers;
+    config.enable_metrics = true;
+
+    auto server = std::make_unique<hap::AccessoryServer>(config);
+    auto accessory = std::make_shared<hap::core::Accessory>(1);
+    accessory->add_service(hap::service::AccessoryInformationBuilder()
+        .name("Load Test").manufacturer("Example Corp").model("Load-Test")
+        .serial_number("00000001").firmware_revision("1.0.0").build());
+    accessory->add_service(hap::service::HAPProtocolInformationBuilder().build());
+    hap::service::LightBulbBuilder bulb;
+    bulb.with_brightness();
+    accessory->add_service(bulb.build());
+    auto brightness = bulb.brightness_characteristic();
+    server->add_accessory(accessory);
+
+    // The reactor outlives the server, so its timer hooks go through a guarded pointer
+    std::mutex server_mutex;
+    hap::AccessoryServer* live_server = server.get();
+    network.set_timer_hooks(
+        [&]() -> std::optional<uint64_t> {
+            std::lock_guard lock(server_mutex);
+            return live_server ? live_server->next_deadline_ms() : std::nullopt;
+        },
+        [&]() {
+            std::lock_guard lock(server_mutex);
+            if (live_server) live_server->tick();
+        });
+    server->start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::printf("%zu controllers (%zu identities), %.0f s, GET %.1f/s, PUT %.1f/s per controller, "
+                "events %.1f/s, %zu workers\n\n",
+                options.controllers, identities.size(), options.seconds, options.get_rate, options.put_rate,
+                options.event_rate, options.workers);
+
+    Results results;
+    double cpu_before = cpu_seconds();
+    auto begin = Clock::now();
+    auto end = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+
+    std::atomic<uint64_t> changes{0};
+    std::thread driver([&]() {
+        if (options.event_rate <= 0) return;
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.event_rate));
+        int value = 0;
+        for (auto next = Clock::now() + period; next < end; next += period) {
+            std::this_thread::sleep_until(next);
+            value = (value + 13) % 101;
+            brightness->set_value(hap::core::Value(value));
+            ++changes;
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.controllers; ++i) {
+        threads.emplace_back(run_controller, std::cref(options), std::cref(identities[i % identities.size()]),
+                             std::cref(accessory_ltpk), brightness->iid(), end, std::ref(results));
+    }
+    for (auto& thread : threads) thread.join();
+    driver.join();
+
+    double wall = std::chrono::duration<double>(Clock::now() - begin).count();
+    double cpu = cpu_seconds() - cpu_before;
+
+    report("pair-verify", results.verify_us, wall);
+    report("GET", results.get_us, wall);
+    report("PUT", results.put_us, wall);
+    std::printf("%-12s %8llu  %9.1f/s  (%llu changes driven)\n", "events", static_cast<unsigned long long>(results.events),
+                static_cast<double>(results.events) / wall, static_cast<unsigned long long>(changes.load()));
+    std::printf("%-12s %8llu\n", "failures", static_cast<unsigned long long>(results.failures));
+    std::printf("CPU %.2f s over %.2f s wall (%.0f%% of one core, controllers included)\n", cpu, wall, 100.0 * cpu / wall);
+
+    auto metrics = server->metrics();
+    std::printf("\nServer side:\n");
+    for (auto metric : {hap::common::Metric::PairVerify, hap::common::Metric::Decrypt,
+                        hap::common::Metric::Encrypt, hap::common::Metric::EventFanout}) {
+        const auto& stats = metrics[metric];
+        std::printf("  %-16s %8llu  p50 %7llu us  p99 %7llu us\n", hap::common::metric_name(metric),
+                    static_cast<unsigned long long>(stats.count),
+                    static_cast<unsigned long long>(stats.percentile_us(50)),
+                    static_cast<unsigned long long>(stats.percentile_us(99)));
+    }
+
+    server->stop();
+    {
+        std::lock_guard lock(server_mutex);
+        live_server = nullptr;
+    }
+    server.reset();
+    std::filesystem::remove(storage_path);
+    return results.failures == 0 ? 0 : 1;
+}
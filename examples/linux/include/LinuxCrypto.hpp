@@ -72,11 +72,42 @@ public:
         std::span<uint8_t> plaintext
     ) override;
     
+    bool chacha20_poly1305_encrypt_in_place(
+        std::span<const uint8_t, 32> key,
+        std::span<const uint8_t, 12> nonce,
+        std::span<const uint8_t> aad,
+        std::span<uint8_t> data,
+        std::span<uint8_t, 16> tag
+    ) override;
+    
+    bool chacha20_poly1305_decrypt_in_place(
+        std::span<const uint8_t, 32> key,
+        std::span<const uint8_t, 12> nonce,
+        std::span<const uint8_t> aad,
+        std::span<uint8_t> data,
+        std::span<const uint8_t, 16> tag
+    ) override;
+    
+    bool chacha20_poly1305_encrypt_batch(
+        std::span<const uint8_t, 32> key,
+        std::span<const AeadSealFrame> frames
+    ) override;
+    bool chacha20_poly1305_decrypt_batch(
+        std::span<const uint8_t, 32> key,
+        std::span<const AeadOpenFrame> frames
+    ) override;
+    
     // SRP (placeholder - will implement simple version)
     std::unique_ptr<hap::platform::SRPSession> srp_new_verifier(
         std::string_view username,
         std::string_view password
     ) override;
+    std::unique_ptr<hap::platform::SRPSession> srp_restore_verifier(
+        std::string_view username,
+        std::string_view password,
+        std::span<const uint8_t, 16> salt,
+        std::span<const uint8_t> verifier
+    ) override;
     
     std::array<uint8_t, 16> srp_get_salt(hap::platform::SRPSession* session) override;
     std::vector<uint8_t> srp_get_public_key(hap::platform::SRPSession* session) override;
@@ -11,9 +11,23 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <sys/types.h>
 
 namespace linux_pal {
 
+/**
+ * @brief Linux Network PAL: Avahi for mDNS, a single epoll reactor for TCP.
+ * 
+ * All sockets are non-blocking and registered edge-triggered on one epoll
+ * instance serviced by one reactor thread, which delivers every receive and
+ * disconnect callback. tcp_send() may be called from any thread: it writes
+ * directly when the socket has room and otherwise parks the remainder in a
+ * per-connection outbox flushed on EPOLLOUT. tcp_can_send() reports false
+ * while that outbox is non-empty so the HAP layer queues instead of piling up.
+ */
 class LinuxNetwork : public hap::platform::Network {
 public:
     LinuxNetwork();
@@ -23,12 +37,41 @@ public:
     void mdns_update_txt_record(const hap::platform::Network::MdnsService& service) override;
     void tcp_listen(uint16_t port, hap::platform::Network::ReceiveCallback callback, hap::platform::Network::DisconnectCallback disconnect_callback) override;
     void tcp_send(uint32_t connection_id, std::span<const uint8_t> data) override;
+    void tcp_send_vectored(uint32_t connection_id, std::span<const std::span<const uint8_t>> buffers) override;
     void tcp_disconnect(uint32_t connection_id) override;
+    bool tcp_can_send(uint32_t connection_id) override;
+
+    /**
+     * @brief Drive timers from the reactor thread.
+     * 
+     * The reactor sleeps in epoll_wait until next_deadline() (capped at
+     * max_sleep_ms so work queued from other threads is not delayed), then
+     * calls on_timer(). Typically wired to AccessoryServer::next_deadline_ms()
+     * and AccessoryServer::tick(). Call before tcp_listen().
+     */
+    void set_timer_hooks(std::function<std::optional<uint64_t>()> next_deadline,
+                         std::function<void()> on_timer,
+                         uint32_t max_sleep_ms = 100);
 
 private:
-    void accept_loop(uint16_t port);
-    void client_handler(int client_fd, uint32_t connection_id);
-    
+    struct Connection {
+        int fd = -1;
+        std::vector<uint8_t> outbox;  // Bytes the kernel did not accept yet
+        size_t outbox_offset = 0;
+        bool want_write = false;      // EPOLLOUT currently armed
+    };
+
+    void event_loop();
+    void accept_all();
+    void read_all(uint32_t connection_id, int fd);
+    void flush_outbox(uint32_t connection_id);
+    void close_connection(uint32_t connection_id);
+    int epoll_timeout_ms();
+    // Caller holds mutex_. Returns bytes written before EAGAIN, or -1 on error.
+    ssize_t write_now(Connection& connection, std::span<const std::span<const uint8_t>> buffers);
+    void queue_remainder(Connection& connection, std::span<const std::span<const uint8_t>> buffers, size_t written);
+    void update_interest(uint32_t connection_id, Connection& connection);
+
     static void client_callback(AvahiClient *c, AvahiClientState state, void *userdata);
     static void entry_group_callback(AvahiEntryGroup *g, AvahiEntryGroupState state, void *userdata);
     void create_services(AvahiClient *c);
@@ -43,9 +86,19 @@ private:
 
     hap::platform::Network::ReceiveCallback receive_callback_;
     hap::platform::Network::DisconnectCallback disconnect_callback_;
+    std::function<std::optional<uint64_t>()> next_deadline_;
+    std::function<void()> on_timer_;
+    uint32_t max_sleep_ms_ = 100;
     
+    int epoll_fd_ = -1;
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;  // eventfd used to stop the reactor
     std::atomic<bool> running_{false};
-    std::thread accept_thread_;
+    std::thread reactor_thread_;
+
+    std::mutex mutex_;  // Guards connections_; never held across callbacks
+    std::unordered_map<uint32_t, Connection> connections_;
+    uint32_t next_connection_id_ = 1;
 };
 
 } // namespace linux_pal
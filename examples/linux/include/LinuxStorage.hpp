@@ -1,96 +1,87 @@
 #pragma once
 
 #include "hap/platform/Storage.hpp"
-#include <nlohmann/json.hpp>
-#include <fstream>
-#include <mutex>
+#include <cstdint>
 #include <map>
-#include <vector>
+#include <mutex>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace linux_pal {
 
+/**
+ * @brief Linux Storage PAL: append-only log of binary records.
+ * 
+ * Every set()/remove() appends one CRC-protected record instead of
+ * rewriting the file, so IID map saves and GSN increments cost O(record).
+ * The live key set is kept in RAM; on open the log is replayed (through
+ * mmap when enabled) and a torn tail from a crash is cut off. Once dead
+ * records outweigh live ones the log is compacted into a fresh file that
+ * atomically replaces the old one.
+ * 
+ * Record layout (little endian):
+ *   u32 crc32 | u8 op | u16 key_len | u32 value_len | key | value
+ * with the CRC covering everything after itself. Keys of 64 KiB or more
+ * do not fit key_len and are refused.
+ */
 class LinuxStorage : public hap::platform::Storage {
 public:
-    explicit LinuxStorage(std::string filename) : filename_(std::move(filename)) {
-        load();
-    }
+    enum class FsyncPolicy {
+        Always,   ///< fsync after every write or batch (default)
+        OnBatch,  ///< fsync only when a begin_batch()/commit_batch() pair ends
+        Never     ///< leave it to the kernel
+    };
 
-    void set(std::string_view key, std::span<const uint8_t> value) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        // Convert to hex string for JSON storage
-        std::string hex_value;
-        hex_value.reserve(value.size() * 2);
-        for (uint8_t byte : value) {
-            char buf[3];
-            snprintf(buf, sizeof(buf), "%02x", byte);
-            hex_value += buf;
-        }
-        
-        data_[std::string(key)] = hex_value;
-        save();
-    }
+    struct Options {
+        FsyncPolicy fsync = FsyncPolicy::Always;
+        bool mmap_reads = true;              ///< Replay the log through mmap instead of read()
+        size_t compact_min_bytes = 64 * 1024;  ///< Never compact below this log size
+        double compact_ratio = 2.0;          ///< Compact once log size exceeds live size times this
+        /// Imported once into an empty log, then renamed to *.migrated
+        std::string legacy_json;
+    };
 
-    std::optional<std::vector<uint8_t>> get(std::string_view key) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        
-        auto it = data_.find(std::string(key));
-        if (it == data_.end()) {
-            return std::nullopt;
-        }
-        
-        // Convert from hex string
-        const std::string& hex = it->second;
-        std::vector<uint8_t> result;
-        result.reserve(hex.size() / 2);
-        
-        for (size_t i = 0; i < hex.size(); i += 2) {
-            unsigned int byte;
-            sscanf(hex.c_str() + i, "%2x", &byte);
-            result.push_back(static_cast<uint8_t>(byte));
-        }
-        
-        return result;
-    }
+    explicit LinuxStorage(std::string filename) : LinuxStorage(std::move(filename), Options{}) {}
+    LinuxStorage(std::string filename, Options options);
+    ~LinuxStorage() override;
 
-    void remove(std::string_view key) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_.erase(std::string(key));
-        save();
-    }
+    LinuxStorage(const LinuxStorage&) = delete;
+    LinuxStorage& operator=(const LinuxStorage&) = delete;
 
-    bool has(std::string_view key) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return data_.count(std::string(key)) > 0;
-    }
+    void set(std::string_view key, std::span<const uint8_t> value) override;
+    std::optional<std::vector<uint8_t>> get(std::string_view key) override;
+    void remove(std::string_view key) override;
+    bool has(std::string_view key) override;
+
+    void begin_batch() override;
+    void commit_batch() override;
+
+    /// Rewrite the log with only live records
+    void compact();
+
+    size_t log_bytes() const;
 
 private:
     std::string filename_;
-    std::map<std::string, std::string> data_;
-    std::mutex mutex_;
-
-    void load() {
-        std::ifstream file(filename_);
-        if (file.is_open()) {
-            try {
-                nlohmann::json j;
-                file >> j;
-                data_ = j.get<std::map<std::string, std::string>>();
-            } catch (...) {
-                // Invalid JSON, start fresh
-                data_.clear();
-            }
-        }
-    }
+    Options options_;
+    int fd_ = -1;
+    
+    std::map<std::string, std::vector<uint8_t>, std::less<>> data_;
+    size_t log_bytes_ = 0;
+    size_t live_bytes_ = 0;  // Size the live records would take in a compacted log
+    
+    size_t batch_depth_ = 0;
+    std::vector<uint8_t> pending_;  // Records buffered while a batch is open
+    mutable std::mutex mutex_;
 
-    void save() {
-        std::ofstream file(filename_);
-        if (file.is_open()) {
-            nlohmann::json j = data_;
-            file << j.dump(2);
-        }
-    }
+    void open_log();
+    void replay(const uint8_t* data, size_t size);
+    void import_legacy_json();
+    void append(uint8_t op, std::string_view key, std::span<const uint8_t> value);
+    void write_pending(bool sync);
+    void maybe_compact();
+    void compact_locked();
 };
 
 } // namespace linux_pal
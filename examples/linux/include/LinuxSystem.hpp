@@ -22,7 +22,11 @@ public:
         }
     }
 
+    void set_log_level(LogLevel level) { log_level_ = level; }
+    LogLevel log_level() const override { return log_level_; }
+
     void log(LogLevel level, std::string_view message) override {
+        if (level < log_level_) return;
         const char* level_str;
         switch (level) {
             case LogLevel::Debug: level_str = "DEBUG"; break;
@@ -42,6 +46,9 @@ public:
                level_str,
                static_cast<int>(message.size()), message.data());
     }
+
+private:
+    LogLevel log_level_ = LogLevel::Debug;
 };
 
 } // namespace linux_pal
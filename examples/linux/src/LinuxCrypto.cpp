@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <memory>
 #include <openssl/bn.h>
 #include <openssl/evp.h>
 #include <openssl/kdf.h>
@@ -183,107 +184,139 @@ void LinuxCrypto::x25519_shared_secret(
   EVP_PKEY_free(pkey);
 }
 
-// ChaCha20-Poly1305 encrypt
-bool LinuxCrypto::chacha20_poly1305_encrypt_and_tag(
-    std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
-    std::span<const uint8_t> aad, std::span<const uint8_t> plaintext,
-    std::span<uint8_t> ciphertext, std::span<uint8_t, 16> tag) {
-  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-  if (!ctx)
-    return false;
+// ChaCha20-Poly1305
+//
+// OpenSSL selects its AVX2/AVX-512/NEON ChaCha20 and Poly1305 kernels at
+// runtime from CPU feature detection. What dominated per-frame cost was the
+// wrapper: a context allocation, an implicit cipher fetch and debug output
+// on every call. The cipher is fetched once and each thread keeps one
+// context that is re-keyed and re-IVed per frame.
+
+namespace {
+
+const EVP_CIPHER *chacha20_poly1305_cipher() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  static EVP_CIPHER *cipher =
+      EVP_CIPHER_fetch(nullptr, "ChaCha20-Poly1305", nullptr);
+  return cipher;
+#else
+  return EVP_chacha20_poly1305();
+#endif
+}
 
-  EVP_EncryptInit_ex(ctx, EVP_chacha20_poly1305(), nullptr, key.data(),
-                     nonce.data());
+struct CipherCtxDeleter {
+  void operator()(EVP_CIPHER_CTX *ctx) const { EVP_CIPHER_CTX_free(ctx); }
+};
 
-  // Set AAD if present
-  int len;
-  if (!aad.empty()) {
-    EVP_EncryptUpdate(ctx, nullptr, &len, aad.data(), aad.size());
-  }
+EVP_CIPHER_CTX *thread_cipher_ctx() {
+  thread_local std::unique_ptr<EVP_CIPHER_CTX, CipherCtxDeleter> ctx(
+      EVP_CIPHER_CTX_new());
+  return ctx.get();
+}
 
-  // Encrypt
-  int ciphertext_len;
-  EVP_EncryptUpdate(ctx, ciphertext.data(), &ciphertext_len, plaintext.data(),
-                    plaintext.size());
+bool set_key(EVP_CIPHER_CTX *ctx, std::span<const uint8_t, 32> key,
+             bool encrypt) {
+  return ctx && EVP_CipherInit_ex(ctx, chacha20_poly1305_cipher(), nullptr,
+                                  key.data(), nullptr, encrypt ? 1 : 0) == 1;
+}
 
-  // Finalize
-  int final_len;
-  EVP_EncryptFinal_ex(ctx, ciphertext.data() + ciphertext_len, &final_len);
+// ctx must already be keyed for encryption; out may alias in exactly
+bool seal_frame(EVP_CIPHER_CTX *ctx, const uint8_t *nonce,
+                std::span<const uint8_t> aad, std::span<const uint8_t> in,
+                uint8_t *out, uint8_t *tag) {
+  int len;
+  return EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce) == 1 &&
+         (aad.empty() ||
+          EVP_EncryptUpdate(ctx, nullptr, &len, aad.data(), aad.size()) ==
+              1) &&
+         EVP_EncryptUpdate(ctx, out, &len, in.data(), in.size()) == 1 &&
+         EVP_EncryptFinal_ex(ctx, out + len, &len) == 1 &&
+         EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, tag) == 1;
+}
+
+// ctx must already be keyed for decryption; out may alias in exactly
+bool open_frame(EVP_CIPHER_CTX *ctx, const uint8_t *nonce,
+                std::span<const uint8_t> aad, std::span<const uint8_t> in,
+                const uint8_t *tag, uint8_t *out) {
+  int len;
+  return EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce) == 1 &&
+         (aad.empty() ||
+          EVP_DecryptUpdate(ctx, nullptr, &len, aad.data(), aad.size()) ==
+              1) &&
+         EVP_DecryptUpdate(ctx, out, &len, in.data(), in.size()) == 1 &&
+         EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16,
+                             const_cast<uint8_t *>(tag)) == 1 &&
+         EVP_DecryptFinal_ex(ctx, out + len, &len) == 1;
+}
 
-  // Get tag
-  EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, 16, tag.data());
+} // namespace
 
-  EVP_CIPHER_CTX_free(ctx);
-  return true;
+bool LinuxCrypto::chacha20_poly1305_encrypt_and_tag(
+    std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+    std::span<const uint8_t> aad, std::span<const uint8_t> plaintext,
+    std::span<uint8_t> ciphertext, std::span<uint8_t, 16> tag) {
+  EVP_CIPHER_CTX *ctx = thread_cipher_ctx();
+  return set_key(ctx, key, true) &&
+         seal_frame(ctx, nonce.data(), aad, plaintext, ciphertext.data(),
+                    tag.data());
 }
 
-// ChaCha20-Poly1305 decrypt
 bool LinuxCrypto::chacha20_poly1305_decrypt_and_verify(
     std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
     std::span<const uint8_t> aad, std::span<const uint8_t> ciphertext,
     std::span<const uint8_t, 16> tag, std::span<uint8_t> plaintext) {
-  printf("\n[CRYPTO-CHACHA20] Decrypting with ChaCha20-Poly1305\n");
-  printf("[CRYPTO-CHACHA20]   Key (first 8 bytes): ");
-  for (size_t i = 0; i < 8; i++)
-    printf("%02x", key[i]);
-  printf("...\n");
-  printf("[CRYPTO-CHACHA20]   Nonce (12 bytes): ");
-  for (size_t i = 0; i < 12; i++)
-    printf("%02x", nonce[i]);
-  printf("\n");
-  printf("[CRYPTO-CHACHA20]   AAD size: %zu bytes\n", aad.size());
-  printf("[CRYPTO-CHACHA20]   Ciphertext size: %zu bytes\n", ciphertext.size());
-  printf("[CRYPTO-CHACHA20]   Tag (16 bytes): ");
-  for (size_t i = 0; i < 16; i++)
-    printf("%02x", tag[i]);
-  printf("\n");
-
-  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
-  if (!ctx) {
-    printf("[CRYPTO-CHACHA20]   EVP_CIPHER_CTX_new() failed\n");
+  EVP_CIPHER_CTX *ctx = thread_cipher_ctx();
+  if (!set_key(ctx, key, false) ||
+      !open_frame(ctx, nonce.data(), aad, ciphertext, tag.data(),
+                  plaintext.data())) {
+    printf("[CRYPTO-CHACHA20] Decryption/authentication FAILED (%zu bytes)\n",
+           ciphertext.size());
     return false;
   }
+  return true;
+}
 
-  EVP_DecryptInit_ex(ctx, EVP_chacha20_poly1305(), nullptr, key.data(),
-                     nonce.data());
+bool LinuxCrypto::chacha20_poly1305_encrypt_in_place(
+    std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+    std::span<const uint8_t> aad, std::span<uint8_t> data,
+    std::span<uint8_t, 16> tag) {
+  return chacha20_poly1305_encrypt_and_tag(key, nonce, aad, data, data, tag);
+}
 
-  // Set AAD if present
-  int len;
-  if (!aad.empty()) {
-    EVP_DecryptUpdate(ctx, nullptr, &len, aad.data(), aad.size());
+bool LinuxCrypto::chacha20_poly1305_decrypt_in_place(
+    std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+    std::span<const uint8_t> aad, std::span<uint8_t> data,
+    std::span<const uint8_t, 16> tag) {
+  return chacha20_poly1305_decrypt_and_verify(key, nonce, aad, data, tag, data);
+}
+
+// Batches key the context once and only change the IV per frame
+bool LinuxCrypto::chacha20_poly1305_encrypt_batch(
+    std::span<const uint8_t, 32> key, std::span<const AeadSealFrame> frames) {
+  EVP_CIPHER_CTX *ctx = thread_cipher_ctx();
+  if (!set_key(ctx, key, true))
+    return false;
+  for (const auto &frame : frames) {
+    if (!seal_frame(ctx, frame.nonce.data(), frame.aad, frame.plaintext,
+                    frame.ciphertext.data(), frame.tag.data()))
+      return false;
   }
+  return true;
+}
 
-  // Decrypt
-  int plaintext_len;
-  EVP_DecryptUpdate(ctx, plaintext.data(), &plaintext_len, ciphertext.data(),
-                    ciphertext.size());
-
-  // Set expected tag
-  EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16,
-                      const_cast<uint8_t *>(tag.data()));
-
-  // Verify tag
-  int ret = EVP_DecryptFinal_ex(ctx, plaintext.data() + plaintext_len, &len);
-  EVP_CIPHER_CTX_free(ctx);
-
-  if (ret > 0) {
-    printf("[CRYPTO-CHACHA20]   Decrypted %d bytes\n", plaintext_len + len);
-    printf("[CRYPTO-CHACHA20]   Plaintext (first 16 bytes): ");
-    for (size_t i = 0; i < std::min(size_t(plaintext_len + len), size_t(16));
-         i++) {
-      printf("%02x", plaintext[i]);
-    }
-    printf("...\n\n");
-    return true;
-  } else {
-    printf("[CRYPTO-CHACHA20]   Tag verification failed or decryption error\n");
-    printf("[CRYPTO-CHACHA20]   This usually means:\n");
-    printf("[CRYPTO-CHACHA20]     - Wrong encryption key\n");
-    printf("[CRYPTO-CHACHA20]     - Wrong nonce\n");
-    printf("[CRYPTO-CHACHA20]     - Corrupted ciphertext\n");
-    printf("[CRYPTO-CHACHA20]     - Wrong AAD\n\n");
+bool LinuxCrypto::chacha20_poly1305_decrypt_batch(
+    std::span<const uint8_t, 32> key, std::span<const AeadOpenFrame> frames) {
+  EVP_CIPHER_CTX *ctx = thread_cipher_ctx();
+  if (!set_key(ctx, key, false))
     return false;
+  for (const auto &frame : frames) {
+    if (!open_frame(ctx, frame.nonce.data(), frame.aad, frame.ciphertext,
+                    frame.tag.data(), frame.plaintext.data())) {
+      printf("[CRYPTO-CHACHA20] Batch authentication FAILED\n");
+      return false;
+    }
   }
+  return true;
 }
 
 // SRP Implementation using simplesrp
@@ -346,6 +379,21 @@ LinuxCrypto::srp_new_verifier(std::string_view username,
   return session;
 }
 
+std::unique_ptr<hap::platform::SRPSession>
+LinuxCrypto::srp_restore_verifier(std::string_view username,
+                                  std::string_view password,
+                                  std::span<const uint8_t, 16> salt,
+                                  std::span<const uint8_t> verifier) {
+  std::array<uint8_t, 16> salt_array;
+  std::copy(salt.begin(), salt.end(), salt_array.begin());
+
+  auto session = std::make_unique<LinuxSRPSession>(
+      salt_array, std::vector<uint8_t>(verifier.begin(), verifier.end()),
+      std::string{username}, std::string{password});
+  session->server.params.flags = simplesrp::SRPFlagSkipZeroes_M1_M2;
+  return session;
+}
+
 std::array<uint8_t, 16>
 LinuxCrypto::srp_get_salt(hap::platform::SRPSession *session) {
   return session->salt;
@@ -1,19 +1,35 @@
 #include "LinuxNetwork.hpp"
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <thread>
-#include <map>
-#include <mutex>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
 
 namespace linux_pal {
 
-// Global state for this simple example
-static std::map<uint32_t, int> g_connections;
-static std::mutex g_mutex;
-static uint32_t g_next_connection_id = 1;
+namespace {
+
+constexpr int kMaxEvents = 64;
+constexpr size_t kReadChunk = 4096;
+
+// Listening socket and wake eventfd use reserved tags; connections use their IDs
+constexpr uint64_t kListenTag = UINT64_MAX;
+constexpr uint64_t kWakeTag = UINT64_MAX - 1;
+
+uint64_t now_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
 
 LinuxNetwork::LinuxNetwork() {
 }
@@ -34,17 +50,25 @@ LinuxNetwork::~LinuxNetwork() {
         threaded_poll_ = nullptr;
     }
     
-    {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        for (auto& [id, fd] : g_connections) {
-            close(fd);
-        }
-        g_connections.clear();
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+    if (reactor_thread_.joinable()) {
+        reactor_thread_.join();
     }
     
-    if (accept_thread_.joinable()) {
-        accept_thread_.join();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [id, connection] : connections_) {
+            close(connection.fd);
+        }
+        connections_.clear();
     }
+    if (listen_fd_ >= 0) close(listen_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    if (epoll_fd_ >= 0) close(epoll_fd_);
 }
 
 void LinuxNetwork::mdns_register(const hap::platform::Network::MdnsService& service) {
@@ -115,9 +139,6 @@ void LinuxNetwork::mdns_update_txt_record(const hap::platform::Network::MdnsServ
     // Lock the threaded poll to safely modify the entry group
     avahi_threaded_poll_lock(threaded_poll_);
     
-    // Reset the entry group to modify it
-    avahi_entry_group_reset(group_);
-    
     // Convert TXT records to Avahi string list
     AvahiStringList *strlst = nullptr;
     for (const auto& kv : service.txt_records) {
@@ -125,8 +146,9 @@ void LinuxNetwork::mdns_update_txt_record(const hap::platform::Network::MdnsServ
         strlst = avahi_string_list_add(strlst, record.c_str());
     }
     
-    // Re-add the service with updated TXT records
-    int ret = avahi_entry_group_add_service_strlst(
+    // Replace only the TXT record; the group stays established, so there is
+    // no withdraw, re-probe and re-announce of the service
+    int ret = avahi_entry_group_update_service_txt_strlst(
         group_,
         AVAHI_IF_UNSPEC,
         AVAHI_PROTO_UNSPEC,
@@ -134,23 +156,13 @@ void LinuxNetwork::mdns_update_txt_record(const hap::platform::Network::MdnsServ
         name_.c_str(),
         "_hap._tcp",
         nullptr,  // domain
-        nullptr,  // host
-        port_,
         strlst
     );
     
     avahi_string_list_free(strlst);
     
     if (ret < 0) {
-        std::cerr << "Failed to re-add service with updated TXT records: " << avahi_strerror(ret) << std::endl;
-        avahi_threaded_poll_unlock(threaded_poll_);
-        return;
-    }
-    
-    // Commit the changes
-    ret = avahi_entry_group_commit(group_);
-    if (ret < 0) {
-        std::cerr << "Failed to commit TXT record update: " << avahi_strerror(ret) << std::endl;
+        std::cerr << "Failed to update TXT records: " << avahi_strerror(ret) << std::endl;
         avahi_threaded_poll_unlock(threaded_poll_);
         return;
     }
@@ -254,119 +266,324 @@ void LinuxNetwork::create_services(AvahiClient *c) {
     }
 }
 
+void LinuxNetwork::set_timer_hooks(std::function<std::optional<uint64_t>()> next_deadline,
+                                   std::function<void()> on_timer,
+                                   uint32_t max_sleep_ms) {
+    next_deadline_ = std::move(next_deadline);
+    on_timer_ = std::move(on_timer);
+    max_sleep_ms_ = max_sleep_ms;
+}
+
 void LinuxNetwork::tcp_listen(uint16_t port, hap::platform::Network::ReceiveCallback callback, hap::platform::Network::DisconnectCallback disconnect_callback) {
     receive_callback_ = callback;
     disconnect_callback_ = disconnect_callback;
-    running_ = true;
     
-    accept_thread_ = std::thread([this, port]() {
-        this->accept_loop(port);
-    });
-}
-
-void LinuxNetwork::accept_loop(uint16_t port) {
-    int server_fd = socket(AF_INET6, SOCK_STREAM, 0);
-    if (server_fd < 0) {
+    listen_fd_ = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
         perror("socket failed");
         return;
     }
     
     int opt = 1;
-    setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt));
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &opt, sizeof(opt));
     
     sockaddr_in6 addr{};
     addr.sin6_family = AF_INET6;
     addr.sin6_port = htons(port);
     addr.sin6_addr = in6addr_any;
     
-    if (bind(server_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    if (bind(listen_fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
         perror("bind failed");
-        close(server_fd);
+        close(listen_fd_);
+        listen_fd_ = -1;
         return;
     }
     
-    if (listen(server_fd, SOMAXCONN) < 0) {
+    if (listen(listen_fd_, SOMAXCONN) < 0) {
         perror("listen failed");
-        close(server_fd);
+        close(listen_fd_);
+        listen_fd_ = -1;
         return;
     }
     
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd_ < 0 || wake_fd_ < 0) {
+        perror("epoll setup failed");
+        return;
+    }
+    
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = kListenTag;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.events = EPOLLIN;
+    ev.data.u64 = kWakeTag;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+    
     std::cout << "Listening on dual-stack (IPv4+IPv6) port " << port << std::endl;
     
+    running_ = true;
+    reactor_thread_ = std::thread([this]() {
+        this->event_loop();
+    });
+}
+
+int LinuxNetwork::epoll_timeout_ms() {
+    if (!next_deadline_) return -1;
+    
+    uint64_t sleep_ms = max_sleep_ms_;
+    if (auto deadline = next_deadline_()) {
+        uint64_t now = now_ms();
+        sleep_ms = *deadline > now ? std::min<uint64_t>(*deadline - now, max_sleep_ms_) : 0;
+    }
+    return static_cast<int>(sleep_ms);
+}
+
+void LinuxNetwork::event_loop() {
+    epoll_event events[kMaxEvents];
+    
     while (running_) {
-        int new_socket = accept(server_fd, nullptr, nullptr);
-        if (new_socket < 0) {
-            if (running_) perror("accept failed");
+        int count = epoll_wait(epoll_fd_, events, kMaxEvents, epoll_timeout_ms());
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
             break;
         }
         
-        uint32_t conn_id;
+        for (int i = 0; i < count; ++i) {
+            uint64_t tag = events[i].data.u64;
+            uint32_t mask = events[i].events;
+            
+            if (tag == kWakeTag) {
+                uint64_t value;
+                ssize_t ignored = read(wake_fd_, &value, sizeof(value));
+                (void)ignored;
+                continue;
+            }
+            if (tag == kListenTag) {
+                accept_all();
+                continue;
+            }
+            
+            auto connection_id = static_cast<uint32_t>(tag);
+            int fd = -1;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = connections_.find(connection_id);
+                if (it == connections_.end()) continue;
+                fd = it->second.fd;
+            }
+            
+            if (mask & EPOLLOUT) {
+                flush_outbox(connection_id);
+            }
+            if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                read_all(connection_id, fd);
+            }
+        }
+        
+        if (on_timer_) {
+            on_timer_();
+        }
+    }
+}
+
+void LinuxNetwork::accept_all() {
+    // Edge-triggered: accept until the backlog is empty
+    for (;;) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept failed");
+            return;
+        }
+        
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        
+        uint32_t connection_id;
         {
-            std::lock_guard<std::mutex> lock(g_mutex);
-            conn_id = g_next_connection_id++;
-            g_connections[conn_id] = new_socket;
+            std::lock_guard<std::mutex> lock(mutex_);
+            connection_id = next_connection_id_++;
+            connections_[connection_id].fd = fd;
         }
         
-        std::thread([this, new_socket, conn_id]() {
-            this->client_handler(new_socket, conn_id);
-        }).detach();
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = connection_id;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            perror("epoll_ctl add failed");
+            std::lock_guard<std::mutex> lock(mutex_);
+            connections_.erase(connection_id);
+            close(fd);
+        }
     }
-    
-    close(server_fd);
 }
 
-void LinuxNetwork::client_handler(int client_fd, uint32_t connection_id) {
-    uint8_t buffer[1024];
+void LinuxNetwork::read_all(uint32_t connection_id, int fd) {
+    uint8_t buffer[kReadChunk];
     
-    while (running_) {
-        ssize_t valread = read(client_fd, buffer, 1024);
+    // Edge-triggered: drain the socket until EAGAIN
+    for (;;) {
+        ssize_t valread = read(fd, buffer, sizeof(buffer));
         if (valread > 0) {
             if (receive_callback_) {
-                receive_callback_(connection_id, std::span<const uint8_t>(buffer, valread));
+                receive_callback_(connection_id, std::span<const uint8_t>(buffer, static_cast<size_t>(valread)));
             }
-        } else {
-            // Disconnected or error
-            break;
+            continue;
         }
+        if (valread < 0 && errno == EINTR) continue;
+        if (valread < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+        
+        // Orderly shutdown or error
+        close_connection(connection_id);
+        return;
     }
-    
+}
+
+void LinuxNetwork::close_connection(uint32_t connection_id) {
     {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        g_connections.erase(connection_id);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = connections_.find(connection_id);
+        if (it == connections_.end()) return;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        close(it->second.fd);
+        connections_.erase(it);
     }
-    close(client_fd);
     
     if (disconnect_callback_) {
         disconnect_callback_(connection_id);
     }
 }
 
-void LinuxNetwork::tcp_send(uint32_t connection_id, std::span<const uint8_t> data) {
-    int fd = -1;
-    {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        if (g_connections.count(connection_id)) {
-            fd = g_connections[connection_id];
+ssize_t LinuxNetwork::write_now(Connection& connection, std::span<const std::span<const uint8_t>> buffers) {
+    iovec iov[16];
+    size_t written = 0;
+    size_t index = 0;   // First buffer with unsent bytes
+    size_t offset = 0;  // Bytes of buffers[index] already sent
+    
+    while (index < buffers.size()) {
+        size_t count = 0;
+        for (size_t i = index; i < buffers.size() && count < std::size(iov); ++i) {
+            auto buffer = i == index ? buffers[i].subspan(offset) : buffers[i];
+            if (buffer.empty()) continue;
+            iov[count++] = {const_cast<uint8_t*>(buffer.data()), buffer.size()};
+        }
+        if (count == 0) break;
+        
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t sent = sendmsg(connection.fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return -1;
         }
+        written += static_cast<size_t>(sent);
+        
+        // Advance past fully written buffers
+        size_t remaining = static_cast<size_t>(sent);
+        while (index < buffers.size() && remaining >= buffers[index].size() - offset) {
+            remaining -= buffers[index].size() - offset;
+            offset = 0;
+            ++index;
+        }
+        offset += remaining;
     }
-    
-    if (fd != -1) {
-        send(fd, data.data(), data.size(), 0);
+    return static_cast<ssize_t>(written);
+}
+
+void LinuxNetwork::queue_remainder(Connection& connection, std::span<const std::span<const uint8_t>> buffers, size_t written) {
+    for (auto buffer : buffers) {
+        if (written >= buffer.size()) {
+            written -= buffer.size();
+            continue;
+        }
+        connection.outbox.insert(connection.outbox.end(), buffer.begin() + static_cast<std::ptrdiff_t>(written), buffer.end());
+        written = 0;
     }
 }
 
-void LinuxNetwork::tcp_disconnect(uint32_t connection_id) {
-    int fd = -1;
-    {
-        std::lock_guard<std::mutex> lock(g_mutex);
-        if (g_connections.count(connection_id)) {
-            fd = g_connections[connection_id];
-            g_connections.erase(connection_id);
+void LinuxNetwork::update_interest(uint32_t connection_id, Connection& connection) {
+    bool want_write = connection.outbox_offset < connection.outbox.size();
+    if (want_write == connection.want_write) return;
+    
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET | (want_write ? EPOLLOUT : 0u);
+    ev.data.u64 = connection_id;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, connection.fd, &ev);
+    connection.want_write = want_write;
+}
+
+void LinuxNetwork::tcp_send(uint32_t connection_id, std::span<const uint8_t> data) {
+    std::span<const uint8_t> buffers[] = {data};
+    tcp_send_vectored(connection_id, buffers);
+}
+
+void LinuxNetwork::tcp_send_vectored(uint32_t connection_id, std::span<const std::span<const uint8_t>> buffers) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(connection_id);
+    if (it == connections_.end()) return;
+    auto& connection = it->second;
+    
+    // Preserve ordering: once bytes are parked, everything goes behind them
+    size_t written = 0;
+    if (connection.outbox_offset == connection.outbox.size()) {
+        ssize_t sent = write_now(connection, buffers);
+        if (sent < 0) {
+            // Peer is gone; the reactor reports the disconnect
+            shutdown(connection.fd, SHUT_RDWR);
+            return;
         }
+        written = static_cast<size_t>(sent);
     }
     
-    if (fd != -1) {
-        close(fd);
+    queue_remainder(connection, buffers, written);
+    update_interest(connection_id, connection);
+}
+
+void LinuxNetwork::flush_outbox(uint32_t connection_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(connection_id);
+    if (it == connections_.end()) return;
+    auto& connection = it->second;
+    
+    std::span<const uint8_t> pending(connection.outbox.data() + connection.outbox_offset,
+                                     connection.outbox.size() - connection.outbox_offset);
+    std::span<const uint8_t> buffers[] = {pending};
+    ssize_t sent = write_now(connection, buffers);
+    if (sent < 0) {
+        shutdown(connection.fd, SHUT_RDWR);
+        return;
+    }
+    
+    connection.outbox_offset += static_cast<size_t>(sent);
+    if (connection.outbox_offset == connection.outbox.size()) {
+        connection.outbox.clear();
+        connection.outbox_offset = 0;
+    }
+    update_interest(connection_id, connection);
+}
+
+bool LinuxNetwork::tcp_can_send(uint32_t connection_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(connection_id);
+    
+    // Unknown connections report writable so queued data is dropped by tcp_send
+    if (it == connections_.end()) return true;
+    return it->second.outbox_offset == it->second.outbox.size();
+}
+
+void LinuxNetwork::tcp_disconnect(uint32_t connection_id) {
+    // Only shut the socket down here; the reactor sees the hang-up, closes
+    // the descriptor and reports the disconnect, so fds are never reused
+    // while another thread might still write to them
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(connection_id);
+    if (it != connections_.end()) {
+        shutdown(it->second.fd, SHUT_RDWR);
     }
 }
 
@@ -0,0 +1,356 @@
+#include "LinuxStorage.hpp"
+#include <nlohmann/json.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace linux_pal {
+
+namespace {
+
+constexpr uint8_t kOpSet = 1;
+constexpr uint8_t kOpRemove = 2;
+constexpr size_t kHeaderSize = 4 + 1 + 2 + 4;
+constexpr size_t kMaxKeySize = 0xFFFF;  // key_len is a u16
+
+constexpr std::array<uint32_t, 256> make_crc_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+constexpr auto kCrcTable = make_crc_table();
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        c = kCrcTable[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+void put_le(std::vector<uint8_t>& out, uint32_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint32_t get_le(const uint8_t* p, size_t bytes) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint32_t>(p[i]) << (8 * i);
+    }
+    return value;
+}
+
+size_t record_size(std::string_view key, size_t value_size) {
+    return kHeaderSize + key.size() + value_size;
+}
+
+void encode_record(std::vector<uint8_t>& out, uint8_t op, std::string_view key, std::span<const uint8_t> value) {
+    size_t start = out.size();
+    out.resize(start + 4);  // CRC placeholder
+    out.push_back(op);
+    put_le(out, static_cast<uint32_t>(key.size()), 2);
+    put_le(out, static_cast<uint32_t>(value.size()), 4);
+    out.insert(out.end(), key.begin(), key.end());
+    out.insert(out.end(), value.begin(), value.end());
+    uint32_t crc = crc32(out.data() + start + 4, out.size() - start - 4);
+    for (size_t i = 0; i < 4; ++i) {
+        out[start + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+}
+
+bool write_all(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void fsync_parent_dir(const std::string& path) {
+    auto slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : path.substr(0, slash == 0 ? 1 : slash);
+    int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dfd >= 0) {
+        ::fsync(dfd);
+        ::close(dfd);
+    }
+}
+
+} // namespace
+
+LinuxStorage::LinuxStorage(std::string filename, Options options)
+    : filename_(std::move(filename)), options_(std::move(options)) {
+    open_log();
+    if (data_.empty() && !options_.legacy_json.empty()) {
+        import_legacy_json();
+    }
+}
+
+LinuxStorage::~LinuxStorage() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_pending(options_.fsync != FsyncPolicy::Never);
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void LinuxStorage::set(std::string_view key, std::span<const uint8_t> value) {
+    if (key.size() > kMaxKeySize || value.size() > UINT32_MAX) {
+        std::cerr << "[LinuxStorage] Record too large for key of " << key.size() << " bytes" << std::endl;
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = data_.find(key);
+    if (it != data_.end()) {
+        if (it->second.size() == value.size() && std::equal(value.begin(), value.end(), it->second.begin())) {
+            return;
+        }
+        live_bytes_ -= record_size(key, it->second.size());
+        it->second.assign(value.begin(), value.end());
+    } else {
+        data_.emplace(std::string(key), std::vector<uint8_t>(value.begin(), value.end()));
+    }
+    live_bytes_ += record_size(key, value.size());
+    append(kOpSet, key, value);
+}
+
+std::optional<std::vector<uint8_t>> LinuxStorage::get(std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = data_.find(key);
+    if (it == data_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void LinuxStorage::remove(std::string_view key) {
+    if (key.size() > kMaxKeySize) {
+        return;  // Never stored
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = data_.find(key);
+    if (it == data_.end()) {
+        return;
+    }
+    live_bytes_ -= record_size(key, it->second.size());
+    data_.erase(it);
+    append(kOpRemove, key, {});
+}
+
+bool LinuxStorage::has(std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return data_.find(key) != data_.end();
+}
+
+void LinuxStorage::begin_batch() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++batch_depth_;
+}
+
+void LinuxStorage::commit_batch() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (batch_depth_ == 0 || --batch_depth_ > 0) {
+        return;
+    }
+    write_pending(options_.fsync != FsyncPolicy::Never);
+    maybe_compact();
+}
+
+void LinuxStorage::compact() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_pending(false);
+    compact_locked();
+}
+
+size_t LinuxStorage::log_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return log_bytes_ + pending_.size();
+}
+
+void LinuxStorage::open_log() {
+    fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd_ < 0) {
+        std::cerr << "[LinuxStorage] Cannot open " << filename_ << ": " << std::strerror(errno) << std::endl;
+        return;
+    }
+    
+    struct stat st{};
+    if (::fstat(fd_, &st) == 0 && st.st_size > 0) {
+        size_t size = static_cast<size_t>(st.st_size);
+        void* mapped = options_.mmap_reads ? ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd_, 0) : MAP_FAILED;
+        if (mapped != MAP_FAILED) {
+            replay(static_cast<const uint8_t*>(mapped), size);
+            ::munmap(mapped, size);
+        } else {
+            std::vector<uint8_t> buffer(size);
+            ssize_t n = ::pread(fd_, buffer.data(), size, 0);
+            replay(buffer.data(), n > 0 ? static_cast<size_t>(n) : 0);
+        }
+        
+        // Drop a torn or corrupt tail so new records follow the last good one
+        if (log_bytes_ < size) {
+            std::cerr << "[LinuxStorage] Discarding " << (size - log_bytes_)
+                      << " bytes of damaged log tail" << std::endl;
+            if (::ftruncate(fd_, static_cast<off_t>(log_bytes_)) != 0) {
+                std::cerr << "[LinuxStorage] ftruncate failed: " << std::strerror(errno) << std::endl;
+            }
+        }
+    }
+    ::lseek(fd_, static_cast<off_t>(log_bytes_), SEEK_SET);
+}
+
+void LinuxStorage::replay(const uint8_t* data, size_t size) {
+    size_t offset = 0;
+    while (size - offset >= kHeaderSize) {
+        const uint8_t* p = data + offset;
+        uint32_t crc = get_le(p, 4);
+        uint8_t op = p[4];
+        size_t key_len = get_le(p + 5, 2);
+        size_t value_len = get_le(p + 7, 4);
+        size_t total = kHeaderSize + key_len + value_len;
+        if (total > size - offset || crc32(p + 4, total - 4) != crc || (op != kOpSet && op != kOpRemove)) {
+            break;
+        }
+        
+        std::string key(reinterpret_cast<const char*>(p + kHeaderSize), key_len);
+        auto it = data_.find(key);
+        if (it != data_.end()) {
+            live_bytes_ -= record_size(key, it->second.size());
+        }
+        if (op == kOpSet) {
+            const uint8_t* value = p + kHeaderSize + key_len;
+            live_bytes_ += total;
+            if (it != data_.end()) {
+                it->second.assign(value, value + value_len);
+            } else {
+                data_.emplace(std::move(key), std::vector<uint8_t>(value, value + value_len));
+            }
+        } else if (it != data_.end()) {
+            data_.erase(it);
+        }
+        offset += total;
+    }
+    log_bytes_ = offset;
+}
+
+void LinuxStorage::import_legacy_json() {
+    std::ifstream file(options_.legacy_json);
+    if (!file.is_open()) {
+        return;
+    }
+    
+    std::map<std::string, std::string> legacy;
+    try {
+        nlohmann::json j;
+        file >> j;
+        legacy = j.get<std::map<std::string, std::string>>();
+    } catch (...) {
+        std::cerr << "[LinuxStorage] Ignoring unreadable " << options_.legacy_json << std::endl;
+        return;
+    }
+    file.close();
+    
+    // Values were stored as hex strings
+    begin_batch();
+    for (const auto& [key, hex] : legacy) {
+        std::vector<uint8_t> value;
+        value.reserve(hex.size() / 2);
+        for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+            value.push_back(static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+        }
+        set(key, value);
+    }
+    commit_batch();
+    
+    std::string migrated = options_.legacy_json + ".migrated";
+    std::rename(options_.legacy_json.c_str(), migrated.c_str());
+    std::cout << "[LinuxStorage] Imported " << legacy.size() << " keys from " << options_.legacy_json << std::endl;
+}
+
+void LinuxStorage::append(uint8_t op, std::string_view key, std::span<const uint8_t> value) {
+    encode_record(pending_, op, key, value);
+    if (batch_depth_ == 0) {
+        write_pending(options_.fsync == FsyncPolicy::Always);
+        maybe_compact();
+    }
+}
+
+void LinuxStorage::write_pending(bool sync) {
+    if (pending_.empty() || fd_ < 0) {
+        return;
+    }
+    if (!write_all(fd_, pending_.data(), pending_.size())) {
+        std::cerr << "[LinuxStorage] Write failed: " << std::strerror(errno) << std::endl;
+        // Rewind over the partial record; replay would discard it anyway
+        if (::ftruncate(fd_, static_cast<off_t>(log_bytes_)) == 0) {
+            ::lseek(fd_, static_cast<off_t>(log_bytes_), SEEK_SET);
+        }
+        pending_.clear();
+        return;
+    }
+    log_bytes_ += pending_.size();
+    pending_.clear();
+    if (sync) {
+        ::fdatasync(fd_);
+    }
+}
+
+void LinuxStorage::maybe_compact() {
+    if (log_bytes_ >= options_.compact_min_bytes &&
+        static_cast<double>(log_bytes_) > static_cast<double>(live_bytes_) * options_.compact_ratio) {
+        compact_locked();
+    }
+}
+
+void LinuxStorage::compact_locked() {
+    std::vector<uint8_t> image;
+    image.reserve(live_bytes_);
+    for (const auto& [key, value] : data_) {
+        encode_record(image, kOpSet, key, value);
+    }
+    
+    std::string tmp = filename_ + ".tmp";
+    int tmp_fd = ::open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (tmp_fd < 0) {
+        std::cerr << "[LinuxStorage] Compaction skipped: " << std::strerror(errno) << std::endl;
+        return;
+    }
+    if (!write_all(tmp_fd, image.data(), image.size()) || ::fsync(tmp_fd) != 0 ||
+        ::rename(tmp.c_str(), filename_.c_str()) != 0) {
+        std::cerr << "[LinuxStorage] Compaction failed: " << std::strerror(errno) << std::endl;
+        ::close(tmp_fd);
+        ::unlink(tmp.c_str());
+        return;
+    }
+    fsync_parent_dir(filename_);
+    
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = tmp_fd;
+    ::lseek(fd_, 0, SEEK_END);
+    log_bytes_ = image.size();
+}
+
+} // namespace linux_pal
@@ -20,6 +20,7 @@
 #include <cereal/types/array.hpp>
 #include <cereal/types/vector.hpp>
 #include <cereal/types/map.hpp>
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <fmt/format.h>
@@ -27,6 +28,7 @@
 #include <iostream>
 #include <mbedtls/sha256.h>
 #include <memory>
+#include <thread>
 #include <unistd.h>
 #include "HK_HomeKit.h"
 
@@ -113,7 +115,9 @@ int main() {
 
     // Instantiate platform interfaces
     auto system = std::make_unique<linux_pal::LinuxSystem>();
-    storage = std::make_unique<linux_pal::LinuxStorage>("hap_storage.json");
+    linux_pal::LinuxStorage::Options storage_options;
+    storage_options.legacy_json = "hap_storage.json";  // Pairings from older builds
+    storage = std::make_unique<linux_pal::LinuxStorage>("hap_storage.log", storage_options);
     auto crypto = std::make_unique<linux_pal::LinuxCrypto>();
     auto network = std::make_unique<linux_pal::LinuxNetwork>();
 
@@ -138,6 +142,8 @@ int main() {
     
     config.device_name = "HAP-Bridge";
     config.port = 8080;
+    // LinuxNetwork delivers callbacks from one thread per client
+    config.worker_threads = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
     // config.accessory_id = "11:64:46:32:20:24"; // Auto-generated if empty
     config.setup_code = "111-22-333";
     config.category_id = hap::core::AccessoryCategory::Bridge;
@@ -285,24 +291,22 @@ int main() {
 
     g_server = std::make_unique<hap::AccessoryServer>(std::move(config));
     
-    g_server->add_accessory(accessory);
-    g_server->add_accessory(accessory_2);
-    g_server->add_accessory(accessory_3);
+    g_server->add_accessories(std::vector{accessory, accessory_2, accessory_3});
+    
+    // Drive the server's scheduler from the network reactor thread so
+    // timers and socket events share a single epoll_wait
+    network->set_timer_hooks(
+        [] { return g_server->next_deadline_ms(); },
+        [] { g_server->tick(); });
     
     // Start Server
     g_server->start();
     
     std::cout << "Server started. Press Ctrl+C to exit." << std::endl;
     
-    // Keep running
+    // Keep running; all work happens on the reactor and worker threads
     while (true) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        //
-        // uint8_t state = std::get<uint8_t>(lock_service->characteristics()[0]->get_value());
-        // uint8_t new_state = (state == 0) ? 1 : 0;
-        // lock_service->characteristics()[1]->set_value(new_state);
-        // lock_service->characteristics()[0]->set_value(new_state);
-        g_server->tick();
+        std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 
     return 0;
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "hap/common/Metrics.hpp"
+#include "hap/common/WorkerPool.hpp"
 #include "hap/core/AttributeDatabase.hpp"
 #include "hap/core/IIDManager.hpp"
 #include "hap/platform/CryptoSRP.hpp"
@@ -7,16 +9,28 @@
 #include "hap/platform/Storage.hpp"
 #include "hap/platform/System.hpp"
 #include "hap/platform/Ble.hpp"
+#include "hap/transport/OutboundQueue.hpp"
 
 #include <array>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace hap::common {
 class TaskScheduler;
 }
 
+namespace hap::transport {
+struct Request;
+struct Response;
+class ConnectionContext;
+class HTTPParser;
+}
+
 namespace hap {
 
 /**
@@ -43,6 +57,39 @@ struct PairingEvent {
  */
 class AccessoryServer {
 public:
+    /**
+     * @brief Wall time (System::millis()) spent in each phase of bringing the server up.
+     */
+    struct StartupReport {
+        uint32_t construct_ms = 0;       ///< Constructor: identity, pairing store, transports
+        uint32_t config_number_ms = 0;   ///< Structure hash and configuration number update
+        uint32_t network_ms = 0;         ///< TCP listener and mDNS registration
+        uint32_t ble_start_ms = 0;       ///< BLE work done inside start()
+        uint32_t pair_setup_ms = 0;      ///< SRP verifier preparation done inside start()
+        uint32_t start_ms = 0;           ///< All of start(); HAP-IP answers from here on
+        std::optional<uint32_t> ble_ready_ms;  ///< From start() until BLE is fully registered and advertising
+    };
+
+    /**
+     * @brief Live counters for one HAP-IP connection.
+     */
+    struct ConnectionDiagnostics {
+        uint32_t connection_id = 0;
+        uint64_t bytes_received = 0;             ///< Raw bytes, before decryption
+        size_t subscriptions = 0;                ///< Characteristics with events enabled
+        transport::OutboundQueue::Stats outbound;  ///< Bytes, messages, events and frames sent; queue depth
+    };
+
+    /**
+     * @brief Point-in-time view of the server for monitoring.
+     */
+    struct Diagnostics {
+        std::vector<ConnectionDiagnostics> connections;
+        size_t scheduled_tasks = 0;
+        std::optional<size_t> min_free_heap;     ///< From System::min_free_heap(), if the platform reports it
+        common::MetricsSnapshot metrics;         ///< All zero unless metrics are enabled
+    };
+
     struct Config {
         platform::CryptoSRP* crypto;
         platform::Network* network;
@@ -56,6 +103,131 @@ public:
         uint16_t port = 8080;          // TCP port for HAP over IP
         core::AccessoryCategory category_id = core::AccessoryCategory::Lightbulb;
         
+        /**
+         * @brief Window (ms) for merging IP event notifications, e.g. 10-50.
+         * Changes within the window go out as one EVENT/1.0 message per
+         * controller, keeping only the latest value per characteristic.
+         * 0 sends every change immediately. Flushing relies on tick().
+         */
+        uint32_t event_coalesce_ms = 0;
+        
+        /**
+         * @brief Simultaneous HAP-over-IP connections. Slots (context, parser,
+         * request arena) are allocated up front; a connection that arrives
+         * while all are in use is closed right away.
+         */
+        size_t max_connections = 16;
+        
+        /**
+         * @brief Largest HAP-over-IP request (request line, headers and body)
+         * accepted; a connection sending more is closed. 0 disables the limit.
+         */
+        size_t max_request_bytes = 32 * 1024;
+        
+        /**
+         * @brief Time a controller has to finish a request once its first
+         * bytes arrived; slower connections are closed so half-sent requests
+         * cannot pin buffers. 0 disables. Relies on tick().
+         */
+        uint32_t request_timeout_ms = 10000;
+        
+        /**
+         * @brief Close connections that have sent nothing for this long.
+         * Controllers keep quiet connections open to receive events, so use a
+         * generous value (e.g. an hour). 0 (default) disables. Relies on tick().
+         */
+        uint32_t idle_timeout_ms = 0;
+        
+        /**
+         * @brief Per-connection outbound queue limit in bytes. Once exceeded,
+         * the oldest queued events are dropped; responses are always kept.
+         */
+        size_t outbound_queue_bytes = transport::OutboundQueue::DEFAULT_MAX_BYTES;
+        
+        /**
+         * @brief Per-connection arena for parsed requests (path, headers, body),
+         * rewound after each request so steady-state traffic does not allocate.
+         * Larger requests spill to the heap for their duration. 0 disables.
+         */
+        size_t request_arena_bytes = 1024;
+        
+        /**
+         * @brief How long HAP-IP requests wait for async characteristic
+         * callbacks (Characteristic::on_read_async / set_async_write_callback)
+         * before answering ServiceCommunicationFailure for the stragglers.
+         * Only the waiting request is delayed; the timeout relies on tick().
+         */
+        uint32_t async_timeout_ms = 5000;
+        
+        /**
+         * @brief Coalesce storage writes (GSN, config number, IIDs) and flush
+         * them to `storage` this many ms after the first change, in one
+         * Storage::begin_batch()/commit_batch(). Pairing changes and the BLE
+         * GSN reserve (which must survive a power loss for the GSN never to
+         * go backwards) are always flushed immediately. 0 (default) writes
+         * through. Relies on tick().
+         */
+        uint32_t storage_flush_ms = 0;
+        
+        /**
+         * @brief Worker threads for HAP-over-IP request handling.
+         * 
+         * 0 (default): requests run on the thread that calls the Network
+         * receive callback; the PAL must deliver all callbacks from one thread.
+         * 
+         * N > 0: receive/disconnect callbacks may arrive on any thread. Each
+         * connection is pinned to one worker (a strand), so its requests,
+         * responses and events stay ordered and its SecureSession nonces
+         * never race. Different connections are handled in parallel.
+         * Attribute database reads take AttributeDatabase::mutex() shared,
+         * writes take it exclusively, and pairing requests are serialized.
+         * tick() and BLE callbacks still belong to the application thread.
+         */
+        size_t worker_threads = 0;
+        
+        /**
+         * @brief Where the worker threads run (ESP-IDF only; ignored elsewhere).
+         * 
+         * On a dual-core ESP32, pin the workers to the core the Wi-Fi/lwIP
+         * tasks are not on (usually 1): receive callbacks only queue the
+         * bytes, and pair-setup SRP, pair-verify and frame encryption run on
+         * the other core. Pairing needs a deeper stack than the pthread
+         * default; 8 KB is enough for pair-setup M3/M5.
+         */
+        int worker_core = -1;
+        size_t worker_stack_bytes = 0;
+        int worker_priority = 0;
+        
+        /**
+         * @brief Keep start() to what HAP-IP needs to answer its first request.
+         * 
+         * BLE registers only the Accessory Information, Protocol Information
+         * and Pairing services in start(); the remaining GATT services,
+         * signatures and advertising, and (without worker threads) the SRP
+         * verifier preparation follow from the first tick(). See
+         * startup_report() for the effect.
+         */
+        bool defer_startup_work = false;
+        
+        /**
+         * @brief Collect latency histograms and counters for metrics().
+         * Off by default; when off each probe is one relaxed load and no
+         * clock read. Can also be toggled later with set_metrics_enabled().
+         */
+        bool enable_metrics = false;
+        
+        /**
+         * @brief Optional hook called with every recorded sample while metrics
+         * are enabled, on the thread that recorded it. Keep it short.
+         */
+        common::Metrics::TraceHook trace_hook;
+        
+        /**
+         * @brief Serve diagnostics() as JSON on GET /diagnostics.
+         * Paired (encrypted) controllers only; off by default.
+         */
+        bool enable_diagnostics_endpoint = false;
+        
         std::function<void()> on_identify;
         
         /**
@@ -71,6 +243,26 @@ public:
 
     void add_accessory(std::shared_ptr<core::Accessory> accessory);
 
+    /**
+     * @brief Add several accessories in one pass (e.g. a bridge at boot).
+     * 
+     * Validates the whole batch before adding any of it, persists the new
+     * IIDs once and registers event callbacks for every accessory.
+     * @return Success, or the first validation failure (nothing is added)
+     */
+    core::ValidationResult add_accessories(std::span<const std::shared_ptr<core::Accessory>> accessories);
+
+    /**
+     * @brief Remove a (bridged) accessory.
+     * 
+     * Drops its event subscriptions and callbacks. While the server is
+     * running, adding or removing accessories also re-evaluates the
+     * Configuration Number and republishes it over mDNS and BLE, without
+     * closing controller sessions.
+     * @return false if no accessory has this AID
+     */
+    bool remove_accessory(uint64_t aid);
+
     /**
      * @brief Broadcast an event notification to all subscribed controllers.
      * @param aid Accessory ID
@@ -102,16 +294,55 @@ public:
     /**
      * @brief Process periodic tasks. Call this regularly from your main loop.
      * 
-     * Handles: session timeouts, GSN updates, characteristic change notifications.
+     * Handles: session timeouts, GSN updates, characteristic change notifications,
+     * and retrying outbound queues held back by tcp_can_send() (with a
+     * doubling backoff while the peer is slow to read).
      * Recommended call frequency: every 100-500ms.
      */
     void tick();
 
+    /**
+     * @brief Earliest time (System::millis()) at which tick() has work to do.
+     * Host loops can sleep until then instead of polling; work arriving from
+     * other threads (e.g. network callbacks) still needs a bounded sleep.
+     * @return nullopt if nothing is scheduled
+     */
+    std::optional<uint64_t> next_deadline_ms();
+
+    /**
+     * @brief Outbound queue metrics for an IP connection (depth, bytes, drops).
+     * @return nullopt if the connection is unknown
+     */
+    std::optional<transport::OutboundQueue::Stats> outbound_stats(uint32_t connection_id) const;
+
+    /**
+     * @brief Snapshot of hot-path latencies and counters (all zero unless enabled).
+     */
+    common::MetricsSnapshot metrics() const;
+
+    /**
+     * @brief Per-connection traffic, subscriptions and queues, plus scheduler,
+     * heap and metrics state. Safe to call from any thread.
+     */
+    Diagnostics diagnostics() const;
+
+    /**
+     * @brief Startup phase timings, filled by the constructor and start().
+     * ble_ready_ms is set once deferred BLE registration has finished.
+     */
+    const StartupReport& startup_report() const { return startup_report_; }
+
+    void set_metrics_enabled(bool enabled);
+    void reset_metrics();
+
 private:
     Config config_;
     core::AttributeDatabase database_;
-    bool mdns_registered_ = false;  // Track whether mDNS service has been registered
-    bool pending_connection_cleanup_ = false;
+    std::atomic<bool> mdns_registered_{false};  // Track whether mDNS service has been registered
+    std::atomic<bool> started_{false};  // Structure changes after start() are published
+    std::atomic<bool> pending_connection_cleanup_{false};
+    StartupReport startup_report_;
+    uint64_t start_began_ms_ = 0;
     
     // Router, scheduler, and endpoints (forward declared to reduce header dependencies)
     class Impl;
@@ -121,11 +352,99 @@ private:
     
     // Private member functions
     void setup_routes();
+    /**
+     * @brief Route handlers, bound statically in setup_routes(). Each takes the
+     * lock its endpoint needs.
+     */
+    transport::Response route_pair_setup(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_pair_verify(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_pairings(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_prepare(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_identify(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_get_accessories(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_get_characteristics(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_put_characteristics(const transport::Request& req, transport::ConnectionContext& ctx);
+    transport::Response route_diagnostics(const transport::Request& req, transport::ConnectionContext& ctx);
+    void register_event_callbacks(const core::Accessory& accessory);
+    void on_structure_changed(std::span<const std::shared_ptr<core::Accessory>> added);
     void on_tcp_receive(uint32_t connection_id, std::span<const uint8_t> data);
+    /**
+     * @brief Make sure the timeout sweep runs no later than deadline_ms.
+     */
+    void arm_connection_timeouts(uint64_t deadline_ms);
+    /**
+     * @brief Close connections past their request or idle timeout and re-arm.
+     */
+    void check_connection_timeouts();
+    /**
+     * @brief Dispatch one parsed request and send its response.
+     * @return false if the connection was closed
+     */
+    bool handle_request(uint32_t connection_id, transport::ConnectionContext& ctx, transport::Request request);
+    /**
+     * @brief Handle parsed requests until one is deferred or the connection closes.
+     * @param complete Whether the parser already holds a complete request
+     */
+    void process_requests(uint32_t connection_id, transport::ConnectionContext& ctx,
+                          transport::HTTPParser& parser, bool complete);
+    /**
+     * @brief Queue a response and flush the connection.
+     * @return false if the connection was closed
+     */
+    bool send_response(uint32_t connection_id, transport::ConnectionContext& ctx, transport::Response response);
+    /**
+     * @brief Queue a built message and flush the connection.
+     * @return false if the connection was closed
+     */
+    bool send_message(uint32_t connection_id, transport::ConnectionContext& ctx,
+                      transport::OutboundQueue::Message message);
+    /**
+     * @brief Answer a plaintext POST /pair-setup or /pair-verify without the router.
+     * @return false if the connection was closed
+     */
+    bool handle_pairing_request(uint32_t connection_id, transport::ConnectionContext& ctx,
+                                const transport::Request& request);
+    /**
+     * @brief One Pair Setup / Pair Verify step under the pairing lock.
+     * @return Response TLV, or nullopt if the session produced none
+     */
+    std::optional<std::vector<uint8_t>> pair_setup_step(std::span<const uint8_t> body, transport::ConnectionContext& ctx);
+    std::optional<std::vector<uint8_t>> pair_verify_step(std::span<const uint8_t> body, transport::ConnectionContext& ctx);
+    /**
+     * @brief Send a response deferred by an endpoint, then resume buffered requests.
+     */
+    void send_deferred_response(uint32_t connection_id, transport::Response response);
+    /**
+     * @brief Send queued messages while the network accepts them.
+     *
+     * If a message fails to encrypt, the queue is dropped and the context
+     * marked to close; callers close it like any other should_close().
+     * @return true if the queue is now empty
+     */
+    bool drain_outbound(uint32_t connection_id, transport::ConnectionContext& ctx);
+    void flush_events();
+    /**
+     * @brief Run work on the connection's strand (inline without a worker pool).
+     */
+    void run_on_connection(uint32_t connection_id, common::WorkerPool::Task task);
     void on_tcp_disconnect(uint32_t connection_id);
+    /**
+     * @brief Refresh the mDNS TXT records after a debounce, unless unchanged.
+     * The first registration is published immediately.
+     */
     void update_mdns();
+    /**
+     * @brief Publish the TXT records now if they differ from the last published set.
+     */
+    void publish_mdns();
     void check_and_update_config_number();
     void reset_pairing_state();
+    /**
+     * @brief Precompute SRP state for the next Pair Setup while unpaired.
+     * 
+     * Runs on the worker pool when there is one; blocks only if `allow_blocking`.
+     */
+    void prepare_pair_setup(bool allow_blocking);
 };
 
 } // namespace hap
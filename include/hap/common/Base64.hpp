@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hap::common {
+
+/**
+ * @brief Base64 (RFC 4648, padded) for data and TLV8 characteristic values.
+ * 
+ * Output is sized once up front. On x86 built with GCC or Clang, blocks of
+ * 12 input bytes (encode) or 16 characters (decode) go through SSSE3 when
+ * the CPU supports it (checked once at runtime); everything else, and the
+ * tail of every buffer, uses the scalar loop.
+ */
+
+constexpr size_t base64_encoded_size(size_t length) {
+    return (length + 2) / 3 * 4;
+}
+
+/**
+ * @brief Encode into `out`, which must hold base64_encoded_size(in.size()) chars.
+ */
+void base64_encode(std::span<const uint8_t> in, char* out);
+
+std::string base64_encode(std::span<const uint8_t> in);
+
+/**
+ * @brief Decode, skipping characters outside the alphabet (e.g. line breaks)
+ * and stopping at the first '='.
+ */
+std::vector<uint8_t> base64_decode(std::string_view in);
+
+namespace detail {
+// Scalar implementations; exposed so tests can compare against the SIMD path
+void base64_encode_scalar(const uint8_t* in, size_t length, char* out);
+size_t base64_decode_scalar(const char* in, size_t length, uint8_t* out);
+} // namespace detail
+
+} // namespace hap::common
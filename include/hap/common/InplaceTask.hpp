@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace hap::common {
+
+/**
+ * @brief Move-only void() callable with inline storage.
+ * 
+ * Callables up to Capacity bytes are stored in place, so queueing them does
+ * not touch the heap; larger ones fall back to a single allocation.
+ */
+template<size_t Capacity>
+class InplaceTask {
+public:
+    InplaceTask() = default;
+
+    template<typename F,
+             typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InplaceTask>>>
+    InplaceTask(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (fits_inline<Fn>) {
+            new (storage_) Fn(std::forward<F>(f));
+            ops_ = &InlineOps<Fn>::ops;
+        } else {
+            new (storage_) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &HeapOps<Fn>::ops;
+        }
+    }
+
+    InplaceTask(InplaceTask&& other) noexcept { take(other); }
+
+    InplaceTask& operator=(InplaceTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    InplaceTask(const InplaceTask&) = delete;
+    InplaceTask& operator=(const InplaceTask&) = delete;
+
+    ~InplaceTask() { reset(); }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+    void operator()() { ops_->invoke(storage_); }
+
+    /**
+     * @brief True if the callable lives in the inline buffer (no heap).
+     */
+    bool is_inline() const { return ops_ && !ops_->heap; }
+
+    void reset() {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src);  // Move-construct into dst, destroy src
+        void (*destroy)(void* storage);
+        bool heap;
+    };
+
+    template<typename Fn>
+    static constexpr bool fits_inline = sizeof(Fn) <= Capacity &&
+                                        alignof(Fn) <= alignof(std::max_align_t) &&
+                                        std::is_nothrow_move_constructible_v<Fn>;
+
+    template<typename Fn>
+    struct InlineOps {
+        static void invoke(void* p) { (*static_cast<Fn*>(p))(); }
+        static void move(void* dst, void* src) {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        }
+        static void destroy(void* p) { static_cast<Fn*>(p)->~Fn(); }
+        static constexpr Ops ops{invoke, move, destroy, false};
+    };
+
+    template<typename Fn>
+    struct HeapOps {
+        static void invoke(void* p) { (**static_cast<Fn**>(p))(); }
+        static void move(void* dst, void* src) { new (dst) Fn*(*static_cast<Fn**>(src)); }
+        static void destroy(void* p) { delete *static_cast<Fn**>(p); }
+        static constexpr Ops ops{invoke, move, destroy, true};
+    };
+
+    void take(InplaceTask& other) noexcept {
+        if (other.ops_) {
+            other.ops_->move(storage_, other.storage_);
+            ops_ = other.ops_;
+            other.ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[Capacity < sizeof(void*) ? sizeof(void*) : Capacity];
+    const Ops* ops_ = nullptr;
+};
+
+} // namespace hap::common
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "hap/platform/System.hpp"
+
+/**
+ * @brief Lowest log level compiled into the library.
+ *
+ * 0 = Debug, 1 = Info, 2 = Warning, 3 = Error, 4 = nothing. Statements below
+ * this level are dead code and their messages are never built. Set it with
+ * the HAP_LOG_LEVEL CMake cache variable; the default keeps Debug in builds
+ * without NDEBUG and drops it otherwise.
+ */
+#ifndef HAP_LOG_LEVEL
+#ifdef NDEBUG
+#define HAP_LOG_LEVEL 1
+#else
+#define HAP_LOG_LEVEL 0
+#endif
+#endif
+
+namespace hap::common {
+
+constexpr bool log_compiled_in(platform::System::LogLevel level) {
+    return static_cast<int>(level) >= HAP_LOG_LEVEL;
+}
+
+inline bool log_enabled(platform::System* system, platform::System::LogLevel level) {
+    return log_compiled_in(level) && level >= system->log_level();
+}
+
+} // namespace hap::common
+
+/// True when a message at `level` (Debug, Info, Warning, Error) would be emitted.
+/// Guard multi-statement formatting such as hex dumps with this.
+#define HAP_LOG_ENABLED(system, level) \
+    (::hap::common::log_compiled_in(::hap::platform::System::LogLevel::level) && \
+     ::hap::common::log_enabled((system), ::hap::platform::System::LogLevel::level))
+
+/// Log `message` only if enabled; the message expression is not evaluated otherwise
+#define HAP_LOG(system, level, message) \
+    do { \
+        if (HAP_LOG_ENABLED(system, level)) { \
+            (system)->log(::hap::platform::System::LogLevel::level, (message)); \
+        } \
+    } while (0)
+
+#define HAP_LOG_DEBUG(system, message) HAP_LOG(system, Debug, message)
+#define HAP_LOG_INFO(system, message) HAP_LOG(system, Info, message)
+#define HAP_LOG_WARNING(system, message) HAP_LOG(system, Warning, message)
+#define HAP_LOG_ERROR(system, message) HAP_LOG(system, Error, message)
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace hap::common {
+
+/**
+ * @brief Timed stages of the request and event paths.
+ */
+enum class Metric : uint8_t {
+    RequestParse,   ///< HTTP parsing of received bytes
+    RouteDispatch,  ///< Route lookup and pairing check
+    Handler,        ///< Route handler execution
+    Encrypt,        ///< Sealing one outbound message
+    Decrypt,        ///< Opening the frames of one received segment
+    PairVerify,     ///< Handling one Pair Verify message (IP or BLE)
+    EventFanout,    ///< Rendering and queueing a batch of IP events
+    BlePdu,         ///< Processing one BLE PDU write
+    SchedulerLag,   ///< Scheduled task start minus its deadline
+    Count
+};
+
+/**
+ * @brief Event counts kept alongside the latencies.
+ */
+enum class Counter : uint8_t {
+    BytesDecrypted,
+    BytesEncrypted,
+    DecryptFailures,
+    UnroutedRequests,
+    RejectedConnections,
+    TimedOutConnections,
+    PairingFastPath,
+    Count
+};
+
+const char* metric_name(Metric metric);
+const char* counter_name(Counter counter);
+
+/**
+ * @brief Latency distribution of one Metric.
+ *
+ * Bucket i holds samples in [2^(i-1), 2^i) microseconds and bucket 0 holds
+ * zero; the last bucket also takes everything slower.
+ */
+struct LatencyStats {
+    static constexpr size_t BUCKETS = 24;
+
+    uint64_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    std::array<uint64_t, BUCKETS> buckets{};
+
+    uint64_t mean_us() const { return count ? total_us / count : 0; }
+
+    /// Upper bound of the bucket holding the given percentile (0-100)
+    uint64_t percentile_us(double percentile) const;
+};
+
+/**
+ * @brief Point-in-time copy of all metrics.
+ */
+struct MetricsSnapshot {
+    std::array<LatencyStats, static_cast<size_t>(Metric::Count)> latency{};
+    std::array<uint64_t, static_cast<size_t>(Counter::Count)> counters{};
+
+    const LatencyStats& operator[](Metric metric) const { return latency[static_cast<size_t>(metric)]; }
+    uint64_t operator[](Counter counter) const { return counters[static_cast<size_t>(counter)]; }
+};
+
+/**
+ * @brief Lock-free latency histograms and counters for the hot paths.
+ *
+ * Disabled instances cost one relaxed load per probe and never read the
+ * clock. Recording is safe from any thread; the trace hook is fixed at
+ * construction and called on the recording thread, so keep it short.
+ */
+class Metrics {
+public:
+    /// Called with every recorded sample, e.g. to forward spans to a tracer
+    using TraceHook = std::function<void(Metric metric, uint64_t duration_us)>;
+
+    explicit Metrics(bool enabled = false, TraceHook trace_hook = nullptr);
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    void record(Metric metric, uint64_t duration_us);
+    void add(Counter counter, uint64_t amount = 1);
+
+    MetricsSnapshot snapshot() const;
+    void reset();
+
+    /// Monotonic microseconds used for all timings
+    static uint64_t now_us();
+
+    /**
+     * @brief Times a scope into one Metric; a null or disabled Metrics is a no-op.
+     */
+    class Scope {
+    public:
+        Scope(Metrics* metrics, Metric metric)
+            : metrics_(metrics && metrics->enabled() ? metrics : nullptr), metric_(metric),
+              start_us_(metrics_ ? now_us() : 0) {}
+        ~Scope() { stop(); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /// Record now instead of at scope exit
+        void stop() {
+            if (metrics_) {
+                metrics_->record(metric_, now_us() - start_us_);
+                metrics_ = nullptr;
+            }
+        }
+
+    private:
+        Metrics* metrics_;
+        Metric metric_;
+        uint64_t start_us_;
+    };
+
+private:
+    struct Histogram {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> total_us{0};
+        std::atomic<uint64_t> max_us{0};
+        std::array<std::atomic<uint64_t>, LatencyStats::BUCKETS> buckets{};
+    };
+
+    std::atomic<bool> enabled_;
+    TraceHook trace_hook_;
+    std::array<Histogram, static_cast<size_t>(Metric::Count)> histograms_;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::Count)> counters_{};
+};
+
+/// Adds to a counter when metrics are present and enabled
+inline void count(Metrics* metrics, Counter counter, uint64_t amount = 1) {
+    if (metrics && metrics->enabled()) {
+        metrics->add(counter, amount);
+    }
+}
+
+} // namespace hap::common
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+namespace hap::common {
+
+/**
+ * @brief Monotonic arena for objects that live for one request.
+ * 
+ * Allocations are carved from a buffer allocated once; nothing is freed
+ * individually. reset() rewinds to the start of the buffer, returning any
+ * overflow blocks to the heap, so steady-state requests that fit never
+ * touch the allocator and cannot fragment it. Not thread-safe: owned by
+ * one connection and used from its thread (or strand).
+ */
+class RequestArena {
+public:
+    explicit RequestArena(size_t initial_bytes)
+        : buffer_(std::make_unique<std::byte[]>(initial_bytes)),
+          resource_(buffer_.get(), initial_bytes, std::pmr::new_delete_resource()) {}
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &resource_; }
+
+    /// Every object allocated from the arena must already be destroyed
+    void reset() { resource_.release(); }
+
+private:
+    std::unique_ptr<std::byte[]> buffer_;
+    std::pmr::monotonic_buffer_resource resource_;
+};
+
+} // namespace hap::common
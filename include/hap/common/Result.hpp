@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
+#include <utility>
 #include <variant>
 #include <optional>
 
@@ -68,24 +70,18 @@ public:
      * @brief Create a successful result.
      */
     static Result ok(T value) {
-        Result r;
-        r.data_ = std::move(value);
-        return r;
+        return Result(std::in_place_index<0>, std::move(value));
     }
     
     /**
      * @brief Create a failed result.
      */
     static Result err(ErrorCode code, std::string message = {}) {
-        Result r;
-        r.data_ = Error{code, std::move(message)};
-        return r;
+        return Result(std::in_place_index<1>, code, std::move(message));
     }
     
     static Result err(Error e) {
-        Result r;
-        r.data_ = std::move(e);
-        return r;
+        return Result(std::in_place_index<1>, std::move(e));
     }
     
     /**
@@ -122,6 +118,11 @@ public:
         return std::get<T>(std::move(data_));
     }
     
+    [[nodiscard]] T& operator*() & { return value(); }
+    [[nodiscard]] const T& operator*() const& { return value(); }
+    [[nodiscard]] T* operator->() { return &value(); }
+    [[nodiscard]] const T* operator->() const { return &value(); }
+    
     /**
      * @brief Get the contained error. Undefined behavior if has_value().
      */
@@ -143,6 +144,11 @@ public:
     }
 
 private:
+    // Built in place, so a result costs one construction of T and no Error
+    template <size_t I, typename... Args>
+    explicit Result(std::in_place_index_t<I> index, Args&&... args)
+        : data_(index, std::forward<Args>(args)...) {}
+    
     std::variant<T, Error> data_;
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace hap::common {
+
+/**
+ * @brief Incremental 64-bit FNV-1a hash.
+ * 
+ * Fed field by field so callers can hash a structure without first
+ * serializing it into a string. Not cryptographic; digest() adds a final
+ * avalanche step so small input differences spread over all 64 bits.
+ */
+class StreamHash {
+public:
+    StreamHash& update(std::span<const uint8_t> data) {
+        for (uint8_t byte : data) {
+            state_ = (state_ ^ byte) * kPrime;
+        }
+        return *this;
+    }
+
+    /// Hash an integer as 8 little-endian bytes so field widths stay fixed
+    StreamHash& update(uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            state_ = (state_ ^ static_cast<uint8_t>(value >> (i * 8))) * kPrime;
+        }
+        return *this;
+    }
+
+    /// Hash a string with its length prefixed so adjacent fields can't merge
+    StreamHash& update(std::string_view text) {
+        update(static_cast<uint64_t>(text.size()));
+        for (char c : text) {
+            state_ = (state_ ^ static_cast<uint8_t>(c)) * kPrime;
+        }
+        return *this;
+    }
+
+    uint64_t digest() const {
+        // splitmix64 finalizer
+        uint64_t z = state_;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    static constexpr uint64_t kOffsetBasis = 0xCBF29CE484222325ull;
+    static constexpr uint64_t kPrime = 0x100000001B3ull;
+
+    uint64_t state_ = kOffsetBasis;
+};
+
+} // namespace hap::common
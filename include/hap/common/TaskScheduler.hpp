@@ -1,9 +1,12 @@
 #pragma once
 
+#include "hap/common/Metrics.hpp"
 #include "hap/platform/System.hpp"
 #include <cstdint>
 #include <functional>
 #include <mutex>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
 namespace hap::common {
@@ -26,9 +29,13 @@ namespace hap::common {
  * // In main loop
  * while (running) {
  *     scheduler.tick(system.millis());
- *     // ... other work
+ *     // ... other work, or sleep until scheduler.next_deadline_ms()
  * }
  * @endcode
+ * 
+ * Tasks are kept in a min-heap ordered by deadline, so scheduling and
+ * cancelling are O(log n) / O(1) and tick() only touches due tasks.
+ * Cancelled tasks are dropped lazily when they reach the top of the heap.
  */
 class TaskScheduler {
 public:
@@ -37,7 +44,8 @@ public:
     
     static constexpr TaskId INVALID_TASK_ID = 0;
 
-    explicit TaskScheduler(platform::System* system);
+    /// `metrics`, if given, records how late each task starts (SchedulerLag)
+    explicit TaskScheduler(platform::System* system, Metrics* metrics = nullptr);
     ~TaskScheduler() = default;
     
     TaskScheduler(const TaskScheduler&) = delete;
@@ -87,23 +95,42 @@ public:
     /**
      * @brief Get the number of currently scheduled tasks.
      */
-    [[nodiscard]] size_t task_count() const { return tasks_.size(); }
+    [[nodiscard]] size_t task_count() const;
+
+    /**
+     * @brief Time (same clock as tick()) at which the earliest task is due.
+     * Lets the host loop sleep precisely instead of polling.
+     * @return nullopt if no tasks are scheduled
+     */
+    [[nodiscard]] std::optional<uint64_t> next_deadline_ms();
 
 private:
     struct ScheduledTask {
-        TaskId id;
         TaskCallback callback;
-        uint64_t next_run_ms;
         uint32_t interval_ms;
-        bool cancelled = false;
+    };
+
+    struct Deadline {
+        uint64_t run_at_ms;
+        uint64_t sequence;   // Keeps FIFO order among tasks due at the same time
+        TaskId id;
+
+        bool operator>(const Deadline& other) const {
+            return run_at_ms != other.run_at_ms ? run_at_ms > other.run_at_ms : sequence > other.sequence;
+        }
     };
     
     platform::System* system_;
-    std::vector<ScheduledTask> tasks_;
+    Metrics* metrics_;
+    std::unordered_map<TaskId, ScheduledTask> tasks_;
+    std::vector<Deadline> heap_;  // Min-heap; entries of cancelled tasks are skipped
     TaskId next_id_ = 1;
+    uint64_t next_sequence_ = 0;
     mutable std::mutex mutex_;
     
-    void cleanup_cancelled_tasks();
+    TaskId add_task(uint64_t run_at_ms, uint32_t interval_ms, TaskCallback callback);
+    void push_deadline(uint64_t run_at_ms, TaskId id);
+    void drop_stale_deadlines();
 };
 
 } // namespace hap::common
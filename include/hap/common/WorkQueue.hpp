@@ -0,0 +1,67 @@
+#pragma once
+
+#include "hap/common/InplaceTask.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace hap::common {
+
+/**
+ * @brief Bounded lock-free multi-producer/single-consumer work queue.
+ * 
+ * Any thread (e.g. the NimBLE host task on ESP32) may push zero-delay work
+ * without taking a mutex or allocating; the owner drains it from its main
+ * loop. Uses a fixed ring of slots with per-slot sequence numbers
+ * (Vyukov's bounded queue), so push() fails instead of blocking when full.
+ */
+class WorkQueue {
+public:
+    static constexpr size_t kInlineTaskSize = 64;
+    using Task = InplaceTask<kInlineTaskSize>;
+
+    /**
+     * @param capacity Number of slots, rounded up to a power of two.
+     */
+    explicit WorkQueue(size_t capacity = 64);
+
+    WorkQueue(const WorkQueue&) = delete;
+    WorkQueue& operator=(const WorkQueue&) = delete;
+
+    /**
+     * @brief Enqueue work from any thread.
+     * @return false if the queue is full; task is left untouched so the
+     *         caller can fall back to another path
+     */
+    bool try_push(Task&& task);
+
+    /**
+     * @brief Run queued work on the consumer thread.
+     * Work pushed while draining runs on the next call.
+     * @return Number of tasks executed
+     */
+    size_t drain();
+
+    /**
+     * @brief Approximate emptiness check (exact on the consumer thread).
+     */
+    bool empty() const;
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Task task;
+    };
+
+    bool try_pop(Task& out);
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+} // namespace hap::common
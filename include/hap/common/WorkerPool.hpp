@@ -0,0 +1,69 @@
+#pragma once
+
+#include "hap/common/InplaceTask.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hap::common {
+
+/**
+ * @brief Fixed-size thread pool with strand affinity.
+ * 
+ * Every task is posted with a strand key (e.g. a connection ID). Tasks with
+ * the same key always run on the same worker, one at a time and in posting
+ * order, so per-connection state such as SecureSession nonces needs no
+ * locking. Different keys spread across workers and run in parallel.
+ * 
+ * On ESP-IDF the workers can be pinned to one core with their own stack
+ * size and priority (see Options), so crypto-heavy request handling runs
+ * beside, not on top of, the core serving the Wi-Fi/BLE stacks. Elsewhere
+ * those fields are ignored and placement is left to the OS.
+ */
+class WorkerPool {
+public:
+    using Task = InplaceTask<64>;
+
+    struct Options {
+        size_t threads = 1;
+        int core = -1;               ///< ESP-IDF: core to pin workers to, -1 for any
+        size_t stack_bytes = 0;      ///< ESP-IDF: worker stack, 0 for the pthread default
+        int priority = 0;            ///< ESP-IDF: FreeRTOS priority, 0 for the pthread default
+        const char* name = "hap_worker";
+    };
+
+    explicit WorkerPool(size_t threads);
+    explicit WorkerPool(const Options& options);
+
+    /**
+     * @brief Stops the workers after running every task already posted.
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void post(uint32_t strand, Task task);
+
+    size_t size() const { return workers_.size(); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<Task> tasks;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    static void run(Worker& worker);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+} // namespace hap::common
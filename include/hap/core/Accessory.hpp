@@ -1,6 +1,8 @@
 #pragma once
 
 #include "hap/core/Service.hpp"
+#include <functional>
+#include <span>
 #include <vector>
 #include <memory>
 
@@ -45,6 +47,14 @@ enum class AccessoryCategory : uint16_t {
     TVStreamingStick = 36
 };
 
+/**
+ * @brief One controller write handed to an accessory's batch write callback.
+ */
+struct BatchWrite {
+    std::shared_ptr<Characteristic> characteristic;
+    Value value;  // Already coerced and stored in the characteristic
+};
+
 /**
  * @brief HAP Accessory
  * 
@@ -58,6 +68,18 @@ enum class AccessoryCategory : uint16_t {
 
 class Accessory {
 public:
+    /**
+     * @brief Receives every value one HAP-IP PUT writes to this accessory.
+     * 
+     * Replaces the characteristics' own write callbacks for those writes,
+     * so a bridge can send one combined command (e.g. on + brightness +
+     * color temperature of a scene). The span is only valid during the
+     * call. Complete `done` once, from any thread, with nullopt or an error
+     * reported for every write in the batch; the PUT response waits for it
+     * like for Characteristic::set_async_write_callback().
+     */
+    using BatchWriteCallback = std::function<void(std::span<const BatchWrite> writes, WriteCompletion done)>;
+
     Accessory(uint64_t aid) : aid_(aid) {}
     virtual ~Accessory() = default;
 
@@ -71,9 +93,13 @@ public:
 
     uint64_t aid() const { return aid_; }
 
+    void set_batch_write_callback(BatchWriteCallback callback) { batch_write_callback_ = std::move(callback); }
+    const BatchWriteCallback& batch_write_callback() const { return batch_write_callback_; }
+
 private:
     uint64_t aid_;
     std::vector<std::shared_ptr<Service>> services_;
+    BatchWriteCallback batch_write_callback_;
 };
 
 } // namespace hap::core
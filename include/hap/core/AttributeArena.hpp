@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <utility>
+
+namespace hap::core {
+
+/**
+ * @brief Contiguous storage for accessory, service and characteristic nodes.
+ *
+ * Nodes made through an arena (object and shared_ptr control block together)
+ * are carved out of large blocks in creation order, so an accessory's
+ * services and characteristics sit next to each other and a database walk
+ * (JSON, hashing, indexing) touches a few cache lines instead of scattered
+ * heap chunks. Node memory is returned all at once when the last node and
+ * the last reference to the arena are gone; every node keeps its arena
+ * alive, so handing shared_ptrs around stays safe.
+ *
+ * The builder API is unchanged: while a Scope is active on a thread,
+ * make_node() (used by the characteristic factories and service builders)
+ * allocates from that arena.
+ *
+ *   auto arena = AttributeArena::create();
+ *   {
+ *       AttributeArena::Scope scope(*arena);
+ *       auto accessory = make_node<Accessory>(1);
+ *       accessory->add_service(service::LightBulbBuilder().with_brightness().build());
+ *   }
+ */
+class AttributeArena : public std::enable_shared_from_this<AttributeArena> {
+public:
+    static std::shared_ptr<AttributeArena> create(size_t block_bytes = 4096);
+
+    AttributeArena(const AttributeArena&) = delete;
+    AttributeArena& operator=(const AttributeArena&) = delete;
+
+    /**
+     * @brief Construct a node in the arena.
+     */
+    template <typename T, typename... Args>
+    std::shared_ptr<T> make(Args&&... args) {
+        return std::allocate_shared<T>(Allocator<T>(shared_from_this()), std::forward<Args>(args)...);
+    }
+
+    /// Bytes handed out to nodes so far
+    size_t bytes_used() const;
+
+    /**
+     * @brief Routes make_node() on the current thread to an arena.
+     * Scopes nest; the previous arena is restored on destruction.
+     */
+    class Scope {
+    public:
+        explicit Scope(AttributeArena& arena);
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        AttributeArena* previous_;
+    };
+
+    /// Arena of the innermost active Scope on this thread, or nullptr
+    static AttributeArena* current();
+
+private:
+    template <typename T>
+    struct Allocator {
+        using value_type = T;
+
+        explicit Allocator(std::shared_ptr<AttributeArena> arena) : arena(std::move(arena)) {}
+        template <typename U>
+        Allocator(const Allocator<U>& other) : arena(other.arena) {}
+
+        T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+        void deallocate(T*, size_t) {}  // Released with the arena
+
+        template <typename U>
+        bool operator==(const Allocator<U>& other) const { return arena == other.arena; }
+
+        std::shared_ptr<AttributeArena> arena;
+    };
+
+    explicit AttributeArena(size_t block_bytes);
+
+    void* allocate(size_t bytes, size_t alignment);
+
+    mutable std::mutex mutex_;
+    std::pmr::monotonic_buffer_resource resource_;
+    size_t bytes_used_ = 0;
+};
+
+/**
+ * @brief Make an attribute node in the current thread's arena, or on the
+ * heap when no AttributeArena::Scope is active.
+ */
+template <typename T, typename... Args>
+std::shared_ptr<T> make_node(Args&&... args) {
+    if (AttributeArena* arena = AttributeArena::current()) {
+        return arena->make<T>(std::forward<Args>(args)...);
+    }
+    return std::make_shared<T>(std::forward<Args>(args)...);
+}
+
+} // namespace hap::core
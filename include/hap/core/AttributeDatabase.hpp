@@ -1,31 +1,21 @@
 #pragma once
 
+#include "hap/common/Base64.hpp"
+#include "hap/common/StreamHash.hpp"
 #include "hap/core/Accessory.hpp"
 #include "hap/core/HAPValidation.hpp"
 #include "hap/core/IIDManager.hpp"
 #include <vector>
 #include <memory>
-#include <sstream>
-#include <iomanip>
+#include <shared_mutex>
+#include <span>
+#include <unordered_set>
+#include <algorithm>
 
 namespace hap::core {
 
 static inline std::string base64_encode(const std::vector<uint8_t>& data) {
-    static const char* encoding_table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    std::string encoded;
-    encoded.reserve(((data.size() + 2) / 3) * 4);
-    
-    for (size_t i = 0; i < data.size(); i += 3) {
-        uint32_t val = (data[i] << 16);
-        if (i + 1 < data.size()) val |= (data[i + 1] << 8);
-        if (i + 2 < data.size()) val |= data[i + 2];
-        
-        encoded.push_back(encoding_table[(val >> 18) & 0x3F]);
-        encoded.push_back(encoding_table[(val >> 12) & 0x3F]);
-        encoded.push_back(i + 1 < data.size() ? encoding_table[(val >> 6) & 0x3F] : '=');
-        encoded.push_back(i + 2 < data.size() ? encoding_table[val & 0x3F] : '=');
-    }
-    return encoded;
+    return common::base64_encode(data);
 }
 
 /**
@@ -59,75 +49,239 @@ public:
      */
     ValidationResult validate_accessory(const std::shared_ptr<Accessory>& accessory) const {
         // Check for duplicate AID (always applies)
-        for (const auto& existing : accessories_) {
-            if (existing->aid() == accessory->aid()) {
+        if (aids_.contains(accessory->aid())) {
+            return ValidationResult::DuplicateAccessoryId;
+        }
+        return validate_limits(*accessory, accessories_.size());
+    }
+
+    /**
+     * @brief Add an accessory with HAP specification validation.
+     * @param accessory The accessory to add
+     * @return ValidationResult indicating success or specific failure
+     */
+    ValidationResult add_accessory(std::shared_ptr<Accessory> accessory) {
+        return add_accessories(std::span<const std::shared_ptr<Accessory>>(&accessory, 1));
+    }
+
+    /**
+     * @brief Add several accessories as one transaction.
+     * 
+     * Every accessory is validated (including duplicate AIDs within the
+     * batch) before any is added, so either all are added or none are.
+     * IIDs are persisted with a single IIDManager::save() and the
+     * characteristic index is merged once, which keeps bridge start-up
+     * linear in the number of accessories.
+     * 
+     * @param accessories Accessories to add
+     * @return Success, or the failure of the first accessory that failed
+     */
+    ValidationResult add_accessories(std::span<const std::shared_ptr<Accessory>> accessories) {
+        std::unordered_set<uint64_t> batch_aids;
+        batch_aids.reserve(accessories.size());
+        for (size_t i = 0; i < accessories.size(); ++i) {
+            const auto& accessory = accessories[i];
+            if (aids_.contains(accessory->aid()) || !batch_aids.insert(accessory->aid()).second) {
                 return ValidationResult::DuplicateAccessoryId;
             }
+            ValidationResult result = validate_limits(*accessory, accessories_.size() + i);
+            if (result != ValidationResult::Success) {
+                return result;
+            }
         }
-        
-        // Check bridge accessory limit (only applies when adding 2nd+ accessory)
-        // HAP Spec 2.5.3.2: "A bridge must not expose more than 150 HAP accessory objects"
-        if (!accessories_.empty() && 
-            accessories_.size() >= HAPValidation::kMaxAccessoriesPerBridge) {
-            return ValidationResult::TooManyAccessories;
+        if (accessories.empty()) {
+            return ValidationResult::Success;
         }
         
-        // Check service limit - universal (HAP Spec 6.11 test 16)
-        if (accessory->services().size() > HAPValidation::kMaxServicesPerAccessory) {
-            return ValidationResult::TooManyServices;
+        for (const auto& accessory : accessories) {
+            assign_iids(accessory);
         }
-        
-        // Check characteristic limit - universal (HAP Spec 6.11 test 15)
-        for (const auto& service : accessory->services()) {
-            if (service->characteristics().size() > HAPValidation::kMaxCharacteristicsPerService) {
-                return ValidationResult::TooManyCharacteristics;
-            }
+        if (iid_manager_) {
+            iid_manager_->save();
         }
         
+        index_accessories(accessories);
+        accessories_.insert(accessories_.end(), accessories.begin(), accessories.end());
+        aids_.insert(batch_aids.begin(), batch_aids.end());
+        invalidate_json_cache();
         return ValidationResult::Success;
     }
 
+
     /**
-     * @brief Add an accessory with HAP specification validation.
-     * @param accessory The accessory to add
-     * @return ValidationResult indicating success or specific failure
+     * @brief Remove an accessory and its characteristics from the index.
+     * 
+     * The IIDManager keeps the accessory's assignments, so its IIDs are not
+     * handed to other attributes and come back unchanged if it is re-added.
+     * @return The removed accessory, or nullptr if the AID is unknown
      */
-    ValidationResult add_accessory(std::shared_ptr<Accessory> accessory) {
-        ValidationResult result = validate_accessory(accessory);
-        if (result != ValidationResult::Success) {
-            return result;
+    std::shared_ptr<Accessory> remove_accessory(uint64_t aid) {
+        auto it = std::find_if(accessories_.begin(), accessories_.end(),
+            [aid](const auto& accessory) { return accessory->aid() == aid; });
+        if (it == accessories_.end()) {
+            return nullptr;
         }
         
-        assign_iids(accessory);
-        accessories_.push_back(std::move(accessory));
-        return ValidationResult::Success;
+        std::shared_ptr<Accessory> removed = std::move(*it);
+        accessories_.erase(it);
+        aids_.erase(aid);
+        
+        // Entries stay sorted when a key range is erased
+        const uint64_t prefix = pack_key(aid, 0) >> 32;
+        std::erase_if(index_, [prefix](const IndexEntry& entry) { return (entry.key >> 32) == prefix; });
+        invalidate_json_cache();
+        return removed;
     }
 
-
     const std::vector<std::shared_ptr<Accessory>>& accessories() const {
         return accessories_;
     }
 
-    std::shared_ptr<Characteristic> find_characteristic(uint64_t aid, uint64_t iid) {
-        for (const auto& acc : accessories_) {
-            if (acc->aid() == aid) {
-                for (const auto& svc : acc->services()) {
-                    for (const auto& char_ptr : svc->characteristics()) {
-                        if (char_ptr->iid() == iid) {
-                            return char_ptr;
-                        }
-                    }
+    /**
+     * @brief Entry of the flat (aid, iid) characteristic index.
+     * Entries are kept sorted by key so lookups are a binary search over
+     * contiguous memory instead of a walk of the accessory tree.
+     */
+    struct IndexEntry {
+        uint64_t key;  ///< pack_key(aid, iid)
+        std::shared_ptr<Characteristic> characteristic;
+        std::shared_ptr<Service> service;
+    };
+
+    /**
+     * @brief Pack an accessory ID and instance ID into a single index key.
+     */
+    static constexpr uint64_t pack_key(uint64_t aid, uint64_t iid) {
+        return (aid << 32) | (iid & 0xFFFFFFFF);
+    }
+
+    /**
+     * @brief Find the index entry for a characteristic.
+     * @return Entry pointer (valid until accessories are added or removed) or nullptr
+     */
+    const IndexEntry* find_entry(uint64_t aid, uint64_t iid) const {
+        const uint64_t key = pack_key(aid, iid);
+        auto it = std::lower_bound(index_.begin(), index_.end(), key,
+            [](const IndexEntry& entry, uint64_t k) { return entry.key < k; });
+        if (it == index_.end() || it->key != key) {
+            return nullptr;
+        }
+        return &*it;
+    }
+
+    std::shared_ptr<Accessory> find_accessory(uint64_t aid) const {
+        auto it = std::find_if(accessories_.begin(), accessories_.end(),
+            [aid](const auto& accessory) { return accessory->aid() == aid; });
+        return it == accessories_.end() ? nullptr : *it;
+    }
+
+    std::shared_ptr<Characteristic> find_characteristic(uint64_t aid, uint64_t iid) const {
+        const IndexEntry* entry = find_entry(aid, iid);
+        return entry ? entry->characteristic : nullptr;
+    }
+
+    /**
+     * @brief Sorted characteristic index, shared with CharacteristicFinder.
+     */
+    const std::vector<IndexEntry>& characteristic_index() const {
+        return index_;
+    }
+
+    std::string to_json_string() const;
+
+    /**
+     * @brief Serialize the database for GET /accessories using a cached template.
+     * 
+     * Structure and metadata are rendered once and reused; only the "value"
+     * fields are read and rendered on each call. The output is identical to
+     * to_json_string(). The template is rebuilt after invalidate_json_cache().
+     */
+    std::string to_cached_json_string() const;
+
+    /**
+     * @brief Drop the cached /accessories template.
+     * Called when accessories are added and when the configuration number
+     * changes (see AccessoryServer::check_and_update_config_number).
+     */
+    void invalidate_json_cache() {
+        json_cache_.valid = false;
+    }
+
+    /**
+     * @brief Hash of the database structure for Configuration Number tracking.
+     * 
+     * Covers everything a controller caches from /accessories apart from
+     * values: AIDs, service and characteristic types, IIDs, formats,
+     * permissions and service flags/links. Streams the tree straight into
+     * the hash, so it is cheap enough to recompute after runtime changes.
+     */
+    uint64_t structure_hash() const {
+        common::StreamHash hash;
+        hash.update(static_cast<uint64_t>(accessories_.size()));
+        for (const auto& accessory : accessories_) {
+            hash.update(accessory->aid());
+            hash.update(static_cast<uint64_t>(accessory->services().size()));
+            for (const auto& service : accessory->services()) {
+                hash.update(service->type()).update(service->iid());
+                hash.update(static_cast<uint64_t>(service->is_primary() | (service->is_hidden() << 1)));
+                hash.update(static_cast<uint64_t>(service->linked_services().size()));
+                for (uint64_t linked : service->linked_services()) {
+                    hash.update(linked);
+                }
+                hash.update(static_cast<uint64_t>(service->characteristics().size()));
+                for (const auto& characteristic : service->characteristics()) {
+                    hash.update(characteristic->type()).update(characteristic->iid());
+                    hash.update(static_cast<uint64_t>(characteristic->format()));
+                    hash.update(static_cast<uint64_t>(characteristic->permissions().bits()));
                 }
             }
         }
-        return nullptr;
+        return hash.digest();
     }
 
-    std::string to_json_string() const;
+    /**
+     * @brief Reader/writer lock for multi-threaded request handling.
+     * 
+     * The database does not lock internally. When requests run on several
+     * threads (AccessoryServer::Config::worker_threads), value reads take it
+     * shared and writes, structure changes and the JSON cache take it
+     * exclusively. Application code updating values from its own thread
+     * should hold it exclusively as well.
+     */
+    std::shared_mutex& mutex() const {
+        return mutex_;
+    }
 
 private:
+    /**
+     * @brief Check HAP size limits for an accessory joining `accessory_count` others.
+     */
+    static ValidationResult validate_limits(const Accessory& accessory, size_t accessory_count) {
+        // Check bridge accessory limit (only applies when adding 2nd+ accessory)
+        // HAP Spec 2.5.3.2: "A bridge must not expose more than 150 HAP accessory objects"
+        if (accessory_count > 0 && 
+            accessory_count >= HAPValidation::kMaxAccessoriesPerBridge) {
+            return ValidationResult::TooManyAccessories;
+        }
+        
+        // Check service limit - universal (HAP Spec 6.11 test 16)
+        if (accessory.services().size() > HAPValidation::kMaxServicesPerAccessory) {
+            return ValidationResult::TooManyServices;
+        }
+        
+        // Check characteristic limit - universal (HAP Spec 6.11 test 15)
+        for (const auto& service : accessory.services()) {
+            if (service->characteristics().size() > HAPValidation::kMaxCharacteristicsPerService) {
+                return ValidationResult::TooManyCharacteristics;
+            }
+        }
+        
+        return ValidationResult::Success;
+    }
+
     /**
      * @brief Assign IIDs to all services and characteristics in an accessory.
+     * The caller persists the IIDManager once the whole batch is assigned.
      */
     void assign_iids(const std::shared_ptr<Accessory>& accessory) {
         uint64_t aid = accessory->aid();
@@ -137,11 +291,7 @@ private:
             
             if (iid_manager_) {
                 // Use IIDManager for stable IIDs
-                // Key format: "S:<type>:<aid>"
-                std::ostringstream key;
-                key << "S:" << std::hex << std::uppercase << std::setfill('0') 
-                    << std::setw(4) << (service->type() & 0xFFFF) << ":" << std::dec << aid;
-                svc_iid = iid_manager_->get_or_assign(key.str());
+                svc_iid = iid_manager_->get_or_assign(IIDManager::Key::service(aid, service->type()));
             } else {
                 // Fallback to sequential assignment
                 svc_iid = next_iid_++;
@@ -152,25 +302,52 @@ private:
                 uint16_t char_iid;
                 
                 if (iid_manager_) {
-                    // Key format: "C:<char_type>:<svc_type>:<aid>"
-                    std::ostringstream key;
-                    key << "C:" << std::hex << std::uppercase << std::setfill('0')
-                        << std::setw(4) << (characteristic->type() & 0xFFFF) << ":"
-                        << std::setw(4) << (service->type() & 0xFFFF) << ":" << std::dec << aid;
-                    char_iid = iid_manager_->get_or_assign(key.str());
+                    char_iid = iid_manager_->get_or_assign(
+                        IIDManager::Key::characteristic(aid, service->type(), characteristic->type()));
                 } else {
                     char_iid = next_iid_++;
                 }
                 characteristic->set_iid(char_iid);
             }
         }
-        
-        if (iid_manager_) {
-            iid_manager_->save();
+    }
+
+    /**
+     * @brief Add the accessories' characteristics to the sorted index.
+     * Must run after assign_iids so the keys reflect the final IIDs.
+     */
+    void index_accessories(std::span<const std::shared_ptr<Accessory>> accessories) {
+        const auto old_size = static_cast<std::ptrdiff_t>(index_.size());
+        for (const auto& accessory : accessories) {
+            for (const auto& service : accessory->services()) {
+                for (const auto& characteristic : service->characteristics()) {
+                    index_.push_back({pack_key(accessory->aid(), characteristic->iid()), characteristic, service});
+                }
+            }
         }
+        auto by_key = [](const IndexEntry& a, const IndexEntry& b) { return a.key < b.key; };
+        std::sort(index_.begin() + old_size, index_.end(), by_key);
+        std::inplace_merge(index_.begin(), index_.begin() + old_size, index_.end(), by_key);
     }
 
+    /**
+     * @brief Pre-rendered /accessories document split around value fields.
+     * segments.size() == value_slots.size() + 1 once built.
+     */
+    struct JsonCache {
+        std::vector<std::string> segments;
+        std::vector<const Characteristic*> value_slots;  // Owned by accessories_; rebuilt on structure changes
+        size_t last_size = 0;
+        bool valid = false;
+    };
+
+    void build_json_cache() const;
+
     std::vector<std::shared_ptr<Accessory>> accessories_;
+    std::unordered_set<uint64_t> aids_;  // AIDs in accessories_, for O(1) duplicate checks
+    std::vector<IndexEntry> index_;
+    mutable JsonCache json_cache_;
+    mutable std::shared_mutex mutex_;
     IIDManager* iid_manager_ = nullptr;
     uint16_t next_iid_ = 1;  // Fallback when no IIDManager
 };
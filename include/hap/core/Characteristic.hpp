@@ -1,11 +1,22 @@
 #pragma once
 
+#include "hap/common/TaskScheduler.hpp"
+#include "hap/common/WorkQueue.hpp"
+#include "hap/core/TypeString.hpp"
+#include "hap/platform/System.hpp"
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 #include <functional>
 #include <optional>
+#include <atomic>
 #include <cstdint>
+#include <bit>
+#include <initializer_list>
 #include <type_traits>
 
 namespace hap::core {
@@ -75,6 +86,110 @@ enum class Permission {
     Broadcast
 };
 
+/**
+ * @brief HAP JSON name of a format ("bool", "uint8", ...).
+ */
+constexpr std::string_view format_name(Format format) {
+    switch (format) {
+        case Format::Bool: return "bool";
+        case Format::UInt8: return "uint8";
+        case Format::UInt16: return "uint16";
+        case Format::UInt32: return "uint32";
+        case Format::UInt64: return "uint64";
+        case Format::Int: return "int";
+        case Format::Float: return "float";
+        case Format::String: return "string";
+        case Format::TLV8: return "tlv8";
+        case Format::Data: return "data";
+    }
+    return "";
+}
+
+/**
+ * @brief HAP JSON name of a permission ("pr", "pw", ...).
+ * Empty for Broadcast, a BLE-only property with no JSON representation.
+ */
+constexpr std::string_view permission_name(Permission permission) {
+    switch (permission) {
+        case Permission::PairedRead: return "pr";
+        case Permission::PairedWrite: return "pw";
+        case Permission::Notify: return "ev";
+        case Permission::AdditionalAuthorization: return "aa";
+        case Permission::TimedWrite: return "tw";
+        case Permission::Hidden: return "hd";
+        case Permission::WriteResponse: return "wr";
+        case Permission::Broadcast: return "";
+    }
+    return "";
+}
+
+/**
+ * @brief Set of HAP permissions packed one bit per Permission.
+ *
+ * Membership tests are a single AND. Iterating yields the permissions in
+ * enum order, so range-for over permissions() keeps working.
+ */
+class PermissionSet {
+public:
+    constexpr PermissionSet() = default;
+    constexpr PermissionSet(std::initializer_list<Permission> permissions) {
+        for (Permission p : permissions) bits_ |= bit(p);
+    }
+    PermissionSet(const std::vector<Permission>& permissions) {
+        for (Permission p : permissions) bits_ |= bit(p);
+    }
+
+    static constexpr PermissionSet from_bits(uint16_t bits) {
+        PermissionSet set;
+        set.bits_ = bits;
+        return set;
+    }
+
+    constexpr bool has(Permission p) const { return (bits_ & bit(p)) != 0; }
+    constexpr uint16_t bits() const { return bits_; }
+    constexpr bool empty() const { return bits_ == 0; }
+
+    /**
+     * @brief HAP-BLE Characteristic Properties (Table 7-50) for this set.
+     */
+    constexpr uint16_t ble_properties() const {
+        uint16_t props = 0;
+        if (has(Permission::AdditionalAuthorization)) props |= 0x0004;
+        if (has(Permission::TimedWrite)) props |= 0x0008;
+        if (has(Permission::PairedRead)) props |= 0x0010;
+        if (has(Permission::PairedWrite)) props |= 0x0020;
+        if (has(Permission::Hidden)) props |= 0x0040;
+        if (has(Permission::Notify)) props |= 0x0080 | 0x0100;  // Connected and disconnected events
+        if (has(Permission::Broadcast)) props |= 0x0200;
+        return props;
+    }
+
+    constexpr bool operator==(const PermissionSet&) const = default;
+
+    class iterator {
+    public:
+        constexpr iterator(uint16_t remaining) : remaining_(remaining) {}
+        constexpr Permission operator*() const {
+            return static_cast<Permission>(std::countr_zero(remaining_));
+        }
+        constexpr iterator& operator++() {
+            remaining_ &= static_cast<uint16_t>(remaining_ - 1);
+            return *this;
+        }
+        constexpr bool operator!=(const iterator& other) const { return remaining_ != other.remaining_; }
+    private:
+        uint16_t remaining_;
+    };
+
+    constexpr iterator begin() const { return iterator(bits_); }
+    constexpr iterator end() const { return iterator(0); }
+
+private:
+    uint16_t bits_ = 0;
+
+    static constexpr uint16_t bit(Permission p) { return static_cast<uint16_t>(1u << static_cast<unsigned>(p)); }
+};
+
 /**
  * @brief HAP Characteristic Value
  */
@@ -90,12 +205,83 @@ using Value = std::variant<
     std::vector<uint8_t>
 >;
 
+/**
+ * @brief Optional HAP metadata of a characteristic (units, ranges, lengths).
+ *
+ * Immutable once attached and shared by every characteristic of the same
+ * kind: the factories in CharacteristicTypes.cpp hand out one static
+ * instance per type. The per-field setters on Characteristic copy it first.
+ */
+struct CharacteristicMetadata {
+    std::optional<std::string> unit{};              // e.g., "celsius", "percentage"
+    std::optional<double> min_value{};              // Minimum value
+    std::optional<double> max_value{};              // Maximum value
+    std::optional<double> min_step{};               // Minimum step value
+    std::optional<uint32_t> max_len{};              // Max length for strings
+    std::optional<uint32_t> max_data_len{};         // Max length for TLV8/data
+    std::optional<std::string> description{};       // Human-readable description
+    std::optional<std::vector<double>> valid_values{};  // Valid values (enum)
+    std::optional<std::pair<double, double>> valid_values_range{}; // Valid values range
+};
+
+/**
+ * @brief When value changes of a characteristic produce events.
+ *
+ * Evaluated in Characteristic before the event callback runs, so filtered
+ * updates never reach the BLE/IP fan-out. The stored value is always
+ * updated; only the notification is skipped.
+ */
+struct NotifyPolicy {
+    bool suppress_unchanged = false;  // No event when the value equals the last one sent
+    bool respect_min_step = false;    // No event for numeric changes smaller than min_step
+    uint32_t min_interval_ms = 0;     // At most one event per interval; 0 disables
+};
+
 /// Result of reading a characteristic - either a Value or an error status
 using ReadResponse = HAPResponse<Value>;
 
 /// Result of writing a characteristic - nullopt means success, HAPStatus means failure
 using WriteResponse = std::optional<HAPStatus>;
 
+/**
+ * @brief One-shot completion handle for asynchronous characteristic callbacks.
+ *
+ * Copies share one slot and only the first call is delivered, so a device
+ * reply arriving after the request timed out is dropped. May be called
+ * from any thread, including from inside the callback itself.
+ */
+template<typename Result>
+class Completion {
+public:
+    using Handler = std::function<void(Result)>;
+
+    Completion() = default;
+    explicit Completion(Handler handler) : state_(std::make_shared<State>(std::move(handler))) {}
+
+    void operator()(Result result) const {
+        if (!state_ || state_->done.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        // Released before running so handlers holding a copy don't form a cycle
+        Handler handler = std::move(state_->handler);
+        state_->handler = nullptr;
+        if (handler) handler(std::move(result));
+    }
+
+    bool done() const { return !state_ || state_->done.load(std::memory_order_acquire); }
+
+private:
+    struct State {
+        explicit State(Handler h) : handler(std::move(h)) {}
+        Handler handler;
+        std::atomic<bool> done{false};
+    };
+    std::shared_ptr<State> state_;
+};
+
+using ReadCompletion = Completion<ReadResponse>;
+using WriteCompletion = Completion<WriteResponse>;
+
 /**
  * @brief HAP Characteristic
  */
@@ -126,14 +312,49 @@ public:
      */
     using WriteResponseCallback = std::function<HAPResponse<Value>(const Value&)>;
 
-    Characteristic(uint64_t type, Format format, std::vector<Permission> permissions)
-        : type_(type), format_(format), permissions_(std::move(permissions)) {}
+    /**
+     * @brief Asynchronous read for values behind slow links (e.g. bridged
+     * Zigbee/Modbus devices). Call the completion once the value is known.
+     *
+     * HAP-IP GET /characteristics defers its response until every async
+     * read of the request completes or AccessoryServer::Config::
+     * async_timeout_ms passes (ServiceCommunicationFailure). Synchronous
+     * readers (/accessories, BLE) serve the last stored value instead.
+     */
+    using AsyncReadCallback = std::function<void(ReadCompletion)>;
+
+    /**
+     * @brief Asynchronous write; the completion reports the device's answer.
+     *
+     * HAP-IP PUT /characteristics waits for it like async reads. Writes
+     * through set_value() (e.g. BLE) start it without waiting for the result.
+     */
+    using AsyncWriteCallback = std::function<void(const Value&, WriteCompletion)>;
+
+    Characteristic(uint64_t type, Format format, PermissionSet permissions)
+        : type_(type), format_(format), permissions_(permissions),
+          ble_properties_(permissions.ble_properties()),
+          type_string_(intern_type_string(type)),
+          perms_json_(intern_perms_json(permissions.bits())) {}
+
+    Characteristic(uint64_t type, Format format, std::initializer_list<Permission> permissions)
+        : Characteristic(type, format, PermissionSet(permissions)) {}
+
+    Characteristic(uint64_t type, Format format, const std::vector<Permission>& permissions)
+        : Characteristic(type, format, PermissionSet(permissions)) {}
 
     virtual ~Characteristic() = default;
 
     uint64_t type() const { return type_; }
+    /// Interned uppercase hex type for JSON ("25")
+    std::string_view type_string() const { return type_string_; }
+    /// Interned JSON "perms" array ('["pr","ev"]')
+    std::string_view perms_json() const { return perms_json_; }
     Format format() const { return format_; }
-    const std::vector<Permission>& permissions() const { return permissions_; }
+    PermissionSet permissions() const { return permissions_; }
+    bool has_permission(Permission perm) const { return permissions_.has(perm); }
+    /// HAP-BLE Characteristic Properties, computed once from the permissions
+    uint16_t ble_properties() const { return ble_properties_; }
     uint64_t iid() const { return iid_; }
     void set_iid(uint64_t iid) { iid_ = iid; }
 
@@ -143,8 +364,10 @@ public:
      * When set, callbacks will be dispatched through this function rather
      * than executed immediately. This solves stack overflow issues on
      * constrained platforms like ESP32 where GATT callbacks have limited stack.
+     * Work is handed over as a common::WorkQueue::Task, which stores the
+     * event closure inline so dispatching does not allocate.
      */
-    using DispatcherFunc = std::function<void(std::function<void()>)>;
+    using DispatcherFunc = std::function<void(common::WorkQueue::Task)>;
     
     /**
      * @brief Set the global dispatcher for all characteristic callbacks.
@@ -155,6 +378,65 @@ public:
     static void set_dispatcher(DispatcherFunc dispatcher) {
         dispatcher_ = std::move(dispatcher);
     }
+
+    /**
+     * @brief Set the clock and scheduler for time-based features.
+     *
+     * Used by NotifyPolicy::min_interval_ms (held-back updates are sent
+     * through `scheduler` once the interval elapses) and by the read cache.
+     * Without a system clock neither is enforced. AccessoryServer installs
+     * its own; pass nullptrs to detach.
+     *
+     * `database_mutex` is the lock writers hold around values (the
+     * AttributeDatabase's); held-back updates take it exclusively before
+     * reading the value from the scheduler's thread.
+     */
+    static void set_scheduler(common::TaskScheduler* scheduler, platform::System* system,
+                              std::shared_mutex* database_mutex = nullptr) {
+        scheduler_ = scheduler;
+        system_ = system;
+        database_mutex_ = database_mutex;
+    }
+
+    /**
+     * @brief Filter events of noisy updates (e.g. sensors polled in a loop).
+     */
+    void set_notify_policy(NotifyPolicy policy) {
+        if (!notify_) {
+            notify_ = std::make_shared<NotifyState>();
+            notify_->owner = this;
+        }
+        notify_->policy = policy;
+    }
+
+    /**
+     * @brief Cache the read callback's result for `ttl_ms` (0 disables).
+     *
+     * Reads within the TTL (GET, /accessories, BLE) serve the cached value
+     * instead of calling the callback, e.g. for sensors on a slow bus. Once
+     * half the TTL has passed, a read also queues a refresh on the
+     * scheduler so frequently read values rarely block on the callback.
+     * Writes from controllers invalidate the cache.
+     */
+    void set_read_cache_ttl(uint32_t ttl_ms) {
+        if (ttl_ms == 0) {
+            read_cache_.reset();
+            return;
+        }
+        if (!read_cache_) {
+            read_cache_ = std::make_shared<ReadCache>();
+            read_cache_->owner = this;
+        }
+        std::lock_guard<std::mutex> lock(read_cache_->mutex);
+        read_cache_->ttl_ms = ttl_ms;
+        read_cache_->fetched_ms.reset();
+    }
+
+    void invalidate_read_cache() {
+        if (!read_cache_) return;
+        std::lock_guard<std::mutex> lock(read_cache_->mutex);
+        read_cache_->fetched_ms.reset();
+    }
     
     /**
      * @brief Set the characteristic value.
@@ -164,28 +446,38 @@ public:
      */
     WriteResponse set_value(Value value, EventSource source = {}) {
         value_ = coerce_value(std::move(value));
-        
-        WriteResponse result = std::nullopt; // Success by default
-        
-        if (write_callback_ && source.type == EventSource::Type::Connection) {
-            // Synchronous callback - captures result
-            result = write_callback_(value_);
-            if (result.has_value()) {
-                return result; // Return error immediately
-            }
+        return commit(source);
+    }
+
+    /**
+     * @brief Store a controller write without running write callbacks.
+     * Used when the owning accessory's batch write callback handles it.
+     */
+    void store_value(Value value) {
+        value_ = coerce_value(std::move(value));
+        invalidate_read_cache();
+    }
+
+    /**
+     * @brief Typed write that skips variant coercion.
+     *
+     * T must be one of the Value alternatives; anything else fails to
+     * compile. When T is the type this characteristic's format stores
+     * (e.g. int32_t for Format::Int), the value is assigned in place;
+     * otherwise it is coerced like set_value().
+     */
+    template<typename T>
+    WriteResponse set(T value, EventSource source = {}) {
+        static_assert(is_value_type_v<T>, "set<T>() requires one of the Value alternative types");
+        if (!stores<T>(format_)) [[unlikely]] {
+            return set_value(Value(std::move(value)), source);
         }
-        
-        if (dispatcher_) {
-            Value captured_value = value_;
-            if (event_callback_ && source.type == EventSource::Type::NotifyChange) {
-                auto cb = event_callback_;
-                dispatcher_([cb, captured_value, source]() { cb(captured_value, source); });
-            }
+        if (T* current = std::get_if<T>(&value_)) {
+            *current = std::move(value);
         } else {
-            if (event_callback_ && source.type == EventSource::Type::NotifyChange) event_callback_(value_, source);
+            value_.template emplace<T>(std::move(value));
         }
-        
-        return result;
+        return commit(source);
     }
 
     /**
@@ -193,8 +485,11 @@ public:
      * @return Value on success, or HAPStatus error code if read callback fails.
      */
     ReadResponse get_value() const {
-        if (read_cb_) {
-            auto result = read_cb_();
+        if (callbacks_ && callbacks_->read) {
+            if (read_cache_ && system_) {
+                return read_cached();
+            }
+            auto result = callbacks_->read();
             // If callback returned a Value, coerce it
             if (std::holds_alternative<Value>(result)) {
                 return coerce_value(std::get<Value>(result));
@@ -205,66 +500,397 @@ public:
         return value_;
     }
 
-    void on_read(ReadCallback cb) { read_cb_ = std::move(cb); }
-    void set_write_callback(WriteCallback callback) { write_callback_ = std::move(callback); }
-    void set_event_callback(EventCallback callback) { event_callback_ = std::move(callback); }
-    void set_write_response_callback(WriteResponseCallback callback) { write_response_callback_ = std::move(callback); }
+    /**
+     * @brief Read without copying the stored value.
+     *
+     * Without a read callback this points at the stored value. With one,
+     * the callback's result, or a copy of the read cache's value while it
+     * is fresh, goes into scratch and the pointer refers to it. The pointer
+     * is valid until the next write or scratch reuse.
+     */
+    HAPResponse<const Value*> read_value(Value& scratch) const {
+        if (callbacks_ && callbacks_->read) {
+            if (read_cache_ && system_) {
+                auto cached = read_cached();
+                if (auto* status = std::get_if<HAPStatus>(&cached)) return *status;
+                scratch = std::move(std::get<Value>(cached));
+                return &scratch;
+            }
+            auto result = callbacks_->read();
+            if (auto* status = std::get_if<HAPStatus>(&result)) {
+                return *status;
+            }
+            scratch = coerce_value(std::move(std::get<Value>(result)));
+            return &scratch;
+        }
+        return &value_;
+    }
+
+    /**
+     * @brief Read through the async callback if there is one.
+     *
+     * `done` receives the coerced result, synchronously when the
+     * characteristic has no async read callback.
+     */
+    void read_async(ReadCompletion done) const {
+        if (!callbacks_ || !callbacks_->read_async) {
+            done(get_value());
+            return;
+        }
+        callbacks_->read_async(ReadCompletion([format = format_, done](ReadResponse result) {
+            if (auto* value = std::get_if<Value>(&result)) {
+                done(coerce_value(std::move(*value), format));
+            } else {
+                done(std::move(result));
+            }
+        }));
+    }
+
+    /**
+     * @brief Store a value and run the write callback, waiting for an async one.
+     *
+     * Behaves like set_value() when there is no async write callback or the
+     * write does not come from a connection.
+     */
+    void write_async(Value value, EventSource source, WriteCompletion done) {
+        value_ = coerce_value(std::move(value));
+        if (source.type == EventSource::Type::Connection && callbacks_ && callbacks_->write_async) {
+            invalidate_read_cache();
+            callbacks_->write_async(value_, std::move(done));
+            return;
+        }
+        done(commit(source));
+    }
+
+    /**
+     * @brief Typed read.
+     *
+     * Goes through the read callback if one is set. Returns
+     * InvalidValueInRequest when the value does not hold T.
+     */
+    template<typename T>
+    HAPResponse<T> get() const {
+        static_assert(is_value_type_v<T>, "get<T>() requires one of the Value alternative types");
+        Value scratch;
+        auto result = read_value(scratch);
+        if (auto* status = std::get_if<HAPStatus>(&result)) {
+            return *status;
+        }
+        if (const T* typed = std::get_if<T>(std::get<const Value*>(result))) {
+            return *typed;
+        }
+        return invalid_value_status();
+    }
+
+    /// Stored value, ignoring any read callback
+    const Value& value() const { return value_; }
+
+    void on_read(ReadCallback cb) { callbacks().read = std::move(cb); }
+    void set_write_callback(WriteCallback callback) { callbacks().write = std::move(callback); }
+    void set_event_callback(EventCallback callback) {
+        callbacks().event = callback ? std::make_shared<const EventCallback>(std::move(callback)) : nullptr;
+    }
+    void set_write_response_callback(WriteResponseCallback callback) { callbacks().write_response = std::move(callback); }
+    void on_read_async(AsyncReadCallback cb) { callbacks().read_async = std::move(cb); }
+    void set_async_write_callback(AsyncWriteCallback callback) { callbacks().write_async = std::move(callback); }
+    bool has_async_read() const { return callbacks_ && callbacks_->read_async; }
+    bool has_async_write() const { return callbacks_ && callbacks_->write_async; }
     
     /**
      * @brief Handle write-with-response by invoking callback.
      * @return Response from callback (Value or HAPStatus), or nullopt if no callback set.
      */
     std::optional<HAPResponse<Value>> handle_write_response(const Value& input) {
-        if (write_response_callback_) {
-            return write_response_callback_(input);
+        if (callbacks_ && callbacks_->write_response) {
+            return callbacks_->write_response(input);
         }
         return std::nullopt;
     }
     
-    void set_unit(std::string unit) { unit_ = std::move(unit); }
-    void set_min_value(double min) { min_value_ = min; }
-    void set_max_value(double max) { max_value_ = max; }
-    void set_min_step(double step) { min_step_ = step; }
-    void set_max_len(uint32_t len) { max_len_ = len; }
-    void set_max_data_len(uint32_t len) { max_data_len_ = len; }
-    void set_description(std::string desc) { description_ = std::move(desc); }
-    void set_valid_values(std::vector<double> values) { valid_values_ = std::move(values); }
-    void set_valid_values_range(double start, double end) { valid_values_range_ = std::make_pair(start, end); }
+    /// Attach shared metadata, replacing any set field by field
+    void set_metadata(std::shared_ptr<const CharacteristicMetadata> metadata) { metadata_ = std::move(metadata); }
+    const CharacteristicMetadata& metadata() const { return metadata_ ? *metadata_ : kNoMetadata; }
+    
+    void set_unit(std::string unit) { edit_metadata().unit = std::move(unit); }
+    void set_min_value(double min) { edit_metadata().min_value = min; }
+    void set_max_value(double max) { edit_metadata().max_value = max; }
+    void set_min_step(double step) { edit_metadata().min_step = step; }
+    void set_max_len(uint32_t len) { edit_metadata().max_len = len; }
+    void set_max_data_len(uint32_t len) { edit_metadata().max_data_len = len; }
+    void set_description(std::string desc) { edit_metadata().description = std::move(desc); }
+    void set_valid_values(std::vector<double> values) { edit_metadata().valid_values = std::move(values); }
+    void set_valid_values_range(double start, double end) { edit_metadata().valid_values_range = std::make_pair(start, end); }
     
-    const std::optional<std::string>& unit() const { return unit_; }
-    const std::optional<double>& min_value() const { return min_value_; }
-    const std::optional<double>& max_value() const { return max_value_; }
-    const std::optional<double>& min_step() const { return min_step_; }
-    const std::optional<uint32_t>& max_len() const { return max_len_; }
-    const std::optional<uint32_t>& max_data_len() const { return max_data_len_; }
-    const std::optional<std::string>& description() const { return description_; }
-    const std::optional<std::vector<double>>& valid_values() const { return valid_values_; }
-    const std::optional<std::pair<double, double>>& valid_values_range() const { return valid_values_range_; }
+    const std::optional<std::string>& unit() const { return metadata().unit; }
+    const std::optional<double>& min_value() const { return metadata().min_value; }
+    const std::optional<double>& max_value() const { return metadata().max_value; }
+    const std::optional<double>& min_step() const { return metadata().min_step; }
+    const std::optional<uint32_t>& max_len() const { return metadata().max_len; }
+    const std::optional<uint32_t>& max_data_len() const { return metadata().max_data_len; }
+    const std::optional<std::string>& description() const { return metadata().description; }
+    const std::optional<std::vector<double>>& valid_values() const { return metadata().valid_values; }
+    const std::optional<std::pair<double, double>>& valid_values_range() const { return metadata().valid_values_range; }
 
 private:
     uint64_t type_;
     Format format_;
-    std::vector<Permission> permissions_;
+    PermissionSet permissions_;
+    uint16_t ble_properties_;
+    std::string_view type_string_;
+    std::string_view perms_json_;
     uint64_t iid_ = 0;
     
     Value value_;
     
-    ReadCallback read_cb_;
-    WriteCallback write_callback_;
-    EventCallback event_callback_;
-    WriteResponseCallback write_response_callback_;
+    // Most characteristics have no callbacks at all, so they live behind
+    // one pointer that the first setter allocates
+    struct Callbacks {
+        ReadCallback read;
+        WriteCallback write;
+        std::shared_ptr<const EventCallback> event;
+        WriteResponseCallback write_response;
+        AsyncReadCallback read_async;
+        AsyncWriteCallback write_async;
+    };
+    std::unique_ptr<Callbacks> callbacks_;
+    
+    std::shared_ptr<const CharacteristicMetadata> metadata_;  // Null when there is none
     
-    std::optional<std::string> unit_;              // e.g., "celsius", "percentage"
-    std::optional<double> min_value_;              // Minimum value
-    std::optional<double> max_value_;              // Maximum value
-    std::optional<double> min_step_;               // Minimum step value
-    std::optional<uint32_t> max_len_;              // Max length for strings
-    std::optional<uint32_t> max_data_len_;         // Max length for TLV8/data
-    std::optional<std::string> description_;       // Human-readable description
-    std::optional<std::vector<double>> valid_values_;  // Valid values (enum)
-    std::optional<std::pair<double, double>> valid_values_range_; // Valid values range
+    // Allocated by set_notify_policy(); shared so a pending interval task
+    // can tell whether the characteristic still exists
+    struct NotifyState {
+        NotifyPolicy policy;
+        Characteristic* owner = nullptr;
+        std::optional<Value> last_sent;
+        std::optional<uint64_t> last_sent_ms;  // Unset when no clock was installed
+        bool flush_scheduled = false;
+    };
+    std::shared_ptr<NotifyState> notify_;
+    
+    // Allocated by set_read_cache_ttl(); shared for the same reason
+    struct ReadCache {
+        uint32_t ttl_ms = 0;
+        Characteristic* owner = nullptr;
+        Value value;
+        std::optional<uint64_t> fetched_ms;  // Unset while there is no valid value
+        bool refresh_scheduled = false;
+        // Readers hold only a shared database lock and refreshes run on the
+        // scheduler, so the fields above are guarded here; readers get copies
+        std::mutex mutex;
+    };
+    std::shared_ptr<ReadCache> read_cache_;
+    
+    static inline const CharacteristicMetadata kNoMetadata{};
+    
+    Callbacks& callbacks() {
+        if (!callbacks_) {
+            callbacks_ = std::make_unique<Callbacks>();
+        }
+        return *callbacks_;
+    }
+    
+    // Copy-on-write: attached metadata may be shared with other characteristics
+    CharacteristicMetadata& edit_metadata() {
+        auto copy = metadata_ ? std::make_shared<CharacteristicMetadata>(*metadata_)
+                              : std::make_shared<CharacteristicMetadata>();
+        CharacteristicMetadata& fields = *copy;
+        metadata_ = std::move(copy);
+        return fields;
+    }
     
     static inline DispatcherFunc dispatcher_;
+    static inline common::TaskScheduler* scheduler_ = nullptr;
+    static inline platform::System* system_ = nullptr;
+    static inline std::shared_mutex* database_mutex_ = nullptr;
+
+    template<typename T>
+    static constexpr bool is_value_type_v =
+        std::is_same_v<T, bool> || std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> ||
+        std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t> || std::is_same_v<T, int32_t> ||
+        std::is_same_v<T, float> || std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>;
+
+    /// Whether T is the alternative coerce_value() keeps for this format
+    template<typename T>
+    static constexpr bool stores(Format format) {
+        switch (format) {
+            case Format::Bool: return std::is_same_v<T, bool>;
+            case Format::UInt8: return std::is_same_v<T, uint8_t>;
+            case Format::UInt16: return std::is_same_v<T, uint16_t>;
+            case Format::UInt32: return std::is_same_v<T, uint32_t>;
+            case Format::UInt64: return std::is_same_v<T, uint64_t>;
+            case Format::Int: return std::is_same_v<T, int32_t>;
+            case Format::Float: return std::is_same_v<T, float>;
+            case Format::String: return std::is_same_v<T, std::string>;
+            case Format::TLV8:
+            case Format::Data: return std::is_same_v<T, std::vector<uint8_t>>;
+        }
+        return false;
+    }
+
+    // HAPStatus is only forward declared here
+    static HAPStatus invalid_value_status() { return static_cast<HAPStatus>(-70410); }
+
+    /// Runs the write and event callbacks for a value already stored in value_
+    WriteResponse commit(const EventSource& source) {
+        WriteResponse result = std::nullopt; // Success by default
+        
+        if (source.type == EventSource::Type::Connection) {
+            invalidate_read_cache();
+        }
+        
+        if (!callbacks_) {
+            return result;
+        }
+        
+        if (callbacks_->write && source.type == EventSource::Type::Connection) {
+            // Synchronous callback - captures result
+            result = callbacks_->write(value_);
+            if (result.has_value()) {
+                return result; // Return error immediately
+            }
+        } else if (callbacks_->write_async && source.type == EventSource::Type::Connection) {
+            // Callers without a completion can't wait, so the result is dropped
+            callbacks_->write_async(value_, WriteCompletion());
+        }
+        
+        if (callbacks_->event && source.type == EventSource::Type::NotifyChange &&
+            (!notify_ || admit_notification())) {
+            emit_event(source);
+        }
+        
+        return result;
+    }
+
+    void emit_event(const EventSource& source) {
+        const auto& event_callback = callbacks_->event;
+        if (dispatcher_) {
+            // Shares the callback instead of copying the std::function
+            dispatcher_([cb = event_callback, captured_value = value_, source]() {
+                (*cb)(captured_value, source);
+            });
+        } else {
+            (*event_callback)(value_, source);
+        }
+    }
+
+    /// Applies the NotifyPolicy to value_ and records it as sent if admitted
+    bool admit_notification() {
+        NotifyState& state = *notify_;
+        const NotifyPolicy& policy = state.policy;
+        if (state.last_sent) {
+            if (policy.suppress_unchanged && *state.last_sent == value_) {
+                return false;
+            }
+            if (policy.respect_min_step && below_min_step(*state.last_sent)) {
+                return false;
+            }
+        }
+        if (system_) {
+            uint64_t now = system_->millis();
+            if (policy.min_interval_ms != 0 && state.last_sent_ms) {
+                uint64_t elapsed = now - *state.last_sent_ms;
+                if (elapsed < policy.min_interval_ms) {
+                    schedule_flush(static_cast<uint32_t>(policy.min_interval_ms - elapsed));
+                    return false;
+                }
+            }
+            state.last_sent_ms = now;
+        }
+        state.last_sent = value_;
+        return true;
+    }
+
+    ReadResponse read_cached() const {
+        ReadCache& cache = *read_cache_;
+        uint64_t now = system_->millis();
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            if (cache.fetched_ms) {
+                uint64_t age = now - *cache.fetched_ms;
+                if (age < cache.ttl_ms) {
+                    if (age >= cache.ttl_ms / 2) {
+                        schedule_refresh(cache);
+                    }
+                    return cache.value;
+                }
+            }
+        }
+        return refresh_cache(cache, now);
+    }
+
+    /// Calls the read callback (without the cache lock) into the cache;
+    /// errors leave it untouched
+    ReadResponse refresh_cache(ReadCache& cache, uint64_t now) const {
+        auto result = callbacks_->read();
+        if (auto* status = std::get_if<HAPStatus>(&result)) {
+            return *status;
+        }
+        Value value = coerce_value(std::move(std::get<Value>(result)));
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        cache.value = value;
+        cache.fetched_ms = now;
+        return value;
+    }
+
+    /// Expects cache.mutex held
+    void schedule_refresh(ReadCache& cache) const {
+        if (!scheduler_ || cache.refresh_scheduled) {
+            return;
+        }
+        cache.refresh_scheduled = true;
+        scheduler_->schedule_once(0, [weak = std::weak_ptr<ReadCache>(read_cache_)]() {
+            auto cache = weak.lock();
+            if (!cache) {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(cache->mutex);
+                cache->refresh_scheduled = false;
+            }
+            const Characteristic& self = *cache->owner;
+            if (self.callbacks_ && self.callbacks_->read && system_) {
+                self.refresh_cache(*cache, system_->millis());
+            }
+        });
+    }
+
+    bool below_min_step(const Value& last) const {
+        const auto& step = metadata().min_step;
+        if (!step || last.index() != value_.index()) {
+            return false;
+        }
+        return std::visit([&last, step = *step](const auto& current) {
+            using T = std::decay_t<decltype(current)>;
+            if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+                double delta = static_cast<double>(current) - static_cast<double>(std::get<T>(last));
+                return (delta < 0 ? -delta : delta) < step;
+            } else {
+                return false;
+            }
+        }, value_);
+    }
+
+    // Sends the latest value once the interval is over, unless the policy
+    // filters it by then (e.g. it went back to the last sent value)
+    void schedule_flush(uint32_t delay_ms) {
+        if (!scheduler_ || notify_->flush_scheduled) {
+            return;
+        }
+        notify_->flush_scheduled = true;
+        scheduler_->schedule_once(delay_ms, [weak = std::weak_ptr<NotifyState>(notify_)]() {
+            auto state = weak.lock();
+            if (!state) {
+                return;
+            }
+            std::unique_lock<std::shared_mutex> lock;
+            if (database_mutex_) lock = std::unique_lock<std::shared_mutex>(*database_mutex_);
+            state->flush_scheduled = false;
+            Characteristic& self = *state->owner;
+            if (self.callbacks_ && self.callbacks_->event && self.admit_notification()) {
+                self.emit_event({});
+            }
+        });
+    }
     
     /**
      * @brief Coerces a value to the correct variant type based on format_
@@ -273,11 +899,15 @@ private:
      * without needing explicit casts like static_cast<uint8_t>(0).
      */
     Value coerce_value(Value input) const {
-        return std::visit([this, &input](auto&& arg) -> Value {
+        return coerce_value(std::move(input), format_);
+    }
+
+    static Value coerce_value(Value input, Format format) {
+        return std::visit([format, &input](auto&& arg) -> Value {
             using T = std::decay_t<decltype(arg)>;
             
             if constexpr (std::is_arithmetic_v<T>) {
-                switch (format_) {
+                switch (format) {
                     case Format::Bool:
                         return static_cast<bool>(arg);
                     case Format::UInt8:
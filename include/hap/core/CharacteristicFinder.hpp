@@ -2,6 +2,7 @@
 
 #include "hap/core/AttributeDatabase.hpp"
 #include <memory>
+#include <vector>
 
 namespace hap::core {
 
@@ -9,11 +10,19 @@ namespace hap::core {
  * @brief Utility for finding characteristics and services in the database.
  * 
  * Provides centralized lookup methods to avoid duplicating search logic
- * across transport layers.
+ * across transport layers. IID lookups are served from tables built once
+ * at construction (or by rebuild()), so a finder should be kept around
+ * rather than created per request.
  */
 class CharacteristicFinder {
 public:
     explicit CharacteristicFinder(const AttributeDatabase& database);
+
+    /**
+     * @brief Re-index the database.
+     * Must be called after accessories are added to the database.
+     */
+    void rebuild();
     
     /**
      * @brief Find a characteristic by its instance ID.
@@ -57,9 +66,30 @@ public:
      * @brief Find characteristic info by IID.
      */
     [[nodiscard]] CharacteristicInfo find_info(uint16_t iid) const;
+    
+    /**
+     * @brief Find characteristic info by IID without copying it.
+     * For hot paths: no reference counts are touched. The pointer is valid
+     * until the next rebuild().
+     * @return Info pointer or nullptr if not found
+     */
+    [[nodiscard]] const CharacteristicInfo* lookup(uint16_t iid) const;
 
 private:
+    struct CharacteristicEntry {
+        uint16_t iid;
+        CharacteristicInfo info;
+    };
+    struct ServiceEntry {
+        uint16_t iid;
+        std::shared_ptr<Service> service;
+    };
+
+    const CharacteristicEntry* find_entry(uint16_t iid) const;
+
     const AttributeDatabase& database_;
+    std::vector<CharacteristicEntry> characteristics_;  // Sorted by iid
+    std::vector<ServiceEntry> services_;                // Sorted by iid
 };
 
 } // namespace hap::core
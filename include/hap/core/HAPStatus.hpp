@@ -39,6 +39,10 @@ inline int32_t to_int(HAPStatus status) {
 /**
  * @brief Check if a characteristic has a specific permission
  */
+inline bool has_permission(PermissionSet perms, Permission perm) {
+    return perms.has(perm);
+}
+
 inline bool has_permission(const std::vector<Permission>& perms, Permission perm) {
     return std::find(perms.begin(), perms.end(), perm) != perms.end();
 }
@@ -2,8 +2,13 @@
 
 #include "hap/platform/Storage.hpp"
 #include "hap/platform/System.hpp"
+#include <compare>
 #include <map>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <cstdint>
 
 namespace hap::core {
@@ -15,22 +20,65 @@ namespace hap::core {
  * - IIDs must be stable across reboots while paired
  * - IIDs for removed attributes must not be reused while paired
  * - Provides hash-based tracking for Configuration Number updates
+ * 
+ * Assignments are persisted as packed binary records in two storage keys:
+ * a snapshot of the whole map and a journal holding only the records
+ * assigned since the snapshot was written. save() rewrites the (small)
+ * journal and folds it into the snapshot once it grows past
+ * kCompactThreshold records, so adding an accessory to a large bridge
+ * does not rewrite every existing assignment.
  */
 class IIDManager {
 public:
+    /**
+     * @brief Identity of an attribute whose IID must stay stable.
+     * 
+     * Types are the 16-bit short form of the HAP UUID. Accessory services
+     * and characteristics are scoped by AID; transport-owned BLE services
+     * (pairing, protocol information) have no AID.
+     */
+    struct Key {
+        enum class Kind : uint8_t {
+            Service = 1,
+            Characteristic = 2,
+            BleService = 3,
+            BleCharacteristic = 4
+        };
+        
+        Kind kind = Kind::Service;
+        uint16_t type = 0;
+        uint16_t service_type = 0;  // Characteristic kinds only
+        uint64_t aid = 0;           // Accessory kinds only
+        
+        static Key service(uint64_t aid, uint64_t type) {
+            return {Kind::Service, static_cast<uint16_t>(type & 0xFFFF), 0, aid};
+        }
+        static Key characteristic(uint64_t aid, uint64_t service_type, uint64_t type) {
+            return {Kind::Characteristic, static_cast<uint16_t>(type & 0xFFFF),
+                    static_cast<uint16_t>(service_type & 0xFFFF), aid};
+        }
+        static Key ble_service(uint16_t type) {
+            return {Kind::BleService, type, 0, 0};
+        }
+        static Key ble_characteristic(uint16_t service_type, uint16_t type) {
+            return {Kind::BleCharacteristic, type, service_type, 0};
+        }
+        
+        auto operator<=>(const Key&) const = default;
+    };
+    
+    /// Journal length (records) at which save() compacts into the snapshot
+    static constexpr size_t kCompactThreshold = 64;
+    
     IIDManager(platform::Storage* storage, platform::System* system);
     
     /**
      * @brief Get or assign a stable IID for a service/characteristic.
      * 
-     * Key format examples:
-     * - Service: "S:003E:1" (type:aid)
-     * - Characteristic: "C:0014:003E:1" (type:svc_type:aid)
-     * 
-     * @param key Unique identifier for the attribute
+     * @param key Identity of the attribute
      * @return Stable IID (1-65535)
      */
-    uint16_t get_or_assign(const std::string& key);
+    uint16_t get_or_assign(const Key& key);
     
     /**
      * @brief Check if database structure changed since last check.
@@ -47,10 +95,18 @@ public:
     void update_stored_hash(const std::string& hash);
     
     /**
-     * @brief Save current IID map to persistent storage.
+     * @brief Persist assignments made since the last save.
+     * 
+     * Appends the new records to the journal, or rewrites the snapshot and
+     * drops the journal once it reaches kCompactThreshold records.
      */
     void save();
     
+    /**
+     * @brief Rewrite the snapshot from the full map and drop the journal.
+     */
+    void compact();
+    
     /**
      * @brief Reset all IIDs (for factory reset when unpaired).
      */
@@ -60,15 +116,30 @@ public:
      * @brief Get current next_iid value (for debugging).
      */
     uint16_t get_next_iid() const { return next_iid_; }
+    
+    /**
+     * @brief Number of unsaved or journaled records (for debugging).
+     */
+    size_t journal_size() const { return journal_records_ + pending_.size(); }
 
 private:
     platform::Storage* storage_;
     platform::System* system_;
-    std::map<std::string, uint16_t> iid_map_;
+    std::map<Key, uint16_t> iid_map_;
     uint16_t next_iid_ = 1;
     bool dirty_ = false;  // Track if save is needed
     
+    std::vector<std::pair<Key, uint16_t>> pending_;  // Assigned since last save
+    std::vector<uint8_t> journal_;                   // Mirror of the stored journal
+    size_t journal_records_ = 0;
+    bool migrate_legacy_ = false;  // Text-format map found on load
+    
     void load();
+    size_t load_records(std::span<const uint8_t> data, size_t* consumed = nullptr);
+    void load_legacy(std::string_view text);
+    static std::optional<Key> parse_legacy_key(std::string_view key);
+    static void append_record(std::vector<uint8_t>& out, const Key& key, uint16_t iid);
+    static void write_header(std::vector<uint8_t>& out, uint16_t next_iid);
 };
 
 } // namespace hap::core
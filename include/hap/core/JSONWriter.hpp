@@ -0,0 +1,65 @@
+#pragma once
+
+#include "hap/core/Characteristic.hpp"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace hap::core {
+
+/**
+ * @brief Minimal streaming JSON writer for HAP responses.
+ * 
+ * Appends compact JSON directly to a byte buffer (typically a Response
+ * body) without building an intermediate DOM. Commas are inserted
+ * automatically; the caller is responsible for balanced begin/end calls.
+ */
+class JSONWriter {
+public:
+    explicit JSONWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void begin_object();
+    void end_object();
+    void begin_array();
+    void end_array();
+
+    /**
+     * @brief Write an object key; the next call writes its value.
+     */
+    void key(std::string_view name);
+
+    void value(bool v);
+    void value(int64_t v);
+    void value(uint64_t v);
+    void value(int32_t v) { value(static_cast<int64_t>(v)); }
+    void value(uint32_t v) { value(static_cast<uint64_t>(v)); }
+    void value(float v);
+    void value(double v);
+    void value(std::string_view v);
+    void value(const char* v) { value(std::string_view(v)); }
+    void null();
+
+    /**
+     * @brief Write a pre-rendered JSON value (e.g. Characteristic::perms_json()) verbatim.
+     */
+    void raw_value(std::string_view json);
+
+    /**
+     * @brief Write a characteristic value using HAP JSON conventions.
+     * TLV8/data values are written as base64 strings.
+     */
+    void value(const Value& v);
+
+private:
+    void separator();
+    void raw(std::string_view text);
+
+    static constexpr int kMaxDepth = 32;
+
+    std::vector<uint8_t>& out_;
+    uint32_t has_items_ = 0;  // Bit per nesting level: level already has an item
+    int depth_ = 0;
+    bool after_key_ = false;
+};
+
+} // namespace hap::core
@@ -13,7 +13,7 @@ namespace hap::core {
 class Service {
 public:
     Service(uint64_t type, std::string name, bool is_primary = false)
-        : type_(type), name_(std::move(name)), is_primary_(is_primary) {}
+        : type_(type), type_string_(intern_type_string(type)), name_(std::move(name)), is_primary_(is_primary) {}
 
     virtual ~Service() = default;
 
@@ -26,6 +26,8 @@ public:
     }
 
     uint64_t type() const { return type_; }
+    /// Interned uppercase hex type for JSON ("43")
+    std::string_view type_string() const { return type_string_; }
     const std::string& name() const { return name_; }
     bool is_primary() const { return is_primary_; }
     void set_primary(bool primary) { is_primary_ = primary; }
@@ -41,6 +43,7 @@ public:
 
 private:
     uint64_t type_;
+    std::string_view type_string_;
     std::string name_;
     bool is_primary_;
     bool hidden_ = false;
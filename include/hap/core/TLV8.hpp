@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace hap::core {
 
@@ -45,4 +46,90 @@ public:
     static std::optional<uint8_t> find_uint8(const std::vector<TLV>& tlvs, uint8_t type);
 };
 
+/**
+ * @brief Non-owning reader over a TLV8 buffer.
+ * 
+ * Values are spans into the input, so the buffer must outlive the view.
+ * Items longer than 255 bytes arrive as consecutive fragments; only those
+ * are reassembled, on first access, into storage owned by the view.
+ * Parsing stops at the first truncated record, like TLV8::parse.
+ */
+class TLV8View {
+public:
+    struct Item {
+        uint8_t type;
+        std::span<const uint8_t> value;
+    };
+    
+    explicit TLV8View(std::span<const uint8_t> data);
+    
+    TLV8View(const TLV8View&) = delete;
+    TLV8View& operator=(const TLV8View&) = delete;
+    
+    std::optional<std::span<const uint8_t>> find(uint8_t type) const;
+    std::optional<std::string_view> find_string(uint8_t type) const;
+    std::optional<uint8_t> find_uint8(uint8_t type) const;
+    
+    class const_iterator {
+    public:
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        
+        Item operator*() const { return view_->item_at(offset_, next_); }
+        const_iterator& operator++() {
+            offset_ = next_;
+            next_ = view_->item_end(offset_);
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return offset_ == other.offset_; }
+        
+    private:
+        friend class TLV8View;
+        const_iterator(const TLV8View* view, size_t offset)
+            : view_(view), offset_(offset), next_(view->item_end(offset)) {}
+        
+        const TLV8View* view_;
+        size_t offset_;
+        size_t next_;
+    };
+    
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, data_.size()); }
+    
+private:
+    std::span<const uint8_t> data_;  // Well-formed prefix of the input
+    
+    // Reassembled fragmented items, keyed by the offset of their first record
+    mutable std::vector<std::pair<size_t, std::vector<uint8_t>>> reassembled_;
+    
+    /// Offset just past the item starting at `offset`, including all of its fragments
+    size_t item_end(size_t offset) const;
+    Item item_at(size_t offset, size_t end) const;
+};
+
+/**
+ * @brief Streaming TLV8 encoder appending to a caller-owned buffer.
+ * 
+ * Values longer than 255 bytes are split into fragments. Reserve
+ * encoded_size() per item up front to encode without reallocation.
+ */
+class TLV8Writer {
+public:
+    explicit TLV8Writer(std::vector<uint8_t>& out) : out_(out) {}
+    
+    TLV8Writer& add(uint8_t type, std::span<const uint8_t> value);
+    TLV8Writer& add(uint8_t type, std::string_view value) {
+        return add(type, std::span(reinterpret_cast<const uint8_t*>(value.data()), value.size()));
+    }
+    TLV8Writer& add(uint8_t type, uint8_t value) { return add(type, std::span(&value, 1)); }
+    
+    /// Bytes an item with a value of `value_size` takes once encoded
+    static constexpr size_t encoded_size(size_t value_size) {
+        return value_size == 0 ? 2 : value_size + 2 * ((value_size + 254) / 255);
+    }
+    
+private:
+    std::vector<uint8_t>& out_;
+};
+
 } // namespace hap::core
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace hap::core {
+
+/**
+ * @brief Interned JSON fragments for characteristic and service types.
+ * 
+ * Each distinct input is rendered once and kept for the life of the
+ * program, so nodes hold views instead of formatting on every request.
+ * Thread-safe; meant to be called when nodes are constructed.
+ */
+
+/// Uppercase hex type as used in HAP JSON ("25", "3E")
+std::string_view intern_type_string(uint64_t type);
+
+/// Rendered JSON permission array for a PermissionSet::bits() value ('["pr","pw","ev"]')
+std::string_view intern_perms_json(uint16_t permission_bits);
+
+} // namespace hap::core
@@ -1,8 +1,9 @@
 #pragma once
 
 #include "hap/pairing/TLVTypes.hpp"
+#include "hap/pairing/PairingStore.hpp"
+#include "hap/pairing/SRPVerifierCache.hpp"
 #include "hap/platform/CryptoSRP.hpp"
-#include "hap/platform/Storage.hpp"
 #include "hap/platform/System.hpp"
 #include "hap/core/TLV8.hpp"
 #include <memory>
@@ -29,10 +30,11 @@ class PairSetup {
 public:
     struct Config {
         platform::CryptoSRP* crypto;
-        platform::Storage* storage;
+        PairingStore* pairing_store;
         platform::System* system;
         std::string accessory_id;      // e.g., "12:34:56:78:9A:BC"
         std::string setup_code;        // 8-digit PIN (e.g., "123-45-678")
+        SRPVerifierCache* srp_verifiers = nullptr;  ///< Precomputed SRP state for M1
         /// Callback for pairing changes: (pairing_id, ltpk, is_add)
         std::function<void(const std::string&, const std::array<uint8_t, 32>&, bool)> on_pairings_changed = nullptr;
     };
@@ -73,9 +75,9 @@ private:
     std::array<uint8_t, 64> accessory_ltsk_;  // Long-term secret key
     
     // Message handlers
-    std::optional<std::vector<uint8_t>> handle_m1(const std::vector<core::TLV>& request);
-    std::optional<std::vector<uint8_t>> handle_m3(const std::vector<core::TLV>& request);
-    std::optional<std::vector<uint8_t>> handle_m5(const std::vector<core::TLV>& request);
+    std::optional<std::vector<uint8_t>> handle_m1(const core::TLV8View& request);
+    std::optional<std::vector<uint8_t>> handle_m3(const core::TLV8View& request);
+    std::optional<std::vector<uint8_t>> handle_m5(const core::TLV8View& request);
     
     // Helper to build error response
     std::vector<uint8_t> build_error_response(PairingState state, TLVError error);
@@ -1,13 +1,15 @@
 #pragma once
 
+#include "hap/pairing/PairingStore.hpp"
+#include "hap/pairing/SessionCache.hpp"
 #include "hap/pairing/TLVTypes.hpp"
 #include "hap/platform/Crypto.hpp"
-#include "hap/platform/Storage.hpp"
 #include "hap/core/TLV8.hpp"
 #include <vector>
 #include <optional>
 #include <string>
 #include <array>
+#include <tuple>
 
 namespace hap::pairing {
 
@@ -19,13 +21,21 @@ namespace hap::pairing {
  * M2: Verify Start Response
  * M3: Verify Finish Request
  * M4: Verify Finish Response
+ * 
+ * With a SessionCache configured, verified sessions are cached and an M1
+ * carrying Method=PairResume and a known SessionID is answered with a
+ * resumed session (HAP Spec 7.3.5.3) in a single round trip, deriving new
+ * keys with HKDF from the cached shared secret. Unknown or expired IDs
+ * fall back to the full exchange using the same M1's public key.
  */
 class PairVerify {
 public:
     struct Config {
         platform::Crypto* crypto;
-        platform::Storage* storage;
+        PairingStore* pairing_store;
         std::string accessory_id;
+        SessionCache* session_cache = nullptr;  ///< Enables Pair Resume
+        platform::System* system = nullptr;     ///< Randomness for resumed session IDs
     };
 
     PairVerify(Config config);
@@ -50,8 +60,10 @@ public:
     const std::tuple<std::array<uint8_t, 32>, std::array<uint8_t, 32>> get_session_keys() const { return std::make_tuple(a_session_key_, c_session_key_); }
 
     /**
-     * @brief Reset the verification state.
+     * @brief Whether the session was resumed rather than fully verified.
      */
+    bool is_resumed() const { return resumed_; }
+
     /**
      * @brief Reset the verification state.
      */
@@ -94,15 +106,29 @@ private:
     std::array<uint8_t, 32> accessory_ltpk_;
     std::array<uint8_t, 64> accessory_ltsk_;
     bool keys_valid_ = false;
+    bool keys_loaded_ = false;
+    bool resumed_ = false;
     
     // Message handlers
-    std::optional<std::vector<uint8_t>> handle_m1(const std::vector<core::TLV>& request);
-    std::optional<std::vector<uint8_t>> handle_m3(const std::vector<core::TLV>& request);
+    std::optional<std::vector<uint8_t>> handle_m1(const core::TLV8View& request);
+    std::optional<std::vector<uint8_t>> handle_m3(const core::TLV8View& request);
+    
+    /**
+     * @brief Try to resume a cached session from a Pair Resume M1.
+     * @return M2 response, or nullopt to fall back to a full Pair Verify
+     */
+    std::optional<std::vector<uint8_t>> handle_resume(const core::TLV8View& request);
+    
+    // Derive the Control channel keys from shared_secret_
+    void derive_control_keys();
+    
+    // Cache the verified session under its derived session ID
+    void cache_session();
     
     // Helper to build error response
     std::vector<uint8_t> build_error_response(PairingState state, TLVError error);
     
-    // Load long-term keys
+    // Load long-term keys (on the first full verify only)
     void load_long_term_keys();
 };
 
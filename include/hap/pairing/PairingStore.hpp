@@ -0,0 +1,107 @@
+#pragma once
+
+#include "hap/platform/Crypto.hpp"
+#include "hap/platform/Storage.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace hap::pairing {
+
+/**
+ * @brief In-memory view of the accessory's pairing state (HAP Spec 5.10-5.12).
+ * 
+ * Holds the accessory long-term key pair and up to kMaxPairings controller
+ * pairings (identifier, LTPK, permissions) in fixed slots. Storage is read
+ * once at construction and written through on every change, so Pair Verify,
+ * /pairings and the BLE transport never touch flash on their read paths.
+ * 
+ * All pairings persist as one packed binary record under "pairings"; the
+ * older JSON "pairing_list" plus per-controller keys are migrated on load.
+ * 
+ * Thread-safe; lookups return copies.
+ */
+class PairingStore {
+public:
+    static constexpr size_t kMaxPairings = 16;
+    static constexpr size_t kMaxIdLength = 36;  // Controller pairing IDs are UUID strings
+    static constexpr uint8_t kPermissionAdmin = 0x01;
+
+    struct Pairing {
+        std::array<char, kMaxIdLength> id_bytes{};
+        uint8_t id_length = 0;
+        std::array<uint8_t, 32> ltpk{};
+        uint8_t permissions = kPermissionAdmin;
+
+        std::string_view id() const { return {id_bytes.data(), id_length}; }
+        bool is_admin() const { return (permissions & kPermissionAdmin) != 0; }
+    };
+
+    struct LongTermKeys {
+        std::array<uint8_t, 32> ltpk;
+        std::array<uint8_t, 64> ltsk;
+    };
+
+    enum class AddResult {
+        Added,      ///< New controller stored
+        Updated,    ///< Existing controller's key/permissions replaced
+        Full,       ///< kMaxPairings controllers already paired
+        InvalidId   ///< Empty or longer than kMaxIdLength
+    };
+
+    explicit PairingStore(platform::Storage* storage);
+
+    /**
+     * @brief Accessory long-term keys, if generated.
+     */
+    std::optional<LongTermKeys> long_term_keys() const;
+
+    /**
+     * @brief Accessory long-term keys, generating and persisting a new pair if missing.
+     */
+    LongTermKeys ensure_long_term_keys(platform::Crypto& crypto);
+
+    std::optional<Pairing> find(std::string_view id) const;
+
+    AddResult add(std::string_view id, const std::array<uint8_t, 32>& ltpk, uint8_t permissions = kPermissionAdmin);
+
+    /**
+     * @return false if the controller was not paired
+     */
+    bool remove(std::string_view id);
+
+    std::vector<Pairing> list() const;
+
+    size_t size() const;
+
+    /**
+     * @brief Lock-free; used by mDNS, advertising and /identify.
+     */
+    bool is_paired() const { return paired_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Forget every pairing and the long-term keys, in memory and in storage.
+     */
+    void clear();
+
+private:
+    platform::Storage* storage_;
+    mutable std::mutex mutex_;
+    std::array<Pairing, kMaxPairings> pairings_;
+    size_t count_ = 0;
+    std::atomic<bool> paired_{false};
+    std::optional<LongTermKeys> keys_;
+
+    void load();
+    void decode(std::span<const uint8_t> data);
+    bool load_legacy();
+    void save_list();
+    size_t index_of(std::string_view id) const;  // count_ if not found
+};
+
+} // namespace hap::pairing
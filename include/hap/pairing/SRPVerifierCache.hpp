@@ -0,0 +1,72 @@
+#pragma once
+
+#include "hap/platform/CryptoSRP.hpp"
+#include "hap/platform/Storage.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace hap::pairing {
+
+/**
+ * @brief Precomputed SRP state for Pair Setup M1 (HAP Spec 5.6.1).
+ * 
+ * Deriving the SRP verifier and the server public key B are 3072-bit
+ * modular exponentiations, which take seconds on small MCUs. The cache
+ * generates the salt/verifier for the setup code once per boot, and
+ * prepare() additionally starts one session ahead of time so that M1 only
+ * has to hand it out. PairSetup falls back to computing on demand whenever
+ * nothing is prepared.
+ * 
+ * Nothing derived from the setup code is written to storage: a verifier in
+ * flash would let anyone reading it test all 10^8 codes offline.
+ * 
+ * prepare() is meant to run on a background worker or at boot; take_session()
+ * waits for a prepare() in progress instead of duplicating its work.
+ * Thread-safe.
+ */
+class SRPVerifierCache {
+public:
+    /**
+     * @param storage Only used to erase the verifier record older versions persisted
+     */
+    SRPVerifierCache(platform::CryptoSRP* crypto, platform::Storage* storage, std::string setup_code);
+
+    /**
+     * @brief Ensure a verifier exists and a session with B is ready for the next M1.
+     */
+    void prepare();
+
+    /**
+     * @return true if take_session() will not compute anything
+     */
+    bool ready() const;
+
+    /**
+     * @brief Session for a new Pair Setup, prepared or built now.
+     * 
+     * Prepared sessions carry server_public_key; otherwise the caller still
+     * has to call srp_get_public_key().
+     */
+    std::unique_ptr<platform::SRPSession> take_session();
+
+private:
+    struct Verifier {
+        std::array<uint8_t, 16> salt;
+        std::vector<uint8_t> verifier;
+    };
+
+    platform::CryptoSRP* crypto_;
+    std::string setup_code_;
+    mutable std::mutex mutex_;
+    std::optional<Verifier> verifier_;
+    std::unique_ptr<platform::SRPSession> prepared_;
+
+    std::unique_ptr<platform::SRPSession> new_session();
+};
+
+} // namespace hap::pairing
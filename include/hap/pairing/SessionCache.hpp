@@ -0,0 +1,79 @@
+#pragma once
+
+#include "hap/platform/System.hpp"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hap::pairing {
+
+/**
+ * @brief Cache of verified sessions for Pair Resume (HAP Spec 7.3.5.3).
+ * 
+ * After a full Pair Verify the accessory remembers the session's shared
+ * secret under an 8-byte session ID. A controller that reconnects within
+ * the expiry window can resume with that ID, which only needs HKDF and a
+ * ChaCha20-Poly1305 tag instead of X25519 and Ed25519.
+ * 
+ * Entries are single-use: resuming consumes the entry and caches the new
+ * session under a new ID. The cache holds at most `capacity` entries and
+ * evicts the oldest first. Thread-safe.
+ */
+class SessionCache {
+public:
+    using SessionId = std::array<uint8_t, 8>;
+
+    struct Session {
+        std::array<uint8_t, 32> shared_secret;
+        std::string controller_id;
+    };
+
+    static constexpr size_t kDefaultCapacity = 8;
+    static constexpr uint64_t kDefaultTtlMs = 60 * 60 * 1000;  // 1 hour
+
+    explicit SessionCache(platform::System* system,
+                          size_t capacity = kDefaultCapacity,
+                          uint64_t ttl_ms = kDefaultTtlMs);
+
+    /**
+     * @brief Remember a verified session, replacing any entry with the same ID.
+     */
+    void store(const SessionId& id, const std::array<uint8_t, 32>& shared_secret, std::string controller_id);
+
+    /**
+     * @brief Remove and return a live session.
+     * @return The session, or nullopt if unknown or expired
+     */
+    std::optional<Session> take(const SessionId& id);
+
+    /**
+     * @brief Forget every session of a controller (e.g., when its pairing is removed).
+     */
+    void remove_controller(std::string_view controller_id);
+
+    void clear();
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        SessionId id;
+        Session session;
+        uint64_t expires_at_ms;
+    };
+
+    platform::System* system_;
+    size_t capacity_;
+    uint64_t ttl_ms_;
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entries_;  // Oldest first
+
+    void drop_expired(uint64_t now);
+};
+
+} // namespace hap::pairing
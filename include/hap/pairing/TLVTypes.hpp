@@ -20,6 +20,7 @@ enum class TLVType : uint8_t {
     Permissions = 11,
     FragmentData = 12,
     FragmentLast = 13,
+    SessionID = 14,
     Separator = 255
 };
 
@@ -41,7 +42,8 @@ enum class PairingMethod : uint8_t {
     PairVerify = 2,
     AddPairing = 3,
     RemovePairing = 4,
-    ListPairings = 5
+    ListPairings = 5,
+    PairResume = 6
 };
 
 // Pairing States (M1-M6 for Pair Setup, M1-M4 for Pair Verify)
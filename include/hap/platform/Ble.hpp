@@ -32,17 +32,19 @@ struct Ble {
     struct Advertisement {
         static Advertisement create_hap(
             uint8_t status_flags, 
-            uint8_t device_id[6], 
+            const uint8_t device_id[6], 
             uint16_t category_id, 
             uint16_t global_state_number,
             uint8_t config_number,
-            uint8_t pair_setup_hash[4]
+            const uint8_t pair_setup_hash[4]
         );
 
         uint16_t company_id = 0x004C;
         std::vector<uint8_t> manufacturer_data;
         uint8_t flags = 0x06;
         std::optional<std::string> local_name;
+
+        bool operator==(const Advertisement&) const = default;
     };
 
     virtual void start() = 0;
@@ -127,6 +129,23 @@ struct Ble {
      */
     virtual void set_disconnect_callback(DisconnectCallback callback) = 0;
 
+    /**
+     * @brief Callback type for ATT MTU exchanges.
+     * @param connection_id The connection that negotiated a new MTU.
+     * @param mtu The negotiated ATT MTU in bytes.
+     */
+    using MtuCallback = std::function<void(uint16_t connection_id, uint16_t mtu)>;
+
+    /**
+     * @brief Set a callback to be invoked when a connection's ATT MTU is negotiated.
+     * 
+     * HAP responses are split into MTU-sized fragments that the controller
+     * reads one GATT Read at a time. Platforms that never report the MTU get
+     * unfragmented responses and must serve them with long reads.
+     * @param callback The callback function.
+     */
+    virtual void set_mtu_callback(MtuCallback callback) { (void)callback; }
+
     /**
      * @brief Send a GATT indication to a connected client.
      * 
@@ -141,6 +160,28 @@ struct Ble {
     virtual bool send_indication(uint16_t connection_id, const std::string& characteristic_uuid, 
                                   std::span<const uint8_t> data) = 0;
 
+    /**
+     * @brief Callback type for indication confirmations.
+     * @param connection_id The connection whose controller confirmed its indication.
+     */
+    using IndicationConfirmCallback = std::function<void(uint16_t connection_id)>;
+
+    /**
+     * @brief Set a callback to be invoked when a controller confirms an indication.
+     * 
+     * ATT allows one unconfirmed indication per connection; stacks buffer or
+     * drop the rest. When the platform reports confirmations (NimBLE:
+     * BLE_GAP_EVENT_NOTIFY_TX with BLE_HS_EDONE, BlueZ: Confirm()), the
+     * transport keeps one indication in flight and sends the next as soon as
+     * the link is free. Otherwise it sends as fast as send_indication() accepts.
+     * @param callback The callback function.
+     * @return true if the platform will invoke the callback.
+     */
+    virtual bool set_indication_confirm_callback(IndicationConfirmCallback callback) {
+        (void)callback;
+        return false;
+    }
+
     /**
      * @brief Encrypted advertisement data for HAP BLE Broadcasted Events.
      * 
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "hap/common/TaskScheduler.hpp"
+#include "hap/platform/Storage.hpp"
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace hap::platform {
+
+/**
+ * @brief Write-coalescing Storage decorator.
+ * 
+ * Keeps every key it has seen in RAM and defers writes to the backend:
+ * set() and remove() only mark the key dirty, and dirty keys are written
+ * together by commit(), which runs `flush_delay_ms` after the first
+ * pending change (through the scheduler, if one is set) or explicitly.
+ * Repeated writes to one key (GSN, IID map) reach the backend once per
+ * flush, inside one Storage::begin_batch()/commit_batch() pair.
+ * 
+ * A Transaction groups several changes so no flush lands between them,
+ * e.g. clearing every pairing key on reset. Thread-safe.
+ */
+class CachedStorage : public Storage {
+public:
+    /**
+     * @param backend Storage that receives the coalesced writes
+     * @param scheduler Runs the delayed flush; nullptr means commit() only
+     * @param flush_delay_ms Delay between the first pending change and the flush
+     */
+    explicit CachedStorage(Storage* backend, common::TaskScheduler* scheduler = nullptr,
+                           uint32_t flush_delay_ms = 1000);
+
+    /// Commits pending changes
+    ~CachedStorage() override;
+
+    CachedStorage(const CachedStorage&) = delete;
+    CachedStorage& operator=(const CachedStorage&) = delete;
+
+    void set(std::string_view key, std::span<const uint8_t> value) override;
+    std::optional<std::vector<uint8_t>> get(std::string_view key) override;
+    void remove(std::string_view key) override;
+    bool has(std::string_view key) override;
+
+    /**
+     * @brief Write all pending changes to the backend now.
+     * Deferred while a Transaction is open; it commits when it ends.
+     */
+    void commit();
+
+    bool has_pending() const;
+
+    /**
+     * @brief Commit as soon as this key changes (outside a Transaction).
+     * For write-ahead state that must not be lost to a power cut, such as
+     * the GSN reserve; whatever else is pending goes out in the same batch.
+     */
+    void set_write_through(std::string key);
+
+    /**
+     * @brief Replace the scheduler used for delayed flushes (nullptr disables them).
+     */
+    void set_scheduler(common::TaskScheduler* scheduler);
+
+    /**
+     * @brief Groups changes into one flush; nests. The outermost one commits.
+     */
+    class Transaction {
+    public:
+        explicit Transaction(CachedStorage& storage) : storage_(&storage) { storage_->begin_transaction(); }
+        ~Transaction() { if (storage_) storage_->end_transaction(); }
+        Transaction(Transaction&& other) noexcept : storage_(other.storage_) { other.storage_ = nullptr; }
+        Transaction(const Transaction&) = delete;
+        Transaction& operator=(const Transaction&) = delete;
+        Transaction& operator=(Transaction&&) = delete;
+    private:
+        CachedStorage* storage_;
+    };
+
+    Transaction transaction() { return Transaction(*this); }
+
+private:
+    Storage* backend_;
+    common::TaskScheduler* scheduler_;
+    uint32_t flush_delay_ms_;
+    
+    mutable std::mutex mutex_;
+    // nullopt marks a key known to be absent (never stored or removed)
+    std::map<std::string, std::optional<std::vector<uint8_t>>, std::less<>> entries_;
+    std::set<std::string, std::less<>> dirty_;
+    std::set<std::string, std::less<>> write_through_;
+    size_t transaction_depth_ = 0;
+    common::TaskScheduler::TaskId flush_task_ = common::TaskScheduler::INVALID_TASK_ID;
+
+    void begin_transaction();
+    void end_transaction();
+    /// Caller holds mutex_
+    const std::optional<std::vector<uint8_t>>& load(std::string_view key);
+    /// Caller holds mutex_
+    void mark_dirty(std::string_view key);
+    /// Caller holds mutex_
+    void arm_flush();
+    /// Caller holds mutex_
+    void flush_locked();
+};
+
+} // namespace hap::platform
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <array>
 #include <span>
 #include <cstdint>
+#include <vector>
 
 namespace hap::platform {
 
@@ -60,6 +62,88 @@ struct Crypto {
         std::span<const uint8_t, 16> tag,
         std::span<uint8_t> plaintext) = 0;
 
+    /**
+     * @brief Encrypt `data` in place, writing the 16-byte tag separately.
+     * 
+     * Backends whose ChaCha20 accepts aliased input/output (OpenSSL EVP,
+     * mbedtls_chachapoly) should override this; the default copies the
+     * plaintext to a temporary buffer first.
+     */
+    virtual bool chacha20_poly1305_encrypt_in_place(
+        std::span<const uint8_t, 32> key,
+        std::span<const uint8_t, 12> nonce,
+        std::span<const uint8_t> aad,
+        std::span<uint8_t> data,
+        std::span<uint8_t, 16> tag) {
+        std::vector<uint8_t> plaintext(data.begin(), data.end());
+        return chacha20_poly1305_encrypt_and_tag(key, nonce, aad, plaintext, data, tag);
+    }
+
+    /**
+     * @brief Decrypt and verify `data` in place.
+     * 
+     * On authentication failure the contents of `data` are unspecified.
+     * The default copies the ciphertext to a temporary buffer first.
+     */
+    virtual bool chacha20_poly1305_decrypt_in_place(
+        std::span<const uint8_t, 32> key,
+        std::span<const uint8_t, 12> nonce,
+        std::span<const uint8_t> aad,
+        std::span<uint8_t> data,
+        std::span<const uint8_t, 16> tag) {
+        std::vector<uint8_t> ciphertext(data.begin(), data.end());
+        return chacha20_poly1305_decrypt_and_verify(key, nonce, aad, ciphertext, tag, data);
+    }
+
+    // Batched ChaCha20-Poly1305: one call per key for many frames.
+    // Tags are 16 bytes; spans are dynamic so batches can live in plain arrays.
+    struct AeadSealFrame {
+        std::array<uint8_t, 12> nonce;
+        std::span<const uint8_t> aad;
+        std::span<const uint8_t> plaintext;
+        std::span<uint8_t> ciphertext;
+        std::span<uint8_t> tag;
+    };
+
+    struct AeadOpenFrame {
+        std::array<uint8_t, 12> nonce;
+        std::span<const uint8_t> aad;
+        std::span<const uint8_t> ciphertext;
+        std::span<const uint8_t> tag;
+        std::span<uint8_t> plaintext;
+    };
+
+    /**
+     * @brief Encrypt several frames under one key.
+     * 
+     * Hardware engines can override this to queue every frame in a single
+     * DMA transaction; the default seals them one at a time.
+     * @return false if any frame fails
+     */
+    virtual bool chacha20_poly1305_encrypt_batch(std::span<const uint8_t, 32> key, std::span<const AeadSealFrame> frames) {
+        for (const auto& frame : frames) {
+            if (!chacha20_poly1305_encrypt_and_tag(key, frame.nonce, frame.aad, frame.plaintext, frame.ciphertext,
+                                                   frame.tag.first<16>())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Decrypt and verify several frames under one key.
+     * @return false if any frame fails authentication
+     */
+    virtual bool chacha20_poly1305_decrypt_batch(std::span<const uint8_t, 32> key, std::span<const AeadOpenFrame> frames) {
+        for (const auto& frame : frames) {
+            if (!chacha20_poly1305_decrypt_and_verify(key, frame.nonce, frame.aad, frame.ciphertext,
+                                                      frame.tag.first<16>(), frame.plaintext)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     // SRP6a (Secure Remote Password)
     // SRP interface is defined in CryptoSRP.hpp extending this interface.
 };
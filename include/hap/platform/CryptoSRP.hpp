@@ -43,6 +43,22 @@ struct CryptoSRP : public Crypto {
         std::string_view username,
         std::string_view password) = 0;
 
+    /**
+     * @brief Create an SRP session from a previously generated salt and verifier.
+     * 
+     * Skips the verifier computation of srp_new_verifier(). Platforms that
+     * cannot rebuild a session return nullptr and callers fall back to
+     * srp_new_verifier().
+     */
+    virtual std::unique_ptr<SRPSession> srp_restore_verifier(
+        std::string_view username,
+        std::string_view password,
+        std::span<const uint8_t, 16> salt,
+        std::span<const uint8_t> verifier) {
+        (void)username; (void)password; (void)salt; (void)verifier;
+        return nullptr;
+    }
+
     /**
      * @brief Get the salt used in SRP.
      * 16 bytes, randomly generated on first pairing.
@@ -33,7 +33,19 @@ struct Network {
 
     virtual void tcp_listen(uint16_t port, ReceiveCallback on_receive, DisconnectCallback on_disconnect) = 0;
     virtual void tcp_send(ConnectionId id, std::span<const uint8_t> data) = 0;
+
+    // Scatter-gather send: writes all buffers in order, ideally with one
+    // syscall (writev/sendmsg). The default falls back to one tcp_send each.
+    virtual void tcp_send_vectored(ConnectionId id, std::span<const std::span<const uint8_t>> buffers) {
+        for (auto buffer : buffers) {
+            tcp_send(id, buffer);
+        }
+    }
     virtual void tcp_disconnect(ConnectionId id) = 0;
+
+    // Backpressure hint: false while the connection's send buffer is full,
+    // so queued data is held back instead of blocking in tcp_send.
+    virtual bool tcp_can_send(ConnectionId /*id*/) { return true; }
 };
 
 } // namespace hap::platform
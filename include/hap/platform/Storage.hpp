@@ -22,6 +22,11 @@ struct Storage {
     
     // Check if key exists
     virtual bool has(std::string_view key) = 0;
+
+    // Optional batching hooks: writes between begin_batch() and commit_batch()
+    // may be made durable together (e.g. one fsync / one NVS commit).
+    virtual void begin_batch() {}
+    virtual void commit_batch() {}
 };
 
 } // namespace hap::platform
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <optional>
 #include <span>
 #include <cstdint>
 #include <string_view>
@@ -26,6 +28,14 @@ struct System {
         Error
     };
     virtual void log(LogLevel level, std::string_view message) = 0;
+
+    // Lowest level the platform will actually output. Checked before a
+    // message is formatted, so dropped levels cost no string building.
+    virtual LogLevel log_level() const { return LogLevel::Debug; }
+
+    // Lowest free heap seen since boot, for diagnostics; platforms that can
+    // tell (ESP32: heap_caps_get_minimum_free_size) override this.
+    virtual std::optional<size_t> min_free_heap() const { return std::nullopt; }
 };
 
 } // namespace hap::platform
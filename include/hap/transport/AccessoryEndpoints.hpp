@@ -2,17 +2,74 @@
 
 #include "hap/transport/HTTP.hpp"
 #include "hap/transport/ConnectionContext.hpp"
+#include "hap/transport/EventDispatcher.hpp"
 #include "hap/core/AttributeDatabase.hpp"
+#include "hap/common/TaskScheduler.hpp"
+#include <charconv>
+#include <functional>
+#include <optional>
+#include <string_view>
 #include <nlohmann/json.hpp>
 
 namespace hap::transport {
 
+/**
+ * @brief Parsed GET /characteristics query (HAP Spec 6.7.4.1), e.g.
+ * "id=1.10,1.11&meta=1&perms=1&type=1&ev=1".
+ * 
+ * Parsed in one pass over the query without allocating: `ids` stays a
+ * view into the request and is walked again by for_each_id().
+ */
+struct ReadQuery {
+    std::string_view ids;  // Validated "<aid>.<iid>,..." list
+    size_t count = 0;
+    bool meta = false;     // Include format, unit and range metadata
+    bool perms = false;    // Include permissions
+    bool type = false;     // Include the characteristic type
+    bool ev = false;       // Include whether this connection is subscribed
+
+    /**
+     * @return nullopt if id is missing, empty or malformed
+     */
+    static std::optional<ReadQuery> parse(std::string_view query);
+
+    /// Calls fn(aid, iid) for every id, in request order
+    template<typename Fn>
+    void for_each_id(Fn&& fn) const {
+        const char* p = ids.data();
+        const char* end = p + ids.size();
+        while (p < end) {
+            uint64_t aid = 0, iid = 0;
+            p = std::from_chars(p, end, aid).ptr + 1;  // Skip '.'
+            p = std::from_chars(p, end, iid).ptr + 1;  // Skip ','
+            fn(aid, iid);
+        }
+    }
+};
+
 /**
  * @brief Accessory endpoint handlers
  */
 class AccessoryEndpoints {
 public:
-    AccessoryEndpoints(core::AttributeDatabase* database);
+    /**
+     * @brief Delivers a response that a handler deferred.
+     * May be called from any thread (whichever completed the last callback).
+     */
+    using DeferredResponder = std::function<void(uint32_t connection_id, Response response)>;
+
+    AccessoryEndpoints(core::AttributeDatabase* database, EventDispatcher* events);
+
+    /**
+     * @brief Enable deferred responses for async characteristic callbacks.
+     * 
+     * Without a responder, async callbacks are still invoked but the
+     * handler answers ServiceCommunicationFailure for any that do not
+     * complete before it returns.
+     * @param scheduler Runs the timeout; nullptr waits indefinitely
+     * @param timeout_ms Time after which pending callbacks fail with ServiceCommunicationFailure
+     */
+    void set_async_support(common::TaskScheduler* scheduler, uint32_t timeout_ms, DeferredResponder responder);
 
     /**
      * @brief GET /accessories handler
@@ -21,8 +78,8 @@ public:
     Response handle_get_accessories(const Request& req, ConnectionContext& ctx);
 
     /**
-     * @brief GET /characteristics?id=<aid>.<iid>,... handler
-     * Reads characteristic values.
+     * @brief GET /characteristics?id=<aid>.<iid>,...[&meta=1][&perms=1][&type=1][&ev=1] handler
+     * Reads characteristic values, plus the requested optional fields.
      */
     Response handle_get_characteristics(const Request& req, ConnectionContext& ctx);
 
@@ -40,9 +97,10 @@ public:
 
 private:
     core::AttributeDatabase* database_;
-    
-    // Parse query string "id=1.2,1.3" into list of (aid, iid) pairs
-    std::vector<std::pair<uint64_t, uint64_t>> parse_characteristic_ids(const std::string& query);
+    EventDispatcher* events_;
+    common::TaskScheduler* scheduler_ = nullptr;
+    uint32_t async_timeout_ms_ = 0;
+    DeferredResponder responder_;
 };
 
 } // namespace hap::transport
@@ -2,14 +2,24 @@
 
 #include "hap/platform/Ble.hpp"
 #include "hap/core/AttributeDatabase.hpp"
+#include "hap/core/CharacteristicFinder.hpp"
 #include "hap/core/IIDManager.hpp"
 #include "hap/transport/PairingEndpoints.hpp"
 #include "hap/transport/ble/BleSessionManager.hpp"
+#include "hap/transport/ble/BroadcastScheduler.hpp"
+#include "hap/transport/ble/SignatureTable.hpp"
+#include "hap/transport/ble/GlobalStateNumber.hpp"
+#include "hap/common/Metrics.hpp"
 #include "hap/common/TaskScheduler.hpp"
+#include <deque>
+#include <functional>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <span>
 #include <vector>
 #include <array>
+#include <optional>
 
 namespace hap::transport {
 
@@ -32,13 +42,27 @@ public:
         PairingEndpoints* pairing_endpoints;
         platform::System* system;
         platform::Storage* storage;
+        pairing::PairingStore* pairing_store = nullptr;
         common::TaskScheduler* scheduler = nullptr;
         core::IIDManager* iid_manager = nullptr;
+        common::Metrics* metrics = nullptr;  // PDU processing and crypto timings
         
         std::string accessory_id;
         std::string device_name;
         uint16_t category_id = 5; // Default to Lightbulb
         uint8_t config_number = 1;
+        uint16_t gsn_reserve = ble::GlobalStateNumber::kDefaultReserve;  // GSN increments per storage write
+        
+        /**
+         * @brief Register only the Accessory Information, Protocol Information
+         * and Pairing services in start(); the database's other services,
+         * signatures and advertising follow from a scheduler task. Needs a
+         * scheduler; ignored without one.
+         */
+        bool defer_user_services = false;
+        
+        /// Called once every service is registered and the radio is started
+        std::function<void()> on_ready;
     };
 
     BleTransport(Config config);
@@ -49,13 +73,22 @@ public:
      */
     void start();
 
+    /**
+     * @brief Whether start() has finished, including deferred registration.
+     */
+    bool is_ready() const { return ready_; }
+
     /**
      * @brief Stop advertising and disconnect clients.
      */
     void stop();
 
     /**
-     * @brief Update BLE advertising data.
+     * @brief Refresh BLE advertising data.
+     * 
+     * With a scheduler, bursts of calls are coalesced into one refresh
+     * after a short delay. The radio is only restarted when the payload
+     * differs from what it is already advertising.
      */
     void update_advertising();
 
@@ -64,6 +97,11 @@ public:
      */
     void set_accessory_id(const std::string& new_id);
 
+    /**
+     * @brief Reload the Global State Number after its stored value was cleared.
+     */
+    void reset_state_number();
+
     /**
      * @brief Notify controllers of a characteristic value change.
      * 
@@ -88,12 +126,32 @@ public:
      * - 30-second idle timeout (7.2.5)
      * - 10-second HAP procedure timeout (7.3.1)
      * - 10-second initial procedure timeout (7.5 Req #40)
+     * 
+     * Only needed without a scheduler; with one, each session arms its own
+     * deadline timer and is disconnected the moment it expires.
      */
     void check_session_timeouts();
 
+    /**
+     * @brief Pick up accessories added to or removed from the database after start().
+     * 
+     * Re-indexes the database, registers GATT services for `added` and
+     * refreshes advertising so the new configuration number is published.
+     * platform::Ble cannot unregister services, so those of removed
+     * accessories stay in the GATT table until restart; their IIDs no
+     * longer resolve and requests on them fail with an error status.
+     */
+    void on_database_changed(std::span<const std::shared_ptr<core::Accessory>> added);
+
 private:
     Config config_;
 
+    // GATT callbacks arrive on the BLE stack's task while scheduler tasks
+    // and notify_value_changed() run on the tick() thread. Every entry point
+    // holds this; recursive because stacks may call back (e.g. disconnect)
+    // from inside a call the transport makes.
+    mutable std::recursive_mutex mutex_;
+
     // UUIDs
     // HAP Base UUID: XXXX-0000-1000-8000-0026BB765291 (Section 6.6.1)
     static constexpr const char* kHapPairingServiceUUID = "00000055-0000-1000-8000-0026BB765291";
@@ -105,8 +163,26 @@ private:
     
     std::unique_ptr<ble::BleSessionManager> session_manager_;
 
-    // Mapping (AID, IID) -> Characteristic UUID
-    std::map<std::pair<uint64_t, uint64_t>, std::string> instance_map_;
+    // IID index over config_.database, built by index_database()
+    std::unique_ptr<core::CharacteristicFinder> finder_;
+    
+    // Deferred part of start() (Config::defer_user_services)
+    common::TaskScheduler::TaskId registration_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    bool ready_ = false;
+
+    // One entry per HAP characteristic registered with GATT, indexed by the
+    // handle its callbacks capture. The UUID string is only kept to hand back
+    // to platform::Ble; PDUs and events work on handles.
+    struct GattCharacteristic {
+        uint64_t aid = 0;                 // Owning accessory, 0 for protocol characteristics
+        uint16_t iid = 0;
+        uint16_t short_type = 0;          // HAP short UUID, e.g. 0x4C for Pair Setup
+        bool requires_encryption = true;  // False for characteristics used before Pair Verify
+        bool in_database = false;         // Cleared once its accessory is removed
+        std::string uuid;
+    };
+    std::vector<GattCharacteristic> gatt_chars_;
+    std::vector<uint16_t> gatt_handles_by_iid_;  // Handles sorted by IID
     
     struct CharacteristicMetadata {
         uint16_t instance_id;     // Characteristic IID
@@ -118,6 +194,11 @@ private:
     };
     std::map<uint16_t, CharacteristicMetadata> pairing_char_metadata_;
 
+    // Characteristic and Service Signature Read bodies, rebuilt whenever the
+    // GATT table is (re)registered so reads never walk the database
+    ble::SignatureTable char_signatures_;
+    ble::SignatureTable service_signatures_;
+
     struct BroadcastConfig {
         uint16_t iid = 0;
         uint8_t interval = 0x01;  // 0x01=20ms, 0x02=1280ms, 0x03=2560ms
@@ -126,28 +207,102 @@ private:
     std::map<uint16_t, BroadcastConfig> broadcast_configs_;
     
     // Broadcast encryption key state (per HAP Spec 7.4.7.3-7.4.7.4)
-    std::array<uint8_t, 32> broadcast_key_ = {};
-    uint16_t broadcast_key_gsn_start_ = 0;  // GSN when key was generated
-    bool broadcast_key_valid_ = false;
+    struct BroadcastKey {
+        std::array<uint8_t, 32> key = {};
+        uint16_t gsn_start = 0;  // GSN when key was generated
+        bool valid = false;
+    };
+    BroadcastKey broadcast_key_;
+    
+    // Broadcasted events take turns on the advertisement slot
+    ble::BroadcastScheduler broadcasts_;
+    common::TaskScheduler::TaskId broadcast_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    
+    ble::GlobalStateNumber gsn_;
+    
+    // Payload the radio is currently advertising, if known; unset when
+    // something else (a connection, an encrypted broadcast) replaced it
+    std::optional<platform::Ble::Advertisement> current_advertisement_;
+    common::TaskScheduler::TaskId advertising_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    static constexpr uint32_t kAdvertisingDebounceMs = 100;
+    
+    // Derived from the accessory ID and cached; cleared when the ID changes
+    std::optional<std::array<uint8_t, 4>> setup_hash_;
+    std::optional<std::array<uint8_t, 6>> advertising_id_;
+    
+    // Connections with a complete PDU awaiting processing, drained round-robin
+    // by the scheduler so one busy connection cannot starve the others
+    std::deque<uint16_t> ready_connections_;
+    common::TaskScheduler::TaskId transaction_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    
+    // Connected Events are paced per connection (BleSession::pending_indications);
+    // this timer retries when the stack is full or a confirmation is overdue
+    common::TaskScheduler::TaskId indication_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    uint64_t indication_task_at_ms_ = 0;
+    bool indication_confirmations_ = false;  // Platform reports confirmations
+    static constexpr uint32_t kIndicationRetryMs = 20;
+    static constexpr uint32_t kIndicationConfirmTimeoutMs = 1000;
+    
+    // Scratch for decrypting incoming PDUs in place; GATT writes arrive one at a time
+    std::vector<uint8_t> rx_pdu_;
     
     bool is_connected_ = false;
 
 
     void setup_hap_service();
     void setup_protocol_info_service();
+    
+    /// Second half of start(): user services, signatures, advertising, radio
+    void finish_start();
+    void index_database();
+    std::optional<platform::Ble::Advertisement> build_advertisement();
+    void flush_advertising();
     void increment_gsn();
     uint16_t get_current_gsn();
     
-    void handle_hap_write(uint16_t connection_id, const std::string& uuid, std::span<const uint8_t> data);
-    void handle_hap_write_with_id(uint16_t connection_id, std::string uuid, std::span<const uint8_t> data);
+    /// Accessory ID parsed into the 6-byte advertising identifier
+    const std::array<uint8_t, 6>& advertising_id();
+    
+    uint16_t add_gatt_characteristic(uint64_t aid, uint16_t iid, const std::string& uuid);
+    std::optional<uint16_t> find_gatt_handle(uint64_t aid, uint16_t iid) const;
+    bool handle_requires_encryption(uint16_t handle) const;
+    
+    void handle_hap_write(uint16_t connection_id, uint16_t handle, std::span<const uint8_t> data);
     std::vector<uint8_t> handle_hap_read(uint16_t connection_id);
     
+    /**
+     * @brief Process a complete PDU now, or queue it when a scheduler is configured.
+     * 
+     * Queued transactions run from the scheduler one per connection per pass,
+     * or as soon as their connection issues the GATT Read for the response.
+     */
+    void queue_transaction(uint16_t connection_id, ble::TransactionState& state);
+    void drain_transactions();
+    void terminate_timed_out(uint16_t connection_id);
+    bool run_ready_transaction(uint16_t connection_id);
     void process_transaction(uint16_t connection_id, ble::TransactionState& state);
-    std::vector<uint8_t> process_signature_read(uint16_t connection_id, uint16_t iid);
+    void rebuild_signatures();
     std::vector<uint8_t> process_characteristic_read(uint16_t connection_id, std::span<const uint8_t> body);
-    bool process_characteristic_write(uint16_t connection_id, uint16_t tid, const std::string& uuid, std::span<const uint8_t> body);
+    bool process_characteristic_write(uint16_t connection_id, uint16_t tid, uint16_t handle, std::span<const uint8_t> body);
     
-    void send_response(uint16_t conn_id, uint16_t tid, const std::string& uuid, uint8_t status, std::span<const uint8_t> body);
+    void send_response(uint16_t conn_id, uint16_t tid, uint16_t handle, uint8_t status, std::span<const uint8_t> body);
+    
+    /**
+     * @brief Write to Pair Setup/Verify/Pairings (or another built-in
+     * characteristic) by handing the body to the pairing endpoints.
+     * @return HAP-BLE PDU status
+     */
+    uint8_t write_pairing_characteristic(uint16_t connection_id, uint8_t char_type,
+                                         std::span<const uint8_t> body, std::vector<uint8_t>& response_body);
+    
+    /**
+     * @brief Apply a Write or executed Timed Write to a database characteristic.
+     * @param body Request TLVs: Value and optionally Return-Response
+     * @param timed Whether this executes a prepared timed write
+     * @return HAP-BLE PDU status; response_body gets the write-response TLV
+     */
+    uint8_t write_characteristic(uint16_t connection_id, ble::TransactionState& state, uint16_t iid,
+                                 std::span<const uint8_t> body, bool timed, std::vector<uint8_t>& response_body);
     
     /**
      * @brief Handle characteristic change and dispatch appropriate event type.
@@ -160,8 +315,22 @@ private:
     /**
      * @brief Send Connected Event (zero-length GATT indication).
      * Per HAP Spec 7.4.6.1: Sent to controllers that registered for indications.
+     * 
+     * Queued per connection; a characteristic already waiting is not queued
+     * twice. See send_pending_indications().
      */
-    void send_connected_event(uint16_t iid);
+    void send_connected_event(uint16_t handle);
+    
+    /**
+     * @brief Hand the connection's queued indications to the stack.
+     * 
+     * With confirmations, one is in flight at a time and the next goes out
+     * from the confirmation callback (or after kIndicationConfirmTimeoutMs).
+     * Without them, all go out until send_indication() refuses one; the rest
+     * are retried after kIndicationRetryMs.
+     */
+    void send_pending_indications(uint16_t connection_id);
+    void schedule_indication_retry(uint32_t delay_ms);
     
     /**
      * @brief Send Broadcasted Event (encrypted advertisement with value).
@@ -169,6 +338,25 @@ private:
      */
     void send_broadcasted_event(uint16_t iid, const core::Value& value);
     
+    /**
+     * @brief Queue a Broadcasted Event for the advertisement slot.
+     * 
+     * Successive values for a queued IID replace each other, so a fast-changing
+     * sensor costs one advertisement per broadcast slot rather than per change.
+     * Without a scheduler the event is sent immediately.
+     */
+    void queue_broadcasted_event(uint16_t iid, const core::Value& value);
+    
+    /**
+     * @brief Put the next queued broadcast on air once the radio is free,
+     * or return to regular advertising after the last one.
+     */
+    void flush_broadcasts();
+    void cancel_broadcasts();
+    
+    /// Advertising interval configured for the IID's broadcasts
+    uint32_t broadcast_interval_ms(uint16_t iid) const;
+    
     /**
      * @brief Handle Disconnected Event (GSN increment + fast advertising).
      * Per HAP Spec 7.4.6.3: Updates GSN and uses 20ms advertising for 3 seconds.
@@ -178,7 +366,8 @@ private:
     /**
      * @brief Build encrypted advertisement payload per HAP Spec 7.4.7.3.
      */
-    std::vector<uint8_t> build_encrypted_advertisement_payload(uint16_t iid, const core::Value& value);
+    bool build_encrypted_advertisement_payload(uint16_t iid, const core::Value& value,
+                                               std::span<uint8_t, 16> out);
     
     /**
      * @brief Check if broadcast encryption key is valid and not expired.
@@ -189,6 +378,7 @@ private:
     void register_accessory_info_service();
     void register_user_services();
     void register_services_by_type(uint16_t filter_type);
+    void register_accessory_services(const core::Accessory& accessory, uint16_t filter_type);
 };
 
 } // namespace hap::transport
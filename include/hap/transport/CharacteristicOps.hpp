@@ -0,0 +1,67 @@
+#pragma once
+
+#include "hap/core/Characteristic.hpp"
+#include "hap/core/HAPStatus.hpp"
+#include "hap/transport/TimedWriteTable.hpp"
+#include <cstdint>
+#include <optional>
+
+namespace hap::transport {
+
+/**
+ * @brief Characteristic operations shared by HAP-IP and HAP-BLE.
+ *
+ * Transports resolve the target and decode the wire value themselves; these
+ * apply HAP's permission rules, run the characteristic's callbacks and
+ * report a core::HAPStatus, which each transport maps to its wire format
+ * (JSON status for IP, to_ble_status() for BLE). A nullptr characteristic
+ * means the target does not exist.
+ */
+class CharacteristicOps {
+public:
+    struct ReadOutcome {
+        core::HAPStatus status = core::HAPStatus::Success;
+        const core::Value* value = nullptr;  // Stored value or the caller's scratch
+    };
+
+    struct WriteResponseOutcome {
+        core::HAPStatus status = core::HAPStatus::Success;
+        std::optional<core::Value> value;  // Set when there is a value to return
+    };
+
+    /// Whether a controller may read the characteristic (PairedRead)
+    static core::HAPStatus check_read(const core::Characteristic* characteristic);
+
+    /// Whether a controller may write the characteristic (PairedWrite)
+    static core::HAPStatus check_write(const core::Characteristic* characteristic);
+
+    /// Whether the characteristic can notify a subscribed controller
+    static core::HAPStatus check_notify(const core::Characteristic* characteristic);
+
+    /**
+     * @brief Timed-write rule: a characteristic with the TimedWrite permission
+     * only accepts writes backed by a live prepared entry.
+     * @param key PID (IP) or IID (BLE) of the prepared write; nullopt if none
+     */
+    static core::HAPStatus check_timed_write(const core::Characteristic& characteristic,
+                                             const TimedWriteTable& prepared,
+                                             std::optional<uint64_t> key, uint64_t now_ms);
+
+    /**
+     * @brief Checked synchronous read, running the read callback if any.
+     * Characteristics with an async read callback go through read_async().
+     */
+    static ReadOutcome read(const core::Characteristic* characteristic, core::Value& scratch);
+
+    /**
+     * @brief Write-response step after a successful write (HAP Spec 6.7.3,
+     * 7.3.5.5): the write-response callback's value, or the current value.
+     * No-op unless the characteristic has the WriteResponse permission.
+     */
+    static WriteResponseOutcome write_response(core::Characteristic& characteristic);
+
+    /// HAP-BLE PDU status for a result (Spec 7.3.5, Table 7-37)
+    static uint8_t to_ble_status(core::HAPStatus status);
+};
+
+} // namespace hap::transport
@@ -1,10 +1,13 @@
 #pragma once
 
 #include "hap/transport/SecureSession.hpp"
+#include "hap/transport/OutboundQueue.hpp"
+#include "hap/transport/TimedWriteTable.hpp"
 #include "hap/platform/System.hpp"
 #include <memory>
 #include <optional>
-#include <set>
+#include <string>
+#include <tuple>
 #include <utility>
 
 namespace hap::transport {
@@ -41,11 +44,13 @@ public:
      * @param session_keys Tuple of (A2C key, C2A key)
      * @param shared_secret X25519 shared secret
      * @param controller_id Authenticated controller identifier
+     * @param admin Whether the controller's pairing has admin permission
      */
     void upgrade_to_secure(
         std::tuple<std::array<uint8_t, 32>, std::array<uint8_t, 32>> session_keys,
         const std::array<uint8_t, 32>& shared_secret,
-        std::string controller_id);
+        std::string controller_id,
+        bool admin);
 
     /**
      * @brief Get session shared secret
@@ -53,24 +58,48 @@ public:
     const std::array<uint8_t, 32>& session_shared_secret() const { return session_shared_secret_; }
 
     const std::string& controller_id() const { return controller_id_; }
-    bool is_admin() const { return !controller_id_.empty(); } // Currently all paired controllers are admins
+    /// Admin permission of the verified controller's pairing, as of pair-verify
+    bool is_admin() const { return admin_; }
 
     /**
      * @brief Reset pairing state (e.g., on disconnect).
      */
     void reset();
 
+    /**
+     * @brief Return to the freshly constructed state under a new connection id,
+     * keeping allocated buffers. Used when a connection slot is recycled.
+     */
+    void reopen(uint32_t connection_id);
+
+    /**
+     * @brief Set while a deferred response is outstanding. Requests that
+     * arrive meanwhile stay buffered so responses keep their order.
+     */
+    void set_response_pending(bool pending) { response_pending_ = pending; }
+    bool response_pending() const { return response_pending_; }
+
     void request_close() { should_close_ = true; }
     bool should_close() const { return should_close_; }
 
-    // Subscription management
-    void add_subscription(uint64_t aid, uint64_t iid);
-    void remove_subscription(uint64_t aid, uint64_t iid);
-    bool has_subscription(uint64_t aid, uint64_t iid) const;
+    /**
+     * @brief Messages waiting to be sent on this connection.
+     */
+    OutboundQueue& outbound() { return outbound_; }
+    const OutboundQueue& outbound() const { return outbound_; }
     
-    // Timed Write support
+    /**
+     * @brief Prepared timed writes (PUT /prepare), keyed by PID.
+     */
+    TimedWriteTable& timed_writes() { return timed_writes_; }
+    const TimedWriteTable& timed_writes() const { return timed_writes_; }
+
+    // Timed Write support; see CharacteristicOps::check_timed_write()
     void prepare_timed_write(uint64_t pid, uint64_t ttl);
-    bool validate_timed_write(uint64_t pid);
+    /// Consume a prepared write once the request that used it is handled
+    void finish_timed_write(uint64_t pid);
+
+    platform::System* system() const { return system_; }
 
 private:
     platform::Crypto* crypto_;
@@ -79,18 +108,12 @@ private:
     std::unique_ptr<SecureSession> secure_session_;
     bool rx_encrypted_ = false;
     std::string controller_id_;
+    bool admin_ = false;
     std::array<uint8_t, 32> session_shared_secret_ = {};
     bool should_close_ = false;
-    
-    // Subscriptions (AID, IID)
-    std::set<std::pair<uint64_t, uint64_t>> subscriptions_;
-    
-    // Timed Write Transaction
-    struct TimedWriteTransaction {
-        uint64_t pid;
-        uint64_t expiration_time;
-    };
-    std::optional<TimedWriteTransaction> timed_write_;
+    bool response_pending_ = false;
+    OutboundQueue outbound_;
+    TimedWriteTable timed_writes_;
 };
 
 } // namespace hap::transport
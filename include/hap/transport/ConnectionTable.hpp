@@ -0,0 +1,99 @@
+#pragma once
+
+#include "hap/transport/ConnectionContext.hpp"
+#include "hap/transport/HTTP.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hap::transport {
+
+/**
+ * @brief Per-connection state: session context and request parser side by side.
+ */
+struct Connection {
+    Connection(platform::Crypto* crypto, platform::System* system, uint32_t connection_id,
+               size_t arena_bytes)
+        : ctx(crypto, system, connection_id), parser(arena_bytes) {}
+
+    ConnectionContext ctx;
+    HTTPParser parser;
+    
+    // Written by the connection's strand, read by the timeout sweep
+    std::atomic<uint64_t> last_receive_ms{0};
+    std::atomic<uint64_t> request_started_ms{0};  // 0 unless a request is partly received
+    std::atomic<uint64_t> timed_write_expiry_ms{0};  // First ctx.timed_writes() deadline, 0 if none
+    std::atomic<uint64_t> bytes_received{0};  // Raw bytes off the socket, for diagnostics
+
+    // Retry of a backed-up outbound queue: set by tick(), cleared by the strand
+    std::atomic<bool> drain_scheduled{false};  // A drain is posted and has not run yet
+    std::atomic<uint64_t> drain_retry_ms{0};  // Next retry; 0 means as soon as possible
+    std::atomic<uint32_t> drain_backoff_ms{0};  // Doubles on every retry that stays blocked
+};
+
+/**
+ * @brief Fixed-capacity table of HAP-over-IP connections
+ *
+ * All slots (context, parser and request arena) are allocated up front and
+ * recycled, so accepting a controller does not allocate. Connection ids sit
+ * in one contiguous array; with the handful of controllers HAP allows, a scan
+ * of it is a cache line or two and beats hashing. When every slot is taken,
+ * acquire() fails and the caller rejects the connection.
+ *
+ * Connections are handed out as shared_ptr so a strand keeps its connection
+ * alive while the table changes; a released slot that is still referenced
+ * is replaced rather than reused. The table itself is not synchronized.
+ */
+class ConnectionTable {
+public:
+    static constexpr uint32_t FREE = UINT32_MAX;
+
+    ConnectionTable(size_t capacity, platform::Crypto* crypto, platform::System* system,
+                    size_t arena_bytes, size_t outbound_bytes);
+
+    size_t capacity() const { return ids_.size(); }
+    size_t size() const { return size_; }
+
+    /**
+     * @brief Connection with this id, or nullptr.
+     */
+    std::shared_ptr<Connection> find(uint32_t connection_id) const;
+
+    /**
+     * @brief Existing connection with this id, else a fresh one in a free slot.
+     * @param created Set when a slot was claimed for a new connection
+     * @return nullptr when the table is full
+     */
+    std::shared_ptr<Connection> acquire(uint32_t connection_id, bool* created = nullptr);
+
+    /**
+     * @brief Free the slot of this connection.
+     * @return false if no such connection
+     */
+    bool release(uint32_t connection_id);
+
+    void clear();
+
+    template <typename F>
+    void for_each(F&& f) const {
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            if (ids_[i] != FREE) f(ids_[i], slots_[i]);
+        }
+    }
+
+private:
+    size_t index_of(uint32_t connection_id) const;
+    std::shared_ptr<Connection> make_connection(uint32_t connection_id) const;
+
+    platform::Crypto* crypto_;
+    platform::System* system_;
+    size_t arena_bytes_;
+    size_t outbound_bytes_;
+    std::vector<uint32_t> ids_;  // FREE marks an unused slot
+    std::vector<std::shared_ptr<Connection>> slots_;
+    size_t size_ = 0;
+};
+
+} // namespace hap::transport
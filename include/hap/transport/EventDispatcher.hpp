@@ -0,0 +1,111 @@
+#pragma once
+
+#include "hap/core/Characteristic.hpp"
+#include "hap/core/JSONWriter.hpp"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace hap::transport {
+
+/**
+ * @brief Event notification fan-out for HAP-over-IP (HAP Spec 6.8)
+ * 
+ * Keeps a reverse subscription index, (aid, iid) -> connections, so a value
+ * change only visits the controllers that asked for it, and renders the
+ * EVENT/1.0 message once into a reusable buffer before it is encrypted
+ * per connection.
+ * 
+ * Changes can also be queued and flushed together: each connection then
+ * gets one EVENT/1.0 message carrying all pending changes it subscribes
+ * to, and a newer value for the same (aid, iid) replaces the queued one.
+ * 
+ * All methods are thread-safe. flush() holds the internal lock while
+ * invoking the send callback, which must not call back into the dispatcher.
+ */
+class EventDispatcher {
+public:
+    /// `keys` are the (aid << 32) | iid of the changes the message carries
+    using SendFunc = std::function<void(uint32_t connection_id, std::span<const uint8_t> message,
+                                        std::span<const uint64_t> keys)>;
+
+    void subscribe(uint32_t connection_id, uint64_t aid, uint64_t iid);
+    void unsubscribe(uint32_t connection_id, uint64_t aid, uint64_t iid);
+
+    /**
+     * @brief Drop every subscription held by a connection (e.g., on disconnect).
+     */
+    void remove_connection(uint32_t connection_id);
+
+    /**
+     * @brief Drop all subscriptions and queued changes for an accessory (e.g., on removal).
+     */
+    void remove_accessory(uint64_t aid);
+
+    bool is_subscribed(uint32_t connection_id, uint64_t aid, uint64_t iid) const;
+
+    bool has_subscribers(uint64_t aid, uint64_t iid) const;
+
+    /**
+     * @brief Number of characteristics a connection is subscribed to.
+     */
+    size_t subscription_count(uint32_t connection_id) const;
+
+    /**
+     * @brief Snapshot of the connections subscribed to a characteristic.
+     */
+    std::vector<uint32_t> subscribers(uint64_t aid, uint64_t iid) const;
+
+    /**
+     * @brief Render an EVENT/1.0 message for a single value change.
+     * @return Plaintext message, valid until the next render call
+     */
+    std::span<const uint8_t> render_event(uint64_t aid, uint64_t iid, const core::Value& value);
+
+    /**
+     * @brief Queue a value change, replacing a pending one for the same (aid, iid).
+     * @param exclude_conn_id Connection that must not be notified (the writer)
+     * @return true if the queue was empty, i.e. a flush needs scheduling
+     */
+    bool enqueue(uint64_t aid, uint64_t iid, const core::Value& value, uint32_t exclude_conn_id);
+
+    bool has_pending() const;
+
+    /**
+     * @brief Render and hand out one message per subscribed connection, then clear the queue.
+     * Connections with identical change sets share a single rendered message.
+     */
+    void flush(const SendFunc& send);
+
+private:
+    struct PendingChange {
+        uint64_t key;
+        uint64_t aid;
+        uint64_t iid;
+        core::Value value;
+        uint32_t exclude_conn_id;
+    };
+
+    const std::vector<uint32_t>* find_subscribers(uint64_t key) const;
+    void render_pending(const std::vector<PendingChange>& pending, std::span<const uint32_t> indices);
+    void frame_body();
+    static void write_change(core::JSONWriter& writer, uint64_t aid, uint64_t iid, const core::Value& value);
+
+    static constexpr uint64_t pack_key(uint64_t aid, uint64_t iid) {
+        return (aid << 32) | (iid & 0xFFFFFFFF);
+    }
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> subscribers_;
+    std::unordered_map<uint32_t, std::vector<uint64_t>> connection_keys_;
+    std::vector<PendingChange> pending_;
+
+    // Reused across events so steady-state notifications do not allocate
+    std::vector<uint8_t> body_;
+    std::vector<uint8_t> message_;
+};
+
+} // namespace hap::transport
@@ -1,8 +1,14 @@
 #pragma once
 
+#include "hap/common/RequestArena.hpp"
+#include <array>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <map>
+#include <optional>
 #include <span>
 #include <cstdint>
 
@@ -31,15 +37,120 @@ enum class Status {
 
 using Headers = std::map<std::string, std::string>;
 
+/**
+ * @brief Compact request header list.
+ * 
+ * All names and values share one string allocation and are indexed by a
+ * small fixed array of offsets, so lookups never allocate. Lookup is
+ * case-insensitive (RFC 7230 3.2). add() refuses headers beyond kMaxFields.
+ */
+class HeaderList {
+public:
+    static constexpr size_t kMaxFields = 16;
+
+    HeaderList() = default;
+    explicit HeaderList(std::pmr::memory_resource* resource) : storage_(resource) {}
+
+    /// @return false if the list is full and the header was not stored
+    bool add(std::string_view name, std::string_view value) {
+        if (count_ >= kMaxFields) return false;
+        Field& f = fields_[count_++];
+        f.name_off = static_cast<uint32_t>(storage_.size());
+        f.name_len = static_cast<uint32_t>(name.size());
+        storage_.append(name);
+        f.value_off = static_cast<uint32_t>(storage_.size());
+        f.value_len = static_cast<uint32_t>(value.size());
+        storage_.append(value);
+        return true;
+    }
+
+    /**
+     * @brief Find a header value; empty if absent.
+     */
+    std::string_view get(std::string_view name) const {
+        for (size_t i = 0; i < count_; ++i) {
+            if (iequals(name_at(i), name)) return value_at(i);
+        }
+        return {};
+    }
+
+    bool contains(std::string_view name) const {
+        for (size_t i = 0; i < count_; ++i) {
+            if (iequals(name_at(i), name)) return true;
+        }
+        return false;
+    }
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    void reserve(size_t bytes) { storage_.reserve(bytes); }
+
+    class const_iterator {
+    public:
+        const_iterator(const HeaderList* list, size_t index) : list_(list), index_(index) {}
+        std::pair<std::string_view, std::string_view> operator*() const {
+            return {list_->name_at(index_), list_->value_at(index_)};
+        }
+        const_iterator& operator++() { ++index_; return *this; }
+        bool operator!=(const const_iterator& other) const { return index_ != other.index_; }
+    private:
+        const HeaderList* list_;
+        size_t index_;
+    };
+
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, count_}; }
+
+    static bool iequals(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            char x = a[i], y = b[i];
+            if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+            if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+            if (x != y) return false;
+        }
+        return true;
+    }
+
+private:
+    // Offsets rather than views so the list stays valid when moved
+    struct Field {
+        uint32_t name_off, name_len, value_off, value_len;
+    };
+
+    std::string_view name_at(size_t i) const {
+        return std::string_view(storage_).substr(fields_[i].name_off, fields_[i].name_len);
+    }
+    std::string_view value_at(size_t i) const {
+        return std::string_view(storage_).substr(fields_[i].value_off, fields_[i].value_len);
+    }
+
+    std::pmr::string storage_;
+    std::array<Field, kMaxFields> fields_{};
+    size_t count_ = 0;
+};
+
+/**
+ * @brief Parsed HTTP request.
+ * 
+ * Strings and the body use a memory resource so HTTPParser can place a
+ * request in its connection's RequestArena; default-constructed requests
+ * use the heap.
+ */
 struct Request {
-    Method method;
-    std::string path;
-    Headers headers;
-    std::vector<uint8_t> body;
+    Method method = Method::GET;
+    std::pmr::string path;   // Request target up to '?'
+    std::pmr::string query;  // Text after '?', split off once by the parser
+    HeaderList headers;
+    std::pmr::vector<uint8_t> body;
+
+    Request() = default;
+    explicit Request(std::pmr::memory_resource* resource)
+        : path(resource), query(resource), headers(resource), body(resource) {}
 
-    std::string get_header(const std::string& key) const {
-        auto it = headers.find(key);
-        return it != headers.end() ? it->second : "";
+    std::string_view get_header(std::string_view key) const {
+        return headers.get(key);
     }
 };
 
@@ -47,21 +158,31 @@ struct Response {
     Status status;
     Headers headers;
     std::vector<uint8_t> body;
+    bool is_deferred = false;  // The handler sends the real response later
 
     Response(Status s = Status::OK) : status(s) {}
 
+    /**
+     * @brief Placeholder returned by handlers that answer asynchronously.
+     * Nothing is sent, and later requests on the connection wait for it.
+     */
+    static Response deferred() {
+        Response response;
+        response.is_deferred = true;
+        return response;
+    }
+
     void set_header(const std::string& key, const std::string& value) {
         headers[key] = value;
     }
 
+    // Content-Length is added by HTTPBuilder from the final body size
     void set_body(std::vector<uint8_t> b) {
         body = std::move(b);
-        headers["Content-Length"] = std::to_string(body.size());
     }
 
     void set_body(std::string_view text) {
         body.assign(text.begin(), text.end());
-        headers["Content-Length"] = std::to_string(body.size());
     }
 };
 
@@ -71,32 +192,73 @@ struct Response {
  */
 class HTTPParser {
 public:
-    HTTPParser();
+    /**
+     * @param arena_bytes Size of the per-parser RequestArena that requests
+     *        are built in; 0 allocates them on the heap.
+     */
+    explicit HTTPParser(size_t arena_bytes = 0);
 
     // Feed data from TCP stream
     // Returns true if a complete request was parsed
     bool feed(std::span<const uint8_t> data);
 
-    // Get the parsed request (only valid after feed returns true)
+    // Receive buffer for producers that write plaintext directly into the
+    // parser (e.g. in-place decryption). Call parse() after appending.
+    std::vector<uint8_t>& receive_buffer() { return buffer_; }
+
+    // Parse bytes already appended to receive_buffer()
+    // Returns true if a complete request was parsed
+    bool parse();
+
+    // Get the parsed request (only valid after feed returns true).
+    // The parser is then ready for the next request; bytes already
+    // received beyond this request are kept, so call parse() to pick up
+    // pipelined requests.
     Request take_request();
 
-    // Reset parser state for next request
+    // Reset parser state and discard any buffered bytes
     void reset();
 
+    // Rewind the request arena. Call once every Request taken from this
+    // parser has been destroyed; ignored while a request is half parsed.
+    void release_request_memory();
+
+    // Largest request (request line, headers and body) accepted; 0 means
+    // no limit. A longer request puts the parser in the failed() state.
+    void set_max_request_bytes(size_t max_bytes) { max_request_bytes_ = max_bytes; }
+
+    // Set once a request exceeded the limit or was malformed; only reset()
+    // clears it
+    bool failed() const { return state_ == State::Failed; }
+
+    // The failure was a malformed head (too many headers, bad Content-Length)
+    // rather than the size limit; the peer should get a 400
+    bool malformed() const { return malformed_; }
+
+    // True while part of a request has been received but not all of it
+    bool has_partial_request() const { return state_ != State::RequestLine || !buffer_.empty(); }
+
 private:
     enum class State {
         RequestLine,
         Headers,
         Body,
-        Complete
+        Complete,
+        Failed
     };
 
     State state_;
+    std::unique_ptr<common::RequestArena> arena_;  // Declared before the request built in it
     std::vector<uint8_t> buffer_;
+    size_t read_pos_;  // Bytes of buffer_ already consumed by the parser
     Request current_request_;
     size_t body_bytes_read_;
     size_t expected_body_length_;
+    size_t head_bytes_ = 0;  // Request line and header bytes of current_request_
+    size_t max_request_bytes_ = 0;
+    bool malformed_ = false;
 
+    std::optional<std::string_view> next_line();
     bool parse_request_line();
     bool parse_headers();
 };
@@ -107,6 +269,19 @@ private:
 class HTTPBuilder {
 public:
     static std::vector<uint8_t> build(const Response& response);
+
+    // Append the status line and headers to out; send response.body after it.
+    // Content-Length is written from body.size() (omitted for 204), so the
+    // body can stay in its own buffer and never be copied next to the head.
+    static void append_head(const Response& response, std::vector<uint8_t>& out);
+
+    // Upper bound of the bytes append_head() writes
+    static size_t head_size(const Response& response);
+
+    // Head with a single Content-Type header, written without a Response or
+    // Headers map; used for pairing replies on the plaintext fast path.
+    static void append_head(Status status, std::string_view content_type, size_t content_length,
+                            std::vector<uint8_t>& out);
 };
 
 } // namespace hap::transport
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace hap::transport {
+
+/**
+ * @brief Bounded per-connection send queue
+ * 
+ * Messages are kept as plaintext and only encrypted when they leave the
+ * queue, so frame nonces follow the actual send order. Request responses
+ * always go before events. When queued bytes exceed the limit, queued events
+ * whose characteristics the new event all carries are replaced by it, since
+ * it holds their newest values. Only if that does not make room are the
+ * oldest events dropped: a controller that cannot keep up loses stale
+ * notifications rather than stalling the server. Responses are never dropped.
+ * 
+ * The queue itself is owned by one connection strand; only has_pending()
+ * and stats() may be called from other threads.
+ */
+class OutboundQueue {
+public:
+    enum class Priority : uint8_t {
+        Response,
+        Event
+    };
+
+    struct Message {
+        Priority priority = Priority::Response;
+        bool encrypt = false;           // Seal with the connection's SecureSession on send
+        std::vector<uint8_t> head;      // Sent first (e.g., HTTP status line and headers)
+        std::vector<uint8_t> body;
+        std::vector<uint64_t> keys;     // Events: characteristics carried, (aid << 32) | iid
+
+        size_t size() const { return head.size() + body.size(); }
+    };
+
+    struct Stats {
+        size_t depth = 0;               // Messages currently queued
+        size_t queued_bytes = 0;
+        size_t high_water_bytes = 0;    // Largest queued_bytes seen
+        uint64_t sent_messages = 0;
+        uint64_t sent_events = 0;
+        uint64_t sent_bytes = 0;        // Plaintext bytes of sent messages
+        uint64_t sealed_frames = 0;     // Encrypted frames those messages went out in
+        uint64_t dropped_events = 0;
+        uint64_t replaced_events = 0;   // Superseded by a newer event for the same characteristics
+    };
+
+    static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024;
+
+    explicit OutboundQueue(size_t max_bytes = DEFAULT_MAX_BYTES) : max_bytes_(max_bytes) {}
+
+    void set_max_bytes(size_t max_bytes) { max_bytes_ = max_bytes; }
+
+    /**
+     * @brief Queue a message; events may be dropped to honour the byte limit.
+     */
+    void push(Message message);
+
+    /**
+     * @brief Next message to send (responses first), or nullptr if empty.
+     */
+    Message* front();
+
+    /**
+     * @brief Remove the message returned by front() after it was sent.
+     * @param sealed_frames Encrypted frames it was sent in (0 if plaintext)
+     */
+    void pop(uint64_t sealed_frames = 0);
+
+    bool empty() const { return responses_.empty() && events_.empty(); }
+    void clear();
+
+    /**
+     * @brief Thread-safe hint that messages are waiting (e.g., for tick()).
+     */
+    bool has_pending() const { return pending_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Thread-safe snapshot of the queue metrics.
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Zero the counters, e.g. when the slot serves a new connection.
+     * depth and queued_bytes still describe what is queued.
+     */
+    void reset_stats();
+
+private:
+    void drop_oldest_event();
+    void replace_superseded_events(const Message& newer);
+    void update_depth();
+
+    size_t max_bytes_;
+    std::deque<Message> responses_;
+    std::deque<Message> events_;
+    std::atomic<bool> pending_{false};
+    mutable std::mutex stats_mutex_;
+    Stats stats_;
+};
+
+} // namespace hap::transport
@@ -1,16 +1,21 @@
 #pragma once
 
+#include "hap/common/Metrics.hpp"
 #include "hap/transport/HTTP.hpp"
 #include "hap/transport/ConnectionContext.hpp"
 #include "hap/pairing/PairSetup.hpp"
 #include "hap/pairing/PairVerify.hpp"
-#include "hap/platform/Storage.hpp"
+#include "hap/pairing/PairingStore.hpp"
+#include "hap/pairing/SessionCache.hpp"
 #include "hap/platform/System.hpp"
 #include "hap/platform/CryptoSRP.hpp"
 #include <string>
 #include <array>
 #include <map>
 #include <functional>
+#include <optional>
+#include <span>
+#include <vector>
 
 namespace hap::transport {
 
@@ -21,10 +26,12 @@ class PairingEndpoints {
 public:
     struct Config {
         platform::CryptoSRP* crypto;
-        platform::Storage* storage;
+        pairing::PairingStore* pairing_store;
+        pairing::SRPVerifierCache* srp_verifiers = nullptr;
         platform::System* system;
         std::string accessory_id;
         std::string setup_code;
+        common::Metrics* metrics = nullptr;  ///< Times Pair Verify messages when set
         /// Callback for pairing changes: (pairing_id, ltpk, is_add)
         std::function<void(const std::string&, const std::array<uint8_t, 32>&, bool)> on_pairings_changed = nullptr;
     };
@@ -41,6 +48,18 @@ public:
      */
     Response handle_pair_verify(const Request& req, ConnectionContext& ctx);
 
+    /**
+     * @brief Run one Pair Setup step on a request TLV.
+     * @return Response TLV, or nullopt if the session produced none
+     */
+    std::optional<std::vector<uint8_t>> pair_setup(std::span<const uint8_t> body, ConnectionContext& ctx);
+
+    /**
+     * @brief Run one Pair Verify step; upgrades ctx once verified.
+     * @return Response TLV, or nullopt if the session produced none
+     */
+    std::optional<std::vector<uint8_t>> pair_verify(std::span<const uint8_t> body, ConnectionContext& ctx);
+
     /**
      * @brief POST /pairings handler
      */
@@ -56,8 +75,14 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Verified sessions available for Pair Resume.
+     */
+    pairing::SessionCache& session_cache() { return session_cache_; }
+
 private:
     Config config_;
+    pairing::SessionCache session_cache_;
     
     // Per-connection pairing state
     std::map<uint32_t, std::unique_ptr<pairing::PairSetup>> pair_setup_sessions_;
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "hap/common/Metrics.hpp"
+#include "hap/common/Result.hpp"
 #include "hap/transport/HTTP.hpp"
+#include <array>
 #include <functional>
 #include <vector>
 #include <string>
-#include <optional>
+#include <string_view>
+#include <unordered_map>
 
 namespace hap::transport {
 
@@ -16,38 +20,88 @@ class ConnectionContext;
  */
 using RouteHandler = std::function<Response(const Request&, ConnectionContext&)>;
 
+/**
+ * @brief Statically bound handler: a plain function pointer and the object it
+ * works on. Calling it is one indirect call with nothing type-erased to copy
+ * or allocate; Router::add_route<&T::member>() builds one.
+ */
+struct RouteTarget {
+    using Fn = Response (*)(void* object, const Request&, ConnectionContext&);
+    Fn fn = nullptr;
+    void* object = nullptr;
+};
+
 /**
  * @brief HTTP Route Definition
  */
 struct Route {
     Method method;
     std::string path;
-    RouteHandler handler;
+    RouteTarget target;     // Used when set
+    RouteHandler handler;   // Otherwise this
     bool requires_pairing;  // True if endpoint requires verified pairing
 };
 
 /**
- * @brief Simple HTTP Router
+ * @brief HTTP Router with an exact-match (path, method) index.
+ * 
+ * Paths are matched without their query (Request::path is already split by
+ * the parser). Lookup is one hash of the path plus an array index by method,
+ * independent of how many routes are registered.
  */
 class Router {
 public:
     Router();
 
     /**
-     * @brief Register a route.
+     * @brief Register a route. A later route for the same method and path replaces the earlier one.
      */
     void add_route(Method method, std::string path, RouteHandler handler, bool requires_pairing = false);
 
+    /**
+     * @brief Register a member function of `object` as a route, called without
+     * std::function. The object must outlive the router.
+     *
+     *   router.add_route<&Endpoints::handle_get>(Method::GET, "/things", &endpoints, true);
+     */
+    template <auto Handler, typename T>
+    void add_route(Method method, std::string path, T* object, bool requires_pairing = false) {
+        insert({method, std::move(path), RouteTarget{&invoke<Handler, T>, object}, {}, requires_pairing});
+    }
+
     /**
      * @brief Dispatch an HTTP request to the appropriate handler.
-     * @return Response, or nullopt if no route matches
+     * @return The handler's response, moved through; ErrorCode::NotFound if no route matches
      */
-    std::optional<Response> dispatch(const Request& req, ConnectionContext& ctx);
+    common::Result<Response> dispatch(const Request& req, ConnectionContext& ctx);
+
+    /**
+     * @brief Record route lookup and handler latency (nullptr disables).
+     */
+    void set_metrics(common::Metrics* metrics) { metrics_ = metrics; }
 
 private:
+    static constexpr size_t kMethodCount = static_cast<size_t>(Method::OPTIONS) + 1;
+    static constexpr uint16_t kNoRoute = UINT16_MAX;
+    
+    // Heterogeneous lookup so dispatch hashes the request path without copying it
+    struct PathHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view path) const { return std::hash<std::string_view>{}(path); }
+    };
+    
     std::vector<Route> routes_;
+    // Path -> route index per method (kNoRoute when the method is not registered)
+    std::unordered_map<std::string, std::array<uint16_t, kMethodCount>, PathHash, std::equal_to<>> index_;
+    common::Metrics* metrics_ = nullptr;
+    
+    const Route* find(Method method, std::string_view path) const;
+    void insert(Route route);
     
-    bool path_matches(const std::string& pattern, const std::string& path);
+    template <auto Handler, typename T>
+    static Response invoke(void* object, const Request& req, ConnectionContext& ctx) {
+        return (static_cast<T*>(object)->*Handler)(req, ctx);
+    }
 };
 
 } // namespace hap::transport
@@ -5,18 +5,27 @@
 #include <vector>
 #include <cstdint>
 #include <optional>
+#include <span>
 
 namespace hap::transport {
 
 /**
  * @brief Secure Session for Transport (HAP Spec 6.5.2)
  * 
- * Encrypts/decrypts HTTP frames using ChaCha20-Poly1305 AEAD.
+ * Encrypts/decrypts HTTP frames using ChaCha20-Poly1305 AEAD, handing up to
+ * BATCH_FRAMES frames at a time to the platform's batched AEAD calls.
  * Frame format: <2-byte length><encrypted data><16-byte auth tag>
  * Nonce: 96-bit counter (little-endian)
  */
 class SecureSession {
 public:
+    // Largest plaintext carried by one frame (HAP Spec 6.5.2)
+    static constexpr size_t MAX_FRAME_PAYLOAD = 1024;
+    static constexpr size_t LENGTH_SIZE = 2;
+    static constexpr size_t AUTH_TAG_SIZE = 16;
+    // Frames handed to the platform per batched AEAD call
+    static constexpr size_t BATCH_FRAMES = 8;
+
     SecureSession(platform::Crypto* crypto, std::array<uint8_t, 32> a2c, std::array<uint8_t, 32> c2a);
 
     /**
@@ -26,6 +35,51 @@ public:
      */
     std::vector<uint8_t> encrypt_frame(std::span<const uint8_t> plaintext_http);
 
+    /**
+     * @brief Seal one frame that the caller laid out in its own buffer.
+     * 
+     * `frame` is <2 bytes><plaintext><16 bytes>; the length prefix and tag
+     * are filled in and the plaintext is encrypted in place, so nothing is
+     * allocated. The plaintext must not exceed MAX_FRAME_PAYLOAD.
+     * @return false if the layout is invalid or encryption fails
+     */
+    bool encrypt_frame_in_place(std::span<uint8_t> frame);
+
+    /**
+     * @brief Encrypt a whole response as consecutive frames appended to out.
+     * 
+     * Plaintext is split into MAX_FRAME_PAYLOAD chunks; out is grown once to
+     * sealed_size() and every length|ciphertext|tag frame is written in place,
+     * so the result can go out in a single tcp_send.
+     * @return false if encryption fails (out is left unchanged). Write
+     *         nonces may already be consumed, so the session is out of step
+     *         with the controller and the connection has to be closed.
+     */
+    bool encrypt_frames_into(std::span<const uint8_t> plaintext, std::vector<uint8_t>& out);
+
+    /**
+     * @brief Encrypt head followed by body as one frame stream.
+     * 
+     * Same output as sealing the concatenation, without building it: only the
+     * frame that straddles the two is assembled in `out` and sealed in place,
+     * every other frame reads straight from head or body. Fails like the
+     * single-buffer overload: out unchanged, connection to be closed.
+     */
+    bool encrypt_frames_into(std::span<const uint8_t> head, std::span<const uint8_t> body,
+                             std::vector<uint8_t>& out);
+
+    /**
+     * @brief Bytes encrypt_frames_into() appends for a plaintext of this size.
+     */
+    static size_t sealed_size(size_t plaintext_size);
+
+    /**
+     * @brief Open one complete <length><ciphertext><tag> frame in place.
+     * @return The plaintext inside `frame`, or nullopt if the frame is
+     *         malformed or authentication fails
+     */
+    std::optional<std::span<uint8_t>> decrypt_frame_in_place(std::span<uint8_t> frame);
+
     /**
      * @brief Decrypt received TCP data and extract HTTP frames.
      * Feed this method with incoming TCP chunks.
@@ -34,6 +88,34 @@ public:
      */
     std::optional<std::vector<uint8_t>> decrypt_frame(std::span<const uint8_t> encrypted_data);
 
+    /**
+     * @brief Decrypt the next complete frame, appending plaintext to out.
+     * 
+     * Ciphertext is decrypted straight from encrypted_data when no partial
+     * frame is pending; only incomplete or surplus bytes are buffered.
+     * @param encrypted_data Raw TCP data (may contain partial frames)
+     * @param out Destination buffer, e.g. HTTPParser::receive_buffer()
+     * @return Plaintext bytes appended (0 if no complete frame yet),
+     *         or nullopt if authentication fails
+     */
+    std::optional<size_t> decrypt_frame_into(std::span<const uint8_t> encrypted_data, std::vector<uint8_t>& out);
+
+    /**
+     * @brief Decrypt every complete frame available, appending plaintext to out.
+     * 
+     * Controllers may coalesce several frames into one TCP segment; draining
+     * them all avoids leaving requests buffered until the next packet.
+     * @return Total plaintext bytes appended (0 if no complete frame yet),
+     *         or nullopt if authentication fails or a frame announces more
+     *         than MAX_FRAME_PAYLOAD bytes
+     */
+    std::optional<size_t> decrypt_all_frames_into(std::span<const uint8_t> encrypted_data, std::vector<uint8_t>& out);
+
+    /**
+     * @brief True while the start of a frame is buffered waiting for the rest.
+     */
+    bool has_partial_frame() const { return !read_buffer_.empty(); }
+
     /**
      * @brief Reset nonces (e.g., after re-verification).
      */
@@ -49,6 +131,14 @@ public:
      */
     std::vector<uint8_t> encrypt_ble_pdu(std::span<const uint8_t> plaintext);
 
+    /**
+     * @brief Encrypt a BLE PDU in place and append its authTag.
+     * @param buffer Plaintext in the first plaintext_size bytes, followed by
+     *        at least AUTH_TAG_SIZE bytes of room for the tag
+     * @return Encrypted size (plaintext_size + AUTH_TAG_SIZE), or nullopt on failure
+     */
+    std::optional<size_t> encrypt_ble_pdu_in_place(std::span<uint8_t> buffer, size_t plaintext_size);
+
     /**
      * @brief Decrypt a received BLE HAP PDU.
      * @param encrypted_data Raw GATT data: <ciphertext><16-byte authTag>
@@ -56,6 +146,13 @@ public:
      */
     std::optional<std::vector<uint8_t>> decrypt_ble_pdu(std::span<const uint8_t> encrypted_data);
 
+    /**
+     * @brief Decrypt a BLE PDU in place.
+     * @param pdu <ciphertext><16-byte authTag>; the plaintext replaces the ciphertext
+     * @return Plaintext size, or nullopt if auth fails
+     */
+    std::optional<size_t> decrypt_ble_pdu_in_place(std::span<uint8_t> pdu);
+
 private:
     platform::Crypto* crypto_;
     std::array<uint8_t, 32> a2c_;
@@ -67,6 +164,8 @@ private:
     std::vector<uint8_t> read_buffer_;
     
     std::array<uint8_t, 12> build_nonce(uint64_t counter);
+    platform::Crypto::AeadSealFrame prepare_seal(std::span<const uint8_t> plaintext, uint8_t* frame);
+    std::optional<size_t> decrypt_frames(std::span<const uint8_t> encrypted_data, std::vector<uint8_t>& out, size_t max_frames);
 };
 
 } // namespace hap::transport
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace hap::transport {
+
+/**
+ * @brief Prepared timed writes of one connection, keyed by transaction
+ *
+ * HAP-IP keys entries by the PID of `PUT /prepare`; HAP-BLE keys them by the
+ * characteristic IID and keeps the TimedWrite body until ExecuteWrite. Up to
+ * CAPACITY writes can be prepared at once, so a scene touching several locks
+ * or doors does not have to serialize its prepare/write cycles. Entries live
+ * in a fixed array, so lookups are a short scan and nothing is allocated
+ * besides BLE payloads.
+ *
+ * Expired entries are never returned. expire() frees them eagerly; callers
+ * schedule it at next_expiry(). Not synchronized: owned by one connection.
+ */
+class TimedWriteTable {
+public:
+    static constexpr size_t CAPACITY = 8;
+
+    /**
+     * @brief Prepare (or re-prepare) a write. When the table is full the
+     * entry closest to expiring is evicted.
+     * @param payload Body to execute later (BLE); empty for IP
+     */
+    void prepare(uint64_t key, uint64_t expires_ms, std::vector<uint8_t> payload = {});
+
+    /**
+     * @brief Whether a prepared write with this key is still live.
+     */
+    bool contains(uint64_t key, uint64_t now_ms) const;
+
+    /**
+     * @brief Remove the entry and return its payload.
+     * @return nullopt if there is no live entry with this key
+     */
+    std::optional<std::vector<uint8_t>> take(uint64_t key, uint64_t now_ms);
+
+    /**
+     * @brief Drop every entry past its deadline.
+     * @return Number of entries dropped
+     */
+    size_t expire(uint64_t now_ms);
+
+    /**
+     * @brief Deadline of the entry that expires first.
+     */
+    std::optional<uint64_t> next_expiry() const;
+
+    size_t size() const { return size_; }
+    void clear();
+
+private:
+    struct Entry {
+        uint64_t key = 0;
+        uint64_t expires_ms = 0;
+        std::vector<uint8_t> payload;
+    };
+
+    size_t find(uint64_t key) const;
+    void remove(size_t index);
+
+    std::array<Entry, CAPACITY> entries_;  // [0, size_) are in use
+    size_t size_ = 0;
+};
+
+} // namespace hap::transport
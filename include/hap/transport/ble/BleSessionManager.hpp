@@ -2,10 +2,15 @@
 
 #include "hap/transport/ble/HapPdu.hpp"
 #include "hap/transport/ConnectionContext.hpp"
+#include "hap/transport/TimedWriteTable.hpp"
 #include "hap/platform/System.hpp"
+#include "hap/common/TaskScheduler.hpp"
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 namespace hap::transport::ble {
@@ -18,17 +23,20 @@ struct TransactionState {
     PDUOpcode opcode = PDUOpcode::CharacteristicRead;
     uint16_t transaction_id = 0;
     bool active = false;
-    std::string target_uuid;                // UUID of the characteristic being written
+    bool ready = false;                     // Complete PDU queued for processing
+    uint16_t target_handle = 0xFFFF;        // GATT handle of the characteristic being written
     uint8_t ttl = 0;                        // Timed Write TTL
-    std::vector<uint8_t> response_buffer;   // Buffer for GATT Read response
+    std::vector<uint8_t> response_buffer;   // GATT Read response, all fragments back to back
+    std::vector<uint32_t> response_fragment_ends; // End offset of each fragment, empty if unfragmented
+    size_t response_fragment = 0;           // Next fragment a GATT Read returns
     uint64_t last_activity_ms = 0;          // Timestamp of last HAP transaction
     uint64_t procedure_start_ms = 0;        // Timestamp when procedure started
     uint64_t connection_established_ms = 0; // Timestamp when connection established
     uint64_t last_write_ms = 0;             // Timestamp of last write
     uint16_t expected_body_length = 0;      // Expected body length from PDU header
+    size_t expected_total = 0;              // Full PDU size once the header is in, 0 until then
     bool gsn_incremented = false;           // Per spec: GSN increments only once per connection
-    std::vector<uint8_t> timed_write_body;  // Body data pending for ExecuteWrite
-    uint16_t timed_write_iid = 0;           // IID for pending timed write
+    TimedWriteTable timed_writes;           // Bodies pending for ExecuteWrite, keyed by IID
 };
 
 /**
@@ -36,8 +44,17 @@ struct TransactionState {
  */
 struct BleSession {
     uint16_t connection_id = 0;
+    uint16_t att_mtu = 0;  // Negotiated ATT MTU, 0 until the platform reports one
     std::unique_ptr<ConnectionContext> context;
     TransactionState transaction;
+    common::TaskScheduler::TaskId timeout_task = common::TaskScheduler::INVALID_TASK_ID;
+    uint64_t timeout_task_at_ms = 0;  // When timeout_task fires
+    
+    // Connected Events not yet handed to the stack: GATT handles in change
+    // order, each at most once since the indication carries no value
+    std::vector<uint16_t> pending_indications;
+    bool indication_in_flight = false;  // Sent, controller has not confirmed yet
+    uint64_t indication_sent_ms = 0;
     
     BleSession() = default;
     BleSession(uint16_t conn_id) : connection_id(conn_id) {}
@@ -57,11 +74,23 @@ struct BleSession {
  * - Transaction state per connection
  * - Timeout checking (idle, procedure, initial)
  * - Subscription tracking
+ * 
+ * With a scheduler, each session carries one timer set to its earliest
+ * deadline instead of being polled; prepared timed writes that expire
+ * are dropped by the same timer. Activity only moves timestamps; a timer
+ * that fires early re-arms itself for the remaining time.
  */
 class BleSessionManager {
 public:
-    explicit BleSessionManager(platform::System* system);
-    ~BleSessionManager() = default;
+    using TimeoutHandler = std::function<void(uint16_t connection_id)>;
+    
+    /**
+     * @param mutex Lock the owner holds around session state, if it is shared
+     * between threads; timer tasks take it before touching a session
+     */
+    explicit BleSessionManager(platform::System* system, common::TaskScheduler* scheduler = nullptr,
+                               std::recursive_mutex* mutex = nullptr);
+    ~BleSessionManager();
     
     BleSessionManager(const BleSessionManager&) = delete;
     BleSessionManager& operator=(const BleSessionManager&) = delete;
@@ -102,6 +131,20 @@ public:
      */
     [[nodiscard]] std::vector<uint16_t> check_timeouts();
     
+    /**
+     * @brief Called from the scheduler when a session's deadline passes.
+     * The session is still present; the handler decides how to tear it down.
+     */
+    void set_timeout_handler(TimeoutHandler handler) { timeout_handler_ = std::move(handler); }
+    
+    /**
+     * @brief Make sure the session's timer fires by its current deadline.
+     * 
+     * Call after updating its timestamps. Cheap when the armed timer already
+     * fires no later than the new deadline, which is the common case.
+     */
+    void arm_timeout(uint16_t connection_id);
+    
     /**
      * @brief Get all active connection IDs.
      */
@@ -112,32 +155,43 @@ public:
      */
     [[nodiscard]] size_t session_count() const { return sessions_.size(); }
     
-    // Subscription management
+    // Subscription management, keyed by the transport's GATT handle index
     
     /**
      * @brief Add a subscription for a connection.
      */
-    void add_subscription(const std::string& uuid, uint16_t connection_id);
+    void add_subscription(uint16_t handle, uint16_t connection_id);
     
     /**
      * @brief Remove a subscription for a connection.
      */
-    void remove_subscription(const std::string& uuid, uint16_t connection_id);
+    void remove_subscription(uint16_t handle, uint16_t connection_id);
     
     /**
-     * @brief Get all subscribers for a UUID.
+     * @brief Get all subscribers for a characteristic handle.
      */
-    [[nodiscard]] const std::vector<uint16_t>& get_subscribers(const std::string& uuid) const;
+    [[nodiscard]] const std::vector<uint16_t>& get_subscribers(uint16_t handle) const;
     
     /**
-     * @brief Check if a UUID has any subscribers.
+     * @brief Check if a characteristic handle has any subscribers.
      */
-    [[nodiscard]] bool has_subscribers(const std::string& uuid) const;
+    [[nodiscard]] bool has_subscribers(uint16_t handle) const;
 
 private:
+    struct Deadline {
+        uint64_t at_ms;      // Session is expired once the clock passes this
+        const char* reason;
+    };
+    [[nodiscard]] std::optional<Deadline> timeout_deadline(const BleSession& session) const;
+    void cancel_timeout(BleSession& session);
+    void on_timeout_task(uint16_t connection_id);
+    
     platform::System* system_;
+    common::TaskScheduler* scheduler_;
+    std::recursive_mutex* mutex_;
+    TimeoutHandler timeout_handler_;
     std::map<uint16_t, BleSession> sessions_;
-    std::map<std::string, std::vector<uint16_t>> subscriptions_;
+    std::vector<std::vector<uint16_t>> subscriptions_;  // Indexed by handle
     
     static constexpr uint64_t kIdleTimeoutMs = 30000;      // 30 seconds
     static constexpr uint64_t kProcedureTimeoutMs = 10000; // 10 seconds
@@ -78,6 +78,11 @@ public:
      */
     [[nodiscard]] std::vector<uint8_t> build() const { return buffer_; }
     
+    /**
+     * @brief View the TLV data without copying it.
+     */
+    [[nodiscard]] std::span<const uint8_t> data() const { return buffer_; }
+    
     /**
      * @brief Get current buffer size.
      */
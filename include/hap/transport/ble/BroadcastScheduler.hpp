@@ -0,0 +1,84 @@
+#pragma once
+
+#include "hap/core/Characteristic.hpp"
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace hap::transport::ble {
+
+/**
+ * @brief Shares the single advertisement slot between Broadcasted Events.
+ *
+ * An encrypted broadcast (HAP Spec 7.4.6.2) carries one characteristic
+ * value, and the radio has room for one at a time. Changes are queued with
+ * one entry per IID holding its latest value, and the queue is served round
+ * robin: each broadcast stays on air for its slot, then the next IID gets the
+ * radio, and an IID that changes again goes to the back. A value equal to
+ * the last one broadcast for its IID is dropped, so radio time goes only to
+ * news.
+ *
+ * A slot lasts kMinSlotMs, stretched to kMinAdvertisements advertising
+ * events at slow intervals (1280/2560 ms), so every broadcast is actually
+ * heard a few times. The scheduler only decides; the transport keeps time,
+ * puts the returned slot on air and restores regular advertising when
+ * release() reports the radio free and nothing is left.
+ */
+class BroadcastScheduler {
+public:
+    static constexpr uint32_t kMinSlotMs = 3000;
+    static constexpr uint32_t kMinAdvertisements = 3;
+
+    struct Slot {
+        uint16_t iid = 0;
+        core::Value value;
+        uint32_t interval_ms = 20;
+    };
+
+    struct Stats {
+        uint64_t sent = 0;        ///< Slots handed out
+        uint64_t coalesced = 0;   ///< Updates that replaced a queued value
+        uint64_t unchanged = 0;   ///< Updates dropped as equal to the last broadcast
+    };
+
+    /// Time one broadcast at this advertising interval keeps the radio
+    static uint32_t slot_ms(uint32_t interval_ms);
+
+    /**
+     * @brief Queue a value, replacing any queued value for the same IID.
+     * @return false if dropped because it is what was last broadcast
+     */
+    bool push(uint16_t iid, core::Value value, uint32_t interval_ms);
+
+    /**
+     * @brief Next broadcast to put on air, if the radio is free at now_ms.
+     * Marks the radio busy for the slot's length.
+     */
+    std::optional<Slot> next(uint64_t now_ms);
+
+    /**
+     * @brief Note that time has passed.
+     * @return true once, when a slot has ended and nothing is queued: the
+     * caller should go back to regular advertising
+     */
+    bool release(uint64_t now_ms);
+
+    /// When the slot on air ends, or nullopt if the radio is free
+    std::optional<uint64_t> busy_until_ms() const;
+
+    size_t pending() const { return queue_.size(); }
+
+    /// Drop queued broadcasts and forget what was sent (a controller connected)
+    void clear();
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    std::vector<Slot> queue_;
+    std::map<uint16_t, core::Value> last_sent_;
+    std::optional<uint64_t> busy_until_ms_;
+    Stats stats_;
+};
+
+} // namespace hap::transport::ble
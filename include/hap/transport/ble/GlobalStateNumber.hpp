@@ -0,0 +1,57 @@
+#pragma once
+
+#include "hap/platform/Storage.hpp"
+#include <cstdint>
+
+namespace hap::transport::ble {
+
+/**
+ * @brief Global State Number kept in RAM with write-ahead persistence.
+ * 
+ * The GSN (HAP Spec 7.4.6) runs 1-65535 and wraps to 1. Instead of a
+ * storage write per increment, a block of `reserve` values is claimed by
+ * persisting its last value; increments inside the block are RAM-only.
+ * After a restart the stored value is used as the current GSN, which skips
+ * ahead of anything advertised before, so the number never goes backwards.
+ */
+class GlobalStateNumber {
+public:
+    static constexpr const char* kStorageKey = "gsn";
+    static constexpr uint16_t kDefaultReserve = 16;
+    
+    explicit GlobalStateNumber(platform::Storage* storage, uint16_t reserve = kDefaultReserve);
+    
+    /**
+     * @brief Current GSN; loads it from storage on first use.
+     */
+    uint16_t current();
+    
+    /**
+     * @brief Advance by one, persisting only when the claimed block runs out.
+     * @return The new GSN
+     */
+    uint16_t increment();
+    
+    /**
+     * @brief Forget the cached value so the next use reloads from storage.
+     * Call after the stored key was cleared, e.g. on factory reset.
+     */
+    void reset();
+    
+    /// Number of storage writes so far, for tests and diagnostics
+    uint32_t persist_count() const { return persist_count_; }
+
+private:
+    static uint16_t advance(uint16_t gsn, uint16_t steps);
+    void load();
+    void persist(uint16_t gsn);
+    
+    platform::Storage* storage_;
+    uint16_t reserve_;
+    bool loaded_ = false;
+    uint16_t value_ = 1;
+    uint16_t remaining_ = 0;  // Increments left before the next block must be claimed
+    uint32_t persist_count_ = 0;
+};
+
+} // namespace hap::transport::ble
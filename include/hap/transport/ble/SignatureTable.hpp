@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace hap::transport::ble {
+
+/**
+ * @brief Precomputed signature read bodies keyed by instance ID.
+ * 
+ * All bodies share one contiguous blob; lookups binary-search a sorted
+ * index. Fill with add(), then call seal() before the first find().
+ */
+class SignatureTable {
+public:
+    void clear();
+    
+    /**
+     * @brief Store the body for `iid`; an IID added twice keeps its first body.
+     */
+    void add(uint16_t iid, std::span<const uint8_t> body);
+    
+    /**
+     * @brief Sort the index and drop duplicate IIDs.
+     */
+    void seal();
+    
+    [[nodiscard]] std::optional<std::span<const uint8_t>> find(uint16_t iid) const;
+    
+    [[nodiscard]] size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        uint16_t iid;
+        uint16_t length;
+        uint32_t offset;
+    };
+    
+    std::vector<Entry> entries_;
+    std::vector<uint8_t> blob_;
+};
+
+} // namespace hap::transport::ble
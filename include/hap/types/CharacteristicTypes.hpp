@@ -7,12 +7,14 @@
  * 
  * Usage:
  *   auto brightness = hap::characteristic::Brightness();
- *   brightness->set_value(static_cast<int32_t>(75));
+ *   brightness->set<int32_t>(75);
  */
 #pragma once
 
 #include "hap/core/Characteristic.hpp"
 #include <memory>
+#include <optional>
+#include <string_view>
 
 namespace hap::characteristic {
 
@@ -338,6 +340,39 @@ enum class ValveType : uint8_t {
     WaterFaucet = 3
 };
 
+//==============================================================================
+// Characteristic Descriptors
+//==============================================================================
+
+/**
+ * @brief Compile-time description of a HAP-defined characteristic.
+ *
+ * The factory functions below are backed by a constexpr table of these, so
+ * the catalog costs flash rather than RAM. Metadata is materialized once per
+ * descriptor and shared by every characteristic created from it.
+ */
+struct CharacteristicDescriptor {
+    uint64_t type = 0;
+    core::Format format = core::Format::Bool;
+    core::PermissionSet permissions{};
+    std::string_view unit{};  // Empty when the characteristic has no unit
+    std::optional<double> min_value{};
+    std::optional<double> max_value{};
+    std::optional<double> min_step{};
+    std::optional<uint32_t> max_len{};
+    std::optional<uint32_t> max_data_len{};
+
+    constexpr bool has_metadata() const {
+        return !unit.empty() || min_value || max_value || min_step || max_len || max_data_len;
+    }
+};
+
+/**
+ * @brief Catalog entry for a HAP-defined characteristic type.
+ * @return nullptr if the type is not in the catalog
+ */
+const CharacteristicDescriptor* find_descriptor(uint64_t type);
+
 //==============================================================================
 // Factory Functions - Returns pre-configured characteristics
 // All characteristics are returned with proper type, format, permissions,
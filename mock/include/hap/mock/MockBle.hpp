@@ -0,0 +1,116 @@
+#pragma once
+
+#include "hap/platform/Ble.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hap::mock {
+
+/**
+ * @brief In-process GATT server for platform::Ble.
+ *
+ * Keeps the registered service table and lets the test or benchmark act as
+ * the central: write()/read()/subscribe() call the characteristic callbacks
+ * directly on the calling thread. Indications and advertising changes are
+ * recorded instead of going over the air.
+ *
+ * Register every service before driving traffic; lookups hand out pointers
+ * into the table.
+ */
+class MockBle : public platform::Ble {
+public:
+    struct Indication {
+        uint16_t connection_id = 0;
+        std::string characteristic_uuid;
+        std::vector<uint8_t> data;
+    };
+
+    // platform::Ble
+    void start() override;
+    void start_advertising(const Advertisement& data, uint32_t interval_ms) override;
+    void stop_advertising() override;
+    void register_service(const ServiceDefinition& service) override;
+    void disconnect(uint16_t connection_id) override;
+    void set_disconnect_callback(DisconnectCallback callback) override;
+    void set_mtu_callback(MtuCallback callback) override;
+    bool send_indication(uint16_t connection_id, const std::string& characteristic_uuid,
+                         std::span<const uint8_t> data) override;
+    bool set_indication_confirm_callback(IndicationConfirmCallback callback) override;
+    void start_encrypted_advertising(const EncryptedAdvertisement& data, uint32_t interval_ms,
+                                     uint32_t duration_ms) override;
+    bool has_connections() const override;
+    void start_timed_advertising(const Advertisement& data, uint32_t fast_interval_ms,
+                                 uint32_t fast_duration_ms, uint32_t normal_interval_ms) override;
+
+    // Central side
+
+    /// First characteristic with this UUID in any registered service, or nullptr
+    CharacteristicDefinition* find_characteristic(std::string_view uuid);
+
+    /// First descriptor with this UUID on the characteristic, or nullptr
+    DescriptorDefinition* find_descriptor(std::string_view characteristic_uuid, std::string_view uuid);
+
+    const std::vector<ServiceDefinition>& services() const { return services_; }
+
+    void connect(uint16_t connection_id);
+    /// Central went away: runs the disconnect callback
+    void drop(uint16_t connection_id);
+    /// ATT MTU exchange: runs the MTU callback
+    void negotiate_mtu(uint16_t connection_id, uint16_t mtu);
+
+    /// @return false if the characteristic is unknown or not writable
+    bool write(uint16_t connection_id, std::string_view uuid, std::span<const uint8_t> data,
+               bool response_needed = true);
+    /// @return std::nullopt if the characteristic is unknown or not readable
+    std::optional<std::vector<uint8_t>> read(uint16_t connection_id, std::string_view uuid);
+    bool subscribe(uint16_t connection_id, std::string_view uuid, bool enabled = true);
+
+    /// Indications sent since the last call
+    std::vector<Indication> take_indications();
+    size_t indication_count() const;
+    /// Keep indications (default) or only count them
+    void set_capture(bool capture);
+    /// Simulate a full indication queue: send_indication() fails while unset
+    void set_accept_indications(bool accept);
+    /// Controller confirmed its indication: runs the confirm callback
+    void confirm_indication(uint16_t connection_id);
+    /// Whether the confirm callback is reported as supported (default true);
+    /// takes effect at the next set_indication_confirm_callback()
+    void set_report_confirmations(bool report);
+
+    bool started() const;
+    bool advertising() const;
+    std::optional<Advertisement> advertisement() const;
+    uint32_t advertising_interval() const;
+    size_t advertisement_count() const;
+    std::optional<EncryptedAdvertisement> encrypted_advertisement() const;
+    std::vector<uint16_t> disconnected_by_server() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<ServiceDefinition> services_;
+    DisconnectCallback on_disconnect_;
+    MtuCallback on_mtu_;
+    IndicationConfirmCallback on_confirm_;
+    bool report_confirmations_ = true;
+    std::set<uint16_t> connections_;
+    std::vector<uint16_t> disconnected_by_server_;
+    std::vector<Indication> indications_;
+    size_t indication_count_ = 0;
+    bool capture_ = true;
+    bool accept_indications_ = true;
+    bool started_ = false;
+    bool advertising_ = false;
+    std::optional<Advertisement> advertisement_;
+    uint32_t advertising_interval_ = 0;
+    size_t advertisement_count_ = 0;
+    std::optional<EncryptedAdvertisement> encrypted_advertisement_;
+};
+
+} // namespace hap::mock
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "hap/platform/Network.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hap::mock {
+
+/**
+ * @brief In-process loopback for platform::Network.
+ *
+ * The test or benchmark plays the controller side: deliver() hands bytes to
+ * the server's receive callback on the calling thread, and whatever the
+ * server sends is kept per connection until take_sent(). No sockets, no
+ * threads, no syscalls, so a timing covers the library and nothing else.
+ *
+ * With capture off, sends are only counted; long benchmark runs then don't
+ * grow a buffer nobody reads.
+ */
+class MockNetwork : public platform::Network {
+public:
+    /// Copy of the last registered or updated mDNS service
+    struct MdnsRecord {
+        std::string name;
+        std::string type;
+        uint16_t port = 0;
+        std::vector<std::pair<std::string, std::string>> txt_records;
+    };
+
+    // platform::Network
+    void mdns_register(const MdnsService& service) override;
+    void mdns_update_txt_record(const MdnsService& service) override;
+    void tcp_listen(uint16_t port, ReceiveCallback on_receive, DisconnectCallback on_disconnect) override;
+    void tcp_send(ConnectionId id, std::span<const uint8_t> data) override;
+    void tcp_send_vectored(ConnectionId id, std::span<const std::span<const uint8_t>> buffers) override;
+    void tcp_disconnect(ConnectionId id) override;
+    bool tcp_can_send(ConnectionId id) override;
+
+    // Controller side
+
+    /**
+     * @brief Feed bytes to the server as if received on this connection.
+     * Runs the receive callback synchronously; a no-op before tcp_listen().
+     */
+    void deliver(ConnectionId id, std::span<const uint8_t> data);
+    void deliver(ConnectionId id, std::string_view data);
+
+    /// Peer closed the connection: runs the disconnect callback
+    void close(ConnectionId id);
+
+    /// Bytes sent on this connection since the last call
+    std::vector<uint8_t> take_sent(ConnectionId id);
+
+    /// Keep sent bytes (default) or only count them
+    void set_capture(bool capture);
+
+    /// Simulate a full send buffer: tcp_can_send() returns false while unset
+    void set_writable(ConnectionId id, bool writable);
+
+    bool listening() const;
+    uint16_t port() const;
+    bool closed_by_server(ConnectionId id) const;
+
+    uint64_t sent_bytes(ConnectionId id) const;
+    uint64_t send_calls(ConnectionId id) const;
+
+    size_t mdns_registrations() const;
+    size_t mdns_updates() const;
+    MdnsRecord mdns_record() const;
+
+    /// Drop all per-connection state and counters (callbacks stay)
+    void reset();
+
+private:
+    struct Peer {
+        std::vector<uint8_t> sent;
+        uint64_t sent_bytes = 0;
+        uint64_t send_calls = 0;
+        bool writable = true;
+        bool closed_by_server = false;
+    };
+
+    void record_mdns(const MdnsService& service);
+
+    mutable std::mutex mutex_;
+    ReceiveCallback on_receive_;
+    DisconnectCallback on_disconnect_;
+    uint16_t port_ = 0;
+    bool listening_ = false;
+    bool capture_ = true;
+    std::unordered_map<ConnectionId, Peer> peers_;
+    size_t mdns_registrations_ = 0;
+    size_t mdns_updates_ = 0;
+    MdnsRecord mdns_record_;
+};
+
+} // namespace hap::mock
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "hap/platform/Storage.hpp"
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace hap::mock {
+
+/**
+ * @brief platform::Storage backed by a map in memory.
+ *
+ * Counts reads, writes and batches so tests can check that a code path
+ * touches storage as often as it should (and no more).
+ */
+class MockStorage : public platform::Storage {
+public:
+    void set(std::string_view key, std::span<const uint8_t> value) override;
+    std::optional<std::vector<uint8_t>> get(std::string_view key) override;
+    void remove(std::string_view key) override;
+    bool has(std::string_view key) override;
+    void begin_batch() override;
+    void commit_batch() override;
+
+    size_t size() const;
+    size_t reads() const;    ///< get() calls
+    size_t writes() const;   ///< set() and remove() calls
+    size_t commits() const;  ///< commit_batch() calls
+    void clear();
+
+private:
+    mutable std::mutex mutex_;
+    std::map<std::string, std::vector<uint8_t>, std::less<>> values_;
+    size_t reads_ = 0;
+    size_t writes_ = 0;
+    size_t commits_ = 0;
+};
+
+} // namespace hap::mock
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "hap/platform/System.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hap::mock {
+
+/**
+ * @brief platform::System with a virtual clock.
+ *
+ * millis() only moves when the test calls advance() or set_time(), so
+ * timeouts and scheduler deadlines fire at exactly the same point on every
+ * run. random_bytes() is a fixed-seed generator: reproducible, and not
+ * secure. Log output is dropped unless capture is on; the default log level
+ * is Error so the library skips formatting altogether.
+ */
+class MockSystem : public platform::System {
+public:
+    explicit MockSystem(uint64_t seed = 0x9E3779B97F4A7C15ull);
+
+    uint64_t millis() override { return now_.load(std::memory_order_relaxed); }
+    void random_bytes(std::span<uint8_t> buffer) override;
+    void log(LogLevel level, std::string_view message) override;
+    LogLevel log_level() const override { return level_.load(std::memory_order_relaxed); }
+    std::optional<size_t> min_free_heap() const override { return min_free_heap_; }
+
+    void advance(uint64_t ms) { now_.fetch_add(ms, std::memory_order_relaxed); }
+    void set_time(uint64_t ms) { now_.store(ms, std::memory_order_relaxed); }
+
+    void set_log_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    /// Keep messages at or above the log level for take_logs()
+    void set_capture_logs(bool capture);
+    std::vector<std::string> take_logs();
+
+    void set_min_free_heap(std::optional<size_t> bytes) { min_free_heap_ = bytes; }
+
+private:
+    std::atomic<uint64_t> now_{0};
+    std::atomic<LogLevel> level_{LogLevel::Error};
+    std::optional<size_t> min_free_heap_;
+
+    std::mutex mutex_;
+    uint64_t rng_state_;
+    bool capture_logs_ = false;
+    std::vector<std::string> logs_;
+};
+
+} // namespace hap::mock
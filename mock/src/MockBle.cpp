@@ -0,0 +1,223 @@
+#include "hap/mock/MockBle.hpp"
+#include <utility>
+
+namespace hap::mock {
+
+void MockBle::start() {
+    std::lock_guard lock(mutex_);
+    started_ = true;
+}
+
+void MockBle::start_advertising(const Advertisement& data, uint32_t interval_ms) {
+    std::lock_guard lock(mutex_);
+    advertising_ = true;
+    advertisement_ = data;
+    advertising_interval_ = interval_ms;
+    ++advertisement_count_;
+}
+
+void MockBle::stop_advertising() {
+    std::lock_guard lock(mutex_);
+    advertising_ = false;
+}
+
+void MockBle::start_timed_advertising(const Advertisement& data, uint32_t fast_interval_ms,
+                                      uint32_t /*fast_duration_ms*/, uint32_t /*normal_interval_ms*/) {
+    start_advertising(data, fast_interval_ms);
+}
+
+void MockBle::start_encrypted_advertising(const EncryptedAdvertisement& data, uint32_t interval_ms,
+                                          uint32_t /*duration_ms*/) {
+    std::lock_guard lock(mutex_);
+    encrypted_advertisement_ = data;
+    advertising_interval_ = interval_ms;
+    ++advertisement_count_;
+}
+
+void MockBle::register_service(const ServiceDefinition& service) {
+    std::lock_guard lock(mutex_);
+    services_.push_back(service);
+}
+
+void MockBle::disconnect(uint16_t connection_id) {
+    DisconnectCallback on_disconnect;
+    {
+        std::lock_guard lock(mutex_);
+        if (connections_.erase(connection_id) == 0) return;
+        disconnected_by_server_.push_back(connection_id);
+        on_disconnect = on_disconnect_;
+    }
+    // Stacks report every link loss, including ones the accessory asked for
+    if (on_disconnect) on_disconnect(connection_id);
+}
+
+void MockBle::set_disconnect_callback(DisconnectCallback callback) {
+    std::lock_guard lock(mutex_);
+    on_disconnect_ = std::move(callback);
+}
+
+void MockBle::set_mtu_callback(MtuCallback callback) {
+    std::lock_guard lock(mutex_);
+    on_mtu_ = std::move(callback);
+}
+
+bool MockBle::send_indication(uint16_t connection_id, const std::string& characteristic_uuid,
+                              std::span<const uint8_t> data) {
+    std::lock_guard lock(mutex_);
+    if (!accept_indications_) return false;
+    ++indication_count_;
+    if (capture_) {
+        indications_.push_back({connection_id, characteristic_uuid, std::vector<uint8_t>(data.begin(), data.end())});
+    }
+    return true;
+}
+
+bool MockBle::set_indication_confirm_callback(IndicationConfirmCallback callback) {
+    std::lock_guard lock(mutex_);
+    on_confirm_ = std::move(callback);
+    return report_confirmations_;
+}
+
+bool MockBle::has_connections() const {
+    std::lock_guard lock(mutex_);
+    return !connections_.empty();
+}
+
+MockBle::CharacteristicDefinition* MockBle::find_characteristic(std::string_view uuid) {
+    std::lock_guard lock(mutex_);
+    for (auto& service : services_) {
+        for (auto& ch : service.characteristics) {
+            if (ch.uuid == uuid) return &ch;
+        }
+    }
+    return nullptr;
+}
+
+MockBle::DescriptorDefinition* MockBle::find_descriptor(std::string_view characteristic_uuid,
+                                                        std::string_view uuid) {
+    auto* ch = find_characteristic(characteristic_uuid);
+    if (!ch) return nullptr;
+    for (auto& desc : ch->descriptors) {
+        if (desc.uuid == uuid) return &desc;
+    }
+    return nullptr;
+}
+
+void MockBle::connect(uint16_t connection_id) {
+    std::lock_guard lock(mutex_);
+    connections_.insert(connection_id);
+}
+
+void MockBle::drop(uint16_t connection_id) {
+    DisconnectCallback on_disconnect;
+    {
+        std::lock_guard lock(mutex_);
+        connections_.erase(connection_id);
+        on_disconnect = on_disconnect_;
+    }
+    if (on_disconnect) on_disconnect(connection_id);
+}
+
+void MockBle::negotiate_mtu(uint16_t connection_id, uint16_t mtu) {
+    MtuCallback on_mtu;
+    {
+        std::lock_guard lock(mutex_);
+        on_mtu = on_mtu_;
+    }
+    if (on_mtu) on_mtu(connection_id, mtu);
+}
+
+// The callbacks run without the lock held: they call back into
+// send_indication() and disconnect() on this thread.
+
+bool MockBle::write(uint16_t connection_id, std::string_view uuid, std::span<const uint8_t> data,
+                    bool response_needed) {
+    auto* ch = find_characteristic(uuid);
+    if (!ch || !ch->on_write) return false;
+    ch->on_write(connection_id, data, response_needed);
+    return true;
+}
+
+std::optional<std::vector<uint8_t>> MockBle::read(uint16_t connection_id, std::string_view uuid) {
+    auto* ch = find_characteristic(uuid);
+    if (!ch || !ch->on_read) return std::nullopt;
+    return ch->on_read(connection_id);
+}
+
+bool MockBle::subscribe(uint16_t connection_id, std::string_view uuid, bool enabled) {
+    auto* ch = find_characteristic(uuid);
+    if (!ch || !ch->on_subscribe) return false;
+    ch->on_subscribe(connection_id, enabled);
+    return true;
+}
+
+void MockBle::confirm_indication(uint16_t connection_id) {
+    IndicationConfirmCallback on_confirm;
+    {
+        std::lock_guard lock(mutex_);
+        on_confirm = on_confirm_;
+    }
+    if (on_confirm) on_confirm(connection_id);
+}
+
+void MockBle::set_report_confirmations(bool report) {
+    std::lock_guard lock(mutex_);
+    report_confirmations_ = report;
+}
+
+std::vector<MockBle::Indication> MockBle::take_indications() {
+    std::lock_guard lock(mutex_);
+    return std::exchange(indications_, {});
+}
+
+size_t MockBle::indication_count() const {
+    std::lock_guard lock(mutex_);
+    return indication_count_;
+}
+
+void MockBle::set_capture(bool capture) {
+    std::lock_guard lock(mutex_);
+    capture_ = capture;
+}
+
+void MockBle::set_accept_indications(bool accept) {
+    std::lock_guard lock(mutex_);
+    accept_indications_ = accept;
+}
+
+bool MockBle::started() const {
+    std::lock_guard lock(mutex_);
+    return started_;
+}
+
+bool MockBle::advertising() const {
+    std::lock_guard lock(mutex_);
+    return advertising_;
+}
+
+std::optional<MockBle::Advertisement> MockBle::advertisement() const {
+    std::lock_guard lock(mutex_);
+    return advertisement_;
+}
+
+uint32_t MockBle::advertising_interval() const {
+    std::lock_guard lock(mutex_);
+    return advertising_interval_;
+}
+
+size_t MockBle::advertisement_count() const {
+    std::lock_guard lock(mutex_);
+    return advertisement_count_;
+}
+
+std::optional<MockBle::EncryptedAdvertisement> MockBle::encrypted_advertisement() const {
+    std::lock_guard lock(mutex_);
+    return encrypted_advertisement_;
+}
+
+std::vector<uint16_t> MockBle::disconnected_by_server() const {
+    std::lock_guard lock(mutex_);
+    return disconnected_by_server_;
+}
+
+} // namespace hap::mock
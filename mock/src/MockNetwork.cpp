@@ -0,0 +1,153 @@
+#include "hap/mock/MockNetwork.hpp"
+
+namespace hap::mock {
+
+void MockNetwork::record_mdns(const MdnsService& service) {
+    mdns_record_.name = std::string(service.name);
+    mdns_record_.type = std::string(service.type);
+    mdns_record_.port = service.port;
+    mdns_record_.txt_records = service.txt_records;
+}
+
+void MockNetwork::mdns_register(const MdnsService& service) {
+    std::lock_guard lock(mutex_);
+    ++mdns_registrations_;
+    record_mdns(service);
+}
+
+void MockNetwork::mdns_update_txt_record(const MdnsService& service) {
+    std::lock_guard lock(mutex_);
+    ++mdns_updates_;
+    record_mdns(service);
+}
+
+void MockNetwork::tcp_listen(uint16_t port, ReceiveCallback on_receive, DisconnectCallback on_disconnect) {
+    std::lock_guard lock(mutex_);
+    port_ = port;
+    listening_ = true;
+    on_receive_ = std::move(on_receive);
+    on_disconnect_ = std::move(on_disconnect);
+}
+
+void MockNetwork::tcp_send(ConnectionId id, std::span<const uint8_t> data) {
+    std::lock_guard lock(mutex_);
+    auto& peer = peers_[id];
+    peer.sent_bytes += data.size();
+    ++peer.send_calls;
+    if (capture_) peer.sent.insert(peer.sent.end(), data.begin(), data.end());
+}
+
+void MockNetwork::tcp_send_vectored(ConnectionId id, std::span<const std::span<const uint8_t>> buffers) {
+    std::lock_guard lock(mutex_);
+    auto& peer = peers_[id];
+    ++peer.send_calls;
+    for (auto buffer : buffers) {
+        peer.sent_bytes += buffer.size();
+        if (capture_) peer.sent.insert(peer.sent.end(), buffer.begin(), buffer.end());
+    }
+}
+
+void MockNetwork::tcp_disconnect(ConnectionId id) {
+    std::lock_guard lock(mutex_);
+    peers_[id].closed_by_server = true;
+}
+
+bool MockNetwork::tcp_can_send(ConnectionId id) {
+    std::lock_guard lock(mutex_);
+    auto it = peers_.find(id);
+    return it == peers_.end() || it->second.writable;
+}
+
+void MockNetwork::deliver(ConnectionId id, std::span<const uint8_t> data) {
+    ReceiveCallback on_receive;
+    {
+        std::lock_guard lock(mutex_);
+        on_receive = on_receive_;
+    }
+    // Outside the lock: the server answers through tcp_send on this thread
+    if (on_receive) on_receive(id, data);
+}
+
+void MockNetwork::deliver(ConnectionId id, std::string_view data) {
+    deliver(id, std::span(reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+}
+
+void MockNetwork::close(ConnectionId id) {
+    DisconnectCallback on_disconnect;
+    {
+        std::lock_guard lock(mutex_);
+        on_disconnect = on_disconnect_;
+        peers_.erase(id);
+    }
+    if (on_disconnect) on_disconnect(id);
+}
+
+std::vector<uint8_t> MockNetwork::take_sent(ConnectionId id) {
+    std::lock_guard lock(mutex_);
+    auto it = peers_.find(id);
+    if (it == peers_.end()) return {};
+    return std::exchange(it->second.sent, {});
+}
+
+void MockNetwork::set_capture(bool capture) {
+    std::lock_guard lock(mutex_);
+    capture_ = capture;
+}
+
+void MockNetwork::set_writable(ConnectionId id, bool writable) {
+    std::lock_guard lock(mutex_);
+    peers_[id].writable = writable;
+}
+
+bool MockNetwork::listening() const {
+    std::lock_guard lock(mutex_);
+    return listening_;
+}
+
+uint16_t MockNetwork::port() const {
+    std::lock_guard lock(mutex_);
+    return port_;
+}
+
+bool MockNetwork::closed_by_server(ConnectionId id) const {
+    std::lock_guard lock(mutex_);
+    auto it = peers_.find(id);
+    return it != peers_.end() && it->second.closed_by_server;
+}
+
+uint64_t MockNetwork::sent_bytes(ConnectionId id) const {
+    std::lock_guard lock(mutex_);
+    auto it = peers_.find(id);
+    return it == peers_.end() ? 0 : it->second.sent_bytes;
+}
+
+uint64_t MockNetwork::send_calls(ConnectionId id) const {
+    std::lock_guard lock(mutex_);
+    auto it = peers_.find(id);
+    return it == peers_.end() ? 0 : it->second.send_calls;
+}
+
+size_t MockNetwork::mdns_registrations() const {
+    std::lock_guard lock(mutex_);
+    return mdns_registrations_;
+}
+
+size_t MockNetwork::mdns_updates() const {
+    std::lock_guard lock(mutex_);
+    return mdns_updates_;
+}
+
+MockNetwork::MdnsRecord MockNetwork::mdns_record() const {
+    std::lock_guard lock(mutex_);
+    return mdns_record_;
+}
+
+void MockNetwork::reset() {
+    std::lock_guard lock(mutex_);
+    peers_.clear();
+    mdns_registrations_ = 0;
+    mdns_updates_ = 0;
+    mdns_record_ = {};
+}
+
+} // namespace hap::mock
@@ -0,0 +1,66 @@
+#include "hap/mock/MockStorage.hpp"
+
+namespace hap::mock {
+
+void MockStorage::set(std::string_view key, std::span<const uint8_t> value) {
+    std::lock_guard lock(mutex_);
+    values_[std::string(key)] = std::vector<uint8_t>(value.begin(), value.end());
+    ++writes_;
+}
+
+std::optional<std::vector<uint8_t>> MockStorage::get(std::string_view key) {
+    std::lock_guard lock(mutex_);
+    ++reads_;
+    auto it = values_.find(key);
+    if (it == values_.end()) return std::nullopt;
+    return it->second;
+}
+
+void MockStorage::remove(std::string_view key) {
+    std::lock_guard lock(mutex_);
+    auto it = values_.find(key);
+    if (it != values_.end()) values_.erase(it);
+    ++writes_;
+}
+
+bool MockStorage::has(std::string_view key) {
+    std::lock_guard lock(mutex_);
+    return values_.find(key) != values_.end();
+}
+
+void MockStorage::begin_batch() {}
+
+void MockStorage::commit_batch() {
+    std::lock_guard lock(mutex_);
+    ++commits_;
+}
+
+size_t MockStorage::size() const {
+    std::lock_guard lock(mutex_);
+    return values_.size();
+}
+
+size_t MockStorage::reads() const {
+    std::lock_guard lock(mutex_);
+    return reads_;
+}
+
+size_t MockStorage::writes() const {
+    std::lock_guard lock(mutex_);
+    return writes_;
+}
+
+size_t MockStorage::commits() const {
+    std::lock_guard lock(mutex_);
+    return commits_;
+}
+
+void MockStorage::clear() {
+    std::lock_guard lock(mutex_);
+    values_.clear();
+    reads_ = 0;
+    writes_ = 0;
+    commits_ = 0;
+}
+
+} // namespace hap::mock
@@ -0,0 +1,39 @@
+#include "hap/mock/MockSystem.hpp"
+#include <utility>
+
+namespace hap::mock {
+
+MockSystem::MockSystem(uint64_t seed)
+    : rng_state_(seed ? seed : 1) {}
+
+void MockSystem::random_bytes(std::span<uint8_t> buffer) {
+    std::lock_guard lock(mutex_);
+    // xorshift64*: cheap and the same sequence for the same seed
+    for (size_t i = 0; i < buffer.size(); i += 8) {
+        rng_state_ ^= rng_state_ >> 12;
+        rng_state_ ^= rng_state_ << 25;
+        rng_state_ ^= rng_state_ >> 27;
+        uint64_t word = rng_state_ * 0x2545F4914F6CDD1Dull;
+        for (size_t j = 0; j < 8 && i + j < buffer.size(); ++j) {
+            buffer[i + j] = static_cast<uint8_t>(word >> (8 * j));
+        }
+    }
+}
+
+void MockSystem::log(LogLevel level, std::string_view message) {
+    if (level < log_level()) return;
+    std::lock_guard lock(mutex_);
+    if (capture_logs_) logs_.emplace_back(message);
+}
+
+void MockSystem::set_capture_logs(bool capture) {
+    std::lock_guard lock(mutex_);
+    capture_logs_ = capture;
+}
+
+std::vector<std::string> MockSystem::take_logs() {
+    std::lock_guard lock(mutex_);
+    return std::exchange(logs_, {});
+}
+
+} // namespace hap::mock
@@ -1,35 +1,174 @@
 #include "hap/AccessoryServer.hpp"
 #include "hap/common/TaskScheduler.hpp"
+#include "hap/common/WorkQueue.hpp"
+#include "hap/common/WorkerPool.hpp"
+#include "hap/common/Log.hpp"
+#include "hap/platform/CachedStorage.hpp"
 #include "hap/transport/Router.hpp"
 #include "hap/transport/BleTransport.hpp"
 #include "hap/transport/ConnectionContext.hpp"
+#include "hap/transport/ConnectionTable.hpp"
 #include "hap/transport/PairingEndpoints.hpp"
 #include "hap/transport/AccessoryEndpoints.hpp"
+#include "hap/transport/EventDispatcher.hpp"
 #include "hap/core/HAPStatus.hpp"
-#include <map>
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
 #include <nlohmann/json.hpp>
 #include <iomanip>
 #include <sstream>
 
 namespace hap {
 
+// Worker strand for work not tied to a connection
+static constexpr uint32_t kBackgroundStrand = UINT32_MAX;
+// Bursts of TXT changes (pairing, c# bump, factory reset) go out as one update
+static constexpr uint32_t kMdnsDebounceMs = 100;
+// A backed-up outbound queue is retried after this, doubling while the peer stays slow
+static constexpr uint32_t kDrainBackoffMinMs = 2;
+static constexpr uint32_t kDrainBackoffMaxMs = 128;
+// HAP Spec Table 6-7: the state number must have a value of 1
+static constexpr const char* kMdnsStateNumber = "1";
+static constexpr std::string_view kPairingContentType = "application/pairing+tlv8";
+
+static nlohmann::json diagnostics_json(const AccessoryServer::Diagnostics& diagnostics) {
+    nlohmann::json connections = nlohmann::json::array();
+    for (const auto& connection : diagnostics.connections) {
+        connections.push_back({
+            {"id", connection.connection_id},
+            {"bytes_in", connection.bytes_received},
+            {"bytes_out", connection.outbound.sent_bytes},
+            {"frames_encrypted", connection.outbound.sealed_frames},
+            {"messages_sent", connection.outbound.sent_messages},
+            {"events_sent", connection.outbound.sent_events},
+            {"events_dropped", connection.outbound.dropped_events},
+            {"events_replaced", connection.outbound.replaced_events},
+            {"subscriptions", connection.subscriptions},
+            {"queue_depth", connection.outbound.depth},
+            {"queue_bytes", connection.outbound.queued_bytes},
+            {"queue_high_water_bytes", connection.outbound.high_water_bytes},
+        });
+    }
+    
+    nlohmann::json counters = nlohmann::json::object();
+    for (size_t i = 0; i < diagnostics.metrics.counters.size(); ++i) {
+        counters[common::counter_name(static_cast<common::Counter>(i))] = diagnostics.metrics.counters[i];
+    }
+    nlohmann::json latency = nlohmann::json::object();
+    for (size_t i = 0; i < diagnostics.metrics.latency.size(); ++i) {
+        const auto& stats = diagnostics.metrics.latency[i];
+        if (stats.count == 0) continue;
+        latency[common::metric_name(static_cast<common::Metric>(i))] = {
+            {"count", stats.count},
+            {"mean_us", stats.mean_us()},
+            {"p99_us", stats.percentile_us(99)},
+            {"max_us", stats.max_us},
+        };
+    }
+    
+    nlohmann::json result = {
+        {"connections", std::move(connections)},
+        {"scheduled_tasks", diagnostics.scheduled_tasks},
+        {"counters", std::move(counters)},
+        {"latency", std::move(latency)},
+    };
+    if (diagnostics.min_free_heap) {
+        result["min_free_heap"] = *diagnostics.min_free_heap;
+    }
+    return result;
+}
+
+static transport::Response pairing_response(std::optional<std::vector<uint8_t>> tlv, std::string_view error) {
+    if (!tlv) {
+        transport::Response resp{transport::Status::InternalServerError};
+        resp.set_body(error);
+        return resp;
+    }
+    transport::Response resp{transport::Status::OK};
+    resp.set_header("Content-Type", std::string(kPairingContentType));
+    resp.set_body(std::move(*tlv));
+    return resp;
+}
+
 class AccessoryServer::Impl {
 public:
+    using Connection = transport::Connection;  // Only touched from the connection's strand
+    
+    std::unique_ptr<common::Metrics> metrics;  // First so every component can hold a pointer
+    std::unique_ptr<platform::CachedStorage> cached_storage;  // Replaces config_.storage when enabled
     std::unique_ptr<transport::Router> router;
+    std::unique_ptr<pairing::PairingStore> pairing_store;
+    std::unique_ptr<pairing::SRPVerifierCache> srp_verifiers;
     std::unique_ptr<transport::PairingEndpoints> pairing_endpoints;
     std::unique_ptr<transport::BleTransport> ble_transport;
     std::unique_ptr<transport::AccessoryEndpoints> accessory_endpoints;
-    std::map<uint32_t, std::unique_ptr<transport::ConnectionContext>> connections;
-    std::map<uint32_t, transport::HTTPParser> parsers;
+    transport::EventDispatcher events;
+    common::WorkQueue immediate_work{128};  // Zero-delay characteristic callbacks
+    
+    std::unique_ptr<transport::ConnectionTable> connections;
+    mutable std::mutex connections_mutex;
+    
+    // One scheduler task sweeps request/idle timeouts for every connection
+    std::mutex timeouts_mutex;
+    common::TaskScheduler::TaskId timeouts_task = common::TaskScheduler::INVALID_TASK_ID;
+    uint64_t timeouts_deadline_ms = 0;
+    std::mutex pairing_mutex;  // Pairing endpoints keep cross-connection state
+    
+    // TXT records as last published; refreshes are debounced and skipped when unchanged
+    std::mutex mdns_mutex;
+    std::vector<std::pair<std::string, std::string>> mdns_txt;
+    common::TaskScheduler::TaskId mdns_task = common::TaskScheduler::INVALID_TASK_ID;
+    
+    // Declared last so workers stop before the state they use is destroyed
+    std::unique_ptr<common::WorkerPool> workers;
+    
+    std::shared_ptr<Connection> find_connection(uint32_t connection_id) const {
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        return connections->find(connection_id);
+    }
+    
+    std::vector<std::pair<uint32_t, std::shared_ptr<Connection>>> snapshot_connections() const {
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        std::vector<std::pair<uint32_t, std::shared_ptr<Connection>>> snapshot;
+        snapshot.reserve(connections->size());
+        connections->for_each([&](uint32_t conn_id, const std::shared_ptr<Connection>& connection) {
+            snapshot.emplace_back(conn_id, connection);
+        });
+        return snapshot;
+    }
+    
+    void clear_connections() {
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        connections->for_each([&](uint32_t conn_id, const std::shared_ptr<Connection>&) {
+            events.remove_connection(conn_id);
+        });
+        connections->clear();
+    }
 };
 
 AccessoryServer::AccessoryServer(Config config) : config_(std::move(config)), impl_(std::make_unique<Impl>()) {
+    const uint64_t construct_began_ms = config_.system->millis();
+    impl_->metrics = std::make_unique<common::Metrics>(config_.enable_metrics, config_.trace_hook);
+    impl_->connections = std::make_unique<transport::ConnectionTable>(
+        config_.max_connections, config_.crypto, config_.system,
+        config_.request_arena_bytes, config_.outbound_queue_bytes);
+    if (config_.storage_flush_ms > 0) {
+        impl_->cached_storage = std::make_unique<platform::CachedStorage>(
+            config_.storage, nullptr, config_.storage_flush_ms);
+        // The GSN reserve is written ahead so the number never goes backwards
+        // after a reboot; buffering it would defeat that
+        impl_->cached_storage->set_write_through(transport::ble::GlobalStateNumber::kStorageKey);
+        config_.storage = impl_->cached_storage.get();
+    }
+    
     // Auto-generate accessory ID if not provided
     if (config_.accessory_id.empty()) {
         auto stored_id = config_.storage->get("accessory_id");
         if (stored_id && !stored_id->empty()) {
             config_.accessory_id = std::string(stored_id->begin(), stored_id->end());
-            config_.system->log(platform::System::LogLevel::Info, 
+            HAP_LOG_INFO(config_.system,
                 "[AccessoryServer] Loaded stored accessory ID: " + config_.accessory_id);
         } else {
             // Generate random 6 bytes and format as MAC address
@@ -48,31 +187,39 @@ AccessoryServer::AccessoryServer(Config config) : config_(std::move(config)), im
             std::vector<uint8_t> id_bytes(config_.accessory_id.begin(), config_.accessory_id.end());
             config_.storage->set("accessory_id", id_bytes);
             
-            config_.system->log(platform::System::LogLevel::Info, 
+            HAP_LOG_INFO(config_.system,
                 "[AccessoryServer] Generated new accessory ID: " + config_.accessory_id);
         }
     }
     
+    // Pairings are loaded once and shared by every transport
+    impl_->pairing_store = std::make_unique<pairing::PairingStore>(config_.storage);
+    impl_->srp_verifiers = std::make_unique<pairing::SRPVerifierCache>(config_.crypto, config_.storage, config_.setup_code);
+    
     // Initialize endpoints
     transport::PairingEndpoints::Config pairing_config;
     pairing_config.crypto = config_.crypto;
-    pairing_config.storage = config_.storage;
+    pairing_config.pairing_store = impl_->pairing_store.get();
+    pairing_config.srp_verifiers = impl_->srp_verifiers.get();
     pairing_config.system = config_.system;
     pairing_config.accessory_id = config_.accessory_id;
     pairing_config.setup_code = config_.setup_code;
+    pairing_config.metrics = impl_->metrics.get();
     pairing_config.on_pairings_changed = [this](const std::string& pairing_id, const std::array<uint8_t, 32>& ltpk, bool is_add) {
-        config_.system->log(platform::System::LogLevel::Info, 
+        HAP_LOG_INFO(config_.system,
             "[AccessoryServer] Pairing " + std::string(is_add ? "added" : "removed") + ": " + pairing_id);
         
         // Check if all pairings have been removed
-        auto pairing_list_data = config_.storage->get("pairing_list");
-        bool is_paired = pairing_list_data && pairing_list_data->size() > 2;
-        
-        if (!is_paired) {
+        if (!impl_->pairing_store->is_paired()) {
             // Clear all state and regenerate identifiers
             reset_pairing_state();
         }
         
+        // Pairings must survive a power loss right after the controller sees success
+        if (impl_->cached_storage) {
+            impl_->cached_storage->commit();
+        }
+        
         update_mdns();
         if (impl_->ble_transport) {
             impl_->ble_transport->update_advertising();
@@ -94,7 +241,10 @@ AccessoryServer::AccessoryServer(Config config) : config_(std::move(config)), im
     database_.set_iid_manager(iid_manager_.get());
     
     // Initialize task scheduler first (needed by BleTransport)
-    scheduler_ = std::make_unique<common::TaskScheduler>(config_.system);
+    scheduler_ = std::make_unique<common::TaskScheduler>(config_.system, impl_->metrics.get());
+    if (impl_->cached_storage) {
+        impl_->cached_storage->set_scheduler(scheduler_.get());
+    }
     
     if (config_.ble) {
         transport::BleTransport::Config ble_config;
@@ -104,33 +254,78 @@ AccessoryServer::AccessoryServer(Config config) : config_(std::move(config)), im
         ble_config.pairing_endpoints = impl_->pairing_endpoints.get();
         ble_config.system = config_.system;
         ble_config.storage = config_.storage;
+        ble_config.pairing_store = impl_->pairing_store.get();
         ble_config.scheduler = scheduler_.get();
         ble_config.accessory_id = config_.accessory_id;
         ble_config.device_name = config_.device_name;
         ble_config.category_id = static_cast<uint16_t>(config_.category_id);
         ble_config.iid_manager = iid_manager_.get();
+        ble_config.metrics = impl_->metrics.get();
+        ble_config.defer_user_services = config_.defer_startup_work;
+        ble_config.on_ready = [this]() {
+            startup_report_.ble_ready_ms = static_cast<uint32_t>(config_.system->millis() - start_began_ms_);
+            HAP_LOG_INFO(config_.system,
+                "[AccessoryServer] BLE ready " + std::to_string(*startup_report_.ble_ready_ms) + " ms after start");
+        };
         impl_->ble_transport = std::make_unique<transport::BleTransport>(ble_config);
-        
-        // Schedule periodic BLE session timeout checks (every 1 second)
-        scheduler_->schedule_periodic(1000, [this]() {
-            impl_->ble_transport->check_session_timeouts();
-        });
+        // Session timeouts are deadline timers on scheduler_, armed per connection
     }
     
-    impl_->accessory_endpoints = std::make_unique<transport::AccessoryEndpoints>(&database_);
+    impl_->accessory_endpoints = std::make_unique<transport::AccessoryEndpoints>(&database_, &impl_->events);
+    impl_->accessory_endpoints->set_async_support(scheduler_.get(), config_.async_timeout_ms,
+        [this](uint32_t conn_id, transport::Response response) {
+            // Async callbacks complete on any thread; answer on the connection's strand
+            auto shared = std::make_shared<transport::Response>(std::move(response));
+            auto deliver = [this, conn_id, shared]() { send_deferred_response(conn_id, std::move(*shared)); };
+            if (impl_->workers) {
+                impl_->workers->post(conn_id, deliver);
+                return;
+            }
+            common::WorkQueue::Task task(deliver);
+            if (!impl_->immediate_work.try_push(std::move(task))) {
+                scheduler_->schedule_once(0, deliver);
+            }
+        });
+    
+    if (config_.worker_threads > 0) {
+        impl_->workers = std::make_unique<common::WorkerPool>(common::WorkerPool::Options{
+            .threads = config_.worker_threads,
+            .core = config_.worker_core,
+            .stack_bytes = config_.worker_stack_bytes,
+            .priority = config_.worker_priority,
+        });
+    }
     
     // Initialize router
     impl_->router = std::make_unique<transport::Router>();
+    impl_->router->set_metrics(impl_->metrics.get());
     setup_routes();
     
     // Set up deferred callback execution for characteristic value changes
     // This avoids stack overflow on platforms with limited callback stack (e.g., ESP32 GATT)
-    core::Characteristic::set_dispatcher([this](std::function<void()> work) {
-        scheduler_->schedule_once(0, std::move(work));
+    core::Characteristic::set_dispatcher([this](common::WorkQueue::Task work) {
+        // Lock-free fast path; fall back to the scheduler only when the ring is full
+        if (!impl_->immediate_work.try_push(std::move(work))) {
+            auto shared = std::make_shared<common::WorkQueue::Task>(std::move(work));
+            scheduler_->schedule_once(0, [shared]() { (*shared)(); });
+        }
     });
+    core::Characteristic::set_scheduler(scheduler_.get(), config_.system, &database_.mutex());
+    
+    startup_report_.construct_ms = static_cast<uint32_t>(config_.system->millis() - construct_began_ms);
 }
 
-AccessoryServer::~AccessoryServer() = default;
+AccessoryServer::~AccessoryServer() {
+    core::Characteristic::set_scheduler(nullptr, nullptr);
+    // Finish in-flight requests before the scheduler and database go away
+    impl_->workers.reset();
+    // The BLE transport cancels its scheduler tasks on destruction
+    impl_->ble_transport.reset();
+    if (impl_->cached_storage) {
+        impl_->cached_storage->set_scheduler(nullptr);
+        impl_->cached_storage->commit();
+    }
+}
 
 static std::string method_to_string(transport::Method method) {
     switch (method) {
@@ -144,13 +339,75 @@ static std::string method_to_string(transport::Method method) {
 }
 
 void AccessoryServer::add_accessory(std::shared_ptr<core::Accessory> accessory) {
-    database_.add_accessory(accessory);
+    add_accessories(std::span<const std::shared_ptr<core::Accessory>>(&accessory, 1));
+}
+
+core::ValidationResult AccessoryServer::add_accessories(std::span<const std::shared_ptr<core::Accessory>> accessories) {
+    core::ValidationResult result;
+    {
+        std::unique_lock lock(database_.mutex());
+        result = database_.add_accessories(accessories);
+    }
+    if (result != core::ValidationResult::Success) {
+        HAP_LOG_ERROR(config_.system,
+            "[AccessoryServer] Rejected " + std::to_string(accessories.size()) +
+            " accessories: " + core::validation_result_str(result));
+        return result;
+    }
+    
+    for (const auto& accessory : accessories) {
+        register_event_callbacks(*accessory);
+    }
+    if (started_) {
+        on_structure_changed(accessories);
+    }
+    return result;
+}
+
+bool AccessoryServer::remove_accessory(uint64_t aid) {
+    std::shared_ptr<core::Accessory> removed;
+    {
+        std::unique_lock lock(database_.mutex());
+        removed = database_.remove_accessory(aid);
+    }
+    if (!removed) {
+        return false;
+    }
     
-    // Register event callbacks
-    uint64_t aid = accessory->aid();
-    for (const auto& service : accessory->services()) {
+    // The application may keep the accessory alive; stop it reaching us
+    for (const auto& service : removed->services()) {
         for (const auto& characteristic : service->characteristics()) {
-            if (core::has_permission(characteristic->permissions(), core::Permission::Notify)) {
+            characteristic->set_event_callback(nullptr);
+        }
+    }
+    impl_->events.remove_accessory(aid);
+    
+    HAP_LOG_INFO(config_.system,
+        "[AccessoryServer] Removed accessory aid=" + std::to_string(aid));
+    
+    if (started_) {
+        on_structure_changed({});
+    }
+    return true;
+}
+
+void AccessoryServer::on_structure_changed(std::span<const std::shared_ptr<core::Accessory>> added) {
+    // Bumps c# and drops the cached /accessories template if the hash moved
+    check_and_update_config_number();
+    
+    if (config_.network) {
+        update_mdns();
+    }
+    if (impl_->ble_transport) {
+        impl_->ble_transport->on_database_changed(added);
+    }
+}
+
+void AccessoryServer::register_event_callbacks(const core::Accessory& accessory) {
+    uint64_t aid = accessory.aid();
+    for (const auto& service : accessory.services()) {
+        for (const auto& characteristic : service->characteristics()) {
+            if (characteristic->has_permission(core::Permission::Notify)) {
                 auto ch_ptr = characteristic.get();
                 characteristic->set_event_callback([this, aid, ch_ptr](const core::Value& value, const core::EventSource& source) {
                     uint64_t iid = ch_ptr->iid();
@@ -169,115 +426,181 @@ void AccessoryServer::add_accessory(std::shared_ptr<core::Accessory> accessory)
 }
 
 void AccessoryServer::setup_routes() {
-    using namespace transport;
+    using transport::Method;
+    auto& router = *impl_->router;
     
     // Pairing endpoints (no pairing required)
-    impl_->router->add_route(Method::POST, "/pair-setup", 
-        [this](const Request& req, ConnectionContext& ctx) {            
-            return impl_->pairing_endpoints->handle_pair_setup(req, ctx);
-        }, false);
-    
-    impl_->router->add_route(Method::POST, "/pair-verify",
-        [this](const Request& req, ConnectionContext& ctx) {
-            return impl_->pairing_endpoints->handle_pair_verify(req, ctx);
-        }, false);
-    
-    impl_->router->add_route(Method::POST, "/pairings",
-        [this](const Request& req, ConnectionContext& ctx) {
-            return impl_->pairing_endpoints->handle_pairings(req, ctx);
-        }, true);
-        
-    impl_->router->add_route(Method::POST, "/prepare",
-        [this](const Request& req, ConnectionContext& ctx) {
-            return impl_->accessory_endpoints->handle_prepare(req, ctx);
-        }, true);
-        
-    impl_->router->add_route(Method::POST, "/identify",
-        [this](const Request& req, ConnectionContext& ctx) {
-            (void)req;
-            (void)ctx;
-            
-            // HAP Spec 6.7.7: /identify is only valid if accessory is unpaired
-            auto pairing_list_data = config_.storage->get("pairing_list");
-            bool is_paired = pairing_list_data && pairing_list_data->size() > 2;
-            
-            if (is_paired) {
-                // Return 400 Bad Request with HAP status -70401 (InsufficientPrivileges)
-                nlohmann::json error_response;
-                error_response["status"] = core::to_int(core::HAPStatus::InsufficientPrivileges);
-                transport::Response resp{transport::Status::BadRequest};
-                resp.set_header("Content-Type", "application/hap+json");
-                resp.set_body(error_response.dump());
-                return resp;
-            }
-            
-            if (config_.on_identify) {
-                config_.on_identify();
-            }
-            return transport::Response{transport::Status::NoContent};
-        }, false); // Allow unencrypted access
+    router.add_route<&AccessoryServer::route_pair_setup>(Method::POST, "/pair-setup", this, false);
+    router.add_route<&AccessoryServer::route_pair_verify>(Method::POST, "/pair-verify", this, false);
+    router.add_route<&AccessoryServer::route_pairings>(Method::POST, "/pairings", this, true);
+    router.add_route<&AccessoryServer::route_prepare>(Method::POST, "/prepare", this, true);
+    router.add_route<&AccessoryServer::route_identify>(Method::POST, "/identify", this, false);  // Allow unencrypted access
     
     // Accessory endpoints (require verified pairing)
-    impl_->router->add_route(Method::GET, "/accessories",
-        [this](const Request& req, ConnectionContext& ctx) {
-            return impl_->accessory_endpoints->handle_get_accessories(req, ctx);
-        }, true);
+    router.add_route<&AccessoryServer::route_get_accessories>(Method::GET, "/accessories", this, true);
+    router.add_route<&AccessoryServer::route_get_characteristics>(Method::GET, "/characteristics", this, true);
+    router.add_route<&AccessoryServer::route_put_characteristics>(Method::PUT, "/characteristics", this, true);
     
-    impl_->router->add_route(Method::GET, "/characteristics",
-        [this](const Request& req, ConnectionContext& ctx) {
-            return impl_->accessory_endpoints->handle_get_characteristics(req, ctx);
-        }, true);
+    if (config_.enable_diagnostics_endpoint) {
+        router.add_route<&AccessoryServer::route_diagnostics>(Method::GET, "/diagnostics", this, true);
+    }
+}
+
+transport::Response AccessoryServer::route_pair_setup(const transport::Request& req, transport::ConnectionContext& ctx) {
+    return pairing_response(pair_setup_step(req.body, ctx), "Pairing error");
+}
+
+transport::Response AccessoryServer::route_pair_verify(const transport::Request& req, transport::ConnectionContext& ctx) {
+    return pairing_response(pair_verify_step(req.body, ctx), "Verification error");
+}
+
+transport::Response AccessoryServer::route_pairings(const transport::Request& req, transport::ConnectionContext& ctx) {
+    std::lock_guard<std::mutex> lock(impl_->pairing_mutex);
+    return impl_->pairing_endpoints->handle_pairings(req, ctx);
+}
+
+transport::Response AccessoryServer::route_prepare(const transport::Request& req, transport::ConnectionContext& ctx) {
+    std::unique_lock<std::shared_mutex> lock(database_.mutex());
+    return impl_->accessory_endpoints->handle_prepare(req, ctx);
+}
+
+transport::Response AccessoryServer::route_identify(const transport::Request& req, transport::ConnectionContext& ctx) {
+    (void)req;
+    (void)ctx;
+    
+    // HAP Spec 6.7.7: /identify is only valid if accessory is unpaired
+    if (impl_->pairing_store->is_paired()) {
+        // Return 400 Bad Request with HAP status -70401 (InsufficientPrivileges)
+        nlohmann::json error_response;
+        error_response["status"] = core::to_int(core::HAPStatus::InsufficientPrivileges);
+        transport::Response resp{transport::Status::BadRequest};
+        resp.set_header("Content-Type", "application/hap+json");
+        resp.set_body(error_response.dump());
+        return resp;
+    }
     
-    impl_->router->add_route(Method::PUT, "/characteristics",
-        [this](const Request& req, ConnectionContext& ctx) {
-            return impl_->accessory_endpoints->handle_put_characteristics(req, ctx);
-        }, true);
+    if (config_.on_identify) {
+        config_.on_identify();
+    }
+    return transport::Response{transport::Status::NoContent};
+}
+
+transport::Response AccessoryServer::route_get_accessories(const transport::Request& req, transport::ConnectionContext& ctx) {
+    // Exclusive: the cached JSON template may be rebuilt
+    std::unique_lock<std::shared_mutex> lock(database_.mutex());
+    return impl_->accessory_endpoints->handle_get_accessories(req, ctx);
+}
+
+transport::Response AccessoryServer::route_get_characteristics(const transport::Request& req, transport::ConnectionContext& ctx) {
+    std::shared_lock<std::shared_mutex> lock(database_.mutex());
+    return impl_->accessory_endpoints->handle_get_characteristics(req, ctx);
+}
+
+transport::Response AccessoryServer::route_put_characteristics(const transport::Request& req, transport::ConnectionContext& ctx) {
+    std::unique_lock<std::shared_mutex> lock(database_.mutex());
+    return impl_->accessory_endpoints->handle_put_characteristics(req, ctx);
+}
+
+transport::Response AccessoryServer::route_diagnostics(const transport::Request& req, transport::ConnectionContext& ctx) {
+    (void)req;
+    (void)ctx;
+    transport::Response resp{transport::Status::OK};
+    resp.set_header("Content-Type", "application/json");
+    resp.set_body(diagnostics_json(diagnostics()).dump());
+    return resp;
 }
 
 void AccessoryServer::start() {
-    config_.system->log(platform::System::LogLevel::Info, "HAP Server starting...");
+    HAP_LOG_INFO(config_.system, "HAP Server starting...");
+    start_began_ms_ = config_.system->millis();
+    uint64_t phase_began_ms = start_began_ms_;
+    auto end_phase = [&]() {
+        uint64_t now = config_.system->millis();
+        auto elapsed = static_cast<uint32_t>(now - phase_began_ms);
+        phase_began_ms = now;
+        return elapsed;
+    };
     
     // Check if database structure changed and increment CN if needed
     check_and_update_config_number();
+    startup_report_.config_number_ms = end_phase();
     
     // Start TCP listener
+    // With a worker pool, network callbacks only hand work to the connection's strand
     auto receive_cb = [this](uint32_t conn_id, std::span<const uint8_t> data) {
-        on_tcp_receive(conn_id, data);
+        if (impl_->workers) {
+            impl_->workers->post(conn_id, [this, conn_id, bytes = std::vector<uint8_t>(data.begin(), data.end())]() {
+                on_tcp_receive(conn_id, bytes);
+            });
+        } else {
+            on_tcp_receive(conn_id, data);
+        }
     };
     
     auto disconnect_cb = [this](uint32_t conn_id) {
-        on_tcp_disconnect(conn_id);
+        run_on_connection(conn_id, [this, conn_id]() { on_tcp_disconnect(conn_id); });
     };
     
     if (config_.network) {
         config_.network->tcp_listen(config_.port, receive_cb, disconnect_cb);
         
         // Register mDNS service
-        update_mdns();
+        publish_mdns();
     }
+    startup_report_.network_ms = end_phase();
     
     if (impl_->ble_transport) {
         impl_->ble_transport->start();
     }
+    startup_report_.ble_start_ms = end_phase();
+    
+    if (config_.defer_startup_work && !impl_->workers) {
+        scheduler_->schedule_once(0, [this]() { prepare_pair_setup(true); });
+    } else {
+        prepare_pair_setup(true);
+    }
+    startup_report_.pair_setup_ms = end_phase();
+    
+    startup_report_.start_ms = static_cast<uint32_t>(config_.system->millis() - start_began_ms_);
+    HAP_LOG_INFO(config_.system,
+        "[AccessoryServer] Started in " + std::to_string(startup_report_.start_ms) + " ms (construct " +
+        std::to_string(startup_report_.construct_ms) + ", config number " +
+        std::to_string(startup_report_.config_number_ms) + ", network " +
+        std::to_string(startup_report_.network_ms) + ", BLE " +
+        std::to_string(startup_report_.ble_start_ms) + ", pair setup " +
+        std::to_string(startup_report_.pair_setup_ms) + ")");
+    
+    started_ = true;
 }
 
 void AccessoryServer::update_mdns() {
     if (!config_.network) return;
+    
+    // The first registration goes out right away so the accessory is discoverable
+    if (!mdns_registered_) {
+        publish_mdns();
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(impl_->mdns_mutex);
+    if (impl_->mdns_task != common::TaskScheduler::INVALID_TASK_ID) return;  // Already pending
+    impl_->mdns_task = scheduler_->schedule_once(kMdnsDebounceMs, [this]() {
+        {
+            std::lock_guard<std::mutex> lock(impl_->mdns_mutex);
+            impl_->mdns_task = common::TaskScheduler::INVALID_TASK_ID;
+        }
+        publish_mdns();
+    });
+}
+
+void AccessoryServer::publish_mdns() {
+    if (!config_.network) return;
     platform::Network::MdnsService mdns_service;
     mdns_service.name = config_.device_name;
     mdns_service.type = "_hap._tcp";
     mdns_service.port = config_.port;
     
-    // Check pairing status
-    auto pairing_list_data = config_.storage->get("pairing_list");
-    bool is_paired = false;
-    if (pairing_list_data) {
-        if (pairing_list_data->size() > 2) {
-            is_paired = true;
-        }
-    }
-    
-    std::string sf_val = is_paired ? "0" : "1";
+    std::string sf_val = impl_->pairing_store->is_paired() ? "0" : "1";
     
     // Check config number
     auto config_num_data = config_.storage->get("config_number");
@@ -295,11 +618,19 @@ void AccessoryServer::update_mdns() {
     mdns_service.txt_records.push_back({"id", config_.accessory_id}); // Device ID
     mdns_service.txt_records.push_back({"md", config_.device_name}); // Model name
     mdns_service.txt_records.push_back({"pv", "1.1"}); // Protocol version
-    mdns_service.txt_records.push_back({"s#", "1"}); // State number
+    mdns_service.txt_records.push_back({"s#", kMdnsStateNumber}); // State number
     mdns_service.txt_records.push_back({"sf", sf_val}); // Status flags (1 = discoverable/unpaired, 0 = paired)
     mdns_service.txt_records.push_back({"ci", std::to_string(static_cast<uint16_t>(config_.category_id))}); // Category identifier
     mdns_service.txt_records.push_back({"ff", "0"}); // Feature flags
     
+    {
+        std::lock_guard<std::mutex> lock(impl_->mdns_mutex);
+        if (mdns_registered_ && mdns_service.txt_records == impl_->mdns_txt) {
+            return;  // Nothing changed; republishing would only cost multicast traffic
+        }
+        impl_->mdns_txt = mdns_service.txt_records;
+    }
+    
     // Use update instead of re-register if already registered
     if (mdns_registered_) {
         config_.network->mdns_update_txt_record(mdns_service);
@@ -310,23 +641,44 @@ void AccessoryServer::update_mdns() {
 }
 
 void AccessoryServer::stop() {
-    config_.system->log(platform::System::LogLevel::Info, "HAP Server stopping...");
+    HAP_LOG_INFO(config_.system, "HAP Server stopping...");
+    started_ = false;
+    
+    {
+        std::lock_guard<std::mutex> lock(impl_->mdns_mutex);
+        if (impl_->mdns_task != common::TaskScheduler::INVALID_TASK_ID) {
+            scheduler_->cancel(impl_->mdns_task);
+            impl_->mdns_task = common::TaskScheduler::INVALID_TASK_ID;
+        }
+    }
     
     if (impl_->ble_transport) {
         impl_->ble_transport->stop();
     }
     
-    impl_->connections.clear();
-    impl_->parsers.clear();
+    impl_->clear_connections();
+}
+
+void AccessoryServer::prepare_pair_setup(bool allow_blocking) {
+    if (impl_->pairing_store->is_paired()) return;
+    
+    if (impl_->workers) {
+        impl_->workers->post(kBackgroundStrand, [this]() { impl_->srp_verifiers->prepare(); });
+    } else if (allow_blocking) {
+        impl_->srp_verifiers->prepare();
+    }
 }
 
 void AccessoryServer::reset_pairing_state() {
+    // Flush the reset as a whole so a power loss cannot leave it half done
+    std::optional<platform::CachedStorage::Transaction> transaction;
+    if (impl_->cached_storage) {
+        transaction.emplace(*impl_->cached_storage);
+    }
+    
     const char* keys_to_clear[] = {
         "accessory_id",      // Device ID
         "setup_id",          // BLE Setup ID
-        "accessory_ltsk",    // Long-term secret key
-        "accessory_ltpk",    // Long-term public key
-        "pairing_list",      // List of paired controllers
         "gsn",               // Global State Number
         "config_number",     // Configuration number
         "ble_addr",
@@ -337,7 +689,10 @@ void AccessoryServer::reset_pairing_state() {
         config_.storage->remove(key);
     }
     
-    config_.system->log(platform::System::LogLevel::Info, 
+    // Long-term keys and controller pairings
+    impl_->pairing_store->clear();
+    
+    HAP_LOG_INFO(config_.system,
         "[AccessoryServer] All pairing state cleared");
     
     // Generate new accessory ID
@@ -356,7 +711,7 @@ void AccessoryServer::reset_pairing_state() {
     std::vector<uint8_t> id_bytes(config_.accessory_id.begin(), config_.accessory_id.end());
     config_.storage->set("accessory_id", id_bytes);
     
-    config_.system->log(platform::System::LogLevel::Info, 
+    HAP_LOG_INFO(config_.system,
         "[AccessoryServer] Generated new accessory ID: " + config_.accessory_id);
     
     // Reset all in-memory session state
@@ -368,6 +723,7 @@ void AccessoryServer::reset_pairing_state() {
     // Update BleTransport with new accessory ID
     if (impl_->ble_transport) {
         impl_->ble_transport->set_accessory_id(config_.accessory_id);
+        impl_->ble_transport->reset_state_number();
     }
     
     // Reset IIDManager - allows IID reuse after factory reset
@@ -376,10 +732,11 @@ void AccessoryServer::reset_pairing_state() {
     }
     
     pending_connection_cleanup_ = true;
+    prepare_pair_setup(false);
 }
 
 void AccessoryServer::factory_reset() {
-    config_.system->log(platform::System::LogLevel::Warning, 
+    HAP_LOG_WARNING(config_.system,
         "[AccessoryServer] Factory reset initiated");
     
     reset_pairing_state();
@@ -399,170 +756,516 @@ void AccessoryServer::factory_reset() {
         config_.on_pairings_changed(event);
     }
     
-    config_.system->log(platform::System::LogLevel::Info, 
+    HAP_LOG_INFO(config_.system,
         "[AccessoryServer] Factory reset complete - accessory is now unpaired");
 }
 
 void AccessoryServer::tick() {
+    impl_->immediate_work.drain();
+    
     if (scheduler_) {
         scheduler_->tick();
     }
+    
+    // Retry connections whose outbound queue was held back, at most one
+    // drain queued per connection and spaced out while the peer stays slow
+    uint64_t now = config_.system->millis();
+    for (const auto& [conn_id, connection] : impl_->snapshot_connections()) {
+        if (!connection->ctx.outbound().has_pending()) {
+            if (connection->drain_backoff_ms != 0) connection->drain_backoff_ms = 0;
+            continue;
+        }
+        if (connection->drain_retry_ms > now) continue;
+        if (connection->drain_scheduled.exchange(true)) continue;
+        run_on_connection(conn_id, [this, conn_id = conn_id]() {
+            auto connection = impl_->find_connection(conn_id);
+            if (!connection) return;
+            connection->drain_scheduled = false;
+            auto& ctx = connection->ctx;
+            if (!drain_outbound(conn_id, ctx)) {
+                uint32_t backoff = std::clamp(connection->drain_backoff_ms * 2, kDrainBackoffMinMs, kDrainBackoffMaxMs);
+                connection->drain_backoff_ms = backoff;
+                connection->drain_retry_ms = config_.system->millis() + backoff;
+                return;
+            }
+            connection->drain_backoff_ms = 0;
+            connection->drain_retry_ms = 0;
+            if (ctx.should_close()) {
+                HAP_LOG_INFO(config_.system,
+                    "[AccessoryServer] Closing connection #" + std::to_string(conn_id) + " as requested");
+                config_.network->tcp_disconnect(conn_id);
+            }
+        });
+    }
+}
+
+void AccessoryServer::run_on_connection(uint32_t connection_id, common::WorkerPool::Task task) {
+    if (impl_->workers) {
+        impl_->workers->post(connection_id, std::move(task));
+    } else {
+        task();
+    }
+}
+
+std::optional<uint64_t> AccessoryServer::next_deadline_ms() {
+    if (!impl_->immediate_work.empty()) return config_.system->millis();
+    
+    // Backed-up outbound queues are retried when their backoff runs out;
+    // one with a drain already queued reports again once it has run
+    auto deadline = scheduler_ ? scheduler_->next_deadline_ms() : std::nullopt;
+    for (const auto& [conn_id, connection] : impl_->snapshot_connections()) {
+        if (!connection->ctx.outbound().has_pending() || connection->drain_scheduled) continue;
+        uint64_t retry = connection->drain_retry_ms;
+        if (!deadline || retry < *deadline) deadline = retry;
+    }
+    if (deadline) deadline = std::max(*deadline, config_.system->millis());
+    return deadline;
 }
 
 void AccessoryServer::on_tcp_receive(uint32_t connection_id, std::span<const uint8_t> data) {
-    config_.system->log(platform::System::LogLevel::Debug, 
+    HAP_LOG_DEBUG(config_.system,
         "[AccessoryServer] Received " + std::to_string(data.size()) + " bytes from connection " + std::to_string(connection_id));
     
-    // Get or create connection context
-    auto& ctx = impl_->connections[connection_id];
-    if (!ctx) {
-        config_.system->log(platform::System::LogLevel::Info, 
+    // Get or create connection context and HTTP parser
+    std::shared_ptr<Impl::Connection> connection;
+    bool created = false;
+    {
+        std::lock_guard<std::mutex> lock(impl_->connections_mutex);
+        connection = impl_->connections->acquire(connection_id, &created);
+    }
+    if (!connection) {
+        HAP_LOG_WARNING(config_.system,
+            "[AccessoryServer] Rejecting connection #" + std::to_string(connection_id) + ": all " +
+            std::to_string(config_.max_connections) + " connection slots in use");
+        common::count(impl_->metrics.get(), common::Counter::RejectedConnections);
+        config_.network->tcp_disconnect(connection_id);
+        return;
+    }
+    auto& parser = connection->parser;
+    uint64_t now = config_.system->millis();
+    if (created) {
+        HAP_LOG_INFO(config_.system,
             "[AccessoryServer] New connection #" + std::to_string(connection_id));
-        ctx = std::make_unique<transport::ConnectionContext>(config_.crypto, config_.system, connection_id);
+        parser.set_max_request_bytes(config_.max_request_bytes);
+        if (config_.idle_timeout_ms > 0) {
+            arm_connection_timeouts(now + config_.idle_timeout_ms);
+        }
     }
+    connection->last_receive_ms = now;
+    connection->bytes_received += data.size();
+    // The request timeout runs from the first byte, so trickling cannot extend it
+    bool starting_request = connection->request_started_ms == 0;
+    if (starting_request) {
+        connection->request_started_ms = now;
+    }
+    auto* ctx = &connection->ctx;
     
-    // Get or create HTTP parser
-    auto& parser = impl_->parsers[connection_id];
-    
-    // Decrypt if connection is encrypted
-    std::vector<uint8_t> plaintext_data;
+    // Decrypt straight into the parser's receive buffer if connection is encrypted
+    bool complete = false;
     if (ctx->is_encrypted() && ctx->get_secure_session()) {
         if(!ctx->rx_encrypted()) {
             ctx->set_rx_encrypted(true);
         }
-        config_.system->log(platform::System::LogLevel::Debug, 
-            "[AccessoryServer] Decrypting frame for connection #" + std::to_string(connection_id));
-        auto decrypted = ctx->get_secure_session()->decrypt_frame(data);
+        HAP_LOG_DEBUG(config_.system,
+            "[AccessoryServer] Decrypting frames for connection #" + std::to_string(connection_id));
+        // Drain every complete frame in this segment before parsing
+        common::Metrics::Scope decrypt_timer(impl_->metrics.get(), common::Metric::Decrypt);
+        auto decrypted = ctx->get_secure_session()->decrypt_all_frames_into(data, parser.receive_buffer());
+        decrypt_timer.stop();
         if (!decrypted) {
-            config_.system->log(platform::System::LogLevel::Warning, 
-                "[AccessoryServer] Decryption failed or incomplete frame for connection #" + std::to_string(connection_id));
+            // The session cannot resynchronize after a bad frame
+            common::count(impl_->metrics.get(), common::Counter::DecryptFailures);
+            HAP_LOG_WARNING(config_.system,
+                "[AccessoryServer] Decryption failed, closing connection #" + std::to_string(connection_id));
+            config_.network->tcp_disconnect(connection_id);
             return;
         }
-        plaintext_data = *decrypted;
-        config_.system->log(platform::System::LogLevel::Debug, 
-            "[AccessoryServer] Decrypted " + std::to_string(plaintext_data.size()) + " bytes");
+        if (*decrypted > 0) {
+            HAP_LOG_DEBUG(config_.system,
+                "[AccessoryServer] Decrypted " + std::to_string(*decrypted) + " bytes");
+            common::count(impl_->metrics.get(), common::Counter::BytesDecrypted, *decrypted);
+            common::Metrics::Scope parse_timer(impl_->metrics.get(), common::Metric::RequestParse);
+            // Requests behind a deferred response wait in the buffer
+            complete = !ctx->response_pending() && parser.parse();
+        }
+    } else if (ctx->response_pending()) {
+        auto& buffer = parser.receive_buffer();
+        buffer.insert(buffer.end(), data.begin(), data.end());
     } else {
-        plaintext_data.assign(data.begin(), data.end());
+        common::Metrics::Scope parse_timer(impl_->metrics.get(), common::Metric::RequestParse);
+        complete = parser.feed(data);
+    }
+    
+    if (parser.malformed()) {
+        // Answered once; the connection closes when the 400 has gone out
+        if (!ctx->should_close()) {
+            HAP_LOG_WARNING(config_.system,
+                "[AccessoryServer] Malformed request head, closing connection #" + std::to_string(connection_id));
+            ctx->request_close();
+            send_response(connection_id, *ctx, transport::Response{transport::Status::BadRequest});
+        }
+        return;
+    }
+    if (parser.failed() ||
+        (config_.max_request_bytes > 0 && parser.receive_buffer().size() > config_.max_request_bytes)) {
+        HAP_LOG_WARNING(config_.system,
+            "[AccessoryServer] Request exceeds " + std::to_string(config_.max_request_bytes) +
+            " bytes, closing connection #" + std::to_string(connection_id));
+        config_.network->tcp_disconnect(connection_id);
+        return;
+    }
+    
+    process_requests(connection_id, *ctx, parser, complete);
+    
+    // Requests buffered behind a deferred response are waiting on us, not the controller
+    auto* session = ctx->get_secure_session();
+    bool partial = !ctx->response_pending() &&
+                   (parser.has_partial_request() || (session && session->has_partial_frame()));
+    if (!partial) {
+        connection->request_started_ms = 0;
+    } else if (starting_request && config_.request_timeout_ms > 0) {
+        arm_connection_timeouts(now + config_.request_timeout_ms);
     }
     
-    // Feed to HTTP parser
-    if (parser.feed(plaintext_data)) {
-        auto request = parser.take_request();
-        parser.reset();
+    // Prepared timed writes are dropped by the same sweep once they expire
+    uint64_t timed_write_expiry = ctx->timed_writes().next_expiry().value_or(0);
+    if (connection->timed_write_expiry_ms.exchange(timed_write_expiry) != timed_write_expiry &&
+        timed_write_expiry != 0) {
+        arm_connection_timeouts(timed_write_expiry + 1);
+    }
+}
+
+void AccessoryServer::arm_connection_timeouts(uint64_t deadline_ms) {
+    if (!scheduler_) return;
+    std::lock_guard<std::mutex> lock(impl_->timeouts_mutex);
+    if (impl_->timeouts_task != common::TaskScheduler::INVALID_TASK_ID) {
+        if (impl_->timeouts_deadline_ms <= deadline_ms) return;
+        scheduler_->cancel(impl_->timeouts_task);
+    }
+    uint64_t now = config_.system->millis();
+    uint32_t delay = deadline_ms > now ? static_cast<uint32_t>(deadline_ms - now) : 0;
+    impl_->timeouts_deadline_ms = deadline_ms;
+    impl_->timeouts_task = scheduler_->schedule_once(delay, [this]() { check_connection_timeouts(); });
+}
+
+void AccessoryServer::check_connection_timeouts() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->timeouts_mutex);
+        impl_->timeouts_task = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    
+    // Deadlines move with traffic; the sweep only re-arms for the earliest one
+    uint64_t now = config_.system->millis();
+    std::optional<uint64_t> next;
+    for (const auto& [conn_id, connection] : impl_->snapshot_connections()) {
+        std::optional<uint64_t> deadline;
+        const char* reason = nullptr;
+        uint64_t started = connection->request_started_ms;
+        if (config_.request_timeout_ms > 0 && started != 0) {
+            deadline = started + config_.request_timeout_ms;
+            reason = "request not completed in time";
+        }
+        if (config_.idle_timeout_ms > 0) {
+            uint64_t idle = connection->last_receive_ms + config_.idle_timeout_ms;
+            if (!deadline || idle < *deadline) {
+                deadline = idle;
+                reason = "idle";
+            }
+        }
         
-        config_.system->log(platform::System::LogLevel::Debug,
-            "[AccessoryServer] HTTP Request: " + method_to_string(request.method) + " " + request.path);
+        uint64_t timed_write_expiry = connection->timed_write_expiry_ms;
+        if (timed_write_expiry != 0) {
+            if (timed_write_expiry < now) {
+                run_on_connection(conn_id, [this, conn_id = conn_id]() {
+                    auto connection = impl_->find_connection(conn_id);
+                    if (!connection) return;
+                    auto& timed_writes = connection->ctx.timed_writes();
+                    timed_writes.expire(config_.system->millis());
+                    auto remaining = timed_writes.next_expiry();
+                    connection->timed_write_expiry_ms = remaining.value_or(0);
+                    if (remaining) arm_connection_timeouts(*remaining + 1);
+                });
+            } else if (!next || timed_write_expiry + 1 < *next) {
+                next = timed_write_expiry + 1;
+            }
+        }
+        if (!deadline) continue;
         
-        // Log headers
+        if (*deadline <= now) {
+            HAP_LOG_INFO(config_.system,
+                "[AccessoryServer] Closing connection #" + std::to_string(conn_id) + ": " + reason);
+            common::count(impl_->metrics.get(), common::Counter::TimedOutConnections);
+            run_on_connection(conn_id, [this, conn_id = conn_id]() {
+                config_.network->tcp_disconnect(conn_id);
+            });
+        } else if (!next || *deadline < *next) {
+            next = *deadline;
+        }
+    }
+    if (next) {
+        arm_connection_timeouts(*next);
+    }
+}
+
+std::optional<std::vector<uint8_t>> AccessoryServer::pair_setup_step(std::span<const uint8_t> body,
+                                                                     transport::ConnectionContext& ctx) {
+    core::TLV8View tlvs(body);
+    auto state = tlvs.find_uint8(static_cast<uint8_t>(pairing::TLVType::State));
+    bool is_m1 = state && *state == static_cast<uint8_t>(pairing::PairingState::M1);
+    
+    // SRP work for M2 runs outside the pairing lock so other connections keep verifying
+    if (is_m1) {
+        impl_->srp_verifiers->prepare();
+    }
+    
+    auto tlv = [&]() {
+        std::lock_guard<std::mutex> lock(impl_->pairing_mutex);
+        return impl_->pairing_endpoints->pair_setup(body, ctx);
+    }();
+    
+    // Have a session ready if the controller restarts pairing
+    if (is_m1) {
+        prepare_pair_setup(false);
+    }
+    return tlv;
+}
+
+std::optional<std::vector<uint8_t>> AccessoryServer::pair_verify_step(std::span<const uint8_t> body,
+                                                                      transport::ConnectionContext& ctx) {
+    std::lock_guard<std::mutex> lock(impl_->pairing_mutex);
+    return impl_->pairing_endpoints->pair_verify(body, ctx);
+}
+
+bool AccessoryServer::handle_pairing_request(uint32_t connection_id, transport::ConnectionContext& ctx,
+                                             const transport::Request& request) {
+    bool setup = request.path == "/pair-setup";
+    auto tlv = setup ? pair_setup_step(request.body, ctx) : pair_verify_step(request.body, ctx);
+    if (!tlv) {
+        return send_response(connection_id, ctx, pairing_response(std::nullopt, setup ? "Pairing error" : "Verification error"));
+    }
+    common::count(impl_->metrics.get(), common::Counter::PairingFastPath);
+    
+    // The session's TLV becomes the message body as is; only the head is written here
+    transport::OutboundQueue::Message message;
+    message.priority = transport::OutboundQueue::Priority::Response;
+    message.encrypt = false;  // Pair Verify M4 goes out in plaintext even though the session is now secure
+    transport::HTTPBuilder::append_head(transport::Status::OK, kPairingContentType, tlv->size(), message.head);
+    message.body = std::move(*tlv);
+    return send_message(connection_id, ctx, std::move(message));
+}
+
+void AccessoryServer::process_requests(uint32_t connection_id, transport::ConnectionContext& ctx,
+                                       transport::HTTPParser& parser, bool complete) {
+    // Handle every complete request in the buffer; controllers may pipeline
+    while (complete) {
+        bool open = handle_request(connection_id, ctx, parser.take_request());
+        // The request is gone, so the next one can reuse its arena space
+        parser.release_request_memory();
+        if (!open || pending_connection_cleanup_) break;
+        common::Metrics::Scope parse_timer(impl_->metrics.get(), common::Metric::RequestParse);
+        complete = parser.parse();
+    }
+    
+    if (pending_connection_cleanup_.exchange(false)) {
+        impl_->clear_connections();
+        HAP_LOG_DEBUG(config_.system,
+            "[AccessoryServer] Deferred connection cleanup completed");
+    }
+}
+
+void AccessoryServer::send_deferred_response(uint32_t connection_id, transport::Response response) {
+    auto connection = impl_->find_connection(connection_id);
+    if (!connection || !connection->ctx.response_pending()) {
+        return;  // Disconnected while the callbacks ran
+    }
+    connection->ctx.set_response_pending(false);
+    if (!send_response(connection_id, connection->ctx, std::move(response))) {
+        return;
+    }
+    // Requests that arrived in the meantime were only buffered
+    bool complete;
+    {
+        common::Metrics::Scope parse_timer(impl_->metrics.get(), common::Metric::RequestParse);
+        complete = connection->parser.parse();
+    }
+    process_requests(connection_id, connection->ctx, connection->parser, complete);
+}
+
+bool AccessoryServer::handle_request(uint32_t connection_id, transport::ConnectionContext& ctx, transport::Request request) {
+    // Plaintext pairing traffic skips the router, the dumps and the Response round trip
+    if (!ctx.is_encrypted() && request.method == transport::Method::POST &&
+        (request.path == "/pair-setup" || request.path == "/pair-verify")) {
+        return handle_pairing_request(connection_id, ctx, request);
+    }
+    
+    HAP_LOG_DEBUG(config_.system,
+        "[AccessoryServer] HTTP Request: " + method_to_string(request.method) + " " + std::string(request.path) +
+        (request.query.empty() ? "" : "?" + std::string(request.query)));
+    
+    // Dump headers and body only when Debug output is actually wanted
+    const bool trace = HAP_LOG_ENABLED(config_.system, Debug);
+
+    // Log headers
+    if (trace) {
         for (const auto& [key, value] : request.headers) {
-            config_.system->log(platform::System::LogLevel::Debug, 
-                "[AccessoryServer] Header: " + key + ": " + value);
+            HAP_LOG_DEBUG(config_.system,
+                "[AccessoryServer] Header: " + std::string(key) + ": " + std::string(value));
         }
-        
+    }
+
+    // Log body
+    if (trace && !request.body.empty()) {
+        std::string_view content_type = request.get_header("Content-Type");
+        if (content_type == "application/pairing+tlv8") {
+            std::ostringstream oss;
+            for (uint8_t b : request.body) {
+                oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
+            }
+            HAP_LOG_DEBUG(config_.system,
+                "[AccessoryServer] Body (TLV8): " + oss.str());
+        } else {
+            std::string body_str(request.body.begin(), request.body.end());
+            HAP_LOG_DEBUG(config_.system,
+                "[AccessoryServer] Body: " + body_str);
+        }
+    }
+    
+    // Dispatch to router; the handler's response is moved, not copied, to the queue
+    auto response = impl_->router->dispatch(request, ctx);
+    
+    if (response && response->is_deferred) {
+        // Sent by send_deferred_response(); later requests wait until then
+        ctx.set_response_pending(true);
+        return false;
+    }
+    
+    transport::Response final_response;
+    if (response) {
+        final_response = std::move(response).value();
+        HAP_LOG_DEBUG(config_.system,
+            "[AccessoryServer] HTTP Response: " + std::to_string(static_cast<int>(final_response.status)));
+    
+        // Log headers
+        if (trace) {
+            for (const auto& [key, value] : final_response.headers) {
+                HAP_LOG_DEBUG(config_.system,
+                    "[AccessoryServer] Response Header: " + key + ": " + value);
+            }
+        }
+    
         // Log body
-        if (!request.body.empty()) {
-            std::string content_type = request.get_header("Content-Type");
+        if (trace && !final_response.body.empty()) {
+            auto it = final_response.headers.find("Content-Type");
+            std::string content_type = (it != final_response.headers.end()) ? it->second : "";
+    
             if (content_type == "application/pairing+tlv8") {
                 std::ostringstream oss;
-                for (uint8_t b : request.body) {
+                for (uint8_t b : final_response.body) {
                     oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
                 }
-                config_.system->log(platform::System::LogLevel::Debug, 
-                    "[AccessoryServer] Body (TLV8): " + oss.str());
+                HAP_LOG_DEBUG(config_.system,
+                    "[AccessoryServer] Response Body (TLV8): " + oss.str());
             } else {
-                std::string body_str(request.body.begin(), request.body.end());
-                config_.system->log(platform::System::LogLevel::Debug, 
-                    "[AccessoryServer] Body: " + body_str);
+                std::string body_str(final_response.body.begin(), final_response.body.end());
+                HAP_LOG_DEBUG(config_.system,
+                    "[AccessoryServer] Response Body: " + body_str);
             }
         }
-        
-        // Dispatch to router
-        auto response = impl_->router->dispatch(request, *ctx);
-        
-        transport::Response final_response;
-        if (response) {
-            final_response = *response;
-            config_.system->log(platform::System::LogLevel::Debug, 
-                "[AccessoryServer] HTTP Response: " + std::to_string(static_cast<int>(final_response.status)));
-            
-            // Log headers
-            for (const auto& [key, value] : final_response.headers) {
-                config_.system->log(platform::System::LogLevel::Debug, 
-                    "[AccessoryServer] Response Header: " + key + ": " + value);
-            }
-            
-            // Log body
-            if (!final_response.body.empty()) {
-                auto it = final_response.headers.find("Content-Type");
-                std::string content_type = (it != final_response.headers.end()) ? it->second : "";
-                
-                if (content_type == "application/pairing+tlv8") {
-                    std::ostringstream oss;
-                    for (uint8_t b : final_response.body) {
-                        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
-                    }
-                    config_.system->log(platform::System::LogLevel::Debug, 
-                        "[AccessoryServer] Response Body (TLV8): " + oss.str());
-                } else {
-                    std::string body_str(final_response.body.begin(), final_response.body.end());
-                    config_.system->log(platform::System::LogLevel::Debug, 
-                        "[AccessoryServer] Response Body: " + body_str);
-                }
-            }
-        } else {
-            config_.system->log(platform::System::LogLevel::Warning, 
-                "[AccessoryServer] No route found for: " + request.path);
-            // HAP Spec 6.7.1.4: 4xx responses must include HAP status code
-            nlohmann::json error_response;
-            error_response["status"] = core::to_int(core::HAPStatus::ResourceDoesNotExist);
-            final_response = transport::Response{transport::Status::NotFound};
-            final_response.set_header("Content-Type", "application/hap+json");
-            final_response.set_body(error_response.dump());
+    } else {
+        common::count(impl_->metrics.get(), common::Counter::UnroutedRequests);
+        HAP_LOG_WARNING(config_.system,
+            "[AccessoryServer] No route found for: " + request.path);
+        // HAP Spec 6.7.1.4: 4xx responses must include HAP status code
+        nlohmann::json error_response;
+        error_response["status"] = core::to_int(core::HAPStatus::ResourceDoesNotExist);
+        final_response = transport::Response{transport::Status::NotFound};
+        final_response.set_header("Content-Type", "application/hap+json");
+        final_response.set_body(error_response.dump());
+    }
+    
+    return send_response(connection_id, ctx, std::move(final_response));
+}
+
+bool AccessoryServer::send_response(uint32_t connection_id, transport::ConnectionContext& ctx, transport::Response final_response) {
+    // Build HTTP response; the body is moved into the queue, never copied next to the head
+    transport::OutboundQueue::Message message;
+    message.priority = transport::OutboundQueue::Priority::Response;
+    message.encrypt = ctx.is_encrypted() && ctx.rx_encrypted();
+    transport::HTTPBuilder::append_head(final_response, message.head);
+    message.body = std::move(final_response.body);
+    return send_message(connection_id, ctx, std::move(message));
+}
+
+bool AccessoryServer::send_message(uint32_t connection_id, transport::ConnectionContext& ctx,
+                                   transport::OutboundQueue::Message message) {
+    HAP_LOG_DEBUG(config_.system,
+        std::string("[AccessoryServer] Queueing ") + (message.encrypt ? "encrypted" : "plaintext") +
+        " response (" + std::to_string(message.size()) + " bytes)");
+    ctx.outbound().push(std::move(message));
+    bool drained = drain_outbound(connection_id, ctx);
+    
+    if (ctx.should_close()) {
+        // A stalled response is flushed first; tick() closes once it drains
+        if (!drained) return false;
+        HAP_LOG_INFO(config_.system,
+            "[AccessoryServer] Closing connection #" + std::to_string(connection_id) + " as requested");
+        // May synchronously invoke on_tcp_disconnect and destroy ctx
+        config_.network->tcp_disconnect(connection_id);
+        return false;
+    }
+    return true;
+}
+
+bool AccessoryServer::drain_outbound(uint32_t connection_id, transport::ConnectionContext& ctx) {
+    auto& queue = ctx.outbound();
+    while (auto* message = queue.front()) {
+        if (!config_.network->tcp_can_send(connection_id)) {
+            HAP_LOG_DEBUG(config_.system,
+                "[AccessoryServer] Connection #" + std::to_string(connection_id) + " is backed up, " +
+                std::to_string(queue.stats().depth) + " messages queued");
+            return false;
         }
         
-        // Build HTTP response
-        auto response_bytes = transport::HTTPBuilder::build(final_response);
-        
-        // Encrypt if connection is encrypted
-        if (ctx->is_encrypted() && ctx->rx_encrypted()) {
-            config_.system->log(platform::System::LogLevel::Debug, 
-                "[AccessoryServer] Encrypting response (" + std::to_string(response_bytes.size()) + " bytes)");
-            
-            size_t offset = 0;
-            while (offset < response_bytes.size()) {
-                size_t chunk_size = std::min(response_bytes.size() - offset, (size_t)1024);
-                std::span<const uint8_t> chunk(response_bytes.data() + offset, chunk_size);
-                auto encrypted = ctx->get_secure_session()->encrypt_frame(chunk);
-                config_.network->tcp_send(connection_id, encrypted);
-                offset += chunk_size;
+        uint64_t frames = 0;
+        if (message->encrypt) {
+            // All frames are sealed into one reused buffer and sent at once
+            thread_local std::vector<uint8_t> sealed;
+            sealed.clear();
+            sealed.reserve(transport::SecureSession::sealed_size(message->size()));
+            auto* session = ctx.get_secure_session();
+            common::Metrics::Scope encrypt_timer(impl_->metrics.get(), common::Metric::Encrypt);
+            bool sealed_ok = session->encrypt_frames_into(message->head, message->body, sealed);
+            encrypt_timer.stop();
+            if (!sealed_ok) {
+                // Nonces are spent, so nothing later on this session would
+                // decrypt at the controller; drop the rest and close
+                HAP_LOG_ERROR(config_.system,
+                    "[AccessoryServer] Encryption failed on connection #" + std::to_string(connection_id) +
+                    ", closing");
+                queue.clear();
+                ctx.request_close();
+                return true;
             }
+            common::count(impl_->metrics.get(), common::Counter::BytesEncrypted, message->size());
+            config_.network->tcp_send(connection_id, sealed);
+            frames = (message->size() + transport::SecureSession::MAX_FRAME_PAYLOAD - 1) /
+                     transport::SecureSession::MAX_FRAME_PAYLOAD;
         } else {
-            config_.system->log(platform::System::LogLevel::Debug, 
-                "[AccessoryServer] Sending plaintext response (" + std::to_string(response_bytes.size()) + " bytes)");
-            config_.network->tcp_send(connection_id, response_bytes);
+            std::array<std::span<const uint8_t>, 2> buffers = {
+                std::span<const uint8_t>(message->head), std::span<const uint8_t>(message->body)};
+            config_.network->tcp_send_vectored(connection_id, buffers);
         }
-        
-        if (ctx->should_close()) {
-            config_.system->log(platform::System::LogLevel::Info, 
-                "[AccessoryServer] Closing connection #" + std::to_string(connection_id) + " as requested");
-            config_.network->tcp_disconnect(connection_id);
-        }
-    }
-    
-    if (pending_connection_cleanup_) {
-        pending_connection_cleanup_ = false;
-        impl_->connections.clear();
-        impl_->parsers.clear();
-        config_.system->log(platform::System::LogLevel::Debug,
-            "[AccessoryServer] Deferred connection cleanup completed");
+        queue.pop(frames);
     }
+    return true;
 }
 
 void AccessoryServer::on_tcp_disconnect(uint32_t connection_id) {
-    config_.system->log(platform::System::LogLevel::Info, 
+    HAP_LOG_INFO(config_.system,
         "[AccessoryServer] Connection #" + std::to_string(connection_id) + " disconnected");
-    impl_->connections.erase(connection_id);
-    impl_->parsers.erase(connection_id);
+    impl_->events.remove_connection(connection_id);
+    std::lock_guard<std::mutex> lock(impl_->connections_mutex);
+    impl_->connections->release(connection_id);
 }
 
 void AccessoryServer::broadcast_event(uint64_t aid, uint64_t iid, const core::Value& value, uint32_t exclude_conn_id) {
@@ -572,80 +1275,87 @@ void AccessoryServer::broadcast_event(uint64_t aid, uint64_t iid, const core::Va
     if(!config_.network) {
         return;
     }
-    nlohmann::json body_json;
-    nlohmann::json characteristics = nlohmann::json::array();
-    nlohmann::json char_json;
-    char_json["aid"] = aid;
-    char_json["iid"] = iid;
-
-    std::visit([&char_json](auto&& arg) {
-        using T = std::decay_t<decltype(arg)>;
-        if constexpr (std::is_same_v<T, bool>) {
-            char_json["value"] = arg;
-        } else if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || 
-                             std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t> || 
-                             std::is_same_v<T, int32_t> || std::is_same_v<T, float>) {
-            char_json["value"] = arg;
-        } else if constexpr (std::is_same_v<T, std::string>) {
-            char_json["value"] = arg;
-        } else {
-            char_json["value"] = nullptr;
-        }
-    }, value);
-
-    characteristics.push_back(char_json);
-    body_json["characteristics"] = characteristics;
-    std::string body = body_json.dump();
-
-    std::ostringstream ss;
-    ss << "EVENT/1.0 200 OK\r\n";
-    ss << "Content-Type: application/hap+json\r\n";
-    ss << "Content-Length: " << body.length() << "\r\n";
-    ss << "\r\n";
-    ss << body;
+    if (!impl_->events.has_subscribers(aid, iid)) {
+        return;
+    }
     
-    std::string response_str = ss.str();
-    std::vector<uint8_t> response_bytes(response_str.begin(), response_str.end());
+    bool first = impl_->events.enqueue(aid, iid, value, exclude_conn_id);
+    if (config_.event_coalesce_ms == 0) {
+        flush_events();
+    } else if (first) {
+        scheduler_->schedule_once(config_.event_coalesce_ms, [this]() {
+            flush_events();
+        });
+    }
+}
 
-    for (auto& [conn_id, ctx] : impl_->connections) {
-        if (conn_id == exclude_conn_id) continue;
+void AccessoryServer::flush_events() {
+    common::Metrics::Scope timer(impl_->metrics.get(), common::Metric::EventFanout);
+    // Each rendered message is shared by connections with the same changes;
+    // it is encrypted on the connection's strand when it leaves the queue
+    impl_->events.flush([this](uint32_t conn_id, std::span<const uint8_t> message,
+                               std::span<const uint64_t> keys) {
+        transport::OutboundQueue::Message event;
+        event.priority = transport::OutboundQueue::Priority::Event;
+        event.encrypt = true;
+        event.body.assign(message.begin(), message.end());
+        event.keys.assign(keys.begin(), keys.end());
         
-        if (ctx->is_encrypted() && ctx->has_subscription(aid, iid)) {
-            config_.system->log(platform::System::LogLevel::Debug, 
-                "[AccessoryServer] Sending event to connection #" + std::to_string(conn_id));
+        auto shared = std::make_shared<transport::OutboundQueue::Message>(std::move(event));
+        run_on_connection(conn_id, [this, conn_id, shared]() {
+            auto connection = impl_->find_connection(conn_id);
+            if (!connection || !connection->ctx.is_encrypted()) return;
             
-            size_t offset = 0;
-            while (offset < response_bytes.size()) {
-                size_t chunk_size = std::min(response_bytes.size() - offset, (size_t)1024);
-                std::span<const uint8_t> chunk(response_bytes.data() + offset, chunk_size);
-                auto encrypted = ctx->get_secure_session()->encrypt_frame(chunk);
-                config_.network->tcp_send(conn_id, encrypted);
-                offset += chunk_size;
+            HAP_LOG_DEBUG(config_.system,
+                "[AccessoryServer] Sending event to connection #" + std::to_string(conn_id));
+            connection->ctx.outbound().push(std::move(*shared));
+            if (drain_outbound(conn_id, connection->ctx) && connection->ctx.should_close()) {
+                config_.network->tcp_disconnect(conn_id);
             }
-        }
+        });
+    });
+}
+
+common::MetricsSnapshot AccessoryServer::metrics() const {
+    return impl_->metrics->snapshot();
+}
+
+void AccessoryServer::set_metrics_enabled(bool enabled) {
+    impl_->metrics->set_enabled(enabled);
+}
+
+void AccessoryServer::reset_metrics() {
+    impl_->metrics->reset();
+}
+
+AccessoryServer::Diagnostics AccessoryServer::diagnostics() const {
+    Diagnostics diagnostics;
+    for (const auto& [conn_id, connection] : impl_->snapshot_connections()) {
+        ConnectionDiagnostics entry;
+        entry.connection_id = conn_id;
+        entry.bytes_received = connection->bytes_received;
+        entry.subscriptions = impl_->events.subscription_count(conn_id);
+        entry.outbound = connection->ctx.outbound().stats();
+        diagnostics.connections.push_back(entry);
     }
+    diagnostics.scheduled_tasks = scheduler_ ? scheduler_->task_count() : 0;
+    diagnostics.min_free_heap = config_.system->min_free_heap();
+    diagnostics.metrics = impl_->metrics->snapshot();
+    return diagnostics;
+}
+
+std::optional<transport::OutboundQueue::Stats> AccessoryServer::outbound_stats(uint32_t connection_id) const {
+    auto connection = impl_->find_connection(connection_id);
+    if (!connection) return std::nullopt;
+    return connection->ctx.outbound().stats();
 }
 
 void AccessoryServer::check_and_update_config_number() {
-    // Build database structure hash
-    std::ostringstream hash_input;
-    
-    for (const auto& acc : database_.accessories()) {
-        hash_input << "A" << acc->aid() << ":";
-        for (const auto& svc : acc->services()) {
-            hash_input << "S" << std::hex << svc->type() << ":";
-            for (const auto& ch : svc->characteristics()) {
-                hash_input << "C" << std::hex << ch->type() << ",";
-            }
-        }
-    }
-    
-    std::string current_hash_input = hash_input.str();
-    
-    // Simple DJB2 hash
-    uint32_t hash = 5381;
-    for (char c : current_hash_input) {
-        hash = ((hash << 5) + hash) + static_cast<uint8_t>(c);
+    // Hash the database structure (stored as decimal text, as before)
+    uint64_t hash;
+    {
+        std::shared_lock lock(database_.mutex());
+        hash = database_.structure_hash();
     }
     
     std::string current_hash = std::to_string(hash);
@@ -664,7 +1374,7 @@ void AccessoryServer::check_and_update_config_number() {
     }
     
     if (structure_changed) {
-        config_.system->log(platform::System::LogLevel::Info, 
+        HAP_LOG_INFO(config_.system,
             "[AccessoryServer] Database structure changed, incrementing Configuration Number");
         
         auto cn_data = config_.storage->get("config_number");
@@ -678,6 +1388,12 @@ void AccessoryServer::check_and_update_config_number() {
         std::string cn_str = std::to_string(cn);
         config_.storage->set("config_number", std::vector<uint8_t>(cn_str.begin(), cn_str.end()));
         
+        // New configuration: drop the cached /accessories template
+        {
+            std::unique_lock lock(database_.mutex());
+            database_.invalidate_json_cache();
+        }
+        
         // Update stored hash
         if (iid_manager_) {
             iid_manager_->update_stored_hash(current_hash);
@@ -685,10 +1401,10 @@ void AccessoryServer::check_and_update_config_number() {
             config_.storage->set("db_hash", std::vector<uint8_t>(current_hash.begin(), current_hash.end()));
         }
 
-        config_.system->log(platform::System::LogLevel::Info, 
+        HAP_LOG_INFO(config_.system,
             "[AccessoryServer] Configuration Number updated to: " + cn_str);
     } else {
-        config_.system->log(platform::System::LogLevel::Debug, 
+        HAP_LOG_DEBUG(config_.system,
             "[AccessoryServer] Database structure unchanged, CN remains the same");
     }
 }
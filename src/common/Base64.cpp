@@ -0,0 +1,193 @@
+#include "hap/common/Base64.hpp"
+#include <array>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HAP_BASE64_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
+namespace hap::common {
+
+namespace {
+
+constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr uint8_t kInvalid = 64;
+
+constexpr std::array<uint8_t, 256> make_decode_table() {
+    std::array<uint8_t, 256> table{};
+    table.fill(kInvalid);
+    for (uint8_t i = 0; i < 64; ++i) {
+        table[static_cast<uint8_t>(kAlphabet[i])] = i;
+    }
+    return table;
+}
+
+constexpr auto kDecodeTable = make_decode_table();
+
+#ifdef HAP_BASE64_SSSE3
+
+// Vector algorithms after W. Mula and D. Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions" (2018), narrowed to 128-bit SSSE3.
+
+/// Encodes 12 bytes per step; reads 16, so stops while at least 16 remain
+__attribute__((target("ssse3")))
+size_t encode_ssse3(const uint8_t* in, size_t length, char* out) {
+    const __m128i shuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shift_lut = _mm_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t done = 0;
+    while (length - done >= 16) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + done)), shuffle);
+        // Spread each 24-bit group into four 6-bit indices, one per byte
+        __m128i t0 = _mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00));
+        __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+        __m128i t2 = _mm_and_si128(v, _mm_set1_epi32(0x003f03f0));
+        __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(t1, t3);
+        // Map index ranges to their ASCII offsets
+        __m128i reduced = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        __m128i is_upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        reduced = _mm_or_si128(reduced, _mm_and_si128(is_upper, _mm_set1_epi8(13)));
+        __m128i ascii = _mm_add_epi8(_mm_shuffle_epi8(shift_lut, reduced), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), ascii);
+        out += 16;
+        done += 12;
+    }
+    return done;
+}
+
+/**
+ * @brief Decodes 16 characters per step into 12 bytes (writes 16).
+ * Stops at the first block containing anything outside the alphabet,
+ * padding included, and leaves it to the scalar loop.
+ */
+__attribute__((target("ssse3")))
+size_t decode_ssse3(const char* in, size_t length, uint8_t* out, size_t out_capacity, size_t& produced) {
+    const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                         0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                         0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m128i lut_roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i mask_2f = _mm_set1_epi8(0x2f);
+    const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t done = 0;
+    produced = 0;
+    while (length - done >= 16 && out_capacity - produced >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + done));
+        __m128i hi = _mm_and_si128(_mm_srli_epi32(v, 4), mask_2f);
+        __m128i lo = _mm_and_si128(v, mask_2f);
+        __m128i invalid = _mm_and_si128(_mm_shuffle_epi8(lut_lo, lo), _mm_shuffle_epi8(lut_hi, hi));
+        if (_mm_movemask_epi8(_mm_cmpgt_epi8(invalid, _mm_setzero_si128())) != 0) {
+            break;
+        }
+        // ASCII -> 6-bit values, then pack four of them into three bytes
+        __m128i roll = _mm_shuffle_epi8(lut_roll, _mm_add_epi8(_mm_cmpeq_epi8(v, mask_2f), hi));
+        __m128i values = _mm_add_epi8(v, roll);
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + produced), _mm_shuffle_epi8(packed, pack));
+        produced += 12;
+        done += 16;
+    }
+    return done;
+}
+
+bool has_ssse3() {
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+
+#endif
+
+} // namespace
+
+namespace detail {
+
+void base64_encode_scalar(const uint8_t* in, size_t length, char* out) {
+    size_t i = 0;
+    for (; length - i >= 3; i += 3) {
+        uint32_t triple = (uint32_t(in[i]) << 16) | (uint32_t(in[i + 1]) << 8) | in[i + 2];
+        out[0] = kAlphabet[(triple >> 18) & 0x3F];
+        out[1] = kAlphabet[(triple >> 12) & 0x3F];
+        out[2] = kAlphabet[(triple >> 6) & 0x3F];
+        out[3] = kAlphabet[triple & 0x3F];
+        out += 4;
+    }
+    if (i < length) {
+        uint32_t triple = uint32_t(in[i]) << 16;
+        if (i + 1 < length) triple |= uint32_t(in[i + 1]) << 8;
+        out[0] = kAlphabet[(triple >> 18) & 0x3F];
+        out[1] = kAlphabet[(triple >> 12) & 0x3F];
+        out[2] = i + 1 < length ? kAlphabet[(triple >> 6) & 0x3F] : '=';
+        out[3] = '=';
+    }
+}
+
+size_t base64_decode_scalar(const char* in, size_t length, uint8_t* out) {
+    const auto* p = reinterpret_cast<const uint8_t*>(in);
+    const auto* end = p + length;
+    uint8_t* start = out;
+
+    // Whole quads first; the first irregular one drops to the per-symbol loop
+    while (end - p >= 4) {
+        uint32_t a = kDecodeTable[p[0]], b = kDecodeTable[p[1]];
+        uint32_t c = kDecodeTable[p[2]], d = kDecodeTable[p[3]];
+        if ((a | b | c | d) & kInvalid) break;
+        uint32_t triple = (a << 18) | (b << 12) | (c << 6) | d;
+        out[0] = static_cast<uint8_t>(triple >> 16);
+        out[1] = static_cast<uint8_t>(triple >> 8);
+        out[2] = static_cast<uint8_t>(triple);
+        out += 3;
+        p += 4;
+    }
+
+    uint32_t buffer = 0;
+    int bits_collected = 0;
+    for (; p < end && *p != '='; ++p) {
+        uint8_t d = kDecodeTable[*p];
+        if (d == kInvalid) continue;
+        buffer = (buffer << 6) | d;
+        bits_collected += 6;
+        if (bits_collected >= 8) {
+            bits_collected -= 8;
+            *out++ = static_cast<uint8_t>(buffer >> bits_collected);
+        }
+    }
+    return static_cast<size_t>(out - start);
+}
+
+} // namespace detail
+
+void base64_encode(std::span<const uint8_t> in, char* out) {
+    size_t done = 0;
+#ifdef HAP_BASE64_SSSE3
+    if (has_ssse3()) {
+        done = encode_ssse3(in.data(), in.size(), out);
+    }
+#endif
+    detail::base64_encode_scalar(in.data() + done, in.size() - done, out + done / 3 * 4);
+}
+
+std::string base64_encode(std::span<const uint8_t> in) {
+    std::string encoded(base64_encoded_size(in.size()), '\0');
+    base64_encode(in, encoded.data());
+    return encoded;
+}
+
+std::vector<uint8_t> base64_decode(std::string_view in) {
+    // Every 4 symbols yield 3 bytes; the slack covers the scalar tail and 16-byte stores
+    std::vector<uint8_t> result(in.size() / 4 * 3 + 4);
+    size_t consumed = 0;
+    size_t produced = 0;
+#ifdef HAP_BASE64_SSSE3
+    if (has_ssse3()) {
+        consumed = decode_ssse3(in.data(), in.size(), result.data(), result.size(), produced);
+    }
+#endif
+    produced += detail::base64_decode_scalar(in.data() + consumed, in.size() - consumed, result.data() + produced);
+    result.resize(produced);
+    return result;
+}
+
+} // namespace hap::common
@@ -0,0 +1,122 @@
+#include "hap/common/Metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+
+namespace hap::common {
+
+const char* metric_name(Metric metric) {
+    switch (metric) {
+        case Metric::RequestParse: return "request_parse";
+        case Metric::RouteDispatch: return "route_dispatch";
+        case Metric::Handler: return "handler";
+        case Metric::Encrypt: return "encrypt";
+        case Metric::Decrypt: return "decrypt";
+        case Metric::PairVerify: return "pair_verify";
+        case Metric::EventFanout: return "event_fanout";
+        case Metric::BlePdu: return "ble_pdu";
+        case Metric::SchedulerLag: return "scheduler_lag";
+        case Metric::Count: break;
+    }
+    return "unknown";
+}
+
+const char* counter_name(Counter counter) {
+    switch (counter) {
+        case Counter::BytesDecrypted: return "bytes_decrypted";
+        case Counter::BytesEncrypted: return "bytes_encrypted";
+        case Counter::DecryptFailures: return "decrypt_failures";
+        case Counter::UnroutedRequests: return "unrouted_requests";
+        case Counter::RejectedConnections: return "rejected_connections";
+        case Counter::TimedOutConnections: return "timed_out_connections";
+        case Counter::PairingFastPath: return "pairing_fast_path";
+        case Counter::Count: break;
+    }
+    return "unknown";
+}
+
+uint64_t LatencyStats::percentile_us(double percentile) const {
+    if (count == 0) return 0;
+    
+    // Nearest-rank: the smallest sample with at least `percentile` of samples at or below it
+    auto rank = static_cast<uint64_t>(std::ceil(static_cast<double>(count) * std::clamp(percentile, 0.0, 100.0) / 100.0));
+    rank = std::max<uint64_t>(rank, 1);
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            if (i == 0) return 0;
+            uint64_t upper = (uint64_t{1} << i) - 1;
+            return i == BUCKETS - 1 ? max_us : std::min(upper, max_us);
+        }
+    }
+    return max_us;
+}
+
+Metrics::Metrics(bool enabled, TraceHook trace_hook)
+    : enabled_(enabled), trace_hook_(std::move(trace_hook)) {}
+
+void Metrics::record(Metric metric, uint64_t duration_us) {
+    auto& histogram = histograms_[static_cast<size_t>(metric)];
+    size_t bucket = std::min<size_t>(std::bit_width(duration_us), LatencyStats::BUCKETS - 1);
+    
+    histogram.count.fetch_add(1, std::memory_order_relaxed);
+    histogram.total_us.fetch_add(duration_us, std::memory_order_relaxed);
+    histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    
+    uint64_t max = histogram.max_us.load(std::memory_order_relaxed);
+    while (duration_us > max &&
+           !histogram.max_us.compare_exchange_weak(max, duration_us, std::memory_order_relaxed)) {
+    }
+    
+    if (trace_hook_) {
+        trace_hook_(metric, duration_us);
+    }
+}
+
+void Metrics::add(Counter counter, uint64_t amount) {
+    counters_[static_cast<size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+    // Fields are read independently, so a snapshot taken under load may be
+    // off by the samples recorded while it was being copied
+    MetricsSnapshot out;
+    for (size_t m = 0; m < histograms_.size(); ++m) {
+        const auto& histogram = histograms_[m];
+        auto& stats = out.latency[m];
+        stats.count = histogram.count.load(std::memory_order_relaxed);
+        stats.total_us = histogram.total_us.load(std::memory_order_relaxed);
+        stats.max_us = histogram.max_us.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < LatencyStats::BUCKETS; ++i) {
+            stats.buckets[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+    for (size_t c = 0; c < counters_.size(); ++c) {
+        out.counters[c] = counters_[c].load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+void Metrics::reset() {
+    for (auto& histogram : histograms_) {
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.total_us.store(0, std::memory_order_relaxed);
+        histogram.max_us.store(0, std::memory_order_relaxed);
+        for (auto& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+    for (auto& counter : counters_) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t Metrics::now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+} // namespace hap::common
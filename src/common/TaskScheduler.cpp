@@ -3,32 +3,16 @@
 
 namespace hap::common {
 
-TaskScheduler::TaskScheduler(platform::System* system)
-    : system_(system) {}
+TaskScheduler::TaskScheduler(platform::System* system, Metrics* metrics)
+    : system_(system), metrics_(metrics) {}
 
 TaskScheduler::TaskId TaskScheduler::schedule_periodic(uint32_t interval_ms, TaskCallback callback) {
     if (!callback || interval_ms == 0) {
         return INVALID_TASK_ID;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    TaskId id = next_id_++;
-    if (next_id_ == INVALID_TASK_ID) {
-        next_id_ = 1;
-    }
-    
     uint64_t now = system_ ? system_->millis() : 0;
-    
-    tasks_.push_back(ScheduledTask{
-        .id = id,
-        .callback = std::move(callback),
-        .next_run_ms = now + interval_ms,
-        .interval_ms = interval_ms,
-        .cancelled = false
-    });
-    
-    return id;
+    return add_task(now + interval_ms, interval_ms, std::move(callback));
 }
 
 TaskScheduler::TaskId TaskScheduler::schedule_once(uint32_t delay_ms, TaskCallback callback) {
@@ -36,6 +20,11 @@ TaskScheduler::TaskId TaskScheduler::schedule_once(uint32_t delay_ms, TaskCallba
         return INVALID_TASK_ID;
     }
     
+    uint64_t now = system_ ? system_->millis() : 0;
+    return add_task(now + delay_ms, 0, std::move(callback));
+}
+
+TaskScheduler::TaskId TaskScheduler::add_task(uint64_t run_at_ms, uint32_t interval_ms, TaskCallback callback) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     TaskId id = next_id_++;
@@ -43,71 +32,75 @@ TaskScheduler::TaskId TaskScheduler::schedule_once(uint32_t delay_ms, TaskCallba
         next_id_ = 1;
     }
     
-    uint64_t now = system_ ? system_->millis() : 0;
-    
-    tasks_.push_back(ScheduledTask{
-        .id = id,
-        .callback = std::move(callback),
-        .next_run_ms = now + delay_ms,
-        .interval_ms = 0,
-        .cancelled = false
-    });
-    
+    tasks_.insert_or_assign(id, ScheduledTask{std::move(callback), interval_ms});
+    push_deadline(run_at_ms, id);
     return id;
 }
 
+void TaskScheduler::push_deadline(uint64_t run_at_ms, TaskId id) {
+    heap_.push_back(Deadline{run_at_ms, next_sequence_++, id});
+    std::push_heap(heap_.begin(), heap_.end(), std::greater<>{});
+}
+
 bool TaskScheduler::cancel(TaskId id) {
     if (id == INVALID_TASK_ID) {
         return false;
     }
     
+    // The heap entry is discarded lazily once it reaches the top
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& task : tasks_) {
-        if (task.id == id && !task.cancelled) {
-            task.cancelled = true;
-            return true;
-        }
-    }
-    return false;
+    return tasks_.erase(id) > 0;
 }
 
 void TaskScheduler::cancel_all() {
     std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& task : tasks_) {
-        task.cancelled = true;
-    }
+    tasks_.clear();
+    heap_.clear();
 }
 
 void TaskScheduler::tick(uint64_t current_time_ms) {
-    std::vector<std::pair<TaskCallback, size_t>> to_execute;
+    struct DueTask {
+        TaskId id;
+        TaskCallback callback;
+        uint32_t interval_ms;
+    };
+    std::vector<DueTask> to_execute;
     
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        for (size_t i = 0; i < tasks_.size(); ++i) {
-            auto& task = tasks_[i];
-            if (task.cancelled) continue;
+        while (!heap_.empty() && heap_.front().run_at_ms <= current_time_ms) {
+            TaskId id = heap_.front().id;
+            uint64_t run_at_ms = heap_.front().run_at_ms;
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<>{});
+            heap_.pop_back();
+            
+            auto it = tasks_.find(id);
+            if (it == tasks_.end()) continue;  // Cancelled
             
-            if (current_time_ms >= task.next_run_ms) {
-                if (task.callback) {
-                    to_execute.emplace_back(task.callback, i);
-                }
-                
-                if (task.interval_ms > 0) {
-                    task.next_run_ms = current_time_ms + task.interval_ms;
-                } else {
-                    task.cancelled = true;
-                }
+            if (metrics_ && metrics_->enabled()) {
+                metrics_->record(Metric::SchedulerLag, (current_time_ms - run_at_ms) * 1000);
+            }
+            
+            // Callbacks are moved out so they run without the lock held
+            to_execute.push_back(DueTask{id, std::move(it->second.callback), it->second.interval_ms});
+            if (it->second.interval_ms == 0) {
+                tasks_.erase(it);
             }
         }
     }
     
-    for (auto& [callback, index] : to_execute) {
-        callback();
-    }
-    
-    {
-        std::lock_guard<std::mutex> lock(mutex_);
-        cleanup_cancelled_tasks();
+    for (auto& task : to_execute) {
+        task.callback();
+        
+        if (task.interval_ms > 0) {
+            // Periodic: hand the callback back unless it was cancelled meanwhile
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = tasks_.find(task.id);
+            if (it != tasks_.end()) {
+                it->second.callback = std::move(task.callback);
+                push_deadline(current_time_ms + task.interval_ms, task.id);
+            }
+        }
     }
 }
 
@@ -117,13 +110,25 @@ void TaskScheduler::tick() {
     }
 }
 
-void TaskScheduler::cleanup_cancelled_tasks() {
-    tasks_.erase(
-        std::remove_if(tasks_.begin(), tasks_.end(),
-            [](const ScheduledTask& task) { return task.cancelled; }),
-        tasks_.end()
-    );
+size_t TaskScheduler::task_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
 }
 
-} // namespace hap::common
+std::optional<uint64_t> TaskScheduler::next_deadline_ms() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drop_stale_deadlines();
+    if (heap_.empty()) {
+        return std::nullopt;
+    }
+    return heap_.front().run_at_ms;
+}
 
+void TaskScheduler::drop_stale_deadlines() {
+    while (!heap_.empty() && !tasks_.count(heap_.front().id)) {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<>{});
+        heap_.pop_back();
+    }
+}
+
+} // namespace hap::common
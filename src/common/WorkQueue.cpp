@@ -0,0 +1,73 @@
+#include "hap/common/WorkQueue.hpp"
+#include <cstddef>
+
+namespace hap::common {
+
+static size_t round_up_pow2(size_t value) {
+    size_t result = 2;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+WorkQueue::WorkQueue(size_t capacity) {
+    size_t size = round_up_pow2(capacity);
+    slots_ = std::make_unique<Slot[]>(size);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool WorkQueue::try_push(Task&& task) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            // Slot is free for this position; claim it
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            return false;  // Full: consumer has not released this slot yet
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->task = std::move(task);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool WorkQueue::try_pop(Task& out) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = &slots_[pos & mask_];
+    if (slot->sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false;  // Empty, or producer still writing this slot
+    }
+
+    out = std::move(slot->task);
+    slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t WorkQueue::drain() {
+    // Bound the pass so producers cannot keep the consumer here forever
+    size_t limit = enqueue_pos_.load(std::memory_order_acquire) - dequeue_pos_.load(std::memory_order_relaxed);
+    size_t executed = 0;
+    Task task;
+    while (executed < limit && try_pop(task)) {
+        task();
+        task.reset();
+        ++executed;
+    }
+    return executed;
+}
+
+bool WorkQueue::empty() const {
+    return enqueue_pos_.load(std::memory_order_acquire) == dequeue_pos_.load(std::memory_order_acquire);
+}
+
+} // namespace hap::common
@@ -0,0 +1,73 @@
+#include "hap/common/WorkerPool.hpp"
+
+#ifdef ESP_PLATFORM
+#include <esp_pthread.h>
+#endif
+
+namespace hap::common {
+
+WorkerPool::WorkerPool(size_t threads)
+    : WorkerPool(Options{.threads = threads}) {}
+
+WorkerPool::WorkerPool(const Options& options) {
+    size_t threads = options.threads ? options.threads : 1;
+    workers_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+#ifdef ESP_PLATFORM
+    // std::thread takes its task settings from the creating thread's
+    // esp_pthread config; set it for the workers and put it back after
+    esp_pthread_cfg_t previous;
+    bool had_previous = esp_pthread_get_cfg(&previous) == ESP_OK;
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    if (options.core >= 0) cfg.pin_to_core = options.core;
+    if (options.stack_bytes) cfg.stack_size = options.stack_bytes;
+    if (options.priority > 0) cfg.prio = static_cast<size_t>(options.priority);
+    cfg.thread_name = options.name;
+    esp_pthread_set_cfg(&cfg);
+#endif
+    for (auto& worker : workers_) {
+        worker->thread = std::thread(run, std::ref(*worker));
+    }
+#ifdef ESP_PLATFORM
+    if (!had_previous) previous = esp_pthread_get_default_config();
+    esp_pthread_set_cfg(&previous);
+#endif
+}
+
+WorkerPool::~WorkerPool() {
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->stopping = true;
+        worker->wake.notify_one();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+void WorkerPool::post(uint32_t strand, Task task) {
+    auto& worker = *workers_[strand % workers_.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    worker.wake.notify_one();
+}
+
+void WorkerPool::run(Worker& worker) {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.wake.wait(lock, [&] { return worker.stopping || !worker.tasks.empty(); });
+            if (worker.tasks.empty()) return;  // Stopping and fully drained
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace hap::common
@@ -0,0 +1,40 @@
+#include "hap/core/AttributeArena.hpp"
+
+namespace hap::core {
+
+namespace {
+thread_local AttributeArena* tls_current = nullptr;
+} // namespace
+
+std::shared_ptr<AttributeArena> AttributeArena::create(size_t block_bytes) {
+    return std::shared_ptr<AttributeArena>(new AttributeArena(block_bytes));
+}
+
+AttributeArena::AttributeArena(size_t block_bytes)
+    : resource_(block_bytes) {}
+
+void* AttributeArena::allocate(size_t bytes, size_t alignment) {
+    std::lock_guard lock(mutex_);
+    bytes_used_ += bytes;
+    return resource_.allocate(bytes, alignment);
+}
+
+size_t AttributeArena::bytes_used() const {
+    std::lock_guard lock(mutex_);
+    return bytes_used_;
+}
+
+AttributeArena::Scope::Scope(AttributeArena& arena)
+    : previous_(tls_current) {
+    tls_current = &arena;
+}
+
+AttributeArena::Scope::~Scope() {
+    tls_current = previous_;
+}
+
+AttributeArena* AttributeArena::current() {
+    return tls_current;
+}
+
+} // namespace hap::core
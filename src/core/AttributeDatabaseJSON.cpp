@@ -4,25 +4,53 @@
 #include "hap/core/Accessory.hpp"
 #include "hap/core/HAPStatus.hpp"
 #include <nlohmann/json.hpp>
-#include <sstream>
 
 namespace hap::core {
 
 using json = nlohmann::json;
 
+// Stands in for "value" while rendering the cached structure template.
+// Escaped by dump() as \u0001, which never occurs in rendered metadata.
+static const char* const kValuePlaceholder = "\x01";
+static const std::string kValuePlaceholderJSON = ",\"value\":\"\\u0001\"";
+
 // Forward declarations
-json to_json(const Characteristic& c);
-json to_json(const Service& s);
-json to_json(const Accessory& a);
+json to_json(const Characteristic& c, bool value_placeholder = false);
+json to_json(const Service& s, bool value_placeholder = false);
+json to_json(const Accessory& a, bool value_placeholder = false);
+
+/**
+ * @brief Read a characteristic and store its JSON value in out.
+ * Leaves out untouched (null) if the read fails.
+ */
+static void read_value_json(const Characteristic& c, json& out) {
+    Value scratch;
+    auto read_result = c.read_value(scratch);
+    // Only include value if read succeeded
+    if (std::holds_alternative<const Value*>(read_result)) {
+        const Value& value = *std::get<const Value*>(read_result);
+        std::visit([&out](auto&& arg) {
+            using T = std::decay_t<decltype(arg)>;
+            if constexpr (std::is_same_v<T, bool>) {
+                out = arg;
+            } else if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || 
+                                 std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t> || 
+                                 std::is_same_v<T, int32_t> || std::is_same_v<T, float>) {
+                out = arg;
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                out = arg;
+            } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
+                out = base64_encode(arg);
+            }
+        }, value);
+    }
+}
 
-json to_json(const Characteristic& c) {
+json to_json(const Characteristic& c, bool value_placeholder) {
     json j;
     
-    // Type (hex string)
-    // Format type as uppercase hex string (e.g., "25" not "0x25")
-    std::ostringstream oss;
-    oss << std::uppercase << std::hex << c.type();
-    j["type"] = oss.str();
+    // Type as uppercase hex (e.g., "25" not "0x25"), interned at construction
+    j["type"] = c.type_string();
     
     // IID  
     j["iid"] = c.iid();
@@ -30,53 +58,25 @@ json to_json(const Characteristic& c) {
     // Permissions
     json perms = json::array();
     for (const auto& perm : c.permissions()) {
-        switch (perm) {
-            case Permission::PairedRead: perms.push_back("pr"); break;
-            case Permission::PairedWrite: perms.push_back("pw"); break;
-            case Permission::Notify: perms.push_back("ev"); break;
-            case Permission::AdditionalAuthorization: perms.push_back("aa"); break;
-            case Permission::TimedWrite: perms.push_back("tw"); break;
-            case Permission::Hidden: perms.push_back("hd"); break;
-            case Permission::WriteResponse: perms.push_back("wr"); break;
-            case Permission::Broadcast: break; // BLE-only property, not in HAP JSON spec
+        auto name = permission_name(perm);
+        if (!name.empty()) {  // Broadcast is BLE-only, not in HAP JSON spec
+            perms.push_back(name);
         }
     }
     j["perms"] = perms;
     
     // Format
-    switch (c.format()) {
-        case Format::Bool: j["format"] = "bool"; break;
-        case Format::UInt8: j["format"] = "uint8"; break;
-        case Format::UInt16: j["format"] = "uint16"; break;
-        case Format::UInt32: j["format"] = "uint32"; break;
-        case Format::UInt64: j["format"] = "uint64"; break;
-        case Format::Int: j["format"] = "int"; break;
-        case Format::Float: j["format"] = "float"; break;
-        case Format::String: j["format"] = "string"; break;
-        case Format::TLV8: j["format"] = "tlv8"; break;
-        case Format::Data: j["format"] = "data"; break;
-    }
+    j["format"] = format_name(c.format());
 
     // Value
-    if (has_permission(c.permissions(), Permission::PairedRead)) {
-        auto read_result = c.get_value();
-        // Only include value if read succeeded
-        if (std::holds_alternative<Value>(read_result)) {
-            auto value = std::get<Value>(read_result);
-            std::visit([&j](auto&& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, bool>) {
-                    j["value"] = arg;
-                } else if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> || 
-                                     std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t> || 
-                                     std::is_same_v<T, int32_t> || std::is_same_v<T, float>) {
-                    j["value"] = arg;
-                } else if constexpr (std::is_same_v<T, std::string>) {
-                    j["value"] = arg;
-                } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
-                    j["value"] = base64_encode(arg);
-                }
-            }, value);
+    if (c.has_permission(Permission::PairedRead)) {
+        if (value_placeholder) {
+            j["value"] = kValuePlaceholder;
+        } else {
+            read_value_json(c, j["value"]);
+            if (j["value"].is_null()) {
+                j.erase("value");
+            }
         }
     }
     
@@ -112,14 +112,11 @@ json to_json(const Characteristic& c) {
     return j;
 }
 
-json to_json(const Service& s) {
+json to_json(const Service& s, bool value_placeholder) {
     json j;
     
-    // Type (hex string)
-    // Format type as uppercase hex string (e.g., "3E" not "0x3E")
-    std::ostringstream oss;
-    oss << std::uppercase << std::hex << s.type();
-    j["type"] = oss.str();
+    // Type as uppercase hex (e.g., "3E" not "0x3E"), interned at construction
+    j["type"] = s.type_string();
     
     // IID
     j["iid"] = s.iid();
@@ -127,7 +124,7 @@ json to_json(const Service& s) {
     // Characteristics
     json chars = json::array();
     for (const auto& c : s.characteristics()) {
-        chars.push_back(to_json(*c));
+        chars.push_back(to_json(*c, value_placeholder));
     }
     j["characteristics"] = chars;
     
@@ -147,7 +144,7 @@ json to_json(const Service& s) {
     return j;
 }
 
-json to_json(const Accessory& a) {
+json to_json(const Accessory& a, bool value_placeholder) {
     json j;
     
     // AID
@@ -156,7 +153,7 @@ json to_json(const Accessory& a) {
     // Services
     json services = json::array();
     for (const auto& s : a.services()) {
-        services.push_back(to_json(*s));
+        services.push_back(to_json(*s, value_placeholder));
     }
     j["services"] = services;
     
@@ -175,4 +172,61 @@ std::string AttributeDatabase::to_json_string() const {
     return j.dump();
 }
 
+void AttributeDatabase::build_json_cache() const {
+    json j;
+    json accessories = json::array();
+
+    for (const auto& acc : accessories_) {
+        accessories.push_back(to_json(*acc, true));
+    }
+
+    j["accessories"] = accessories;
+    std::string rendered = j.dump();
+
+    // Readable characteristics appear in document order, and "value" sorts
+    // last among characteristic keys, so each placeholder maps to the next
+    // readable characteristic in tree order.
+    json_cache_.segments.clear();
+    json_cache_.value_slots.clear();
+    for (const auto& acc : accessories_) {
+        for (const auto& svc : acc->services()) {
+            for (const auto& ch : svc->characteristics()) {
+                if (ch->has_permission(Permission::PairedRead)) {
+                    json_cache_.value_slots.push_back(ch.get());
+                }
+            }
+        }
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < json_cache_.value_slots.size(); ++i) {
+        size_t next = rendered.find(kValuePlaceholderJSON, pos);
+        json_cache_.segments.push_back(rendered.substr(pos, next - pos));
+        pos = next + kValuePlaceholderJSON.size();
+    }
+    json_cache_.segments.push_back(rendered.substr(pos));
+    json_cache_.valid = true;
+}
+
+std::string AttributeDatabase::to_cached_json_string() const {
+    if (!json_cache_.valid) {
+        build_json_cache();
+    }
+
+    std::string out;
+    out.reserve(json_cache_.last_size);
+    out += json_cache_.segments[0];
+    for (size_t i = 0; i < json_cache_.value_slots.size(); ++i) {
+        json value;
+        read_value_json(*json_cache_.value_slots[i], value);
+        if (!value.is_null()) {
+            out += ",\"value\":";
+            out += value.dump();
+        }
+        out += json_cache_.segments[i + 1];
+    }
+    json_cache_.last_size = out.size();
+    return out;
+}
+
 } // namespace hap::core
@@ -1,79 +1,75 @@
 #include "hap/core/CharacteristicFinder.hpp"
+#include <algorithm>
 
 namespace hap::core {
 
 CharacteristicFinder::CharacteristicFinder(const AttributeDatabase& database)
-    : database_(database) {}
+    : database_(database) {
+    rebuild();
+}
+
+void CharacteristicFinder::rebuild() {
+    characteristics_.clear();
+    services_.clear();
 
-std::shared_ptr<Characteristic> CharacteristicFinder::by_iid(uint16_t iid) const {
     for (const auto& accessory : database_.accessories()) {
         for (const auto& service : accessory->services()) {
+            services_.push_back({static_cast<uint16_t>(service->iid()), service});
             for (const auto& characteristic : service->characteristics()) {
-                if (characteristic->iid() == iid) {
-                    return characteristic;
-                }
+                characteristics_.push_back({static_cast<uint16_t>(characteristic->iid()),
+                                            {characteristic, service, accessory->aid()}});
             }
         }
     }
-    return nullptr;
+
+    // Stable sort keeps tree order for duplicate IIDs (bridged accessories),
+    // so lower_bound returns the same match the old tree walk did.
+    std::stable_sort(characteristics_.begin(), characteristics_.end(),
+        [](const CharacteristicEntry& a, const CharacteristicEntry& b) { return a.iid < b.iid; });
+    std::stable_sort(services_.begin(), services_.end(),
+        [](const ServiceEntry& a, const ServiceEntry& b) { return a.iid < b.iid; });
 }
 
-std::shared_ptr<Characteristic> CharacteristicFinder::by_aid_iid(uint64_t aid, uint64_t iid) const {
-    for (const auto& accessory : database_.accessories()) {
-        if (accessory->aid() != aid) continue;
-        
-        for (const auto& service : accessory->services()) {
-            for (const auto& characteristic : service->characteristics()) {
-                if (characteristic->iid() == iid) {
-                    return characteristic;
-                }
-            }
-        }
+const CharacteristicFinder::CharacteristicEntry* CharacteristicFinder::find_entry(uint16_t iid) const {
+    auto it = std::lower_bound(characteristics_.begin(), characteristics_.end(), iid,
+        [](const CharacteristicEntry& entry, uint16_t key) { return entry.iid < key; });
+    if (it == characteristics_.end() || it->iid != iid) {
+        return nullptr;
     }
-    return nullptr;
+    return &*it;
+}
+
+std::shared_ptr<Characteristic> CharacteristicFinder::by_iid(uint16_t iid) const {
+    const CharacteristicEntry* entry = find_entry(iid);
+    return entry ? entry->info.characteristic : nullptr;
+}
+
+std::shared_ptr<Characteristic> CharacteristicFinder::by_aid_iid(uint64_t aid, uint64_t iid) const {
+    return database_.find_characteristic(aid, iid);
 }
 
 std::shared_ptr<Service> CharacteristicFinder::service_by_iid(uint16_t iid) const {
-    for (const auto& accessory : database_.accessories()) {
-        for (const auto& service : accessory->services()) {
-            if (service->iid() == iid) {
-                return service;
-            }
-        }
+    auto it = std::lower_bound(services_.begin(), services_.end(), iid,
+        [](const ServiceEntry& entry, uint16_t key) { return entry.iid < key; });
+    if (it == services_.end() || it->iid != iid) {
+        return nullptr;
     }
-    return nullptr;
+    return it->service;
 }
 
 std::shared_ptr<Service> CharacteristicFinder::service_containing(uint16_t char_iid) const {
-    for (const auto& accessory : database_.accessories()) {
-        for (const auto& service : accessory->services()) {
-            for (const auto& characteristic : service->characteristics()) {
-                if (characteristic->iid() == char_iid) {
-                    return service;
-                }
-            }
-        }
-    }
-    return nullptr;
+    const CharacteristicEntry* entry = find_entry(char_iid);
+    return entry ? entry->info.service : nullptr;
 }
 
 CharacteristicFinder::CharacteristicInfo CharacteristicFinder::find_info(uint16_t iid) const {
-    CharacteristicInfo info;
-    
-    for (const auto& accessory : database_.accessories()) {
-        for (const auto& service : accessory->services()) {
-            for (const auto& characteristic : service->characteristics()) {
-                if (characteristic->iid() == iid) {
-                    info.characteristic = characteristic;
-                    info.service = service;
-                    info.accessory_id = accessory->aid();
-                    return info;
-                }
-            }
-        }
-    }
-    
-    return info;
+    const CharacteristicEntry* entry = find_entry(iid);
+    return entry ? entry->info : CharacteristicInfo{};
+}
+
+const CharacteristicFinder::CharacteristicInfo* CharacteristicFinder::lookup(uint16_t iid) const {
+    const CharacteristicEntry* entry = find_entry(iid);
+    return entry ? &entry->info : nullptr;
 }
 
 } // namespace hap::core
@@ -1,13 +1,60 @@
 #include "hap/core/IIDManager.hpp"
-#include <sstream>
+#include "hap/common/Log.hpp"
+#include <charconv>
+#include <cstdio>
 
 namespace hap::core {
 
 // Storage keys
-static constexpr const char* kIIDMapKey = "iid_map";
-static constexpr const char* kIIDNextKey = "iid_next";
+static constexpr const char* kIIDSnapshotKey = "iid_snapshot";
+static constexpr const char* kIIDJournalKey = "iid_journal";
 static constexpr const char* kDBHashKey = "db_hash";
 
+// Text-format keys written by earlier releases, migrated on first save
+static constexpr const char* kLegacyIIDMapKey = "iid_map";
+static constexpr const char* kLegacyIIDNextKey = "iid_next";
+
+// Snapshot and journal share a header: [version][next_iid:u16 LE]
+// followed by records: [kind][type:u16][svc_type:u16][iid:u16][aid:varint]
+static constexpr uint8_t kFormatVersion = 1;
+static constexpr size_t kHeaderSize = 3;
+static constexpr size_t kRecordFixedSize = 7;
+
+namespace {
+
+uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8);
+}
+
+void write_u16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value & 0xFF));
+    out.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+}
+
+std::string format_key(const IIDManager::Key& key) {
+    using Kind = IIDManager::Key::Kind;
+    char buf[48];
+    switch (key.kind) {
+        case Kind::Service:
+            std::snprintf(buf, sizeof(buf), "S:%04X:%llu", key.type,
+                          static_cast<unsigned long long>(key.aid));
+            break;
+        case Kind::Characteristic:
+            std::snprintf(buf, sizeof(buf), "C:%04X:%04X:%llu", key.type, key.service_type,
+                          static_cast<unsigned long long>(key.aid));
+            break;
+        case Kind::BleService:
+            std::snprintf(buf, sizeof(buf), "BLE:S:%04X", key.type);
+            break;
+        case Kind::BleCharacteristic:
+            std::snprintf(buf, sizeof(buf), "BLE:C:%04X:%04X", key.type, key.service_type);
+            break;
+    }
+    return buf;
+}
+
+} // namespace
+
 IIDManager::IIDManager(platform::Storage* storage, platform::System* system)
     : storage_(storage), system_(system) {
     load();
@@ -16,66 +63,235 @@ IIDManager::IIDManager(platform::Storage* storage, platform::System* system)
 void IIDManager::load() {
     if (!storage_) return;
     
-    // Load next_iid
-    auto next_data = storage_->get(kIIDNextKey);
-    if (next_data && next_data->size() >= 2) {
-        next_iid_ = static_cast<uint16_t>((*next_data)[0]) | 
-                   (static_cast<uint16_t>((*next_data)[1]) << 8);
-        if (next_iid_ == 0) next_iid_ = 1;  // Ensure minimum of 1
-    }
-    
-    // Load IID map (simple key=value format, one per line)
-    auto map_data = storage_->get(kIIDMapKey);
-    if (map_data && !map_data->empty()) {
-        std::string data_str(map_data->begin(), map_data->end());
-        std::istringstream iss(data_str);
-        std::string line;
-        while (std::getline(iss, line)) {
-            auto sep = line.find('=');
-            if (sep != std::string::npos) {
-                std::string key = line.substr(0, sep);
-                uint16_t iid = static_cast<uint16_t>(std::stoi(line.substr(sep + 1)));
-                iid_map_[key] = iid;
-            }
+    auto snapshot = storage_->get(kIIDSnapshotKey);
+    if (snapshot) {
+        load_records(*snapshot);
+    }
+    
+    // Journal records are newer than the snapshot; a journal that was
+    // already folded into the snapshot just repeats identical entries
+    auto journal = storage_->get(kIIDJournalKey);
+    if (journal) {
+        size_t consumed = 0;
+        journal_records_ = load_records(*journal, &consumed);
+        
+        // Keep the valid prefix so later appends never follow a torn record
+        journal->resize(consumed);
+        journal_ = std::move(*journal);
+    }
+    
+    if (!snapshot && !journal) {
+        auto map_data = storage_->get(kLegacyIIDMapKey);
+        if (map_data && !map_data->empty()) {
+            load_legacy(std::string_view(reinterpret_cast<const char*>(map_data->data()), map_data->size()));
+            migrate_legacy_ = true;
+            dirty_ = true;
+        }
+        
+        auto next_data = storage_->get(kLegacyIIDNextKey);
+        if (next_data && next_data->size() >= 2) {
+            next_iid_ = read_u16(next_data->data());
+            if (next_iid_ == 0) next_iid_ = 1;
+            migrate_legacy_ = true;
+            dirty_ = true;
         }
     }
     
     if (system_) {
-        system_->log(platform::System::LogLevel::Debug, 
+        HAP_LOG_DEBUG(system_,
             "[IIDManager] Loaded " + std::to_string(iid_map_.size()) + 
-            " entries, next_iid=" + std::to_string(next_iid_));
+            " entries (" + std::to_string(journal_records_) + " journaled), next_iid=" +
+            std::to_string(next_iid_));
+    }
+}
+
+size_t IIDManager::load_records(std::span<const uint8_t> data, size_t* consumed) {
+    if (consumed) *consumed = 0;
+    if (data.size() < kHeaderSize || data[0] != kFormatVersion) return 0;
+    
+    // A journal left behind by an interrupted compact() carries an older
+    // next_iid than the snapshot, so never move the counter backwards
+    uint16_t next = read_u16(&data[1]);
+    if (next > next_iid_) next_iid_ = next;
+    
+    size_t count = 0;
+    size_t pos = kHeaderSize;
+    while (pos + kRecordFixedSize < data.size()) {
+        const uint8_t* p = &data[pos];
+        uint8_t kind = p[0];
+        if (kind < static_cast<uint8_t>(Key::Kind::Service) ||
+            kind > static_cast<uint8_t>(Key::Kind::BleCharacteristic)) {
+            break;
+        }
+        
+        Key key;
+        key.kind = static_cast<Key::Kind>(kind);
+        key.type = read_u16(p + 1);
+        key.service_type = read_u16(p + 3);
+        uint16_t iid = read_u16(p + 5);
+        pos += kRecordFixedSize;
+        
+        // LEB128 AID
+        uint64_t aid = 0;
+        unsigned shift = 0;
+        bool complete = false;
+        while (pos < data.size() && shift < 64) {
+            uint8_t byte = data[pos++];
+            aid |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) {
+                complete = true;
+                break;
+            }
+        }
+        if (!complete) break;  // Truncated record
+        
+        key.aid = aid;
+        iid_map_[key] = iid;
+        ++count;
+        if (consumed) *consumed = pos;
+    }
+    if (consumed && count == 0) *consumed = kHeaderSize;
+    return count;
+}
+
+void IIDManager::load_legacy(std::string_view text) {
+    while (!text.empty()) {
+        auto eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text = eol == std::string_view::npos ? std::string_view{} : text.substr(eol + 1);
+        
+        auto sep = line.find('=');
+        if (sep == std::string_view::npos) continue;
+        
+        auto key = parse_legacy_key(line.substr(0, sep));
+        auto value = line.substr(sep + 1);
+        unsigned iid = 0;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), iid);
+        if (key && ec == std::errc() && iid > 0 && iid <= 0xFFFF) {
+            iid_map_[*key] = static_cast<uint16_t>(iid);
+        }
+    }
+}
+
+std::optional<IIDManager::Key> IIDManager::parse_legacy_key(std::string_view key) {
+    // Split on ':' (at most four fields: "BLE:C:<char>:<svc>")
+    std::string_view fields[4];
+    size_t count = 0;
+    while (count < 4) {
+        auto sep = key.find(':');
+        fields[count++] = key.substr(0, sep);
+        if (sep == std::string_view::npos) break;
+        key.remove_prefix(sep + 1);
+    }
+    
+    auto parse = [](std::string_view field, auto& out, int base) {
+        auto [ptr, ec] = std::from_chars(field.data(), field.data() + field.size(), out, base);
+        return ec == std::errc() && ptr == field.data() + field.size();
+    };
+    
+    Key result;
+    if (count == 3 && fields[0] == "S") {
+        result.kind = Key::Kind::Service;
+        if (parse(fields[1], result.type, 16) && parse(fields[2], result.aid, 10)) return result;
+    } else if (count == 4 && fields[0] == "C") {
+        result.kind = Key::Kind::Characteristic;
+        if (parse(fields[1], result.type, 16) && parse(fields[2], result.service_type, 16) &&
+            parse(fields[3], result.aid, 10)) return result;
+    } else if (count == 3 && fields[0] == "BLE" && fields[1] == "S") {
+        result.kind = Key::Kind::BleService;
+        if (parse(fields[2], result.type, 16)) return result;
+    } else if (count == 4 && fields[0] == "BLE" && fields[1] == "C") {
+        result.kind = Key::Kind::BleCharacteristic;
+        if (parse(fields[2], result.type, 16) && parse(fields[3], result.service_type, 16)) return result;
     }
+    return std::nullopt;
+}
+
+void IIDManager::write_header(std::vector<uint8_t>& out, uint16_t next_iid) {
+    out.push_back(kFormatVersion);
+    write_u16(out, next_iid);
+}
+
+void IIDManager::append_record(std::vector<uint8_t>& out, const Key& key, uint16_t iid) {
+    out.push_back(static_cast<uint8_t>(key.kind));
+    write_u16(out, key.type);
+    write_u16(out, key.service_type);
+    write_u16(out, iid);
+    
+    uint64_t aid = key.aid;
+    do {
+        uint8_t byte = aid & 0x7F;
+        aid >>= 7;
+        out.push_back(aid ? (byte | 0x80) : byte);
+    } while (aid);
 }
 
 void IIDManager::save() {
     if (!storage_ || !dirty_) return;
     
-    // Save next_iid (little-endian)
-    std::vector<uint8_t> next_data = {
-        static_cast<uint8_t>(next_iid_ & 0xFF),
-        static_cast<uint8_t>((next_iid_ >> 8) & 0xFF)
-    };
-    storage_->set(kIIDNextKey, next_data);
+    if (migrate_legacy_ || journal_records_ + pending_.size() >= kCompactThreshold) {
+        compact();
+        return;
+    }
     
-    // Save IID map (simple key=value format)
-    std::ostringstream oss;
+    // Append to the journal; next_iid lives in its header
+    if (journal_.size() < kHeaderSize) {
+        journal_.clear();
+        write_header(journal_, next_iid_);
+    } else {
+        journal_[1] = static_cast<uint8_t>(next_iid_ & 0xFF);
+        journal_[2] = static_cast<uint8_t>((next_iid_ >> 8) & 0xFF);
+    }
+    for (const auto& [key, iid] : pending_) {
+        append_record(journal_, key, iid);
+    }
+    storage_->set(kIIDJournalKey, journal_);
+    
+    journal_records_ += pending_.size();
+    pending_.clear();
+    dirty_ = false;
+    
+    if (system_) {
+        HAP_LOG_DEBUG(system_,
+            "[IIDManager] Journaled " + std::to_string(journal_records_) + 
+            " entries, next_iid=" + std::to_string(next_iid_));
+    }
+}
+
+void IIDManager::compact() {
+    if (!storage_) return;
+    
+    std::vector<uint8_t> snapshot;
+    snapshot.reserve(kHeaderSize + iid_map_.size() * (kRecordFixedSize + 2));
+    write_header(snapshot, next_iid_);
     for (const auto& [key, iid] : iid_map_) {
-        oss << key << "=" << iid << "\n";
+        append_record(snapshot, key, iid);
+    }
+    
+    // Snapshot first: if we stop before the journal is removed, its
+    // records simply duplicate entries already in the snapshot
+    storage_->set(kIIDSnapshotKey, snapshot);
+    storage_->remove(kIIDJournalKey);
+    if (migrate_legacy_) {
+        storage_->remove(kLegacyIIDMapKey);
+        storage_->remove(kLegacyIIDNextKey);
+        migrate_legacy_ = false;
     }
-    std::string map_str = oss.str();
-    std::vector<uint8_t> map_data(map_str.begin(), map_str.end());
-    storage_->set(kIIDMapKey, map_data);
     
+    journal_.clear();
+    journal_records_ = 0;
+    pending_.clear();
     dirty_ = false;
     
     if (system_) {
-        system_->log(platform::System::LogLevel::Debug, 
+        HAP_LOG_DEBUG(system_,
             "[IIDManager] Saved " + std::to_string(iid_map_.size()) + 
             " entries, next_iid=" + std::to_string(next_iid_));
     }
 }
 
-uint16_t IIDManager::get_or_assign(const std::string& key) {
+uint16_t IIDManager::get_or_assign(const Key& key) {
     auto it = iid_map_.find(key);
     if (it != iid_map_.end()) {
         return it->second;
@@ -90,11 +306,12 @@ uint16_t IIDManager::get_or_assign(const std::string& key) {
     }
     
     iid_map_[key] = iid;
+    pending_.emplace_back(key, iid);
     dirty_ = true;
     
     if (system_) {
-        system_->log(platform::System::LogLevel::Debug, 
-            "[IIDManager] Assigned IID=" + std::to_string(iid) + " for key=" + key);
+        HAP_LOG_DEBUG(system_,
+            "[IIDManager] Assigned IID=" + std::to_string(iid) + " for key=" + format_key(key));
     }
     
     return iid;
@@ -121,17 +338,23 @@ void IIDManager::update_stored_hash(const std::string& hash) {
 
 void IIDManager::reset() {
     iid_map_.clear();
+    pending_.clear();
+    journal_.clear();
+    journal_records_ = 0;
+    migrate_legacy_ = false;
     next_iid_ = 1;
     dirty_ = true;
     
     if (storage_) {
-        storage_->remove(kIIDMapKey);
-        storage_->remove(kIIDNextKey);
+        storage_->remove(kIIDSnapshotKey);
+        storage_->remove(kIIDJournalKey);
+        storage_->remove(kLegacyIIDMapKey);
+        storage_->remove(kLegacyIIDNextKey);
         storage_->remove(kDBHashKey);
     }
     
     if (system_) {
-        system_->log(platform::System::LogLevel::Info, 
+        HAP_LOG_INFO(system_,
             "[IIDManager] Reset - all IIDs cleared");
     }
 }
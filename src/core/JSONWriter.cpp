@@ -0,0 +1,155 @@
+#include "hap/core/JSONWriter.hpp"
+#include "hap/common/Base64.hpp"
+#include <charconv>
+#include <cmath>
+
+namespace hap::core {
+
+void JSONWriter::raw(std::string_view text) {
+    out_.insert(out_.end(), text.begin(), text.end());
+}
+
+void JSONWriter::separator() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    if (depth_ > 0) {
+        uint32_t bit = 1u << (depth_ - 1);
+        if (has_items_ & bit) {
+            out_.push_back(',');
+        }
+        has_items_ |= bit;
+    }
+}
+
+void JSONWriter::begin_object() {
+    separator();
+    out_.push_back('{');
+    if (depth_ < kMaxDepth) ++depth_;
+    has_items_ &= ~(1u << (depth_ - 1));
+}
+
+void JSONWriter::end_object() {
+    out_.push_back('}');
+    if (depth_ > 0) --depth_;
+}
+
+void JSONWriter::begin_array() {
+    separator();
+    out_.push_back('[');
+    if (depth_ < kMaxDepth) ++depth_;
+    has_items_ &= ~(1u << (depth_ - 1));
+}
+
+void JSONWriter::end_array() {
+    out_.push_back(']');
+    if (depth_ > 0) --depth_;
+}
+
+void JSONWriter::key(std::string_view name) {
+    value(name);
+    out_.push_back(':');
+    after_key_ = true;
+}
+
+void JSONWriter::value(bool v) {
+    separator();
+    raw(v ? "true" : "false");
+}
+
+void JSONWriter::value(int64_t v) {
+    separator();
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    raw(std::string_view(buf, res.ptr - buf));
+}
+
+void JSONWriter::value(uint64_t v) {
+    separator();
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    raw(std::string_view(buf, res.ptr - buf));
+}
+
+void JSONWriter::value(float v) {
+    if (!std::isfinite(v)) {
+        // JSON has no representation for NaN/Inf
+        null();
+        return;
+    }
+    separator();
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    raw(std::string_view(buf, res.ptr - buf));
+}
+
+void JSONWriter::value(double v) {
+    if (!std::isfinite(v)) {
+        null();
+        return;
+    }
+    separator();
+    char buf[32];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    raw(std::string_view(buf, res.ptr - buf));
+}
+
+void JSONWriter::value(std::string_view v) {
+    separator();
+    static const char* hex = "0123456789abcdef";
+    out_.push_back('"');
+    for (char c : v) {
+        unsigned char uc = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"': raw("\\\""); break;
+            case '\\': raw("\\\\"); break;
+            case '\b': raw("\\b"); break;
+            case '\f': raw("\\f"); break;
+            case '\n': raw("\\n"); break;
+            case '\r': raw("\\r"); break;
+            case '\t': raw("\\t"); break;
+            default:
+                if (uc < 0x20) {
+                    const char esc[] = {'\\', 'u', '0', '0', hex[uc >> 4], hex[uc & 0x0F]};
+                    raw(std::string_view(esc, sizeof(esc)));
+                } else {
+                    out_.push_back(uc);
+                }
+        }
+    }
+    out_.push_back('"');
+}
+
+void JSONWriter::raw_value(std::string_view json) {
+    separator();
+    raw(json);
+}
+
+void JSONWriter::null() {
+    separator();
+    raw("null");
+}
+
+void JSONWriter::value(const Value& v) {
+    std::visit([this](auto&& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
+            // Base64 needs no escaping: encode straight into the output
+            separator();
+            size_t start = out_.size();
+            out_.resize(start + common::base64_encoded_size(arg.size()) + 2);
+            out_[start] = '"';
+            common::base64_encode(arg, reinterpret_cast<char*>(out_.data() + start + 1));
+            out_.back() = '"';
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            value(std::string_view(arg));
+        } else if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t>) {
+            value(static_cast<uint64_t>(arg));
+        } else {
+            value(arg);
+        }
+    }, v);
+}
+
+} // namespace hap::core
@@ -1,4 +1,5 @@
 #include "hap/core/TLV8.hpp"
+#include <algorithm>
 
 namespace hap::core {
 
@@ -32,30 +33,17 @@ std::vector<TLV> TLV8::parse(std::span<const uint8_t> data) {
 }
 
 std::vector<uint8_t> TLV8::encode(const std::vector<TLV>& tlvs) {
+    size_t size = 0;
+    for (const auto& item : tlvs) {
+        size += TLV8Writer::encoded_size(item.value.size());
+    }
+    
     std::vector<uint8_t> buffer;
-
+    buffer.reserve(size);
+    TLV8Writer writer(buffer);
     for (const auto& item : tlvs) {
-        const auto& value = item.value;
-        size_t value_offset = 0;
-        size_t remaining = value.size();
-
-        if (remaining == 0) {
-            buffer.push_back(item.type);
-            buffer.push_back(0);
-        } else {
-            while (remaining > 0) {
-                uint8_t chunk_len = static_cast<uint8_t>(std::min<size_t>(remaining, 255));
-                
-                buffer.push_back(item.type);
-                buffer.push_back(chunk_len);
-                buffer.insert(buffer.end(), value.begin() + value_offset, value.begin() + value_offset + chunk_len);
-
-                value_offset += chunk_len;
-                remaining -= chunk_len;
-            }
-        }
+        writer.add(item.type, item.value);
     }
-
     return buffer;
 }
 
@@ -84,4 +72,97 @@ std::optional<uint8_t> TLV8::find_uint8(const std::vector<TLV>& tlvs, uint8_t ty
     return std::nullopt;
 }
 
+TLV8View::TLV8View(std::span<const uint8_t> data) {
+    // Drop everything from the first truncated record on
+    size_t offset = 0;
+    while (offset + 2 <= data.size() && offset + 2 + data[offset + 1] <= data.size()) {
+        offset += 2 + data[offset + 1];
+    }
+    data_ = data.first(offset);
+}
+
+size_t TLV8View::item_end(size_t offset) const {
+    if (offset >= data_.size()) {
+        return data_.size();
+    }
+    
+    const uint8_t type = data_[offset];
+    size_t length = data_[offset + 1];
+    size_t end = offset + 2 + length;
+    
+    // A full fragment followed by the same type continues the item
+    while (length == 255 && end < data_.size() && data_[end] == type) {
+        length = data_[end + 1];
+        end += 2 + length;
+    }
+    return end;
+}
+
+TLV8View::Item TLV8View::item_at(size_t offset, size_t end) const {
+    const uint8_t type = data_[offset];
+    const size_t first_length = data_[offset + 1];
+    if (offset + 2 + first_length == end) {
+        return {type, data_.subspan(offset + 2, first_length)};
+    }
+    
+    for (const auto& [start, value] : reassembled_) {
+        if (start == offset) {
+            return {type, value};
+        }
+    }
+    
+    std::vector<uint8_t> value;
+    value.reserve(end - offset);
+    for (size_t pos = offset; pos < end; pos += 2 + data_[pos + 1]) {
+        auto fragment = data_.subspan(pos + 2, data_[pos + 1]);
+        value.insert(value.end(), fragment.begin(), fragment.end());
+    }
+    reassembled_.emplace_back(offset, std::move(value));
+    return {type, reassembled_.back().second};
+}
+
+std::optional<std::span<const uint8_t>> TLV8View::find(uint8_t type) const {
+    for (size_t offset = 0; offset < data_.size();) {
+        size_t end = item_end(offset);
+        if (data_[offset] == type) {
+            return item_at(offset, end).value;
+        }
+        offset = end;
+    }
+    return std::nullopt;
+}
+
+std::optional<std::string_view> TLV8View::find_string(uint8_t type) const {
+    auto value = find(type);
+    if (value) {
+        return std::string_view(reinterpret_cast<const char*>(value->data()), value->size());
+    }
+    return std::nullopt;
+}
+
+std::optional<uint8_t> TLV8View::find_uint8(uint8_t type) const {
+    auto value = find(type);
+    if (value && value->size() == 1) {
+        return (*value)[0];
+    }
+    return std::nullopt;
+}
+
+TLV8Writer& TLV8Writer::add(uint8_t type, std::span<const uint8_t> value) {
+    if (value.empty()) {
+        out_.push_back(type);
+        out_.push_back(0);
+        return *this;
+    }
+    
+    while (!value.empty()) {
+        const size_t chunk = std::min<size_t>(value.size(), 255);
+        out_.push_back(type);
+        out_.push_back(static_cast<uint8_t>(chunk));
+        out_.insert(out_.end(), value.begin(), value.begin() + chunk);
+        value = value.subspan(chunk);
+    }
+    return *this;
+}
+
 } // namespace hap::core
@@ -0,0 +1,52 @@
+#include "hap/core/TypeString.hpp"
+#include "hap/core/Characteristic.hpp"
+#include <charconv>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace hap::core {
+
+namespace {
+
+// Node-based maps: views into the stored strings survive rehashing
+std::mutex intern_mutex;
+std::unordered_map<uint64_t, std::string> type_strings;
+std::unordered_map<uint16_t, std::string> perms_strings;
+
+} // namespace
+
+std::string_view intern_type_string(uint64_t type) {
+    std::lock_guard<std::mutex> lock(intern_mutex);
+    auto [it, inserted] = type_strings.try_emplace(type);
+    if (inserted) {
+        char buf[16];
+        auto res = std::to_chars(buf, buf + sizeof(buf), type, 16);
+        for (char* p = buf; p != res.ptr; ++p) {
+            if (*p >= 'a') *p = static_cast<char>(*p - 'a' + 'A');
+        }
+        it->second.assign(buf, res.ptr);
+    }
+    return it->second;
+}
+
+std::string_view intern_perms_json(uint16_t permission_bits) {
+    std::lock_guard<std::mutex> lock(intern_mutex);
+    auto [it, inserted] = perms_strings.try_emplace(permission_bits);
+    if (inserted) {
+        std::string& json = it->second;
+        json = "[";
+        for (auto permission : PermissionSet::from_bits(permission_bits)) {
+            auto name = permission_name(permission);
+            if (name.empty()) continue;  // Broadcast is BLE-only
+            if (json.size() > 1) json += ',';
+            json += '"';
+            json += name;
+            json += '"';
+        }
+        json += ']';
+    }
+    return it->second;
+}
+
+} // namespace hap::core
@@ -3,27 +3,43 @@
 
 namespace hap::pairing {
 
+namespace {
+
+// HKDF salt/info strings without the terminating NUL
+template<size_t N>
+std::span<const uint8_t> label(const char (&text)[N]) {
+    return std::span(reinterpret_cast<const uint8_t*>(text), N - 1);
+}
+
+// 4 zero bytes followed by the 8-byte message tag (e.g. "PR-Msg01")
+std::array<uint8_t, 12> make_nonce(const char (&tag)[9]) {
+    std::array<uint8_t, 12> nonce = {};
+    std::copy_n(tag, 8, nonce.begin() + 4);
+    return nonce;
+}
+
+} // namespace
+
 PairVerify::PairVerify(Config config) 
     : config_(std::move(config)), state_(State::M1_AwaitingVerifyStartRequest) {
-    load_long_term_keys();
 }
 
 PairVerify::~PairVerify() = default;
 
 void PairVerify::reset() {
     state_ = State::M1_AwaitingVerifyStartRequest;
+    resumed_ = false;
     p_session_key_ = {};
     shared_secret_ = {};
     controller_id_.clear();
 }
 
 void PairVerify::load_long_term_keys() {
-    auto ltsk_data = config_.storage->get("accessory_ltsk");
-    auto ltpk_data = config_.storage->get("accessory_ltpk");
-    
-    if (ltsk_data && ltpk_data && ltsk_data->size() == 64 && ltpk_data->size() == 32) {
-        std::copy_n(ltsk_data->begin(), 64, accessory_ltsk_.begin());
-        std::copy_n(ltpk_data->begin(), 32, accessory_ltpk_.begin());
+    keys_loaded_ = true;
+    auto keys = config_.pairing_store->long_term_keys();
+    if (keys) {
+        accessory_ltpk_ = keys->ltpk;
+        accessory_ltsk_ = keys->ltsk;
         keys_valid_ = true;
     } else {
         // Per HAP spec, keys must exist from Pair Setup.
@@ -33,9 +49,9 @@ void PairVerify::load_long_term_keys() {
 }
 
 std::optional<std::vector<uint8_t>> PairVerify::handle_request(std::span<const uint8_t> request_tlv) {
-    auto tlvs = core::TLV8::parse(request_tlv);
+    core::TLV8View tlvs(request_tlv);
     
-    auto state_val = core::TLV8::find_uint8(tlvs, static_cast<uint8_t>(TLVType::State));
+    auto state_val = tlvs.find_uint8(static_cast<uint8_t>(TLVType::State));
     if (!state_val) {
         return build_error_response(PairingState::M2, TLVError::Unknown);
     }
@@ -44,6 +60,14 @@ std::optional<std::vector<uint8_t>> PairVerify::handle_request(std::span<const u
     
     switch (requested_state) {
         case PairingState::M1:
+            if (config_.session_cache) {
+                auto method = tlvs.find_uint8(static_cast<uint8_t>(TLVType::Method));
+                if (method && *method == static_cast<uint8_t>(PairingMethod::PairResume)) {
+                    if (auto response = handle_resume(tlvs)) {
+                        return response;
+                    }
+                }
+            }
             return handle_m1(tlvs);
         case PairingState::M3:
             return handle_m3(tlvs);
@@ -52,17 +76,21 @@ std::optional<std::vector<uint8_t>> PairVerify::handle_request(std::span<const u
     }
 }
 
-std::optional<std::vector<uint8_t>> PairVerify::handle_m1(const std::vector<core::TLV>& request) {
+std::optional<std::vector<uint8_t>> PairVerify::handle_m1(const core::TLV8View& request) {
     if (state_ != State::M1_AwaitingVerifyStartRequest) {
         return build_error_response(PairingState::M2, TLVError::Unknown);
     }
     
+    if (!keys_loaded_) {
+        load_long_term_keys();
+    }
+    
     // Per HAP spec: If no valid long-term keys exist, the accessory is unpaired
     if (!keys_valid_) {
         return build_error_response(PairingState::M2, TLVError::Authentication);
     }
     
-    auto client_public_key = core::TLV8::find(request, static_cast<uint8_t>(TLVType::PublicKey));
+    auto client_public_key = request.find(static_cast<uint8_t>(TLVType::PublicKey));
     if (!client_public_key || client_public_key->size() != 32) {
         return build_error_response(PairingState::M2, TLVError::Unknown);
     }
@@ -80,6 +108,7 @@ std::optional<std::vector<uint8_t>> PairVerify::handle_m1(const std::vector<core
     );
     
     std::vector<uint8_t> accessory_info;
+    accessory_info.reserve(accessory_curve_public_.size() + config_.accessory_id.size() + client_curve_public_.size());
     accessory_info.insert(accessory_info.end(), accessory_curve_public_.begin(), accessory_curve_public_.end());
     accessory_info.insert(accessory_info.end(), config_.accessory_id.begin(), config_.accessory_id.end());
     accessory_info.insert(accessory_info.end(), client_curve_public_.begin(), client_curve_public_.end());
@@ -87,47 +116,52 @@ std::optional<std::vector<uint8_t>> PairVerify::handle_m1(const std::vector<core
     std::array<uint8_t, 64> accessory_signature;
     config_.crypto->ed25519_sign(accessory_ltsk_, accessory_info, accessory_signature);
     
-    std::vector<core::TLV> sub_tlvs;
-    sub_tlvs.emplace_back(static_cast<uint8_t>(TLVType::Identifier), config_.accessory_id);
-    sub_tlvs.emplace_back(static_cast<uint8_t>(TLVType::Signature), std::span(accessory_signature));
-    auto sub_tlv_data = core::TLV8::encode(sub_tlvs);
+    std::vector<uint8_t> sub_tlv_data;
+    sub_tlv_data.reserve(core::TLV8Writer::encoded_size(config_.accessory_id.size()) +
+                         core::TLV8Writer::encoded_size(accessory_signature.size()));
+    core::TLV8Writer(sub_tlv_data)
+        .add(static_cast<uint8_t>(TLVType::Identifier), config_.accessory_id)
+        .add(static_cast<uint8_t>(TLVType::Signature), accessory_signature);
     
     const char nonce_str[] = "\x00\x00\x00\x00PV-Msg02";
     std::array<uint8_t, 12> nonce = {};
     std::copy_n(nonce_str, sizeof(nonce_str) - 1, nonce.begin());
     
-    std::vector<uint8_t> ciphertext(sub_tlv_data.size());
-    std::array<uint8_t, 16> auth_tag;
+    // Ciphertext and tag are sealed straight into one buffer
+    std::vector<uint8_t> encrypted(sub_tlv_data.size() + 16);
+    auto ciphertext = std::span(encrypted).first(sub_tlv_data.size());
+    auto auth_tag = std::span(encrypted).last<16>();
     
     if (!config_.crypto->chacha20_poly1305_encrypt_and_tag(
             p_session_key_, nonce, {}, sub_tlv_data, ciphertext, auth_tag)) {
         return build_error_response(PairingState::M2, TLVError::Unknown);
     }
     
-    ciphertext.insert(ciphertext.end(), auth_tag.begin(), auth_tag.end());
-    
-    std::vector<core::TLV> response_tlvs;
-    response_tlvs.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M2));
-    response_tlvs.emplace_back(static_cast<uint8_t>(TLVType::PublicKey), std::span(accessory_curve_public_));
-    response_tlvs.emplace_back(static_cast<uint8_t>(TLVType::EncryptedData), ciphertext);
+    std::vector<uint8_t> response;
+    response.reserve(core::TLV8Writer::encoded_size(1) +
+                     core::TLV8Writer::encoded_size(accessory_curve_public_.size()) +
+                     core::TLV8Writer::encoded_size(encrypted.size()));
+    core::TLV8Writer(response)
+        .add(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M2))
+        .add(static_cast<uint8_t>(TLVType::PublicKey), accessory_curve_public_)
+        .add(static_cast<uint8_t>(TLVType::EncryptedData), encrypted);
     
     state_ = State::M3_AwaitingVerifyFinishRequest;
-    return core::TLV8::encode(response_tlvs);
+    return response;
 }
 
-std::optional<std::vector<uint8_t>> PairVerify::handle_m3(const std::vector<core::TLV>& request) {
+std::optional<std::vector<uint8_t>> PairVerify::handle_m3(const core::TLV8View& request) {
     if (state_ != State::M3_AwaitingVerifyFinishRequest) {
         return build_error_response(PairingState::M4, TLVError::Unknown);
     }
     
-    auto encrypted_data_tlv = core::TLV8::find(request, static_cast<uint8_t>(TLVType::EncryptedData));
+    auto encrypted_data_tlv = request.find(static_cast<uint8_t>(TLVType::EncryptedData));
     if (!encrypted_data_tlv || encrypted_data_tlv->size() < 16) {
         return build_error_response(PairingState::M4, TLVError::Authentication);
     }
     
-    std::vector<uint8_t> ciphertext(encrypted_data_tlv->begin(), encrypted_data_tlv->end() - 16);
-    std::array<uint8_t, 16> auth_tag;
-    std::copy_n(encrypted_data_tlv->end() - 16, 16, auth_tag.begin());
+    auto ciphertext = encrypted_data_tlv->first(encrypted_data_tlv->size() - 16);
+    auto auth_tag = encrypted_data_tlv->last<16>();
     
     const char nonce_str[] = "\x00\x00\x00\x00PV-Msg03";
     std::array<uint8_t, 12> nonce = {};
@@ -139,9 +173,9 @@ std::optional<std::vector<uint8_t>> PairVerify::handle_m3(const std::vector<core
         return build_error_response(PairingState::M4, TLVError::Authentication);
     }
     
-    auto sub_tlvs = core::TLV8::parse(plaintext);
-    auto ios_identifier = core::TLV8::find(sub_tlvs, static_cast<uint8_t>(TLVType::Identifier));
-    auto ios_signature = core::TLV8::find(sub_tlvs, static_cast<uint8_t>(TLVType::Signature));
+    core::TLV8View sub_tlvs(plaintext);
+    auto ios_identifier = sub_tlvs.find(static_cast<uint8_t>(TLVType::Identifier));
+    auto ios_signature = sub_tlvs.find(static_cast<uint8_t>(TLVType::Signature));
     
     if (!ios_identifier || !ios_signature || ios_signature->size() != 64) {
         return build_error_response(PairingState::M4, TLVError::Authentication);
@@ -149,32 +183,108 @@ std::optional<std::vector<uint8_t>> PairVerify::handle_m3(const std::vector<core
     
     controller_id_ = std::string(ios_identifier->begin(), ios_identifier->end());
 
-    std::string pairing_key = "pairing_" + std::string(ios_identifier->begin(), ios_identifier->end());
-    auto ios_ltpk_data = config_.storage->get(pairing_key);
-    if (!ios_ltpk_data || ios_ltpk_data->size() != 32) {
+    auto pairing = config_.pairing_store->find(controller_id_);
+    if (!pairing) {
         return build_error_response(PairingState::M4, TLVError::Authentication);
     }
-    
-    std::array<uint8_t, 32> ios_ltpk;
-    std::copy_n(ios_ltpk_data->begin(), 32, ios_ltpk.begin());
+    const auto& ios_ltpk = pairing->ltpk;
     
     std::vector<uint8_t> ios_device_info;
+    ios_device_info.reserve(client_curve_public_.size() + ios_identifier->size() + accessory_curve_public_.size());
     ios_device_info.insert(ios_device_info.end(), client_curve_public_.begin(), client_curve_public_.end());
     ios_device_info.insert(ios_device_info.end(), ios_identifier->begin(), ios_identifier->end());
     ios_device_info.insert(ios_device_info.end(), accessory_curve_public_.begin(), accessory_curve_public_.end());
     
-    std::array<uint8_t, 64> ios_sig_arr;
-    std::copy_n(ios_signature->begin(), 64, ios_sig_arr.begin());
-    
-    if (!config_.crypto->ed25519_verify(ios_ltpk, ios_device_info, ios_sig_arr)) {
+    if (!config_.crypto->ed25519_verify(ios_ltpk, ios_device_info, ios_signature->first<64>())) {
         return build_error_response(PairingState::M4, TLVError::Authentication);
     }
     
-    std::vector<core::TLV> response_tlvs;
-    response_tlvs.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M4));
+    std::vector<uint8_t> response;
+    core::TLV8Writer(response).add(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M4));
+    
+    state_ = State::Verified;
+
+    derive_control_keys();
+    cache_session();
+
+    return response;
+}
+
+std::optional<std::vector<uint8_t>> PairVerify::handle_resume(const core::TLV8View& request) {
+    if (state_ != State::M1_AwaitingVerifyStartRequest || !config_.system) {
+        return std::nullopt;
+    }
+    
+    auto client_public_key = request.find(static_cast<uint8_t>(TLVType::PublicKey));
+    auto session_id_tlv = request.find(static_cast<uint8_t>(TLVType::SessionID));
+    auto encrypted_data = request.find(static_cast<uint8_t>(TLVType::EncryptedData));
+    if (!client_public_key || client_public_key->size() != 32 ||
+        !session_id_tlv || session_id_tlv->size() != 8 ||
+        !encrypted_data || encrypted_data->size() != 16) {
+        return std::nullopt;
+    }
+    
+    // Entries are single-use, so a failed attempt also retires the ID
+    SessionCache::SessionId session_id;
+    std::copy_n(session_id_tlv->begin(), 8, session_id.begin());
+    auto cached = config_.session_cache->take(session_id);
+    if (!cached) {
+        return std::nullopt;
+    }
+    
+    // The pairing may have been removed through another transport
+    if (!config_.pairing_store->find(cached->controller_id)) {
+        return std::nullopt;
+    }
+    
+    // Salt: controller's ephemeral public key || session ID
+    std::array<uint8_t, 40> salt;
+    std::copy_n(client_public_key->begin(), 32, salt.begin());
+    std::copy_n(session_id.begin(), 8, salt.begin() + 32);
+    
+    std::array<uint8_t, 32> request_key;
+    config_.crypto->hkdf_sha512(cached->shared_secret, salt, label("Pair-Resume-Request-Info"), request_key);
+    
+    if (!config_.crypto->chacha20_poly1305_decrypt_and_verify(
+            request_key, make_nonce("PR-Msg01"), {}, {}, encrypted_data->first<16>(), {})) {
+        return build_error_response(PairingState::M2, TLVError::Authentication);
+    }
+    
+    // New session ID; it salts the response key and the new shared secret
+    SessionCache::SessionId new_session_id;
+    config_.system->random_bytes(new_session_id);
+    std::copy_n(new_session_id.begin(), 8, salt.begin() + 32);
+    
+    std::array<uint8_t, 32> response_key;
+    config_.crypto->hkdf_sha512(cached->shared_secret, salt, label("Pair-Resume-Response-Info"), response_key);
+    
+    std::array<uint8_t, 16> response_tag;
+    if (!config_.crypto->chacha20_poly1305_encrypt_and_tag(
+            response_key, make_nonce("PR-Msg02"), {}, {}, {}, response_tag)) {
+        return build_error_response(PairingState::M2, TLVError::Unknown);
+    }
+    
+    config_.crypto->hkdf_sha512(cached->shared_secret, salt, label("Pair-Resume-Shared-Secret-Info"), shared_secret_);
+    controller_id_ = std::move(cached->controller_id);
+    
+    std::vector<uint8_t> response;
+    response.reserve(core::TLV8Writer::encoded_size(1) + core::TLV8Writer::encoded_size(new_session_id.size()) +
+                     core::TLV8Writer::encoded_size(response_tag.size()));
+    core::TLV8Writer(response)
+        .add(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M2))
+        .add(static_cast<uint8_t>(TLVType::SessionID), new_session_id)
+        .add(static_cast<uint8_t>(TLVType::EncryptedData), response_tag);
     
     state_ = State::Verified;
+    resumed_ = true;
+    
+    derive_control_keys();
+    config_.session_cache->store(new_session_id, shared_secret_, controller_id_);
+    
+    return response;
+}
 
+void PairVerify::derive_control_keys() {
     config_.crypto->hkdf_sha512(
         shared_secret_,
         std::span(reinterpret_cast<const uint8_t*>("Control-Salt"), 12),
@@ -188,15 +298,28 @@ std::optional<std::vector<uint8_t>> PairVerify::handle_m3(const std::vector<core
         std::span(reinterpret_cast<const uint8_t*>("Control-Write-Encryption-Key"), 28),
         c_session_key_
     );
+}
 
-    return core::TLV8::encode(response_tlvs);
+void PairVerify::cache_session() {
+    if (!config_.session_cache) return;
+    
+    SessionCache::SessionId session_id;
+    config_.crypto->hkdf_sha512(
+        shared_secret_,
+        label("Pair-Verify-ResumeSessionID-Salt"),
+        label("Pair-Verify-ResumeSessionID-Info"),
+        session_id
+    );
+    config_.session_cache->store(session_id, shared_secret_, controller_id_);
 }
 
 std::vector<uint8_t> PairVerify::build_error_response(PairingState state, TLVError error) {
-    std::vector<core::TLV> tlvs;
-    tlvs.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(state));
-    tlvs.emplace_back(static_cast<uint8_t>(TLVType::Error), static_cast<uint8_t>(error));
-    return core::TLV8::encode(tlvs);
+    std::vector<uint8_t> response;
+    response.reserve(2 * core::TLV8Writer::encoded_size(1));
+    core::TLV8Writer(response)
+        .add(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(state))
+        .add(static_cast<uint8_t>(TLVType::Error), static_cast<uint8_t>(error));
+    return response;
 }
 
 } // namespace hap::pairing
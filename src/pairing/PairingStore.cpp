@@ -0,0 +1,197 @@
+#include "hap/pairing/PairingStore.hpp"
+#include <algorithm>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace hap::pairing {
+
+// Storage keys
+static constexpr const char* kLtskKey = "accessory_ltsk";
+static constexpr const char* kLtpkKey = "accessory_ltpk";
+static constexpr const char* kPairingsKey = "pairings";
+
+// Pre-binary format: JSON array of IDs plus one key per controller LTPK
+static constexpr const char* kLegacyListKey = "pairing_list";
+static constexpr const char* kLegacyPairingPrefix = "pairing_";
+
+// Record layout: [version][count] then per pairing [permissions][id_len][id][ltpk(32)]
+static constexpr uint8_t kFormatVersion = 1;
+static constexpr size_t kHeaderSize = 2;
+
+PairingStore::PairingStore(platform::Storage* storage) : storage_(storage) {
+    load();
+}
+
+void PairingStore::load() {
+    auto ltsk_data = storage_->get(kLtskKey);
+    auto ltpk_data = storage_->get(kLtpkKey);
+    if (ltsk_data && ltpk_data && ltsk_data->size() == 64 && ltpk_data->size() == 32) {
+        LongTermKeys keys;
+        std::copy_n(ltsk_data->begin(), 64, keys.ltsk.begin());
+        std::copy_n(ltpk_data->begin(), 32, keys.ltpk.begin());
+        keys_ = keys;
+    }
+
+    auto data = storage_->get(kPairingsKey);
+    if (data) {
+        decode(*data);
+    } else if (load_legacy()) {
+        save_list();
+        for (size_t i = 0; i < count_; ++i) {
+            storage_->remove(kLegacyPairingPrefix + std::string(pairings_[i].id()));
+        }
+        storage_->remove(kLegacyListKey);
+    }
+    paired_.store(count_ > 0, std::memory_order_release);
+}
+
+void PairingStore::decode(std::span<const uint8_t> data) {
+    if (data.size() < kHeaderSize || data[0] != kFormatVersion) return;
+    size_t count = std::min<size_t>(data[1], kMaxPairings);
+
+    // A truncated record ends the list; the pairings before it are kept
+    size_t pos = kHeaderSize;
+    while (count_ < count && pos + 2 <= data.size()) {
+        uint8_t permissions = data[pos];
+        uint8_t id_length = data[pos + 1];
+        if (id_length == 0 || id_length > kMaxIdLength || pos + 2 + id_length + 32 > data.size()) break;
+        pos += 2;
+
+        Pairing& pairing = pairings_[count_++];
+        pairing.permissions = permissions;
+        pairing.id_length = id_length;
+        std::copy_n(data.begin() + pos, id_length, pairing.id_bytes.begin());
+        pos += id_length;
+        std::copy_n(data.begin() + pos, 32, pairing.ltpk.begin());
+        pos += 32;
+    }
+}
+
+bool PairingStore::load_legacy() {
+    auto list_data = storage_->get(kLegacyListKey);
+    if (!list_data) return false;
+
+    auto list_json = nlohmann::json::parse(list_data->begin(), list_data->end(), nullptr, false);
+    if (list_json.is_discarded() || !list_json.is_array()) return false;
+
+    for (const auto& id_json : list_json) {
+        if (!id_json.is_string() || count_ == kMaxPairings) continue;
+        const auto& id = id_json.get_ref<const std::string&>();
+        if (id.empty() || id.size() > kMaxIdLength) continue;
+
+        auto ltpk_data = storage_->get(kLegacyPairingPrefix + id);
+        if (!ltpk_data || ltpk_data->size() != 32) continue;
+
+        Pairing& pairing = pairings_[count_++];
+        std::copy(id.begin(), id.end(), pairing.id_bytes.begin());
+        pairing.id_length = static_cast<uint8_t>(id.size());
+        std::copy_n(ltpk_data->begin(), 32, pairing.ltpk.begin());
+        pairing.permissions = kPermissionAdmin;  // The legacy format only stored admins
+    }
+    return true;
+}
+
+void PairingStore::save_list() {
+    std::vector<uint8_t> data;
+    data.reserve(kHeaderSize + count_ * (2 + kMaxIdLength + 32));
+    data.push_back(kFormatVersion);
+    data.push_back(static_cast<uint8_t>(count_));
+    for (size_t i = 0; i < count_; ++i) {
+        const Pairing& pairing = pairings_[i];
+        data.push_back(pairing.permissions);
+        data.push_back(pairing.id_length);
+        data.insert(data.end(), pairing.id_bytes.begin(), pairing.id_bytes.begin() + pairing.id_length);
+        data.insert(data.end(), pairing.ltpk.begin(), pairing.ltpk.end());
+    }
+    storage_->set(kPairingsKey, data);
+    paired_.store(count_ > 0, std::memory_order_release);
+}
+
+size_t PairingStore::index_of(std::string_view id) const {
+    for (size_t i = 0; i < count_; ++i) {
+        if (pairings_[i].id() == id) return i;
+    }
+    return count_;
+}
+
+std::optional<PairingStore::LongTermKeys> PairingStore::long_term_keys() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return keys_;
+}
+
+PairingStore::LongTermKeys PairingStore::ensure_long_term_keys(platform::Crypto& crypto) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!keys_) {
+        LongTermKeys keys;
+        crypto.ed25519_generate_keypair(keys.ltpk, keys.ltsk);
+        storage_->set(kLtpkKey, keys.ltpk);
+        storage_->set(kLtskKey, keys.ltsk);
+        keys_ = keys;
+    }
+    return *keys_;
+}
+
+std::optional<PairingStore::Pairing> PairingStore::find(std::string_view id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t index = index_of(id);
+    if (index == count_) return std::nullopt;
+    return pairings_[index];
+}
+
+PairingStore::AddResult PairingStore::add(std::string_view id, const std::array<uint8_t, 32>& ltpk, uint8_t permissions) {
+    if (id.empty() || id.size() > kMaxIdLength) {
+        return AddResult::InvalidId;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t index = index_of(id);
+    bool exists = index < count_;
+    if (!exists && count_ == kMaxPairings) {
+        return AddResult::Full;
+    }
+
+    Pairing& pairing = pairings_[index];
+    std::copy(id.begin(), id.end(), pairing.id_bytes.begin());
+    pairing.id_length = static_cast<uint8_t>(id.size());
+    pairing.ltpk = ltpk;
+    pairing.permissions = permissions;
+    if (!exists) ++count_;
+
+    save_list();
+    return exists ? AddResult::Updated : AddResult::Added;
+}
+
+bool PairingStore::remove(std::string_view id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t index = index_of(id);
+    if (index == count_) return false;
+
+    // Keep slots packed and in pairing order
+    std::move(pairings_.begin() + index + 1, pairings_.begin() + count_, pairings_.begin() + index);
+    pairings_[--count_] = {};
+    save_list();
+    return true;
+}
+
+std::vector<PairingStore::Pairing> PairingStore::list() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {pairings_.begin(), pairings_.begin() + count_};
+}
+
+size_t PairingStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+void PairingStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pairings_.fill({});
+    count_ = 0;
+    paired_.store(false, std::memory_order_release);
+    keys_.reset();
+    storage_->remove(kPairingsKey);
+    storage_->remove(kLtskKey);
+    storage_->remove(kLtpkKey);
+}
+
+} // namespace hap::pairing
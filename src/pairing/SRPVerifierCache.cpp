@@ -0,0 +1,54 @@
+#include "hap/pairing/SRPVerifierCache.hpp"
+#include <algorithm>
+
+namespace hap::pairing {
+
+static constexpr const char* kUsername = "Pair-Setup";
+// Earlier versions persisted the verifier here next to a fast hash of the
+// setup code, which made the code recoverable offline from flash
+static constexpr const char* kLegacyVerifierKey = "srp_verifier";
+
+SRPVerifierCache::SRPVerifierCache(platform::CryptoSRP* crypto, platform::Storage* storage, std::string setup_code)
+    : crypto_(crypto), setup_code_(std::move(setup_code)) {
+    if (storage && storage->has(kLegacyVerifierKey)) {
+        storage->remove(kLegacyVerifierKey);
+    }
+}
+
+std::unique_ptr<platform::SRPSession> SRPVerifierCache::new_session() {
+    if (verifier_) {
+        auto session = crypto_->srp_restore_verifier(kUsername, setup_code_, verifier_->salt, verifier_->verifier);
+        if (session) return session;
+    }
+
+    auto session = crypto_->srp_new_verifier(kUsername, setup_code_);
+    if (session && !verifier_) {
+        verifier_ = Verifier{session->salt, session->verifier};
+    }
+    return session;
+}
+
+void SRPVerifierCache::prepare() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (prepared_) return;
+
+    auto session = new_session();
+    if (!session) return;
+    session->server_public_key = crypto_->srp_get_public_key(session.get());
+    prepared_ = std::move(session);
+}
+
+bool SRPVerifierCache::ready() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return prepared_ != nullptr;
+}
+
+std::unique_ptr<platform::SRPSession> SRPVerifierCache::take_session() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (prepared_) {
+        return std::move(prepared_);
+    }
+    return new_session();
+}
+
+} // namespace hap::pairing
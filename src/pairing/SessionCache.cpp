@@ -0,0 +1,58 @@
+#include "hap/pairing/SessionCache.hpp"
+#include <algorithm>
+
+namespace hap::pairing {
+
+SessionCache::SessionCache(platform::System* system, size_t capacity, uint64_t ttl_ms)
+    : system_(system), capacity_(std::max<size_t>(capacity, 1)), ttl_ms_(ttl_ms) {
+    entries_.reserve(capacity_);
+}
+
+void SessionCache::store(const SessionId& id, const std::array<uint8_t, 32>& shared_secret, std::string controller_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t now = system_->millis();
+    drop_expired(now);
+
+    std::erase_if(entries_, [&id](const Entry& entry) { return entry.id == id; });
+    if (entries_.size() >= capacity_) {
+        entries_.erase(entries_.begin());
+    }
+    entries_.push_back({id, {shared_secret, std::move(controller_id)}, now + ttl_ms_});
+}
+
+std::optional<SessionCache::Session> SessionCache::take(const SessionId& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    drop_expired(system_->millis());
+
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+        [&id](const Entry& entry) { return entry.id == id; });
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    Session session = std::move(it->session);
+    entries_.erase(it);
+    return session;
+}
+
+void SessionCache::remove_controller(std::string_view controller_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::erase_if(entries_, [controller_id](const Entry& entry) {
+        return entry.session.controller_id == controller_id;
+    });
+}
+
+void SessionCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+size_t SessionCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+void SessionCache::drop_expired(uint64_t now) {
+    std::erase_if(entries_, [now](const Entry& entry) { return entry.expires_at_ms <= now; });
+}
+
+} // namespace hap::pairing
@@ -4,11 +4,11 @@ namespace hap::platform {
 
 Ble::Advertisement Ble::Advertisement::create_hap(
     uint8_t status_flags, 
-    uint8_t device_id[6], 
+    const uint8_t device_id[6], 
     uint16_t category_id, 
     uint16_t global_state_number,
     uint8_t config_number,
-    uint8_t pair_setup_hash[4]
+    const uint8_t pair_setup_hash[4]
 ) {
     Ble::Advertisement adv;
     adv.company_id = 0x004C;
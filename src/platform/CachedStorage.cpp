@@ -0,0 +1,144 @@
+#include "hap/platform/CachedStorage.hpp"
+#include <algorithm>
+
+namespace hap::platform {
+
+CachedStorage::CachedStorage(Storage* backend, common::TaskScheduler* scheduler, uint32_t flush_delay_ms)
+    : backend_(backend), scheduler_(scheduler), flush_delay_ms_(flush_delay_ms) {}
+
+CachedStorage::~CachedStorage() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (scheduler_ && flush_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        scheduler_->cancel(flush_task_);
+    }
+    flush_locked();
+}
+
+void CachedStorage::set(std::string_view key, std::span<const uint8_t> value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        it = entries_.emplace(std::string(key), std::nullopt).first;
+    } else if (it->second && it->second->size() == value.size() &&
+               std::equal(value.begin(), value.end(), it->second->begin())) {
+        return;  // Unchanged
+    }
+    it->second.emplace(value.begin(), value.end());
+    mark_dirty(key);
+}
+
+std::optional<std::vector<uint8_t>> CachedStorage::get(std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return load(key);
+}
+
+void CachedStorage::remove(std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && !it->second) {
+        return;  // Known to be absent
+    }
+    if (it == entries_.end()) {
+        entries_.emplace(std::string(key), std::nullopt);
+    } else {
+        it->second.reset();
+    }
+    mark_dirty(key);
+}
+
+bool CachedStorage::has(std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return load(key).has_value();
+}
+
+void CachedStorage::commit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (transaction_depth_ == 0) {
+        flush_locked();
+    }
+}
+
+bool CachedStorage::has_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !dirty_.empty();
+}
+
+void CachedStorage::set_write_through(std::string key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_through_.insert(std::move(key));
+}
+
+void CachedStorage::set_scheduler(common::TaskScheduler* scheduler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (scheduler_ && flush_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        scheduler_->cancel(flush_task_);
+        flush_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    scheduler_ = scheduler;
+    if (!dirty_.empty()) {
+        arm_flush();
+    }
+}
+
+void CachedStorage::begin_transaction() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++transaction_depth_;
+}
+
+void CachedStorage::end_transaction() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--transaction_depth_ == 0) {
+        flush_locked();
+    }
+}
+
+const std::optional<std::vector<uint8_t>>& CachedStorage::load(std::string_view key) {
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        it = entries_.emplace(std::string(key), backend_->get(key)).first;
+    }
+    return it->second;
+}
+
+void CachedStorage::mark_dirty(std::string_view key) {
+    if (dirty_.find(key) == dirty_.end()) {
+        dirty_.emplace(key);
+    }
+    if (transaction_depth_ == 0 && write_through_.contains(key)) {
+        flush_locked();
+        return;
+    }
+    arm_flush();
+}
+
+void CachedStorage::arm_flush() {
+    if (transaction_depth_ > 0 || !scheduler_ || flush_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        return;
+    }
+    flush_task_ = scheduler_->schedule_once(flush_delay_ms_, [this]() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_task_ = common::TaskScheduler::INVALID_TASK_ID;
+        if (transaction_depth_ == 0) {
+            flush_locked();
+        }
+    });
+}
+
+void CachedStorage::flush_locked() {
+    if (dirty_.empty()) {
+        return;
+    }
+    backend_->begin_batch();
+    for (const auto& key : dirty_) {
+        const auto& value = entries_.find(key)->second;
+        if (value) {
+            backend_->set(key, *value);
+        } else {
+            backend_->remove(key);
+        }
+    }
+    backend_->commit_batch();
+    dirty_.clear();
+}
+
+} // namespace hap::platform
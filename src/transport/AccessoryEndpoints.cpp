@@ -1,55 +1,484 @@
 #include "hap/transport/AccessoryEndpoints.hpp"
+#include "hap/common/Base64.hpp"
+#include "hap/transport/CharacteristicOps.hpp"
 #include "hap/core/HAPStatus.hpp"
-#include <sstream>
+#include "hap/core/JSONWriter.hpp"
+#include <algorithm>
+#include <charconv>
+#include <map>
+#include <mutex>
+#include <optional>
 
 using json = nlohmann::json;
 
 namespace hap::transport {
 
-static std::vector<uint8_t> base64_decode(const std::string& encoded) {
-    static constexpr unsigned char decode_table[] = {
-        64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-        64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
-        64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 62, 64, 64, 64, 63,
-        52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 64, 64, 64, 64, 64, 64,
-        64,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
-        15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 64, 64, 64, 64, 64,
-        64, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-        41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 64, 64, 64, 64, 64
-    };
+namespace {
+
+/**
+ * @brief Results of one request whose characteristic callbacks may complete
+ * after its handler returned.
+ *
+ * The handler holds one count while it starts operations. Whoever drops the
+ * count to zero renders the response: the handler itself when everything
+ * completed inline, otherwise the last completion, which passes it to the
+ * DeferredResponder.
+ */
+class AsyncBatch : public std::enable_shared_from_this<AsyncBatch> {
+public:
+    AsyncBatch(uint32_t connection_id, std::function<Response()> render)
+        : connection_id_(connection_id), render_(std::move(render)) {}
 
-    std::vector<uint8_t> result;
-    result.reserve(encoded.size() * 3 / 4);
+    /// Register a pending callback; `expire` fails it on timeout
+    void begin(std::function<void()> expire) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++outstanding_;
+        expire_.push_back(std::move(expire));
+    }
 
-    uint32_t buffer = 0;
-    int bits_collected = 0;
+    /// Record a callback's result; sends the response if it was the last one
+    template<typename Update>
+    void complete(Update&& update) {
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            update();
+            // Reaching zero here means the handler already returned deferred
+            last = --outstanding_ == 0;
+        }
+        if (!last) return;
+        if (scheduler_ && timeout_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+            scheduler_->cancel(timeout_task_);
+        }
+        responder_(connection_id_, render_());
+    }
 
-    for (char c : encoded) {
-        if (c == '=' || c == '\0') break;
-        if (static_cast<unsigned char>(c) >= 128) continue;
-        unsigned char d = decode_table[static_cast<unsigned char>(c)];
-        if (d == 64) continue;
+    /**
+     * @brief Called by the handler once every operation has started.
+     * @param detach Copies results that still point into the database,
+     *        run only if the response is deferred
+     * @return The response, or Response::deferred()
+     */
+    Response finish(const AccessoryEndpoints::DeferredResponder& responder,
+                    common::TaskScheduler* scheduler, uint32_t timeout_ms,
+                    const std::function<void()>& detach) {
+        if (!responder) {
+            // Nobody could send a late response; fail what is still pending
+            expire_all();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (outstanding_ > 1) {
+                detach();
+                responder_ = responder;
+                scheduler_ = scheduler;
+                --outstanding_;
+                if (scheduler_ && timeout_ms > 0) {
+                    std::weak_ptr<AsyncBatch> weak = weak_from_this();
+                    timeout_task_ = scheduler_->schedule_once(timeout_ms, [weak]() {
+                        if (auto batch = weak.lock()) batch->expire_all();
+                    });
+                }
+                return Response::deferred();
+            }
+            outstanding_ = 0;
+        }
+        return render_();
+    }
 
-        buffer = (buffer << 6) | d;
-        bits_collected += 6;
+private:
+    std::mutex mutex_;
+    uint32_t connection_id_;
+    std::function<Response()> render_;
+    size_t outstanding_ = 1;
+    std::vector<std::function<void()>> expire_;
+    AccessoryEndpoints::DeferredResponder responder_;
+    common::TaskScheduler* scheduler_ = nullptr;
+    common::TaskScheduler::TaskId timeout_task_ = common::TaskScheduler::INVALID_TASK_ID;
 
-        if (bits_collected >= 8) {
-            bits_collected -= 8;
-            result.push_back(static_cast<uint8_t>((buffer >> bits_collected) & 0xFF));
+    void expire_all() {
+        std::vector<std::function<void()>> expire;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            expire = expire_;
         }
+        // Completions that already ran ignore the failure
+        for (auto& fail : expire) fail();
     }
+};
 
-    return result;
+struct ReadResult {
+    uint64_t aid;
+    uint64_t iid;
+    int32_t status;
+    const core::Value* value;  // Stored value, or scratch
+    core::Value scratch;       // Holds read callback results
+    std::shared_ptr<const core::Characteristic> characteristic;  // Set when found
+    bool subscribed = false;
+};
+
+struct WriteResult {
+    uint64_t aid;
+    uint64_t iid;
+    int32_t status;
+    std::optional<core::Value> value;  // Write-response value, if any
+};
+
+constexpr int32_t kSuccess = static_cast<int32_t>(core::HAPStatus::Success);
+
+bool parse_flag(std::string_view value) {
+    return value == "1" || value == "true";
+}
+
+/// Validates "<aid>.<iid>,..." and counts the ids
+bool parse_ids(std::string_view ids, size_t& count) {
+    const char* p = ids.data();
+    const char* end = p + ids.size();
+    count = 0;
+    if (p == end) return false;
+    while (true) {
+        uint64_t aid = 0, iid = 0;
+        auto [after_aid, aid_ec] = std::from_chars(p, end, aid);
+        if (aid_ec != std::errc{} || after_aid == end || *after_aid != '.') return false;
+        auto [after_iid, iid_ec] = std::from_chars(after_aid + 1, end, iid);
+        if (iid_ec != std::errc{}) return false;
+        ++count;
+        if (after_iid == end) return true;
+        if (*after_iid != ',') return false;
+        p = after_iid + 1;
+    }
+}
+
+/// The metadata fields of /accessories (HAP Spec 6.7.4.1, meta=1)
+void write_metadata(core::JSONWriter& writer, const core::Characteristic& characteristic) {
+    writer.key("format");
+    writer.value(core::format_name(characteristic.format()));
+    if (characteristic.unit()) {
+        writer.key("unit");
+        writer.value(std::string_view(*characteristic.unit()));
+    }
+    if (characteristic.min_value()) {
+        writer.key("minValue");
+        writer.value(*characteristic.min_value());
+    }
+    if (characteristic.max_value()) {
+        writer.key("maxValue");
+        writer.value(*characteristic.max_value());
+    }
+    if (characteristic.min_step()) {
+        writer.key("minStep");
+        writer.value(*characteristic.min_step());
+    }
+    if (characteristic.max_len()) {
+        writer.key("maxLen");
+        writer.value(*characteristic.max_len());
+    }
+    if (characteristic.max_data_len()) {
+        writer.key("maxDataLen");
+        writer.value(*characteristic.max_data_len());
+    }
+    if (characteristic.valid_values() && !characteristic.valid_values()->empty()) {
+        writer.key("valid-values");
+        writer.begin_array();
+        for (double v : *characteristic.valid_values()) writer.value(v);
+        writer.end_array();
+    }
+    if (characteristic.valid_values_range()) {
+        writer.key("valid-values-range");
+        writer.begin_array();
+        writer.value(characteristic.valid_values_range()->first);
+        writer.value(characteristic.valid_values_range()->second);
+        writer.end_array();
+    }
+}
+
+Response bad_request() {
+    json error_response;
+    error_response["status"] = core::to_int(core::HAPStatus::InvalidValueInRequest);
+    Response resp{Status::BadRequest};
+    resp.set_header("Content-Type", "application/hap+json");
+    resp.set_body(error_response.dump());
+    return resp;
+}
+
+/// `fields` supplies only the flags; its ids view may have expired
+Response render_reads(const std::vector<ReadResult>& results, const ReadQuery& fields) {
+    bool any_error = std::any_of(results.begin(), results.end(),
+                                 [](const ReadResult& result) { return result.status != kSuccess; });
+    
+    // HAP Spec 6.7.4.2: Return 207 Multi-Status if any read fails.
+    // For 200 OK, status:0 is omitted as it's optional for successful reads.
+    Response resp{any_error ? Status::MultiStatus : Status::OK};
+    resp.set_header("Content-Type", "application/hap+json");
+    
+    std::vector<uint8_t> body;
+    body.reserve(32 + results.size() * 48);
+    core::JSONWriter writer(body);
+    writer.begin_object();
+    writer.key("characteristics");
+    writer.begin_array();
+    for (const auto& result : results) {
+        writer.begin_object();
+        writer.key("aid");
+        writer.value(result.aid);
+        writer.key("iid");
+        writer.value(result.iid);
+        if (any_error) {
+            writer.key("status");
+            writer.value(result.status);
+        }
+        if (result.status == kSuccess) {
+            writer.key("value");
+            writer.value(*result.value);
+        }
+        if (result.characteristic) {
+            const auto& characteristic = *result.characteristic;
+            if (fields.type) {
+                writer.key("type");
+                writer.value(characteristic.type_string());
+            }
+            if (fields.perms) {
+                writer.key("perms");
+                writer.raw_value(characteristic.perms_json());
+            }
+            if (fields.ev) {
+                writer.key("ev");
+                writer.value(result.subscribed);
+            }
+            if (fields.meta) {
+                write_metadata(writer, characteristic);
+            }
+        }
+        writer.end_object();
+    }
+    writer.end_array();
+    writer.end_object();
+    
+    resp.set_body(std::move(body));
+    return resp;
+}
+
+Response render_writes(const std::vector<WriteResult>& results, bool write_response_needed) {
+    bool any_error = std::any_of(results.begin(), results.end(),
+                                 [](const WriteResult& result) { return result.status != kSuccess; });
+    if (!any_error && !write_response_needed) {
+        return Response{Status::NoContent};
+    }
+    
+    // HAP Spec 6.7.3: errors and write responses both use 207 Multi-Status,
+    // which MUST include status for each characteristic. Without errors only
+    // the characteristics carrying a write-response value are reported.
+    std::vector<uint8_t> body;
+    body.reserve(32 + results.size() * 48);
+    core::JSONWriter writer(body);
+    writer.begin_object();
+    writer.key("characteristics");
+    writer.begin_array();
+    for (const auto& result : results) {
+        if (!any_error && !result.value) continue;
+        writer.begin_object();
+        writer.key("aid");
+        writer.value(result.aid);
+        writer.key("iid");
+        writer.value(result.iid);
+        writer.key("status");
+        writer.value(result.status);
+        if (result.value) {
+            writer.key("value");
+            writer.value(*result.value);
+        }
+        writer.end_object();
+    }
+    writer.end_array();
+    writer.end_object();
+    
+    Response resp{Status::MultiStatus};
+    resp.set_header("Content-Type", "application/hap+json");
+    resp.set_body(std::move(body));
+    return resp;
+}
+
+/// Runs the write-response step of a successful write (HAP Spec 6.7.3)
+void apply_write_response(core::Characteristic& characteristic, WriteResult& result) {
+    if (result.status != kSuccess) {
+        return;
+    }
+    auto outcome = CharacteristicOps::write_response(characteristic);
+    if (outcome.status != core::HAPStatus::Success) {
+        result.status = core::to_int(outcome.status);
+    } else if (outcome.value) {
+        result.value = std::move(outcome.value);
+    }
+}
+
+/// A scalar from a PUT body, kept until the target format is known
+using JsonScalar = std::variant<bool, int64_t, uint64_t, double, std::string>;
+
+/// One element of the PUT "characteristics" array
+struct WriteEntry {
+    std::optional<uint64_t> aid;
+    std::optional<uint64_t> iid;
+    std::optional<uint64_t> pid;
+    std::optional<bool> ev;
+    bool has_value = false;
+    std::optional<JsonScalar> value;  // nullopt with has_value: not a scalar (or null)
+};
+
+/**
+ * @brief SAX handler that reads a PUT /characteristics body straight into
+ * WriteEntry records, without building a DOM.
+ *
+ * Only scalars are kept; nested containers are skipped. Values stay raw
+ * because "value" may precede "aid"/"iid" and the target format is only
+ * known once both have been seen (see decode_value()).
+ */
+class WriteBodyParser : public nlohmann::json_sax<json> {
+public:
+    std::vector<WriteEntry> entries;
+    std::optional<uint64_t> pid;  // Top-level pid (HAP Spec 6.7.2.4)
+    bool has_array = false;
+    bool valid = true;
+
+    bool null() override { return scalar(std::nullopt); }
+    bool boolean(bool val) override { return scalar(JsonScalar{val}); }
+    bool number_integer(number_integer_t val) override { return scalar(JsonScalar{static_cast<int64_t>(val)}); }
+    bool number_unsigned(number_unsigned_t val) override { return scalar(JsonScalar{static_cast<uint64_t>(val)}); }
+    bool number_float(number_float_t val, const string_t&) override { return scalar(JsonScalar{static_cast<double>(val)}); }
+    bool string(string_t& val) override { return scalar(JsonScalar{std::move(val)}); }
+    bool binary(binary_t&) override { return scalar(std::nullopt); }
+
+    bool key(string_t& val) override {
+        key_ = std::move(val);
+        return true;
+    }
+
+    bool start_object(std::size_t) override {
+        ++depth_;
+        if (depth_ == 3 && in_array_) {
+            entries.emplace_back();
+        } else if (depth_ == 1) {
+            return true;
+        } else {
+            skipped_value();
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        --depth_;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++depth_;
+        if (depth_ == 2 && key_ == "characteristics") {
+            in_array_ = true;
+            has_array = true;
+        } else {
+            skipped_value();
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        --depth_;
+        if (depth_ == 1) in_array_ = false;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        valid = false;
+        return false;
+    }
+
+private:
+    int depth_ = 0;
+    bool in_array_ = false;
+    std::string key_;
+
+    /// A container where a scalar was expected: an unusable "value"
+    void skipped_value() {
+        if (depth_ == 4 && in_array_ && key_ == "value") {
+            entries.back().has_value = true;
+            entries.back().value.reset();
+        }
+    }
+
+    static std::optional<uint64_t> as_uint(const std::optional<JsonScalar>& v) {
+        if (!v) return std::nullopt;
+        if (auto* u = std::get_if<uint64_t>(&*v)) return *u;
+        return std::nullopt;
+    }
+
+    bool scalar(std::optional<JsonScalar> v) {
+        if (depth_ == 1 && key_ == "pid") {
+            pid = as_uint(v);
+        } else if (depth_ == 3 && in_array_) {
+            WriteEntry& entry = entries.back();
+            if (key_ == "aid") {
+                entry.aid = as_uint(v);
+            } else if (key_ == "iid") {
+                entry.iid = as_uint(v);
+            } else if (key_ == "pid") {
+                entry.pid = as_uint(v);
+            } else if (key_ == "ev") {
+                if (v && std::holds_alternative<bool>(*v)) entry.ev = std::get<bool>(*v);
+                else if (auto u = as_uint(v)) entry.ev = *u != 0;
+            } else if (key_ == "value") {
+                entry.has_value = true;
+                entry.value = std::move(v);
+            }
+        }
+        return true;
+    }
+};
+
+/// Convert a raw JSON scalar to the characteristic's format (nullopt: wrong type)
+std::optional<core::Value> decode_value(JsonScalar& raw, core::Format format) {
+    return std::visit([format](auto& v) -> std::optional<core::Value> {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+            switch (format) {
+                case core::Format::String: return core::Value(std::move(v));
+                case core::Format::TLV8:
+                case core::Format::Data: return core::Value(common::base64_decode(v));
+                default: return std::nullopt;
+            }
+        } else {
+            // Numbers and booleans convert between each other, except bool -> float
+            if constexpr (std::is_same_v<T, bool>) {
+                if (format == core::Format::Float) return std::nullopt;
+            }
+            switch (format) {
+                case core::Format::Bool: return core::Value(v != 0);
+                case core::Format::UInt8: return core::Value(static_cast<uint8_t>(v));
+                case core::Format::UInt16: return core::Value(static_cast<uint16_t>(v));
+                case core::Format::UInt32: return core::Value(static_cast<uint32_t>(v));
+                case core::Format::UInt64: return core::Value(static_cast<uint64_t>(v));
+                case core::Format::Int: return core::Value(static_cast<int32_t>(v));
+                case core::Format::Float: return core::Value(static_cast<float>(v));
+                default: return std::nullopt;
+            }
+        }
+    }, raw);
 }
 
-AccessoryEndpoints::AccessoryEndpoints(core::AttributeDatabase* database) 
-    : database_(database) {}
+} // namespace
+
+AccessoryEndpoints::AccessoryEndpoints(core::AttributeDatabase* database, EventDispatcher* events) 
+    : database_(database), events_(events) {}
+
+void AccessoryEndpoints::set_async_support(common::TaskScheduler* scheduler, uint32_t timeout_ms, DeferredResponder responder) {
+    scheduler_ = scheduler;
+    async_timeout_ms_ = timeout_ms;
+    responder_ = std::move(responder);
+}
 
 Response AccessoryEndpoints::handle_get_accessories(const Request& req, ConnectionContext& ctx) {
     (void)req;
     (void)ctx;
     
-    std::string json_str = database_->to_json_string();
+    std::string json_str = database_->to_cached_json_string();
     
     Response resp{Status::OK};
     resp.set_header("Content-Type", "application/hap+json");
@@ -61,381 +490,261 @@ Response AccessoryEndpoints::handle_get_accessories(const Request& req, Connecti
 Response AccessoryEndpoints::handle_get_characteristics(const Request& req, ConnectionContext& ctx) {
     (void)ctx;
     
-    // ?id=1.2,1.3,2.4
-    std::string query;
-    size_t query_start = req.path.find('?');
-    if (query_start != std::string::npos) {
-        query = req.path.substr(query_start + 1);
+    // ?id=1.2,1.3,2.4[&meta=1&perms=1&type=1&ev=1]
+    auto query = ReadQuery::parse(req.query);
+    if (!query) {
+        return bad_request();
     }
+    ReadQuery fields = *query;
+    fields.ids = {};  // Rendering may outlive the request
     
-    auto char_ids = parse_characteristic_ids(query);
+    // Resolve every read first so the 200/207 decision is known before
+    // anything is serialized. Results are sized up front: async completions
+    // write into their slot while later reads are still being started.
+    auto batch_results = std::make_shared<std::vector<ReadResult>>(query->count);
+    auto& results = *batch_results;
+    auto batch = std::make_shared<AsyncBatch>(ctx.connection_id(), [batch_results, fields]() {
+        return render_reads(*batch_results, fields);
+    });
     
-    json response;
-    json characteristics = json::array();
-    bool any_error = false;
-    
-    for (const auto& [aid, iid] : char_ids) {
+    size_t i = 0;
+    query->for_each_id([&](uint64_t aid, uint64_t iid) {
+        ReadResult& result = results[i++];
+        result.aid = aid;
+        result.iid = iid;
+        result.status = kSuccess;
         auto characteristic = database_->find_characteristic(aid, iid);
         if (characteristic) {
-            json char_json;
-            char_json["aid"] = aid;
-            char_json["iid"] = iid;
-            
-            if (!core::has_permission(characteristic->permissions(), core::Permission::PairedRead)) {
-                char_json["status"] = core::to_int(core::HAPStatus::WriteOnlyCharacteristic);
-                any_error = true;
-                characteristics.push_back(char_json);
-                continue;
+            result.characteristic = characteristic;
+            if (fields.ev && events_) {
+                result.subscribed = events_->is_subscribed(ctx.connection_id(), aid, iid);
             }
-            
-            // get_value() now returns ReadResponse (variant of Value or HAPStatus)
-            auto read_result = characteristic->get_value();
-            
-            if (std::holds_alternative<core::HAPStatus>(read_result)) {
-                // Read callback returned an error status
-                char_json["status"] = core::to_int(std::get<core::HAPStatus>(read_result));
-                any_error = true;
-                characteristics.push_back(char_json);
-                continue;
-            }
-            
-            // Success - extract the Value
-            auto value = std::get<core::Value>(read_result);
-            char_json["status"] = core::to_int(core::HAPStatus::Success);
-            
-            std::visit([&char_json](auto&& arg) {
-                using T = std::decay_t<decltype(arg)>;
-                if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, uint8_t> || 
-                             std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t> || 
-                             std::is_same_v<T, uint64_t> || std::is_same_v<T, int32_t> || 
-                             std::is_same_v<T, float> || std::is_same_v<T, std::string>) {
-                    char_json["value"] = arg;
-                } else {
-                    char_json["value"] = nullptr;
-                }
-            }, value);
-            
-            characteristics.push_back(char_json);
+        }
+        auto status = CharacteristicOps::check_read(characteristic.get());
+        if (status != core::HAPStatus::Success) {
+            result.status = core::to_int(status);
+        } else if (characteristic->has_async_read()) {
+            core::ReadCompletion done([batch, &result](core::ReadResponse response) {
+                batch->complete([&result, &response]() {
+                    if (auto* status = std::get_if<core::HAPStatus>(&response)) {
+                        result.status = core::to_int(*status);
+                    } else {
+                        result.scratch = std::get<core::Value>(std::move(response));
+                        result.value = &result.scratch;
+                    }
+                });
+            });
+            batch->begin([done]() { done(core::HAPStatus::ServiceCommunicationFailure); });
+            characteristic->read_async(done);
         } else {
-            json char_json;
-            char_json["aid"] = aid;
-            char_json["iid"] = iid;
-            char_json["status"] = core::to_int(core::HAPStatus::ResourceDoesNotExist);
-            any_error = true;
-            characteristics.push_back(char_json);
+            auto outcome = CharacteristicOps::read(characteristic.get(), result.scratch);
+            result.status = core::to_int(outcome.status);
+            result.value = outcome.value;
         }
-    }
-    
-    response["characteristics"] = characteristics;
-    
-    // HAP Spec 6.7.4.2: Return 207 Multi-Status if any read fails
-    if (any_error) {
-        Response resp{Status::MultiStatus};
-        resp.set_header("Content-Type", "application/hap+json");
-        resp.set_body(response.dump());
-        return resp;
-    }
+    });
     
-    // For 200 OK, strip status:0 as it's optional for successful reads
-    for (auto& c : characteristics) {
-        if (c.contains("status") && c["status"] == 0) {
-            c.erase("status");
+    return batch->finish(responder_, scheduler_, async_timeout_ms_, [&results]() {
+        // A deferred response is rendered outside the database lock
+        for (auto& result : results) {
+            if (result.status == kSuccess && result.value && result.value != &result.scratch) {
+                result.scratch = *result.value;
+                result.value = &result.scratch;
+            }
         }
-    }
-    response["characteristics"] = characteristics;
-    
-    Response resp{Status::OK};
-    resp.set_header("Content-Type", "application/hap+json");
-    resp.set_body(response.dump());
-    
-    return resp;
+    });
 }
 
 Response AccessoryEndpoints::handle_put_characteristics(const Request& req, ConnectionContext& ctx) {
-    (void)ctx;
-    std::string body_str(req.body.begin(), req.body.end());
-    auto body_json = json::parse(body_str, nullptr, false);
-    if (body_json.is_discarded()) {
-            json error_response;
-            error_response["status"] = core::to_int(core::HAPStatus::InvalidValueInRequest);
-            Response resp{Status::BadRequest};
-            resp.set_header("Content-Type", "application/hap+json");
-            resp.set_body(error_response.dump());
-            return resp;
+    WriteBodyParser body;
+    json::sax_parse(req.body.begin(), req.body.end(), &body, json::input_format_t::json, false);
+    if (!body.valid || !body.has_array) {
+        return bad_request();
     }
-    
-    if (!body_json.contains("characteristics") || !body_json["characteristics"].is_array()) {
-        json error_response;
-        error_response["status"] = core::to_int(core::HAPStatus::InvalidValueInRequest);
-        Response resp{Status::BadRequest};
-        resp.set_header("Content-Type", "application/hap+json");
-        resp.set_body(error_response.dump());
-        return resp;
+    bool ids_present = std::all_of(body.entries.begin(), body.entries.end(),
+                                   [](const WriteEntry& entry) { return entry.aid && entry.iid; });
+    if (!ids_present) {
+        return bad_request();
     }
     
-    json response;
-    json characteristics = json::array();
-    bool any_error = false;
-    bool write_response_needed = false;
+    // Sized up front like GET: async completions write into their slot
+    auto batch_results = std::make_shared<std::vector<WriteResult>>();
+    auto& results = *batch_results;
+    results.reserve(body.entries.size());
+    auto write_response_needed = std::make_shared<bool>(false);
+    auto batch = std::make_shared<AsyncBatch>(ctx.connection_id(), [batch_results, write_response_needed]() {
+        return render_writes(*batch_results, *write_response_needed);
+    });
     
-    for (const auto& char_req : body_json["characteristics"]) {
-        uint64_t aid = char_req["aid"];
-        uint64_t iid = char_req["iid"];
+    // Resolve targets and decode values first; writes start once every
+    // slot exists so no completion sees the vector grow
+    struct PendingWrite {
+        size_t index;
+        std::shared_ptr<core::Characteristic> characteristic;
+        core::Value value;
+    };
+    std::vector<PendingWrite> writes;
+    std::vector<uint64_t> used_pids;  // Every write of a request shares its prepared PID
+    uint64_t now_ms = ctx.system() ? ctx.system()->millis() : 0;
+    
+    for (auto& entry : body.entries) {
+        uint64_t aid = *entry.aid;
+        uint64_t iid = *entry.iid;
         
         auto characteristic = database_->find_characteristic(aid, iid);
         
         if (!characteristic) {
-            json char_json;
-            char_json["aid"] = aid;
-            char_json["iid"] = iid;
-            char_json["status"] = core::to_int(core::HAPStatus::ResourceDoesNotExist);
-            characteristics.push_back(char_json);
-            any_error = true;
+            results.push_back({aid, iid, core::to_int(core::HAPStatus::ResourceDoesNotExist), std::nullopt});
             continue;
         }
 
         bool processed = false;
         int status = core::to_int(core::HAPStatus::Success);
 
-        if (char_req.contains("ev")) {
-            bool enable = char_req["ev"];
-            if (core::has_permission(characteristic->permissions(), core::Permission::Notify)) {
-                if (enable) ctx.add_subscription(aid, iid);
-                else ctx.remove_subscription(aid, iid);
-                processed = true;
+        if (entry.ev) {
+            auto notify = CharacteristicOps::check_notify(characteristic.get());
+            if (notify == core::HAPStatus::Success) {
+                if (*entry.ev) events_->subscribe(ctx.connection_id(), aid, iid);
+                else events_->unsubscribe(ctx.connection_id(), aid, iid);
             } else {
-                status = core::to_int(core::HAPStatus::NotificationNotSupported);
-                processed = true;
+                status = core::to_int(notify);
             }
+            processed = true;
         }
 
-        if (char_req.contains("value")) {
-            if (core::has_permission(characteristic->permissions(), core::Permission::TimedWrite)) {
-                if (!char_req.contains("pid")) {
-                    status = core::to_int(core::HAPStatus::InvalidValueInRequest);
-                } else {
-                    uint64_t pid = char_req["pid"];
-                    if (!ctx.validate_timed_write(pid)) {
-                        status = core::to_int(core::HAPStatus::InvalidValueInRequest);
-                    }
-                }
+        if (entry.has_value) {
+            auto pid = entry.pid ? entry.pid : body.pid;
+            auto timed = CharacteristicOps::check_timed_write(*characteristic, ctx.timed_writes(), pid, now_ms);
+            if (timed != core::HAPStatus::Success) {
+                status = core::to_int(timed);
+            } else if (pid && characteristic->has_permission(core::Permission::TimedWrite) &&
+                       std::find(used_pids.begin(), used_pids.end(), *pid) == used_pids.end()) {
+                used_pids.push_back(*pid);
             }
 
             if (status == core::to_int(core::HAPStatus::Success)) {
-                if (!core::has_permission(characteristic->permissions(), core::Permission::PairedWrite)) {
-                    status = core::to_int(core::HAPStatus::ReadOnlyCharacteristic);
+                auto writable = CharacteristicOps::check_write(characteristic.get());
+                if (writable != core::HAPStatus::Success) {
+                    status = core::to_int(writable);
                 } else {
-                auto& value_json = char_req["value"];
-                
-                bool valid_value = true;
-                auto source = core::EventSource::from_connection(ctx.connection_id());
-                    switch (characteristic->format()) {
-                        case core::Format::Bool:
-                            if (value_json.is_boolean()) {
-                                characteristic->set_value(value_json.get<bool>(), source);
-                            } else if (value_json.is_number()) {
-                                characteristic->set_value(value_json.get<int>() != 0, source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::UInt8:
-                            if (value_json.is_number()) {
-                                characteristic->set_value(static_cast<uint8_t>(value_json.get<uint32_t>()), source);
-                            } else if (value_json.is_boolean()) {
-                                characteristic->set_value(static_cast<uint8_t>(value_json.get<bool>() ? 1 : 0), source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::UInt16:
-                            if (value_json.is_number()) {
-                                characteristic->set_value(static_cast<uint16_t>(value_json.get<uint32_t>()), source);
-                            } else if (value_json.is_boolean()) {
-                                characteristic->set_value(static_cast<uint16_t>(value_json.get<bool>() ? 1 : 0), source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::UInt32:
-                            if (value_json.is_number()) {
-                                characteristic->set_value(value_json.get<uint32_t>(), source);
-                            } else if (value_json.is_boolean()) {
-                                characteristic->set_value(static_cast<uint32_t>(value_json.get<bool>() ? 1 : 0), source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::UInt64:
-                            if (value_json.is_number()) {
-                                characteristic->set_value(value_json.get<uint64_t>(), source);
-                            } else if (value_json.is_boolean()) {
-                                characteristic->set_value(static_cast<uint64_t>(value_json.get<bool>() ? 1 : 0), source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::Int:
-                            if (value_json.is_number()) {
-                                characteristic->set_value(value_json.get<int32_t>(), source);
-                            } else if (value_json.is_boolean()) {
-                                characteristic->set_value(static_cast<int32_t>(value_json.get<bool>() ? 1 : 0), source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::Float:
-                            if (value_json.is_number()) {
-                                characteristic->set_value(value_json.get<float>(), source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::String:
-                            if (value_json.is_string()) {
-                                characteristic->set_value(value_json.get<std::string>(), source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
-                            
-                        case core::Format::TLV8:
-                        case core::Format::Data:
-                            if (value_json.is_string()) {
-                                std::string b64_str = value_json.get<std::string>();
-                                std::vector<uint8_t> data = base64_decode(b64_str);
-                                characteristic->set_value(data, source);
-                            } else {
-                                valid_value = false;
-                            }
-                            break;
+                    auto decoded = entry.value ? decode_value(*entry.value, characteristic->format()) : std::nullopt;
+                    if (!decoded) {
+                        status = core::to_int(core::HAPStatus::InvalidValueInRequest);
+                    } else {
+                        writes.push_back({results.size(), characteristic, std::move(*decoded)});
                     }
-                
-                if (!valid_value) {
-                    status = core::to_int(core::HAPStatus::InvalidValueInRequest);
                 }
             }
-            }
             processed = true;
         }
         
-        if (status != core::to_int(core::HAPStatus::Success)) {
-            any_error = true;
-        }
-        
-        if (core::has_permission(characteristic->permissions(), core::Permission::WriteResponse)) {
-            write_response_needed = true;
+        if (characteristic->has_permission(core::Permission::WriteResponse)) {
+            *write_response_needed = true;
         }
         
         if (processed) {
-            json char_json;
-            char_json["aid"] = aid;
-            char_json["iid"] = iid;
-            char_json["status"] = status;
-            
-            if (status == core::to_int(core::HAPStatus::Success) && 
-                core::has_permission(characteristic->permissions(), core::Permission::WriteResponse)) {
-                // Get input value for write-response callback
-                auto read_result = characteristic->get_value();
-                if (std::holds_alternative<core::Value>(read_result)) {
-                    auto input_value = std::get<core::Value>(read_result);
-                    auto response_opt = characteristic->handle_write_response(input_value);
-                    
-                    core::Value value_to_send;
-                    if (response_opt.has_value()) {
-                        auto& response = *response_opt;
-                        if (std::holds_alternative<core::HAPStatus>(response)) {
-                            // WriteResponse callback returned an error
-                            status = core::to_int(std::get<core::HAPStatus>(response));
-                            any_error = true;
-                        } else {
-                            value_to_send = std::get<core::Value>(response);
-                        }
-                    } else {
-                        // No callback, use the current value
-                        value_to_send = input_value;
-                    }
-                    
-                    if (status == core::to_int(core::HAPStatus::Success)) {
-                        std::visit([&char_json](auto&& arg) {
-                            using T = std::decay_t<decltype(arg)>;
-                            if constexpr (std::is_same_v<T, bool> || std::is_same_v<T, uint8_t> || 
-                                            std::is_same_v<T, uint16_t> || std::is_same_v<T, uint32_t> || 
-                                            std::is_same_v<T, uint64_t> || std::is_same_v<T, int32_t> || 
-                                            std::is_same_v<T, float> || std::is_same_v<T, std::string>) {
-                                char_json["value"] = arg;
-                            } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
-                                char_json["value"] = core::base64_encode(arg);
-                            } else {
-                                char_json["value"] = nullptr;
-                            }
-                        }, value_to_send);
-                    }
-                    // Update the status in char_json in case it changed
-                    char_json["status"] = status;
-                }
+            results.push_back({aid, iid, status, std::nullopt});
+        }
+    }
+    for (uint64_t pid : used_pids) {
+        ctx.finish_timed_write(pid);
+    }
+    
+    // Accessories with a batch write callback get all their writes in one call
+    std::map<uint64_t, std::pair<std::shared_ptr<core::Accessory>, std::vector<PendingWrite*>>> batched;
+    std::vector<PendingWrite*> individual;
+    for (auto& write : writes) {
+        uint64_t aid = results[write.index].aid;
+        auto it = batched.find(aid);
+        if (it == batched.end()) {
+            auto accessory = database_->find_accessory(aid);
+            if (!accessory || !accessory->batch_write_callback()) {
+                individual.push_back(&write);
+                continue;
             }
-            
-            characteristics.push_back(char_json);
+            it = batched.emplace(aid, std::make_pair(std::move(accessory), std::vector<PendingWrite*>{})).first;
         }
+        it->second.second.push_back(&write);
     }
     
-    if (any_error) {
-        response["characteristics"] = characteristics;
-        Response resp{Status::MultiStatus};
-        resp.set_header("Content-Type", "application/hap+json");
-        resp.set_body(response.dump());
-        return resp;
-    } else if (write_response_needed) {
-        json final_chars = json::array();
-            for (auto& c : characteristics) {
-                if (c.contains("value")) {
-                    // HAP Spec 6.7.3: 207 Multi-Status MUST include status for each characteristic
-                    // Ensure status is present (default to 0 if not set)
-                    if (!c.contains("status")) {
-                        c["status"] = core::to_int(core::HAPStatus::Success);
+    for (auto& [aid, group] : batched) {
+        auto& [accessory, group_writes] = group;
+        std::vector<core::BatchWrite> entries;
+        std::vector<std::pair<size_t, std::shared_ptr<core::Characteristic>>> targets;
+        entries.reserve(group_writes.size());
+        targets.reserve(group_writes.size());
+        for (PendingWrite* write : group_writes) {
+            write->characteristic->store_value(std::move(write->value));
+            entries.push_back({write->characteristic, write->characteristic->value()});
+            targets.emplace_back(write->index, write->characteristic);
+        }
+        core::WriteCompletion done([batch, &results, targets = std::move(targets)](core::WriteResponse response) {
+            batch->complete([&]() {
+                for (const auto& [index, characteristic] : targets) {
+                    if (response) {
+                        results[index].status = core::to_int(*response);
+                    } else {
+                        apply_write_response(*characteristic, results[index]);
                     }
-                    final_chars.push_back(c);
                 }
-            }
-        response["characteristics"] = final_chars;
-        Response resp{Status::MultiStatus};  // HAP Spec 6.7.3: WriteResponse uses 207 Multi-Status
-        resp.set_header("Content-Type", "application/hap+json");
-        resp.set_body(response.dump());
-        return resp;
-    } else {
-        return Response{Status::NoContent};
+            });
+        });
+        batch->begin([done]() { done(core::HAPStatus::ServiceCommunicationFailure); });
+        accessory->batch_write_callback()(entries, done);
     }
-}
-
-std::vector<std::pair<uint64_t, uint64_t>> AccessoryEndpoints::parse_characteristic_ids(const std::string& query) {
-    std::vector<std::pair<uint64_t, uint64_t>> result;
     
-    size_t id_start = query.find("id=");
-    if (id_start == std::string::npos) {
-        return result;
+    auto source = core::EventSource::from_connection(ctx.connection_id());
+    for (PendingWrite* pending : individual) {
+        PendingWrite& write = *pending;
+        WriteResult& result = results[write.index];
+        core::WriteCompletion done([batch, &result, characteristic = write.characteristic](core::WriteResponse response) {
+            batch->complete([&]() {
+                if (response) {
+                    result.status = core::to_int(*response);
+                } else {
+                    apply_write_response(*characteristic, result);
+                }
+            });
+        });
+        if (write.characteristic->has_async_write()) {
+            batch->begin([done]() { done(core::HAPStatus::ServiceCommunicationFailure); });
+        } else {
+            // Completes inline; counted so complete() balances
+            batch->begin([]() {});
+        }
+        write.characteristic->write_async(std::move(write.value), source, done);
     }
     
-    std::string ids_str = query.substr(id_start + 3);
-    
-    std::istringstream iss(ids_str);
-    std::string token;
-    while (std::getline(iss, token, ',')) {
-        size_t dot_pos = token.find('.');
-        if (dot_pos != std::string::npos) {
-            uint64_t aid = std::stoull(token.substr(0, dot_pos));
-            uint64_t iid = std::stoull(token.substr(dot_pos + 1));
-            result.emplace_back(aid, iid);
+    // Write results own their values, so nothing needs detaching
+    return batch->finish(responder_, scheduler_, async_timeout_ms_, []() {});
+}
+
+std::optional<ReadQuery> ReadQuery::parse(std::string_view query) {
+    ReadQuery result;
+    bool has_ids = false;
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view param = query.substr(0, amp);
+        query = amp == std::string_view::npos ? std::string_view{} : query.substr(amp + 1);
+        
+        size_t eq = param.find('=');
+        std::string_view name = param.substr(0, eq);
+        std::string_view value = eq == std::string_view::npos ? std::string_view{} : param.substr(eq + 1);
+        if (name == "id") {
+            if (!parse_ids(value, result.count)) return std::nullopt;
+            result.ids = value;
+            has_ids = true;
+        } else if (name == "meta") {
+            result.meta = parse_flag(value);
+        } else if (name == "perms") {
+            result.perms = parse_flag(value);
+        } else if (name == "type") {
+            result.type = parse_flag(value);
+        } else if (name == "ev") {
+            result.ev = parse_flag(value);
         }
+        // Unknown parameters are ignored
     }
-    
+    if (!has_ids) return std::nullopt;
     return result;
 }
 
@@ -1,12 +1,16 @@
 #include "hap/transport/BleTransport.hpp"
 #include "hap/core/CharacteristicFinder.hpp"
 #include "hap/core/HAPStatus.hpp"
+#include "hap/common/Log.hpp"
 #include <random>
 #include <algorithm>
+#include <bit>
 #include <cstring>
+#include <cstdlib>
 #include "hap/core/TLV8.hpp"
 #include "hap/transport/ble/BleTlvBuilder.hpp"
 #include "hap/core/CharacteristicSerializer.hpp"
+#include "hap/transport/CharacteristicOps.hpp"
 
 static std::string to_hex_string(const uint8_t* data, size_t len) {
     std::string s;
@@ -26,10 +30,58 @@ using ble::TransactionState;
 using ble::HAPBLEPDUTLVType;
 using ble::BleTlvBuilder;
 
+namespace {
+
+// Little-endian value bytes for a broadcast payload, zero padded to 8 bytes;
+// same layout as CharacteristicSerializer::to_bytes without the allocation
+void write_broadcast_value(const core::Value& value, std::span<uint8_t, 8> out) {
+    std::fill(out.begin(), out.end(), 0);
+    std::visit([&out](auto&& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, bool>) {
+            out[0] = arg ? 1 : 0;
+        } else if constexpr (std::is_same_v<T, float>) {
+            uint32_t bits = std::bit_cast<uint32_t>(arg);
+            for (size_t i = 0; i < 4; ++i) out[i] = (bits >> (i * 8)) & 0xFF;
+        } else if constexpr (std::is_integral_v<T>) {
+            auto bits = static_cast<std::make_unsigned_t<T>>(arg);
+            for (size_t i = 0; i < sizeof(T); ++i) out[i] = (bits >> (i * 8)) & 0xFF;
+        } else if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::vector<uint8_t>>) {
+            std::copy_n(arg.begin(), std::min(arg.size(), out.size()), out.begin());
+        }
+    }, value);
+}
+
+/// Appends one fragment to the transaction and reports whether the PDU is
+/// complete. The header is decoded once, when enough of it has arrived, and
+/// the buffer is reserved for the whole PDU at that point.
+bool append_fragment(TransactionState& state, std::span<const uint8_t> fragment) {
+    state.buffer.insert(state.buffer.end(), fragment.begin(), fragment.end());
+    
+    if (state.expected_total == 0) {
+        // Header is 5 bytes: CF(1) | Opcode(1) | TID(1) | IID(2), plus BodyLen(2) for bodies
+        size_t header_size = ble::HapPdu::body_offset(state.opcode);
+        if (state.buffer.size() < header_size) return false;
+        
+        if (ble::HapPdu::opcode_has_body(state.opcode)) {
+            state.expected_body_length = state.buffer[5] | (static_cast<uint16_t>(state.buffer[6]) << 8);
+        } else {
+            state.expected_body_length = 0;
+        }
+        state.expected_total = header_size + state.expected_body_length;
+        state.buffer.reserve(state.expected_total);
+    }
+    
+    return state.buffer.size() >= state.expected_total;
+}
+
+} // namespace
+
 BleTransport::BleTransport(Config config) : config_(std::move(config)),
-    session_manager_(std::make_unique<ble::BleSessionManager>(config_.system)) {
+    session_manager_(std::make_unique<ble::BleSessionManager>(config_.system, config_.scheduler, &mutex_)),
+    gsn_(config_.storage, config_.gsn_reserve) {
     if (!config_.ble) {
-        if(config_.system) config_.system->log(platform::System::LogLevel::Warning, "[BleTransport] No BLE platform interface provided");
+        if(config_.system) HAP_LOG_WARNING(config_.system, "[BleTransport] No BLE platform interface provided");
     }
 }
 
@@ -38,54 +90,125 @@ BleTransport::~BleTransport() {
 }
 
 void BleTransport::start() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (!config_.ble) return;
 
-    config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Starting...");
+    HAP_LOG_INFO(config_.system, "[BleTransport] Starting...");
 
     config_.ble->set_disconnect_callback([this](uint16_t connection_id) {
-        config_.system->log(platform::System::LogLevel::Info, 
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Device disconnected, connection_id=" + std::to_string(connection_id));
         
         session_manager_->remove(connection_id);
         
-        config_.system->log(platform::System::LogLevel::Info, 
+        // The controller read current values while connected
+        cancel_broadcasts();
+        
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Connection state cleaned up, refreshing advertising");
         
+        // Stacks stop advertising while connected, so restart even if unchanged
+        current_advertisement_.reset();
         update_advertising();
     });
 
+    session_manager_->set_timeout_handler([this](uint16_t connection_id) {
+        terminate_timed_out(connection_id);
+    });
+
+    config_.ble->set_mtu_callback([this](uint16_t connection_id, uint16_t mtu) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        HAP_LOG_DEBUG(config_.system,
+            "[BleTransport] ATT MTU for connection " + std::to_string(connection_id) + " is " + std::to_string(mtu));
+        session_manager_->get_or_create(connection_id).att_mtu = mtu;
+    });
+
+    indication_confirmations_ = config_.ble->set_indication_confirm_callback([this](uint16_t connection_id) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        if (auto* session = session_manager_->get_session(connection_id)) {
+            session->indication_in_flight = false;
+        }
+        send_pending_indications(connection_id);
+    });
+
+    index_database();
+    
+    // Services a controller needs first: identify the accessory, then pair
     register_accessory_info_service();
     
     setup_protocol_info_service();
     
     setup_hap_service();
     
+    if (config_.defer_user_services && config_.scheduler) {
+        // Let the caller bring up HAP-IP before the rest of the GATT table
+        registration_task_ = config_.scheduler->schedule_once(0, [this]() {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            registration_task_ = common::TaskScheduler::INVALID_TASK_ID;
+            finish_start();
+        });
+        return;
+    }
+    finish_start();
+}
+
+void BleTransport::finish_start() {
     register_user_services();
     
-    update_advertising();
+    rebuild_signatures();
+    
+    flush_advertising();
     
     config_.ble->start();
+    
+    ready_ = true;
+    if (config_.on_ready) {
+        config_.on_ready();
+    }
 }
 
 void BleTransport::stop() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (registration_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        config_.scheduler->cancel(registration_task_);
+        registration_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    if (advertising_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        config_.scheduler->cancel(advertising_task_);
+        advertising_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    if (transaction_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        config_.scheduler->cancel(transaction_task_);
+        transaction_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    ready_connections_.clear();
+    if (indication_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        config_.scheduler->cancel(indication_task_);
+        indication_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    cancel_broadcasts();
     if (config_.ble) {
         config_.ble->stop_advertising();
     }
+    current_advertisement_.reset();
 }
 
 void BleTransport::setup_hap_service() {
     // Use IIDManager for stable IIDs with dedicated keys for HAP pairing service
-    auto get_iid = [this](const std::string& key) -> uint16_t {
+    auto get_iid = [this](const core::IIDManager::Key& key) -> uint16_t {
         if (config_.iid_manager) {
             return config_.iid_manager->get_or_assign(key);
         }
         // Fallback: use hash of key as stable-ish IID
         uint16_t iid = 1;
-        for (char c : key) iid = ((iid << 5) + iid) ^ c;
+        for (uint16_t part : {static_cast<uint16_t>(key.kind), key.type, key.service_type}) {
+            iid = ((iid << 5) + iid) ^ part;
+        }
         return (iid & 0x7FFF) + 1;  // Ensure positive, non-zero
     };
     
-    uint16_t svc_iid = get_iid("BLE:S:0055");  // HAP Pairing Service
+    uint16_t svc_iid = get_iid(core::IIDManager::Key::ble_service(0x0055));  // HAP Pairing Service
     platform::Ble::ServiceDefinition hap_service;
     hap_service.uuid = kHapPairingServiceUUID;
     hap_service.is_primary = true;
@@ -117,13 +240,14 @@ void BleTransport::setup_hap_service() {
     }
 
     {
-        uint16_t char_iid = get_iid("BLE:C:004C:0055");  // Pair Setup
+        uint16_t char_iid = get_iid(core::IIDManager::Key::ble_characteristic(0x0055, 0x004C));  // Pair Setup
         platform::Ble::CharacteristicDefinition def;
         def.uuid = "0000004C-0000-1000-8000-0026BB765291";
         def.properties = { .read = true, .write = true };
-        def.on_write = [this](uint16_t conn, std::span<const uint8_t> data, bool) {
-            config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Pair Setup Write: " + std::to_string(data.size()) + " bytes");
-            handle_hap_write(conn, "0000004C-0000-1000-8000-0026BB765291", data);
+        uint16_t handle = add_gatt_characteristic(0, char_iid, def.uuid);
+        def.on_write = [this, handle](uint16_t conn, std::span<const uint8_t> data, bool) {
+            HAP_LOG_DEBUG(config_.system, "[BleTransport] Pair Setup Write: " + std::to_string(data.size()) + " bytes");
+            handle_hap_write(conn, handle, data);
         };
         def.on_read = [this](uint16_t conn) {
             return handle_hap_read(conn);
@@ -138,20 +262,21 @@ void BleTransport::setup_hap_service() {
         meta.properties = 0x0003;  // Read | Write (NOT Paired Read/Write!)
         pairing_char_metadata_[char_iid] = meta;
         
-        config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Registered Pair Setup (4C) IID=" + std::to_string(char_iid));
+        HAP_LOG_INFO(config_.system, "[BleTransport] Registered Pair Setup (4C) IID=" + std::to_string(char_iid));
         hap_service.characteristics.push_back(std::move(def));
     }
 
     {
-        uint16_t char_iid = get_iid("BLE:C:004E:0055");  // Pair Verify
+        uint16_t char_iid = get_iid(core::IIDManager::Key::ble_characteristic(0x0055, 0x004E));  // Pair Verify
         platform::Ble::CharacteristicDefinition def;
         def.uuid = "0000004E-0000-1000-8000-0026BB765291";
         def.properties.read = true;
         def.properties.write = true;
         def.properties.indicate = false;
         def.properties.notify = false;
-        def.on_write = [this](uint16_t conn, std::span<const uint8_t> data, bool) {
-            handle_hap_write(conn, "0000004E-0000-1000-8000-0026BB765291", data);
+        uint16_t handle = add_gatt_characteristic(0, char_iid, def.uuid);
+        def.on_write = [this, handle](uint16_t conn, std::span<const uint8_t> data, bool) {
+            handle_hap_write(conn, handle, data);
         };
         def.on_read = [this](uint16_t conn) {
             return handle_hap_read(conn);
@@ -170,16 +295,17 @@ void BleTransport::setup_hap_service() {
     }
 
     {
-        config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Adding Pairing Features...");
-        uint16_t char_iid = get_iid("BLE:C:004F:0055");  // Pairing Features
+        HAP_LOG_INFO(config_.system, "[BleTransport] Adding Pairing Features...");
+        uint16_t char_iid = get_iid(core::IIDManager::Key::ble_characteristic(0x0055, 0x004F));  // Pairing Features
         platform::Ble::CharacteristicDefinition def;
         def.uuid = "0000004F-0000-1000-8000-0026BB765291";
         def.properties.read = true;
         def.properties.write = true;
         def.properties.indicate = false;
         def.properties.notify = false;
-        def.on_write = [this](uint16_t conn, std::span<const uint8_t> data, bool) {
-            handle_hap_write(conn, "0000004F-0000-1000-8000-0026BB765291", data);
+        uint16_t handle = add_gatt_characteristic(0, char_iid, def.uuid);
+        def.on_write = [this, handle](uint16_t conn, std::span<const uint8_t> data, bool) {
+            handle_hap_write(conn, handle, data);
         };
         def.on_read = [this](uint16_t conn) {
             return handle_hap_read(conn);
@@ -199,8 +325,8 @@ void BleTransport::setup_hap_service() {
     }
 
     {
-        config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Adding Pairing Pairings...");
-        uint16_t char_iid = get_iid("BLE:C:0050:0055");  // Pairing Pairings
+        HAP_LOG_INFO(config_.system, "[BleTransport] Adding Pairing Pairings...");
+        uint16_t char_iid = get_iid(core::IIDManager::Key::ble_characteristic(0x0055, 0x0050));  // Pairing Pairings
         platform::Ble::CharacteristicDefinition def;
         def.uuid = "00000050-0000-1000-8000-0026BB765291";
         def.properties.read = true;
@@ -208,8 +334,9 @@ void BleTransport::setup_hap_service() {
         def.properties.indicate = false;
         def.properties.notify = false;
         
-        def.on_write = [this](uint16_t conn, std::span<const uint8_t> data, bool) {
-            handle_hap_write(conn, "00000050-0000-1000-8000-0026BB765291", data);
+        uint16_t handle = add_gatt_characteristic(0, char_iid, def.uuid);
+        def.on_write = [this, handle](uint16_t conn, std::span<const uint8_t> data, bool) {
+            handle_hap_write(conn, handle, data);
         };
         
         def.on_read = [this](uint16_t conn) {
@@ -228,7 +355,7 @@ void BleTransport::setup_hap_service() {
         hap_service.characteristics.push_back(std::move(def));
     }
 
-    config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Registering Service...");
+    HAP_LOG_INFO(config_.system, "[BleTransport] Registering Service...");
     config_.ble->register_service(hap_service);
     
     // Save IIDManager state if available
@@ -239,17 +366,19 @@ void BleTransport::setup_hap_service() {
 
 void BleTransport::setup_protocol_info_service() {
     // Use IIDManager for stable IIDs with dedicated keys for Protocol Info service
-    auto get_iid = [this](const std::string& key) -> uint16_t {
+    auto get_iid = [this](const core::IIDManager::Key& key) -> uint16_t {
         if (config_.iid_manager) {
             return config_.iid_manager->get_or_assign(key);
         }
         // Fallback: use hash of key as stable-ish IID
         uint16_t iid = 1;
-        for (char c : key) iid = ((iid << 5) + iid) ^ c;
+        for (uint16_t part : {static_cast<uint16_t>(key.kind), key.type, key.service_type}) {
+            iid = ((iid << 5) + iid) ^ part;
+        }
         return (iid & 0x7FFF) + 1;  // Ensure positive, non-zero
     };
     
-    uint16_t svc_iid = get_iid("BLE:S:00A2");  // Protocol Information Service
+    uint16_t svc_iid = get_iid(core::IIDManager::Key::ble_service(0x00A2));  // Protocol Information Service
     platform::Ble::ServiceDefinition proto_service;
     proto_service.uuid = kHapProtocolInformationServiceUUID;
     proto_service.is_primary = true;
@@ -281,12 +410,13 @@ void BleTransport::setup_protocol_info_service() {
     }
 
     {
-        uint16_t char_iid = get_iid("BLE:C:00A5:00A2");  // Service Signature
+        uint16_t char_iid = get_iid(core::IIDManager::Key::ble_characteristic(0x00A2, 0x00A5));  // Service Signature
         platform::Ble::CharacteristicDefinition def;
         def.uuid = kServiceSignatureCharUUID;
         def.properties = { .read = true, .write = true };
-        def.on_write = [this](uint16_t conn, std::span<const uint8_t> data, bool) {
-            handle_hap_write(conn, kServiceSignatureCharUUID, data);
+        uint16_t handle = add_gatt_characteristic(0, char_iid, def.uuid);
+        def.on_write = [this, handle](uint16_t conn, std::span<const uint8_t> data, bool) {
+            handle_hap_write(conn, handle, data);
         };
         def.on_read = [this](uint16_t conn) {
              return handle_hap_read(conn);
@@ -305,12 +435,13 @@ void BleTransport::setup_protocol_info_service() {
     }
 
     {
-        uint16_t char_iid = get_iid("BLE:C:0037:00A2");  // Version
+        uint16_t char_iid = get_iid(core::IIDManager::Key::ble_characteristic(0x00A2, 0x0037));  // Version
         platform::Ble::CharacteristicDefinition def;
         def.uuid = "00000037-0000-1000-8000-0026BB765291";
         def.properties = { .read = true, .write = true };
-        def.on_write = [this](uint16_t conn, std::span<const uint8_t> data, bool) {
-            handle_hap_write(conn, "00000037-0000-1000-8000-0026BB765291", data);
+        uint16_t handle = add_gatt_characteristic(0, char_iid, def.uuid);
+        def.on_write = [this, handle](uint16_t conn, std::span<const uint8_t> data, bool) {
+            handle_hap_write(conn, handle, data);
         };
         def.on_read = [this](uint16_t conn) {
             return handle_hap_read(conn);
@@ -337,62 +468,90 @@ void BleTransport::setup_protocol_info_service() {
 }
 
 void BleTransport::update_advertising() {
-    config_.system->log(platform::System::LogLevel::Info, "[BleTransport] update_advertising entry");
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (!config_.scheduler) {
+        flush_advertising();
+        return;
+    }
+    if (advertising_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        return;  // A refresh is already pending and will pick up this change
+    }
+    advertising_task_ = config_.scheduler->schedule_once(kAdvertisingDebounceMs, [this]() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        advertising_task_ = common::TaskScheduler::INVALID_TASK_ID;
+        flush_advertising();
+    });
+}
+
+void BleTransport::flush_advertising() {
+    if (advertising_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        config_.scheduler->cancel(advertising_task_);
+        advertising_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
     
-    auto setup_id_bytes = config_.storage->get("setup_id");
-    std::string setup_id;
-    if (setup_id_bytes && setup_id_bytes->size() == 4) {
-        setup_id = std::string(setup_id_bytes->begin(), setup_id_bytes->end());
-        config_.system->log(platform::System::LogLevel::Debug, "[BleTransport] Using existing Setup ID: " + setup_id);
-    } else {
-        const char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-        std::mt19937 rng(std::random_device{}());
-        std::uniform_int_distribution<> dist(0, 35);
-        for (int i = 0; i < 4; ++i) {
-            setup_id += charset[dist(rng)];
-        }
-        config_.storage->set("setup_id", std::vector<uint8_t>(setup_id.begin(), setup_id.end()));
-        config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Generated new Setup ID: " + setup_id);
+    // An encrypted broadcast owns the radio until its slot ends;
+    // flush_broadcasts() comes back here afterwards
+    if (auto busy_until = broadcasts_.busy_until_ms(); busy_until && config_.system->millis() < *busy_until) {
+        return;
     }
     
-    std::string input = setup_id + config_.accessory_id;
-    std::vector<uint8_t> hash_output(64);
-    config_.system->log(platform::System::LogLevel::Debug, "[BleTransport] Calculating Setup Hash for: " + input);
+    auto adv = build_advertisement();
+    if (!adv) return;
     
-    if (config_.crypto == nullptr) {
-         config_.system->log(platform::System::LogLevel::Error, "[BleTransport] No crypto provider!");
-         return;
+    if (current_advertisement_ && *current_advertisement_ == *adv) {
+        HAP_LOG_DEBUG(config_.system, "[BleTransport] Advertisement unchanged, not restarting");
+        return;
     }
 
-    config_.crypto->sha512(
-        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(input.data()), input.size()), 
-        std::span<uint8_t, 64>(hash_output.data(), 64)
-    );
+    HAP_LOG_DEBUG(config_.system,
+        "[BleTransport] Advertisement Data (" + std::to_string(adv->manufacturer_data.size()) + " bytes): " +
+        to_hex_string(adv->manufacturer_data.data(), adv->manufacturer_data.size()));
+
+    config_.ble->start_advertising(*adv, config_.ble->interval_config.normal_interval_ms);
+    current_advertisement_ = std::move(adv);
+}
+
+std::optional<platform::Ble::Advertisement> BleTransport::build_advertisement() {
+    if (config_.crypto == nullptr) {
+         HAP_LOG_ERROR(config_.system, "[BleTransport] No crypto provider!");
+         return std::nullopt;
+    }
     
-    uint8_t setup_hash[4];
-    std::copy_n(hash_output.begin(), 4, setup_hash);
+    if (!setup_hash_) {
+        auto setup_id_bytes = config_.storage->get("setup_id");
+        std::string setup_id;
+        if (setup_id_bytes && setup_id_bytes->size() == 4) {
+            setup_id = std::string(setup_id_bytes->begin(), setup_id_bytes->end());
+            HAP_LOG_DEBUG(config_.system, "[BleTransport] Using existing Setup ID: " + setup_id);
+        } else {
+            const char charset[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+            std::mt19937 rng(std::random_device{}());
+            std::uniform_int_distribution<> dist(0, 35);
+            for (int i = 0; i < 4; ++i) {
+                setup_id += charset[dist(rng)];
+            }
+            config_.storage->set("setup_id", std::vector<uint8_t>(setup_id.begin(), setup_id.end()));
+            HAP_LOG_INFO(config_.system, "[BleTransport] Generated new Setup ID: " + setup_id);
+        }
+        
+        std::string input = setup_id + config_.accessory_id;
+        std::array<uint8_t, 64> hash_output = {};
+        HAP_LOG_DEBUG(config_.system, "[BleTransport] Calculating Setup Hash for: " + input);
+        config_.crypto->sha512(
+            std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(input.data()), input.size()), 
+            std::span<uint8_t, 64>(hash_output.data(), 64)
+        );
+        
+        setup_hash_.emplace();
+        std::copy_n(hash_output.begin(), 4, setup_hash_->begin());
+    }
     
-    auto pairing_list = config_.storage->get("pairing_list");
-    bool is_paired = (pairing_list && pairing_list->size() > 2);
+    bool is_paired = config_.pairing_store && config_.pairing_store->is_paired();
     uint8_t status_flags = is_paired ? 0x00 : 0x01;
     
-    uint8_t device_id[6] = {0};
-    int scanned = sscanf(config_.accessory_id.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", 
-        &device_id[0], &device_id[1], &device_id[2], &device_id[3], &device_id[4], &device_id[5]);
-    if (scanned != 6) {
-         config_.system->log(platform::System::LogLevel::Warning, "[BleTransport] Invalid Device ID format: " + config_.accessory_id);
-    }
+    const auto& device_id = advertising_id();
 
-    uint16_t gsn = 1;
-    auto gsn_bytes = config_.storage->get("gsn");
-    if (gsn_bytes && gsn_bytes->size() == 2) {
-        gsn = static_cast<uint16_t>((*gsn_bytes)[0]) | (static_cast<uint16_t>((*gsn_bytes)[1]) << 8);
-        if (gsn == 0) gsn = 1;
-    } else {
-        std::vector<uint8_t> gsn_data = {0x01, 0x00};
-        config_.storage->set("gsn", gsn_data);
-        config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Initialized GSN to 1");
-    }
+    uint16_t gsn = gsn_.current();
 
     uint8_t config_number = 1;
     auto cn_bytes = config_.storage->get("config_number");
@@ -403,89 +562,131 @@ void BleTransport::update_advertising() {
 
     auto adv = platform::Ble::Advertisement::create_hap(
         status_flags,
-        device_id,
+        device_id.data(),
         config_.category_id,
         gsn,
         config_number,
-        setup_hash
+        setup_hash_->data()
     );
     
     adv.local_name = config_.device_name;
 
-    std::string adv_hex;
-    for (auto byte : adv.manufacturer_data) {
-        char buf[4];
-        snprintf(buf, sizeof(buf), "%02X ", byte);
-        adv_hex += buf;
-    }
-    config_.system->log(platform::System::LogLevel::Info, 
-        "[BleTransport] Advertisement Data (" + std::to_string(adv.manufacturer_data.size()) + " bytes): " + adv_hex);
-    config_.system->log(platform::System::LogLevel::Info,
+    HAP_LOG_DEBUG(config_.system,
         "[BleTransport] SF=" + std::to_string(status_flags) + 
         " ACID=" + std::to_string(config_.category_id) +
         " GSN=" + std::to_string(gsn) +
         " CN=" + std::to_string(config_number));
 
-    config_.ble->start_advertising(adv, config_.ble->interval_config.normal_interval_ms);
+    return adv;
+}
+
+const std::array<uint8_t, 6>& BleTransport::advertising_id() {
+    if (!advertising_id_) {
+        advertising_id_.emplace();
+        auto& id = *advertising_id_;
+        int scanned = sscanf(config_.accessory_id.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
+            &id[0], &id[1], &id[2], &id[3], &id[4], &id[5]);
+        if (scanned != 6) {
+            HAP_LOG_WARNING(config_.system, "[BleTransport] Invalid Device ID format: " + config_.accessory_id);
+        }
+    }
+    return *advertising_id_;
 }
 
 void BleTransport::set_accessory_id(const std::string& new_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     config_.accessory_id = new_id;
-    config_.system->log(platform::System::LogLevel::Info, 
+    setup_hash_.reset();
+    advertising_id_.reset();
+    HAP_LOG_INFO(config_.system,
         "[BleTransport] Accessory ID updated to: " + new_id);
 }
 
 void BleTransport::notify_value_changed(uint64_t aid, uint64_t iid, const core::Value& value, uint32_t exclude_conn_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     handle_characteristic_change(aid, iid, value, exclude_conn_id);
 }
 
+void BleTransport::reset_state_number() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    gsn_.reset();
+}
+
 void BleTransport::increment_gsn() {
     // Per Spec 7.4.6: GSN increments on characteristic changes
     // Range: 1-65535, wraps to 1 on overflow
-    auto gsn_bytes = config_.storage->get("gsn");
-    uint16_t gsn = 1;
-    
-    if (gsn_bytes && gsn_bytes->size() == 2) {
-        gsn = static_cast<uint16_t>((*gsn_bytes)[0]) | (static_cast<uint16_t>((*gsn_bytes)[1]) << 8);
-    }
-    
-    gsn++;
-    if (gsn == 0) {
-        gsn = 1;
-    }
+    uint16_t gsn = gsn_.increment();
     
-    std::vector<uint8_t> gsn_data = {
-        static_cast<uint8_t>(gsn & 0xFF),
-        static_cast<uint8_t>((gsn >> 8) & 0xFF)
-    };
-    config_.storage->set("gsn", gsn_data);
-    
-    config_.system->log(platform::System::LogLevel::Debug, 
+    HAP_LOG_DEBUG(config_.system,
         "[BleTransport] GSN incremented to " + std::to_string(gsn));
     
     update_advertising();
 }
 
 void BleTransport::check_session_timeouts() {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     auto timed_out = session_manager_->check_timeouts();
     
     for (uint16_t conn_id : timed_out) {
-        session_manager_->remove(conn_id);
-        config_.ble->disconnect(conn_id);
-        config_.system->log(platform::System::LogLevel::Info,
-            "[BleTransport] Terminated connection " + std::to_string(conn_id) + " due to timeout");
+        terminate_timed_out(conn_id);
+    }
+}
+
+void BleTransport::terminate_timed_out(uint16_t connection_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    std::erase(ready_connections_, connection_id);
+    session_manager_->remove(connection_id);
+    config_.ble->disconnect(connection_id);
+    HAP_LOG_INFO(config_.system,
+        "[BleTransport] Terminated connection " + std::to_string(connection_id) + " due to timeout");
+}
+
+uint16_t BleTransport::add_gatt_characteristic(uint64_t aid, uint16_t iid, const std::string& uuid) {
+    GattCharacteristic entry;
+    entry.aid = aid;
+    entry.iid = iid;
+    entry.in_database = aid != 0;
+    entry.uuid = uuid;
+    
+    // HAP base UUIDs carry the short type in "0000XXXX-..."
+    if (uuid.size() >= 8) {
+        entry.short_type = static_cast<uint16_t>(std::strtoul(uuid.substr(4, 4).c_str(), nullptr, 16));
     }
+    // Pair Setup, Pair Verify and Pairing Features are used before a session exists
+    entry.requires_encryption = !(entry.short_type == 0x4C || entry.short_type == 0x4E || entry.short_type == 0x4F);
+    
+    uint16_t handle = static_cast<uint16_t>(gatt_chars_.size());
+    gatt_chars_.push_back(std::move(entry));
+    
+    // Keep registration order among equal IIDs so the first registered wins
+    auto pos = std::upper_bound(gatt_handles_by_iid_.begin(), gatt_handles_by_iid_.end(), iid,
+        [this](uint16_t key, uint16_t h) { return key < gatt_chars_[h].iid; });
+    gatt_handles_by_iid_.insert(pos, handle);
+    return handle;
+}
+
+std::optional<uint16_t> BleTransport::find_gatt_handle(uint64_t aid, uint16_t iid) const {
+    auto it = std::lower_bound(gatt_handles_by_iid_.begin(), gatt_handles_by_iid_.end(), iid,
+        [this](uint16_t h, uint16_t key) { return gatt_chars_[h].iid < key; });
+    for (; it != gatt_handles_by_iid_.end() && gatt_chars_[*it].iid == iid; ++it) {
+        const auto& entry = gatt_chars_[*it];
+        if (entry.in_database && entry.aid == aid) {
+            return *it;
+        }
+    }
+    return std::nullopt;
 }
 
-void BleTransport::handle_hap_write_with_id(uint16_t connection_id, std::string uuid, std::span<const uint8_t> data) {
-    config_.system->log(platform::System::LogLevel::Debug, "[BleTransport] Write to Char UUID: " + uuid);
-    handle_hap_write(connection_id, uuid, data);
+bool BleTransport::handle_requires_encryption(uint16_t handle) const {
+    return handle < gatt_chars_.size() ? gatt_chars_[handle].requires_encryption : true;
 }
 
-void BleTransport::handle_hap_write(uint16_t connection_id, const std::string& uuid, std::span<const uint8_t> data) {
+void BleTransport::handle_hap_write(uint16_t connection_id, uint16_t handle, std::span<const uint8_t> data) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (data.empty()) return;
+    common::Metrics::Scope timer(config_.metrics, common::Metric::BlePdu);
     
-    config_.system->log(platform::System::LogLevel::Debug, "[BleTransport] Write PDU Fragment (" + std::to_string(data.size()) + " bytes): " + to_hex_string(data.data(), data.size()));
+    HAP_LOG_DEBUG(config_.system, "[BleTransport] Write PDU Fragment (" + std::to_string(data.size()) + " bytes): " + to_hex_string(data.data(), data.size()));
 
     bool session_is_secured = false;
     auto* session = session_manager_->get_session(connection_id);
@@ -493,45 +694,38 @@ void BleTransport::handle_hap_write(uint16_t connection_id, const std::string& u
         session_is_secured = session->context->is_encrypted();
     }
     
-    bool requires_encryption = true;
-    {
-        if (uuid.size() >= 8) {
-            std::string short_uuid_str = uuid.substr(4, 4);
-            unsigned int short_uuid = 0;
-            if (sscanf(short_uuid_str.c_str(), "%x", &short_uuid) == 1) {
-                if (short_uuid == 0x4C || short_uuid == 0x4E || short_uuid == 0x4F) {
-                    requires_encryption = false;
-                }
-            }
-        }
-    }
+    bool requires_encryption = handle_requires_encryption(handle);
 
-    std::vector<uint8_t> decrypted_data;
     std::span<const uint8_t> working_data = data;
     
     if (session_is_secured && requires_encryption) {
         auto& session_ref = session_manager_->get_or_create(connection_id);
         if (!session_ref.context) {
-            config_.system->log(platform::System::LogLevel::Error,
+            HAP_LOG_ERROR(config_.system,
                 "[BleTransport] Context missing for secured session - disconnecting");
             config_.ble->disconnect(connection_id);
             session_manager_->remove(connection_id);
             return;
         }
-        auto decrypted = session_ref.context->get_secure_session()->decrypt_ble_pdu(data);
+        // Decrypted in place in a buffer reused across writes
+        rx_pdu_.assign(data.begin(), data.end());
+        common::Metrics::Scope decrypt_timer(config_.metrics, common::Metric::Decrypt);
+        auto decrypted = session_ref.context->get_secure_session()->decrypt_ble_pdu_in_place(rx_pdu_);
+        decrypt_timer.stop();
         if (!decrypted) {
-            config_.system->log(platform::System::LogLevel::Error, 
+            common::count(config_.metrics, common::Counter::DecryptFailures);
+            HAP_LOG_ERROR(config_.system,
                 "[BleTransport] Decryption failed for connection " + std::to_string(connection_id) + " - disconnecting");
             // Per HAP Spec 6.5.2.2: Close connection on decryption failure
             config_.ble->disconnect(connection_id);
             session_manager_->remove(connection_id);
             return;
         }
-        decrypted_data = std::move(*decrypted);
-        working_data = decrypted_data;
-        config_.system->log(platform::System::LogLevel::Debug, 
-            "[BleTransport] Decrypted PDU (" + std::to_string(decrypted_data.size()) + " bytes): " + 
-            to_hex_string(decrypted_data.data(), decrypted_data.size()));
+        common::count(config_.metrics, common::Counter::BytesDecrypted, *decrypted);
+        working_data = std::span<const uint8_t>(rx_pdu_).first(*decrypted);
+        HAP_LOG_DEBUG(config_.system,
+            "[BleTransport] Decrypted PDU (" + std::to_string(working_data.size()) + " bytes): " + 
+            to_hex_string(working_data.data(), working_data.size()));
     }
     
     if (working_data.empty()) return;
@@ -542,20 +736,26 @@ void BleTransport::handle_hap_write(uint16_t connection_id, const std::string& u
     
     if (!continuation) {
         if (working_data.size() < 3) {
-            config_.system->log(platform::System::LogLevel::Error, "[BleTransport] PDU too short");
+            HAP_LOG_ERROR(config_.system, "[BleTransport] PDU too short");
             return;
         }
         opcode = static_cast<PDUOpcode>(working_data[1]);
         tid = working_data[2];
         
-        config_.system->log(platform::System::LogLevel::Info, "[BleTransport] New Transaction TID=" + std::to_string(tid) + " Opcode=" + std::to_string((int)opcode));
+        HAP_LOG_DEBUG(config_.system, "[BleTransport] New Transaction TID=" + std::to_string(tid) + " Opcode=" + std::to_string((int)opcode));
         
         auto& state = session_manager_->get_or_create(connection_id).transaction;
+        if (state.ready) {
+            // The controller moved on without reading; finish the queued one first
+            run_ready_transaction(connection_id);
+        }
         state.opcode = opcode;
         state.transaction_id = tid;
-        state.target_uuid = uuid;
+        state.target_handle = handle;
         state.buffer.clear();
+        state.expected_total = 0;
         state.response_buffer.clear();
+        state.response_fragment_ends.clear();
         state.active = true;
         state.last_activity_ms = config_.system->millis();
         state.procedure_start_ms = config_.system->millis();
@@ -564,13 +764,16 @@ void BleTransport::handle_hap_write(uint16_t connection_id, const std::string& u
         if (state.connection_established_ms == 0) {
             state.connection_established_ms = config_.system->millis();
         }
+        session_manager_->arm_timeout(connection_id);
         
-        state.buffer.insert(state.buffer.end(), working_data.begin(), working_data.end());
-        process_transaction(connection_id, state);
+
+        if (append_fragment(state, working_data)) {
+            queue_transaction(connection_id, state);
+        }
     } else {
         auto& state = session_manager_->get_or_create(connection_id).transaction;
         if (!state.active) {
-             config_.system->log(platform::System::LogLevel::Warning, "[BleTransport] Orphaned continuation fragment!");
+             HAP_LOG_WARNING(config_.system, "[BleTransport] Orphaned continuation fragment!");
              return;
         }
         
@@ -579,176 +782,180 @@ void BleTransport::handle_hap_write(uint16_t connection_id, const std::string& u
         if (working_data.size() < 2) return;
         uint16_t cont_tid = working_data[1];
         if (cont_tid != state.transaction_id) {
-            config_.system->log(platform::System::LogLevel::Error, "[BleTransport] TID mismatch in continuation! Expected " + std::to_string(state.transaction_id) + " got " + std::to_string(cont_tid));
+            HAP_LOG_ERROR(config_.system, "[BleTransport] TID mismatch in continuation! Expected " + std::to_string(state.transaction_id) + " got " + std::to_string(cont_tid));
             return;
         }
 
         // Continuation Body starts at index 2 (CF, TID)
-        state.buffer.insert(state.buffer.end(), working_data.begin() + 2, working_data.end());
+        if (append_fragment(state, working_data.subspan(2))) {
+            queue_transaction(connection_id, state);
+        } else if (state.expected_total != 0) {
+            HAP_LOG_DEBUG(config_.system,
+                "[BleTransport] Waiting for more fragments: have " + 
+                std::to_string(state.buffer.size()) + " bytes, need " + 
+                std::to_string(state.expected_total) + " bytes");
+        }
+    }
+}
+
+void BleTransport::queue_transaction(uint16_t connection_id, TransactionState& state) {
+    if (!config_.scheduler) {
         process_transaction(connection_id, state);
+        return;
+    }
+    
+    state.ready = true;
+    ready_connections_.push_back(connection_id);
+    if (transaction_task_ == common::TaskScheduler::INVALID_TASK_ID) {
+        transaction_task_ = config_.scheduler->schedule_once(0, [this]() {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            transaction_task_ = common::TaskScheduler::INVALID_TASK_ID;
+            drain_transactions();
+        });
+    }
+}
+
+void BleTransport::drain_transactions() {
+    // One transaction per connection per pass, in the order they became
+    // ready; anything queued meanwhile waits for the next pass
+    size_t pass = ready_connections_.size();
+    for (size_t i = 0; i < pass && !ready_connections_.empty(); ++i) {
+        uint16_t connection_id = ready_connections_.front();
+        ready_connections_.pop_front();
+        run_ready_transaction(connection_id);
+    }
+    
+    if (!ready_connections_.empty() && transaction_task_ == common::TaskScheduler::INVALID_TASK_ID) {
+        transaction_task_ = config_.scheduler->schedule_once(0, [this]() {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            transaction_task_ = common::TaskScheduler::INVALID_TASK_ID;
+            drain_transactions();
+        });
+    }
+}
+
+bool BleTransport::run_ready_transaction(uint16_t connection_id) {
+    auto* session = session_manager_->get_session(connection_id);
+    if (!session || !session->transaction.ready) {
+        return false;
     }
+    session->transaction.ready = false;
+    std::erase(ready_connections_, connection_id);
+    process_transaction(connection_id, session->transaction);
+    return true;
 }
 
 std::vector<uint8_t> BleTransport::handle_hap_read(uint16_t connection_id) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
     auto* session = session_manager_->get_session(connection_id);
     if (session) {
         auto& state = session->transaction;
         
+        // The controller reads as soon as its write is acknowledged; answer
+        // it now rather than waiting for the scheduler to get to it
+        if (state.ready) {
+            run_ready_transaction(connection_id);
+        }
+        
         if (state.last_write_ms > 0) {
             uint64_t current_time = config_.system->millis();
             uint64_t time_since_write = current_time - state.last_write_ms;
             
             if (time_since_write > 10000) { // 10 seconds
-                config_.system->log(platform::System::LogLevel::Warning,
+                HAP_LOG_WARNING(config_.system,
                     "[BleTransport] Rejecting GATT Read - >10s since write (Req #12)");
                 return {};
             }
         }
         
-        config_.system->log(platform::System::LogLevel::Info, 
-            "[BleTransport] Handling GATT Read. Returning " + 
-            std::to_string(state.response_buffer.size()) + " bytes");
-        return state.response_buffer;
+        if (state.response_fragment_ends.empty()) {
+            HAP_LOG_DEBUG(config_.system,
+                "[BleTransport] Handling GATT Read. Returning " + 
+                std::to_string(state.response_buffer.size()) + " bytes");
+            return state.response_buffer;
+        }
+        
+        // One fragment per GATT Read; the last one is repeated if read again
+        size_t index = state.response_fragment;
+        size_t begin = index == 0 ? 0 : state.response_fragment_ends[index - 1];
+        size_t end = state.response_fragment_ends[index];
+        if (state.response_fragment + 1 < state.response_fragment_ends.size()) {
+            ++state.response_fragment;
+        }
+        
+        HAP_LOG_DEBUG(config_.system,
+            "[BleTransport] Handling GATT Read. Returning fragment " + std::to_string(index + 1) + "/" +
+            std::to_string(state.response_fragment_ends.size()) + " (" + std::to_string(end - begin) + " bytes)");
+        return std::vector<uint8_t>(state.response_buffer.begin() + begin, state.response_buffer.begin() + end);
     }
     return {};
 }
 
 void BleTransport::process_transaction(uint16_t connection_id, TransactionState& state) {
-    // Header is 5 bytes: CF(1) | Opcode(1) | TID(1) | IID(2)
-    if (state.buffer.size() < 5) return; 
-    
+    // Called once append_fragment() has the whole PDU; the header is already decoded
     PDUOpcode opcode = state.opcode;
     
-    // For Write operations (opcode 0x02, 0x04), the header is 7 bytes:
-    // CF(1) | Opcode(1) | TID(1) | IID(2) | BodyLen(2) | Body...
-    if (ble::HapPdu::opcode_has_body(opcode)) {
-        
-        if (state.buffer.size() < 7) return;
-        
-        uint16_t body_length = state.buffer[5] | (static_cast<uint16_t>(state.buffer[6]) << 8);
-        state.expected_body_length = body_length;
-        
-        size_t expected_total = 7 + body_length;
-        
-        if (state.buffer.size() < expected_total) {
-            config_.system->log(platform::System::LogLevel::Debug, 
-                "[BleTransport] Waiting for more fragments: have " + 
-                std::to_string(state.buffer.size()) + " bytes, need " + 
-                std::to_string(expected_total) + " bytes");
-            return;
-        }
-        
-        config_.system->log(platform::System::LogLevel::Debug, 
-            "[BleTransport] All fragments received: " + 
-            std::to_string(state.buffer.size()) + " bytes (body=" + 
-            std::to_string(body_length) + ")");
-    }
+    HAP_LOG_DEBUG(config_.system,
+        "[BleTransport] All fragments received: " + 
+        std::to_string(state.buffer.size()) + " bytes (body=" + 
+        std::to_string(state.expected_body_length) + ")");
     
     uint16_t tid = state.buffer[2];
     uint16_t iid = state.buffer[3] | (state.buffer[4] << 8);
 
-    config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Processing Opcode " + std::to_string((int)opcode) + " TID=" + std::to_string(tid));
+    HAP_LOG_DEBUG(config_.system, "[BleTransport] Processing Opcode " + std::to_string((int)opcode) + " TID=" + std::to_string(tid));
     
-    std::unique_ptr<core::CharacteristicFinder> finder;
-    if (config_.database) {
-        finder = std::make_unique<core::CharacteristicFinder>(*config_.database);
-    }
-    
-    auto find_service = [&](uint16_t target_iid) -> std::shared_ptr<core::Service> {
-        return finder ? finder->service_by_iid(target_iid) : nullptr;
-    };
+    // Index built by start() and kept current by on_database_changed();
+    // PDUs never construct or rebuild it
+    const core::CharacteristicFinder* finder = finder_.get();
     
-    auto find_char_in_db = [&](uint16_t target_iid) -> std::shared_ptr<core::Characteristic> {
-        return finder ? finder->by_iid(target_iid) : nullptr;
+    auto find_char_in_db = [&](uint16_t target_iid) -> core::Characteristic* {
+        const auto* info = finder ? finder->lookup(target_iid) : nullptr;
+        return info ? info->characteristic.get() : nullptr;
     };
     
-    // Helper to get full characteristic info including AID
-    auto find_char_info = [&](uint16_t target_iid) -> core::CharacteristicFinder::CharacteristicInfo {
-        if (finder) {
-            return finder->find_info(target_iid);
-        }
-        return {};
-    };
 
     if (opcode == PDUOpcode::ServiceSignatureRead) {
         state.active = false;
         state.procedure_start_ms = 0;
         
-        std::vector<uint8_t> sig_response;
-        bool is_primary = false;
-        bool found = false;
-        std::vector<uint16_t> linked_services;
-
-        for (const auto& [cid, meta] : pairing_char_metadata_) {
-            if (meta.service_id == iid) {
-                is_primary = true;
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
-            auto svc = find_service(iid);
-            if (svc) {
-                is_primary = svc->is_primary();
-                found = true;
-                for (uint64_t linked_iid : svc->linked_services()) {
-                    linked_services.push_back(static_cast<uint16_t>(linked_iid));
-                }
-            }
-        }
-
         // Per Spec 7.3.4.13: If invalid Service IID, return props=0 and linked=0 length
-        if (!found) {
-            config_.system->log(platform::System::LogLevel::Warning, 
+        static constexpr uint8_t kNotFound[] = {
+            static_cast<uint8_t>(HAPBLEPDUTLVType::ServiceProperties), 0x02, 0x00, 0x00,
+            static_cast<uint8_t>(HAPBLEPDUTLVType::LinkedServices), 0x00};
+        
+        auto signature = service_signatures_.find(iid);
+        if (!signature) {
+            HAP_LOG_WARNING(config_.system,
                 "[BleTransport] Service Signature Read IID=" + std::to_string(iid) + " Not Found - returning empty");
-            // Return empty response with props=0
-            BleTlvBuilder builder;
-            builder.add_uint16(HAPBLEPDUTLVType::ServiceProperties, 0);
-            auto tlv = builder.build();
-            sig_response.insert(sig_response.end(), tlv.begin(), tlv.end());
-            
-            sig_response.push_back(static_cast<uint8_t>(HAPBLEPDUTLVType::LinkedServices));
-            sig_response.push_back(0x00);
+            signature = std::span<const uint8_t>(kNotFound);
         } else {
-            uint16_t props = is_primary ? 0x0001 : 0x0000;
-            
-            BleTlvBuilder builder;
-            builder.add_uint16(HAPBLEPDUTLVType::ServiceProperties, props);
-            auto tlv = builder.build();
-            sig_response.insert(sig_response.end(), tlv.begin(), tlv.end());
-            
-            sig_response.push_back(static_cast<uint8_t>(HAPBLEPDUTLVType::LinkedServices));
-            sig_response.push_back(static_cast<uint8_t>(linked_services.size() * 2));
-            for (uint16_t linked_iid : linked_services) {
-                sig_response.push_back(linked_iid & 0xFF);
-                sig_response.push_back((linked_iid >> 8) & 0xFF);
-            }
-            
-            config_.system->log(platform::System::LogLevel::Info, 
+            HAP_LOG_DEBUG(config_.system,
                 "[BleTransport] Service Signature Read IID=" + std::to_string(iid) + 
-                " Primary=" + std::to_string(is_primary));
+                " Len=" + std::to_string(signature->size()));
         }
         
-        send_response(connection_id, state.transaction_id, state.target_uuid, 0x00, sig_response);
+        send_response(connection_id, state.transaction_id, state.target_handle, 0x00, *signature);
         return;
     }
     
     if (opcode == PDUOpcode::CharacteristicSignatureRead) {
         state.active = false; 
         
-        std::vector<uint8_t> sig_response = process_signature_read(connection_id, iid);
+        auto signature = char_signatures_.find(iid);
         
         uint8_t status = 0x00;
-        if (sig_response.empty()) {
-             config_.system->log(platform::System::LogLevel::Warning, "[BleTransport] Char Signature Read IID=" + std::to_string(iid) + " Not Found");
+        std::span<const uint8_t> sig_response;
+        if (!signature) {
+             HAP_LOG_WARNING(config_.system, "[BleTransport] Char Signature Read IID=" + std::to_string(iid) + " Not Found");
              status = 0x05; // Invalid Request (Attribute Not Found)
         } else {
-             config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Char Signature Read IID=" + std::to_string(iid) + " Len=" + std::to_string(sig_response.size()));
-             config_.system->log(platform::System::LogLevel::Debug, "[BleTransport] Signature Response: " + to_hex_string(sig_response.data(), sig_response.size()));
+             sig_response = *signature;
+             HAP_LOG_DEBUG(config_.system, "[BleTransport] Char Signature Read IID=" + std::to_string(iid) + " Len=" + std::to_string(sig_response.size()));
+             HAP_LOG_DEBUG(config_.system, "[BleTransport] Signature Response: " + to_hex_string(sig_response.data(), sig_response.size()));
         }
         
-        send_response(connection_id, state.transaction_id, state.target_uuid, status, sig_response);
+        send_response(connection_id, state.transaction_id, state.target_handle, status, sig_response);
         return;
     }
 
@@ -773,7 +980,7 @@ void BleTransport::process_transaction(uint16_t connection_id, TransactionState&
         if (meta_it != pairing_char_metadata_.end()) {
             if (meta_it->second.char_type == 0x4F) { // Pairing Features
                 value_bytes = {0x01, 0x01, 0x00};
-                config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Pairing Features Read: returning 0x00");
+                HAP_LOG_DEBUG(config_.system, "[BleTransport] Pairing Features Read: returning 0x00");
             } else if (meta_it->second.char_type == 0x37) { // Version
                 // HAP Spec 7.4.4.5.2: Version characteristic returns protocol version string
                 // Format: "major.minor.revision" e.g., "1.1.0"
@@ -782,381 +989,79 @@ void BleTransport::process_transaction(uint16_t connection_id, TransactionState&
                 value_bytes.push_back(0x01); // TLV Type: HAP-Param-Value
                 value_bytes.push_back(static_cast<uint8_t>(version.size())); // Length
                 value_bytes.insert(value_bytes.end(), version.begin(), version.end()); // Value
-                config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Version Read: returning " + version);
+                HAP_LOG_DEBUG(config_.system, "[BleTransport] Version Read: returning " + version);
             } else {
                 status = 0x05; // Invalid Request
             }
         } 
         else {
-            auto ch = find_char_in_db(iid);
-            if (ch) {
-                auto read_result = ch->get_value();
-                if (std::holds_alternative<core::HAPStatus>(read_result)) {
-                    // Read callback returned error
-                    status = 0x02; // HAP Error (map HAPStatus to BLE status)
-                    config_.system->log(platform::System::LogLevel::Warning, 
-                        "[BleTransport] Read IID=" + std::to_string(iid) + " callback returned error");
-                } else {
-                    auto raw_value = core::CharacteristicSerializer::to_bytes(std::get<core::Value>(read_result));
-                    value_bytes.push_back(0x01); // Type: HAP-Param-Value
-                    value_bytes.push_back(static_cast<uint8_t>(raw_value.size()));
-                    value_bytes.insert(value_bytes.end(), raw_value.begin(), raw_value.end());
-                }
+            core::Value scratch;
+            auto outcome = CharacteristicOps::read(find_char_in_db(iid), scratch);
+            status = CharacteristicOps::to_ble_status(outcome.status);
+            if (outcome.value) {
+                auto raw_value = core::CharacteristicSerializer::to_bytes(*outcome.value);
+                value_bytes.push_back(0x01); // Type: HAP-Param-Value
+                value_bytes.push_back(static_cast<uint8_t>(raw_value.size()));
+                value_bytes.insert(value_bytes.end(), raw_value.begin(), raw_value.end());
             } else {
-                status = 0x05; // Invalid Request (Attribute Not Found)
-                config_.system->log(platform::System::LogLevel::Warning, "[BleTransport] Read IID=" + std::to_string(iid) + " Not Found");
+                HAP_LOG_WARNING(config_.system,
+                    "[BleTransport] Read IID=" + std::to_string(iid) + " failed with status " +
+                    std::to_string(core::to_int(outcome.status)));
             }
         }
         
-        send_response(connection_id, state.transaction_id, state.target_uuid, status, value_bytes);
+        send_response(connection_id, state.transaction_id, state.target_handle, status, value_bytes);
     }
     else if (opcode == PDUOpcode::CharacteristicWrite) {
-        uint8_t status = 0x00;
         std::vector<uint8_t> response_body;
-
+        uint8_t status;
         auto meta_it = pairing_char_metadata_.find(iid);
         if (meta_it != pairing_char_metadata_.end()) {
-             uint8_t type = meta_it->second.char_type;
-             
-             auto& session = session_manager_->get_or_create(connection_id);
-             if (!session.context) {
-                session.context = std::make_unique<ConnectionContext>(config_.crypto, config_.system, connection_id);
-             }
-             auto& ctx = *session.context;
-             
-             // HAP-BLE Pair Setup/Verify are "Write-with-Response" (Spec 7.3.5.5)
-             // The body is a LIST of TLVs:
-             // - kTLVType_ReturnResponse (0x09): (Empty implies request response)
-             // - kTLVType_Value (0x01): The actual SRP payload (M1, M3, etc)
-             
-             std::vector<uint8_t> inner_body;
-             bool return_response_requested = false;
-
-             // Only parse as BLE TLVs for Pairing Services (Setup 4C, Verify 4E, Pairings 50)
-             if (type == 0x4C || type == 0x4E || type == 0x50) {
-                 auto ble_tlvs = core::TLV8::parse(std::vector<uint8_t>(body.begin(), body.end()));
-                 
-                 // Check for Return-Response (0x09)
-                 if (core::TLV8::find(ble_tlvs, (uint8_t)HAPBLEPDUTLVType::ReturnResponse)) {
-                     return_response_requested = true;
-                 }
-                 
-                 // Extract Value (0x01)
-                 auto val = core::TLV8::find(ble_tlvs, 0x01); // 0x01 = Param-Value
-                 if (val) {
-                     inner_body.assign(val->begin(), val->end());
-                 } else {
-                     config_.system->log(platform::System::LogLevel::Warning, "[BleTransport] Warning: Pairing Write missing Value TLV wrapper. Using raw body.");
-                     inner_body.assign(body.begin(), body.end());
-                 }
-             } else {
-                inner_body.assign(body.begin(), body.end());
-             }
-
-             Request req;
-             req.body = std::move(inner_body);
-             req.method = Method::POST;
-             
-             Response resp;
-             if (type == 0x4C) { // Pair Setup
-                req.path = "/pair-setup";
-                resp = config_.pairing_endpoints->handle_pair_setup(req, ctx);
-             } else if (type == 0x4E) { // Pair Verify
-                req.path = "/pair-verify";
-                resp = config_.pairing_endpoints->handle_pair_verify(req, ctx);
-             } else if (type == 0x50) { // Pairings
-                req.path = "/pairings";
-                resp = config_.pairing_endpoints->handle_pairings(req, ctx);
-             } else if (type == 0xA5) { // Service Signature
-                config_.system->log(platform::System::LogLevel::Info, "[BleTransport] Software Auth Write - Skipping (Success)");
-                resp = Response{Status::OK}; 
-             }
-             
-             status = (resp.status == Status::OK) ? 0x00 : 0x02;
-
-             // If Return-Response was requested, we MUST wrap the response body in Result TLVs
-             // TlV 0x01 (Value) -> Response Body
-             if (return_response_requested && !resp.body.empty()) {
-                 std::vector<core::TLV> resp_tlvs;
-                 resp_tlvs.emplace_back(0x01, resp.body); // 0x01 = Param-Value
-                 response_body = core::TLV8::encode(resp_tlvs);
-             } else {
-                 response_body = resp.body;
-             }
-        }
-        else {
-             auto ch = find_char_in_db(iid);
-             if (ch) {
-                 auto body_tlvs = core::TLV8::parse(std::vector<uint8_t>(body.begin(), body.end()));
-                 
-                 bool return_response_requested = core::TLV8::find(body_tlvs, (uint8_t)HAPBLEPDUTLVType::ReturnResponse).has_value();
-                 
-                 auto value_tlv = core::TLV8::find(body_tlvs, 0x01);
-                 if (value_tlv && !value_tlv->empty()) {
-                     core::Value new_value;
-                     switch (ch->format()) {
-                         case core::Format::Bool:
-                             new_value = static_cast<bool>((*value_tlv)[0] != 0);
-                             break;
-                         case core::Format::UInt8:
-                             new_value = (*value_tlv)[0];
-                             break;
-                         case core::Format::UInt16:
-                             if (value_tlv->size() >= 2) {
-                                 new_value = static_cast<uint16_t>((*value_tlv)[0] | ((*value_tlv)[1] << 8));
-                             }
-                             break;
-                         case core::Format::UInt32:
-                             if (value_tlv->size() >= 4) {
-                                 new_value = static_cast<uint32_t>(
-                                     (*value_tlv)[0] | ((*value_tlv)[1] << 8) |
-                                     ((*value_tlv)[2] << 16) | ((*value_tlv)[3] << 24));
-                             }
-                             break;
-                         case core::Format::Int:
-                             if (value_tlv->size() >= 4) {
-                                 new_value = static_cast<int32_t>(
-                                     (*value_tlv)[0] | ((*value_tlv)[1] << 8) |
-                                     ((*value_tlv)[2] << 16) | ((*value_tlv)[3] << 24));
-                             }
-                             break;
-                         case core::Format::Float:
-                            if (value_tlv->size() >= 4) {
-                                uint32_t raw = (*value_tlv)[0] | ((*value_tlv)[1] << 8) |
-                                            ((*value_tlv)[2] << 16) | ((*value_tlv)[3] << 24);
-                                float f;
-                                std::memcpy(&f, &raw, sizeof(f));
-                                new_value = f;
-                            }
-                            break;
-                         case core::Format::String:
-                            new_value = std::string(value_tlv->begin(), value_tlv->end());
-                            break;
-                         case core::Format::TLV8:
-                         case core::Format::Data:
-                            new_value = std::vector<uint8_t>(value_tlv->begin(), value_tlv->end());
-                            break;
-                         default:
-                            break;
-                     }
-                     
-                     ch->set_value(new_value, core::EventSource::from_connection(connection_id));
-                     config_.system->log(platform::System::LogLevel::Info, 
-                         "[BleTransport] Write IID=" + std::to_string(iid) + " success");
-                     
-                     // Per HAP Spec 7.4.1.8: GSN increments on first characteristic change per connection
-                     if (!state.gsn_incremented) {
-                         state.gsn_incremented = true;
-                         increment_gsn();
-                     }
-                     
-                     // HAP Spec 7.3.5.5: Write-with-Response - return value if requested
-                     if (return_response_requested && 
-                         core::has_permission(ch->permissions(), core::Permission::WriteResponse)) {
-                         auto response_opt = ch->handle_write_response(new_value);
-                         core::Value val_to_send;
-                         
-                         if (response_opt.has_value()) {
-                             auto& response = *response_opt;
-                             if (std::holds_alternative<core::HAPStatus>(response)) {
-                                 // WriteResponse callback returned error - still send status
-                                 status = 0x02; // HAP Error
-                                 config_.system->log(platform::System::LogLevel::Warning,
-                                     "[BleTransport] WriteResponse IID=" + std::to_string(iid) + " callback returned error");
-                             } else {
-                                 val_to_send = std::get<core::Value>(response);
-                             }
-                         } else {
-                             // No callback, use current value
-                             auto read_result = ch->get_value();
-                             if (std::holds_alternative<core::Value>(read_result)) {
-                                 val_to_send = std::get<core::Value>(read_result);
-                             }
-                         }
-                         
-                         if (status == 0x00) {
-                             auto raw_bytes = core::CharacteristicSerializer::to_bytes(val_to_send);
-                             std::vector<core::TLV> resp_tlvs;
-                             resp_tlvs.emplace_back(0x01, raw_bytes); // HAP-Param-Value
-                             response_body = core::TLV8::encode(resp_tlvs);
-                             
-                             config_.system->log(platform::System::LogLevel::Info, 
-                                 "[BleTransport] Write-Response IID=" + std::to_string(iid) + 
-                                 " returning " + std::to_string(response_body.size()) + " bytes");
-                         }
-                     }
-                     
-                     // Get actual AID for this characteristic
-                     auto char_info = find_char_info(iid);
-                     handle_characteristic_change(char_info.accessory_id, iid, new_value, connection_id);
-                 } else {
-                     config_.system->log(platform::System::LogLevel::Warning, 
-                         "[BleTransport] Write IID=" + std::to_string(iid) + " - no value TLV found");
-                     status = 0x06; // Invalid Request
-                 }
-             } else {
-                 status = 0x05; // Not Found
-             }
+            status = write_pairing_characteristic(connection_id, meta_it->second.char_type, body, response_body);
+        } else {
+            status = write_characteristic(connection_id, state, iid, body, false, response_body);
         }
-        
-        send_response(connection_id, state.transaction_id, state.target_uuid, status, response_body);
+        send_response(connection_id, state.transaction_id, state.target_handle, status, response_body);
     }
     else if (opcode == PDUOpcode::CharacteristicTimedWrite) {
-        state.timed_write_body.assign(body.begin(), body.end());
-        state.timed_write_iid = iid;
-        state.target_uuid = state.target_uuid;
+        // TTL is in units of 100 ms (Spec 7.3.5.4); without one the write
+        // lives as long as a HAP procedure
+        uint64_t ttl_ms = 10000;
+        auto tlvs = core::TLV8::parse(body);
+        if (auto ttl = core::TLV8::find(tlvs, static_cast<uint8_t>(HAPBLEPDUTLVType::TTL)); ttl && !ttl->empty()) {
+            ttl_ms = static_cast<uint64_t>((*ttl)[0]) * 100;
+        }
+        state.timed_writes.prepare(iid, config_.system->millis() + ttl_ms,
+                                   std::vector<uint8_t>(body.begin(), body.end()));
+        session_manager_->arm_timeout(connection_id);
         
-        config_.system->log(platform::System::LogLevel::Info,
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Timed Write stored for IID=" + std::to_string(iid) + 
-            " Body size=" + std::to_string(body.size()));
+            " Body size=" + std::to_string(body.size()) + " TTL=" + std::to_string(ttl_ms) + "ms");
         
-        send_response(connection_id, state.transaction_id, state.target_uuid, 0x00, {});
+        send_response(connection_id, state.transaction_id, state.target_handle, 0x00, {});
     }
     else if (opcode == PDUOpcode::CharacteristicExecuteWrite) {
         uint8_t status = 0x00;
         std::vector<uint8_t> response_body;
         
-        if (state.timed_write_body.empty()) {
-            config_.system->log(platform::System::LogLevel::Warning,
-                "[BleTransport] Execute Write with no pending timed write");
+        auto pending = state.timed_writes.take(iid, config_.system->millis());
+        if (!pending) {
+            HAP_LOG_WARNING(config_.system,
+                "[BleTransport] Execute Write with no pending timed write for IID=" + std::to_string(iid));
             status = 0x06; // Invalid Request
         } else {
-            config_.system->log(platform::System::LogLevel::Info,
-                "[BleTransport] Executing pending timed write for IID=" + std::to_string(state.timed_write_iid));
-            
-            auto meta_it = pairing_char_metadata_.find(state.timed_write_iid);
+            HAP_LOG_INFO(config_.system,
+                "[BleTransport] Executing pending timed write for IID=" + std::to_string(iid));
+            auto meta_it = pairing_char_metadata_.find(iid);
             if (meta_it != pairing_char_metadata_.end()) {
-                uint8_t type = meta_it->second.char_type;
-                
-                auto& session = session_manager_->get_or_create(connection_id);
-                if (!session.context) {
-                    session.context = std::make_unique<ConnectionContext>(config_.crypto, config_.system, connection_id);
-                }
-                auto& ctx = *session.context;
-                
-                std::vector<uint8_t> inner_body;
-                bool return_response_requested = false;
-                
-                // Parse BLE TLVs for Pairing characteristics
-                if (type == 0x4C || type == 0x4E || type == 0x50) {
-                    auto ble_tlvs = core::TLV8::parse(state.timed_write_body);
-                    
-                    if (core::TLV8::find(ble_tlvs, (uint8_t)HAPBLEPDUTLVType::ReturnResponse)) {
-                        return_response_requested = true;
-                    }
-                    
-                    auto val = core::TLV8::find(ble_tlvs, 0x01);
-                    if (val) {
-                        inner_body.assign(val->begin(), val->end());
-                    } else {
-                        inner_body = state.timed_write_body;
-                    }
-                } else {
-                    inner_body = state.timed_write_body;
-                }
-                
-                Request req;
-                req.body = std::move(inner_body);
-                req.method = Method::POST;
-                
-                Response resp;
-                if (type == 0x4C) {
-                    req.path = "/pair-setup";
-                    resp = config_.pairing_endpoints->handle_pair_setup(req, ctx);
-                } else if (type == 0x4E) {
-                    req.path = "/pair-verify";
-                    resp = config_.pairing_endpoints->handle_pair_verify(req, ctx);
-                } else if (type == 0x50) {
-                    req.path = "/pairings";
-                    resp = config_.pairing_endpoints->handle_pairings(req, ctx);
-                }
-                
-                status = (resp.status == Status::OK) ? 0x00 : 0x02;
-                
-                if (return_response_requested && !resp.body.empty()) {
-                    std::vector<core::TLV> resp_tlvs;
-                    resp_tlvs.emplace_back(0x01, resp.body);
-                    response_body = core::TLV8::encode(resp_tlvs);
-                } else {
-                    response_body = resp.body;
-                }
+                status = write_pairing_characteristic(connection_id, meta_it->second.char_type, *pending, response_body);
             } else {
-                auto ch = find_char_in_db(state.timed_write_iid);
-                if (ch) {
-                    auto body_tlvs = core::TLV8::parse(state.timed_write_body);
-                    auto value_tlv = core::TLV8::find(body_tlvs, 0x01);
-                    if (value_tlv && !value_tlv->empty()) {
-                        core::Value new_value;
-                        switch (ch->format()) {
-                            case core::Format::Bool:
-                                new_value = static_cast<bool>((*value_tlv)[0] != 0);
-                                break;
-                            case core::Format::UInt8:
-                                new_value = (*value_tlv)[0];
-                                break;
-                            case core::Format::UInt16:
-                                if (value_tlv->size() >= 2) {
-                                    new_value = static_cast<uint16_t>((*value_tlv)[0] | ((*value_tlv)[1] << 8));
-                                }
-                                break;
-                            case core::Format::UInt32:
-                                if (value_tlv->size() >= 4) {
-                                    new_value = static_cast<uint32_t>(
-                                        (*value_tlv)[0] | ((*value_tlv)[1] << 8) |
-                                        ((*value_tlv)[2] << 16) | ((*value_tlv)[3] << 24));
-                                }
-                                break;
-                            case core::Format::Int:
-                                if (value_tlv->size() >= 4) {
-                                    new_value = static_cast<int32_t>(
-                                        (*value_tlv)[0] | ((*value_tlv)[1] << 8) |
-                                        ((*value_tlv)[2] << 16) | ((*value_tlv)[3] << 24));
-                                }
-                                break;
-                            case core::Format::Float:
-                                if (value_tlv->size() >= 4) {
-                                    uint32_t raw = (*value_tlv)[0] | ((*value_tlv)[1] << 8) |
-                                                ((*value_tlv)[2] << 16) | ((*value_tlv)[3] << 24);
-                                    float f;
-                                    std::memcpy(&f, &raw, sizeof(f));
-                                    new_value = f;
-                                }
-                                break;
-                            case core::Format::String:
-                                new_value = std::string(value_tlv->begin(), value_tlv->end());
-                                break;
-                            default:
-                                break;
-                        }
-                        
-                        // Pass EventSource so the originating connection is excluded from notifications
-                        ch->set_value(new_value, core::EventSource::from_connection(connection_id));
-                        config_.system->log(platform::System::LogLevel::Info, 
-                            "[BleTransport] Execute Timed Write IID=" + std::to_string(state.timed_write_iid) + " success");
-                        
-                        // Per HAP Spec 7.4.1.8: GSN increments on first characteristic change per connection
-                        if (!state.gsn_incremented) {
-                            state.gsn_incremented = true;
-                            increment_gsn();
-                        }
-                        
-                    } else {
-                        config_.system->log(platform::System::LogLevel::Warning, 
-                            "[BleTransport] Execute Timed Write IID=" + std::to_string(state.timed_write_iid) + " - no value TLV found");
-                        status = 0x06; // Invalid Request
-                    }
-                } else {
-                    config_.system->log(platform::System::LogLevel::Warning, 
-                        "[BleTransport] Execute Timed Write IID=" + std::to_string(state.timed_write_iid) + " - characteristic not found");
-                    status = 0x05; // Not Found
-                }
+                status = write_characteristic(connection_id, state, iid, *pending, true, response_body);
             }
-            
-            state.timed_write_body.clear();
-            state.timed_write_iid = 0;
         }
         
-        send_response(connection_id, state.transaction_id, state.target_uuid, status, response_body);
+        send_response(connection_id, state.transaction_id, state.target_handle, status, response_body);
     }
     else if (opcode == PDUOpcode::CharacteristicConfiguration) {
         // HAP-Characteristic-Configuration-Request/Response
@@ -1201,12 +1106,12 @@ void BleTransport::process_transaction(uint16_t connection_id, TransactionState&
         bool broadcast_enabled = (properties & 0x0001) != 0;
         broadcast_configs_[iid] = BroadcastConfig{iid, broadcast_interval, broadcast_enabled};
         
-        config_.system->log(platform::System::LogLevel::Info,
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Characteristic Configuration IID=" + std::to_string(iid) +
             " Props=" + std::to_string(properties) + " Interval=" + std::to_string(broadcast_interval) +
             " BroadcastEnabled=" + std::to_string(broadcast_enabled));
         
-        send_response(connection_id, state.transaction_id, state.target_uuid, status, response_body);
+        send_response(connection_id, state.transaction_id, state.target_handle, status, response_body);
     }
     else if (opcode == PDUOpcode::ProtocolConfiguration) {
         // HAP-Protocol-Configuration-Request/Response
@@ -1230,22 +1135,24 @@ void BleTransport::process_transaction(uint16_t connection_id, TransactionState&
             //     Info = "Broadcast-Encryption-Key",
             //     L = 32 bytes
             // )
-            config_.system->log(platform::System::LogLevel::Info,
+            HAP_LOG_INFO(config_.system,
                 "[BleTransport] Protocol Config: Generate Broadcast Encryption Key requested");
             
             auto* session = session_manager_->get_session(connection_id);
             if (!session || !session->context || !session->context->is_encrypted()) {
-                config_.system->log(platform::System::LogLevel::Error,
+                HAP_LOG_ERROR(config_.system,
                     "[BleTransport] Protocol Config: Cannot generate key - no secure session");
                 status = 0x06; // Invalid Request
             } else {
                 auto& ctx = *session->context;
                 
-                std::string pairing_key = "pairing_" + ctx.controller_id();
-                auto controller_ltpk = config_.storage->get(pairing_key);
+                std::optional<pairing::PairingStore::Pairing> controller;
+                if (config_.pairing_store) {
+                    controller = config_.pairing_store->find(ctx.controller_id());
+                }
                 
-                if (!controller_ltpk || controller_ltpk->size() != 32) {
-                    config_.system->log(platform::System::LogLevel::Error,
+                if (!controller) {
+                    HAP_LOG_ERROR(config_.system,
                         "[BleTransport] Protocol Config: Controller LTPK not found for: " + ctx.controller_id());
                     status = 0x06; // Invalid Request
                 } else {
@@ -1253,31 +1160,26 @@ void BleTransport::process_transaction(uint16_t connection_id, TransactionState&
                     std::array<uint8_t, 32> broadcast_key;
                     config_.crypto->hkdf_sha512(
                         ctx.session_shared_secret(),                                         // IKM: Session shared secret
-                        std::span<const uint8_t>(controller_ltpk->data(), 32),              // Salt: Controller LTPK
+                        std::span<const uint8_t>(controller->ltpk),                        // Salt: Controller LTPK
                         std::span(reinterpret_cast<const uint8_t*>("Broadcast-Encryption-Key"), 24), // Info
                         broadcast_key                                                        // Output: 32 bytes
                     );
                     
-                    std::copy(broadcast_key.begin(), broadcast_key.end(), broadcast_key_.begin());
-                    broadcast_key_valid_ = true;
-                    broadcast_key_gsn_start_ = get_current_gsn();
+                    broadcast_key_.key = broadcast_key;
+                    broadcast_key_.valid = true;
+                    broadcast_key_.gsn_start = get_current_gsn();
                     
                     resp_tlvs.emplace_back(0x04, std::vector<uint8_t>(broadcast_key.begin(), broadcast_key.end()));
                     
-                    config_.system->log(platform::System::LogLevel::Info,
+                    HAP_LOG_INFO(config_.system,
                         "[BleTransport] Protocol Config: Generated and stored Broadcast Encryption Key (GSN start=" + 
-                        std::to_string(broadcast_key_gsn_start_) + ")");
+                        std::to_string(broadcast_key_.gsn_start) + ")");
                 }
             }
         }
         
         if (get_all_tlv || true) {
-            uint16_t gsn = 1;
-            auto gsn_bytes = config_.storage->get("gsn");
-            if (gsn_bytes && gsn_bytes->size() == 2) {
-                gsn = static_cast<uint16_t>((*gsn_bytes)[0]) | 
-                     (static_cast<uint16_t>((*gsn_bytes)[1]) << 8);
-            }
+            uint16_t gsn = gsn_.current();
             
             // State Number TLV (0x01)
             std::vector<uint8_t> state_data = {
@@ -1293,74 +1195,114 @@ void BleTransport::process_transaction(uint16_t connection_id, TransactionState&
             
             // Accessory Advertising Identifier TLV (0x03) - 6 bytes
             // Use Device ID as advertising identifier
-            uint8_t device_id[6] = {0};
-            sscanf(config_.accessory_id.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
-                &device_id[0], &device_id[1], &device_id[2], 
-                &device_id[3], &device_id[4], &device_id[5]);
-            resp_tlvs.emplace_back(0x03, std::vector<uint8_t>(device_id, device_id + 6));
+            const auto& device_id = advertising_id();
+            resp_tlvs.emplace_back(0x03, std::vector<uint8_t>(device_id.begin(), device_id.end()));
         }
         
         response_body = core::TLV8::encode(resp_tlvs);
         
-        config_.system->log(platform::System::LogLevel::Info,
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Protocol Configuration completed");
         
-        send_response(connection_id, state.transaction_id, state.target_uuid, status, response_body);
+        send_response(connection_id, state.transaction_id, state.target_handle, status, response_body);
     }
     else if (opcode == PDUOpcode::ServiceSignatureRead) {
-        send_response(connection_id, state.transaction_id, state.target_uuid, 0x00, {});
+        send_response(connection_id, state.transaction_id, state.target_handle, 0x00, {});
     }
     else {
-        send_response(connection_id, state.transaction_id, state.target_uuid, 0x01, {});
+        send_response(connection_id, state.transaction_id, state.target_handle, 0x01, {});
     }
 }
 
-void BleTransport::send_response(uint16_t conn_id, uint16_t tid, const std::string& uuid, uint8_t status, std::span<const uint8_t> body) {
-    std::vector<uint8_t> packet = ble::HapPdu::build_response(tid, status, body);
-    
-    bool session_is_secured = false;
-    auto* session_ptr = session_manager_->get_session(conn_id);
-    if (session_ptr && session_ptr->context) {
-        session_is_secured = session_ptr->context->is_encrypted();
-    }
-    
-    bool requires_encryption = true;
-    if (uuid.size() >= 8) {
-        std::string short_uuid_str = uuid.substr(4, 4);
-        unsigned int short_uuid = 0;
-        if (sscanf(short_uuid_str.c_str(), "%x", &short_uuid) == 1) {
-            if (short_uuid == 0x4C || short_uuid == 0x4E || short_uuid == 0x4F) {
-                requires_encryption = false;
+void BleTransport::send_response(uint16_t conn_id, uint16_t tid, uint16_t handle, uint8_t status, std::span<const uint8_t> body) {
+    auto& session = session_manager_->get_or_create(conn_id);
+    auto& state = session.transaction;
+    
+    bool session_is_secured = session.context && session.context->is_encrypted();
+    bool encrypt = session_is_secured && handle_requires_encryption(handle);
+    size_t tag_size = encrypt ? SecureSession::AUTH_TAG_SIZE : 0;
+    
+    // HAP-BLE Spec 7.3.3.5: a PDU larger than one GATT Read is split into
+    // fragments, each encrypted on its own. A Read Response carries MTU - 1
+    // bytes; stay within MTU - 3 like notifications so every stack accepts it.
+    constexpr size_t kHeaderSize = 5;           // CF | TID | Status | BodyLen(2)
+    constexpr size_t kContinuationHeaderSize = 2;   // CF | TID
+    size_t fragment_limit = session.att_mtu > 3 ? session.att_mtu - 3u : 0;
+    bool fragment = fragment_limit > tag_size + kHeaderSize &&
+                    kHeaderSize + body.size() + tag_size > fragment_limit;
+    size_t plaintext_limit = fragment ? fragment_limit - tag_size : kHeaderSize + body.size();
+    
+    auto& out = state.response_buffer;
+    out.clear();
+    state.response_fragment_ends.clear();
+    state.response_fragment = 0;
+    
+    size_t first_chunk = std::min(body.size(), plaintext_limit - kHeaderSize);
+    size_t continuations = fragment
+        ? (body.size() - first_chunk + (plaintext_limit - kContinuationHeaderSize) - 1) / (plaintext_limit - kContinuationHeaderSize)
+        : 0;
+    out.reserve(kHeaderSize + body.size() + continuations * kContinuationHeaderSize + (continuations + 1) * tag_size);
+    
+    size_t offset = 0;
+    while (true) {
+        size_t start = out.size();
+        size_t chunk;
+        if (start == 0) {
+            // First fragment: CF(0x02 = response) | TID | Status | BodyLen(2) | Body...
+            out.push_back(0x02);
+            out.push_back(static_cast<uint8_t>(tid & 0xFF));
+            out.push_back(status);
+            out.push_back(body.size() & 0xFF);
+            out.push_back((body.size() >> 8) & 0xFF);
+            chunk = first_chunk;
+        } else {
+            // Continuation: CF(0x82) | TID | Body...
+            out.push_back(0x82);
+            out.push_back(static_cast<uint8_t>(tid & 0xFF));
+            chunk = std::min(body.size() - offset, plaintext_limit - kContinuationHeaderSize);
+        }
+        out.insert(out.end(), body.begin() + offset, body.begin() + offset + chunk);
+        offset += chunk;
+        
+        if (encrypt) {
+            size_t plaintext_size = out.size() - start;
+            out.resize(out.size() + tag_size);
+            common::Metrics::Scope encrypt_timer(config_.metrics, common::Metric::Encrypt);
+            auto encrypted = session.context->get_secure_session()->encrypt_ble_pdu_in_place(
+                std::span<uint8_t>(out).subspan(start), plaintext_size);
+            encrypt_timer.stop();
+            if (!encrypted) {
+                HAP_LOG_ERROR(config_.system,
+                    "[BleTransport] Response encryption failed for connection " + std::to_string(conn_id));
+                state.response_fragment_ends.clear();
+                out = ble::HapPdu::build_response(tid, status, body);
+                return;
             }
+            common::count(config_.metrics, common::Counter::BytesEncrypted, plaintext_size);
         }
-    }
-    
-    if (session_is_secured && requires_encryption) {
-        auto& ctx = *session_ptr->context;
-        auto encrypted = ctx.get_secure_session()->encrypt_ble_pdu(packet);
-        if (encrypted.empty()) {
-            config_.system->log(platform::System::LogLevel::Error, 
-                "[BleTransport] Response encryption failed for connection " + std::to_string(conn_id));
-            session_manager_->get_or_create(conn_id).transaction.response_buffer = packet;
-        } else {
-            config_.system->log(platform::System::LogLevel::Debug, 
-                "[BleTransport] Encrypted response (" + std::to_string(encrypted.size()) + " bytes)");
-            session_manager_->get_or_create(conn_id).transaction.response_buffer = std::move(encrypted);
+        
+        if (fragment) {
+            state.response_fragment_ends.push_back(static_cast<uint32_t>(out.size()));
         }
-    } else {
-        session_manager_->get_or_create(conn_id).transaction.response_buffer = packet;
+        if (offset >= body.size()) break;
     }
     
+    HAP_LOG_DEBUG(config_.system,
+        "[BleTransport] Response ready (" + std::to_string(out.size()) + " bytes" +
+        (fragment ? ", " + std::to_string(state.response_fragment_ends.size()) + " fragments" : std::string()) +
+        (encrypt ? ", encrypted" : "") + ")");
+    
     // HAP-BLE Spec 7.3.5.1/7.3.5.5: The response is returned in the GATT Read Response.
 }
 
-bool BleTransport::process_characteristic_write(uint16_t connection_id, uint16_t tid, const std::string& uuid, std::span<const uint8_t> body) {
+bool BleTransport::process_characteristic_write(uint16_t connection_id, uint16_t tid, uint16_t handle, std::span<const uint8_t> body) {
+    uint16_t type = handle < gatt_chars_.size() ? gatt_chars_[handle].short_type : 0;
     auto& session = session_manager_->get_or_create(connection_id);
     if (!session.context) {
         session.context = std::make_unique<ConnectionContext>(config_.crypto, config_.system, connection_id);
     }
     
-    if (uuid == "0000004C-0000-1000-8000-0026BB765291") { // Pair Setup
+    if (type == 0x4C) { // Pair Setup
         Request req;
         req.body.assign(body.begin(), body.end());
         req.method = Method::POST; 
@@ -1369,10 +1311,10 @@ bool BleTransport::process_characteristic_write(uint16_t connection_id, uint16_t
         auto resp = config_.pairing_endpoints->handle_pair_setup(req, *session.context);
         
         uint8_t status = (resp.status == Status::OK) ? 0x00 : 0x05; 
-        send_response(connection_id, tid, uuid, status, resp.body);
+        send_response(connection_id, tid, handle, status, resp.body);
         return true; 
     }
-    else if (uuid == "0000004E-0000-1000-8000-0026BB765291") { // Pair Verify
+    else if (type == 0x4E) { // Pair Verify
         Request req;
         req.body.assign(body.begin(), body.end());
         req.method = Method::POST;
@@ -1380,10 +1322,10 @@ bool BleTransport::process_characteristic_write(uint16_t connection_id, uint16_t
         
         auto resp = config_.pairing_endpoints->handle_pair_verify(req, *session.context);
         uint8_t status = (resp.status == Status::OK) ? 0x00 : 0x05;
-        send_response(connection_id, tid, uuid, status, resp.body);
+        send_response(connection_id, tid, handle, status, resp.body);
         return true;
     }
-    else if (uuid == "00000050-0000-1000-8000-0026BB765291") { // Pairing Mappings
+    else if (type == 0x50) { // Pairing Mappings
         if (!session.context) return false;
         
         Request req;
@@ -1393,130 +1335,72 @@ bool BleTransport::process_characteristic_write(uint16_t connection_id, uint16_t
         
         auto resp = config_.pairing_endpoints->handle_pairings(req, *session.context);
         uint8_t status = (resp.status == Status::OK) ? 0x00 : 0x05;
-        send_response(connection_id, tid, uuid, status, resp.body);
+        send_response(connection_id, tid, handle, status, resp.body);
         return true;
     }
     
     return false;
 }
-std::vector<uint8_t> BleTransport::process_signature_read(uint16_t connection_id, uint16_t char_iid) {
-    (void)connection_id;
-    std::vector<uint8_t> response;
-    
-    if (pairing_char_metadata_.count(char_iid)) {
-        const auto& meta = pairing_char_metadata_[char_iid];
-        
-        {
-            BleTlvBuilder builder;
-            builder.add_hap_uuid128(HAPBLEPDUTLVType::CharacteristicType, meta.char_type);
-            auto tlv = builder.build();
-            response.insert(response.end(), tlv.begin(), tlv.end());
-        }
-        
-        {
-            BleTlvBuilder builder;
-            builder.add_uint16(HAPBLEPDUTLVType::ServiceInstanceID, meta.service_id);
-            auto tlv = builder.build();
-            response.insert(response.end(), tlv.begin(), tlv.end());
-        }
-        
-        {
-            BleTlvBuilder builder;
-            builder.add_hap_uuid128(HAPBLEPDUTLVType::ServiceType, meta.service_type);
-            auto tlv = builder.build();
-            response.insert(response.end(), tlv.begin(), tlv.end());
-        }
-        
-        {
-            BleTlvBuilder builder;
-            builder.add_uint16(HAPBLEPDUTLVType::CharacteristicProperties, meta.properties);
-            auto tlv = builder.build();
-            response.insert(response.end(), tlv.begin(), tlv.end());
-        }
-        
+void BleTransport::rebuild_signatures() {
+    char_signatures_.clear();
+    service_signatures_.clear();
+    BleTlvBuilder builder;
+    
+    // Protocol characteristics come first so they shadow database IIDs, as
+    // the per-read lookups used to
+    for (const auto& [char_iid, meta] : pairing_char_metadata_) {
+        builder.clear();
+        builder.add_hap_uuid128(HAPBLEPDUTLVType::CharacteristicType, meta.char_type)
+               .add_uint16(HAPBLEPDUTLVType::ServiceInstanceID, meta.service_id)
+               .add_hap_uuid128(HAPBLEPDUTLVType::ServiceType, meta.service_type)
+               .add_uint16(HAPBLEPDUTLVType::CharacteristicProperties, meta.properties);
         if (!meta.user_description.empty()) {
-            response.push_back((uint8_t)HAPBLEPDUTLVType::GATTUserDescription);
-            response.push_back(static_cast<uint8_t>(meta.user_description.size()));
-            response.insert(response.end(), meta.user_description.begin(), meta.user_description.end());
+            builder.add_string(HAPBLEPDUTLVType::GATTUserDescription, meta.user_description);
         }
+        builder.add_gatt_format((meta.char_type == 0x4F) ? 0x04 : 0x1B);
+        char_signatures_.add(char_iid, builder.data());
         
-        {
-             uint8_t gatt_format = (meta.char_type == 0x4F) ? 0x04 : 0x1B;
-             BleTlvBuilder builder;
-             builder.add_gatt_format(gatt_format);
-             auto tlv = builder.build();
-             response.insert(response.end(), tlv.begin(), tlv.end());
-        }
-
-        config_.system->log(platform::System::LogLevel::Info, 
-            "[BleTransport] Generated signature for special char IID=" + std::to_string(char_iid));
-        
-        return response;
+        // Protocol services are primary and have no linked services
+        builder.clear();
+        builder.add_uint16(HAPBLEPDUTLVType::ServiceProperties, 0x0001)
+               .add(HAPBLEPDUTLVType::LinkedServices, {});
+        service_signatures_.add(meta.service_id, builder.data());
     }
     
     if (config_.database) {
         for (const auto& acc : config_.database->accessories()) {
             for (const auto& svc : acc->services()) {
+                uint16_t svc_iid = static_cast<uint16_t>(svc->iid());
+                
+                std::vector<uint8_t> linked;
+                for (uint64_t linked_iid : svc->linked_services()) {
+                    linked.push_back(linked_iid & 0xFF);
+                    linked.push_back((linked_iid >> 8) & 0xFF);
+                }
+                builder.clear();
+                builder.add_uint16(HAPBLEPDUTLVType::ServiceProperties, svc->is_primary() ? 0x0001 : 0x0000)
+                       .add(HAPBLEPDUTLVType::LinkedServices, linked);
+                service_signatures_.add(svc_iid, builder.data());
+                
                 for (const auto& ch : svc->characteristics()) {
-                     if (ch->iid() == char_iid) {
-                            {
-                             uint16_t short_uuid = ch->type() & 0xFFFF;
-                             BleTlvBuilder builder;
-                             builder.add_hap_uuid128(HAPBLEPDUTLVType::CharacteristicType, short_uuid);
-                             auto tlv = builder.build();
-                             response.insert(response.end(), tlv.begin(), tlv.end());
-                         }
-
-                         {
-                             BleTlvBuilder builder;
-                             builder.add_uint16(HAPBLEPDUTLVType::ServiceInstanceID, svc->iid());
-                             auto tlv = builder.build();
-                             response.insert(response.end(), tlv.begin(), tlv.end());
-                         }
-                         
-                         {
-                             uint16_t svc_short_uuid = svc->type() & 0xFFFF;
-                             BleTlvBuilder builder;
-                             builder.add_hap_uuid128(HAPBLEPDUTLVType::ServiceType, svc_short_uuid);
-                             auto tlv = builder.build();
-                             response.insert(response.end(), tlv.begin(), tlv.end());
-                         }
-                         
-                         {
-                             uint16_t props = 0;
-                             auto perms = ch->permissions();
-                             for (auto p : perms) {
-                                 if (p == core::Permission::PairedRead) props |= 0x0010;
-                                 else if (p == core::Permission::PairedWrite) props |= 0x0020;
-                                 else if (p == core::Permission::Notify) props |= (0x0080 | 0x0100); 
-                                 else if (p == core::Permission::TimedWrite) props |= 0x0008;
-                                 else if (p == core::Permission::Hidden) props |= 0x0040;
-                                 else if (p == core::Permission::AdditionalAuthorization) props |= 0x0004;
-                                 else if (p == core::Permission::Broadcast) props |= 0x0200;
-                             }
-                             
-                             BleTlvBuilder builder;
-                             builder.add_uint16(HAPBLEPDUTLVType::CharacteristicProperties, props);
-                             auto tlv = builder.build();
-                             response.insert(response.end(), tlv.begin(), tlv.end());
-                         }
-
-                         {
-                             uint8_t gatt_format = core::CharacteristicSerializer::gatt_format_byte(ch->format());
-                             BleTlvBuilder builder;
-                             builder.add_gatt_format(gatt_format);
-                             auto tlv = builder.build();
-                             response.insert(response.end(), tlv.begin(), tlv.end());
-                         }
-                         
-                         return response;
-                     }
+                    builder.clear();
+                    builder.add_hap_uuid128(HAPBLEPDUTLVType::CharacteristicType, ch->type() & 0xFFFF)
+                           .add_uint16(HAPBLEPDUTLVType::ServiceInstanceID, svc_iid)
+                           .add_hap_uuid128(HAPBLEPDUTLVType::ServiceType, svc->type() & 0xFFFF)
+                           .add_uint16(HAPBLEPDUTLVType::CharacteristicProperties, ch->ble_properties())
+                           .add_gatt_format(core::CharacteristicSerializer::gatt_format_byte(ch->format()));
+                    char_signatures_.add(static_cast<uint16_t>(ch->iid()), builder.data());
                 }
             }
         }
     }
-
-    return response;
+    
+    char_signatures_.seal();
+    service_signatures_.seal();
+    
+    HAP_LOG_DEBUG(config_.system,
+        "[BleTransport] Precomputed " + std::to_string(char_signatures_.size()) + " characteristic and " +
+        std::to_string(service_signatures_.size()) + " service signatures");
 }
 
 std::vector<uint8_t> BleTransport::process_characteristic_read(uint16_t connection_id, std::span<const uint8_t> body) { (void)connection_id; (void)body; return {}; }
@@ -1529,157 +1413,334 @@ void BleTransport::register_user_services() {
     register_services_by_type(0);
 }
 
+void BleTransport::index_database() {
+    if (!config_.database) return;
+
+    // PDUs resolve IIDs from this index
+    if (finder_) {
+        finder_->rebuild();
+    } else {
+        finder_ = std::make_unique<core::CharacteristicFinder>(*config_.database);
+    }
+}
+
 void BleTransport::register_services_by_type(uint16_t filter_type) {
     if (!config_.database) return;
+
+    for (const auto& acc : config_.database->accessories()) {
+        register_accessory_services(*acc, filter_type);
+    }
+}
+
+void BleTransport::on_database_changed(std::span<const std::shared_ptr<core::Accessory>> added) {
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    if (!config_.ble || !config_.database) return;
+
+    index_database();
+    
+    // Retire characteristics that are no longer in the database; their GATT
+    // entries stay registered, so handles stay valid
+    for (auto& entry : gatt_chars_) {
+        if (entry.in_database && config_.database->find_entry(entry.aid, entry.iid) == nullptr) {
+            entry.in_database = false;
+        }
+    }
+
+    // Deferred registration has not run yet and picks up the other services
+    if (registration_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        for (const auto& acc : added) {
+            register_accessory_services(*acc, 0x3E);
+        }
+        return;
+    }
+
+    for (const auto& acc : added) {
+        register_accessory_services(*acc, 0x3E);
+        register_accessory_services(*acc, 0);
+    }
+    rebuild_signatures();
+
+    // Publishes the new configuration number
+    update_advertising();
+}
+
+void BleTransport::register_accessory_services(const core::Accessory& accessory, uint16_t filter_type) {
     auto type_to_uuid_str = [](uint64_t type) {
         char buffer[37];
         snprintf(buffer, sizeof(buffer), "0000%04X-0000-1000-8000-0026BB765291", (unsigned int)(type & 0xFFFF));
         return std::string(buffer);
     };
 
-    for (const auto& acc : config_.database->accessories()) {
-        for (const auto& svc : acc->services()) {
-            uint16_t svc_type = svc->type() & 0xFFFF;
-            
-            if (filter_type == 0 && svc_type == 0x3E) continue;
-            if (filter_type != 0 && svc_type != filter_type) continue;
-            
+    for (const auto& svc : accessory.services()) {
+        uint16_t svc_type = svc->type() & 0xFFFF;
+        
+        if (filter_type == 0 && svc_type == 0x3E) continue;
+        if (filter_type != 0 && svc_type != filter_type) continue;
+        
+        // Use IID already assigned by AttributeDatabase (via IIDManager)
+        uint16_t svc_iid = static_cast<uint16_t>(svc->iid());
+
+        platform::Ble::ServiceDefinition def;
+        def.uuid = type_to_uuid_str(svc->type());
+        // HAP Spec 7.4.1: All HAP services must be primary GATT services.
+        def.is_primary = true;
+        
+        {
+            platform::Ble::CharacteristicDefinition svc_iid_char;
+            svc_iid_char.uuid = kServiceInstanceIdCharUUID;
+            svc_iid_char.properties.read = true;
+            svc_iid_char.properties.write = false;
+            svc_iid_char.properties.indicate = false;
+            svc_iid_char.properties.notify = false;
+            svc_iid_char.on_read = [svc_iid](uint16_t) {
+                std::vector<uint8_t> val;
+                val.push_back(svc_iid & 0xFF);
+                val.push_back((svc_iid >> 8) & 0xFF);
+                return val;
+            };
+            def.characteristics.push_back(std::move(svc_iid_char));
+        }
+        
+        auto add_iid_descriptor = [](platform::Ble::CharacteristicDefinition& d, uint16_t iid) {
+            platform::Ble::DescriptorDefinition desc;
+            desc.uuid = kCharacteristicInstanceIdDescUUID;
+            desc.properties.read = true;
+            desc.on_read = [iid](uint16_t) {
+                std::vector<uint8_t> val;
+                val.push_back(iid & 0xFF);
+                val.push_back((iid >> 8) & 0xFF);
+                return val;
+            };
+            d.descriptors.push_back(std::move(desc));
+        };
+
+        for (const auto& ch : svc->characteristics()) {
             // Use IID already assigned by AttributeDatabase (via IIDManager)
-            uint16_t svc_iid = static_cast<uint16_t>(svc->iid());
+            uint16_t char_iid = static_cast<uint16_t>(ch->iid());
 
-            platform::Ble::ServiceDefinition def;
-            def.uuid = type_to_uuid_str(svc->type());
-            // HAP Spec 7.4.1: All HAP services must be primary GATT services.
-            def.is_primary = true;
+            std::string char_uuid = type_to_uuid_str(ch->type());
+            platform::Ble::CharacteristicDefinition cdef;
+            cdef.uuid = char_uuid;
             
-            {
-                platform::Ble::CharacteristicDefinition svc_iid_char;
-                svc_iid_char.uuid = kServiceInstanceIdCharUUID;
-                svc_iid_char.properties.read = true;
-                svc_iid_char.properties.write = false;
-                svc_iid_char.properties.indicate = false;
-                svc_iid_char.properties.notify = false;
-                svc_iid_char.on_read = [svc_iid](uint16_t) {
-                    std::vector<uint8_t> val;
-                    val.push_back(svc_iid & 0xFF);
-                    val.push_back((svc_iid >> 8) & 0xFF);
-                    return val;
-                };
-                def.characteristics.push_back(std::move(svc_iid_char));
-            }
+            uint16_t handle = add_gatt_characteristic(accessory.aid(), char_iid, char_uuid);
             
-            auto add_iid_descriptor = [](platform::Ble::CharacteristicDefinition& d, uint16_t iid) {
+            cdef.properties.read = true;
+            cdef.properties.write = true;
+            bool has_notify = ch->has_permission(core::Permission::Notify);
+            cdef.properties.notify = false;
+            cdef.properties.indicate = has_notify;
+
+            add_iid_descriptor(cdef, char_iid);
+
+            if (ch->description().has_value()) {
                 platform::Ble::DescriptorDefinition desc;
-                desc.uuid = kCharacteristicInstanceIdDescUUID;
+                desc.uuid = "2901"; 
                 desc.properties.read = true;
-                desc.on_read = [iid](uint16_t) {
-                    std::vector<uint8_t> val;
-                    val.push_back(iid & 0xFF);
-                    val.push_back((iid >> 8) & 0xFF);
-                    return val;
+                std::string d = ch->description().value();
+                desc.on_read = [d](uint16_t) {
+                    return std::vector<uint8_t>(d.begin(), d.end());
                 };
-                d.descriptors.push_back(std::move(desc));
+                cdef.descriptors.push_back(std::move(desc));
+            }
+            
+            cdef.on_read = [this](uint16_t conn_id) {
+                return handle_hap_read(conn_id);
+            };
+            
+            cdef.on_write = [this, handle](uint16_t conn_id, std::span<const uint8_t> data, bool response) {
+                (void)response;
+                handle_hap_write(conn_id, handle, data);
+            };
+            
+            cdef.on_subscribe = [this, handle](uint16_t conn_id, bool enabled) {
+                 std::lock_guard<std::recursive_mutex> lock(mutex_);
+                 if (enabled) {
+                     session_manager_->add_subscription(handle, conn_id);
+                 } else {
+                     session_manager_->remove_subscription(handle, conn_id);
+                 }
             };
 
-            for (const auto& ch : svc->characteristics()) {
-                // Use IID already assigned by AttributeDatabase (via IIDManager)
-                uint16_t char_iid = static_cast<uint16_t>(ch->iid());
-
-                std::string char_uuid = type_to_uuid_str(ch->type());
-                platform::Ble::CharacteristicDefinition cdef;
-                cdef.uuid = char_uuid;
-                
-                instance_map_[{acc->aid(), ch->iid()}] = char_uuid;
-                
-                auto perms = ch->permissions();
-                cdef.properties.read = true;
-                cdef.properties.write = true;
-                bool has_notify = core::has_permission(perms, core::Permission::Notify);
-                cdef.properties.notify = false;
-                cdef.properties.indicate = has_notify;
-
-                add_iid_descriptor(cdef, char_iid);
-
-                if (ch->description().has_value()) {
-                    platform::Ble::DescriptorDefinition desc;
-                    desc.uuid = "2901"; 
-                    desc.properties.read = true;
-                    std::string d = ch->description().value();
-                    desc.on_read = [d](uint16_t) {
-                        return std::vector<uint8_t>(d.begin(), d.end());
-                    };
-                    cdef.descriptors.push_back(std::move(desc));
-                }
-                
-                cdef.on_read = [this](uint16_t conn_id) {
-                    return handle_hap_read(conn_id);
-                };
-                
-                cdef.on_write = [this, uuid=char_uuid](uint16_t conn_id, std::span<const uint8_t> data, bool response) {
-                    (void)response;
-                    handle_hap_write_with_id(conn_id, uuid, data);
-                };
-                
-                cdef.on_subscribe = [this, uuid=char_uuid](uint16_t conn_id, bool enabled) {
-                     if (enabled) {
-                         session_manager_->add_subscription(uuid, conn_id);
-                     } else {
-                         session_manager_->remove_subscription(uuid, conn_id);
-                     }
-                };
-
-                def.characteristics.push_back(std::move(cdef));
-            }
-            config_.ble->register_service(def);
+            def.characteristics.push_back(std::move(cdef));
         }
+        config_.ble->register_service(def);
     }
 }
 
 uint16_t BleTransport::get_current_gsn() {
-    auto gsn_bytes = config_.storage->get("gsn");
-    uint16_t gsn = 1;
-    if (gsn_bytes && gsn_bytes->size() == 2) {
-        gsn = static_cast<uint16_t>((*gsn_bytes)[0]) | (static_cast<uint16_t>((*gsn_bytes)[1]) << 8);
-    }
-    return gsn;
+    return gsn_.current();
 }
 
 bool BleTransport::is_broadcast_key_valid() {
-    if (!broadcast_key_valid_) return false;
+    if (!broadcast_key_.valid) return false;
     
     // Per HAP Spec 7.4.7.4: Key expires after 32767 GSN increments
     uint16_t current_gsn = get_current_gsn();
     uint16_t gsn_diff = 0;
     
     // Handle GSN wraparound (1-65535, wraps to 1)
-    if (current_gsn >= broadcast_key_gsn_start_) {
-        gsn_diff = current_gsn - broadcast_key_gsn_start_;
+    if (current_gsn >= broadcast_key_.gsn_start) {
+        gsn_diff = current_gsn - broadcast_key_.gsn_start;
     } else {
         // GSN wrapped around
-        gsn_diff = (65535 - broadcast_key_gsn_start_) + current_gsn;
+        gsn_diff = (65535 - broadcast_key_.gsn_start) + current_gsn;
     }
     
     if (gsn_diff >= 32767) {
-        config_.system->log(platform::System::LogLevel::Warning,
+        HAP_LOG_WARNING(config_.system,
             "[BleTransport] Broadcast encryption key expired (GSN diff=" + std::to_string(gsn_diff) + ")");
-        broadcast_key_valid_ = false;
+        broadcast_key_.valid = false;
         return false;
     }
     
     return true;
 }
 
+uint8_t BleTransport::write_pairing_characteristic(uint16_t connection_id, uint8_t char_type,
+                                                  std::span<const uint8_t> body,
+                                                  std::vector<uint8_t>& response_body) {
+    auto& session = session_manager_->get_or_create(connection_id);
+    if (!session.context) {
+        session.context = std::make_unique<ConnectionContext>(config_.crypto, config_.system, connection_id);
+    }
+    auto& ctx = *session.context;
+    
+    // HAP-BLE Pair Setup/Verify are "Write-with-Response" (Spec 7.3.5.5)
+    // The body is a LIST of TLVs:
+    // - kTLVType_ReturnResponse (0x09): (Empty implies request response)
+    // - kTLVType_Value (0x01): The actual SRP payload (M1, M3, etc)
+    std::vector<uint8_t> inner_body;
+    bool return_response_requested = false;
+    
+    // Only parse as BLE TLVs for Pairing Services (Setup 4C, Verify 4E, Pairings 50)
+    if (char_type == 0x4C || char_type == 0x4E || char_type == 0x50) {
+        auto ble_tlvs = core::TLV8::parse(std::vector<uint8_t>(body.begin(), body.end()));
+        
+        if (core::TLV8::find(ble_tlvs, (uint8_t)HAPBLEPDUTLVType::ReturnResponse)) {
+            return_response_requested = true;
+        }
+        
+        auto val = core::TLV8::find(ble_tlvs, 0x01); // 0x01 = Param-Value
+        if (val) {
+            inner_body.assign(val->begin(), val->end());
+        } else {
+            HAP_LOG_WARNING(config_.system, "[BleTransport] Warning: Pairing Write missing Value TLV wrapper. Using raw body.");
+            inner_body.assign(body.begin(), body.end());
+        }
+    } else {
+        inner_body.assign(body.begin(), body.end());
+    }
+    
+    Request req;
+    req.body.assign(inner_body.begin(), inner_body.end());
+    req.method = Method::POST;
+    
+    Response resp;
+    if (char_type == 0x4C) { // Pair Setup
+        req.path = "/pair-setup";
+        resp = config_.pairing_endpoints->handle_pair_setup(req, ctx);
+    } else if (char_type == 0x4E) { // Pair Verify
+        req.path = "/pair-verify";
+        resp = config_.pairing_endpoints->handle_pair_verify(req, ctx);
+    } else if (char_type == 0x50) { // Pairings
+        req.path = "/pairings";
+        resp = config_.pairing_endpoints->handle_pairings(req, ctx);
+    } else if (char_type == 0xA5) { // Service Signature
+        HAP_LOG_INFO(config_.system, "[BleTransport] Software Auth Write - Skipping (Success)");
+        resp = Response{Status::OK};
+    }
+    
+    // If Return-Response was requested, the response body goes in a Value TLV
+    if (return_response_requested && !resp.body.empty()) {
+        std::vector<core::TLV> resp_tlvs;
+        resp_tlvs.emplace_back(0x01, resp.body); // 0x01 = Param-Value
+        response_body = core::TLV8::encode(resp_tlvs);
+    } else {
+        response_body = resp.body;
+    }
+    return (resp.status == Status::OK) ? 0x00 : 0x02;
+}
+
+uint8_t BleTransport::write_characteristic(uint16_t connection_id, ble::TransactionState& state, uint16_t iid,
+                                           std::span<const uint8_t> body, bool timed,
+                                           std::vector<uint8_t>& response_body) {
+    const auto* info = finder_ ? finder_->lookup(iid) : nullptr;
+    core::Characteristic* ch = info ? info->characteristic.get() : nullptr;
+    
+    auto status = CharacteristicOps::check_write(ch);
+    if (status == core::HAPStatus::Success && !timed) {
+        // Plain writes to timed-write characteristics are refused; executed ones were prepared
+        status = CharacteristicOps::check_timed_write(*ch, state.timed_writes, std::nullopt,
+                                                      config_.system->millis());
+    }
+    if (status != core::HAPStatus::Success) {
+        HAP_LOG_WARNING(config_.system,
+            "[BleTransport] Write IID=" + std::to_string(iid) + " refused with status " +
+            std::to_string(core::to_int(status)));
+        return CharacteristicOps::to_ble_status(status);
+    }
+    
+    auto body_tlvs = core::TLV8::parse(std::vector<uint8_t>(body.begin(), body.end()));
+    bool return_response_requested =
+        core::TLV8::find(body_tlvs, (uint8_t)HAPBLEPDUTLVType::ReturnResponse).has_value();
+    auto value_tlv = core::TLV8::find(body_tlvs, 0x01);
+    auto decoded = value_tlv && !value_tlv->empty()
+        ? core::CharacteristicSerializer::from_bytes(*value_tlv, ch->format())
+        : common::Result<core::Value>::err(common::ErrorCode::InvalidParameter);
+    if (!decoded) {
+        HAP_LOG_WARNING(config_.system,
+            "[BleTransport] Write IID=" + std::to_string(iid) + " - no valid value TLV found");
+        return CharacteristicOps::to_ble_status(core::HAPStatus::InvalidValueInRequest);
+    }
+    core::Value new_value = std::move(decoded).value();
+    const uint64_t aid = info->accessory_id;  // info is only valid until the finder is rebuilt
+    
+    // Pass EventSource so the originating connection is excluded from notifications
+    ch->set_value(new_value, core::EventSource::from_connection(connection_id));
+    HAP_LOG_DEBUG(config_.system,
+        "[BleTransport] Write IID=" + std::to_string(iid) + " success");
+    
+    // Per HAP Spec 7.4.1.8: GSN increments on first characteristic change per connection
+    if (!state.gsn_incremented) {
+        state.gsn_incremented = true;
+        increment_gsn();
+    }
+    
+    uint8_t ble_status = 0x00;
+    // HAP Spec 7.3.5.5: Write-with-Response - return value if requested
+    if (return_response_requested) {
+        auto outcome = CharacteristicOps::write_response(*ch);
+        ble_status = CharacteristicOps::to_ble_status(outcome.status);
+        if (outcome.status != core::HAPStatus::Success) {
+            HAP_LOG_WARNING(config_.system,
+                "[BleTransport] WriteResponse IID=" + std::to_string(iid) + " callback returned error");
+        } else if (outcome.value) {
+            auto raw_bytes = core::CharacteristicSerializer::to_bytes(*outcome.value);
+            std::vector<core::TLV> resp_tlvs;
+            resp_tlvs.emplace_back(0x01, raw_bytes); // HAP-Param-Value
+            response_body = core::TLV8::encode(resp_tlvs);
+            HAP_LOG_DEBUG(config_.system,
+                "[BleTransport] Write-Response IID=" + std::to_string(iid) +
+                " returning " + std::to_string(response_body.size()) + " bytes");
+        }
+    }
+    
+    handle_characteristic_change(aid, iid, new_value, connection_id);
+    return ble_status;
+}
+
 void BleTransport::handle_characteristic_change(uint64_t aid, uint64_t iid, 
                                                  const core::Value& value, 
                                                  uint32_t exclude_conn_id) {
-    config_.system->log(platform::System::LogLevel::Debug,
+    HAP_LOG_DEBUG(config_.system,
         "[BleTransport] Characteristic change: AID=" + std::to_string(aid) + 
         " IID=" + std::to_string(iid));
     
     // Find the characteristic to check its event properties
-    auto ch = config_.database ? config_.database->find_characteristic(aid, iid) : nullptr;
+    const auto* entry = config_.database ? config_.database->find_entry(aid, iid) : nullptr;
+    const core::Characteristic* ch = entry ? entry->characteristic.get() : nullptr;
     if (!ch) {
-        config_.system->log(platform::System::LogLevel::Warning,
+        HAP_LOG_WARNING(config_.system,
             "[BleTransport] Cannot find characteristic for event: IID=" + std::to_string(iid));
         return;
     }
@@ -1689,19 +1750,10 @@ void BleTransport::handle_characteristic_change(uint64_t aid, uint64_t iid,
     // - 0x0080: Notifies Events in Connected State
     // - 0x0100: Notifies Events in Disconnected State
     // - 0x0200: Supports Broadcast Notify
-    bool supports_connected = false;
-    bool supports_disconnected = false;
-    bool supports_broadcast = false;
-    
-    for (const auto& perm : ch->permissions()) {
-        if (perm == core::Permission::Notify) {
-            supports_connected = true;
-            supports_disconnected = true;
-        }
-        if (perm == core::Permission::Broadcast) {
-            supports_broadcast = true;
-        }
-    }
+    const uint16_t props = ch->ble_properties();
+    bool supports_connected = (props & 0x0080) != 0;
+    bool supports_disconnected = (props & 0x0100) != 0;
+    bool supports_broadcast = (props & 0x0200) != 0;
     
     bool broadcast_enabled = false;
     if (broadcast_configs_.count(static_cast<uint16_t>(iid))) {
@@ -1709,17 +1761,16 @@ void BleTransport::handle_characteristic_change(uint64_t aid, uint64_t iid,
         broadcast_enabled = bc.enabled;
     }
     
-    auto it = instance_map_.find({aid, iid});
-    if (it == instance_map_.end()) {
-        config_.system->log(platform::System::LogLevel::Warning,
-            "[BleTransport] No UUID mapping for IID=" + std::to_string(iid));
+    auto handle = find_gatt_handle(aid, static_cast<uint16_t>(iid));
+    if (!handle) {
+        HAP_LOG_WARNING(config_.system,
+            "[BleTransport] No GATT characteristic for IID=" + std::to_string(iid));
         return;
     }
-    std::string uuid = it->second;
     
     bool has_connected_subscribers = false;
-    if (session_manager_->has_subscribers(uuid)) {
-        for (uint16_t conn_id : session_manager_->get_subscribers(uuid)) {
+    if (session_manager_->has_subscribers(*handle)) {
+        for (uint16_t conn_id : session_manager_->get_subscribers(*handle)) {
             if (conn_id != exclude_conn_id) {
                 has_connected_subscribers = true;
                 break;
@@ -1730,22 +1781,22 @@ void BleTransport::handle_characteristic_change(uint64_t aid, uint64_t iid,
     is_connected_ = session_manager_->session_count() > 0;
     
     if (is_connected_ && has_connected_subscribers && supports_connected) {
-        config_.system->log(platform::System::LogLevel::Info,
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Sending Connected Event for IID=" + std::to_string(iid));
-        send_connected_event(static_cast<uint16_t>(iid));
+        send_connected_event(*handle);
     }
     else if (!is_connected_ && supports_broadcast && broadcast_enabled && is_broadcast_key_valid()) {
-        config_.system->log(platform::System::LogLevel::Info,
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Sending Broadcasted Event for IID=" + std::to_string(iid));
-        send_broadcasted_event(static_cast<uint16_t>(iid), value);
+        queue_broadcasted_event(static_cast<uint16_t>(iid), value);
     }
     else if (!is_connected_ && supports_disconnected) {
-        config_.system->log(platform::System::LogLevel::Info,
+        HAP_LOG_INFO(config_.system,
             "[BleTransport] Sending Disconnected Event for IID=" + std::to_string(iid));
         send_disconnected_event(static_cast<uint16_t>(iid));
     }
     else {
-        config_.system->log(platform::System::LogLevel::Debug,
+        HAP_LOG_DEBUG(config_.system,
             "[BleTransport] No event sent for IID=" + std::to_string(iid) + 
             " (connected=" + std::to_string(is_connected_) +
             ", has_subs=" + std::to_string(has_connected_subscribers) +
@@ -1753,39 +1804,94 @@ void BleTransport::handle_characteristic_change(uint64_t aid, uint64_t iid,
     }
 }
 
-void BleTransport::send_connected_event(uint16_t iid) {
+void BleTransport::send_connected_event(uint16_t handle) {
     // Per HAP Spec 7.4.6.1 Connected Events:
     // Send a ZERO-LENGTH indication to controllers that registered for indications.
+    const auto& entry = gatt_chars_[handle];
     
-    std::string uuid;
-    for (const auto& [key, val] : instance_map_) {
-        if (key.second == iid) {
-            uuid = val;
-            break;
-        }
-    }
-    
-    if (uuid.empty()) {
-        config_.system->log(platform::System::LogLevel::Warning,
-            "[BleTransport] Cannot send Connected Event - no UUID for IID=" + std::to_string(iid));
+    if (!session_manager_->has_subscribers(handle)) {
+        HAP_LOG_DEBUG(config_.system,
+            "[BleTransport] No subscribers for Connected Event IID=" + std::to_string(entry.iid));
         return;
     }
     
-    if (!session_manager_->has_subscribers(uuid)) {
-        config_.system->log(platform::System::LogLevel::Debug,
-            "[BleTransport] No subscribers for Connected Event IID=" + std::to_string(iid));
-        return;
+    for (uint16_t conn_id : session_manager_->get_subscribers(handle)) {
+        auto* session = session_manager_->get_session(conn_id);
+        if (!session) {
+            config_.ble->send_indication(conn_id, entry.uuid, {});
+            continue;
+        }
+        
+        auto& pending = session->pending_indications;
+        if (std::find(pending.begin(), pending.end(), handle) != pending.end()) {
+            HAP_LOG_DEBUG(config_.system,
+                "[BleTransport] Indication for IID=" + std::to_string(entry.iid) +
+                " already queued on conn=" + std::to_string(conn_id));
+            continue;
+        }
+        pending.push_back(handle);
+        send_pending_indications(conn_id);
     }
+}
+
+void BleTransport::send_pending_indications(uint16_t connection_id) {
+    auto* session = session_manager_->get_session(connection_id);
+    if (!session || session->pending_indications.empty()) return;
     
-    std::vector<uint8_t> empty_indication;
-    
-    for (uint16_t conn_id : session_manager_->get_subscribers(uuid)) {
-        config_.system->log(platform::System::LogLevel::Debug,
-            "[BleTransport] Sending zero-length indication to conn=" + std::to_string(conn_id) + 
-            " for IID=" + std::to_string(iid));
+    uint64_t now = config_.system->millis();
+    if (session->indication_in_flight) {
+        uint64_t waited = now - session->indication_sent_ms;
+        if (waited < kIndicationConfirmTimeoutMs) {
+            schedule_indication_retry(static_cast<uint32_t>(kIndicationConfirmTimeoutMs - waited));
+            return;
+        }
+        HAP_LOG_WARNING(config_.system,
+            "[BleTransport] No indication confirmation from conn=" + std::to_string(connection_id) +
+            ", sending the next one");
+        session->indication_in_flight = false;
+    }
+    
+    // The confirmation callback may run inside send_indication(), so the
+    // entry leaves the queue and the flight flag is set before the call
+    auto& pending = session->pending_indications;
+    while (!pending.empty() && !session->indication_in_flight) {
+        uint16_t handle = pending.front();
+        pending.erase(pending.begin());
+        const auto& entry = gatt_chars_[handle];
+        if (indication_confirmations_) {
+            session->indication_in_flight = true;
+            session->indication_sent_ms = now;
+        }
         
-        config_.ble->send_indication(conn_id, uuid, empty_indication);
+        HAP_LOG_DEBUG(config_.system,
+            "[BleTransport] Sending zero-length indication to conn=" + std::to_string(connection_id) +
+            " for IID=" + std::to_string(entry.iid));
+        if (!config_.ble->send_indication(connection_id, entry.uuid, {})) {
+            // Stack buffers are full: keep it first in line and try again shortly
+            session->indication_in_flight = false;
+            pending.insert(pending.begin(), handle);
+            schedule_indication_retry(kIndicationRetryMs);
+            return;
+        }
+    }
+}
+
+void BleTransport::schedule_indication_retry(uint32_t delay_ms) {
+    if (!config_.scheduler) return;
+    
+    uint64_t at_ms = config_.system->millis() + delay_ms;
+    if (indication_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        if (indication_task_at_ms_ <= at_ms) return;
+        config_.scheduler->cancel(indication_task_);
     }
+    indication_task_at_ms_ = at_ms;
+    indication_task_ = config_.scheduler->schedule_once(delay_ms, [this]() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        indication_task_ = common::TaskScheduler::INVALID_TASK_ID;
+        for (uint16_t connection_id : session_manager_->get_connection_ids()) {
+            send_pending_indications(connection_id);
+        }
+    });
 }
 
 void BleTransport::send_broadcasted_event(uint16_t iid, const core::Value& value) {
@@ -1794,15 +1900,15 @@ void BleTransport::send_broadcasted_event(uint16_t iid, const core::Value& value
     // containing the characteristic value.
     
     if (!is_broadcast_key_valid()) {
-        config_.system->log(platform::System::LogLevel::Warning,
+        HAP_LOG_WARNING(config_.system,
             "[BleTransport] Cannot send Broadcasted Event - no valid broadcast key");
         send_disconnected_event(iid);
         return;
     }
     
-    std::vector<uint8_t> encrypted_payload = build_encrypted_advertisement_payload(iid, value);
-    if (encrypted_payload.empty()) {
-        config_.system->log(platform::System::LogLevel::Error,
+    std::array<uint8_t, 16> encrypted_payload;
+    if (!build_encrypted_advertisement_payload(iid, value, encrypted_payload)) {
+        HAP_LOG_ERROR(config_.system,
             "[BleTransport] Failed to build encrypted advertisement payload");
         send_disconnected_event(iid);
         return;
@@ -1810,31 +1916,86 @@ void BleTransport::send_broadcasted_event(uint16_t iid, const core::Value& value
     
     increment_gsn();
     
-    std::array<uint8_t, 6> adv_id = {};
-    sscanf(config_.accessory_id.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
-        &adv_id[0], &adv_id[1], &adv_id[2], 
-        &adv_id[3], &adv_id[4], &adv_id[5]);
-    
-    uint32_t interval_ms = 20;  // Default 20ms
-    if (broadcast_configs_.count(iid)) {
-        switch (broadcast_configs_[iid].interval) {
-            case 0x01: interval_ms = 20; break;
-            case 0x02: interval_ms = 1280; break;
-            case 0x03: interval_ms = 2560; break;
-            default: interval_ms = 20; break;
-        }
-    }
+    uint32_t interval_ms = broadcast_interval_ms(iid);
+    uint32_t duration_ms = ble::BroadcastScheduler::slot_ms(interval_ms);
     
     platform::Ble::EncryptedAdvertisement enc_adv;
-    enc_adv.advertising_id = adv_id;
-    enc_adv.encrypted_payload = std::move(encrypted_payload);
+    enc_adv.advertising_id = advertising_id();
+    enc_adv.encrypted_payload.assign(encrypted_payload.begin(), encrypted_payload.end());
     enc_adv.gsn = get_current_gsn();
     
-    config_.system->log(platform::System::LogLevel::Info,
+    HAP_LOG_INFO(config_.system,
         "[BleTransport] Starting encrypted advertisement for IID=" + std::to_string(iid) +
-        " interval=" + std::to_string(interval_ms) + "ms duration=3000ms");
+        " interval=" + std::to_string(interval_ms) + "ms duration=" + std::to_string(duration_ms) + "ms");
+    
+    config_.ble->start_encrypted_advertising(enc_adv, interval_ms, duration_ms);
+    current_advertisement_.reset();
+}
+
+void BleTransport::queue_broadcasted_event(uint16_t iid, const core::Value& value) {
+    if (!config_.scheduler) {
+        send_broadcasted_event(iid, value);
+        return;
+    }
     
-    config_.ble->start_encrypted_advertising(enc_adv, interval_ms, 3000);
+    if (!broadcasts_.push(iid, value, broadcast_interval_ms(iid))) {
+        HAP_LOG_DEBUG(config_.system,
+            "[BleTransport] Broadcast for IID=" + std::to_string(iid) + " unchanged, skipped");
+        return;
+    }
+    if (broadcast_task_ == common::TaskScheduler::INVALID_TASK_ID) {
+        flush_broadcasts();
+    }
+    // Otherwise the slot on air is still running; its end picks this up
+}
+
+void BleTransport::flush_broadcasts() {
+    if (broadcast_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        config_.scheduler->cancel(broadcast_task_);
+        broadcast_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    
+    // A controller connected meanwhile and will read current values itself
+    if (session_manager_->session_count() > 0) {
+        broadcasts_.clear();
+        return;
+    }
+    
+    uint64_t now = config_.system->millis();
+    bool finished = broadcasts_.release(now);
+    if (auto slot = broadcasts_.next(now)) {
+        send_broadcasted_event(slot->iid, slot->value);
+    } else if (finished) {
+        HAP_LOG_DEBUG(config_.system, "[BleTransport] Broadcasts done, back to regular advertising");
+        flush_advertising();
+    }
+    
+    if (auto busy_until = broadcasts_.busy_until_ms()) {
+        uint32_t delay = *busy_until > now ? static_cast<uint32_t>(*busy_until - now) : 0;
+        broadcast_task_ = config_.scheduler->schedule_once(delay, [this]() {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            broadcast_task_ = common::TaskScheduler::INVALID_TASK_ID;
+            flush_broadcasts();
+        });
+    }
+}
+
+void BleTransport::cancel_broadcasts() {
+    if (broadcast_task_ != common::TaskScheduler::INVALID_TASK_ID) {
+        config_.scheduler->cancel(broadcast_task_);
+        broadcast_task_ = common::TaskScheduler::INVALID_TASK_ID;
+    }
+    broadcasts_.clear();
+}
+
+uint32_t BleTransport::broadcast_interval_ms(uint16_t iid) const {
+    auto it = broadcast_configs_.find(iid);
+    if (it == broadcast_configs_.end()) return 20;
+    switch (it->second.interval) {
+        case 0x02: return 1280;
+        case 0x03: return 2560;
+        default: return 20;
+    }
 }
 
 void BleTransport::send_disconnected_event(uint16_t iid) {
@@ -1842,66 +2003,33 @@ void BleTransport::send_disconnected_event(uint16_t iid) {
     // Increment GSN (once per disconnected period until connected) and
     // use 20ms advertising for at least 3 seconds, then revert to normal.
     
-    config_.system->log(platform::System::LogLevel::Debug,
+    HAP_LOG_DEBUG(config_.system,
         "[BleTransport] Disconnected Event for IID=" + std::to_string(iid));
     
     increment_gsn();
     
-    std::string setup_id;
-    auto setup_id_bytes = config_.storage->get("setup_id");
-    if (setup_id_bytes && setup_id_bytes->size() == 4) {
-        setup_id = std::string(setup_id_bytes->begin(), setup_id_bytes->end());
-    } else {
-        setup_id = "X-HZ";
-    }
-    
-    std::string input = setup_id + config_.accessory_id;
-    std::array<uint8_t, 64> hash_output = {};
-    config_.crypto->sha512(
-        std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(input.data()), input.size()),
-        std::span<uint8_t, 64>(hash_output.data(), 64)
-    );
-    uint8_t setup_hash[4];
-    std::copy_n(hash_output.begin(), 4, setup_hash);
-    
-    auto pairing_list = config_.storage->get("pairing_list");
-    bool is_paired = (pairing_list && pairing_list->size() > 2);
-    uint8_t status_flags = is_paired ? 0x00 : 0x01;
-    
-    uint8_t device_id[6] = {0};
-    sscanf(config_.accessory_id.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
-        &device_id[0], &device_id[1], &device_id[2],
-        &device_id[3], &device_id[4], &device_id[5]);
-    
-    uint16_t gsn = get_current_gsn();
-    
-    uint8_t config_number = 1;
-    auto cn_bytes = config_.storage->get("config_number");
-    if (cn_bytes && !cn_bytes->empty()) {
-        std::string cn_str(cn_bytes->begin(), cn_bytes->end());
-        config_number = static_cast<uint8_t>(std::stoi(cn_str));
-    }
-    
-    auto adv = platform::Ble::Advertisement::create_hap(
-        status_flags, device_id, config_.category_id, gsn, config_number, setup_hash);
-    adv.local_name = config_.device_name;
+    auto adv = build_advertisement();
+    if (!adv) return;
     
     // Per HAP Spec 7.4.6.3: Use fast interval (20 ms) for 3 seconds, then normal interval
-    config_.system->log(platform::System::LogLevel::Info,
+    HAP_LOG_INFO(config_.system,
         "[BleTransport] Starting timed advertising for Disconnected Event (" + 
         std::to_string(config_.ble->interval_config.fast_interval_ms) + "ms for " +
         std::to_string(config_.ble->interval_config.fast_duration_ms) + "ms)");
     config_.ble->start_timed_advertising(
-        adv, 
+        *adv, 
         config_.ble->interval_config.fast_interval_ms,
         config_.ble->interval_config.fast_duration_ms,
         config_.ble->interval_config.normal_interval_ms
     );
+    // The pending refresh from increment_gsn() would only restart the same payload
+    current_advertisement_ = std::move(adv);
     
     (void)iid;
 }
 
-std::vector<uint8_t> BleTransport::build_encrypted_advertisement_payload(uint16_t iid, const core::Value& value) {
+bool BleTransport::build_encrypted_advertisement_payload(uint16_t iid, const core::Value& value,
+                                                         std::span<uint8_t, 16> out) {
     // Per HAP Spec 7.4.7.3 Broadcast Encryption:
     // Payload: 12 bytes = GSN(2) + IID(2) + Value(8, with padding)
     // Nonce: GSN padded to 12 bytes with zeros
@@ -1909,57 +2037,41 @@ std::vector<uint8_t> BleTransport::build_encrypted_advertisement_payload(uint16_
     // AuthTag: First 4 bytes of 16-byte ChaCha20-Poly1305 tag
     
     if (!is_broadcast_key_valid()) {
-        return {};
+        return false;
     }
     
     uint16_t gsn = get_current_gsn();
     
-    std::vector<uint8_t> plaintext(12, 0);
+    std::array<uint8_t, 12> plaintext = {};
     plaintext[0] = gsn & 0xFF;
     plaintext[1] = (gsn >> 8) & 0xFF;
     plaintext[2] = iid & 0xFF;
     plaintext[3] = (iid >> 8) & 0xFF;
-    
-    std::vector<uint8_t> value_bytes = core::CharacteristicSerializer::to_bytes(value);
-    for (size_t i = 0; i < 8 && i < value_bytes.size(); ++i) {
-        plaintext[4 + i] = value_bytes[i];
-    }
+    write_broadcast_value(value, std::span<uint8_t, 8>(plaintext.data() + 4, 8));
     
     std::array<uint8_t, 12> nonce = {};
     nonce[0] = gsn & 0xFF;
     nonce[1] = (gsn >> 8) & 0xFF;
     
-    std::array<uint8_t, 6> aad = {};
-    sscanf(config_.accessory_id.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx",
-        &aad[0], &aad[1], &aad[2], &aad[3], &aad[4], &aad[5]);
-    
-    std::vector<uint8_t> ciphertext(12);
     std::array<uint8_t, 16> full_tag = {};
     
-    std::array<uint8_t, 32> key_copy;
-    std::copy(broadcast_key_.begin(), broadcast_key_.end(), key_copy.begin());
-    
     bool success = config_.crypto->chacha20_poly1305_encrypt_and_tag(
-        key_copy,
+        broadcast_key_.key,
         nonce,
-        std::span<const uint8_t>(aad.data(), 6),
+        advertising_id(),
         plaintext,
-        ciphertext,
+        out.first<12>(),
         full_tag
     );
     
     if (!success) {
-        config_.system->log(platform::System::LogLevel::Error,
+        HAP_LOG_ERROR(config_.system,
             "[BleTransport] Broadcast encryption failed");
-        return {};
+        return false;
     }
     
-    std::vector<uint8_t> result;
-    result.reserve(16);
-    result.insert(result.end(), ciphertext.begin(), ciphertext.end());
-    result.insert(result.end(), full_tag.begin(), full_tag.begin() + 4);
-    
-    return result;
+    std::copy_n(full_tag.begin(), 4, out.begin() + 12);
+    return true;
 }
 
 } // namespace hap::transport
@@ -0,0 +1,100 @@
+#include "hap/transport/CharacteristicOps.hpp"
+
+namespace hap::transport {
+
+core::HAPStatus CharacteristicOps::check_read(const core::Characteristic* characteristic) {
+    if (!characteristic) return core::HAPStatus::ResourceDoesNotExist;
+    if (!characteristic->has_permission(core::Permission::PairedRead)) {
+        return core::HAPStatus::WriteOnlyCharacteristic;
+    }
+    return core::HAPStatus::Success;
+}
+
+core::HAPStatus CharacteristicOps::check_write(const core::Characteristic* characteristic) {
+    if (!characteristic) return core::HAPStatus::ResourceDoesNotExist;
+    if (!characteristic->has_permission(core::Permission::PairedWrite)) {
+        return core::HAPStatus::ReadOnlyCharacteristic;
+    }
+    return core::HAPStatus::Success;
+}
+
+core::HAPStatus CharacteristicOps::check_notify(const core::Characteristic* characteristic) {
+    if (!characteristic) return core::HAPStatus::ResourceDoesNotExist;
+    if (!characteristic->has_permission(core::Permission::Notify)) {
+        return core::HAPStatus::NotificationNotSupported;
+    }
+    return core::HAPStatus::Success;
+}
+
+core::HAPStatus CharacteristicOps::check_timed_write(const core::Characteristic& characteristic,
+                                                     const TimedWriteTable& prepared,
+                                                     std::optional<uint64_t> key, uint64_t now_ms) {
+    if (!characteristic.has_permission(core::Permission::TimedWrite)) {
+        return core::HAPStatus::Success;
+    }
+    if (!key || !prepared.contains(*key, now_ms)) {
+        return core::HAPStatus::InvalidValueInRequest;
+    }
+    return core::HAPStatus::Success;
+}
+
+CharacteristicOps::ReadOutcome CharacteristicOps::read(const core::Characteristic* characteristic,
+                                                       core::Value& scratch) {
+    ReadOutcome outcome;
+    outcome.status = check_read(characteristic);
+    if (outcome.status != core::HAPStatus::Success) return outcome;
+    
+    // Points at the stored value unless a read callback filled scratch
+    auto result = characteristic->read_value(scratch);
+    if (auto* status = std::get_if<core::HAPStatus>(&result)) {
+        outcome.status = *status;
+    } else {
+        outcome.value = std::get<const core::Value*>(result);
+    }
+    return outcome;
+}
+
+CharacteristicOps::WriteResponseOutcome CharacteristicOps::write_response(core::Characteristic& characteristic) {
+    WriteResponseOutcome outcome;
+    if (!characteristic.has_permission(core::Permission::WriteResponse)) {
+        return outcome;
+    }
+    core::Value scratch;
+    auto read_result = characteristic.read_value(scratch);
+    if (!std::holds_alternative<const core::Value*>(read_result)) {
+        return outcome;
+    }
+    const core::Value& input_value = *std::get<const core::Value*>(read_result);
+    auto response = characteristic.handle_write_response(input_value);
+    if (!response) {
+        // No callback, use the current value
+        outcome.value = input_value;
+    } else if (auto* status = std::get_if<core::HAPStatus>(&*response)) {
+        outcome.status = *status;
+    } else {
+        outcome.value = std::get<core::Value>(std::move(*response));
+    }
+    return outcome;
+}
+
+uint8_t CharacteristicOps::to_ble_status(core::HAPStatus status) {
+    switch (status) {
+        case core::HAPStatus::Success:
+            return 0x00;
+        case core::HAPStatus::InsufficientPrivileges:
+        case core::HAPStatus::InsufficientAuthorization:
+            return 0x03;  // Insufficient Authorization
+        case core::HAPStatus::ResourceDoesNotExist:
+            return 0x05;
+        case core::HAPStatus::ReadOnlyCharacteristic:
+        case core::HAPStatus::WriteOnlyCharacteristic:
+        case core::HAPStatus::NotificationNotSupported:
+        case core::HAPStatus::InvalidValueInRequest:
+            return 0x06;  // Invalid Request
+        default:
+            // Callback failures (busy, timeout, communication) have no BLE code of their own
+            return 0x02;
+    }
+}
+
+} // namespace hap::transport
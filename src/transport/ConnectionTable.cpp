@@ -0,0 +1,81 @@
+#include "hap/transport/ConnectionTable.hpp"
+#include <algorithm>
+
+namespace hap::transport {
+
+ConnectionTable::ConnectionTable(size_t capacity, platform::Crypto* crypto, platform::System* system,
+                                 size_t arena_bytes, size_t outbound_bytes)
+    : crypto_(crypto), system_(system), arena_bytes_(arena_bytes), outbound_bytes_(outbound_bytes),
+      ids_(capacity, FREE) {
+    slots_.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        slots_.push_back(make_connection(FREE));
+    }
+}
+
+std::shared_ptr<Connection> ConnectionTable::make_connection(uint32_t connection_id) const {
+    auto connection = std::make_shared<Connection>(crypto_, system_, connection_id, arena_bytes_);
+    connection->ctx.outbound().set_max_bytes(outbound_bytes_);
+    return connection;
+}
+
+size_t ConnectionTable::index_of(uint32_t connection_id) const {
+    for (size_t i = 0; i < ids_.size(); ++i) {
+        if (ids_[i] == connection_id) return i;
+    }
+    return ids_.size();
+}
+
+std::shared_ptr<Connection> ConnectionTable::find(uint32_t connection_id) const {
+    if (connection_id == FREE) return nullptr;
+    size_t i = index_of(connection_id);
+    return i < ids_.size() ? slots_[i] : nullptr;
+}
+
+std::shared_ptr<Connection> ConnectionTable::acquire(uint32_t connection_id, bool* created) {
+    if (created) *created = false;
+    if (connection_id == FREE) return nullptr;
+    
+    size_t free_slot = ids_.size();
+    for (size_t i = 0; i < ids_.size(); ++i) {
+        if (ids_[i] == connection_id) return slots_[i];
+        if (ids_[i] == FREE && free_slot == ids_.size()) free_slot = i;
+    }
+    if (free_slot == ids_.size()) return nullptr;
+    
+    auto& slot = slots_[free_slot];
+    if (slot.use_count() == 1) {
+        slot->ctx.reopen(connection_id);
+        slot->parser.reset();
+        slot->last_receive_ms = 0;
+        slot->request_started_ms = 0;
+        slot->timed_write_expiry_ms = 0;
+        slot->bytes_received = 0;
+        slot->drain_scheduled = false;
+        slot->drain_retry_ms = 0;
+        slot->drain_backoff_ms = 0;
+    } else {
+        // A strand still holds the previous connection; leave it to finish
+        slot = make_connection(connection_id);
+    }
+    ids_[free_slot] = connection_id;
+    ++size_;
+    if (created) *created = true;
+    return slot;
+}
+
+bool ConnectionTable::release(uint32_t connection_id) {
+    if (connection_id == FREE) return false;
+    size_t i = index_of(connection_id);
+    if (i == ids_.size()) return false;
+    ids_[i] = FREE;
+    --size_;
+    return true;
+}
+
+void ConnectionTable::clear() {
+    std::fill(ids_.begin(), ids_.end(), FREE);
+    size_ = 0;
+}
+
+} // namespace hap::transport
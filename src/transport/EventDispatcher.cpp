@@ -0,0 +1,236 @@
+#include "hap/transport/EventDispatcher.hpp"
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+namespace hap::transport {
+
+namespace {
+
+// Order of entries does not matter, so erase by swapping with the last one
+template<typename T>
+bool erase_unordered(std::vector<T>& items, T item) {
+    auto it = std::find(items.begin(), items.end(), item);
+    if (it == items.end()) return false;
+    *it = items.back();
+    items.pop_back();
+    return true;
+}
+
+} // namespace
+
+void EventDispatcher::subscribe(uint32_t connection_id, uint64_t aid, uint64_t iid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t key = pack_key(aid, iid);
+    auto& connections = subscribers_[key];
+    if (std::find(connections.begin(), connections.end(), connection_id) != connections.end()) {
+        return;
+    }
+    connections.push_back(connection_id);
+    connection_keys_[connection_id].push_back(key);
+}
+
+void EventDispatcher::unsubscribe(uint32_t connection_id, uint64_t aid, uint64_t iid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t key = pack_key(aid, iid);
+    auto it = subscribers_.find(key);
+    if (it == subscribers_.end() || !erase_unordered(it->second, connection_id)) {
+        return;
+    }
+    if (it->second.empty()) subscribers_.erase(it);
+
+    auto keys = connection_keys_.find(connection_id);
+    if (keys != connection_keys_.end()) {
+        erase_unordered(keys->second, key);
+        if (keys->second.empty()) connection_keys_.erase(keys);
+    }
+}
+
+size_t EventDispatcher::subscription_count(uint32_t connection_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto keys = connection_keys_.find(connection_id);
+    return keys == connection_keys_.end() ? 0 : keys->second.size();
+}
+
+void EventDispatcher::remove_connection(uint32_t connection_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto keys = connection_keys_.find(connection_id);
+    if (keys == connection_keys_.end()) return;
+
+    for (uint64_t key : keys->second) {
+        auto it = subscribers_.find(key);
+        if (it == subscribers_.end()) continue;
+        erase_unordered(it->second, connection_id);
+        if (it->second.empty()) subscribers_.erase(it);
+    }
+    connection_keys_.erase(keys);
+}
+
+void EventDispatcher::remove_accessory(uint64_t aid) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t prefix = pack_key(aid, 0) >> 32;
+    auto belongs = [prefix](uint64_t key) { return (key >> 32) == prefix; };
+
+    for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+        if (!belongs(it->first)) {
+            ++it;
+            continue;
+        }
+        for (uint32_t connection_id : it->second) {
+            auto keys = connection_keys_.find(connection_id);
+            if (keys == connection_keys_.end()) continue;
+            erase_unordered(keys->second, it->first);
+            if (keys->second.empty()) connection_keys_.erase(keys);
+        }
+        it = subscribers_.erase(it);
+    }
+
+    std::erase_if(pending_, [&](const PendingChange& change) { return belongs(change.key); });
+}
+
+const std::vector<uint32_t>* EventDispatcher::find_subscribers(uint64_t key) const {
+    auto it = subscribers_.find(key);
+    return it == subscribers_.end() ? nullptr : &it->second;
+}
+
+bool EventDispatcher::is_subscribed(uint32_t connection_id, uint64_t aid, uint64_t iid) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto* connections = find_subscribers(pack_key(aid, iid));
+    return connections && std::find(connections->begin(), connections->end(), connection_id) != connections->end();
+}
+
+bool EventDispatcher::has_subscribers(uint64_t aid, uint64_t iid) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return find_subscribers(pack_key(aid, iid)) != nullptr;
+}
+
+std::vector<uint32_t> EventDispatcher::subscribers(uint64_t aid, uint64_t iid) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto* connections = find_subscribers(pack_key(aid, iid));
+    return connections ? *connections : std::vector<uint32_t>{};
+}
+
+bool EventDispatcher::has_pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !pending_.empty();
+}
+
+std::span<const uint8_t> EventDispatcher::render_event(uint64_t aid, uint64_t iid, const core::Value& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    body_.clear();
+    core::JSONWriter writer(body_);
+    writer.begin_object();
+    writer.key("characteristics");
+    writer.begin_array();
+    write_change(writer, aid, iid, value);
+    writer.end_array();
+    writer.end_object();
+    
+    frame_body();
+    return message_;
+}
+
+bool EventDispatcher::enqueue(uint64_t aid, uint64_t iid, const core::Value& value, uint32_t exclude_conn_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t key = pack_key(aid, iid);
+    for (auto& change : pending_) {
+        if (change.key == key) {
+            // Superseded: only the latest value is worth sending
+            change.value = value;
+            change.exclude_conn_id = exclude_conn_id;
+            return false;
+        }
+    }
+    pending_.push_back({key, aid, iid, value, exclude_conn_id});
+    return pending_.size() == 1;
+}
+
+void EventDispatcher::flush(const SendFunc& send) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PendingChange> pending;
+    pending.swap(pending_);
+    if (pending.empty()) return;
+
+    std::vector<uint32_t> connections;
+    for (const auto& change : pending) {
+        if (auto* subscribed = find_subscribers(change.key)) {
+            connections.insert(connections.end(), subscribed->begin(), subscribed->end());
+        }
+    }
+    std::sort(connections.begin(), connections.end());
+    connections.erase(std::unique(connections.begin(), connections.end()), connections.end());
+
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> rendered;
+    std::vector<uint64_t> keys;
+    for (uint32_t connection_id : connections) {
+        indices.clear();
+        for (uint32_t i = 0; i < pending.size(); ++i) {
+            const auto& change = pending[i];
+            if (change.exclude_conn_id == connection_id) continue;
+            auto* subscribed = find_subscribers(change.key);
+            if (subscribed && std::find(subscribed->begin(), subscribed->end(), connection_id) != subscribed->end()) {
+                indices.push_back(i);
+            }
+        }
+        if (indices.empty()) continue;
+
+        // Controllers usually share the same subscriptions; render once for them
+        if (indices != rendered) {
+            render_pending(pending, indices);
+            rendered = indices;
+            keys.clear();
+            for (uint32_t i : indices) keys.push_back(pending[i].key);
+        }
+        send(connection_id, message_, keys);
+    }
+}
+
+void EventDispatcher::render_pending(const std::vector<PendingChange>& pending, std::span<const uint32_t> indices) {
+    body_.clear();
+    core::JSONWriter writer(body_);
+    writer.begin_object();
+    writer.key("characteristics");
+    writer.begin_array();
+    for (uint32_t i : indices) {
+        write_change(writer, pending[i].aid, pending[i].iid, pending[i].value);
+    }
+    writer.end_array();
+    writer.end_object();
+
+    frame_body();
+}
+
+void EventDispatcher::write_change(core::JSONWriter& writer, uint64_t aid, uint64_t iid, const core::Value& value) {
+    writer.begin_object();
+    writer.key("aid");
+    writer.value(aid);
+    writer.key("iid");
+    writer.value(iid);
+    writer.key("value");
+    writer.value(value);
+    writer.end_object();
+}
+
+void EventDispatcher::frame_body() {
+    static constexpr std::string_view kHeader = "EVENT/1.0 200 OK\r\n"
+                                                "Content-Type: application/hap+json\r\n"
+                                                "Content-Length: ";
+    char length[20];
+    auto [end, ec] = std::to_chars(length, length + sizeof(length), body_.size());
+    (void)ec;
+
+    static constexpr std::string_view kBlankLine = "\r\n\r\n";
+
+    // Sized once and filled in place; GCC 12 also misreports chained
+    // inserts after clear() as overflows at -O2
+    const size_t length_size = static_cast<size_t>(end - length);
+    message_.resize(kHeader.size() + length_size + kBlankLine.size() + body_.size());
+    auto out = message_.begin();
+    out = std::copy(kHeader.begin(), kHeader.end(), out);
+    out = std::copy(length, end, out);
+    out = std::copy(kBlankLine.begin(), kBlankLine.end(), out);
+    std::copy(body_.begin(), body_.end(), out);
+}
+
+} // namespace hap::transport
@@ -1,65 +1,114 @@
 #include "hap/transport/HTTP.hpp"
 #include <algorithm>
-#include <iostream>
-#include <sstream>
+#include <charconv>
 
 namespace hap::transport {
 
-HTTPParser::HTTPParser() : state_(State::RequestLine), body_bytes_read_(0), expected_body_length_(0) {}
+static constexpr size_t kMaxBodyReserve = 16 * 1024;
+
+HTTPParser::HTTPParser(size_t arena_bytes)
+    : state_(State::RequestLine),
+      arena_(arena_bytes > 0 ? std::make_unique<common::RequestArena>(arena_bytes) : nullptr),
+      read_pos_(0),
+      current_request_(arena_ ? arena_->resource() : std::pmr::get_default_resource()),
+      body_bytes_read_(0), expected_body_length_(0) {}
 
 bool HTTPParser::feed(std::span<const uint8_t> data) {
     buffer_.insert(buffer_.end(), data.begin(), data.end());
+    return parse();
+}
 
-    while (state_ != State::Complete) {
+bool HTTPParser::parse() {
+    while (state_ != State::Complete && state_ != State::Failed) {
         if (state_ == State::RequestLine) {
-            if (!parse_request_line()) return false;
+            if (!parse_request_line()) break;
         } else if (state_ == State::Headers) {
-            if (!parse_headers()) return false;
+            if (!parse_headers()) break;
         } else if (state_ == State::Body) {
             size_t remaining = expected_body_length_ - body_bytes_read_;
-            size_t available = buffer_.size();
+            size_t available = buffer_.size() - read_pos_;
             size_t to_read = std::min(remaining, available);
 
-            current_request_.body.insert(current_request_.body.end(), buffer_.begin(), buffer_.begin() + to_read);
-            buffer_.erase(buffer_.begin(), buffer_.begin() + to_read);
+            auto begin = buffer_.begin() + static_cast<std::ptrdiff_t>(read_pos_);
+            current_request_.body.insert(current_request_.body.end(), begin, begin + static_cast<std::ptrdiff_t>(to_read));
+            read_pos_ += to_read;
             body_bytes_read_ += to_read;
 
             if (body_bytes_read_ >= expected_body_length_) {
                 state_ = State::Complete;
+            } else {
+                break;
             }
         }
     }
 
+    // Drop consumed bytes once per call rather than once per line
+    if (read_pos_ > 0) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(read_pos_));
+        read_pos_ = 0;
+    }
+
+    // A head that never ends (no CRLF, endless headers) is cut off here
+    if (max_request_bytes_ > 0 && (state_ == State::RequestLine || state_ == State::Headers) &&
+        head_bytes_ + buffer_.size() > max_request_bytes_) {
+        state_ = State::Failed;
+    }
+
     return state_ == State::Complete;
 }
 
 Request HTTPParser::take_request() {
-    return std::move(current_request_);
+    Request request = std::move(current_request_);
+    state_ = State::RequestLine;
+    current_request_ = Request(current_request_.path.get_allocator().resource());
+    body_bytes_read_ = 0;
+    expected_body_length_ = 0;
+    head_bytes_ = 0;
+    return request;
+}
+
+void HTTPParser::release_request_memory() {
+    if (arena_ && state_ == State::RequestLine) {
+        // Drop the empty request's reservations before rewinding under it
+        current_request_ = Request(arena_->resource());
+        arena_->reset();
+    }
 }
 
 void HTTPParser::reset() {
     state_ = State::RequestLine;
     buffer_.clear();
-    current_request_ = Request{};
+    read_pos_ = 0;
+    current_request_ = Request(current_request_.path.get_allocator().resource());
     body_bytes_read_ = 0;
     expected_body_length_ = 0;
+    head_bytes_ = 0;
+    malformed_ = false;
 }
 
-bool HTTPParser::parse_request_line() {
+std::optional<std::string_view> HTTPParser::next_line() {
     // Look for \r\n
-    const char crlf[] = "\r\n";
-    auto it = std::search(buffer_.begin(), buffer_.end(), crlf, crlf + 2);
-    if (it == buffer_.end()) return false;
+    const char* data = reinterpret_cast<const char*>(buffer_.data());
+    std::string_view pending(data + read_pos_, buffer_.size() - read_pos_);
+    size_t crlf = pending.find("\r\n");
+    if (crlf == std::string_view::npos) return std::nullopt;
 
-    std::string line(buffer_.begin(), it);
-    buffer_.erase(buffer_.begin(), it + 2);
+    read_pos_ += crlf + 2;
+    head_bytes_ += crlf + 2;
+    return pending.substr(0, crlf);
+}
 
-    // Parse "METHOD /path HTTP/1.1"
-    std::istringstream iss(line);
-    std::string method_str, path, version;
-    iss >> method_str >> path >> version;
+bool HTTPParser::parse_request_line() {
+    auto line = next_line();
+    if (!line) return false;
 
-    std::cout << "Method: " << method_str << " Path: " << path << " Version: " << version << std::endl;
+    // Parse "METHOD /path HTTP/1.1"
+    std::string_view rest = *line;
+    size_t sp = rest.find(' ');
+    std::string_view method_str = rest.substr(0, sp);
+    rest = (sp == std::string_view::npos) ? std::string_view{} : rest.substr(sp + 1);
+    rest.remove_prefix(std::min(rest.find_first_not_of(' '), rest.size()));
+    std::string_view path = rest.substr(0, rest.find(' '));
 
     if (method_str == "GET") current_request_.method = Method::GET;
     else if (method_str == "POST") current_request_.method = Method::POST;
@@ -67,26 +116,45 @@ bool HTTPParser::parse_request_line() {
     else if (method_str == "DELETE") current_request_.method = Method::DELETE;
     else if (method_str == "OPTIONS") current_request_.method = Method::OPTIONS;
 
-    current_request_.path = path;
+    // Split the query off once so routing and handlers never search for '?'
+    size_t query_start = path.find('?');
+    if (query_start != std::string_view::npos) {
+        current_request_.query.assign(path.substr(query_start + 1));
+        path = path.substr(0, query_start);
+    }
+    current_request_.path.assign(path);
+    // One allocation holds every header name and value
+    current_request_.headers.reserve(256);
     state_ = State::Headers;
     return true;
 }
 
 bool HTTPParser::parse_headers() {
-    const char crlf[] = "\r\n";
     while (true) {
-        auto it = std::search(buffer_.begin(), buffer_.end(), crlf, crlf + 2);
-        if (it == buffer_.end()) return false;
+        auto line = next_line();
+        if (!line) return false;
 
-        std::string line(buffer_.begin(), it);
-        buffer_.erase(buffer_.begin(), it + 2);
-
-        if (line.empty()) {
+        if (line->empty()) {
             // End of headers
             // Check for Content-Length
-            auto content_length_it = current_request_.headers.find("Content-Length");
-            if (content_length_it != current_request_.headers.end()) {
-                expected_body_length_ = std::stoul(content_length_it->second);
+            std::string_view content_length = current_request_.headers.get("Content-Length");
+            if (!content_length.empty()) {
+                size_t length = 0;
+                const char* end = content_length.data() + content_length.size();
+                auto [ptr, ec] = std::from_chars(content_length.data(), end, length);
+                if (ec != std::errc{} || ptr != end) {
+                    malformed_ = true;
+                    state_ = State::Failed;
+                    return false;
+                }
+                if (max_request_bytes_ > 0 && length > max_request_bytes_ - std::min(head_bytes_, max_request_bytes_)) {
+                    state_ = State::Failed;
+                    return false;
+                }
+                expected_body_length_ = length;
+                // One allocation for the body (arenas never reclaim grown-out
+                // blocks), bounded so a bogus length cannot reserve much
+                current_request_.body.reserve(std::min<size_t>(length, kMaxBodyReserve));
                 state_ = State::Body;
             } else {
                 state_ = State::Complete;
@@ -95,46 +163,106 @@ bool HTTPParser::parse_headers() {
         }
 
         // Parse "Key: Value"
-        size_t colon = line.find(':');
-        if (colon != std::string::npos) {
-            std::string key = line.substr(0, colon);
-            std::string value = line.substr(colon + 1);
+        size_t colon = line->find(':');
+        if (colon != std::string_view::npos) {
+            std::string_view key = line->substr(0, colon);
+            std::string_view value = line->substr(colon + 1);
             // Trim whitespace from value
-            value.erase(0, value.find_first_not_of(" \t"));
-            current_request_.headers[key] = value;
+            value.remove_prefix(std::min(value.find_first_not_of(" \t"), value.size()));
+            // A dropped header could be the Content-Length, so don't guess
+            if (!current_request_.headers.add(key, value)) {
+                malformed_ = true;
+                state_ = State::Failed;
+                return false;
+            }
         }
     }
 }
 
-std::vector<uint8_t> HTTPBuilder::build(const Response& response) {
-    std::ostringstream ss;
-    
-    ss << "HTTP/1.1 " << static_cast<int>(response.status);
-    switch (response.status) {
-        case Status::OK: ss << " OK"; break;
-        case Status::NoContent: ss << " No Content"; break;
-        case Status::MultiStatus: ss << " Multi-Status"; break;
-        case Status::BadRequest: ss << " Bad Request"; break;
-        case Status::Unauthorized: ss << " Unauthorized"; break;
-        case Status::NotFound: ss << " Not Found"; break;
-        case Status::UnprocessableEntity: ss << " Unprocessable Entity"; break;
-        case Status::MethodNotAllowed: ss << " Method Not Allowed"; break;
-        case Status::InternalServerError: ss << " Internal Server Error"; break;
-        case Status::ServiceUnavailable: ss << " Service Unavailable"; break;
+static std::string_view status_line(Status status) {
+    switch (status) {
+        case Status::OK: return "HTTP/1.1 200 OK\r\n";
+        case Status::NoContent: return "HTTP/1.1 204 No Content\r\n";
+        case Status::MultiStatus: return "HTTP/1.1 207 Multi-Status\r\n";
+        case Status::BadRequest: return "HTTP/1.1 400 Bad Request\r\n";
+        case Status::Unauthorized: return "HTTP/1.1 401 Unauthorized\r\n";
+        case Status::NotFound: return "HTTP/1.1 404 Not Found\r\n";
+        case Status::UnprocessableEntity: return "HTTP/1.1 422 Unprocessable Entity\r\n";
+        case Status::MethodNotAllowed: return "HTTP/1.1 405 Method Not Allowed\r\n";
+        case Status::InternalServerError: return "HTTP/1.1 500 Internal Server Error\r\n";
+        case Status::ServiceUnavailable: return "HTTP/1.1 503 Service Unavailable\r\n";
     }
-    ss << "\r\n";
+    return "HTTP/1.1 500 Internal Server Error\r\n";
+}
 
+std::vector<uint8_t> HTTPBuilder::build(const Response& response) {
+    std::vector<uint8_t> result;
+    result.reserve(head_size(response) + response.body.size());
+    append_head(response, result);
+    result.insert(result.end(), response.body.begin(), response.body.end());
+    return result;
+}
+
+size_t HTTPBuilder::head_size(const Response& response) {
+    static constexpr std::string_view kContentLength = "Content-Length: ";
+    size_t size = status_line(response.status).size() + 2;
     for (const auto& [key, value] : response.headers) {
-        ss << key << ": " << value << "\r\n";
+        if (key != "Content-Length") size += key.size() + 2 + value.size() + 2;
     }
+    if (response.status != Status::NoContent) {
+        size += kContentLength.size() + 20 + 2;  // Upper bound for the digits
+    }
+    return size;
+}
 
-    ss << "\r\n";
-
-    std::string header_str = ss.str();
-    std::vector<uint8_t> result(header_str.begin(), header_str.end());
-    result.insert(result.end(), response.body.begin(), response.body.end());
+void HTTPBuilder::append_head(const Response& response, std::vector<uint8_t>& out) {
+    static constexpr std::string_view kContentLength = "Content-Length: ";
+    static constexpr std::string_view kCRLF = "\r\n";
+    
+    // Sized once for the worst case, then written in place and trimmed
+    size_t start = out.size();
+    out.resize(start + head_size(response));
+    char* p = reinterpret_cast<char*>(out.data() + start);
+    auto put = [&p](std::string_view text) { p = std::copy(text.begin(), text.end(), p); };
+    
+    put(status_line(response.status));
+    for (const auto& [key, value] : response.headers) {
+        if (key == "Content-Length") continue;  // Always derived from the body
+        put(key);
+        put(": ");
+        put(value);
+        put(kCRLF);
+    }
+    if (response.status != Status::NoContent) {
+        put(kContentLength);
+        p = std::to_chars(p, p + 20, response.body.size()).ptr;
+        put(kCRLF);
+    }
+    put(kCRLF);
+    out.resize(static_cast<size_t>(reinterpret_cast<uint8_t*>(p) - out.data()));
+}
 
-    return result;
+void HTTPBuilder::append_head(Status status, std::string_view content_type, size_t content_length,
+                              std::vector<uint8_t>& out) {
+    static constexpr std::string_view kContentType = "Content-Type: ";
+    static constexpr std::string_view kContentLength = "Content-Length: ";
+    static constexpr std::string_view kCRLF = "\r\n";
+    
+    size_t start = out.size();
+    out.resize(start + status_line(status).size() + kContentType.size() + content_type.size() +
+               kContentLength.size() + 20 + 3 * kCRLF.size());
+    char* p = reinterpret_cast<char*>(out.data() + start);
+    auto put = [&p](std::string_view text) { p = std::copy(text.begin(), text.end(), p); };
+    
+    put(status_line(status));
+    put(kContentType);
+    put(content_type);
+    put(kCRLF);
+    put(kContentLength);
+    p = std::to_chars(p, p + 20, content_length).ptr;
+    put(kCRLF);
+    put(kCRLF);
+    out.resize(static_cast<size_t>(reinterpret_cast<uint8_t*>(p) - out.data()));
 }
 
 } // namespace hap::transport
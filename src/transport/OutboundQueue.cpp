@@ -0,0 +1,105 @@
+#include "hap/transport/OutboundQueue.hpp"
+#include <algorithm>
+
+namespace hap::transport {
+
+void OutboundQueue::push(Message message) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    size_t size = message.size();
+
+    if (message.priority == Priority::Event) {
+        // Make room from events this one supersedes first, so no characteristic
+        // loses its only pending update; then from the oldest
+        if (stats_.queued_bytes + size > max_bytes_) {
+            replace_superseded_events(message);
+        }
+        while (!events_.empty() && stats_.queued_bytes + size > max_bytes_) {
+            drop_oldest_event();
+        }
+        if (stats_.queued_bytes + size > max_bytes_) {
+            ++stats_.dropped_events;
+            return;
+        }
+        events_.push_back(std::move(message));
+    } else {
+        responses_.push_back(std::move(message));
+    }
+
+    stats_.queued_bytes += size;
+    stats_.high_water_bytes = std::max(stats_.high_water_bytes, stats_.queued_bytes);
+    update_depth();
+}
+
+OutboundQueue::Message* OutboundQueue::front() {
+    if (!responses_.empty()) return &responses_.front();
+    if (!events_.empty()) return &events_.front();
+    return nullptr;
+}
+
+void OutboundQueue::pop(uint64_t sealed_frames) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    bool event = responses_.empty();
+    auto& queue = event ? events_ : responses_;
+    if (queue.empty()) return;
+
+    size_t size = queue.front().size();
+    stats_.queued_bytes -= size;
+    queue.pop_front();
+    ++stats_.sent_messages;
+    stats_.sent_events += event ? 1 : 0;
+    stats_.sent_bytes += size;
+    stats_.sealed_frames += sealed_frames;
+    update_depth();
+}
+
+void OutboundQueue::clear() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    responses_.clear();
+    events_.clear();
+    stats_.queued_bytes = 0;
+    update_depth();
+}
+
+void OutboundQueue::reset_stats() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    Stats current = stats_;
+    stats_ = Stats{};
+    stats_.depth = current.depth;
+    stats_.queued_bytes = current.queued_bytes;
+    stats_.high_water_bytes = current.queued_bytes;
+}
+
+void OutboundQueue::drop_oldest_event() {
+    stats_.queued_bytes -= events_.front().size();
+    events_.pop_front();
+    ++stats_.dropped_events;
+    update_depth();
+}
+
+void OutboundQueue::replace_superseded_events(const Message& newer) {
+    if (newer.keys.empty()) return;
+    std::erase_if(events_, [&](const Message& queued) {
+        bool superseded = !queued.keys.empty() &&
+            std::all_of(queued.keys.begin(), queued.keys.end(), [&](uint64_t key) {
+                return std::find(newer.keys.begin(), newer.keys.end(), key) != newer.keys.end();
+            });
+        if (superseded) {
+            stats_.queued_bytes -= queued.size();
+            ++stats_.replaced_events;
+        }
+        return superseded;
+    });
+    update_depth();
+}
+
+OutboundQueue::Stats OutboundQueue::stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+void OutboundQueue::update_depth() {
+    stats_.depth = responses_.size() + events_.size();
+    pending_.store(stats_.depth > 0, std::memory_order_relaxed);
+}
+
+} // namespace hap::transport
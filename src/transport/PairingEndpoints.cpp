@@ -1,20 +1,37 @@
 #include "hap/transport/PairingEndpoints.hpp"
-#include <nlohmann/json.hpp>
+#include "hap/common/Log.hpp"
 
 namespace hap::transport {
 
-PairingEndpoints::PairingEndpoints(Config config) : config_(std::move(config)) {
-    config_.system->log(platform::System::LogLevel::Info, "[PairingEndpoints] Initialized");
+PairingEndpoints::PairingEndpoints(Config config)
+    : config_(std::move(config)), session_cache_(config_.system) {
+    HAP_LOG_INFO(config_.system, "[PairingEndpoints] Initialized");
 }
 
 Response PairingEndpoints::handle_pair_setup(const Request& req, ConnectionContext& ctx) {
-    config_.system->log(platform::System::LogLevel::Info, 
+    auto response_tlv = pair_setup(req.body, ctx);
+    
+    Response resp{Status::OK};
+    resp.set_header("Content-Type", "application/pairing+tlv8");
+    
+    if (response_tlv) {
+        resp.set_body(std::move(*response_tlv));
+    } else {
+        resp = Response{Status::InternalServerError};
+        resp.set_body("Pairing error");
+    }
+    
+    return resp;
+}
+
+std::optional<std::vector<uint8_t>> PairingEndpoints::pair_setup(std::span<const uint8_t> body, ConnectionContext& ctx) {
+    HAP_LOG_INFO(config_.system,
         "[PairingEndpoints] /pair-setup request from connection #" + std::to_string(ctx.connection_id()) + 
-        ", body size: " + std::to_string(req.body.size()));
+        ", body size: " + std::to_string(body.size()));
     
     // Parse request to check what state we're handling
-    auto tlvs = core::TLV8::parse(req.body);
-    auto state_val = core::TLV8::find_uint8(tlvs, static_cast<uint8_t>(pairing::TLVType::State));
+    core::TLV8View tlvs(body);
+    auto state_val = tlvs.find_uint8(static_cast<uint8_t>(pairing::TLVType::State));
     bool is_m1 = state_val && *state_val == static_cast<uint8_t>(pairing::PairingState::M1);
     
     // Get or create session
@@ -22,46 +39,58 @@ Response PairingEndpoints::handle_pair_setup(const Request& req, ConnectionConte
     // (BLE reconnects with same connection_id=0, so old completed session would be reused)
     auto& session = pair_setup_sessions_[ctx.connection_id()];
     if (!session || is_m1) {
-        config_.system->log(platform::System::LogLevel::Info, 
+        HAP_LOG_INFO(config_.system,
             "[PairingEndpoints] Creating new pair-setup session");
         pairing::PairSetup::Config setup_config;
         setup_config.crypto = config_.crypto;
-        setup_config.storage = config_.storage;
+        setup_config.pairing_store = config_.pairing_store;
         setup_config.system = config_.system;
         setup_config.accessory_id = config_.accessory_id;
         setup_config.setup_code = config_.setup_code;
+        setup_config.srp_verifiers = config_.srp_verifiers;
         setup_config.on_pairings_changed = config_.on_pairings_changed;
         session = std::make_unique<pairing::PairSetup>(setup_config);
     }
 
     // Handle request
-    auto response_tlv = session->handle_request(req.body);
+    auto response_tlv = session->handle_request(body);
+    
+    if (response_tlv) {
+        HAP_LOG_INFO(config_.system,
+            "[PairingEndpoints] Pair-setup response ready (" + std::to_string(response_tlv->size()) + " bytes)");
+    } else {
+        HAP_LOG_ERROR(config_.system,
+            "[PairingEndpoints] Pair-setup failed - no response from session");
+    }
+    
+    return response_tlv;
+}
+
+Response PairingEndpoints::handle_pair_verify(const Request& req, ConnectionContext& ctx) {
+    auto response_tlv = pair_verify(req.body, ctx);
     
     Response resp{Status::OK};
     resp.set_header("Content-Type", "application/pairing+tlv8");
     
     if (response_tlv) {
-        config_.system->log(platform::System::LogLevel::Info, 
-            "[PairingEndpoints] Pair-setup response ready (" + std::to_string(response_tlv->size()) + " bytes)");
-        resp.set_body(*response_tlv);
+        resp.set_body(std::move(*response_tlv));
     } else {
-        config_.system->log(platform::System::LogLevel::Error, 
-            "[PairingEndpoints] Pair-setup failed - no response from session");
         resp = Response{Status::InternalServerError};
-        resp.set_body("Pairing error");
+        resp.set_body("Verification error");
     }
     
     return resp;
 }
 
-Response PairingEndpoints::handle_pair_verify(const Request& req, ConnectionContext& ctx) {
-    config_.system->log(platform::System::LogLevel::Info, 
+std::optional<std::vector<uint8_t>> PairingEndpoints::pair_verify(std::span<const uint8_t> body, ConnectionContext& ctx) {
+    common::Metrics::Scope timer(config_.metrics, common::Metric::PairVerify);
+    HAP_LOG_INFO(config_.system,
         "[PairingEndpoints] /pair-verify request from connection #" + std::to_string(ctx.connection_id()) + 
-        ", body size: " + std::to_string(req.body.size()));
+        ", body size: " + std::to_string(body.size()));
     
     // Parse request to check what state we're handling
-    auto tlvs = core::TLV8::parse(req.body);
-    auto state_val = core::TLV8::find_uint8(tlvs, static_cast<uint8_t>(pairing::TLVType::State));
+    core::TLV8View tlvs(body);
+    auto state_val = tlvs.find_uint8(static_cast<uint8_t>(pairing::TLVType::State));
     bool is_m1 = state_val && *state_val == static_cast<uint8_t>(pairing::PairingState::M1);
     
     // Get or create session
@@ -69,138 +98,107 @@ Response PairingEndpoints::handle_pair_verify(const Request& req, ConnectionCont
     // (BLE reconnects with same connection_id=0, so old verified session would be reused)
     auto& session = pair_verify_sessions_[ctx.connection_id()];
     if (!session || is_m1) {
-        config_.system->log(platform::System::LogLevel::Info, 
+        HAP_LOG_INFO(config_.system,
             "[PairingEndpoints] Creating new pair-verify session");
         pairing::PairVerify::Config verify_config;
         verify_config.crypto = config_.crypto;
-        verify_config.storage = config_.storage;
+        verify_config.pairing_store = config_.pairing_store;
         verify_config.accessory_id = config_.accessory_id;
+        verify_config.session_cache = &session_cache_;
+        verify_config.system = config_.system;
         session = std::make_unique<pairing::PairVerify>(verify_config);
     }
 
     // Handle request
-    auto response_tlv = session->handle_request(req.body);
-    
-    Response resp{Status::OK};
-    resp.set_header("Content-Type", "application/pairing+tlv8");
+    auto response_tlv = session->handle_request(body);
     
     if (response_tlv) {
-        resp.set_body(*response_tlv);
-        
         // If verification succeeded, upgrade connection to encrypted
         if (session->is_verified()) {
-            config_.system->log(platform::System::LogLevel::Info, 
-                "[PairingEndpoints] Pair-verify succeeded - upgrading connection to encrypted");
+            HAP_LOG_INFO(config_.system,
+                std::string("[PairingEndpoints] Pair-verify ") + (session->is_resumed() ? "resumed" : "succeeded") +
+                " - upgrading connection to encrypted");
+            // /pairings checks the permission stored for this controller
+            auto pairing = config_.pairing_store->find(session->get_controller_id());
             ctx.upgrade_to_secure(
                 session->get_session_keys(),
                 session->get_shared_secret(),
-                session->get_controller_id());
+                session->get_controller_id(),
+                pairing && pairing->is_admin());
         } else {
-            config_.system->log(platform::System::LogLevel::Debug, 
+            HAP_LOG_DEBUG(config_.system,
                 "[PairingEndpoints] Pair-verify response sent (" + std::to_string(response_tlv->size()) + " bytes)");
         }
     } else {
-        config_.system->log(platform::System::LogLevel::Error, 
+        HAP_LOG_ERROR(config_.system,
             "[PairingEndpoints] Pair-verify failed - no response from session");
-        resp = Response{Status::InternalServerError};
-        resp.set_body("Verification error");
     }
     
-    return resp;
+    return response_tlv;
 }
 
 Response PairingEndpoints::handle_pairings(const Request& req, ConnectionContext& ctx) {
     if (!ctx.is_encrypted()) {
-        config_.system->log(platform::System::LogLevel::Error, "[PairingEndpoints] /pairings request on unencrypted connection");
+        HAP_LOG_ERROR(config_.system, "[PairingEndpoints] /pairings request on unencrypted connection");
         return Response{Status::Unauthorized};
     }
 
-    auto tlvs = core::TLV8::parse(req.body);
-    auto method_val = core::TLV8::find_uint8(tlvs, static_cast<uint8_t>(pairing::TLVType::Method));
+    core::TLV8View tlvs(req.body);
+    auto method_val = tlvs.find_uint8(static_cast<uint8_t>(pairing::TLVType::Method));
     if (!method_val) {
         return Response{Status::BadRequest};
     }
     
     pairing::PairingMethod method = static_cast<pairing::PairingMethod>(*method_val);
-    config_.system->log(platform::System::LogLevel::Info, 
+    HAP_LOG_INFO(config_.system,
         "[PairingEndpoints] /pairings method: " + std::to_string(static_cast<int>(method)));
 
-    std::vector<core::TLV> response_tlvs;
-    response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::State), static_cast<uint8_t>(pairing::PairingState::M2));
+    std::vector<uint8_t> body;
+    core::TLV8Writer response_tlvs(body);
+    response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::State), static_cast<uint8_t>(pairing::PairingState::M2));
 
     if (method == pairing::PairingMethod::AddPairing) {
         if (!ctx.is_admin()) {
-            response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Authentication));
+            response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Authentication));
         } else {
-            auto identifier = core::TLV8::find(tlvs, static_cast<uint8_t>(pairing::TLVType::Identifier));
-            auto public_key = core::TLV8::find(tlvs, static_cast<uint8_t>(pairing::TLVType::PublicKey));
+            auto identifier = tlvs.find(static_cast<uint8_t>(pairing::TLVType::Identifier));
+            auto public_key = tlvs.find(static_cast<uint8_t>(pairing::TLVType::PublicKey));
             
             if (!identifier || !public_key || public_key->size() != 32) {
-                 response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Unknown));
+                 response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Unknown));
             } else {
                 std::string pairing_id(identifier->begin(), identifier->end());
-                std::string pairing_key = "pairing_" + pairing_id;
-                config_.storage->set(pairing_key, *public_key);
-                
-                // Update list
-                auto list_data = config_.storage->get("pairing_list");
-                nlohmann::json list_json = list_data ? nlohmann::json::parse(list_data->begin(), list_data->end(), nullptr, false) : nlohmann::json::array();
-                if (list_json.is_discarded()) list_json = nlohmann::json::array();
+                std::array<uint8_t, 32> ltpk_arr;
+                std::copy_n(public_key->begin(), 32, ltpk_arr.begin());
+                auto permissions = tlvs.find_uint8(static_cast<uint8_t>(pairing::TLVType::Permissions));
 
-                bool exists = false;
-                for (const auto& id : list_json) {
-                    if (id == pairing_id) { exists = true; break; }
-                }
-                if (!exists) {
-                    list_json.push_back(pairing_id);
-                    std::string list_str = list_json.dump();
-                    config_.storage->set("pairing_list", std::vector<uint8_t>(list_str.begin(), list_str.end()));
-                    if (config_.on_pairings_changed) {
-                        std::array<uint8_t, 32> ltpk_arr;
-                        std::copy_n(public_key->begin(), 32, ltpk_arr.begin());
-                        config_.on_pairings_changed(pairing_id, ltpk_arr, true);
-                    }
+                auto added = config_.pairing_store->add(pairing_id, ltpk_arr,
+                    permissions.value_or(pairing::PairingStore::kPermissionAdmin));
+                if (added == pairing::PairingStore::AddResult::Full) {
+                    response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::MaxPeers));
+                } else if (added == pairing::PairingStore::AddResult::InvalidId) {
+                    response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Unknown));
+                } else if (added == pairing::PairingStore::AddResult::Added && config_.on_pairings_changed) {
+                    config_.on_pairings_changed(pairing_id, ltpk_arr, true);
                 }
             }
         }
     } else if (method == pairing::PairingMethod::RemovePairing) {
         if (!ctx.is_admin()) {
-            response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Authentication));
+            response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Authentication));
         } else {
-            auto identifier = core::TLV8::find(tlvs, static_cast<uint8_t>(pairing::TLVType::Identifier));
+            auto identifier = tlvs.find(static_cast<uint8_t>(pairing::TLVType::Identifier));
             if (!identifier) {
-                response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Unknown));
+                response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Unknown));
             } else {
                 std::string pairing_id(identifier->begin(), identifier->end());
-                std::string pairing_key = "pairing_" + pairing_id;
                 
                 // Get LTPK before removing (for callback)
-                std::array<uint8_t, 32> ltpk_arr{};
-                auto ltpk_data = config_.storage->get(pairing_key);
-                if (ltpk_data && ltpk_data->size() == 32) {
-                    std::copy_n(ltpk_data->begin(), 32, ltpk_arr.begin());
-                }
-                
-                config_.storage->remove(pairing_key);
+                auto existing = config_.pairing_store->find(pairing_id);
+                session_cache_.remove_controller(pairing_id);
                 
-                // Update list
-                auto list_data = config_.storage->get("pairing_list");
-                if (list_data) {
-                    auto list_json = nlohmann::json::parse(list_data->begin(), list_data->end(), nullptr, false);
-                    if (!list_json.is_discarded()) {
-                        for (auto it = list_json.begin(); it != list_json.end(); ) {
-                            if (*it == pairing_id) {
-                                it = list_json.erase(it);
-                            } else {
-                                ++it;
-                            }
-                        }
-                        std::string list_str = list_json.dump();
-                        config_.storage->set("pairing_list", std::vector<uint8_t>(list_str.begin(), list_str.end()));
-                        if (config_.on_pairings_changed) {
-                            config_.on_pairings_changed(pairing_id, ltpk_arr, false);
-                        }
-                    }
+                if (existing && config_.pairing_store->remove(pairing_id) && config_.on_pairings_changed) {
+                    config_.on_pairings_changed(pairing_id, existing->ltpk, false);
                 }
                 
                 if (pairing_id == ctx.controller_id()) {
@@ -210,40 +208,30 @@ Response PairingEndpoints::handle_pairings(const Request& req, ConnectionContext
         }
     } else if (method == pairing::PairingMethod::ListPairings) {
         if (!ctx.is_admin()) {
-            response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Authentication));
+            response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Error), static_cast<uint8_t>(pairing::TLVError::Authentication));
         } else {
-            auto list_data = config_.storage->get("pairing_list");
-            if (list_data) {
-                auto list_json = nlohmann::json::parse(list_data->begin(), list_data->end(), nullptr, false);
-                if (!list_json.is_discarded()) {
-                    bool first = true;
-                    for (const auto& id_json : list_json) {
-                        std::string id = id_json.get<std::string>();
-                        auto ltpk_data = config_.storage->get("pairing_" + id);
-                        if (ltpk_data && ltpk_data->size() == 32) {
-                            if (!first) {
-                                response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Separator), std::vector<uint8_t>{});
-                            }
-                            response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Identifier), id);
-                            response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::PublicKey), *ltpk_data);
-                            response_tlvs.emplace_back(static_cast<uint8_t>(pairing::TLVType::Permissions), std::vector<uint8_t>{0x01}); // Admin
-                            first = false;
-                        }
-                    }
+            bool first = true;
+            for (const auto& entry : config_.pairing_store->list()) {
+                if (!first) {
+                    response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Separator), std::span<const uint8_t>{});
                 }
+                response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Identifier), entry.id());
+                response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::PublicKey), entry.ltpk);
+                response_tlvs.add(static_cast<uint8_t>(pairing::TLVType::Permissions), entry.permissions);
+                first = false;
             }
         }
     }
 
     Response resp{Status::OK};
     resp.set_header("Content-Type", "application/pairing+tlv8");
-    resp.set_body(core::TLV8::encode(response_tlvs));
+    resp.set_body(std::move(body));
     return resp;
 }
 
 void PairingEndpoints::set_accessory_id(const std::string& new_id) {
     config_.accessory_id = new_id;
-    config_.system->log(platform::System::LogLevel::Info, 
+    HAP_LOG_INFO(config_.system,
         "[PairingEndpoints] Accessory ID updated to: " + new_id);
 }
 
@@ -251,7 +239,8 @@ void PairingEndpoints::reset() {
     // Clear all session state
     pair_setup_sessions_.clear();
     pair_verify_sessions_.clear();
-    config_.system->log(platform::System::LogLevel::Info, 
+    session_cache_.clear();
+    HAP_LOG_INFO(config_.system,
         "[PairingEndpoints] All sessions cleared");
 }
 
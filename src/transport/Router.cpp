@@ -1,42 +1,60 @@
 #include "hap/transport/Router.hpp"
 #include "hap/transport/ConnectionContext.hpp"
 
-#include <string_view>
-
 namespace hap::transport {
 
 Router::Router() = default;
 
 void Router::add_route(Method method, std::string path, RouteHandler handler, bool requires_pairing) {
-    routes_.push_back({method, std::move(path), std::move(handler), requires_pairing});
+    insert({method, std::move(path), {}, std::move(handler), requires_pairing});
 }
 
-std::optional<Response> Router::dispatch(const Request& req, ConnectionContext& ctx) {
-    for (const auto& route : routes_) {
-        if (route.method == req.method && path_matches(route.path, req.path)) {
-            // Check pairing requirement
-            if (route.requires_pairing && !ctx.is_encrypted()) {
-                Response resp{Status::BadRequest};
-                resp.set_body("Pairing required");
-                return resp;
-            }
-            
-            // Call handler
-            return route.handler(req, ctx);
-        }
+void Router::insert(Route route) {
+    auto [it, inserted] = index_.try_emplace(route.path);
+    if (inserted) {
+        it->second.fill(kNoRoute);
     }
     
-    // No route found
-    return std::nullopt;
+    uint16_t& slot = it->second[static_cast<size_t>(route.method)];
+    if (slot != kNoRoute) {
+        routes_[slot] = std::move(route);
+        return;
+    }
+    slot = static_cast<uint16_t>(routes_.size());
+    routes_.push_back(std::move(route));
+}
+
+const Route* Router::find(Method method, std::string_view path) const {
+    auto it = index_.find(path);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    uint16_t slot = it->second[static_cast<size_t>(method)];
+    return slot == kNoRoute ? nullptr : &routes_[slot];
 }
 
-bool Router::path_matches(const std::string& pattern, const std::string& path) {
-    size_t query_start = path.find('?');
-    std::string_view path_base = (query_start == std::string::npos) 
-        ? std::string_view(path) 
-        : std::string_view(path).substr(0, query_start);
-        
-    return pattern == path_base;
+common::Result<Response> Router::dispatch(const Request& req, ConnectionContext& ctx) {
+    common::Metrics::Scope lookup(metrics_, common::Metric::RouteDispatch);
+    const Route* route = find(req.method, req.path);
+    if (!route) {
+        return common::Result<Response>::err(common::ErrorCode::NotFound);
+    }
+    
+    // Check pairing requirement
+    if (route->requires_pairing && !ctx.is_encrypted()) {
+        Response resp{Status::BadRequest};
+        resp.set_body("Pairing required");
+        return common::Result<Response>::ok(std::move(resp));
+    }
+    
+    lookup.stop();
+    
+    // Call handler
+    common::Metrics::Scope timer(metrics_, common::Metric::Handler);
+    if (route->target.fn) {
+        return common::Result<Response>::ok(route->target.fn(route->target.object, req, ctx));
+    }
+    return common::Result<Response>::ok(route->handler(req, ctx));
 }
 
 } // namespace hap::transport
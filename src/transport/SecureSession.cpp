@@ -1,4 +1,5 @@
 #include "hap/transport/SecureSession.hpp"
+#include <cstdint>
 #include <cstring>
 #include <algorithm>
 
@@ -23,122 +24,275 @@ std::array<uint8_t, 12> SecureSession::build_nonce(uint64_t counter) {
     return nonce;
 }
 
-std::vector<uint8_t> SecureSession::encrypt_frame(std::span<const uint8_t> plaintext_http) {
+size_t SecureSession::sealed_size(size_t plaintext_size) {
+    size_t frames = (plaintext_size + MAX_FRAME_PAYLOAD - 1) / MAX_FRAME_PAYLOAD;
+    return plaintext_size + frames * (LENGTH_SIZE + AUTH_TAG_SIZE);
+}
+
+platform::Crypto::AeadSealFrame SecureSession::prepare_seal(std::span<const uint8_t> plaintext, uint8_t* frame) {
     // Frame format: <2-byte length><encrypted data><16-byte auth tag>
-    
-    uint16_t length = static_cast<uint16_t>(plaintext_http.size());
-    std::array<uint8_t, 2> length_bytes = {
-        static_cast<uint8_t>(length & 0xFF),
-        static_cast<uint8_t>((length >> 8) & 0xFF)
-    };
-    
-    // Encrypt plaintext
-    auto nonce = build_nonce(write_nonce_++);
-    std::vector<uint8_t> ciphertext(plaintext_http.size());
-    std::array<uint8_t, 16> auth_tag;
-    
-    // AAD is the 2-byte length
-    if (!crypto_->chacha20_poly1305_encrypt_and_tag(
-            a2c_, nonce, std::span(length_bytes), 
-            plaintext_http, ciphertext, auth_tag)) {
+    uint16_t length = static_cast<uint16_t>(plaintext.size());
+    frame[0] = static_cast<uint8_t>(length & 0xFF);
+    frame[1] = static_cast<uint8_t>((length >> 8) & 0xFF);
+
+    // AAD is the 2-byte length; ciphertext and tag land directly in the frame
+    return {build_nonce(write_nonce_++),
+            std::span<const uint8_t>(frame, LENGTH_SIZE),
+            plaintext,
+            std::span<uint8_t>(frame + LENGTH_SIZE, plaintext.size()),
+            std::span<uint8_t>(frame + LENGTH_SIZE + plaintext.size(), AUTH_TAG_SIZE)};
+}
+
+std::vector<uint8_t> SecureSession::encrypt_frame(std::span<const uint8_t> plaintext_http) {
+    std::vector<uint8_t> frame(LENGTH_SIZE + plaintext_http.size() + AUTH_TAG_SIZE);
+    auto op = prepare_seal(plaintext_http, frame.data());
+    if (!crypto_->chacha20_poly1305_encrypt_batch(a2c_, std::span(&op, 1))) {
         // Encryption failed (shouldn't happen with valid key)
         return {};
     }
-    
-    // Build frame: length || ciphertext || auth_tag
-    std::vector<uint8_t> frame;
-    frame.insert(frame.end(), length_bytes.begin(), length_bytes.end());
-    frame.insert(frame.end(), ciphertext.begin(), ciphertext.end());
-    frame.insert(frame.end(), auth_tag.begin(), auth_tag.end());
-    
     return frame;
 }
 
+bool SecureSession::encrypt_frame_in_place(std::span<uint8_t> frame) {
+    if (frame.size() < LENGTH_SIZE + AUTH_TAG_SIZE ||
+        frame.size() - LENGTH_SIZE - AUTH_TAG_SIZE > MAX_FRAME_PAYLOAD) {
+        return false;
+    }
+    size_t length = frame.size() - LENGTH_SIZE - AUTH_TAG_SIZE;
+    frame[0] = static_cast<uint8_t>(length & 0xFF);
+    frame[1] = static_cast<uint8_t>((length >> 8) & 0xFF);
+
+    auto nonce = build_nonce(write_nonce_++);
+    return crypto_->chacha20_poly1305_encrypt_in_place(
+        a2c_, nonce, frame.first(LENGTH_SIZE), frame.subspan(LENGTH_SIZE, length),
+        frame.subspan(LENGTH_SIZE + length).first<AUTH_TAG_SIZE>());
+}
+
+bool SecureSession::encrypt_frames_into(std::span<const uint8_t> plaintext, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.resize(start + sealed_size(plaintext.size()));
+
+    std::array<platform::Crypto::AeadSealFrame, BATCH_FRAMES> batch;
+    size_t batched = 0;
+    uint8_t* frame = out.data() + start;
+    size_t offset = 0;
+    while (offset < plaintext.size()) {
+        size_t chunk_size = std::min(plaintext.size() - offset, MAX_FRAME_PAYLOAD);
+        batch[batched++] = prepare_seal(plaintext.subspan(offset, chunk_size), frame);
+        frame += LENGTH_SIZE + chunk_size + AUTH_TAG_SIZE;
+        offset += chunk_size;
+
+        if (batched == BATCH_FRAMES || offset == plaintext.size()) {
+            if (!crypto_->chacha20_poly1305_encrypt_batch(a2c_, std::span(batch.data(), batched))) {
+                out.resize(start);
+                return false;
+            }
+            batched = 0;
+        }
+    }
+    return true;
+}
+
+bool SecureSession::encrypt_frames_into(std::span<const uint8_t> head, std::span<const uint8_t> body,
+                                       std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    size_t head_frames = head.size() / MAX_FRAME_PAYLOAD;
+    size_t tail = head.size() % MAX_FRAME_PAYLOAD;
+    if (tail == 0 || body.empty()) {
+        // Nothing straddles the boundary
+        if (!encrypt_frames_into(head, out) || !encrypt_frames_into(body, out)) {
+            out.resize(start);
+            return false;
+        }
+        return true;
+    }
+
+    if (head_frames > 0 && !encrypt_frames_into(head.first(head_frames * MAX_FRAME_PAYLOAD), out)) {
+        return false;
+    }
+
+    // Joint frame: head tail plus the start of the body, laid out in out
+    size_t from_body = std::min(body.size(), MAX_FRAME_PAYLOAD - tail);
+    size_t frame_start = out.size();
+    out.resize(frame_start + LENGTH_SIZE + tail + from_body + AUTH_TAG_SIZE);
+    uint8_t* payload = out.data() + frame_start + LENGTH_SIZE;
+    std::copy(head.end() - tail, head.end(), payload);
+    std::copy(body.begin(), body.begin() + from_body, payload + tail);
+    if (!encrypt_frame_in_place(std::span<uint8_t>(out).subspan(frame_start)) ||
+        !encrypt_frames_into(body.subspan(from_body), out)) {
+        out.resize(start);
+        return false;
+    }
+    return true;
+}
+
 std::optional<std::vector<uint8_t>> SecureSession::decrypt_frame(std::span<const uint8_t> encrypted_data) {
-    // Append to read buffer
-    read_buffer_.insert(read_buffer_.end(), encrypted_data.begin(), encrypted_data.end());
-    
-    // Need at least 2 bytes for length
-    if (read_buffer_.size() < 2) {
-        return std::nullopt; // Not enough data yet
+    std::vector<uint8_t> plaintext;
+    auto appended = decrypt_frame_into(encrypted_data, plaintext);
+    if (!appended || *appended == 0) {
+        return std::nullopt;
     }
-    
-    // Read length (little-endian)
-    uint16_t length = read_buffer_[0] | (static_cast<uint16_t>(read_buffer_[1]) << 8);
+    return plaintext;
+}
 
-    // Check if we have the full frame: 2 (length) + length (ciphertext) + 16 (auth tag)
-    size_t frame_size = 2 + length + 16;
-    if (read_buffer_.size() < frame_size) {
-        return std::nullopt; // Not enough data yet
+std::optional<std::span<uint8_t>> SecureSession::decrypt_frame_in_place(std::span<uint8_t> frame) {
+    if (frame.size() < LENGTH_SIZE + AUTH_TAG_SIZE) {
+        return std::nullopt;
     }
-    
-    // Extract components
-    std::array<uint8_t, 2> length_bytes = {read_buffer_[0], read_buffer_[1]};
-    std::vector<uint8_t> ciphertext(read_buffer_.begin() + 2, read_buffer_.begin() + 2 + length);
-    std::array<uint8_t, 16> auth_tag;
-    std::copy_n(read_buffer_.begin() + 2 + length, 16, auth_tag.begin());
-    
-    // Decrypt
+    size_t length = frame[0] | (static_cast<size_t>(frame[1]) << 8);
+    if (frame.size() != LENGTH_SIZE + length + AUTH_TAG_SIZE) {
+        return std::nullopt;
+    }
+
     auto nonce = build_nonce(read_nonce_++);
-    std::vector<uint8_t> plaintext(length);
-    
-    if (!crypto_->chacha20_poly1305_decrypt_and_verify(
-            c2a_, nonce, std::span(length_bytes),
-            ciphertext, auth_tag, plaintext)) {
-        // Authentication failed - this is a security violation
-        read_buffer_.clear();
+    auto plaintext = frame.subspan(LENGTH_SIZE, length);
+    if (!crypto_->chacha20_poly1305_decrypt_in_place(
+            c2a_, nonce, frame.first(LENGTH_SIZE), plaintext,
+            std::span<const uint8_t>(frame).subspan(LENGTH_SIZE + length).first<AUTH_TAG_SIZE>())) {
         return std::nullopt;
     }
+    return plaintext;
+}
+
+std::optional<size_t> SecureSession::decrypt_frame_into(std::span<const uint8_t> encrypted_data, std::vector<uint8_t>& out) {
+    return decrypt_frames(encrypted_data, out, 1);
+}
+
+std::optional<size_t> SecureSession::decrypt_all_frames_into(std::span<const uint8_t> encrypted_data, std::vector<uint8_t>& out) {
+    return decrypt_frames(encrypted_data, out, SIZE_MAX);
+}
+
+std::optional<size_t> SecureSession::decrypt_frames(std::span<const uint8_t> encrypted_data, std::vector<uint8_t>& out, size_t max_frames) {
+    // Only fall back to the reassembly buffer when a partial frame is pending
+    bool buffered = !read_buffer_.empty();
+    if (buffered) {
+        read_buffer_.insert(read_buffer_.end(), encrypted_data.begin(), encrypted_data.end());
+    }
+    std::span<const uint8_t> input = buffered ? std::span<const uint8_t>(read_buffer_) : encrypted_data;
     
-    // Remove processed frame from buffer
-    read_buffer_.erase(read_buffer_.begin(), read_buffer_.begin() + frame_size);
+    size_t pos = 0;
+    size_t appended = 0;
+    size_t frames = 0;
+    std::array<platform::Crypto::AeadOpenFrame, BATCH_FRAMES> batch;
+    std::array<uint16_t, BATCH_FRAMES> lengths;
+    while (frames < max_frames) {
+        // Find the complete frames of this batch first so out grows once
+        size_t count = 0;
+        size_t batch_end = pos;
+        size_t batch_plaintext = 0;
+        while (count < BATCH_FRAMES && frames + count < max_frames) {
+            // Need at least 2 bytes for length
+            if (input.size() - batch_end < LENGTH_SIZE) break;
+            
+            // Read length (little-endian)
+            uint16_t length = input[batch_end] | (static_cast<uint16_t>(input[batch_end + 1]) << 8);
+            if (length > MAX_FRAME_PAYLOAD) {
+                // No valid frame is this long; don't buffer up to 64 KiB waiting for it
+                read_buffer_.clear();
+                return std::nullopt;
+            }
+            
+            // Check if we have the full frame: 2 (length) + length (ciphertext) + 16 (auth tag)
+            size_t frame_size = LENGTH_SIZE + length + AUTH_TAG_SIZE;
+            if (input.size() - batch_end < frame_size) break;
+            
+            lengths[count++] = length;
+            batch_end += frame_size;
+            batch_plaintext += length;
+        }
+        if (count == 0) break;
+        
+        // Decrypt directly from the input into the caller's buffer
+        size_t offset = out.size();
+        out.resize(offset + batch_plaintext);
+        size_t frame_pos = pos;
+        size_t out_pos = offset;
+        for (size_t i = 0; i < count; ++i) {
+            auto frame = input.subspan(frame_pos, LENGTH_SIZE + lengths[i] + AUTH_TAG_SIZE);
+            batch[i] = {build_nonce(read_nonce_++),
+                        frame.first(LENGTH_SIZE),
+                        frame.subspan(LENGTH_SIZE, lengths[i]),
+                        frame.subspan(LENGTH_SIZE + lengths[i]),
+                        std::span<uint8_t>(out).subspan(out_pos, lengths[i])};
+            frame_pos += frame.size();
+            out_pos += lengths[i];
+        }
+        
+        if (!crypto_->chacha20_poly1305_decrypt_batch(c2a_, std::span(batch.data(), count))) {
+            // Authentication failed - this is a security violation
+            out.resize(offset);
+            read_buffer_.clear();
+            return std::nullopt;
+        }
+        
+        pos = batch_end;
+        appended += batch_plaintext;
+        frames += count;
+    }
     
-    return plaintext;
+    // Keep whatever follows the last complete frame for the next call
+    if (buffered) {
+        read_buffer_.erase(read_buffer_.begin(), read_buffer_.begin() + static_cast<std::ptrdiff_t>(pos));
+    } else if (pos < input.size()) {
+        read_buffer_.assign(input.begin() + static_cast<std::ptrdiff_t>(pos), input.end());
+    }
+    
+    return appended;
 }
 
 // ===== BLE-specific methods (HAP Spec 7.4.7.2/7.4.7.5) =====
 
 std::vector<uint8_t> SecureSession::encrypt_ble_pdu(std::span<const uint8_t> plaintext) {
-    auto nonce = build_nonce(write_nonce_++);
-    std::vector<uint8_t> ciphertext(plaintext.size());
-    std::array<uint8_t, 16> auth_tag;
+    std::vector<uint8_t> pdu(plaintext.size() + AUTH_TAG_SIZE);
+    std::copy(plaintext.begin(), plaintext.end(), pdu.begin());
+    if (!encrypt_ble_pdu_in_place(pdu, plaintext.size())) {
+        return {};
+    }
+    return pdu;
+}
+
+std::optional<size_t> SecureSession::encrypt_ble_pdu_in_place(std::span<uint8_t> buffer, size_t plaintext_size) {
+    if (buffer.size() < plaintext_size + AUTH_TAG_SIZE) {
+        return std::nullopt;
+    }
     
+    auto nonce = build_nonce(write_nonce_++);
     std::span<const uint8_t> empty_aad;
     
-    if (!crypto_->chacha20_poly1305_encrypt_and_tag(
-            a2c_, nonce, empty_aad, 
-            plaintext, ciphertext, auth_tag)) {
-        return {};
+    if (!crypto_->chacha20_poly1305_encrypt_in_place(
+            a2c_, nonce, empty_aad,
+            buffer.first(plaintext_size), buffer.subspan(plaintext_size).first<AUTH_TAG_SIZE>())) {
+        return std::nullopt;
     }
-    
-    ciphertext.insert(ciphertext.end(), auth_tag.begin(), auth_tag.end());
-    return ciphertext;
+    return plaintext_size + AUTH_TAG_SIZE;
 }
 
 std::optional<std::vector<uint8_t>> SecureSession::decrypt_ble_pdu(std::span<const uint8_t> encrypted_data) {
-    constexpr size_t AUTH_TAG_SIZE = 16;
-    
-    if (encrypted_data.size() < AUTH_TAG_SIZE) {
+    std::vector<uint8_t> pdu(encrypted_data.begin(), encrypted_data.end());
+    auto plaintext_size = decrypt_ble_pdu_in_place(pdu);
+    if (!plaintext_size) {
+        return std::nullopt;
+    }
+    pdu.resize(*plaintext_size);
+    return pdu;
+}
+
+std::optional<size_t> SecureSession::decrypt_ble_pdu_in_place(std::span<uint8_t> pdu) {
+    if (pdu.size() < AUTH_TAG_SIZE) {
         return std::nullopt;
     }
     
-    size_t ciphertext_len = encrypted_data.size() - AUTH_TAG_SIZE;
-    
-    std::span<const uint8_t> ciphertext = encrypted_data.subspan(0, ciphertext_len);
-    std::array<uint8_t, 16> auth_tag;
-    std::copy_n(encrypted_data.data() + ciphertext_len, AUTH_TAG_SIZE, auth_tag.begin());
-    
+    size_t ciphertext_len = pdu.size() - AUTH_TAG_SIZE;
     auto nonce = build_nonce(read_nonce_++);
-    std::vector<uint8_t> plaintext(ciphertext_len);
     std::span<const uint8_t> empty_aad;
     
-    if (!crypto_->chacha20_poly1305_decrypt_and_verify(
+    if (!crypto_->chacha20_poly1305_decrypt_in_place(
             c2a_, nonce, empty_aad,
-            ciphertext, auth_tag, plaintext)) {
+            pdu.first(ciphertext_len),
+            std::span<const uint8_t>(pdu).subspan(ciphertext_len).first<AUTH_TAG_SIZE>())) {
         return std::nullopt;
     }
-    
-    return plaintext;
+    return ciphertext_len;
 }
 
 } // namespace hap::transport
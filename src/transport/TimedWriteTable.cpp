@@ -0,0 +1,81 @@
+#include "hap/transport/TimedWriteTable.hpp"
+
+namespace hap::transport {
+
+size_t TimedWriteTable::find(uint64_t key) const {
+    for (size_t i = 0; i < size_; ++i) {
+        if (entries_[i].key == key) return i;
+    }
+    return CAPACITY;
+}
+
+void TimedWriteTable::remove(size_t index) {
+    // Swap with the last live entry; order does not matter
+    if (index != size_ - 1) {
+        entries_[index] = std::move(entries_[size_ - 1]);
+    }
+    entries_[size_ - 1] = Entry{};  // Releases the payload
+    --size_;
+}
+
+void TimedWriteTable::prepare(uint64_t key, uint64_t expires_ms, std::vector<uint8_t> payload) {
+    size_t index = find(key);
+    if (index == CAPACITY) {
+        if (size_ < CAPACITY) {
+            index = size_++;
+        } else {
+            index = 0;
+            for (size_t i = 1; i < size_; ++i) {
+                if (entries_[i].expires_ms < entries_[index].expires_ms) index = i;
+            }
+        }
+    }
+    entries_[index] = Entry{key, expires_ms, std::move(payload)};
+}
+
+bool TimedWriteTable::contains(uint64_t key, uint64_t now_ms) const {
+    size_t index = find(key);
+    return index != CAPACITY && now_ms <= entries_[index].expires_ms;
+}
+
+std::optional<std::vector<uint8_t>> TimedWriteTable::take(uint64_t key, uint64_t now_ms) {
+    size_t index = find(key);
+    if (index == CAPACITY) return std::nullopt;
+    
+    std::optional<std::vector<uint8_t>> payload;
+    if (now_ms <= entries_[index].expires_ms) {
+        payload = std::move(entries_[index].payload);
+    }
+    remove(index);
+    return payload;
+}
+
+size_t TimedWriteTable::expire(uint64_t now_ms) {
+    size_t dropped = 0;
+    for (size_t i = 0; i < size_;) {
+        if (now_ms > entries_[i].expires_ms) {
+            remove(i);
+            ++dropped;
+        } else {
+            ++i;
+        }
+    }
+    return dropped;
+}
+
+std::optional<uint64_t> TimedWriteTable::next_expiry() const {
+    std::optional<uint64_t> earliest;
+    for (size_t i = 0; i < size_; ++i) {
+        if (!earliest || entries_[i].expires_ms < *earliest) earliest = entries_[i].expires_ms;
+    }
+    return earliest;
+}
+
+void TimedWriteTable::clear() {
+    for (size_t i = 0; i < size_; ++i) {
+        entries_[i] = Entry{};
+    }
+    size_ = 0;
+}
+
+} // namespace hap::transport
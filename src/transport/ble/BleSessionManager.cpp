@@ -1,12 +1,18 @@
 #include "hap/transport/ble/BleSessionManager.hpp"
+#include "hap/common/Log.hpp"
 #include <algorithm>
 
 namespace hap::transport::ble {
 
 const std::vector<uint16_t> BleSessionManager::kEmptySubscribers = {};
 
-BleSessionManager::BleSessionManager(platform::System* system)
-    : system_(system) {}
+BleSessionManager::BleSessionManager(platform::System* system, common::TaskScheduler* scheduler,
+                                     std::recursive_mutex* mutex)
+    : system_(system), scheduler_(scheduler), mutex_(mutex) {}
+
+BleSessionManager::~BleSessionManager() {
+    clear();
+}
 
 BleSession& BleSessionManager::get_or_create(uint16_t connection_id) {
     auto it = sessions_.find(connection_id);
@@ -32,10 +38,15 @@ const BleSession* BleSessionManager::get_session(uint16_t connection_id) const {
 }
 
 void BleSessionManager::remove(uint16_t connection_id) {
-    sessions_.erase(connection_id);
+    auto it = sessions_.find(connection_id);
+    if (it == sessions_.end()) {
+        return;
+    }
+    cancel_timeout(it->second);
+    sessions_.erase(it);
     
     // Remove from all subscriptions
-    for (auto& [uuid, subscribers] : subscriptions_) {
+    for (auto& subscribers : subscriptions_) {
         subscribers.erase(
             std::remove(subscribers.begin(), subscribers.end(), connection_id),
             subscribers.end()
@@ -44,10 +55,40 @@ void BleSessionManager::remove(uint16_t connection_id) {
 }
 
 void BleSessionManager::clear() {
+    for (auto& [_, session] : sessions_) {
+        cancel_timeout(session);
+    }
     sessions_.clear();
     subscriptions_.clear();
 }
 
+std::optional<BleSessionManager::Deadline> BleSessionManager::timeout_deadline(const BleSession& session) const {
+    const auto& state = session.transaction;
+    std::optional<Deadline> earliest;
+    auto consider = [&earliest](uint64_t at_ms, const char* reason) {
+        if (!earliest || at_ms < earliest->at_ms) {
+            earliest = Deadline{at_ms, reason};
+        }
+    };
+    
+    // Initial procedure timeout (10 seconds)
+    if (state.connection_established_ms > 0 && !state.active && state.last_activity_ms == 0) {
+        consider(state.connection_established_ms + kInitialTimeoutMs, "Initial procedure");
+    }
+    
+    // Procedure timeout (10 seconds)
+    if (state.active && state.procedure_start_ms > 0) {
+        consider(state.procedure_start_ms + kProcedureTimeoutMs, "Procedure");
+    }
+    
+    // Idle timeout (30 seconds)
+    if (state.last_activity_ms > 0) {
+        consider(state.last_activity_ms + kIdleTimeoutMs, "Idle");
+    }
+    
+    return earliest;
+}
+
 std::vector<uint16_t> BleSessionManager::check_timeouts() {
     std::vector<uint16_t> timed_out;
     
@@ -58,48 +99,85 @@ std::vector<uint16_t> BleSessionManager::check_timeouts() {
     uint64_t current_time = system_->millis();
     
     for (auto& [conn_id, session] : sessions_) {
-        auto& state = session.transaction;
-        
-        if (state.connection_established_ms > 0 && 
-            !state.active && 
-            state.last_activity_ms == 0) {
-            uint64_t time_since_connect = current_time - state.connection_established_ms;
-            if (time_since_connect > kInitialTimeoutMs) {
-                system_->log(platform::System::LogLevel::Warning,
-                    "[BleSessionManager] Initial procedure timeout for connection " + 
-                    std::to_string(conn_id));
-                timed_out.push_back(conn_id);
-                continue;
-            }
-        }
-        
-        // Check procedure timeout (10 seconds)
-        if (state.active && state.procedure_start_ms > 0) {
-            uint64_t procedure_duration = current_time - state.procedure_start_ms;
-            if (procedure_duration > kProcedureTimeoutMs) {
-                system_->log(platform::System::LogLevel::Warning,
-                    "[BleSessionManager] Procedure timeout for connection " + 
-                    std::to_string(conn_id));
-                timed_out.push_back(conn_id);
-                continue;
-            }
-        }
-        
-        // Check idle timeout (30 seconds)
-        if (state.last_activity_ms > 0) {
-            uint64_t idle_duration = current_time - state.last_activity_ms;
-            if (idle_duration > kIdleTimeoutMs) {
-                system_->log(platform::System::LogLevel::Info,
-                    "[BleSessionManager] Idle timeout for connection " + 
-                    std::to_string(conn_id));
-                timed_out.push_back(conn_id);
-            }
+        auto deadline = timeout_deadline(session);
+        if (deadline && current_time > deadline->at_ms) {
+            HAP_LOG_WARNING(system_,
+                "[BleSessionManager] " + std::string(deadline->reason) + " timeout for connection " + 
+                std::to_string(conn_id));
+            timed_out.push_back(conn_id);
         }
     }
     
     return timed_out;
 }
 
+void BleSessionManager::arm_timeout(uint16_t connection_id) {
+    if (!scheduler_ || !system_) {
+        return;
+    }
+    auto* session = get_session(connection_id);
+    if (!session) {
+        return;
+    }
+    
+    auto deadline = timeout_deadline(*session);
+    auto timed_write_expiry = session->transaction.timed_writes.next_expiry();
+    if (!deadline && !timed_write_expiry) {
+        cancel_timeout(*session);
+        return;
+    }
+    
+    uint64_t fire_at = deadline ? deadline->at_ms + 1 : UINT64_MAX;
+    if (timed_write_expiry) {
+        fire_at = std::min(fire_at, *timed_write_expiry + 1);
+    }
+    if (session->timeout_task != common::TaskScheduler::INVALID_TASK_ID) {
+        if (session->timeout_task_at_ms <= fire_at) {
+            return;  // Fires first and re-arms for whatever is left
+        }
+        cancel_timeout(*session);
+    }
+    
+    uint64_t now = system_->millis();
+    uint32_t delay = fire_at > now ? static_cast<uint32_t>(fire_at - now) : 0;
+    session->timeout_task_at_ms = now + delay;
+    session->timeout_task = scheduler_->schedule_once(delay, [this, connection_id]() {
+        std::unique_lock<std::recursive_mutex> lock;
+        if (mutex_) lock = std::unique_lock<std::recursive_mutex>(*mutex_);
+        on_timeout_task(connection_id);
+    });
+}
+
+void BleSessionManager::cancel_timeout(BleSession& session) {
+    if (session.timeout_task != common::TaskScheduler::INVALID_TASK_ID) {
+        scheduler_->cancel(session.timeout_task);
+        session.timeout_task = common::TaskScheduler::INVALID_TASK_ID;
+    }
+}
+
+void BleSessionManager::on_timeout_task(uint16_t connection_id) {
+    auto* session = get_session(connection_id);
+    if (!session) {
+        return;
+    }
+    session->timeout_task = common::TaskScheduler::INVALID_TASK_ID;
+    uint64_t now = system_->millis();
+    session->transaction.timed_writes.expire(now);
+    
+    auto deadline = timeout_deadline(*session);
+    if (!deadline || now <= deadline->at_ms) {
+        arm_timeout(connection_id);  // Activity moved the deadline, or timed writes remain
+        return;
+    }
+    
+    HAP_LOG_WARNING(system_,
+        "[BleSessionManager] " + std::string(deadline->reason) + " timeout for connection " + 
+        std::to_string(connection_id));
+    if (timeout_handler_) {
+        timeout_handler_(connection_id);
+    }
+}
+
 std::vector<uint16_t> BleSessionManager::get_connection_ids() const {
     std::vector<uint16_t> ids;
     ids.reserve(sessions_.size());
@@ -109,17 +187,19 @@ std::vector<uint16_t> BleSessionManager::get_connection_ids() const {
     return ids;
 }
 
-void BleSessionManager::add_subscription(const std::string& uuid, uint16_t connection_id) {
-    auto& subscribers = subscriptions_[uuid];
+void BleSessionManager::add_subscription(uint16_t handle, uint16_t connection_id) {
+    if (handle >= subscriptions_.size()) {
+        subscriptions_.resize(handle + 1);
+    }
+    auto& subscribers = subscriptions_[handle];
     if (std::find(subscribers.begin(), subscribers.end(), connection_id) == subscribers.end()) {
         subscribers.push_back(connection_id);
     }
 }
 
-void BleSessionManager::remove_subscription(const std::string& uuid, uint16_t connection_id) {
-    auto it = subscriptions_.find(uuid);
-    if (it != subscriptions_.end()) {
-        auto& subscribers = it->second;
+void BleSessionManager::remove_subscription(uint16_t handle, uint16_t connection_id) {
+    if (handle < subscriptions_.size()) {
+        auto& subscribers = subscriptions_[handle];
         subscribers.erase(
             std::remove(subscribers.begin(), subscribers.end(), connection_id),
             subscribers.end()
@@ -127,14 +207,12 @@ void BleSessionManager::remove_subscription(const std::string& uuid, uint16_t co
     }
 }
 
-const std::vector<uint16_t>& BleSessionManager::get_subscribers(const std::string& uuid) const {
-    auto it = subscriptions_.find(uuid);
-    return it != subscriptions_.end() ? it->second : kEmptySubscribers;
+const std::vector<uint16_t>& BleSessionManager::get_subscribers(uint16_t handle) const {
+    return handle < subscriptions_.size() ? subscriptions_[handle] : kEmptySubscribers;
 }
 
-bool BleSessionManager::has_subscribers(const std::string& uuid) const {
-    auto it = subscriptions_.find(uuid);
-    return it != subscriptions_.end() && !it->second.empty();
+bool BleSessionManager::has_subscribers(uint16_t handle) const {
+    return handle < subscriptions_.size() && !subscriptions_[handle].empty();
 }
 
 } // namespace hap::transport::ble
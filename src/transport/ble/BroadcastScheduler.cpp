@@ -0,0 +1,60 @@
+#include "hap/transport/ble/BroadcastScheduler.hpp"
+#include <algorithm>
+
+namespace hap::transport::ble {
+
+uint32_t BroadcastScheduler::slot_ms(uint32_t interval_ms) {
+    return std::max(kMinSlotMs, interval_ms * kMinAdvertisements);
+}
+
+bool BroadcastScheduler::push(uint16_t iid, core::Value value, uint32_t interval_ms) {
+    auto queued = std::find_if(queue_.begin(), queue_.end(),
+        [iid](const Slot& slot) { return slot.iid == iid; });
+
+    auto sent = last_sent_.find(iid);
+    if (sent != last_sent_.end() && sent->second == value) {
+        // Back to what controllers last heard: a queued change is moot too
+        if (queued != queue_.end()) queue_.erase(queued);
+        ++stats_.unchanged;
+        return false;
+    }
+
+    if (queued != queue_.end()) {
+        queued->value = std::move(value);
+        queued->interval_ms = interval_ms;
+        ++stats_.coalesced;
+    } else {
+        queue_.push_back({iid, std::move(value), interval_ms});
+    }
+    return true;
+}
+
+std::optional<BroadcastScheduler::Slot> BroadcastScheduler::next(uint64_t now_ms) {
+    if (busy_until_ms_ && now_ms < *busy_until_ms_) return std::nullopt;
+    if (queue_.empty()) return std::nullopt;
+
+    Slot slot = std::move(queue_.front());
+    queue_.erase(queue_.begin());
+    busy_until_ms_ = now_ms + slot_ms(slot.interval_ms);
+    last_sent_[slot.iid] = slot.value;
+    ++stats_.sent;
+    return slot;
+}
+
+bool BroadcastScheduler::release(uint64_t now_ms) {
+    if (!busy_until_ms_ || now_ms < *busy_until_ms_) return false;
+    busy_until_ms_.reset();
+    return queue_.empty();
+}
+
+std::optional<uint64_t> BroadcastScheduler::busy_until_ms() const {
+    return busy_until_ms_;
+}
+
+void BroadcastScheduler::clear() {
+    queue_.clear();
+    last_sent_.clear();
+    busy_until_ms_.reset();
+}
+
+} // namespace hap::transport::ble
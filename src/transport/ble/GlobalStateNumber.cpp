@@ -0,0 +1,59 @@
+#include "hap/transport/ble/GlobalStateNumber.hpp"
+
+namespace hap::transport::ble {
+
+GlobalStateNumber::GlobalStateNumber(platform::Storage* storage, uint16_t reserve)
+    : storage_(storage), reserve_(reserve == 0 ? 1 : reserve) {}
+
+uint16_t GlobalStateNumber::current() {
+    if (!loaded_) load();
+    return value_;
+}
+
+uint16_t GlobalStateNumber::increment() {
+    if (!loaded_) load();
+    
+    value_ = advance(value_, 1);
+    if (remaining_ == 0) {
+        // Claim [value_, value_ + reserve_ - 1]; a restart resumes past it
+        persist(advance(value_, reserve_ - 1));
+        remaining_ = reserve_ - 1;
+    } else {
+        --remaining_;
+    }
+    return value_;
+}
+
+void GlobalStateNumber::reset() {
+    loaded_ = false;
+    remaining_ = 0;
+}
+
+uint16_t GlobalStateNumber::advance(uint16_t gsn, uint16_t steps) {
+    // 1-65535, wrapping to 1
+    uint32_t next = (static_cast<uint32_t>(gsn) - 1 + steps) % 65535;
+    return static_cast<uint16_t>(next + 1);
+}
+
+void GlobalStateNumber::load() {
+    loaded_ = true;
+    remaining_ = 0;
+    value_ = 1;
+    
+    auto bytes = storage_ ? storage_->get(kStorageKey) : std::nullopt;
+    if (bytes && bytes->size() == 2) {
+        value_ = static_cast<uint16_t>((*bytes)[0]) | (static_cast<uint16_t>((*bytes)[1]) << 8);
+        if (value_ == 0) value_ = 1;
+    } else {
+        persist(value_);
+    }
+}
+
+void GlobalStateNumber::persist(uint16_t gsn) {
+    if (!storage_) return;
+    uint8_t data[2] = {static_cast<uint8_t>(gsn & 0xFF), static_cast<uint8_t>((gsn >> 8) & 0xFF)};
+    storage_->set(kStorageKey, data);
+    ++persist_count_;
+}
+
+} // namespace hap::transport::ble
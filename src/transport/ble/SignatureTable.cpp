@@ -0,0 +1,34 @@
+#include "hap/transport/ble/SignatureTable.hpp"
+#include <algorithm>
+
+namespace hap::transport::ble {
+
+void SignatureTable::clear() {
+    entries_.clear();
+    blob_.clear();
+}
+
+void SignatureTable::add(uint16_t iid, std::span<const uint8_t> body) {
+    entries_.push_back({iid, static_cast<uint16_t>(body.size()), static_cast<uint32_t>(blob_.size())});
+    blob_.insert(blob_.end(), body.begin(), body.end());
+}
+
+void SignatureTable::seal() {
+    // Stable so that among duplicate IIDs the first added is kept, matching
+    // CharacteristicFinder's tree-order lookups
+    std::stable_sort(entries_.begin(), entries_.end(),
+        [](const Entry& a, const Entry& b) { return a.iid < b.iid; });
+    entries_.erase(std::unique(entries_.begin(), entries_.end(),
+        [](const Entry& a, const Entry& b) { return a.iid == b.iid; }), entries_.end());
+}
+
+std::optional<std::span<const uint8_t>> SignatureTable::find(uint16_t iid) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), iid,
+        [](const Entry& entry, uint16_t key) { return entry.iid < key; });
+    if (it == entries_.end() || it->iid != iid) {
+        return std::nullopt;
+    }
+    return std::span<const uint8_t>(blob_).subspan(it->offset, it->length);
+}
+
+} // namespace hap::transport::ble
@@ -2,87 +2,502 @@
  * @file CharacteristicTypes.cpp
  * @brief Implementation of HAP Characteristic factory functions
  * 
- * Factory functions return pre-configured characteristics with proper
- * type, format, permissions, and metadata per HAP Specification R13.
+ * Every HAP-defined characteristic is described once in a constexpr table
+ * (type, format, permissions, unit and ranges) that lives in flash; the
+ * factory functions reference their entry and only add the initial value.
  */
 
 #include "hap/types/CharacteristicTypes.hpp"
+#include "hap/core/AttributeArena.hpp"
 #include "hap/core/TLV8.hpp"
 
 namespace hap::characteristic {
 
 using namespace hap::core;
 
+namespace {
+
 //==============================================================================
-// Helper macros for common permission patterns
+// Common permission patterns
 //==============================================================================
-#define PERM_PR     std::vector{Permission::PairedRead}
-#define PERM_PW     std::vector{Permission::PairedWrite}
-#define PERM_PR_NT  std::vector{Permission::PairedRead, Permission::Notify}
-#define PERM_PR_PW  std::vector{Permission::PairedRead, Permission::PairedWrite}
-#define PERM_PR_PW_NT std::vector{Permission::PairedRead, Permission::PairedWrite, Permission::Notify}
-#define PERM_PR_PW_WR std::vector{Permission::PairedRead, Permission::PairedWrite, Permission::WriteResponse}
+
+constexpr PermissionSet kPR{Permission::PairedRead};
+constexpr PermissionSet kPW{Permission::PairedWrite};
+constexpr PermissionSet kPR_NT{Permission::PairedRead, Permission::Notify};
+constexpr PermissionSet kPR_PW{Permission::PairedRead, Permission::PairedWrite};
+constexpr PermissionSet kPR_PW_NT{Permission::PairedRead, Permission::PairedWrite, Permission::Notify};
+constexpr PermissionSet kPR_PW_WR{Permission::PairedRead, Permission::PairedWrite, Permission::WriteResponse};
+
+//==============================================================================
+// Descriptor table (HAP Specification R13, Chapter 9)
+//==============================================================================
+
+namespace desc {
+
+// Accessory Information Characteristics
+constexpr CharacteristicDescriptor AccessoryFlags{.type = kType_AccessoryFlags, .format = Format::UInt32, .permissions = kPR_NT};
+constexpr CharacteristicDescriptor FirmwareRevision{.type = kType_FirmwareRevision, .format = Format::String, .permissions = kPR};
+constexpr CharacteristicDescriptor HardwareRevision{.type = kType_HardwareRevision, .format = Format::String, .permissions = kPR};
+constexpr CharacteristicDescriptor Identify{.type = kType_Identify, .format = Format::Bool, .permissions = kPR_PW};
+constexpr CharacteristicDescriptor Manufacturer{.type = kType_Manufacturer, .format = Format::String, .permissions = kPR,
+    .max_len = 64};
+constexpr CharacteristicDescriptor Model{.type = kType_Model, .format = Format::String, .permissions = kPR,
+    .max_len = 64};
+constexpr CharacteristicDescriptor Name{.type = kType_Name, .format = Format::String, .permissions = kPR,
+    .max_len = 64};
+constexpr CharacteristicDescriptor SerialNumber{.type = kType_SerialNumber, .format = Format::String, .permissions = kPR,
+    .max_len = 64};
+constexpr CharacteristicDescriptor HardwareFinish{.type = kType_HardwareFinish, .format = Format::TLV8, .permissions = kPR};
+
+// Lightbulb Characteristics
+constexpr CharacteristicDescriptor On{.type = kType_On, .format = Format::Bool, .permissions = kPR_PW_NT};
+constexpr CharacteristicDescriptor Brightness{.type = kType_Brightness, .format = Format::Int, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor Hue{.type = kType_Hue, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "arcdegrees", .min_value = 0, .max_value = 360, .min_step = 1};
+constexpr CharacteristicDescriptor Saturation{.type = kType_Saturation, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor ColorTemperature{.type = kType_ColorTemperature, .format = Format::UInt32, .permissions = kPR_PW_NT,
+    .min_value = 140,  // ~7142K (cool white)
+    .max_value = 500,  // 2000K (warm white)
+    .min_step = 1,
+};
+
+// Thermostat / Temperature Characteristics
+constexpr CharacteristicDescriptor CurrentTemperature{.type = kType_CurrentTemperature, .format = Format::Float, .permissions = kPR_NT,
+    .unit = "celsius", .min_value = 0, .max_value = 100, .min_step = 0.1};
+constexpr CharacteristicDescriptor TargetTemperature{.type = kType_TargetTemperature, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "celsius", .min_value = 10, .max_value = 38, .min_step = 0.1};
+constexpr CharacteristicDescriptor TemperatureDisplayUnits{.type = kType_TemperatureDisplayUnits, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor CurrentHeatingCoolingState{.type = kType_CurrentHeatingCoolingState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor TargetHeatingCoolingState{.type = kType_TargetHeatingCoolingState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 3};
+constexpr CharacteristicDescriptor CoolingThresholdTemperature{.type = kType_CoolingThresholdTemperature, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "celsius", .min_value = 10, .max_value = 35, .min_step = 0.1};
+constexpr CharacteristicDescriptor HeatingThresholdTemperature{.type = kType_HeatingThresholdTemperature, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "celsius", .min_value = 0, .max_value = 25, .min_step = 0.1};
+
+// Humidity Characteristics
+constexpr CharacteristicDescriptor CurrentRelativeHumidity{.type = kType_CurrentRelativeHumidity, .format = Format::Float, .permissions = kPR_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor TargetRelativeHumidity{.type = kType_TargetRelativeHumidity, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+
+// Door / Garage Characteristics
+constexpr CharacteristicDescriptor CurrentDoorState{.type = kType_CurrentDoorState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 4};
+constexpr CharacteristicDescriptor TargetDoorState{.type = kType_TargetDoorState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor ObstructionDetected{.type = kType_ObstructionDetected, .format = Format::Bool, .permissions = kPR_NT};
+
+// Lock Characteristics
+constexpr CharacteristicDescriptor LockCurrentState{.type = kType_LockCurrentState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 3};
+constexpr CharacteristicDescriptor LockTargetState{.type = kType_LockTargetState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+
+// Fan Characteristics
+constexpr CharacteristicDescriptor Active{.type = kType_Active, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor CurrentFanState{.type = kType_CurrentFanState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor TargetFanState{.type = kType_TargetFanState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor RotationDirection{.type = kType_RotationDirection, .format = Format::Int, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor RotationSpeed{.type = kType_RotationSpeed, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor SwingMode{.type = kType_SwingMode, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+
+// Window / Covering Characteristics
+constexpr CharacteristicDescriptor CurrentPosition{.type = kType_CurrentPosition, .format = Format::UInt8, .permissions = kPR_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor TargetPosition{.type = kType_TargetPosition, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor PositionState{.type = kType_PositionState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor HoldPosition{.type = kType_HoldPosition, .format = Format::Bool, .permissions = kPW};
+
+// Sensor Characteristics
+constexpr CharacteristicDescriptor MotionDetected{.type = kType_MotionDetected, .format = Format::Bool, .permissions = kPR_NT};
+constexpr CharacteristicDescriptor OccupancyDetected{.type = kType_OccupancyDetected, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor ContactSensorState{.type = kType_ContactSensorState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor LeakDetected{.type = kType_LeakDetected, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor SmokeDetected{.type = kType_SmokeDetected, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor CarbonMonoxideDetected{.type = kType_CarbonMonoxideDetected, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor CarbonMonoxideLevel{.type = kType_CarbonMonoxideLevel, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 100};
+constexpr CharacteristicDescriptor CarbonDioxideDetected{.type = kType_CarbonDioxideDetected, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor CarbonDioxideLevel{.type = kType_CarbonDioxideLevel, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 100000};
+constexpr CharacteristicDescriptor CurrentAmbientLightLevel{.type = kType_CurrentAmbientLightLevel, .format = Format::Float, .permissions = kPR_NT,
+    .unit = "lux", .min_value = 0.0001, .max_value = 100000};
+
+// Air Quality Characteristics
+constexpr CharacteristicDescriptor AirQuality{.type = kType_AirQuality, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 5};
+constexpr CharacteristicDescriptor PM2_5Density{.type = kType_PM2_5Density, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1000};
+constexpr CharacteristicDescriptor PM10Density{.type = kType_PM10Density, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1000};
+constexpr CharacteristicDescriptor VOCDensity{.type = kType_VOCDensity, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1000};
+
+// Security System Characteristics
+constexpr CharacteristicDescriptor SecuritySystemCurrentState{.type = kType_SecuritySystemCurrentState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 4};
+constexpr CharacteristicDescriptor SecuritySystemTargetState{.type = kType_SecuritySystemTargetState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 3};
+
+// Battery Characteristics
+constexpr CharacteristicDescriptor BatteryLevel{.type = kType_BatteryLevel, .format = Format::UInt8, .permissions = kPR_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100};
+constexpr CharacteristicDescriptor ChargingState{.type = kType_ChargingState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor StatusLowBattery{.type = kType_StatusLowBattery, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+
+// Status Characteristics
+constexpr CharacteristicDescriptor StatusActive{.type = kType_StatusActive, .format = Format::Bool, .permissions = kPR_NT};
+constexpr CharacteristicDescriptor StatusFault{.type = kType_StatusFault, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor StatusTampered{.type = kType_StatusTampered, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+
+// Outlet Characteristics
+constexpr CharacteristicDescriptor OutletInUse{.type = kType_OutletInUse, .format = Format::Bool, .permissions = kPR_NT};
+
+// Audio Characteristics
+constexpr CharacteristicDescriptor Volume{.type = kType_Volume, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor Mute{.type = kType_Mute, .format = Format::Bool, .permissions = kPR_PW_NT};
+
+// Switch Characteristics
+constexpr CharacteristicDescriptor ProgrammableSwitchEvent{.type = kType_ProgrammableSwitchEvent, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor ServiceLabelIndex{.type = kType_ServiceLabelIndex, .format = Format::UInt8, .permissions = kPR,
+    .min_value = 1, .max_value = 255};
+constexpr CharacteristicDescriptor ServiceLabelNamespace{.type = kType_ServiceLabelNamespace, .format = Format::UInt8, .permissions = kPR,
+    .min_value = 0, .max_value = 1};
+
+// Valve Characteristics
+constexpr CharacteristicDescriptor InUse{.type = kType_InUse, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor IsConfigured{.type = kType_IsConfigured, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor RemainingDuration{.type = kType_RemainingDuration, .format = Format::UInt32, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 3600};
+constexpr CharacteristicDescriptor SetDuration{.type = kType_SetDuration, .format = Format::UInt32, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 3600};
+constexpr CharacteristicDescriptor ValveType{.type = kType_ValveType, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 3};
+constexpr CharacteristicDescriptor ProgramMode{.type = kType_ProgramMode, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+
+// Air Purifier Characteristics (9.35)
+constexpr CharacteristicDescriptor CurrentAirPurifierState{.type = kType_CurrentAirPurifierState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor TargetAirPurifierState{.type = kType_TargetAirPurifierState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+
+// Heater Cooler Characteristics (9.36)
+constexpr CharacteristicDescriptor CurrentHeaterCoolerState{.type = kType_CurrentHeaterCoolerState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 3};
+constexpr CharacteristicDescriptor TargetHeaterCoolerState{.type = kType_TargetHeaterCoolerState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 2};
+
+// Humidifier Dehumidifier Characteristics (9.37)
+constexpr CharacteristicDescriptor CurrentHumidifierDehumidifierState{.type = kType_CurrentHumidifierDehumidifierState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 3};
+constexpr CharacteristicDescriptor TargetHumidifierDehumidifierState{.type = kType_TargetHumidifierDehumidifierState, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor WaterLevel{.type = kType_WaterLevel, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 100};
+constexpr CharacteristicDescriptor RelativeHumidityDehumidifierThreshold{.type = kType_RelativeHumidityDehumidifierThreshold, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+constexpr CharacteristicDescriptor RelativeHumidityHumidifierThreshold{.type = kType_RelativeHumidityHumidifierThreshold, .format = Format::Float, .permissions = kPR_PW_NT,
+    .unit = "percentage", .min_value = 0, .max_value = 100, .min_step = 1};
+
+// Filter Maintenance Characteristics (9.34)
+constexpr CharacteristicDescriptor FilterLifeLevel{.type = kType_FilterLifeLevel, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 100};
+constexpr CharacteristicDescriptor FilterChangeIndication{.type = kType_FilterChangeIndication, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor ResetFilterIndication{.type = kType_ResetFilterIndication, .format = Format::UInt8, .permissions = kPW,
+    .min_value = 1, .max_value = 1};
+
+// Slat Characteristics (9.33)
+constexpr CharacteristicDescriptor CurrentSlatState{.type = kType_CurrentSlatState, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 2};
+constexpr CharacteristicDescriptor SlatType{.type = kType_SlatType, .format = Format::UInt8, .permissions = kPR,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor CurrentTiltAngle{.type = kType_CurrentTiltAngle, .format = Format::Int, .permissions = kPR_NT,
+    .unit = "arcdegrees", .min_value = -90, .max_value = 90, .min_step = 1};
+constexpr CharacteristicDescriptor TargetTiltAngle{.type = kType_TargetTiltAngle, .format = Format::Int, .permissions = kPR_PW_NT,
+    .unit = "arcdegrees", .min_value = -90, .max_value = 90, .min_step = 1};
+
+// Window Tilt Characteristics
+constexpr CharacteristicDescriptor CurrentHorizontalTiltAngle{.type = kType_CurrentHorizontalTiltAngle, .format = Format::Int, .permissions = kPR_NT,
+    .unit = "arcdegrees", .min_value = -90, .max_value = 90, .min_step = 1};
+constexpr CharacteristicDescriptor TargetHorizontalTiltAngle{.type = kType_TargetHorizontalTiltAngle, .format = Format::Int, .permissions = kPR_PW_NT,
+    .unit = "arcdegrees", .min_value = -90, .max_value = 90, .min_step = 1};
+constexpr CharacteristicDescriptor CurrentVerticalTiltAngle{.type = kType_CurrentVerticalTiltAngle, .format = Format::Int, .permissions = kPR_NT,
+    .unit = "arcdegrees", .min_value = -90, .max_value = 90, .min_step = 1};
+constexpr CharacteristicDescriptor TargetVerticalTiltAngle{.type = kType_TargetVerticalTiltAngle, .format = Format::Int, .permissions = kPR_PW_NT,
+    .unit = "arcdegrees", .min_value = -90, .max_value = 90, .min_step = 1};
+
+// Air Quality Extended Characteristics
+constexpr CharacteristicDescriptor OzoneDensity{.type = kType_OzoneDensity, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1000};
+constexpr CharacteristicDescriptor NitrogenDioxideDensity{.type = kType_NitrogenDioxideDensity, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1000};
+constexpr CharacteristicDescriptor SulphurDioxideDensity{.type = kType_SulphurDioxideDensity, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1000};
+constexpr CharacteristicDescriptor AirParticulateDensity{.type = kType_AirParticulateDensity, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1000};
+constexpr CharacteristicDescriptor AirParticulateSize{.type = kType_AirParticulateSize, .format = Format::UInt8, .permissions = kPR,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor CarbonMonoxidePeakLevel{.type = kType_CarbonMonoxidePeakLevel, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 100};
+constexpr CharacteristicDescriptor CarbonDioxidePeakLevel{.type = kType_CarbonDioxidePeakLevel, .format = Format::Float, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 100000};
+
+// NFC Access Characteristics
+constexpr CharacteristicDescriptor NFCAccessControlPoint{.type = kType_NFCAccessControlPoint, .format = Format::TLV8, .permissions = kPR_PW_WR};
+constexpr CharacteristicDescriptor NFCAccessSupportedConfiguration{.type = kType_NFCAccessSupportedConfiguration, .format = Format::TLV8, .permissions = kPR};
+constexpr CharacteristicDescriptor ConfigurationState{.type = kType_ConfigurationState, .format = Format::UInt16, .permissions = kPR_NT};
+
+// Lock Management Characteristics
+constexpr CharacteristicDescriptor LockControlPoint{.type = kType_LockControlPoint, .format = Format::TLV8, .permissions = kPW};
+constexpr CharacteristicDescriptor LockPhysicalControls{.type = kType_LockPhysicalControls, .format = Format::UInt8, .permissions = kPR_PW_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor LockManagementAutoSecurityTimeout{.type = kType_LockManagementAutoSecurityTimeout, .format = Format::UInt32, .permissions = kPR_PW_NT,
+    .unit = "seconds"};
+constexpr CharacteristicDescriptor LockLastKnownAction{.type = kType_LockLastKnownAction, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 10};
+constexpr CharacteristicDescriptor Logs{.type = kType_Logs, .format = Format::TLV8, .permissions = kPR_NT};
+
+// Miscellaneous Characteristics
+constexpr CharacteristicDescriptor Version{.type = kType_Version, .format = Format::String, .permissions = kPR};
+constexpr CharacteristicDescriptor AdministratorOnlyAccess{.type = kType_AdministratorOnlyAccess, .format = Format::Bool, .permissions = kPR_PW_NT};
+constexpr CharacteristicDescriptor AudioFeedback{.type = kType_AudioFeedback, .format = Format::Bool, .permissions = kPR_PW_NT};
+constexpr CharacteristicDescriptor StatusJammed{.type = kType_StatusJammed, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+constexpr CharacteristicDescriptor SecuritySystemAlarmType{.type = kType_SecuritySystemAlarmType, .format = Format::UInt8, .permissions = kPR_NT,
+    .min_value = 0, .max_value = 1};
+
+} // namespace desc
+
+constexpr const CharacteristicDescriptor* kCatalog[] = {
+    &desc::AccessoryFlags,
+    &desc::FirmwareRevision,
+    &desc::HardwareRevision,
+    &desc::Identify,
+    &desc::Manufacturer,
+    &desc::Model,
+    &desc::Name,
+    &desc::SerialNumber,
+    &desc::HardwareFinish,
+    &desc::On,
+    &desc::Brightness,
+    &desc::Hue,
+    &desc::Saturation,
+    &desc::ColorTemperature,
+    &desc::CurrentTemperature,
+    &desc::TargetTemperature,
+    &desc::TemperatureDisplayUnits,
+    &desc::CurrentHeatingCoolingState,
+    &desc::TargetHeatingCoolingState,
+    &desc::CoolingThresholdTemperature,
+    &desc::HeatingThresholdTemperature,
+    &desc::CurrentRelativeHumidity,
+    &desc::TargetRelativeHumidity,
+    &desc::CurrentDoorState,
+    &desc::TargetDoorState,
+    &desc::ObstructionDetected,
+    &desc::LockCurrentState,
+    &desc::LockTargetState,
+    &desc::Active,
+    &desc::CurrentFanState,
+    &desc::TargetFanState,
+    &desc::RotationDirection,
+    &desc::RotationSpeed,
+    &desc::SwingMode,
+    &desc::CurrentPosition,
+    &desc::TargetPosition,
+    &desc::PositionState,
+    &desc::HoldPosition,
+    &desc::MotionDetected,
+    &desc::OccupancyDetected,
+    &desc::ContactSensorState,
+    &desc::LeakDetected,
+    &desc::SmokeDetected,
+    &desc::CarbonMonoxideDetected,
+    &desc::CarbonMonoxideLevel,
+    &desc::CarbonDioxideDetected,
+    &desc::CarbonDioxideLevel,
+    &desc::CurrentAmbientLightLevel,
+    &desc::AirQuality,
+    &desc::PM2_5Density,
+    &desc::PM10Density,
+    &desc::VOCDensity,
+    &desc::SecuritySystemCurrentState,
+    &desc::SecuritySystemTargetState,
+    &desc::BatteryLevel,
+    &desc::ChargingState,
+    &desc::StatusLowBattery,
+    &desc::StatusActive,
+    &desc::StatusFault,
+    &desc::StatusTampered,
+    &desc::OutletInUse,
+    &desc::Volume,
+    &desc::Mute,
+    &desc::ProgrammableSwitchEvent,
+    &desc::ServiceLabelIndex,
+    &desc::ServiceLabelNamespace,
+    &desc::InUse,
+    &desc::IsConfigured,
+    &desc::RemainingDuration,
+    &desc::SetDuration,
+    &desc::ValveType,
+    &desc::ProgramMode,
+    &desc::CurrentAirPurifierState,
+    &desc::TargetAirPurifierState,
+    &desc::CurrentHeaterCoolerState,
+    &desc::TargetHeaterCoolerState,
+    &desc::CurrentHumidifierDehumidifierState,
+    &desc::TargetHumidifierDehumidifierState,
+    &desc::WaterLevel,
+    &desc::RelativeHumidityDehumidifierThreshold,
+    &desc::RelativeHumidityHumidifierThreshold,
+    &desc::FilterLifeLevel,
+    &desc::FilterChangeIndication,
+    &desc::ResetFilterIndication,
+    &desc::CurrentSlatState,
+    &desc::SlatType,
+    &desc::CurrentTiltAngle,
+    &desc::TargetTiltAngle,
+    &desc::CurrentHorizontalTiltAngle,
+    &desc::TargetHorizontalTiltAngle,
+    &desc::CurrentVerticalTiltAngle,
+    &desc::TargetVerticalTiltAngle,
+    &desc::OzoneDensity,
+    &desc::NitrogenDioxideDensity,
+    &desc::SulphurDioxideDensity,
+    &desc::AirParticulateDensity,
+    &desc::AirParticulateSize,
+    &desc::CarbonMonoxidePeakLevel,
+    &desc::CarbonDioxidePeakLevel,
+    &desc::NFCAccessControlPoint,
+    &desc::NFCAccessSupportedConfiguration,
+    &desc::ConfigurationState,
+    &desc::LockControlPoint,
+    &desc::LockPhysicalControls,
+    &desc::LockManagementAutoSecurityTimeout,
+    &desc::LockLastKnownAction,
+    &desc::Logs,
+    &desc::Version,
+    &desc::AdministratorOnlyAccess,
+    &desc::AudioFeedback,
+    &desc::StatusJammed,
+    &desc::SecuritySystemAlarmType,
+};
+
+constexpr bool types_unique() {
+    for (size_t i = 0; i < std::size(kCatalog); ++i) {
+        for (size_t j = i + 1; j < std::size(kCatalog); ++j) {
+            if (kCatalog[i]->type == kCatalog[j]->type) return false;
+        }
+    }
+    return true;
+}
+static_assert(types_unique(), "characteristic type listed twice in the catalog");
+
+// Built once per descriptor, on first use, and shared by every characteristic
+// made from it; null when the descriptor carries no metadata
+std::shared_ptr<const CharacteristicMetadata> metadata_of(const CharacteristicDescriptor& d) {
+    if (!d.has_metadata()) return nullptr;
+    CharacteristicMetadata metadata;
+    if (!d.unit.empty()) metadata.unit = std::string(d.unit);
+    metadata.min_value = d.min_value;
+    metadata.max_value = d.max_value;
+    metadata.min_step = d.min_step;
+    metadata.max_len = d.max_len;
+    metadata.max_data_len = d.max_data_len;
+    return std::make_shared<const CharacteristicMetadata>(std::move(metadata));
+}
+
+template <const CharacteristicDescriptor& D>
+std::shared_ptr<Characteristic> make() {
+    static const auto kMetadata = metadata_of(D);
+    auto c = make_node<Characteristic>(D.type, D.format, D.permissions);
+    c->set_metadata(kMetadata);
+    return c;
+}
+
+template <const CharacteristicDescriptor& D, typename T>
+std::shared_ptr<Characteristic> make(T initial) {
+    auto c = make<D>();
+    c->set(std::move(initial));
+    return c;
+}
+
+} // namespace
+
+const CharacteristicDescriptor* find_descriptor(uint64_t type) {
+    for (const auto* d : kCatalog) {
+        if (d->type == type) return d;
+    }
+    return nullptr;
+}
 
 //==============================================================================
 // Accessory Information Characteristics
 //==============================================================================
 
 std::shared_ptr<Characteristic> AccessoryFlags() {
-    auto c = std::make_shared<Characteristic>(kType_AccessoryFlags, Format::UInt32, PERM_PR_NT);
-    c->set_value(static_cast<uint32_t>(0));
-    return c;
+    return make<desc::AccessoryFlags>(static_cast<uint32_t>(0));
 }
 
 std::shared_ptr<Characteristic> FirmwareRevision() {
-    auto c = std::make_shared<Characteristic>(kType_FirmwareRevision, Format::String, PERM_PR);
-    c->set_value(std::string("1.0.0"));
-    return c;
+    return make<desc::FirmwareRevision>(std::string("1.0.0"));
 }
 
 std::shared_ptr<Characteristic> HardwareRevision() {
-    auto c = std::make_shared<Characteristic>(kType_HardwareRevision, Format::String, PERM_PR);
-    c->set_value(std::string("1.0.0"));
-    return c;
+    return make<desc::HardwareRevision>(std::string("1.0.0"));
 }
 
 std::shared_ptr<Characteristic> Identify() {
-    auto c = std::make_shared<Characteristic>(kType_Identify, Format::Bool, PERM_PR_PW);
-    c->set_value(false);
-    return c;
+    return make<desc::Identify>(false);
 }
 
 std::shared_ptr<Characteristic> Manufacturer() {
-    auto c = std::make_shared<Characteristic>(kType_Manufacturer, Format::String, PERM_PR);
-    c->set_max_len(64);
-    c->set_value(std::string(""));
-    return c;
+    return make<desc::Manufacturer>(std::string(""));
 }
 
 std::shared_ptr<Characteristic> Model() {
-    auto c = std::make_shared<Characteristic>(kType_Model, Format::String, PERM_PR);
-    c->set_max_len(64);
-    c->set_value(std::string(""));
-    return c;
+    return make<desc::Model>(std::string(""));
 }
 
 std::shared_ptr<Characteristic> Name() {
-    auto c = std::make_shared<Characteristic>(kType_Name, Format::String, PERM_PR);
-    c->set_max_len(64);
-    c->set_value(std::string(""));
-    return c;
+    return make<desc::Name>(std::string(""));
 }
 
 std::shared_ptr<Characteristic> SerialNumber() {
-    auto c = std::make_shared<Characteristic>(kType_SerialNumber, Format::String, PERM_PR);
-    c->set_max_len(64);
-    c->set_value(std::string(""));
-    return c;
+    return make<desc::SerialNumber>(std::string(""));
 }
 
 std::shared_ptr<Characteristic> HardwareFinish() {
-    auto c = std::make_shared<Characteristic>(kType_HardwareFinish, Format::TLV8, PERM_PR);
-    c->set_value(TLV8::encode({TLV(0x01,{0xce,0xd5,0xda,0x00})}));
-    return c;
+    return make<desc::HardwareFinish>(TLV8::encode({TLV(0x01,{0xce,0xd5,0xda,0x00})}));
 }
 
 //==============================================================================
@@ -90,48 +505,23 @@ std::shared_ptr<Characteristic> HardwareFinish() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> On() {
-    auto c = std::make_shared<Characteristic>(kType_On, Format::Bool, PERM_PR_PW_NT);
-    c->set_value(false);
-    return c;
+    return make<desc::On>(false);
 }
 
 std::shared_ptr<Characteristic> Brightness() {
-    auto c = std::make_shared<Characteristic>(kType_Brightness, Format::Int, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(static_cast<int32_t>(100));
-    return c;
+    return make<desc::Brightness>(static_cast<int32_t>(100));
 }
 
 std::shared_ptr<Characteristic> Hue() {
-    auto c = std::make_shared<Characteristic>(kType_Hue, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("arcdegrees");
-    c->set_min_value(0);
-    c->set_max_value(360);
-    c->set_min_step(1);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::Hue>(0.0f);
 }
 
 std::shared_ptr<Characteristic> Saturation() {
-    auto c = std::make_shared<Characteristic>(kType_Saturation, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::Saturation>(0.0f);
 }
 
 std::shared_ptr<Characteristic> ColorTemperature() {
-    auto c = std::make_shared<Characteristic>(kType_ColorTemperature, Format::UInt32, PERM_PR_PW_NT);
-    c->set_min_value(140);    // ~7142K (cool white)
-    c->set_max_value(500);    // 2000K (warm white)
-    c->set_min_step(1);
-    c->set_value(static_cast<uint32_t>(200));
-    return c;
+    return make<desc::ColorTemperature>(static_cast<uint32_t>(200));
 }
 
 //==============================================================================
@@ -139,67 +529,31 @@ std::shared_ptr<Characteristic> ColorTemperature() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentTemperature() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentTemperature, Format::Float, PERM_PR_NT);
-    c->set_unit("celsius");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(0.1);
-    c->set_value(20.0f);
-    return c;
+    return make<desc::CurrentTemperature>(20.0f);
 }
 
 std::shared_ptr<Characteristic> TargetTemperature() {
-    auto c = std::make_shared<Characteristic>(kType_TargetTemperature, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("celsius");
-    c->set_min_value(10);
-    c->set_max_value(38);
-    c->set_min_step(0.1);
-    c->set_value(20.0f);
-    return c;
+    return make<desc::TargetTemperature>(20.0f);
 }
 
 std::shared_ptr<Characteristic> TemperatureDisplayUnitsChar() {
-    auto c = std::make_shared<Characteristic>(kType_TemperatureDisplayUnits, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Celsius
-    return c;
+    return make<desc::TemperatureDisplayUnits>(static_cast<uint8_t>(0)); // Celsius
 }
 
 std::shared_ptr<Characteristic> CurrentHeatingCoolingStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentHeatingCoolingState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // Off
-    return c;
+    return make<desc::CurrentHeatingCoolingState>(static_cast<uint8_t>(0)); // Off
 }
 
 std::shared_ptr<Characteristic> TargetHeatingCoolingStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_TargetHeatingCoolingState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(3);
-    c->set_value(static_cast<uint8_t>(0)); // Off
-    return c;
+    return make<desc::TargetHeatingCoolingState>(static_cast<uint8_t>(0)); // Off
 }
 
 std::shared_ptr<Characteristic> CoolingThresholdTemperature() {
-    auto c = std::make_shared<Characteristic>(kType_CoolingThresholdTemperature, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("celsius");
-    c->set_min_value(10);
-    c->set_max_value(35);
-    c->set_min_step(0.1);
-    c->set_value(26.0f);
-    return c;
+    return make<desc::CoolingThresholdTemperature>(26.0f);
 }
 
 std::shared_ptr<Characteristic> HeatingThresholdTemperature() {
-    auto c = std::make_shared<Characteristic>(kType_HeatingThresholdTemperature, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("celsius");
-    c->set_min_value(0);
-    c->set_max_value(25);
-    c->set_min_step(0.1);
-    c->set_value(18.0f);
-    return c;
+    return make<desc::HeatingThresholdTemperature>(18.0f);
 }
 
 //==============================================================================
@@ -207,23 +561,11 @@ std::shared_ptr<Characteristic> HeatingThresholdTemperature() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentRelativeHumidity() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentRelativeHumidity, Format::Float, PERM_PR_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(50.0f);
-    return c;
+    return make<desc::CurrentRelativeHumidity>(50.0f);
 }
 
 std::shared_ptr<Characteristic> TargetRelativeHumidity() {
-    auto c = std::make_shared<Characteristic>(kType_TargetRelativeHumidity, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(50.0f);
-    return c;
+    return make<desc::TargetRelativeHumidity>(50.0f);
 }
 
 //==============================================================================
@@ -231,25 +573,15 @@ std::shared_ptr<Characteristic> TargetRelativeHumidity() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentDoorStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentDoorState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(4);
-    c->set_value(static_cast<uint8_t>(1)); // Closed
-    return c;
+    return make<desc::CurrentDoorState>(static_cast<uint8_t>(1)); // Closed
 }
 
 std::shared_ptr<Characteristic> TargetDoorStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_TargetDoorState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(1)); // Closed
-    return c;
+    return make<desc::TargetDoorState>(static_cast<uint8_t>(1)); // Closed
 }
 
 std::shared_ptr<Characteristic> ObstructionDetected() {
-    auto c = std::make_shared<Characteristic>(kType_ObstructionDetected, Format::Bool, PERM_PR_NT);
-    c->set_value(false);
-    return c;
+    return make<desc::ObstructionDetected>(false);
 }
 
 //==============================================================================
@@ -257,19 +589,11 @@ std::shared_ptr<Characteristic> ObstructionDetected() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> LockCurrentStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_LockCurrentState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(3);
-    c->set_value(static_cast<uint8_t>(1)); // Secured
-    return c;
+    return make<desc::LockCurrentState>(static_cast<uint8_t>(1)); // Secured
 }
 
 std::shared_ptr<Characteristic> LockTargetStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_LockTargetState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(1)); // Secured
-    return c;
+    return make<desc::LockTargetState>(static_cast<uint8_t>(1)); // Secured
 }
 
 //==============================================================================
@@ -277,53 +601,27 @@ std::shared_ptr<Characteristic> LockTargetStateChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> ActiveChar() {
-    auto c = std::make_shared<Characteristic>(kType_Active, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Inactive
-    return c;
+    return make<desc::Active>(static_cast<uint8_t>(0)); // Inactive
 }
 
 std::shared_ptr<Characteristic> CurrentFanStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentFanState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // Inactive
-    return c;
+    return make<desc::CurrentFanState>(static_cast<uint8_t>(0)); // Inactive
 }
 
 std::shared_ptr<Characteristic> TargetFanStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_TargetFanState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Manual
-    return c;
+    return make<desc::TargetFanState>(static_cast<uint8_t>(0)); // Manual
 }
 
 std::shared_ptr<Characteristic> RotationDirectionChar() {
-    auto c = std::make_shared<Characteristic>(kType_RotationDirection, Format::Int, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<int32_t>(0)); // Clockwise
-    return c;
+    return make<desc::RotationDirection>(static_cast<int32_t>(0)); // Clockwise
 }
 
 std::shared_ptr<Characteristic> RotationSpeed() {
-    auto c = std::make_shared<Characteristic>(kType_RotationSpeed, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::RotationSpeed>(0.0f);
 }
 
 std::shared_ptr<Characteristic> SwingModeChar() {
-    auto c = std::make_shared<Characteristic>(kType_SwingMode, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Disabled
-    return c;
+    return make<desc::SwingMode>(static_cast<uint8_t>(0)); // Disabled
 }
 
 //==============================================================================
@@ -331,37 +629,19 @@ std::shared_ptr<Characteristic> SwingModeChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentPosition() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentPosition, Format::UInt8, PERM_PR_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::CurrentPosition>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> TargetPosition() {
-    auto c = std::make_shared<Characteristic>(kType_TargetPosition, Format::UInt8, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::TargetPosition>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> PositionStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_PositionState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(2)); // Stopped
-    return c;
+    return make<desc::PositionState>(static_cast<uint8_t>(2)); // Stopped
 }
 
 std::shared_ptr<Characteristic> HoldPositionChar() {
-    auto c = std::make_shared<Characteristic>(kType_HoldPosition, Format::Bool, PERM_PW);
-    c->set_value(false);
-    return c;
+    return make<desc::HoldPosition>(false);
 }
 
 //==============================================================================
@@ -369,82 +649,43 @@ std::shared_ptr<Characteristic> HoldPositionChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> MotionDetected() {
-    auto c = std::make_shared<Characteristic>(kType_MotionDetected, Format::Bool, PERM_PR_NT);
-    c->set_value(false);
-    return c;
+    return make<desc::MotionDetected>(false);
 }
 
 std::shared_ptr<Characteristic> OccupancyDetected() {
-    auto c = std::make_shared<Characteristic>(kType_OccupancyDetected, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::OccupancyDetected>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> ContactSensorStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_ContactSensorState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::ContactSensorState>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> LeakDetected() {
-    auto c = std::make_shared<Characteristic>(kType_LeakDetected, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::LeakDetected>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> SmokeDetected() {
-    auto c = std::make_shared<Characteristic>(kType_SmokeDetected, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::SmokeDetected>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> CarbonMonoxideDetectedChar() {
-    auto c = std::make_shared<Characteristic>(kType_CarbonMonoxideDetected, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::CarbonMonoxideDetected>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> CarbonMonoxideLevel() {
-    auto c = std::make_shared<Characteristic>(kType_CarbonMonoxideLevel, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::CarbonMonoxideLevel>(0.0f);
 }
 
 std::shared_ptr<Characteristic> CarbonDioxideDetectedChar() {
-    auto c = std::make_shared<Characteristic>(kType_CarbonDioxideDetected, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::CarbonDioxideDetected>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> CarbonDioxideLevel() {
-    auto c = std::make_shared<Characteristic>(kType_CarbonDioxideLevel, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(100000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::CarbonDioxideLevel>(0.0f);
 }
 
 std::shared_ptr<Characteristic> CurrentAmbientLightLevel() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentAmbientLightLevel, Format::Float, PERM_PR_NT);
-    c->set_unit("lux");
-    c->set_min_value(0.0001);
-    c->set_max_value(100000);
-    c->set_value(1.0f);
-    return c;
+    return make<desc::CurrentAmbientLightLevel>(1.0f);
 }
 
 //==============================================================================
@@ -452,35 +693,19 @@ std::shared_ptr<Characteristic> CurrentAmbientLightLevel() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> AirQualityChar() {
-    auto c = std::make_shared<Characteristic>(kType_AirQuality, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(5);
-    c->set_value(static_cast<uint8_t>(0)); // Unknown
-    return c;
+    return make<desc::AirQuality>(static_cast<uint8_t>(0)); // Unknown
 }
 
 std::shared_ptr<Characteristic> PM2_5Density() {
-    auto c = std::make_shared<Characteristic>(kType_PM2_5Density, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::PM2_5Density>(0.0f);
 }
 
 std::shared_ptr<Characteristic> PM10Density() {
-    auto c = std::make_shared<Characteristic>(kType_PM10Density, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::PM10Density>(0.0f);
 }
 
 std::shared_ptr<Characteristic> VOCDensity() {
-    auto c = std::make_shared<Characteristic>(kType_VOCDensity, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::VOCDensity>(0.0f);
 }
 
 //==============================================================================
@@ -488,19 +713,11 @@ std::shared_ptr<Characteristic> VOCDensity() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> SecuritySystemCurrentStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_SecuritySystemCurrentState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(4);
-    c->set_value(static_cast<uint8_t>(3)); // Disarmed
-    return c;
+    return make<desc::SecuritySystemCurrentState>(static_cast<uint8_t>(3)); // Disarmed
 }
 
 std::shared_ptr<Characteristic> SecuritySystemTargetStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_SecuritySystemTargetState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(3);
-    c->set_value(static_cast<uint8_t>(3)); // Disarm
-    return c;
+    return make<desc::SecuritySystemTargetState>(static_cast<uint8_t>(3)); // Disarm
 }
 
 //==============================================================================
@@ -508,28 +725,15 @@ std::shared_ptr<Characteristic> SecuritySystemTargetStateChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> BatteryLevel() {
-    auto c = std::make_shared<Characteristic>(kType_BatteryLevel, Format::UInt8, PERM_PR_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_value(static_cast<uint8_t>(100));
-    return c;
+    return make<desc::BatteryLevel>(static_cast<uint8_t>(100));
 }
 
 std::shared_ptr<Characteristic> ChargingStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_ChargingState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // Not Charging
-    return c;
+    return make<desc::ChargingState>(static_cast<uint8_t>(0)); // Not Charging
 }
 
 std::shared_ptr<Characteristic> StatusLowBatteryChar() {
-    auto c = std::make_shared<Characteristic>(kType_StatusLowBattery, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Normal
-    return c;
+    return make<desc::StatusLowBattery>(static_cast<uint8_t>(0)); // Normal
 }
 
 //==============================================================================
@@ -537,25 +741,15 @@ std::shared_ptr<Characteristic> StatusLowBatteryChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> StatusActive() {
-    auto c = std::make_shared<Characteristic>(kType_StatusActive, Format::Bool, PERM_PR_NT);
-    c->set_value(true);
-    return c;
+    return make<desc::StatusActive>(true);
 }
 
 std::shared_ptr<Characteristic> StatusFault() {
-    auto c = std::make_shared<Characteristic>(kType_StatusFault, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // No Fault
-    return c;
+    return make<desc::StatusFault>(static_cast<uint8_t>(0)); // No Fault
 }
 
 std::shared_ptr<Characteristic> StatusTampered() {
-    auto c = std::make_shared<Characteristic>(kType_StatusTampered, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Not Tampered
-    return c;
+    return make<desc::StatusTampered>(static_cast<uint8_t>(0)); // Not Tampered
 }
 
 //==============================================================================
@@ -563,9 +757,7 @@ std::shared_ptr<Characteristic> StatusTampered() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> OutletInUse() {
-    auto c = std::make_shared<Characteristic>(kType_OutletInUse, Format::Bool, PERM_PR_NT);
-    c->set_value(false);
-    return c;
+    return make<desc::OutletInUse>(false);
 }
 
 //==============================================================================
@@ -573,19 +765,11 @@ std::shared_ptr<Characteristic> OutletInUse() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> Volume() {
-    auto c = std::make_shared<Characteristic>(kType_Volume, Format::UInt8, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(static_cast<uint8_t>(50));
-    return c;
+    return make<desc::Volume>(static_cast<uint8_t>(50));
 }
 
 std::shared_ptr<Characteristic> Mute() {
-    auto c = std::make_shared<Characteristic>(kType_Mute, Format::Bool, PERM_PR_PW_NT);
-    c->set_value(false);
-    return c;
+    return make<desc::Mute>(false);
 }
 
 //==============================================================================
@@ -594,27 +778,15 @@ std::shared_ptr<Characteristic> Mute() {
 
 std::shared_ptr<Characteristic> ProgrammableSwitchEventChar() {
     // Note: This characteristic is event-only (null value allowed)
-    auto c = std::make_shared<Characteristic>(kType_ProgrammableSwitchEvent, Format::UInt8, 
-        std::vector{Permission::PairedRead, Permission::Notify});
-    c->set_min_value(0);
-    c->set_max_value(2);
-    return c;
+    return make<desc::ProgrammableSwitchEvent>();
 }
 
 std::shared_ptr<Characteristic> ServiceLabelIndex() {
-    auto c = std::make_shared<Characteristic>(kType_ServiceLabelIndex, Format::UInt8, PERM_PR);
-    c->set_min_value(1);
-    c->set_max_value(255);
-    c->set_value(static_cast<uint8_t>(1));
-    return c;
+    return make<desc::ServiceLabelIndex>(static_cast<uint8_t>(1));
 }
 
 std::shared_ptr<Characteristic> ServiceLabelNamespaceChar() {
-    auto c = std::make_shared<Characteristic>(kType_ServiceLabelNamespace, Format::UInt8, PERM_PR);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(1)); // Arabic numerals
-    return c;
+    return make<desc::ServiceLabelNamespace>(static_cast<uint8_t>(1)); // Arabic numerals
 }
 
 //==============================================================================
@@ -622,51 +794,27 @@ std::shared_ptr<Characteristic> ServiceLabelNamespaceChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> InUseChar() {
-    auto c = std::make_shared<Characteristic>(kType_InUse, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Not in use
-    return c;
+    return make<desc::InUse>(static_cast<uint8_t>(0)); // Not in use
 }
 
 std::shared_ptr<Characteristic> IsConfigured() {
-    auto c = std::make_shared<Characteristic>(kType_IsConfigured, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Not configured
-    return c;
+    return make<desc::IsConfigured>(static_cast<uint8_t>(0)); // Not configured
 }
 
 std::shared_ptr<Characteristic> RemainingDuration() {
-    auto c = std::make_shared<Characteristic>(kType_RemainingDuration, Format::UInt32, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(3600);
-    c->set_value(static_cast<uint32_t>(0));
-    return c;
+    return make<desc::RemainingDuration>(static_cast<uint32_t>(0));
 }
 
 std::shared_ptr<Characteristic> SetDuration() {
-    auto c = std::make_shared<Characteristic>(kType_SetDuration, Format::UInt32, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(3600);
-    c->set_value(static_cast<uint32_t>(0));
-    return c;
+    return make<desc::SetDuration>(static_cast<uint32_t>(0));
 }
 
 std::shared_ptr<Characteristic> ValveTypeChar() {
-    auto c = std::make_shared<Characteristic>(kType_ValveType, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(3);
-    c->set_value(static_cast<uint8_t>(0)); // Generic
-    return c;
+    return make<desc::ValveType>(static_cast<uint8_t>(0)); // Generic
 }
 
 std::shared_ptr<Characteristic> ProgramMode() {
-    auto c = std::make_shared<Characteristic>(kType_ProgramMode, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // No program scheduled
-    return c;
+    return make<desc::ProgramMode>(static_cast<uint8_t>(0)); // No program scheduled
 }
 
 //==============================================================================
@@ -674,19 +822,11 @@ std::shared_ptr<Characteristic> ProgramMode() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentAirPurifierStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentAirPurifierState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // Inactive
-    return c;
+    return make<desc::CurrentAirPurifierState>(static_cast<uint8_t>(0)); // Inactive
 }
 
 std::shared_ptr<Characteristic> TargetAirPurifierStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_TargetAirPurifierState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Manual
-    return c;
+    return make<desc::TargetAirPurifierState>(static_cast<uint8_t>(0)); // Manual
 }
 
 //==============================================================================
@@ -694,19 +834,11 @@ std::shared_ptr<Characteristic> TargetAirPurifierStateChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentHeaterCoolerStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentHeaterCoolerState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(3);
-    c->set_value(static_cast<uint8_t>(0)); // Inactive
-    return c;
+    return make<desc::CurrentHeaterCoolerState>(static_cast<uint8_t>(0)); // Inactive
 }
 
 std::shared_ptr<Characteristic> TargetHeaterCoolerStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_TargetHeaterCoolerState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // Auto
-    return c;
+    return make<desc::TargetHeaterCoolerState>(static_cast<uint8_t>(0)); // Auto
 }
 
 //==============================================================================
@@ -714,47 +846,23 @@ std::shared_ptr<Characteristic> TargetHeaterCoolerStateChar() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentHumidifierDehumidifierStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentHumidifierDehumidifierState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(3);
-    c->set_value(static_cast<uint8_t>(0)); // Inactive
-    return c;
+    return make<desc::CurrentHumidifierDehumidifierState>(static_cast<uint8_t>(0)); // Inactive
 }
 
 std::shared_ptr<Characteristic> TargetHumidifierDehumidifierStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_TargetHumidifierDehumidifierState, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // Humidifier or Dehumidifier
-    return c;
+    return make<desc::TargetHumidifierDehumidifierState>(static_cast<uint8_t>(0)); // Humidifier or Dehumidifier
 }
 
 std::shared_ptr<Characteristic> WaterLevel() {
-    auto c = std::make_shared<Characteristic>(kType_WaterLevel, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::WaterLevel>(0.0f);
 }
 
 std::shared_ptr<Characteristic> RelativeHumidityDehumidifierThreshold() {
-    auto c = std::make_shared<Characteristic>(kType_RelativeHumidityDehumidifierThreshold, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(50.0f);
-    return c;
+    return make<desc::RelativeHumidityDehumidifierThreshold>(50.0f);
 }
 
 std::shared_ptr<Characteristic> RelativeHumidityHumidifierThreshold() {
-    auto c = std::make_shared<Characteristic>(kType_RelativeHumidityHumidifierThreshold, Format::Float, PERM_PR_PW_NT);
-    c->set_unit("percentage");
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_min_step(1);
-    c->set_value(50.0f);
-    return c;
+    return make<desc::RelativeHumidityHumidifierThreshold>(50.0f);
 }
 
 //==============================================================================
@@ -762,26 +870,15 @@ std::shared_ptr<Characteristic> RelativeHumidityHumidifierThreshold() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> FilterLifeLevel() {
-    auto c = std::make_shared<Characteristic>(kType_FilterLifeLevel, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_value(100.0f);
-    return c;
+    return make<desc::FilterLifeLevel>(100.0f);
 }
 
 std::shared_ptr<Characteristic> FilterChangeIndication() {
-    auto c = std::make_shared<Characteristic>(kType_FilterChangeIndication, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Filter OK
-    return c;
+    return make<desc::FilterChangeIndication>(static_cast<uint8_t>(0)); // Filter OK
 }
 
 std::shared_ptr<Characteristic> ResetFilterIndication() {
-    auto c = std::make_shared<Characteristic>(kType_ResetFilterIndication, Format::UInt8, PERM_PW);
-    c->set_min_value(1);
-    c->set_max_value(1);
-    return c;
+    return make<desc::ResetFilterIndication>();
 }
 
 //==============================================================================
@@ -789,39 +886,19 @@ std::shared_ptr<Characteristic> ResetFilterIndication() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentSlatStateChar() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentSlatState, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(2);
-    c->set_value(static_cast<uint8_t>(0)); // Fixed
-    return c;
+    return make<desc::CurrentSlatState>(static_cast<uint8_t>(0)); // Fixed
 }
 
 std::shared_ptr<Characteristic> SlatTypeChar() {
-    auto c = std::make_shared<Characteristic>(kType_SlatType, Format::UInt8, PERM_PR);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Horizontal
-    return c;
+    return make<desc::SlatType>(static_cast<uint8_t>(0)); // Horizontal
 }
 
 std::shared_ptr<Characteristic> CurrentTiltAngle() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentTiltAngle, Format::Int, PERM_PR_NT);
-    c->set_unit("arcdegrees");
-    c->set_min_value(-90);
-    c->set_max_value(90);
-    c->set_min_step(1);
-    c->set_value(static_cast<int32_t>(0));
-    return c;
+    return make<desc::CurrentTiltAngle>(static_cast<int32_t>(0));
 }
 
 std::shared_ptr<Characteristic> TargetTiltAngle() {
-    auto c = std::make_shared<Characteristic>(kType_TargetTiltAngle, Format::Int, PERM_PR_PW_NT);
-    c->set_unit("arcdegrees");
-    c->set_min_value(-90);
-    c->set_max_value(90);
-    c->set_min_step(1);
-    c->set_value(static_cast<int32_t>(0));
-    return c;
+    return make<desc::TargetTiltAngle>(static_cast<int32_t>(0));
 }
 
 //==============================================================================
@@ -829,43 +906,19 @@ std::shared_ptr<Characteristic> TargetTiltAngle() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> CurrentHorizontalTiltAngle() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentHorizontalTiltAngle, Format::Int, PERM_PR_NT);
-    c->set_unit("arcdegrees");
-    c->set_min_value(-90);
-    c->set_max_value(90);
-    c->set_min_step(1);
-    c->set_value(static_cast<int32_t>(0));
-    return c;
+    return make<desc::CurrentHorizontalTiltAngle>(static_cast<int32_t>(0));
 }
 
 std::shared_ptr<Characteristic> TargetHorizontalTiltAngle() {
-    auto c = std::make_shared<Characteristic>(kType_TargetHorizontalTiltAngle, Format::Int, PERM_PR_PW_NT);
-    c->set_unit("arcdegrees");
-    c->set_min_value(-90);
-    c->set_max_value(90);
-    c->set_min_step(1);
-    c->set_value(static_cast<int32_t>(0));
-    return c;
+    return make<desc::TargetHorizontalTiltAngle>(static_cast<int32_t>(0));
 }
 
 std::shared_ptr<Characteristic> CurrentVerticalTiltAngle() {
-    auto c = std::make_shared<Characteristic>(kType_CurrentVerticalTiltAngle, Format::Int, PERM_PR_NT);
-    c->set_unit("arcdegrees");
-    c->set_min_value(-90);
-    c->set_max_value(90);
-    c->set_min_step(1);
-    c->set_value(static_cast<int32_t>(0));
-    return c;
+    return make<desc::CurrentVerticalTiltAngle>(static_cast<int32_t>(0));
 }
 
 std::shared_ptr<Characteristic> TargetVerticalTiltAngle() {
-    auto c = std::make_shared<Characteristic>(kType_TargetVerticalTiltAngle, Format::Int, PERM_PR_PW_NT);
-    c->set_unit("arcdegrees");
-    c->set_min_value(-90);
-    c->set_max_value(90);
-    c->set_min_step(1);
-    c->set_value(static_cast<int32_t>(0));
-    return c;
+    return make<desc::TargetVerticalTiltAngle>(static_cast<int32_t>(0));
 }
 
 //==============================================================================
@@ -873,81 +926,47 @@ std::shared_ptr<Characteristic> TargetVerticalTiltAngle() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> OzoneDensity() {
-    auto c = std::make_shared<Characteristic>(kType_OzoneDensity, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::OzoneDensity>(0.0f);
 }
 
 std::shared_ptr<Characteristic> NitrogenDioxideDensity() {
-    auto c = std::make_shared<Characteristic>(kType_NitrogenDioxideDensity, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::NitrogenDioxideDensity>(0.0f);
 }
 
 std::shared_ptr<Characteristic> SulphurDioxideDensity() {
-    auto c = std::make_shared<Characteristic>(kType_SulphurDioxideDensity, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::SulphurDioxideDensity>(0.0f);
 }
 
 std::shared_ptr<Characteristic> AirParticulateDensity() {
-    auto c = std::make_shared<Characteristic>(kType_AirParticulateDensity, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::AirParticulateDensity>(0.0f);
 }
 
 std::shared_ptr<Characteristic> AirParticulateSize() {
-    auto c = std::make_shared<Characteristic>(kType_AirParticulateSize, Format::UInt8, PERM_PR);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // 2.5 um
-    return c;
+    return make<desc::AirParticulateSize>(static_cast<uint8_t>(0)); // 2.5 um
 }
 
 std::shared_ptr<Characteristic> CarbonMonoxidePeakLevel() {
-    auto c = std::make_shared<Characteristic>(kType_CarbonMonoxidePeakLevel, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(100);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::CarbonMonoxidePeakLevel>(0.0f);
 }
 
 std::shared_ptr<Characteristic> CarbonDioxidePeakLevel() {
-    auto c = std::make_shared<Characteristic>(kType_CarbonDioxidePeakLevel, Format::Float, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(100000);
-    c->set_value(0.0f);
-    return c;
+    return make<desc::CarbonDioxidePeakLevel>(0.0f);
 }
 
-//============================================================================== 
+//==============================================================================
 // NFC Access Characteristics
 //==============================================================================
 
 std::shared_ptr<Characteristic> NFCAccessControlPoint() {
-    auto c = std::make_shared<Characteristic>(kType_NFCAccessControlPoint, Format::TLV8, PERM_PR_PW_WR);
-    c->set_value(TLV8::encode({}));
-    return c;
+    return make<desc::NFCAccessControlPoint>(TLV8::encode({}));
 }
 
 std::shared_ptr<Characteristic> NFCAccessSupportedConfiguration() {
-    auto c = std::make_shared<Characteristic>(kType_NFCAccessSupportedConfiguration, Format::TLV8, PERM_PR);
-    c->set_value(TLV8::encode({TLV(0x01,0x10), TLV(0x02,0x10)}));
-    return c;
+    return make<desc::NFCAccessSupportedConfiguration>(TLV8::encode({TLV(0x01,0x10), TLV(0x02,0x10)}));
 }
 
 std::shared_ptr<Characteristic> ConfigurationState() {
-    auto c = std::make_shared<Characteristic>(kType_ConfigurationState, Format::UInt16, PERM_PR_NT);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::ConfigurationState>(static_cast<uint8_t>(0));
 }
 
 //==============================================================================
@@ -955,36 +974,23 @@ std::shared_ptr<Characteristic> ConfigurationState() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> LockControlPoint() {
-    auto c = std::make_shared<Characteristic>(kType_LockControlPoint, Format::TLV8, PERM_PW);
-    return c;
+    return make<desc::LockControlPoint>();
 }
 
 std::shared_ptr<Characteristic> LockPhysicalControls() {
-    auto c = std::make_shared<Characteristic>(kType_LockPhysicalControls, Format::UInt8, PERM_PR_PW_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Control Lock Disabled
-    return c;
+    return make<desc::LockPhysicalControls>(static_cast<uint8_t>(0)); // Control Lock Disabled
 }
 
 std::shared_ptr<Characteristic> LockManagementAutoSecurityTimeout() {
-    auto c = std::make_shared<Characteristic>(kType_LockManagementAutoSecurityTimeout, Format::UInt32, PERM_PR_PW_NT);
-    c->set_unit("seconds");
-    c->set_value(static_cast<uint32_t>(0));
-    return c;
+    return make<desc::LockManagementAutoSecurityTimeout>(static_cast<uint32_t>(0));
 }
 
 std::shared_ptr<Characteristic> LockLastKnownAction() {
-    auto c = std::make_shared<Characteristic>(kType_LockLastKnownAction, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(10);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::LockLastKnownAction>(static_cast<uint8_t>(0));
 }
 
 std::shared_ptr<Characteristic> Logs() {
-    auto c = std::make_shared<Characteristic>(kType_Logs, Format::TLV8, PERM_PR_NT);
-    return c;
+    return make<desc::Logs>();
 }
 
 //==============================================================================
@@ -992,37 +998,23 @@ std::shared_ptr<Characteristic> Logs() {
 //==============================================================================
 
 std::shared_ptr<Characteristic> Version() {
-    auto c = std::make_shared<Characteristic>(kType_Version, Format::String, PERM_PR);
-    c->set_value(std::string("1.0.0"));
-    return c;
+    return make<desc::Version>(std::string("1.0.0"));
 }
 
 std::shared_ptr<Characteristic> AdministratorOnlyAccess() {
-    auto c = std::make_shared<Characteristic>(kType_AdministratorOnlyAccess, Format::Bool, PERM_PR_PW_NT);
-    c->set_value(false);
-    return c;
+    return make<desc::AdministratorOnlyAccess>(false);
 }
 
 std::shared_ptr<Characteristic> AudioFeedback() {
-    auto c = std::make_shared<Characteristic>(kType_AudioFeedback, Format::Bool, PERM_PR_PW_NT);
-    c->set_value(false);
-    return c;
+    return make<desc::AudioFeedback>(false);
 }
 
 std::shared_ptr<Characteristic> StatusJammed() {
-    auto c = std::make_shared<Characteristic>(kType_StatusJammed, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0)); // Not Jammed
-    return c;
+    return make<desc::StatusJammed>(static_cast<uint8_t>(0)); // Not Jammed
 }
 
 std::shared_ptr<Characteristic> SecuritySystemAlarmType() {
-    auto c = std::make_shared<Characteristic>(kType_SecuritySystemAlarmType, Format::UInt8, PERM_PR_NT);
-    c->set_min_value(0);
-    c->set_max_value(1);
-    c->set_value(static_cast<uint8_t>(0));
-    return c;
+    return make<desc::SecuritySystemAlarmType>(static_cast<uint8_t>(0));
 }
 
 } // namespace hap::characteristic
@@ -4,6 +4,7 @@
  */
 
 #include "hap/types/ServiceTypes.hpp"
+#include "hap/core/AttributeArena.hpp"
 #include "hap/types/CharacteristicTypes.hpp"
 
 namespace hap::service {
@@ -16,7 +17,7 @@ namespace chr = hap::characteristic;
 //==============================================================================
 
 AccessoryInformationBuilder::AccessoryInformationBuilder() {
-    service_ = std::make_shared<Service>(kType_AccessoryInformation, "Accessory Information");
+    service_ = make_node<Service>(kType_AccessoryInformation, "Accessory Information");
     
     // Required characteristics (create them upfront)
     name_char_ = chr::Name();
@@ -98,7 +99,7 @@ std::shared_ptr<Service> AccessoryInformationBuilder::build() {
 //==============================================================================
 
 HAPProtocolInformationBuilder::HAPProtocolInformationBuilder() {
-    service_ = std::make_shared<Service>(kType_HAPProtocolInformation, "Protocol Information");
+    service_ = make_node<Service>(kType_HAPProtocolInformation, "Protocol Information");
     
     version_char_ = chr::Version();
     add_characteristic(version_char_);
@@ -113,7 +114,7 @@ std::shared_ptr<Service> HAPProtocolInformationBuilder::build() {
 //==============================================================================
 
 LightBulbBuilder::LightBulbBuilder() {
-    service_ = std::make_shared<Service>(kType_LightBulb, "Lightbulb", true);
+    service_ = make_node<Service>(kType_LightBulb, "Lightbulb", true);
     
     // Required characteristic
     on_char_ = chr::On();
@@ -185,7 +186,7 @@ std::shared_ptr<Service> LightBulbBuilder::build() {
 //==============================================================================
 
 SwitchBuilder::SwitchBuilder() {
-    service_ = std::make_shared<Service>(kType_Switch, "Switch", true);
+    service_ = make_node<Service>(kType_Switch, "Switch", true);
     on_char_ = chr::On();
     add_characteristic(on_char_);
 }
@@ -215,7 +216,7 @@ std::shared_ptr<Service> SwitchBuilder::build() {
 //==============================================================================
 
 OutletBuilder::OutletBuilder() {
-    service_ = std::make_shared<Service>(kType_Outlet, "Outlet", true);
+    service_ = make_node<Service>(kType_Outlet, "Outlet", true);
     
     on_char_ = chr::On();
     outlet_in_use_char_ = chr::OutletInUse();
@@ -249,7 +250,7 @@ std::shared_ptr<Service> OutletBuilder::build() {
 //==============================================================================
 
 ThermostatBuilder::ThermostatBuilder() {
-    service_ = std::make_shared<Service>(kType_Thermostat, "Thermostat", true);
+    service_ = make_node<Service>(kType_Thermostat, "Thermostat", true);
     
     current_hc_state_ = chr::CurrentHeatingCoolingStateChar();
     target_hc_state_ = chr::TargetHeatingCoolingStateChar();
@@ -298,7 +299,7 @@ std::shared_ptr<Service> ThermostatBuilder::build() {
 //==============================================================================
 
 TemperatureSensorBuilder::TemperatureSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_TemperatureSensor, "Temperature Sensor", true);
+    service_ = make_node<Service>(kType_TemperatureSensor, "Temperature Sensor", true);
     current_temp_ = chr::CurrentTemperature();
     add_characteristic(current_temp_);
 }
@@ -331,7 +332,7 @@ std::shared_ptr<Service> TemperatureSensorBuilder::build() {
 //==============================================================================
 
 HumiditySensorBuilder::HumiditySensorBuilder() {
-    service_ = std::make_shared<Service>(kType_HumiditySensor, "Humidity Sensor", true);
+    service_ = make_node<Service>(kType_HumiditySensor, "Humidity Sensor", true);
     current_humidity_ = chr::CurrentRelativeHumidity();
     add_characteristic(current_humidity_);
 }
@@ -364,7 +365,7 @@ std::shared_ptr<Service> HumiditySensorBuilder::build() {
 //==============================================================================
 
 MotionSensorBuilder::MotionSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_MotionSensor, "Motion Sensor", true);
+    service_ = make_node<Service>(kType_MotionSensor, "Motion Sensor", true);
     motion_detected_ = chr::MotionDetected();
     add_characteristic(motion_detected_);
 }
@@ -397,7 +398,7 @@ std::shared_ptr<Service> MotionSensorBuilder::build() {
 //==============================================================================
 
 ContactSensorBuilder::ContactSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_ContactSensor, "Contact Sensor", true);
+    service_ = make_node<Service>(kType_ContactSensor, "Contact Sensor", true);
     contact_state_ = chr::ContactSensorStateChar();
     add_characteristic(contact_state_);
 }
@@ -430,7 +431,7 @@ std::shared_ptr<Service> ContactSensorBuilder::build() {
 //==============================================================================
 
 GarageDoorOpenerBuilder::GarageDoorOpenerBuilder() {
-    service_ = std::make_shared<Service>(kType_GarageDoorOpener, "Garage Door Opener", true);
+    service_ = make_node<Service>(kType_GarageDoorOpener, "Garage Door Opener", true);
     
     current_door_state_ = chr::CurrentDoorStateChar();
     target_door_state_ = chr::TargetDoorStateChar();
@@ -466,7 +467,7 @@ std::shared_ptr<Service> GarageDoorOpenerBuilder::build() {
 
 LockMechanismBuilder::LockMechanismBuilder() {
     // Lock Mechanism MUST be a primary service per HAP Spec 11.2.1
-    service_ = std::make_shared<Service>(kType_LockMechanism, "Lock Mechanism", true);
+    service_ = make_node<Service>(kType_LockMechanism, "Lock Mechanism", true);
     
     lock_current_state_ = chr::LockCurrentStateChar();
     lock_target_state_ = chr::LockTargetStateChar();
@@ -500,7 +501,7 @@ std::shared_ptr<Service> LockMechanismBuilder::build() {
 //==============================================================================
 
 NFCAccessBuilder::NFCAccessBuilder() {
-    service_ = std::make_shared<Service>(kType_NFCAccess, "NFC Access");
+    service_ = make_node<Service>(kType_NFCAccess, "NFC Access");
     
     configuration_state_ = chr::ConfigurationState();
     nfc_access_supported_configuration_ = chr::NFCAccessSupportedConfiguration();
@@ -535,7 +536,7 @@ std::shared_ptr<Service> NFCAccessBuilder::build() {
 //==============================================================================
 
 LockManagementBuilder::LockManagementBuilder() {
-    service_ = std::make_shared<Service>(kType_LockManagement, "Lock Management");
+    service_ = make_node<Service>(kType_LockManagement, "Lock Management");
     
     // Required characteristics
     lock_control_point_ = chr::LockControlPoint();
@@ -597,7 +598,7 @@ std::shared_ptr<Service> LockManagementBuilder::build() {
 //==============================================================================
 
 FanBuilder::FanBuilder() {
-    service_ = std::make_shared<Service>(kType_Fan_v2, "Fan", true);
+    service_ = make_node<Service>(kType_Fan_v2, "Fan", true);
     active_char_ = chr::ActiveChar();
     add_characteristic(active_char_);
 }
@@ -651,7 +652,7 @@ std::shared_ptr<Service> FanBuilder::build() {
 //==============================================================================
 
 WindowCoveringBuilder::WindowCoveringBuilder() {
-    service_ = std::make_shared<Service>(kType_WindowCovering, "Window Covering", true);
+    service_ = make_node<Service>(kType_WindowCovering, "Window Covering", true);
     
     current_position_ = chr::CurrentPosition();
     target_position_ = chr::TargetPosition();
@@ -690,7 +691,7 @@ std::shared_ptr<Service> WindowCoveringBuilder::build() {
 //==============================================================================
 
 BatteryServiceBuilder::BatteryServiceBuilder() {
-    service_ = std::make_shared<Service>(kType_BatteryService, "Battery");
+    service_ = make_node<Service>(kType_BatteryService, "Battery");
     
     battery_level_ = chr::BatteryLevel();
     charging_state_ = chr::ChargingStateChar();
@@ -717,7 +718,7 @@ std::shared_ptr<Service> BatteryServiceBuilder::build() {
 //==============================================================================
 
 SecuritySystemBuilder::SecuritySystemBuilder() {
-    service_ = std::make_shared<Service>(kType_SecuritySystem, "Security System", true);
+    service_ = make_node<Service>(kType_SecuritySystem, "Security System", true);
     
     current_state_ = chr::SecuritySystemCurrentStateChar();
     target_state_ = chr::SecuritySystemTargetStateChar();
@@ -734,13 +735,7 @@ SecuritySystemBuilder& SecuritySystemBuilder::with_name(std::string name) {
 }
 
 SecuritySystemBuilder& SecuritySystemBuilder::with_alarm_type() {
-    auto alarm_type = std::make_shared<Characteristic>(
-        chr::kType_SecuritySystemAlarmType, Format::UInt8,
-        std::vector{Permission::PairedRead, Permission::Notify}
-    );
-    alarm_type->set_min_value(0);
-    alarm_type->set_max_value(1);
-    alarm_type->set_value(static_cast<uint8_t>(0));
+    auto alarm_type = chr::SecuritySystemAlarmType();
     add_characteristic(alarm_type);
     return *this;
 }
@@ -760,7 +755,7 @@ std::shared_ptr<Service> SecuritySystemBuilder::build() {
 //==============================================================================
 
 DoorBuilder::DoorBuilder() {
-    service_ = std::make_shared<Service>(kType_Door, "Door", true);
+    service_ = make_node<Service>(kType_Door, "Door", true);
     
     current_position_ = chr::CurrentPosition();
     target_position_ = chr::TargetPosition();
@@ -797,7 +792,7 @@ std::shared_ptr<Service> DoorBuilder::build() {
 //==============================================================================
 
 OccupancySensorBuilder::OccupancySensorBuilder() {
-    service_ = std::make_shared<Service>(kType_OccupancySensor, "Occupancy Sensor", true);
+    service_ = make_node<Service>(kType_OccupancySensor, "Occupancy Sensor", true);
     
     occupancy_detected_ = chr::OccupancyDetected();
     add_characteristic(occupancy_detected_);
@@ -829,7 +824,7 @@ std::shared_ptr<Service> OccupancySensorBuilder::build() {
 //==============================================================================
 
 SmokeSensorBuilder::SmokeSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_SmokeSensor, "Smoke Sensor", true);
+    service_ = make_node<Service>(kType_SmokeSensor, "Smoke Sensor", true);
     
     smoke_detected_ = chr::SmokeDetected();
     add_characteristic(smoke_detected_);
@@ -861,7 +856,7 @@ std::shared_ptr<Service> SmokeSensorBuilder::build() {
 //==============================================================================
 
 LeakSensorBuilder::LeakSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_LeakSensor, "Leak Sensor", true);
+    service_ = make_node<Service>(kType_LeakSensor, "Leak Sensor", true);
     
     leak_detected_ = chr::LeakDetected();
     add_characteristic(leak_detected_);
@@ -893,7 +888,7 @@ std::shared_ptr<Service> LeakSensorBuilder::build() {
 //==============================================================================
 
 LightSensorBuilder::LightSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_LightSensor, "Light Sensor", true);
+    service_ = make_node<Service>(kType_LightSensor, "Light Sensor", true);
     
     current_light_level_ = chr::CurrentAmbientLightLevel();
     add_characteristic(current_light_level_);
@@ -925,7 +920,7 @@ std::shared_ptr<Service> LightSensorBuilder::build() {
 //==============================================================================
 
 CarbonDioxideSensorBuilder::CarbonDioxideSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_CarbonDioxideSensor, "Carbon Dioxide Sensor", true);
+    service_ = make_node<Service>(kType_CarbonDioxideSensor, "Carbon Dioxide Sensor", true);
     
     co2_detected_ = chr::CarbonDioxideDetectedChar();
     add_characteristic(co2_detected_);
@@ -959,7 +954,7 @@ std::shared_ptr<Service> CarbonDioxideSensorBuilder::build() {
 
 DoorbellBuilder::DoorbellBuilder() {
     // Doorbell is the primary service for Video Doorbell Profile per HAP Spec
-    service_ = std::make_shared<Service>(kType_Doorbell, "Doorbell", true);
+    service_ = make_node<Service>(kType_Doorbell, "Doorbell", true);
     
     switch_event_ = chr::ProgrammableSwitchEventChar();
     add_characteristic(switch_event_);
@@ -991,7 +986,7 @@ std::shared_ptr<Service> DoorbellBuilder::build() {
 //==============================================================================
 
 AirPurifierBuilder::AirPurifierBuilder() {
-    service_ = std::make_shared<Service>(kType_AirPurifier, "Air Purifier", true);
+    service_ = make_node<Service>(kType_AirPurifier, "Air Purifier", true);
     
     active_ = chr::ActiveChar();
     current_state_ = chr::CurrentAirPurifierStateChar();
@@ -1033,7 +1028,7 @@ std::shared_ptr<Service> AirPurifierBuilder::build() {
 //==============================================================================
 
 HeaterCoolerBuilder::HeaterCoolerBuilder() {
-    service_ = std::make_shared<Service>(kType_HeaterCooler, "Heater Cooler", true);
+    service_ = make_node<Service>(kType_HeaterCooler, "Heater Cooler", true);
     
     active_ = chr::ActiveChar();
     current_temp_ = chr::CurrentTemperature();
@@ -1082,7 +1077,7 @@ std::shared_ptr<Service> HeaterCoolerBuilder::build() {
 //==============================================================================
 
 HumidifierDehumidifierBuilder::HumidifierDehumidifierBuilder() {
-    service_ = std::make_shared<Service>(kType_HumidifierDehumidifier, "Humidifier Dehumidifier", true);
+    service_ = make_node<Service>(kType_HumidifierDehumidifier, "Humidifier Dehumidifier", true);
     
     active_ = chr::ActiveChar();
     current_humidity_ = chr::CurrentRelativeHumidity();
@@ -1126,7 +1121,7 @@ std::shared_ptr<Service> HumidifierDehumidifierBuilder::build() {
 //==============================================================================
 
 FilterMaintenanceBuilder::FilterMaintenanceBuilder() {
-    service_ = std::make_shared<Service>(kType_FilterMaintenance, "Filter Maintenance");
+    service_ = make_node<Service>(kType_FilterMaintenance, "Filter Maintenance");
     
     filter_change_ = chr::FilterChangeIndication();
     add_characteristic(filter_change_);
@@ -1158,7 +1153,7 @@ std::shared_ptr<Service> FilterMaintenanceBuilder::build() {
 //==============================================================================
 
 SlatBuilder::SlatBuilder() {
-    service_ = std::make_shared<Service>(kType_Slat, "Slat");
+    service_ = make_node<Service>(kType_Slat, "Slat");
     
     current_state_ = chr::CurrentSlatStateChar();
     slat_type_ = chr::SlatTypeChar();
@@ -1194,7 +1189,7 @@ std::shared_ptr<Service> SlatBuilder::build() {
 //==============================================================================
 
 ValveBuilder::ValveBuilder() {
-    service_ = std::make_shared<Service>(kType_Valve, "Valve", true);
+    service_ = make_node<Service>(kType_Valve, "Valve", true);
     
     active_ = chr::ActiveChar();
     in_use_ = chr::InUseChar();
@@ -1232,7 +1227,7 @@ std::shared_ptr<Service> ValveBuilder::build() {
 //==============================================================================
 
 IrrigationSystemBuilder::IrrigationSystemBuilder() {
-    service_ = std::make_shared<Service>(kType_IrrigationSystem, "Irrigation System", true);
+    service_ = make_node<Service>(kType_IrrigationSystem, "Irrigation System", true);
     
     active_ = chr::ActiveChar();
     program_mode_ = chr::ProgramMode();
@@ -1264,7 +1259,7 @@ std::shared_ptr<Service> IrrigationSystemBuilder::build() {
 //==============================================================================
 
 FaucetBuilder::FaucetBuilder() {
-    service_ = std::make_shared<Service>(kType_Faucet, "Faucet", true);
+    service_ = make_node<Service>(kType_Faucet, "Faucet", true);
     
     active_ = chr::ActiveChar();
     add_characteristic(active_);
@@ -1291,7 +1286,7 @@ std::shared_ptr<Service> FaucetBuilder::build() {
 //==============================================================================
 
 ServiceLabelBuilder::ServiceLabelBuilder() {
-    service_ = std::make_shared<Service>(kType_ServiceLabel, "Service Label");
+    service_ = make_node<Service>(kType_ServiceLabel, "Service Label");
     
     namespace_char_ = chr::ServiceLabelNamespaceChar();
     add_characteristic(namespace_char_);
@@ -1306,7 +1301,7 @@ std::shared_ptr<Service> ServiceLabelBuilder::build() {
 //==============================================================================
 
 CarbonMonoxideSensorBuilder::CarbonMonoxideSensorBuilder() {
-    service_ = std::make_shared<Service>(kType_CarbonMonoxideSensor, "Carbon Monoxide Sensor", true);
+    service_ = make_node<Service>(kType_CarbonMonoxideSensor, "Carbon Monoxide Sensor", true);
     
     co_detected_ = chr::CarbonMonoxideDetectedChar();
     add_characteristic(co_detected_);
@@ -1339,7 +1334,7 @@ std::shared_ptr<Service> CarbonMonoxideSensorBuilder::build() {
 //==============================================================================
 
 AirQualitySensorBuilder::AirQualitySensorBuilder() {
-    service_ = std::make_shared<Service>(kType_AirQualitySensor, "Air Quality Sensor", true);
+    service_ = make_node<Service>(kType_AirQualitySensor, "Air Quality Sensor", true);
     
     air_quality_ = chr::AirQualityChar();
     add_characteristic(air_quality_);
@@ -1381,7 +1376,7 @@ std::shared_ptr<Service> AirQualitySensorBuilder::build() {
 //==============================================================================
 
 StatelessProgrammableSwitchBuilder::StatelessProgrammableSwitchBuilder() {
-    service_ = std::make_shared<Service>(kType_StatelessProgrammableSwitch, "Stateless Programmable Switch", true);
+    service_ = make_node<Service>(kType_StatelessProgrammableSwitch, "Stateless Programmable Switch", true);
     
     switch_event_ = chr::ProgrammableSwitchEventChar();
     add_characteristic(switch_event_);
@@ -1410,7 +1405,7 @@ std::shared_ptr<Service> StatelessProgrammableSwitchBuilder::build() {
 //==============================================================================
 
 MicrophoneBuilder::MicrophoneBuilder() {
-    service_ = std::make_shared<Service>(kType_Microphone, "Microphone", true);
+    service_ = make_node<Service>(kType_Microphone, "Microphone", true);
     
     mute_ = chr::Mute();
     add_characteristic(mute_);
@@ -1437,7 +1432,7 @@ std::shared_ptr<Service> MicrophoneBuilder::build() {
 //==============================================================================
 
 SpeakerBuilder::SpeakerBuilder() {
-    service_ = std::make_shared<Service>(kType_Speaker, "Speaker", true);
+    service_ = make_node<Service>(kType_Speaker, "Speaker", true);
     
     mute_ = chr::Mute();
     add_characteristic(mute_);
@@ -0,0 +1,302 @@
+#include "hap/transport/AccessoryEndpoints.hpp"
+#include "hap/core/HAPStatus.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace hap;
+using namespace hap::core;
+using namespace hap::transport;
+
+struct Fixture {
+    mock::MockSystem system;
+    common::TaskScheduler scheduler{&system};
+    AttributeDatabase db;
+    EventDispatcher events;
+    AccessoryEndpoints endpoints{&db, &events};
+    ConnectionContext ctx{nullptr, &system, 7};
+    std::shared_ptr<Characteristic> on;
+    std::shared_ptr<Characteristic> brightness;
+    std::vector<std::pair<uint32_t, Response>> deferred;
+
+    Fixture() {
+        auto acc = std::make_shared<Accessory>(1);
+        auto bulb = std::make_shared<Service>(0x43, "Lightbulb");
+        on = std::make_shared<Characteristic>(0x25, Format::Bool,
+            std::vector{Permission::PairedRead, Permission::PairedWrite, Permission::Notify});
+        brightness = std::make_shared<Characteristic>(0x08, Format::Int,
+            std::vector{Permission::PairedRead, Permission::PairedWrite});
+        bulb->add_characteristic(on);
+        bulb->add_characteristic(brightness);
+        acc->add_service(bulb);
+        assert(db.add_accessory(acc) == ValidationResult::Success);
+        on->set_value(true);
+        brightness->set_value(50);
+
+        endpoints.set_async_support(&scheduler, 1000, [this](uint32_t conn_id, Response response) {
+            deferred.emplace_back(conn_id, std::move(response));
+        });
+    }
+
+    Request get() const {
+        Request req;
+        req.method = Method::GET;
+        req.path = "/characteristics";
+        req.query = "id=1." + std::to_string(on->iid()) + ",1." + std::to_string(brightness->iid());
+        return req;
+    }
+
+    Request put(int32_t value) const {
+        Request req;
+        req.method = Method::PUT;
+        req.path = "/characteristics";
+        std::string body = R"({"characteristics":[{"aid":1,"iid":)" + std::to_string(brightness->iid()) +
+                           R"(,"value":)" + std::to_string(value) + "}]}";
+        req.body.assign(body.begin(), body.end());
+        return req;
+    }
+};
+
+static std::string body_of(const Response& response) {
+    return std::string(response.body.begin(), response.body.end());
+}
+
+void test_async_read_completing_inline() {
+    Fixture f;
+    f.brightness->on_read_async([](ReadCompletion done) { done(Value{int32_t{80}}); });
+
+    auto response = f.endpoints.handle_get_characteristics(f.get(), f.ctx);
+    assert(!response.is_deferred);
+    assert(response.status == Status::OK);
+    assert(body_of(response).find(R"("value":80)") != std::string::npos);
+    assert(f.scheduler.task_count() == 0);
+
+    std::cout << "test_async_read_completing_inline passed" << std::endl;
+}
+
+void test_async_read_deferred() {
+    Fixture f;
+    std::optional<ReadCompletion> pending;
+    f.brightness->on_read_async([&pending](ReadCompletion done) { pending = done; });
+
+    auto response = f.endpoints.handle_get_characteristics(f.get(), f.ctx);
+    assert(response.is_deferred);
+    assert(f.deferred.empty());
+
+    // The stored value changing meanwhile doesn't affect the rendered response
+    f.on->set_value(false);
+    (*pending)(Value{int32_t{30}});
+    assert(f.deferred.size() == 1);
+    assert(f.deferred[0].first == 7);
+    std::string body = body_of(f.deferred[0].second);
+    assert(f.deferred[0].second.status == Status::OK);
+    assert(body.find(R"("value":true)") != std::string::npos);
+    assert(body.find(R"("value":30)") != std::string::npos);
+
+    // The timeout was cancelled and a late second completion is ignored
+    assert(f.scheduler.task_count() == 0);
+    (*pending)(Value{int32_t{31}});
+    assert(f.deferred.size() == 1);
+
+    std::cout << "test_async_read_deferred passed" << std::endl;
+}
+
+void test_async_read_timeout() {
+    Fixture f;
+    std::optional<ReadCompletion> pending;
+    f.brightness->on_read_async([&pending](ReadCompletion done) { pending = done; });
+
+    assert(f.endpoints.handle_get_characteristics(f.get(), f.ctx).is_deferred);
+    f.scheduler.tick(999);
+    assert(f.deferred.empty());
+    f.scheduler.tick(1000);
+    assert(f.deferred.size() == 1);
+    assert(f.deferred[0].second.status == Status::MultiStatus);
+    assert(body_of(f.deferred[0].second).find("-70402") != std::string::npos);
+
+    (*pending)(Value{int32_t{30}});  // Too late
+    assert(f.deferred.size() == 1);
+
+    std::cout << "test_async_read_timeout passed" << std::endl;
+}
+
+void test_async_write() {
+    Fixture f;
+    std::optional<WriteCompletion> pending;
+    Value written;
+    f.brightness->set_async_write_callback([&](const Value& value, WriteCompletion done) {
+        written = value;
+        pending = done;
+    });
+
+    assert(f.endpoints.handle_put_characteristics(f.put(70), f.ctx).is_deferred);
+    assert(std::get<int32_t>(written) == 70);
+    (*pending)(std::nullopt);
+    assert(f.deferred.size() == 1);
+    assert(f.deferred[0].second.status == Status::NoContent);
+
+    // A device error is reported per characteristic
+    f.deferred.clear();
+    assert(f.endpoints.handle_put_characteristics(f.put(10), f.ctx).is_deferred);
+    (*pending)(HAPStatus::ResourceBusy);
+    assert(f.deferred.size() == 1);
+    assert(f.deferred[0].second.status == Status::MultiStatus);
+    assert(body_of(f.deferred[0].second).find("-70403") != std::string::npos);
+
+    std::cout << "test_async_write passed" << std::endl;
+}
+
+void test_sync_write_errors_reported() {
+    Fixture f;
+    f.brightness->set_write_callback([](const Value&) -> WriteResponse { return HAPStatus::ResourceBusy; });
+
+    auto response = f.endpoints.handle_put_characteristics(f.put(10), f.ctx);
+    assert(!response.is_deferred);
+    assert(response.status == Status::MultiStatus);
+    assert(body_of(response).find("-70403") != std::string::npos);
+
+    std::cout << "test_sync_write_errors_reported passed" << std::endl;
+}
+
+void test_read_query_flags() {
+    Fixture f;
+    f.brightness->set_min_value(0);
+    f.brightness->set_max_value(100);
+    f.brightness->set_unit("percentage");
+    f.events.subscribe(7, 1, f.on->iid());
+
+    Request req;
+    req.method = Method::GET;
+    req.path = "/characteristics";
+    req.query = "id=1." + std::to_string(f.on->iid()) + ",1." + std::to_string(f.brightness->iid()) +
+                "&meta=1&perms=1&type=1&ev=1";
+    auto response = f.endpoints.handle_get_characteristics(req, f.ctx);
+    assert(response.status == Status::OK);
+    std::string body = body_of(response);
+    assert(body.find(R"("value":true,"type":"25","perms":["pr","pw","ev"],"ev":true,"format":"bool")") != std::string::npos);
+    assert(body.find(R"("type":"8","perms":["pr","pw"],"ev":false,"format":"int","unit":"percentage","minValue":0,"maxValue":100)") != std::string::npos);
+
+    // Without flags only values are sent
+    response = f.endpoints.handle_get_characteristics(f.get(), f.ctx);
+    assert(body_of(response).find("format") == std::string::npos);
+
+    // Malformed or missing ids are rejected
+    for (const char* query : {"", "meta=1", "id=", "id=1", "id=1.x", "id=1.2,", "id=1.2;1.3"}) {
+        req.query = query;
+        assert(f.endpoints.handle_get_characteristics(req, f.ctx).status == Status::BadRequest);
+    }
+
+    auto parsed = ReadQuery::parse("ev=1&id=1.10,2.20");
+    assert(parsed && parsed->count == 2 && parsed->ev && !parsed->meta);
+    std::vector<std::pair<uint64_t, uint64_t>> ids;
+    parsed->for_each_id([&](uint64_t aid, uint64_t iid) { ids.emplace_back(aid, iid); });
+    assert((ids == std::vector<std::pair<uint64_t, uint64_t>>{{1, 10}, {2, 20}}));
+
+    std::cout << "test_read_query_flags passed" << std::endl;
+}
+
+static Request put_body(const std::string& body) {
+    Request req;
+    req.method = Method::PUT;
+    req.path = "/characteristics";
+    req.body.assign(body.begin(), body.end());
+    return req;
+}
+
+void test_put_decoding() {
+    Fixture f;
+    auto acc = std::make_shared<Accessory>(2);
+    auto svc = std::make_shared<Service>(0x44, "Lock");
+    auto blob = std::make_shared<Characteristic>(0x99, Format::Data,
+        std::vector{Permission::PairedRead, Permission::PairedWrite});
+    svc->add_characteristic(blob);
+    acc->add_service(svc);
+    assert(f.db.add_accessory(acc) == ValidationResult::Success);
+    f.on->set_value(false);
+    std::string on_iid = std::to_string(f.on->iid());
+    std::string brightness_iid = std::to_string(f.brightness->iid());
+    std::string blob_iid = std::to_string(blob->iid());
+
+    // Keys in any order; numbers coerce to bool; base64 (quads plus padded tail) decodes
+    auto response = f.endpoints.handle_put_characteristics(put_body(
+        R"({"characteristics":[{"value":1,"aid":1,"iid":)" + on_iid + R"(},)"
+        R"({"aid":1,"iid":)" + brightness_iid + R"(,"value":true},)"
+        R"({"aid":2,"iid":)" + blob_iid + R"(,"value":"AQIDBAUGBw=="}]})"), f.ctx);
+    assert(response.status == Status::NoContent);
+    assert(f.on->get<bool>() == HAPResponse<bool>(true));
+    assert(f.brightness->get<int32_t>() == HAPResponse<int32_t>(1));
+    assert((std::get<std::vector<uint8_t>>(blob->value()) == std::vector<uint8_t>{1, 2, 3, 4, 5, 6, 7}));
+
+    // Wrong value types fail per characteristic
+    response = f.endpoints.handle_put_characteristics(put_body(
+        R"({"characteristics":[{"aid":1,"iid":)" + brightness_iid + R"(,"value":"x"},)"
+        R"({"aid":1,"iid":)" + on_iid + R"(,"value":{"nested":[1]}},)"
+        R"({"aid":1,"iid":)" + on_iid + R"(,"ev":true}]})"), f.ctx);
+    assert(response.status == Status::MultiStatus);
+    std::string body = body_of(response);
+    assert(body.find(R"("iid":)" + brightness_iid + R"(,"status":-70410)") != std::string::npos);
+    assert(body.find(R"("iid":)" + on_iid + R"(,"status":-70410)") != std::string::npos);
+    assert(f.events.is_subscribed(7, 1, f.on->iid()));
+
+    // Malformed bodies and entries without ids are rejected as a whole
+    for (const char* bad : {R"({"characteristics":[)", R"({"characteristics":{}})", R"([])",
+                            R"({"characteristics":[{"iid":1,"value":1}]})"}) {
+        assert(f.endpoints.handle_put_characteristics(put_body(bad), f.ctx).status == Status::BadRequest);
+    }
+
+    std::cout << "test_put_decoding passed" << std::endl;
+}
+
+void test_batch_write() {
+    Fixture f;
+    auto accessory = f.db.find_accessory(1);
+    assert(accessory);
+    std::vector<std::vector<BatchWrite>> calls;
+    std::optional<WriteCompletion> pending;
+    bool complete_inline = true;
+    accessory->set_batch_write_callback([&](std::span<const BatchWrite> writes, WriteCompletion done) {
+        calls.emplace_back(writes.begin(), writes.end());
+        if (complete_inline) done(std::nullopt);
+        else pending = done;
+    });
+    int single_writes = 0;
+    f.brightness->set_write_callback([&](const Value&) -> WriteResponse { ++single_writes; return std::nullopt; });
+
+    std::string body = R"({"characteristics":[{"aid":1,"iid":)" + std::to_string(f.on->iid()) +
+                       R"(,"value":false},{"aid":1,"iid":)" + std::to_string(f.brightness->iid()) + R"(,"value":20}]})";
+    auto response = f.endpoints.handle_put_characteristics(put_body(body), f.ctx);
+    assert(response.status == Status::NoContent);
+    assert(calls.size() == 1 && calls[0].size() == 2);
+    assert(calls[0][0].characteristic == f.on && calls[0][0].value == Value{false});
+    assert(calls[0][1].value == Value{int32_t{20}});
+    assert(single_writes == 0);
+    assert(f.brightness->get<int32_t>() == HAPResponse<int32_t>(20));
+
+    // One failure answers for the whole batch, after the handler returned
+    complete_inline = false;
+    response = f.endpoints.handle_put_characteristics(put_body(body), f.ctx);
+    assert(response.is_deferred && pending);
+    (*pending)(HAPStatus::ResourceBusy);
+    assert(f.deferred.size() == 1);
+    assert(f.deferred[0].second.status == Status::MultiStatus);
+    std::string deferred_body = body_of(f.deferred[0].second);
+    assert(deferred_body.find("-70403") != deferred_body.rfind("-70403"));
+
+    std::cout << "test_batch_write passed" << std::endl;
+}
+
+int main() {
+    test_async_read_completing_inline();
+    test_async_read_deferred();
+    test_async_read_timeout();
+    test_async_write();
+    test_sync_write_errors_reported();
+    test_read_query_flags();
+    test_put_decoding();
+    test_batch_write();
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "hap/core/AttributeArena.hpp"
+#include "hap/core/AttributeDatabase.hpp"
+#include "hap/core/CharacteristicFinder.hpp"
+#include "hap/types/ServiceTypes.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+using namespace hap::core;
+
+void test_scope_routes_builders() {
+    auto arena = AttributeArena::create();
+    assert(arena->bytes_used() == 0);
+
+    std::shared_ptr<Accessory> accessory;
+    {
+        AttributeArena::Scope scope(*arena);
+        assert(AttributeArena::current() == arena.get());
+        accessory = make_node<Accessory>(1);
+        accessory->add_service(hap::service::LightBulbBuilder().with_brightness().build());
+    }
+    assert(AttributeArena::current() == nullptr);
+    size_t used = arena->bytes_used();
+    assert(used > 0);
+
+    // Service and its characteristics were carved from the same block
+    const auto& service = accessory->services()[0];
+    auto a = reinterpret_cast<uintptr_t>(service.get());
+    auto b = reinterpret_cast<uintptr_t>(service->characteristics().back().get());
+    assert(static_cast<size_t>(std::llabs(static_cast<long long>(a - b))) < used);
+
+    // Outside a scope nodes come from the heap
+    auto loose = make_node<Service>(0x43, "Loose");
+    assert(arena->bytes_used() == used);
+
+    std::cout << "test_scope_routes_builders passed" << std::endl;
+}
+
+void test_nodes_keep_arena_alive() {
+    std::weak_ptr<AttributeArena> weak;
+    std::shared_ptr<Characteristic> survivor;
+    {
+        auto arena = AttributeArena::create();
+        weak = arena;
+        AttributeArena::Scope scope(*arena);
+        survivor = hap::service::SwitchBuilder().build()->characteristics()[0];
+    }
+    assert(!weak.expired());
+    survivor->set_value(true);
+    assert(std::get<bool>(survivor->value()));
+
+    survivor.reset();
+    assert(weak.expired());
+
+    std::cout << "test_nodes_keep_arena_alive passed" << std::endl;
+}
+
+void test_nested_scopes() {
+    auto outer = AttributeArena::create();
+    auto inner = AttributeArena::create();
+    {
+        AttributeArena::Scope a(*outer);
+        {
+            AttributeArena::Scope b(*inner);
+            assert(AttributeArena::current() == inner.get());
+        }
+        assert(AttributeArena::current() == outer.get());
+    }
+    assert(AttributeArena::current() == nullptr);
+
+    std::cout << "test_nested_scopes passed" << std::endl;
+}
+
+void test_database_lookup() {
+    auto arena = AttributeArena::create();
+    AttributeDatabase db;
+    {
+        AttributeArena::Scope scope(*arena);
+        auto accessory = make_node<Accessory>(1);
+        accessory->add_service(hap::service::LightBulbBuilder().with_brightness().build());
+        assert(db.add_accessory(accessory) == ValidationResult::Success);
+    }
+
+    CharacteristicFinder finder(db);
+    const auto& on = db.accessories()[0]->services()[0]->characteristics()[0];
+    const auto* info = finder.lookup(static_cast<uint16_t>(on->iid()));
+    assert(info && info->characteristic.get() == on.get() && info->accessory_id == 1);
+    assert(!finder.lookup(0xFFFF));
+    assert(db.to_cached_json_string() == db.to_json_string());
+
+    std::cout << "test_database_lookup passed" << std::endl;
+}
+
+int main() {
+    test_scope_routes_builders();
+    test_nodes_keep_arena_alive();
+    test_nested_scopes();
+    test_database_lookup();
+    std::cout << "All AttributeArena tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "hap/core/AttributeDatabase.hpp"
+#include "hap/core/CharacteristicFinder.hpp"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace hap::core;
+
+static std::shared_ptr<Accessory> make_light(uint64_t aid) {
+    auto acc = std::make_shared<Accessory>(aid);
+    auto info = std::make_shared<Service>(0x3E, "AccessoryInformation");
+    info->add_characteristic(std::make_shared<Characteristic>(0x23, Format::String, std::vector{Permission::PairedRead}));
+    acc->add_service(info);
+
+    auto bulb = std::make_shared<Service>(0x43, "Lightbulb");
+    bulb->add_characteristic(std::make_shared<Characteristic>(0x25, Format::Bool,
+        std::vector{Permission::PairedRead, Permission::PairedWrite, Permission::Notify}));
+    bulb->add_characteristic(std::make_shared<Characteristic>(0x08, Format::Int,
+        std::vector{Permission::PairedRead, Permission::PairedWrite}));
+    acc->add_service(bulb);
+    return acc;
+}
+
+void test_index_matches_tree() {
+    AttributeDatabase db;
+    // Add out of AID order to exercise the sorted merge
+    for (uint64_t aid : {3, 1, 2}) {
+        assert(db.add_accessory(make_light(aid)) == ValidationResult::Success);
+    }
+
+    const auto& index = db.characteristic_index();
+    assert(index.size() == 9);
+    for (size_t i = 1; i < index.size(); ++i) {
+        assert(index[i - 1].key < index[i].key);
+    }
+
+    for (const auto& acc : db.accessories()) {
+        for (const auto& svc : acc->services()) {
+            for (const auto& ch : svc->characteristics()) {
+                assert(db.find_characteristic(acc->aid(), ch->iid()) == ch);
+                auto* entry = db.find_entry(acc->aid(), ch->iid());
+                assert(entry && entry->service == svc);
+            }
+        }
+    }
+
+    std::cout << "test_index_matches_tree passed" << std::endl;
+}
+
+void test_index_misses() {
+    AttributeDatabase db;
+    db.add_accessory(make_light(1));
+
+    auto svc = db.accessories()[0]->services()[0];
+    // Service IIDs and unknown AIDs must not resolve to a characteristic
+    assert(db.find_characteristic(1, svc->iid()) == nullptr);
+    assert(db.find_characteristic(2, 2) == nullptr);
+    assert(db.find_characteristic(1, 999) == nullptr);
+
+    CharacteristicFinder finder(db);
+    auto ch = svc->characteristics()[0];
+    assert(finder.by_aid_iid(1, ch->iid()) == ch);
+    assert(finder.by_aid_iid(7, ch->iid()) == nullptr);
+
+    std::cout << "test_index_misses passed" << std::endl;
+}
+
+void test_finder_tables() {
+    AttributeDatabase db;
+    db.add_accessory(make_light(1));
+
+    CharacteristicFinder finder(db);
+    for (const auto& svc : db.accessories()[0]->services()) {
+        assert(finder.service_by_iid(svc->iid()) == svc);
+        for (const auto& ch : svc->characteristics()) {
+            auto info = finder.find_info(ch->iid());
+            assert(info.characteristic == ch);
+            assert(info.service == svc);
+            assert(info.accessory_id == 1);
+            assert(finder.by_iid(ch->iid()) == ch);
+            assert(finder.service_containing(ch->iid()) == svc);
+        }
+    }
+    assert(finder.by_iid(999) == nullptr);
+    assert(!finder.find_info(999).characteristic);
+
+    // Tables are snapshots; rebuild picks up accessories added later
+    db.add_accessory(make_light(2));
+    auto added = db.accessories()[1]->services()[1];
+    assert(finder.service_by_iid(added->iid()) == nullptr);
+    finder.rebuild();
+    assert(finder.service_by_iid(added->iid()) == added);
+
+    std::cout << "test_finder_tables passed" << std::endl;
+}
+
+void test_add_accessories_batch() {
+    AttributeDatabase db;
+    assert(db.add_accessory(make_light(1)) == ValidationResult::Success);
+
+    // A duplicate inside the batch rejects the whole batch
+    std::vector<std::shared_ptr<Accessory>> bad = {make_light(4), make_light(5), make_light(4)};
+    assert(db.add_accessories(bad) == ValidationResult::DuplicateAccessoryId);
+    std::vector<std::shared_ptr<Accessory>> clash = {make_light(6), make_light(1)};
+    assert(db.add_accessories(clash) == ValidationResult::DuplicateAccessoryId);
+    assert(db.accessories().size() == 1);
+    assert(db.characteristic_index().size() == 3);
+
+    std::vector<std::shared_ptr<Accessory>> batch;
+    for (uint64_t aid = 10; aid > 2; --aid) {
+        batch.push_back(make_light(aid));
+    }
+    assert(db.add_accessories(batch) == ValidationResult::Success);
+    assert(db.accessories().size() == 9);
+
+    const auto& index = db.characteristic_index();
+    assert(index.size() == 27);
+    for (size_t i = 1; i < index.size(); ++i) {
+        assert(index[i - 1].key < index[i].key);
+    }
+    for (const auto& acc : batch) {
+        assert(db.find_characteristic(acc->aid(), acc->services()[1]->characteristics()[0]->iid()));
+    }
+
+    // Bridge limit counts the accessories earlier in the same batch
+    std::vector<std::shared_ptr<Accessory>> overflow;
+    for (uint64_t aid = 100; aid < 100 + HAPValidation::kMaxAccessoriesPerBridge; ++aid) {
+        overflow.push_back(make_light(aid));
+    }
+    assert(db.add_accessories(overflow) == ValidationResult::TooManyAccessories);
+    assert(db.accessories().size() == 9);
+
+    std::cout << "test_add_accessories_batch passed" << std::endl;
+}
+
+void test_structure_hash() {
+    AttributeDatabase a, b;
+    a.add_accessory(make_light(1));
+    b.add_accessory(make_light(1));
+    assert(a.structure_hash() == b.structure_hash());
+
+    // Adding an accessory changes the structure
+    uint64_t before = a.structure_hash();
+    a.add_accessory(make_light(2));
+    assert(a.structure_hash() != before);
+
+    // So do metadata-only changes such as permissions or flags
+    AttributeDatabase c;
+    auto light = make_light(1);
+    light->services()[1]->set_hidden(true);
+    c.add_accessory(light);
+    assert(c.structure_hash() != b.structure_hash());
+
+    // Values are not part of the structure
+    before = b.structure_hash();
+    b.accessories()[0]->services()[1]->characteristics()[0]->set_value(true);
+    assert(b.structure_hash() == before);
+
+    std::cout << "test_structure_hash passed" << std::endl;
+}
+
+void test_remove_accessory() {
+    AttributeDatabase db;
+    for (uint64_t aid : {1, 2, 3}) {
+        db.add_accessory(make_light(aid));
+    }
+    auto on_2 = db.accessories()[1]->services()[1]->characteristics()[0];
+    uint64_t before = db.structure_hash();
+
+    auto removed = db.remove_accessory(2);
+    assert(removed && removed->aid() == 2);
+    assert(!db.remove_accessory(2));
+    assert(db.accessories().size() == 2);
+    assert(db.characteristic_index().size() == 6);
+    assert(!db.find_characteristic(2, on_2->iid()));
+    assert(db.find_characteristic(3, db.accessories()[1]->services()[1]->characteristics()[0]->iid()));
+    assert(db.structure_hash() != before);
+
+    // The AID can be reused once it is gone
+    assert(db.add_accessory(make_light(2)) == ValidationResult::Success);
+
+    std::cout << "test_remove_accessory passed" << std::endl;
+}
+
+int main() {
+    test_index_matches_tree();
+    test_index_misses();
+    test_finder_tables();
+    test_add_accessories_batch();
+    test_structure_hash();
+    test_remove_accessory();
+    return 0;
+}
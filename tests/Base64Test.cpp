@@ -0,0 +1,57 @@
+#include "hap/common/Base64.hpp"
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace hap::common;
+
+static std::vector<uint8_t> bytes(std::string_view s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+void test_known_vectors() {
+    // RFC 4648 section 10
+    const std::pair<const char*, const char*> vectors[] = {
+        {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"},
+        {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"},
+    };
+    for (const auto& [plain, encoded] : vectors) {
+        assert(base64_encode(bytes(plain)) == encoded);
+        assert(base64_decode(encoded) == bytes(plain));
+    }
+    // Line breaks and stray characters are skipped; decoding stops at padding
+    assert(base64_decode("Zm9v\r\nYmFy") == bytes("foobar"));
+    assert(base64_decode("Zm9vYmFyZm9vYmFy\nZm9vYmFyZm9vYmFy") == bytes("foobarfoobarfoobarfoobar"));
+    assert(base64_decode("Zg==Zm9v") == bytes("f"));
+
+    std::cout << "test_known_vectors passed" << std::endl;
+}
+
+void test_matches_scalar() {
+    // Sizes around the 12-byte / 16-char SIMD blocks and the scalar tail
+    std::mt19937 rng(42);
+    for (size_t size = 0; size < 300; ++size) {
+        std::vector<uint8_t> data(size);
+        for (auto& b : data) b = static_cast<uint8_t>(rng());
+
+        std::string encoded = base64_encode(data);
+        std::string reference(base64_encoded_size(size), '\0');
+        detail::base64_encode_scalar(data.data(), size, reference.data());
+        assert(encoded == reference);
+
+        assert(base64_decode(encoded) == data);
+        std::vector<uint8_t> scalar(size + 4);
+        scalar.resize(detail::base64_decode_scalar(encoded.data(), encoded.size(), scalar.data()));
+        assert(scalar == data);
+    }
+
+    std::cout << "test_matches_scalar passed" << std::endl;
+}
+
+int main() {
+    test_known_vectors();
+    test_matches_scalar();
+    return 0;
+}
@@ -1,8 +1,12 @@
 #include "hap/transport/BleTransport.hpp"
+#include "hap/common/TaskScheduler.hpp"
 #include <iostream>
 #include <vector>
 #include <cassert>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 using namespace hap;
 using namespace hap::transport;
@@ -10,7 +14,7 @@ using namespace hap::transport;
 // --- MOCK DEFINITIONS for Linker ---
 namespace hap::transport {
 
-PairingEndpoints::PairingEndpoints(Config config) : config_(config) {}
+PairingEndpoints::PairingEndpoints(Config config) : config_(config), session_cache_(config_.system) {}
 
 Response PairingEndpoints::handle_pair_setup(const Request& req, ConnectionContext& ctx) {
     Response resp{Status::OK};
@@ -69,24 +73,43 @@ public:
     }
     
     void start_advertising(const hap::platform::Ble::Advertisement& adv, uint32_t interval_ms) override {
-        // Capture adv data if needed
-        (void)adv; (void)interval_ms;
+        (void)interval_ms;
+        last_advertisement = adv;
+        ++advertising_starts;
     }
+    platform::Ble::Advertisement last_advertisement;
+    int advertising_starts = 0;
     
     void stop_advertising() override {}
     void start() override {}
     
     bool send_indication(uint16_t connection_id, const std::string& char_uuid, std::span<const uint8_t> data) override {
+        if (indication_room == 0) return false;
+        --indication_room;
         sent_notifications.push_back({connection_id, char_uuid, std::vector<uint8_t>(data.begin(), data.end())});
         return true;
     }
+    size_t indication_room = SIZE_MAX;  // Indications the stack accepts before refusing
     
-    void disconnect(uint16_t connection_id) override { (void)connection_id; }
+    bool set_indication_confirm_callback(IndicationConfirmCallback callback) override {
+        confirm_callback = callback;
+        return report_confirmations;
+    }
+    IndicationConfirmCallback confirm_callback;
+    bool report_confirmations = false;
+    
+    void disconnect(uint16_t connection_id) override { disconnected.push_back(connection_id); }
+    std::vector<uint16_t> disconnected;
     
     void set_disconnect_callback(DisconnectCallback callback) override { 
         disconnect_callback_ = callback;
     }
     
+    void set_mtu_callback(MtuCallback callback) override {
+        mtu_callback = callback;
+    }
+    MtuCallback mtu_callback;
+    
     void start_timed_advertising(const Advertisement& data,
                                   uint32_t fast_interval_ms,
                                   uint32_t fast_duration_ms,
@@ -186,12 +209,22 @@ public:
         (void)level;
         std::cout << "[LOG] " << message << std::endl;
     }
-    uint64_t millis() override { return 0; }
+    uint64_t millis() override { return now_ms; }
+    uint64_t now_ms = 0;
     void random_bytes(std::span<uint8_t> buffer) override {
         std::fill(buffer.begin(), buffer.end(), 0x00);
     }
 };
 
+// Read the little-endian Characteristic Instance ID descriptor of a GATT characteristic
+static std::vector<uint8_t> read_char_iid(const platform::Ble::CharacteristicDefinition& def) {
+    const std::string kCharIidDescUUID = "DC46F0FE-81D2-4616-B5D9-6ABDD796939A";
+    for (const auto& desc : def.descriptors) {
+        if (desc.uuid == kCharIidDescUUID && desc.on_read) return desc.on_read(1);
+    }
+    return {};
+}
+
 void run_advertising_test() {
     std::cout << "Running Advertising Test..." << std::endl;
     uint8_t status = 0x01; // Unpaired
@@ -244,7 +277,6 @@ void run_reassembly_test() {
     core::AttributeDatabase db;
     PairingEndpoints::Config pe_config;
     pe_config.crypto = &crypto;
-    pe_config.storage = &storage;
     pe_config.system = &system;
     pe_config.accessory_id = "11:22:33:44:55:66";
     pe_config.setup_code = "123-45-678";
@@ -342,7 +374,6 @@ void run_service_signature_test() {
     core::AttributeDatabase db; 
     PairingEndpoints::Config pe_config;
     pe_config.crypto = &crypto;
-    pe_config.storage = &storage;
     pe_config.system = &system;
     pe_config.accessory_id = "ID";
     pe_config.setup_code = "Code";
@@ -372,24 +403,41 @@ void run_service_signature_test() {
     }
     ASSERT_TRUE(char_def != nullptr);
 
-    // Send Opcode 1 (Char Sig Read) TID=2 IID=01A0 (A001)
-    std::vector<uint8_t> pdu = {0x00, 0x01, 0x02, 0x01, 0xA0};
+    // Instance IDs are assigned at registration time; discover them the way a
+    // controller would, via the Instance ID descriptor / characteristic.
+    const std::string kSvcIidCharUUID = "E604E95D-A759-4817-87D3-AA005083A0D1";
+    std::vector<uint8_t> char_iid_le = read_char_iid(*char_def);
+    std::vector<uint8_t> svc_iid_le;
+    for (auto& svc : ble.registered_services) {
+        for (auto& ch : svc.characteristics) {
+            if (ch.uuid == kPairSetupUUID) {
+                for (auto& sibling : svc.characteristics) {
+                    if (sibling.uuid == kSvcIidCharUUID && sibling.on_read) svc_iid_le = sibling.on_read(1);
+                }
+            }
+        }
+    }
+    ASSERT_EQ(char_iid_le.size(), 2u);
+    ASSERT_EQ(svc_iid_le.size(), 2u);
+
+    // Send Opcode 1 (Char Sig Read) TID=2 IID=<Pair Setup IID>
+    std::vector<uint8_t> pdu = {0x00, 0x01, 0x02, char_iid_le[0], char_iid_le[1]};
     char_def->on_write(1, pdu, false);
 
-    // Expected response for Pair Setup (IID 40961)
+    // Expected response for Pair Setup
     // Ctrl(0x02) TID(02) Status(00) Len(0035 - 53 bytes)
     // 04 10 915276BB2600008000100000 4C 00 00 00 (Type 4C)
-    // 07 02 00A0 (Svc ID A000)
+    // 07 02 <Svc IID>
     // 06 10 915276BB2600008000100000 55 00 00 00 (Svc Type 55)
-    // 0A 02 0200 (Properties: Write Only = 0x0002)
+    // 0A 02 0300 (Properties: Read | Write = 0x0003)
     // 0C 07 1B 00 0027 01 0000 (Format Data, Unit Unitless)
     
     std::vector<uint8_t> expected_response = {
         0x02, 0x02, 0x00, 0x35, 0x00, // CF=0x02 (Response), TID=0x02, Status=0x00, Len=0x0035
         0x04, 0x10, 0x91, 0x52, 0x76, 0xBB, 0x26, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x4C, 0x00, 0x00, 0x00,
-        0x07, 0x02, 0x00, 0xA0,
+        0x07, 0x02, svc_iid_le[0], svc_iid_le[1],
         0x06, 0x10, 0x91, 0x52, 0x76, 0xBB, 0x26, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x55, 0x00, 0x00, 0x00,
-        0x0A, 0x02, 0x02, 0x00, // Properties: 0x0002
+        0x0A, 0x02, 0x03, 0x00, // Properties: 0x0003
         0x0C, 0x07, 0x1B, 0x00, 0x00, 0x27, 0x01, 0x00, 0x00
     };
 
@@ -424,6 +472,316 @@ void run_service_signature_test() {
     std::cout << "Characteristic Signature Test Passed." << std::endl;
 }
 
+void run_mtu_fragmentation_test() {
+    std::cout << "Running MTU Fragmentation Test..." << std::endl;
+    MockBle ble; MockCrypto crypto; MockStorage storage; MockSystem system;
+    core::AttributeDatabase db;
+    PairingEndpoints::Config pe_config;
+    pe_config.crypto = &crypto;
+    pe_config.system = &system;
+    pe_config.accessory_id = "ID";
+    pe_config.setup_code = "Code";
+    PairingEndpoints pe(pe_config);
+    
+    BleTransport::Config config;
+    config.ble = &ble;
+    config.crypto = &crypto;
+    config.database = &db;
+    config.pairing_endpoints = &pe;
+    config.system = &system;
+    config.storage = &storage;
+    config.accessory_id = "ID";
+    config.device_name = "Dev";
+    
+    transport::BleTransport transport(config);
+    transport.start();
+    ASSERT_TRUE(ble.mtu_callback != nullptr);
+    
+    const std::string kPairSetupUUID = "0000004C-0000-1000-8000-0026BB765291";
+    platform::Ble::CharacteristicDefinition* char_def = nullptr;
+    for (auto& svc : ble.registered_services) {
+        for (auto& ch : svc.characteristics) {
+            if (ch.uuid == kPairSetupUUID) { char_def = &ch; break; }
+        }
+    }
+    ASSERT_TRUE(char_def != nullptr);
+    std::vector<uint8_t> char_iid_le = read_char_iid(*char_def);
+    
+    // Unfragmented reference response
+    std::vector<uint8_t> pdu = {0x00, 0x01, 0x02, char_iid_le[0], char_iid_le[1]};
+    char_def->on_write(1, pdu, false);
+    std::vector<uint8_t> whole = char_def->on_read(1);
+    ASSERT_EQ(whole.size(), 5u + 0x35u);
+    
+    // ATT MTU 23 leaves 20 bytes per fragment
+    ble.mtu_callback(1, 23);
+    pdu[2] = 0x03;
+    char_def->on_write(1, pdu, false);
+    
+    std::vector<uint8_t> body;
+    auto first = char_def->on_read(1);
+    ASSERT_EQ(first.size(), 20u);
+    ASSERT_EQ((int)first[0], 0x02);
+    ASSERT_EQ((int)first[1], 0x03);
+    body.insert(body.end(), first.begin() + 5, first.end());
+    
+    size_t reads = 1;
+    while (body.size() < 0x35u) {
+        auto next = char_def->on_read(1);
+        ASSERT_TRUE(next.size() <= 20u && next.size() > 2u);
+        ASSERT_EQ((int)next[0], 0x82);
+        ASSERT_EQ((int)next[1], 0x03);
+        body.insert(body.end(), next.begin() + 2, next.end());
+        ++reads;
+    }
+    ASSERT_EQ(reads, 4u);  // 15 + 18 + 18 + 2 body bytes
+    ASSERT_TRUE(std::equal(body.begin(), body.end(), whole.begin() + 5, whole.end()));
+    
+    // Reading past the end repeats the last fragment
+    auto again = char_def->on_read(1);
+    ASSERT_EQ(again.size(), 4u);
+    
+    std::cout << "MTU Fragmentation Test Passed." << std::endl;
+}
+
+void run_advertising_debounce_test() {
+    std::cout << "Running Advertising Debounce Test..." << std::endl;
+    MockBle ble; MockCrypto crypto; MockStorage storage; MockSystem system;
+    core::AttributeDatabase db;
+    common::TaskScheduler scheduler(&system);
+    PairingEndpoints::Config pe_config;
+    pe_config.crypto = &crypto;
+    pe_config.system = &system;
+    pe_config.accessory_id = "11:22:33:44:55:66";
+    pe_config.setup_code = "Code";
+    PairingEndpoints pe(pe_config);
+    
+    BleTransport::Config config;
+    config.ble = &ble;
+    config.crypto = &crypto;
+    config.database = &db;
+    config.pairing_endpoints = &pe;
+    config.system = &system;
+    config.storage = &storage;
+    config.scheduler = &scheduler;
+    config.accessory_id = "11:22:33:44:55:66";
+    config.device_name = "Dev";
+    
+    transport::BleTransport transport(config);
+    transport.start();
+    ASSERT_EQ(ble.advertising_starts, 1);  // Advertising is up right away at start
+    
+    // A burst of refreshes is coalesced and, with nothing changed, never restarts the radio
+    transport.update_advertising();
+    transport.update_advertising();
+    transport.update_advertising();
+    ASSERT_EQ(ble.advertising_starts, 1);
+    scheduler.tick(1000);
+    ASSERT_EQ(ble.advertising_starts, 1);
+    
+    // A changed payload restarts it once
+    transport.set_accessory_id("AA:BB:CC:DD:EE:FF");
+    transport.update_advertising();
+    transport.update_advertising();
+    scheduler.tick(2000);
+    ASSERT_EQ(ble.advertising_starts, 2);
+    ASSERT_EQ((int)ble.last_advertisement.manufacturer_data[3], 0xAA);
+    
+    std::cout << "Advertising Debounce Test Passed." << std::endl;
+}
+
+void run_concurrent_connections_test() {
+    std::cout << "Running Concurrent Connections Test..." << std::endl;
+    MockBle ble; MockCrypto crypto; MockStorage storage; MockSystem system;
+    core::AttributeDatabase db;
+    common::TaskScheduler scheduler(&system);
+    PairingEndpoints::Config pe_config;
+    pe_config.crypto = &crypto;
+    pe_config.system = &system;
+    pe_config.accessory_id = "ID";
+    pe_config.setup_code = "Code";
+    PairingEndpoints pe(pe_config);
+    
+    BleTransport::Config config;
+    config.ble = &ble;
+    config.crypto = &crypto;
+    config.database = &db;
+    config.pairing_endpoints = &pe;
+    config.system = &system;
+    config.storage = &storage;
+    config.scheduler = &scheduler;
+    config.accessory_id = "ID";
+    config.device_name = "Dev";
+    
+    transport::BleTransport transport(config);
+    transport.start();
+    
+    platform::Ble::CharacteristicDefinition* char_def = nullptr;
+    for (auto& svc : ble.registered_services) {
+        for (auto& ch : svc.characteristics) {
+            if (ch.uuid == "0000004C-0000-1000-8000-0026BB765291") { char_def = &ch; break; }
+        }
+    }
+    ASSERT_TRUE(char_def != nullptr);
+    std::vector<uint8_t> iid = read_char_iid(*char_def);
+    ASSERT_EQ(iid.size(), 2u);
+    
+    auto signature_read = [&](uint16_t conn_id, uint8_t tid) {
+        std::vector<uint8_t> pdu = {0x00, 0x01, tid, iid[0], iid[1]};
+        char_def->on_write(conn_id, pdu, false);
+    };
+    
+    // Two controllers each leave a request queued
+    signature_read(1, 0x05);
+    signature_read(2, 0x06);
+    
+    // A read ahead of the scheduler is still answered, with its own connection's TID
+    auto second = char_def->on_read(2);
+    ASSERT_TRUE(second.size() > 2);
+    ASSERT_EQ(second[1], 0x06);
+    
+    // The scheduler drains the rest
+    scheduler.tick(10);
+    auto first = char_def->on_read(1);
+    ASSERT_TRUE(first.size() > 2);
+    ASSERT_EQ(first[1], 0x05);
+    ASSERT_TRUE(std::equal(first.begin() + 2, first.end(), second.begin() + 2, second.end()));
+    
+    // A new request behind an unread one does not get mixed into it
+    signature_read(1, 0x07);
+    signature_read(1, 0x08);
+    scheduler.tick(20);
+    auto latest = char_def->on_read(1);
+    ASSERT_TRUE(latest.size() > 2);
+    ASSERT_EQ(latest[1], 0x08);
+    ASSERT_EQ(latest.size(), first.size());
+    
+    std::cout << "Concurrent Connections Test Passed." << std::endl;
+}
+
+void run_threaded_transactions_test() {
+    std::cout << "Running Threaded Transactions Test..." << std::endl;
+    MockBle ble; MockCrypto crypto; MockStorage storage; MockSystem system;
+    core::AttributeDatabase db;
+    common::TaskScheduler scheduler(&system);
+    PairingEndpoints::Config pe_config;
+    pe_config.crypto = &crypto;
+    pe_config.system = &system;
+    pe_config.accessory_id = "ID";
+    pe_config.setup_code = "Code";
+    PairingEndpoints pe(pe_config);
+    
+    BleTransport::Config config;
+    config.ble = &ble;
+    config.crypto = &crypto;
+    config.database = &db;
+    config.pairing_endpoints = &pe;
+    config.system = &system;
+    config.storage = &storage;
+    config.scheduler = &scheduler;
+    config.accessory_id = "ID";
+    config.device_name = "Dev";
+    
+    transport::BleTransport transport(config);
+    transport.start();
+    
+    platform::Ble::CharacteristicDefinition* char_def = nullptr;
+    for (auto& svc : ble.registered_services) {
+        for (auto& ch : svc.characteristics) {
+            if (ch.uuid == "0000004C-0000-1000-8000-0026BB765291") { char_def = &ch; break; }
+        }
+    }
+    ASSERT_TRUE(char_def != nullptr);
+    std::vector<uint8_t> iid = read_char_iid(*char_def);
+    ASSERT_EQ(iid.size(), 2u);
+    
+    // GATT callbacks on the BLE stack's thread, the scheduler on the
+    // application's: every read still gets its own write's response
+    std::atomic<bool> done{false};
+    std::thread ticker([&]() {
+        uint64_t now = 1;
+        while (!done) scheduler.tick(now++);
+    });
+    for (int i = 0; i < 500; ++i) {
+        uint8_t tid = static_cast<uint8_t>(i);
+        std::vector<uint8_t> pdu = {0x00, 0x01, tid, iid[0], iid[1]};
+        char_def->on_write(1, pdu, false);
+        auto response = char_def->on_read(1);
+        ASSERT_TRUE(response.size() > 2);
+        ASSERT_EQ(response[1], tid);
+    }
+    done = true;
+    ticker.join();
+    
+    std::cout << "Threaded Transactions Test Passed." << std::endl;
+}
+
+void run_session_timeout_test() {
+    std::cout << "Running Session Timeout Test..." << std::endl;
+    MockBle ble; MockCrypto crypto; MockStorage storage; MockSystem system;
+    core::AttributeDatabase db;
+    common::TaskScheduler scheduler(&system);
+    PairingEndpoints::Config pe_config;
+    pe_config.crypto = &crypto;
+    pe_config.system = &system;
+    pe_config.accessory_id = "ID";
+    pe_config.setup_code = "Code";
+    PairingEndpoints pe(pe_config);
+    
+    BleTransport::Config config;
+    config.ble = &ble;
+    config.crypto = &crypto;
+    config.database = &db;
+    config.pairing_endpoints = &pe;
+    config.system = &system;
+    config.storage = &storage;
+    config.scheduler = &scheduler;
+    config.accessory_id = "ID";
+    config.device_name = "Dev";
+    
+    transport::BleTransport transport(config);
+    transport.start();
+    
+    platform::Ble::CharacteristicDefinition* char_def = nullptr;
+    for (auto& svc : ble.registered_services) {
+        for (auto& ch : svc.characteristics) {
+            if (ch.uuid == "0000004C-0000-1000-8000-0026BB765291") { char_def = &ch; break; }
+        }
+    }
+    ASSERT_TRUE(char_def != nullptr);
+    std::vector<uint8_t> iid = read_char_iid(*char_def);
+    std::vector<uint8_t> pdu = {0x00, 0x01, 0x01, iid[0], iid[1]};
+    
+    // A finished procedure leaves only the 30 s idle deadline
+    char_def->on_write(1, pdu, false);
+    ASSERT_TRUE(!char_def->on_read(1).empty());
+    
+    // The timer armed for the procedure deadline fires and re-arms for the idle one
+    system.now_ms = 10001;
+    scheduler.tick(system.now_ms);
+    ASSERT_TRUE(ble.disconnected.empty());
+    
+    // Activity pushes the deadline out without disconnecting
+    system.now_ms = 20000;
+    char_def->on_write(1, pdu, false);
+    ASSERT_TRUE(!char_def->on_read(1).empty());
+    system.now_ms = 30001;
+    scheduler.tick(system.now_ms);
+    ASSERT_TRUE(ble.disconnected.empty());
+    
+    // Expiry lands on the deadline itself, not a polling interval later
+    auto next = scheduler.next_deadline_ms();
+    ASSERT_TRUE(next.has_value());
+    ASSERT_EQ(*next, 50001u);
+    system.now_ms = 50001;
+    scheduler.tick(system.now_ms);
+    ASSERT_EQ(ble.disconnected.size(), 1u);
+    ASSERT_EQ(ble.disconnected[0], 1);
+    ASSERT_EQ(scheduler.task_count(), 0u);
+    
+    std::cout << "Session Timeout Test Passed." << std::endl;
+}
+
 void run_write_with_response_test() {
     MockBle ble;
     MockCrypto crypto;
@@ -467,7 +825,7 @@ void run_write_with_response_test() {
     std::cout << "Running Write-with-Response Test..." << std::endl;
 
     // 1. Send Write Request (Pair Setup)
-    // HAP-PDU: Control(00) | Opcode(02 Write) | TID(03) | ID(0xA001) | Len(...) | Body...
+    // HAP-PDU: Control(00) | Opcode(02 Write) | TID(03) | IID | Len(...) | Body...
     // Body: TLV 0x01 (Value) + TLV 0x09 (Return-Response)
     
     // TLV 0x01: Value = 0xAA (Dummy Request)
@@ -495,8 +853,10 @@ void run_write_with_response_test() {
     full_pdu.push_back(0x00); // CF
     full_pdu.push_back(0x02); // Opcode Write
     full_pdu.push_back(0x03); // TID
-    full_pdu.push_back(0x01); // IID L
-    full_pdu.push_back(0xA0); // IID H
+    std::vector<uint8_t> char_iid_le = read_char_iid(*pair_setup_def);
+    ASSERT_EQ(char_iid_le.size(), 2u);
+    full_pdu.push_back(char_iid_le[0]); // IID L
+    full_pdu.push_back(char_iid_le[1]); // IID H
     
     uint16_t len = pdu_body.size();
     full_pdu.push_back(len & 0xFF);
@@ -543,10 +903,163 @@ void run_write_with_response_test() {
     std::cout << "Write-with-Response Test Passed." << std::endl;
 }
 
+void run_deferred_registration_test() {
+    std::cout << "Running Deferred Registration Test..." << std::endl;
+    MockBle ble; MockCrypto crypto; MockStorage storage; MockSystem system;
+    core::AttributeDatabase db;
+    auto accessory = std::make_shared<core::Accessory>(1);
+    auto info = std::make_shared<core::Service>(0x3E, "Accessory Information");
+    info->add_characteristic(std::make_shared<core::Characteristic>(0x23, core::Format::String,
+        core::PermissionSet{core::Permission::PairedRead}));
+    accessory->add_service(info);
+    auto light = std::make_shared<core::Service>(0x43, "Lightbulb", true);
+    light->add_characteristic(std::make_shared<core::Characteristic>(0x25, core::Format::Bool,
+        core::PermissionSet{core::Permission::PairedRead, core::Permission::PairedWrite}));
+    accessory->add_service(light);
+    ASSERT_TRUE(db.add_accessory(accessory) == core::ValidationResult::Success);
+    
+    common::TaskScheduler scheduler(&system);
+    PairingEndpoints::Config pe_config;
+    pe_config.crypto = &crypto;
+    pe_config.system = &system;
+    pe_config.accessory_id = "11:22:33:44:55:66";
+    pe_config.setup_code = "Code";
+    PairingEndpoints pe(pe_config);
+    
+    BleTransport::Config config;
+    config.ble = &ble;
+    config.crypto = &crypto;
+    config.database = &db;
+    config.pairing_endpoints = &pe;
+    config.system = &system;
+    config.storage = &storage;
+    config.scheduler = &scheduler;
+    config.accessory_id = "11:22:33:44:55:66";
+    config.device_name = "Dev";
+    config.defer_user_services = true;
+    int ready_calls = 0;
+    config.on_ready = [&ready_calls]() { ++ready_calls; };
+    
+    transport::BleTransport transport(config);
+    transport.start();
+    
+    // Only Accessory Information, Protocol Information and Pairing so far
+    ASSERT_EQ(ble.registered_services.size(), (size_t)3);
+    ASSERT_TRUE(!transport.is_ready());
+    ASSERT_EQ(ble.advertising_starts, 0);
+    ASSERT_EQ(ready_calls, 0);
+    
+    scheduler.tick(0);
+    ASSERT_EQ(ble.registered_services.size(), (size_t)4);
+    ASSERT_EQ(ble.registered_services.back().uuid, std::string("00000043-0000-1000-8000-0026BB765291"));
+    ASSERT_TRUE(transport.is_ready());
+    ASSERT_EQ(ble.advertising_starts, 1);
+    ASSERT_EQ(ready_calls, 1);
+    
+    std::cout << "Deferred Registration Test Passed." << std::endl;
+}
+
+void run_indication_pacing_test() {
+    std::cout << "Running Indication Pacing Test..." << std::endl;
+    MockBle ble; MockCrypto crypto; MockStorage storage; MockSystem system;
+    ble.report_confirmations = true;
+    core::AttributeDatabase db;
+    auto accessory = std::make_shared<core::Accessory>(1);
+    auto info = std::make_shared<core::Service>(0x3E, "Accessory Information");
+    info->add_characteristic(std::make_shared<core::Characteristic>(0x23, core::Format::String,
+        core::PermissionSet{core::Permission::PairedRead}));
+    accessory->add_service(info);
+    auto light = std::make_shared<core::Service>(0x43, "Lightbulb", true);
+    auto on = std::make_shared<core::Characteristic>(0x25, core::Format::Bool,
+        core::PermissionSet{core::Permission::PairedRead, core::Permission::PairedWrite, core::Permission::Notify});
+    auto brightness = std::make_shared<core::Characteristic>(0x08, core::Format::Int,
+        core::PermissionSet{core::Permission::PairedRead, core::Permission::PairedWrite, core::Permission::Notify});
+    light->add_characteristic(on);
+    light->add_characteristic(brightness);
+    accessory->add_service(light);
+    ASSERT_TRUE(db.add_accessory(accessory) == core::ValidationResult::Success);
+    
+    common::TaskScheduler scheduler(&system);
+    PairingEndpoints::Config pe_config;
+    pe_config.crypto = &crypto;
+    pe_config.system = &system;
+    pe_config.accessory_id = "11:22:33:44:55:66";
+    pe_config.setup_code = "Code";
+    PairingEndpoints pe(pe_config);
+    
+    BleTransport::Config config;
+    config.ble = &ble;
+    config.crypto = &crypto;
+    config.database = &db;
+    config.pairing_endpoints = &pe;
+    config.system = &system;
+    config.storage = &storage;
+    config.scheduler = &scheduler;
+    config.accessory_id = "11:22:33:44:55:66";
+    config.device_name = "Dev";
+    
+    transport::BleTransport transport(config);
+    transport.start();
+    ASSERT_TRUE(ble.confirm_callback != nullptr);
+    
+    // A connected controller subscribed to both characteristics
+    const std::string kOnUUID = "00000025-0000-1000-8000-0026BB765291";
+    const std::string kBrightnessUUID = "00000008-0000-1000-8000-0026BB765291";
+    for (auto& svc : ble.registered_services) {
+        for (auto& ch : svc.characteristics) {
+            if (ch.uuid == kOnUUID || ch.uuid == kBrightnessUUID) ch.on_subscribe(1, true);
+        }
+    }
+    ble.mtu_callback(1, 185);  // Opens the session
+    
+    // A burst: one in flight, the rest wait for confirmations, repeats coalesce
+    transport.notify_value_changed(1, on->iid(), true);
+    transport.notify_value_changed(1, brightness->iid(), 10);
+    transport.notify_value_changed(1, brightness->iid(), 20);
+    transport.notify_value_changed(1, on->iid(), false);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)1);
+    ASSERT_EQ(ble.sent_notifications[0].uuid, kOnUUID);
+    ASSERT_TRUE(ble.sent_notifications[0].data.empty());
+    
+    ble.confirm_callback(1);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)2);
+    ASSERT_EQ(ble.sent_notifications[1].uuid, kBrightnessUUID);
+    ble.confirm_callback(1);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)3);
+    ASSERT_EQ(ble.sent_notifications[2].uuid, kOnUUID);
+    ble.confirm_callback(1);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)3);
+    
+    // A refused indication is retried, not dropped
+    ble.indication_room = 0;
+    transport.notify_value_changed(1, brightness->iid(), 30);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)3);
+    ble.indication_room = SIZE_MAX;
+    system.now_ms = 50;
+    scheduler.tick(50);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)4);
+    
+    // A confirmation that never comes stalls the queue only until the timeout
+    transport.notify_value_changed(1, on->iid(), true);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)4);
+    system.now_ms = 2000;
+    scheduler.tick(2000);
+    ASSERT_EQ(ble.sent_notifications.size(), (size_t)5);
+    
+    std::cout << "Indication Pacing Test Passed." << std::endl;
+}
+
 int main() {
     run_advertising_test();
     run_reassembly_test();
     run_service_signature_test();
+    run_mtu_fragmentation_test();
+    run_advertising_debounce_test();
+    run_concurrent_connections_test();
+    run_threaded_transactions_test();
+    run_session_timeout_test();
     run_write_with_response_test();
+    run_deferred_registration_test();
+    run_indication_pacing_test();
     return 0;
 }
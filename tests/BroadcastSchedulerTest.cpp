@@ -0,0 +1,86 @@
+#include "hap/transport/ble/BroadcastScheduler.hpp"
+#include <cassert>
+#include <iostream>
+
+using namespace hap;
+using hap::transport::ble::BroadcastScheduler;
+
+void test_slot_length() {
+    assert(BroadcastScheduler::slot_ms(20) == BroadcastScheduler::kMinSlotMs);
+    assert(BroadcastScheduler::slot_ms(1280) == 3840);
+    assert(BroadcastScheduler::slot_ms(2560) == 7680);
+    std::cout << "test_slot_length passed" << std::endl;
+}
+
+void test_round_robin_and_coalescing() {
+    BroadcastScheduler scheduler;
+    assert(!scheduler.next(0));
+
+    assert(scheduler.push(10, core::Value{int32_t(1)}, 20));
+    auto slot = scheduler.next(0);
+    assert(slot && slot->iid == 10);
+    assert(scheduler.busy_until_ms() == 3000u);
+
+    // Two sensors change while the radio is busy; one changes twice
+    assert(scheduler.push(20, core::Value{int32_t(5)}, 20));
+    assert(scheduler.push(10, core::Value{int32_t(2)}, 20));
+    assert(scheduler.push(20, core::Value{int32_t(6)}, 20));
+    assert(scheduler.pending() == 2);
+    assert(scheduler.stats().coalesced == 1);
+    assert(!scheduler.next(2999));
+
+    // Queue order: 20 was queued first and carries its latest value
+    assert(!scheduler.release(3000));
+    slot = scheduler.next(3000);
+    assert(slot && slot->iid == 20 && slot->value == core::Value{int32_t(6)});
+    slot = scheduler.next(6000);
+    assert(slot && slot->iid == 10 && slot->value == core::Value{int32_t(2)});
+
+    // Slot over and nothing left: back to regular advertising, once
+    assert(!scheduler.release(8999));
+    assert(scheduler.release(9000));
+    assert(!scheduler.release(9001));
+    assert(!scheduler.busy_until_ms());
+    assert(scheduler.stats().sent == 3);
+    std::cout << "test_round_robin_and_coalescing passed" << std::endl;
+}
+
+void test_unchanged_values_are_dropped() {
+    BroadcastScheduler scheduler;
+    scheduler.push(10, core::Value{true}, 20);
+    scheduler.next(0);
+
+    assert(!scheduler.push(10, core::Value{true}, 20));
+    assert(scheduler.pending() == 0);
+
+    // Changed and changed back before it went out: nothing to tell
+    assert(scheduler.push(10, core::Value{false}, 20));
+    assert(!scheduler.push(10, core::Value{true}, 20));
+    assert(scheduler.pending() == 0);
+    assert(scheduler.stats().unchanged == 2);
+
+    // A connection resets what controllers are known to have seen
+    scheduler.clear();
+    assert(scheduler.push(10, core::Value{true}, 20));
+    assert(scheduler.next(0));
+    std::cout << "test_unchanged_values_are_dropped passed" << std::endl;
+}
+
+void test_slow_interval_holds_longer() {
+    BroadcastScheduler scheduler;
+    scheduler.push(10, core::Value{int32_t(1)}, 2560);
+    scheduler.push(20, core::Value{int32_t(1)}, 20);
+    assert(scheduler.next(100)->interval_ms == 2560);
+    assert(!scheduler.next(3100));
+    assert(scheduler.next(100 + 7680)->iid == 20);
+    std::cout << "test_slow_interval_holds_longer passed" << std::endl;
+}
+
+int main() {
+    test_slot_length();
+    test_round_robin_and_coalescing();
+    test_unchanged_values_are_dropped();
+    test_slow_interval_holds_longer();
+    std::cout << "All BroadcastScheduler tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include "hap/platform/CachedStorage.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace hap;
+using namespace hap::platform;
+
+class CountingStorage : public Storage {
+public:
+    std::map<std::string, std::vector<uint8_t>, std::less<>> data;
+    int sets = 0;
+    int removes = 0;
+    int gets = 0;
+    int batches = 0;
+    bool in_batch = false;
+
+    void set(std::string_view key, std::span<const uint8_t> value) override {
+        assert(in_batch);
+        ++sets;
+        data[std::string(key)] = std::vector<uint8_t>(value.begin(), value.end());
+    }
+    std::optional<std::vector<uint8_t>> get(std::string_view key) override {
+        ++gets;
+        auto it = data.find(key);
+        if (it == data.end()) return std::nullopt;
+        return it->second;
+    }
+    void remove(std::string_view key) override {
+        assert(in_batch);
+        ++removes;
+        if (auto it = data.find(key); it != data.end()) data.erase(it);
+    }
+    bool has(std::string_view key) override { return data.find(key) != data.end(); }
+    void begin_batch() override { in_batch = true; }
+    void commit_batch() override { in_batch = false; ++batches; }
+};
+
+static std::vector<uint8_t> bytes(uint8_t v) { return {v}; }
+
+void test_coalesced_flush() {
+    mock::MockSystem system;
+    common::TaskScheduler scheduler(&system);
+    CountingStorage backend;
+    CachedStorage storage(&backend, &scheduler, 100);
+
+    // Churn on one key: only the last value reaches the backend
+    for (uint8_t i = 1; i <= 10; ++i) {
+        storage.set("gsn", bytes(i));
+    }
+    storage.set("cn", bytes(7));
+    assert(backend.sets == 0);
+    assert(storage.get("gsn") == bytes(10));
+    assert(storage.has_pending());
+
+    system.set_time(99);
+    scheduler.tick();
+    assert(backend.sets == 0);
+    system.set_time(100);
+    scheduler.tick();
+    assert(backend.sets == 2 && backend.batches == 1);
+    assert(backend.data["gsn"] == bytes(10));
+    assert(!storage.has_pending());
+
+    // Unchanged values and removals of keys known to be absent are not writes
+    storage.set("gsn", bytes(10));
+    assert(!storage.has("missing"));
+    storage.remove("missing");
+    assert(!storage.has_pending());
+
+    storage.remove("cn");
+    assert(!storage.has("cn"));
+    storage.commit();
+    assert(backend.removes == 1 && backend.batches == 2);
+    assert(!backend.has("cn"));
+    assert(scheduler.task_count() == 1);  // Explicit commit leaves the timer; it finds nothing to do
+    system.set_time(300);
+    scheduler.tick();
+    assert(backend.batches == 2);
+
+    std::cout << "test_coalesced_flush passed" << std::endl;
+}
+
+void test_write_through_key() {
+    mock::MockSystem system;
+    common::TaskScheduler scheduler(&system);
+    CountingStorage backend;
+    CachedStorage storage(&backend, &scheduler, 100);
+    storage.set_write_through("gsn");
+
+    // The write-through key takes pending changes with it, in one batch
+    storage.set("cn", bytes(1));
+    storage.set("gsn", bytes(2));
+    assert(backend.sets == 2 && backend.batches == 1);
+    assert(backend.data["gsn"] == bytes(2) && !storage.has_pending());
+
+    // Inside a transaction it waits for the end like everything else
+    {
+        auto transaction = storage.transaction();
+        storage.set("gsn", bytes(3));
+        assert(backend.sets == 2);
+    }
+    assert(backend.data["gsn"] == bytes(3));
+
+    std::cout << "test_write_through_key passed" << std::endl;
+}
+
+void test_read_through() {
+    CountingStorage backend;
+    backend.data["accessory_id"] = bytes(1);
+    CachedStorage storage(&backend);
+
+    assert(storage.get("accessory_id") == bytes(1));
+    assert(storage.has("accessory_id"));
+    assert(!storage.has("setup_id"));
+    assert(!storage.get("setup_id"));
+    assert(backend.gets == 2);  // Misses are cached too
+
+    std::cout << "test_read_through passed" << std::endl;
+}
+
+void test_transaction() {
+    mock::MockSystem system;
+    common::TaskScheduler scheduler(&system);
+    CountingStorage backend;
+    backend.data["a"] = bytes(1);
+    backend.data["b"] = bytes(2);
+    CachedStorage storage(&backend, &scheduler, 10);
+
+    {
+        auto outer = storage.transaction();
+        storage.remove("a");
+        {
+            CachedStorage::Transaction inner(storage);
+            storage.remove("b");
+        }
+        // Neither the inner transaction, commit() nor the timer flush mid-transaction
+        storage.commit();
+        system.set_time(50);
+        scheduler.tick();
+        assert(backend.removes == 0);
+        storage.set("a", bytes(3));
+    }
+    assert(backend.batches == 1);
+    assert(backend.data["a"] == bytes(3));
+    assert(!backend.has("b"));
+
+    std::cout << "test_transaction passed" << std::endl;
+}
+
+void test_destructor_commits() {
+    CountingStorage backend;
+    {
+        CachedStorage storage(&backend);  // No scheduler: explicit commits only
+        storage.set("iid", bytes(5));
+        assert(backend.sets == 0);
+    }
+    assert(backend.data["iid"] == bytes(5));
+
+    std::cout << "test_destructor_commits passed" << std::endl;
+}
+
+int main() {
+    test_coalesced_flush();
+    test_write_through_key();
+    test_read_through();
+    test_transaction();
+    test_destructor_commits();
+    return 0;
+}
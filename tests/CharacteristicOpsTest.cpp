@@ -0,0 +1,78 @@
+#include "hap/transport/CharacteristicOps.hpp"
+#include <cassert>
+#include <iostream>
+
+using namespace hap::core;
+using namespace hap::transport;
+
+void test_permission_checks() {
+    Characteristic read_only(0x25, Format::Bool, {Permission::PairedRead, Permission::Notify});
+    Characteristic write_only(0x25, Format::Bool, {Permission::PairedWrite});
+
+    assert(CharacteristicOps::check_read(&read_only) == HAPStatus::Success);
+    assert(CharacteristicOps::check_write(&read_only) == HAPStatus::ReadOnlyCharacteristic);
+    assert(CharacteristicOps::check_notify(&read_only) == HAPStatus::Success);
+    assert(CharacteristicOps::check_read(&write_only) == HAPStatus::WriteOnlyCharacteristic);
+    assert(CharacteristicOps::check_notify(&write_only) == HAPStatus::NotificationNotSupported);
+
+    // A missing target is reported the same way by every check
+    assert(CharacteristicOps::check_read(nullptr) == HAPStatus::ResourceDoesNotExist);
+    assert(CharacteristicOps::check_write(nullptr) == HAPStatus::ResourceDoesNotExist);
+
+    std::cout << "test_permission_checks passed" << std::endl;
+}
+
+void test_timed_write() {
+    Characteristic timed(0x1E, Format::UInt8, {Permission::PairedWrite, Permission::TimedWrite});
+    Characteristic plain(0x1E, Format::UInt8, {Permission::PairedWrite});
+    TimedWriteTable prepared;
+    prepared.prepare(7, 1000);
+
+    assert(CharacteristicOps::check_timed_write(plain, prepared, std::nullopt, 0) == HAPStatus::Success);
+    assert(CharacteristicOps::check_timed_write(timed, prepared, std::nullopt, 0) == HAPStatus::InvalidValueInRequest);
+    assert(CharacteristicOps::check_timed_write(timed, prepared, 7, 500) == HAPStatus::Success);
+    assert(CharacteristicOps::check_timed_write(timed, prepared, 7, 1500) == HAPStatus::InvalidValueInRequest);
+
+    std::cout << "test_timed_write passed" << std::endl;
+}
+
+void test_read_and_write_response() {
+    Characteristic ch(0x25, Format::Bool, {Permission::PairedRead, Permission::PairedWrite, Permission::WriteResponse});
+    ch.set_value(true);
+
+    Value scratch;
+    auto read = CharacteristicOps::read(&ch, scratch);
+    assert(read.status == HAPStatus::Success && read.value && std::get<bool>(*read.value));
+
+    // Without a callback the current value is returned
+    auto outcome = CharacteristicOps::write_response(ch);
+    assert(outcome.status == HAPStatus::Success && outcome.value && std::get<bool>(*outcome.value));
+
+    ch.set_write_response_callback([](const Value&) -> HAPResponse<Value> { return HAPStatus::ResourceBusy; });
+    outcome = CharacteristicOps::write_response(ch);
+    assert(outcome.status == HAPStatus::ResourceBusy && !outcome.value);
+
+    Characteristic no_response(0x25, Format::Bool, {Permission::PairedWrite});
+    assert(!CharacteristicOps::write_response(no_response).value);
+
+    std::cout << "test_read_and_write_response passed" << std::endl;
+}
+
+void test_ble_status() {
+    assert(CharacteristicOps::to_ble_status(HAPStatus::Success) == 0x00);
+    assert(CharacteristicOps::to_ble_status(HAPStatus::InsufficientAuthorization) == 0x03);
+    assert(CharacteristicOps::to_ble_status(HAPStatus::ResourceDoesNotExist) == 0x05);
+    assert(CharacteristicOps::to_ble_status(HAPStatus::ReadOnlyCharacteristic) == 0x06);
+    assert(CharacteristicOps::to_ble_status(HAPStatus::ResourceBusy) == 0x02);
+
+    std::cout << "test_ble_status passed" << std::endl;
+}
+
+int main() {
+    test_permission_checks();
+    test_timed_write();
+    test_read_and_write_response();
+    test_ble_status();
+    std::cout << "All CharacteristicOps tests passed!" << std::endl;
+    return 0;
+}
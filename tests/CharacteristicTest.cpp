@@ -0,0 +1,298 @@
+#include "hap/core/Characteristic.hpp"
+#include "hap/core/HAPStatus.hpp"
+#include "hap/types/CharacteristicTypes.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <shared_mutex>
+#include <thread>
+
+using namespace hap::core;
+
+void test_factory_metadata_is_shared() {
+    auto a = hap::characteristic::Brightness();
+    auto b = hap::characteristic::Brightness();
+    assert(&a->metadata() == &b->metadata());
+    assert(a->unit() && *a->unit() == "percentage");
+    assert(a->max_value() && *a->max_value() == 100);
+
+    // Editing one instance copies the shared descriptor first
+    a->set_max_value(50);
+    assert(&a->metadata() != &b->metadata());
+    assert(*a->max_value() == 50);
+    assert(*a->unit() == "percentage");
+    assert(*b->max_value() == 100);
+
+    std::cout << "test_factory_metadata_is_shared passed" << std::endl;
+}
+
+void test_descriptor_catalog() {
+    // Descriptors are usable at compile time and back the factories
+    static_assert(hap::characteristic::CharacteristicDescriptor{.unit = "celsius"}.has_metadata());
+    static_assert(!hap::characteristic::CharacteristicDescriptor{.type = 0x25}.has_metadata());
+
+    const auto* d = hap::characteristic::find_descriptor(hap::characteristic::kType_Brightness);
+    assert(d && d->format == Format::Int && d->unit == "percentage" && *d->max_value == 100);
+    auto c = hap::characteristic::Brightness();
+    assert(c->type() == d->type && c->format() == d->format && c->permissions() == d->permissions);
+    assert(!hap::characteristic::find_descriptor(0xFFFF));
+
+    // Without ranges or units nothing is attached
+    auto on = hap::characteristic::On();
+    assert(!on->unit() && !on->max_value() && !on->max_len());
+
+    std::cout << "test_descriptor_catalog passed" << std::endl;
+}
+
+void test_no_metadata() {
+    Characteristic c(0x25, Format::Bool, {Permission::PairedRead});
+    assert(!c.unit());
+    assert(!c.min_value());
+    assert(!c.valid_values());
+
+    c.set_valid_values({0, 1});
+    assert(c.valid_values() && c.valid_values()->size() == 2);
+    assert(!c.unit());
+
+    std::cout << "test_no_metadata passed" << std::endl;
+}
+
+void test_callbacks_optional() {
+    Characteristic c(0x08, Format::Int, {Permission::PairedRead, Permission::PairedWrite});
+
+    // Without callbacks, values are stored and read back as is
+    assert(!c.set_value(42, EventSource::from_connection(1)));
+    assert(std::get<int32_t>(std::get<Value>(c.get_value())) == 42);
+    assert(!c.handle_write_response(Value{int32_t{1}}));
+
+    int writes = 0;
+    c.set_write_callback([&writes](const Value&) -> WriteResponse {
+        ++writes;
+        return std::nullopt;
+    });
+    c.on_read([]() -> ReadResponse { return Value{int32_t{7}}; });
+    assert(!c.set_value(5, EventSource::from_connection(1)));
+    assert(writes == 1);
+    assert(std::get<int32_t>(std::get<Value>(c.get_value())) == 7);
+
+    std::cout << "test_callbacks_optional passed" << std::endl;
+}
+
+void test_permission_set() {
+    Characteristic c(0x25, Format::Bool, {Permission::PairedRead, Permission::PairedWrite, Permission::Notify});
+    assert(c.has_permission(Permission::PairedRead));
+    assert(c.has_permission(Permission::Notify));
+    assert(!c.has_permission(Permission::TimedWrite));
+    assert(c.ble_properties() == (0x0010 | 0x0020 | 0x0080 | 0x0100));
+
+    // Iteration yields enum order regardless of construction order
+    PermissionSet set{Permission::WriteResponse, Permission::PairedRead};
+    std::vector<Permission> seen;
+    for (Permission p : set) seen.push_back(p);
+    assert((seen == std::vector{Permission::PairedRead, Permission::WriteResponse}));
+
+    // The vector constructor packs the same bits
+    Characteristic legacy(0x25, Format::Bool, std::vector{Permission::Notify, Permission::PairedRead, Permission::PairedWrite});
+    assert(legacy.permissions() == c.permissions());
+
+    std::cout << "test_permission_set passed" << std::endl;
+}
+
+void test_typed_accessors() {
+    auto brightness = hap::characteristic::Brightness();
+    assert(!brightness->set<int32_t>(75));
+    assert(std::get<int32_t>(brightness->get<int32_t>()) == 75);
+    assert(std::get<int32_t>(brightness->value()) == 75);
+
+    // A type the format does not store is coerced like set_value()
+    assert(!brightness->set<uint8_t>(40));
+    assert(std::get<int32_t>(brightness->value()) == 40);
+    assert(std::holds_alternative<HAPStatus>(brightness->get<float>()));
+
+    // Without a read callback the read path points at the stored value
+    Characteristic tlv(0x114, Format::TLV8, {Permission::PairedRead});
+    tlv.set(std::vector<uint8_t>(1024, 0xAB));
+    Value scratch;
+    auto read = tlv.read_value(scratch);
+    assert(std::get<const Value*>(read) == &tlv.value());
+
+    // With one, the coerced callback result lands in scratch
+    tlv.on_read([]() -> ReadResponse { return Value{std::vector<uint8_t>{1, 2}}; });
+    read = tlv.read_value(scratch);
+    assert(std::get<const Value*>(read) == &scratch);
+    assert(std::get<std::vector<uint8_t>>(scratch).size() == 2);
+
+    std::cout << "test_typed_accessors passed" << std::endl;
+}
+
+void test_notify_policy() {
+    auto temperature = hap::characteristic::CurrentTemperature();
+    std::vector<float> events;
+    temperature->set_event_callback([&events](const Value& value, const EventSource&) {
+        events.push_back(std::get<float>(value));
+    });
+
+    temperature->set_notify_policy({.suppress_unchanged = true, .respect_min_step = true});
+    temperature->set<float>(20.0f);
+    temperature->set<float>(20.0f);    // Unchanged
+    temperature->set<float>(20.05f);   // Below min_step (0.1)
+    temperature->set<float>(20.5f);
+    assert((events == std::vector<float>{20.0f, 20.5f}));
+    assert(std::get<float>(temperature->value()) == 20.5f);
+
+    // Held-back updates are delivered once the interval elapses
+    hap::mock::MockSystem system;
+    hap::common::TaskScheduler scheduler(&system);
+    Characteristic::set_scheduler(&scheduler, &system);
+    events.clear();
+    temperature->set_notify_policy({.min_interval_ms = 1000});
+    temperature->set<float>(21.0f);
+    system.set_time(100);
+    temperature->set<float>(22.0f);
+    temperature->set<float>(23.0f);
+    assert((events == std::vector<float>{21.0f}));
+    system.set_time(1000);
+    scheduler.tick();
+    assert((events == std::vector<float>{21.0f, 23.0f}));
+
+    // The flush reads the value under the database lock writers hold
+    std::shared_mutex database_mutex;
+    Characteristic::set_scheduler(&scheduler, &system, &database_mutex);
+    system.set_time(1500);
+    temperature->set<float>(23.5f);
+    {
+        std::unique_lock<std::shared_mutex> writer(database_mutex);
+        system.set_time(2000);
+        std::thread tick([&scheduler]() { scheduler.tick(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        assert(events.size() == 2);
+        writer.unlock();
+        tick.join();
+    }
+    assert((events == std::vector<float>{21.0f, 23.0f, 23.5f}));
+
+    // A pending flush does not outlive the characteristic
+    system.set_time(2100);
+    temperature->set<float>(24.0f);
+    temperature.reset();
+    system.set_time(5000);
+    scheduler.tick();
+    assert(events.size() == 3);
+    Characteristic::set_scheduler(nullptr, nullptr);
+
+    std::cout << "test_notify_policy passed" << std::endl;
+}
+
+void test_read_cache() {
+    hap::mock::MockSystem system;
+    hap::common::TaskScheduler scheduler(&system);
+    Characteristic::set_scheduler(&scheduler, &system);
+
+    Characteristic sensor(0x11, Format::Float, {Permission::PairedRead, Permission::PairedWrite});
+    int reads = 0;
+    sensor.on_read([&reads]() -> ReadResponse { return Value{static_cast<float>(++reads)}; });
+    sensor.set_read_cache_ttl(1000);
+
+    assert(std::get<float>(std::get<Value>(sensor.get_value())) == 1.0f);
+    system.set_time(100);
+    assert(std::get<float>(std::get<Value>(sensor.get_value())) == 1.0f);
+    assert(reads == 1);
+    assert(scheduler.task_count() == 0);
+
+    // Past half the TTL the cached value is served and a refresh is queued
+    system.set_time(600);
+    Value scratch;
+    assert(std::get<float>(*std::get<const Value*>(sensor.read_value(scratch))) == 1.0f);
+    sensor.get_value();
+    assert(scheduler.task_count() == 1);
+    scheduler.tick();
+    assert(reads == 2);
+    assert(std::get<float>(std::get<Value>(sensor.get_value())) == 2.0f);
+
+    // Expired entries are read through; controller writes invalidate
+    system.set_time(5000);
+    assert(std::get<float>(std::get<Value>(sensor.get_value())) == 3.0f);
+    sensor.set_value(0.0f, EventSource::from_connection(1));
+    assert(std::get<float>(std::get<Value>(sensor.get_value())) == 4.0f);
+
+    // So do writes handed to an async write callback
+    WriteCompletion pending;
+    sensor.set_async_write_callback([&pending](const Value&, WriteCompletion done) { pending = std::move(done); });
+    sensor.write_async(0.0f, EventSource::from_connection(1), WriteCompletion());
+    assert(std::get<float>(std::get<Value>(sensor.get_value())) == 5.0f);
+    pending(std::nullopt);
+
+    Characteristic::set_scheduler(nullptr, nullptr);
+    std::cout << "test_read_cache passed" << std::endl;
+}
+
+void test_read_cache_threads() {
+    hap::mock::MockSystem system;
+    hap::common::TaskScheduler scheduler(&system);
+    Characteristic::set_scheduler(&scheduler, &system);
+
+    Characteristic name(0x23, Format::String, {Permission::PairedRead});
+    std::atomic<int> reads{0};
+    name.on_read([&reads]() -> ReadResponse {
+        return Value{std::string(64, static_cast<char>('a' + ++reads % 26))};
+    });
+    name.set_read_cache_ttl(1000);
+    name.get_value();
+    system.set_time(600);  // Every hit queues a background refresh
+
+    // Workers read under a shared database lock while the scheduler refreshes
+    std::atomic<bool> done{false};
+    std::thread ticker([&]() {
+        while (!done) scheduler.tick();
+    });
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t) {
+        readers.emplace_back([&name]() {
+            Value scratch;
+            for (int i = 0; i < 2000; ++i) {
+                const auto& value = std::get<std::string>(*std::get<const Value*>(name.read_value(scratch)));
+                assert(value.size() == 64 && std::all_of(value.begin(), value.end(),
+                    [&value](char c) { return c == value[0]; }));
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    done = true;
+    ticker.join();
+    scheduler.tick();  // The readers may all finish before the ticker first runs
+    assert(reads > 1);
+
+    Characteristic::set_scheduler(nullptr, nullptr);
+    std::cout << "test_read_cache_threads passed" << std::endl;
+}
+
+void test_interned_strings() {
+    Characteristic a(0x25, Format::Bool, {Permission::PairedRead, Permission::Notify, Permission::Broadcast});
+    Characteristic b(0x25, Format::Bool, {Permission::PairedRead, Permission::Notify});
+    Characteristic c(0x3E, Format::String, PermissionSet{});
+    assert(a.type_string() == "25");
+    assert(c.type_string() == "3E");
+    assert(a.type_string().data() == b.type_string().data());  // One copy per type
+    assert(a.perms_json() == R"(["pr","ev"])");
+    assert(b.perms_json() == R"(["pr","ev"])");
+    assert(c.perms_json() == "[]");
+
+    std::cout << "test_interned_strings passed" << std::endl;
+}
+
+int main() {
+    test_factory_metadata_is_shared();
+    test_descriptor_catalog();
+    test_no_metadata();
+    test_callbacks_optional();
+    test_permission_set();
+    test_typed_accessors();
+    test_notify_policy();
+    test_read_cache();
+    test_read_cache_threads();
+    test_interned_strings();
+    return 0;
+}
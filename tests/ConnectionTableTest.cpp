@@ -0,0 +1,91 @@
+#include "hap/transport/ConnectionTable.hpp"
+#include <cassert>
+#include <iostream>
+
+using namespace hap::transport;
+
+void test_acquire_and_reject() {
+    ConnectionTable table(2, nullptr, nullptr, 256, 1024);
+    assert(table.capacity() == 2 && table.size() == 0);
+
+    bool created = false;
+    auto a = table.acquire(7, &created);
+    assert(a && created && a->ctx.connection_id() == 7);
+    assert(table.acquire(7, &created) == a && !created);
+    assert(table.find(7) == a);
+
+    auto b = table.acquire(9, &created);
+    assert(b && created && b != a);
+    assert(table.size() == 2);
+
+    // Full: a third controller is turned away
+    assert(table.acquire(11, &created) == nullptr && !created);
+    assert(table.find(11) == nullptr);
+
+    std::cout << "test_acquire_and_reject passed" << std::endl;
+}
+
+void test_slot_reuse() {
+    ConnectionTable table(1, nullptr, nullptr, 256, 1024);
+    Connection* first = nullptr;
+    {
+        auto a = table.acquire(1);
+        first = a.get();
+        a->ctx.request_close();
+        a->ctx.set_response_pending(true);
+        std::string partial = "GET /accessories HTTP/1.1\r\n";
+        a->parser.feed(std::vector<uint8_t>(partial.begin(), partial.end()));
+        a->bytes_received = partial.size();
+        OutboundQueue::Message message;
+        message.body.assign(10, 0);
+        a->ctx.outbound().push(std::move(message));
+        a->ctx.outbound().pop();
+        a->ctx.outbound().push(OutboundQueue::Message{});
+    }
+    assert(table.release(1));
+    assert(!table.release(1));
+    assert(table.find(1) == nullptr && table.size() == 0);
+
+    // The unreferenced slot is recycled in a fresh state
+    auto b = table.acquire(2);
+    assert(b.get() == first);
+    assert(b->ctx.connection_id() == 2);
+    assert(!b->ctx.should_close() && !b->ctx.response_pending());
+    assert(b->parser.receive_buffer().empty());
+    assert(b->bytes_received == 0);
+    auto stats = b->ctx.outbound().stats();
+    assert(stats.depth == 0 && stats.sent_messages == 0 && stats.sent_bytes == 0 && stats.high_water_bytes == 0);
+
+    // A slot still held elsewhere is replaced instead
+    assert(table.release(2));
+    auto c = table.acquire(3);
+    assert(c.get() != first && b->ctx.connection_id() == 2);
+
+    std::cout << "test_slot_reuse passed" << std::endl;
+}
+
+void test_for_each_and_clear() {
+    ConnectionTable table(4, nullptr, nullptr, 0, 1024);
+    table.acquire(1);
+    table.acquire(2);
+    table.acquire(3);
+    table.release(2);
+
+    uint32_t sum = 0;
+    size_t count = 0;
+    table.for_each([&](uint32_t id, const std::shared_ptr<Connection>&) { sum += id; ++count; });
+    assert(count == 2 && sum == 4);
+
+    table.clear();
+    assert(table.size() == 0 && table.find(1) == nullptr);
+    assert(table.acquire(ConnectionTable::FREE) == nullptr);
+
+    std::cout << "test_for_each_and_clear passed" << std::endl;
+}
+
+int main() {
+    test_acquire_and_reject();
+    test_slot_reuse();
+    test_for_each_and_clear();
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "hap/transport/EventDispatcher.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace hap;
+using namespace hap::transport;
+
+void test_reverse_index() {
+    EventDispatcher events;
+    events.subscribe(1, 1, 10);
+    events.subscribe(2, 1, 10);
+    events.subscribe(2, 1, 10);  // Duplicate is ignored
+    events.subscribe(2, 2, 10);
+
+    assert(events.subscribers(1, 10).size() == 2);
+    assert(events.subscribers(2, 10).size() == 1);
+    assert(events.subscribers(1, 11).empty());
+    assert(events.is_subscribed(2, 2, 10));
+    assert(!events.is_subscribed(1, 2, 10));
+    assert(events.subscription_count(2) == 2);
+
+    events.unsubscribe(1, 1, 10);
+    assert(events.subscribers(1, 10).size() == 1);
+    assert(events.subscribers(1, 10)[0] == 2);
+
+    events.remove_connection(2);
+    assert(events.subscribers(1, 10).empty());
+    assert(events.subscription_count(2) == 0);
+    assert(events.subscribers(2, 10).empty());
+
+    std::cout << "test_reverse_index passed" << std::endl;
+}
+
+void test_render_event() {
+    EventDispatcher events;
+    auto message = events.render_event(1, 10, core::Value{true});
+    std::string text(message.begin(), message.end());
+
+    std::string body = R"({"characteristics":[{"aid":1,"iid":10,"value":true}]})";
+    std::string expected = "EVENT/1.0 200 OK\r\n"
+                           "Content-Type: application/hap+json\r\n"
+                           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                           "\r\n" + body;
+    assert(text == expected);
+
+    // The buffer is reused for the next event
+    message = events.render_event(1, 11, core::Value{int32_t(42)});
+    text.assign(message.begin(), message.end());
+    assert(text.find(R"("iid":11,"value":42)") != std::string::npos);
+
+    std::cout << "test_render_event passed" << std::endl;
+}
+
+void test_coalesced_flush() {
+    EventDispatcher events;
+    events.subscribe(1, 1, 10);
+    events.subscribe(1, 1, 11);
+    events.subscribe(2, 1, 10);
+    events.subscribe(2, 1, 11);
+    events.subscribe(3, 1, 11);
+
+    assert(events.enqueue(1, 10, core::Value{int32_t(1)}, 0));
+    assert(!events.enqueue(1, 11, core::Value{int32_t(5)}, 0));
+    assert(!events.enqueue(1, 10, core::Value{int32_t(2)}, 2));  // Supersedes, excludes conn 2
+    assert(!events.enqueue(1, 12, core::Value{int32_t(9)}, 0));  // Nobody subscribed
+
+    std::vector<std::pair<uint32_t, std::string>> sent;
+    std::vector<std::vector<uint64_t>> carried;
+    events.flush([&](uint32_t conn, std::span<const uint8_t> message, std::span<const uint64_t> keys) {
+        carried.emplace_back(keys.begin(), keys.end());
+        sent.emplace_back(conn, std::string(message.begin(), message.end()));
+    });
+    assert(!events.has_pending());
+    assert(sent.size() == 3);
+
+    std::string both = R"({"characteristics":[{"aid":1,"iid":10,"value":2},{"aid":1,"iid":11,"value":5}]})";
+    std::string only_11 = R"({"characteristics":[{"aid":1,"iid":11,"value":5}]})";
+    auto body_of = [](const std::string& m) { return m.substr(m.find("\r\n\r\n") + 4); };
+    assert(sent[0].first == 1 && body_of(sent[0].second) == both);
+    assert(sent[1].first == 2 && body_of(sent[1].second) == only_11);
+    assert(sent[2].first == 3 && body_of(sent[2].second) == only_11);
+    assert((carried[0] == std::vector<uint64_t>{(1ull << 32) | 10, (1ull << 32) | 11}));
+    assert((carried[1] == std::vector<uint64_t>{(1ull << 32) | 11}));
+
+    // Nothing queued: flush is a no-op
+    events.flush([&](uint32_t, std::span<const uint8_t>, std::span<const uint64_t>) { assert(false); });
+
+    std::cout << "test_coalesced_flush passed" << std::endl;
+}
+
+void test_remove_accessory() {
+    EventDispatcher events;
+    events.subscribe(1, 2, 10);
+    events.subscribe(1, 3, 10);
+    events.subscribe(2, 2, 11);
+    events.enqueue(2, 10, core::Value{true}, 0);
+    events.enqueue(3, 10, core::Value{true}, 0);
+
+    events.remove_accessory(2);
+    assert(!events.has_subscribers(2, 10));
+    assert(!events.has_subscribers(2, 11));
+    assert(events.is_subscribed(1, 3, 10));
+
+    std::vector<uint32_t> notified;
+    events.flush([&](uint32_t conn, std::span<const uint8_t> message, std::span<const uint64_t>) {
+        std::string text(message.begin(), message.end());
+        assert(text.find(R"("aid":2)") == std::string::npos);
+        notified.push_back(conn);
+    });
+    assert((notified == std::vector<uint32_t>{1}));
+
+    // Connection 2 lost its only subscription; removing it again is harmless
+    events.remove_connection(2);
+
+    std::cout << "test_remove_accessory passed" << std::endl;
+}
+
+int main() {
+    test_reverse_index();
+    test_render_event();
+    test_coalesced_flush();
+    test_remove_accessory();
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "hap/transport/ble/GlobalStateNumber.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace hap;
+using hap::transport::ble::GlobalStateNumber;
+
+static uint16_t stored_gsn(mock::MockStorage& storage) {
+    auto bytes = *storage.get("gsn");
+    return static_cast<uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+void test_batched_writes() {
+    mock::MockStorage storage;
+    GlobalStateNumber gsn(&storage, 8);
+
+    assert(gsn.current() == 1);
+    assert(storage.writes() == 1);  // Initial value
+
+    for (int i = 0; i < 8; ++i) gsn.increment();
+    assert(gsn.current() == 9);
+    assert(storage.writes() == 2);  // One block claimed for 2..9
+    assert(stored_gsn(storage) == 9);
+
+    gsn.increment();
+    assert(storage.writes() == 3);
+    assert(stored_gsn(storage) == 17);
+
+    std::cout << "test_batched_writes passed" << std::endl;
+}
+
+void test_restart_skips_ahead() {
+    mock::MockStorage storage;
+    {
+        GlobalStateNumber gsn(&storage, 8);
+        gsn.increment();
+        gsn.increment();
+        gsn.increment();
+        assert(gsn.current() == 4);
+    }
+
+    // Whatever was advertised before, the new instance starts past it
+    GlobalStateNumber restarted(&storage, 8);
+    assert(restarted.current() == 9);
+    assert(restarted.increment() == 10);
+    assert(stored_gsn(storage) == 17);
+
+    std::cout << "test_restart_skips_ahead passed" << std::endl;
+}
+
+void test_wraparound() {
+    mock::MockStorage storage;
+    storage.set("gsn", std::vector<uint8_t>{0xFE, 0xFF});  // 65534
+    GlobalStateNumber gsn(&storage, 4);
+
+    assert(gsn.current() == 65534);
+    assert(gsn.increment() == 65535);
+    assert(stored_gsn(storage) == 3);  // 65535, 1, 2, 3 claimed
+    assert(gsn.increment() == 1);
+    assert(gsn.increment() == 2);
+
+    std::cout << "test_wraparound passed" << std::endl;
+}
+
+void test_reset_reloads() {
+    mock::MockStorage storage;
+    GlobalStateNumber gsn(&storage, 4);
+    gsn.increment();
+    gsn.increment();
+
+    storage.remove("gsn");
+    gsn.reset();
+    assert(gsn.current() == 1);
+    assert(stored_gsn(storage) == 1);
+
+    std::cout << "test_reset_reloads passed" << std::endl;
+}
+
+int main() {
+    test_batched_writes();
+    test_restart_skips_ahead();
+    test_wraparound();
+    test_reset_reloads();
+    return 0;
+}
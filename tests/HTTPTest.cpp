@@ -1,4 +1,6 @@
 #include "hap/transport/HTTP.hpp"
+#include "hap/transport/Router.hpp"
+#include "hap/transport/ConnectionContext.hpp"
 #include <cassert>
 #include <iostream>
 #include <string>
@@ -61,6 +63,80 @@ void test_chunked_parsing() {
     std::cout << "test_chunked_parsing passed" << std::endl;
 }
 
+void test_receive_buffer_partial_body() {
+    std::string head = "PUT /characteristics HTTP/1.1\r\nContent-Length: 10\r\n\r\n01234";
+    std::string tail = "56789";
+
+    HTTPParser parser;
+    // Producers such as in-place decryption append directly to the buffer
+    auto& buf = parser.receive_buffer();
+    buf.insert(buf.end(), head.begin(), head.end());
+    assert(!parser.parse()); // Body incomplete
+
+    auto& buf2 = parser.receive_buffer();
+    buf2.insert(buf2.end(), tail.begin(), tail.end());
+    assert(parser.parse());
+
+    auto req = parser.take_request();
+    assert(req.method == Method::PUT);
+    assert(std::string(req.body.begin(), req.body.end()) == "0123456789");
+
+    std::cout << "test_receive_buffer_partial_body passed" << std::endl;
+}
+
+void test_pipelined_requests() {
+    std::string http_req =
+        "GET /characteristics?id=1.10 HTTP/1.1\r\nHost: a\r\n\r\n"
+        "PUT /characteristics HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}"
+        "GET /accessories HTTP/1.1\r\n";
+    std::vector<uint8_t> data(http_req.begin(), http_req.end());
+
+    HTTPParser parser;
+    assert(parser.feed(data));
+    auto first = parser.take_request();
+    assert(first.path == "/characteristics");
+    assert(first.query == "id=1.10");
+
+    // Second request was already buffered
+    assert(parser.parse());
+    auto second = parser.take_request();
+    assert(second.method == Method::PUT);
+    assert(std::string(second.body.begin(), second.body.end()) == "{}");
+    assert(second.get_header("Host").empty());
+
+    // Third is incomplete until the rest arrives
+    assert(!parser.parse());
+    std::string rest = "\r\n";
+    assert(parser.feed(std::vector<uint8_t>(rest.begin(), rest.end())));
+    assert(parser.take_request().path == "/accessories");
+
+    std::cout << "test_pipelined_requests passed" << std::endl;
+}
+
+void test_header_lookup() {
+    std::string http_req = "POST /pairings HTTP/1.1\r\ncontent-length: 3\r\nContent-Type:application/pairing+tlv8\r\n\r\nabc";
+    std::vector<uint8_t> data(http_req.begin(), http_req.end());
+
+    HTTPParser parser;
+    assert(parser.feed(data));
+    auto req = parser.take_request();
+
+    // Lookup is case-insensitive and values are trimmed
+    assert(req.get_header("Content-Length") == "3");
+    assert(req.get_header("CONTENT-TYPE") == "application/pairing+tlv8");
+    assert(req.headers.size() == 2);
+    assert(req.body.size() == 3);
+
+    size_t seen = 0;
+    for (const auto& [key, value] : req.headers) {
+        assert(!key.empty() && !value.empty());
+        ++seen;
+    }
+    assert(seen == 2);
+
+    std::cout << "test_header_lookup passed" << std::endl;
+}
+
 void test_response_builder() {
     Response resp(Status::OK);
     resp.set_header("Content-Type", "application/json");
@@ -74,13 +150,227 @@ void test_response_builder() {
     assert(result.find("Content-Length: 13") != std::string::npos);
     assert(result.find(R"({"test": 123})") != std::string::npos);
 
+    // Content-Length always follows the body; 204 carries none
+    resp.set_header("Content-Length", "99");
+    resp.set_body("{}");
+    std::vector<uint8_t> head;
+    HTTPBuilder::append_head(resp, head);
+    std::string head_str(head.begin(), head.end());
+    assert(head_str.find("Content-Length: 2\r\n") != std::string::npos);
+    assert(head_str.find("99") == std::string::npos);
+    assert(head_str.size() <= HTTPBuilder::head_size(resp));
+    assert(head_str.substr(head_str.size() - 4) == "\r\n\r\n");
+
+    Response empty(Status::NoContent);
+    auto no_content = HTTPBuilder::build(empty);
+    assert(std::string(no_content.begin(), no_content.end()) == "HTTP/1.1 204 No Content\r\n\r\n");
+
+    // The fixed pairing head matches what a Response with the same header builds
+    Response pairing(Status::OK);
+    pairing.set_header("Content-Type", "application/pairing+tlv8");
+    pairing.set_body(std::vector<uint8_t>(409, 0x06));
+    std::vector<uint8_t> fixed_head;
+    HTTPBuilder::append_head(Status::OK, "application/pairing+tlv8", 409, fixed_head);
+    std::vector<uint8_t> built_head;
+    HTTPBuilder::append_head(pairing, built_head);
+    assert(fixed_head == built_head);
+
     std::cout << "test_response_builder passed" << std::endl;
 }
 
+void test_router_dispatch() {
+    Router router;
+    std::string seen;
+    router.add_route(Method::GET, "/characteristics", [&](const Request& req, ConnectionContext&) {
+        seen = "get:" + req.query;
+        return Response{Status::OK};
+    });
+    router.add_route(Method::PUT, "/characteristics", [&](const Request&, ConnectionContext&) {
+        seen = "put";
+        return Response{Status::NoContent};
+    }, true);
+
+    std::string http_req = "GET /characteristics?id=1.10&ev=1 HTTP/1.1\r\n\r\n";
+    HTTPParser parser;
+    assert(parser.feed(std::vector<uint8_t>(http_req.begin(), http_req.end())));
+    Request req = parser.take_request();
+
+    ConnectionContext ctx(nullptr, nullptr, 1);
+    auto resp = router.dispatch(req, ctx);
+    assert(resp && resp->status == Status::OK);
+    assert(seen == "get:id=1.10&ev=1");
+
+    // Method is part of the key; pairing is checked before the handler runs
+    req.method = Method::PUT;
+    resp = router.dispatch(req, ctx);
+    assert(resp && resp->status == Status::BadRequest);
+    assert(seen == "get:id=1.10&ev=1");
+
+    req.method = Method::POST;
+    assert(!router.dispatch(req, ctx));
+    req.method = Method::GET;
+    req.path = "/characteristic";
+    auto missing = router.dispatch(req, ctx);
+    assert(!missing && missing.error().code == hap::common::ErrorCode::NotFound);
+
+    std::cout << "test_router_dispatch passed" << std::endl;
+}
+
+struct CountingEndpoints {
+    int calls = 0;
+    Response handle_get(const Request&, ConnectionContext&) {
+        ++calls;
+        Response resp{Status::OK};
+        resp.set_body("static");
+        return resp;
+    }
+};
+
+void test_router_static_routes() {
+    Router router;
+    CountingEndpoints endpoints;
+    router.add_route<&CountingEndpoints::handle_get>(Method::GET, "/things", &endpoints);
+    router.add_route<&CountingEndpoints::handle_get>(Method::PUT, "/things", &endpoints, true);
+
+    Request req;
+    req.method = Method::GET;
+    req.path = "/things";
+    ConnectionContext ctx(nullptr, nullptr, 1);
+    auto resp = router.dispatch(req, ctx);
+    assert(resp && resp->status == Status::OK);
+    assert(std::string(resp->body.begin(), resp->body.end()) == "static");
+    assert(endpoints.calls == 1);
+
+    req.method = Method::PUT;
+    resp = router.dispatch(req, ctx);
+    assert(resp && resp->status == Status::BadRequest);
+    assert(endpoints.calls == 1);
+
+    // A std::function route replaces a static one for the same key
+    router.add_route(Method::GET, "/things", [](const Request&, ConnectionContext&) {
+        return Response{Status::NoContent};
+    });
+    req.method = Method::GET;
+    resp = router.dispatch(req, ctx);
+    assert(resp && resp->status == Status::NoContent);
+    assert(endpoints.calls == 1);
+
+    std::cout << "test_router_static_routes passed" << std::endl;
+}
+
+void test_request_arena() {
+    HTTPParser parser(512);
+    std::string http_req =
+        "PUT /characteristics HTTP/1.1\r\nContent-Length: 11\r\n\r\n{\"a\":12345}"
+        "GET /characteristics?id=1.10 HTTP/1.1\r\nHost: a\r\n\r\n";
+    assert(parser.feed(std::vector<uint8_t>(http_req.begin(), http_req.end())));
+
+    const char* first_path = nullptr;
+    {
+        Request req = parser.take_request();
+        assert(req.method == Method::PUT && req.body.size() == 11);
+        first_path = req.path.data();
+    }
+    parser.release_request_memory();
+
+    // The next request is built in the rewound arena, where the first one was
+    assert(parser.parse());
+    Request second = parser.take_request();
+    assert(second.path == "/characteristics" && second.query == "id=1.10");
+    assert(second.get_header("host") == "a");
+    assert(second.path.data() == first_path);
+
+    // Requests larger than the arena spill to the heap and still parse
+    std::string big_body(2000, 'x');
+    std::string big = "PUT /x HTTP/1.1\r\nContent-Length: 2000\r\n\r\n" + big_body;
+    assert(parser.feed(std::vector<uint8_t>(big.begin(), big.end())));
+    Request third = parser.take_request();
+    assert(std::string(third.body.begin(), third.body.end()) == big_body);
+
+    std::cout << "test_request_arena passed" << std::endl;
+}
+
+void test_max_request_bytes() {
+    auto feed = [](HTTPParser& parser, const std::string& text) {
+        return parser.feed(std::vector<uint8_t>(text.begin(), text.end()));
+    };
+
+    // Announced body too large
+    HTTPParser big_body;
+    big_body.set_max_request_bytes(64);
+    assert(!feed(big_body, "PUT /characteristics HTTP/1.1\r\nContent-Length: 100\r\n\r\n"));
+    assert(big_body.failed());
+
+    // Headers that never end, sent a little at a time
+    HTTPParser endless;
+    endless.set_max_request_bytes(64);
+    assert(!feed(endless, "GET / HTTP/1.1\r\n"));
+    assert(!endless.failed() && endless.has_partial_request());
+    for (int i = 0; i < 10 && !endless.failed(); ++i) {
+        assert(!feed(endless, "X-Pad: aaaa\r\n"));
+    }
+    assert(endless.failed());
+
+    // A request line without CRLF
+    HTTPParser no_crlf;
+    no_crlf.set_max_request_bytes(64);
+    assert(!feed(no_crlf, std::string(80, 'G')));
+    assert(no_crlf.failed());
+    no_crlf.reset();
+    assert(!no_crlf.failed() && !no_crlf.has_partial_request());
+
+    // Within the limit, pipelined requests are counted one at a time
+    HTTPParser ok;
+    ok.set_max_request_bytes(64);
+    assert(feed(ok, "PUT /x HTTP/1.1\r\nContent-Length: 2\r\n\r\n{}GET /y HTTP/1.1\r\n\r\n"));
+    assert(ok.take_request().path == "/x");
+    assert(ok.parse() && ok.take_request().path == "/y");
+    assert(!ok.failed() && !ok.has_partial_request());
+
+    std::cout << "test_max_request_bytes passed" << std::endl;
+}
+
+void test_malformed_head() {
+    auto feed = [](HTTPParser& parser, const std::string& text) {
+        return parser.feed(std::vector<uint8_t>(text.begin(), text.end()));
+    };
+
+    for (const char* length : {"abc", "12x", "99999999999999999999999", "-1"}) {
+        HTTPParser parser;
+        assert(!feed(parser, std::string("PUT /x HTTP/1.1\r\nContent-Length: ") + length + "\r\n\r\n"));
+        assert(parser.failed() && parser.malformed());
+    }
+
+    // A Content-Length past the header limit is not silently lost
+    std::string head = "PUT /x HTTP/1.1\r\n";
+    for (size_t i = 0; i < HeaderList::kMaxFields; ++i) head += "X-Pad-" + std::to_string(i) + ": a\r\n";
+    HTTPParser parser;
+    assert(!feed(parser, head + "Content-Length: 2\r\n\r\n{}"));
+    assert(parser.failed() && parser.malformed());
+    parser.reset();
+    assert(!parser.failed() && !parser.malformed());
+
+    // Size-limit failures are not malformed
+    HTTPParser big;
+    big.set_max_request_bytes(64);
+    assert(!feed(big, "PUT /x HTTP/1.1\r\nContent-Length: 100\r\n\r\n"));
+    assert(big.failed() && !big.malformed());
+
+    std::cout << "test_malformed_head passed" << std::endl;
+}
+
 int main() {
     test_simple_request();
     test_post_with_body();
     test_chunked_parsing();
+    test_receive_buffer_partial_body();
+    test_pipelined_requests();
+    test_header_lookup();
     test_response_builder();
+    test_router_dispatch();
+    test_router_static_routes();
+    test_request_arena();
+    test_max_request_bytes();
+    test_malformed_head();
     return 0;
 }
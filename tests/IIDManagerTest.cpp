@@ -0,0 +1,147 @@
+#include "hap/core/IIDManager.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace hap;
+using namespace hap::core;
+using Key = IIDManager::Key;
+
+void test_journal_round_trip() {
+    mock::MockStorage storage;
+    uint16_t light, on;
+    {
+        IIDManager manager(&storage, nullptr);
+        light = manager.get_or_assign(Key::service(1, 0x43));
+        on = manager.get_or_assign(Key::characteristic(1, 0x43, 0x25));
+        assert(manager.get_or_assign(Key::service(1, 0x43)) == light);
+        assert(light != on);
+        manager.save();
+        
+        // Only the journal is written until compaction
+        assert(storage.has("iid_journal"));
+        assert(!storage.has("iid_snapshot"));
+        
+        // A large AID needs a multi-byte varint
+        manager.get_or_assign(Key::service(300000, 0x3E));
+        manager.save();
+    }
+    
+    IIDManager reloaded(&storage, nullptr);
+    assert(reloaded.journal_size() == 3);
+    assert(reloaded.get_or_assign(Key::service(1, 0x43)) == light);
+    assert(reloaded.get_or_assign(Key::characteristic(1, 0x43, 0x25)) == on);
+    assert(reloaded.get_or_assign(Key::service(300000, 0x3E)) == 3);
+    assert(reloaded.get_next_iid() == 4);
+    
+    std::cout << "test_journal_round_trip passed" << std::endl;
+}
+
+void test_compaction() {
+    mock::MockStorage storage;
+    {
+        IIDManager manager(&storage, nullptr);
+        for (uint64_t aid = 1; aid <= IIDManager::kCompactThreshold; ++aid) {
+            manager.get_or_assign(Key::service(aid, 0x3E));
+            manager.save();
+        }
+        
+        // The last save folded the journal into the snapshot
+        assert(storage.has("iid_snapshot"));
+        assert(!storage.has("iid_journal"));
+        assert(manager.journal_size() == 0);
+        
+        manager.get_or_assign(Key::service(1000, 0x3E));
+        manager.save();
+        assert(storage.get("iid_journal")->size() < 16);
+    }
+    
+    IIDManager reloaded(&storage, nullptr);
+    for (uint64_t aid = 1; aid <= IIDManager::kCompactThreshold; ++aid) {
+        assert(reloaded.get_or_assign(Key::service(aid, 0x3E)) == aid);
+    }
+    assert(reloaded.get_or_assign(Key::service(1000, 0x3E)) == IIDManager::kCompactThreshold + 1);
+    
+    std::cout << "test_compaction passed" << std::endl;
+}
+
+void test_interrupted_compaction() {
+    mock::MockStorage storage;
+    {
+        IIDManager manager(&storage, nullptr);
+        manager.get_or_assign(Key::service(1, 0x3E));
+        manager.save();
+    }
+    auto stale_journal = *storage.get("iid_journal");
+    {
+        IIDManager manager(&storage, nullptr);
+        manager.get_or_assign(Key::service(2, 0x3E));
+        manager.compact();
+    }
+    
+    // Journal removal was lost: stale records must not rewind next_iid.
+    // A torn trailing record is ignored.
+    stale_journal.push_back(0x01);
+    stale_journal.push_back(0x3E);
+    storage.set("iid_journal", stale_journal);
+    
+    IIDManager reloaded(&storage, nullptr);
+    assert(reloaded.get_next_iid() == 3);
+    assert(reloaded.journal_size() == 1);
+    assert(reloaded.get_or_assign(Key::service(3, 0x3E)) == 3);
+    
+    std::cout << "test_interrupted_compaction passed" << std::endl;
+}
+
+void test_legacy_migration() {
+    mock::MockStorage storage;
+    std::string legacy =
+        "BLE:C:004C:0055=2\n"
+        "BLE:S:0055=1\n"
+        "C:0025:0043:17=9\n"
+        "S:0043:17=8\n";
+    storage.set("iid_map", std::vector<uint8_t>(legacy.begin(), legacy.end()));
+    storage.set("iid_next", std::vector<uint8_t>{10, 0});
+    
+    {
+        IIDManager manager(&storage, nullptr);
+        assert(manager.get_or_assign(Key::ble_service(0x55)) == 1);
+        assert(manager.get_or_assign(Key::ble_characteristic(0x55, 0x4C)) == 2);
+        assert(manager.get_or_assign(Key::service(17, 0x43)) == 8);
+        assert(manager.get_or_assign(Key::characteristic(17, 0x43, 0x25)) == 9);
+        assert(manager.get_next_iid() == 10);
+        manager.save();
+    }
+    assert(!storage.has("iid_map"));
+    assert(!storage.has("iid_next"));
+    assert(storage.has("iid_snapshot"));
+    
+    IIDManager reloaded(&storage, nullptr);
+    assert(reloaded.get_or_assign(Key::characteristic(17, 0x43, 0x25)) == 9);
+    assert(reloaded.get_next_iid() == 10);
+    
+    std::cout << "test_legacy_migration passed" << std::endl;
+}
+
+void test_reset() {
+    mock::MockStorage storage;
+    IIDManager manager(&storage, nullptr);
+    manager.get_or_assign(Key::service(1, 0x3E));
+    manager.save();
+    manager.reset();
+    assert(storage.size() == 0);
+    assert(manager.get_or_assign(Key::service(2, 0x3E)) == 1);
+    
+    std::cout << "test_reset passed" << std::endl;
+}
+
+int main() {
+    test_journal_round_trip();
+    test_compaction();
+    test_interrupted_compaction();
+    test_legacy_migration();
+    test_reset();
+    std::cout << "All IIDManager tests passed" << std::endl;
+    return 0;
+}
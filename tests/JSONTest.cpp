@@ -2,6 +2,7 @@
 #include "hap/core/Accessory.hpp"
 #include "hap/core/Service.hpp"
 #include "hap/core/Characteristic.hpp"
+#include "hap/core/JSONWriter.hpp"
 #include <nlohmann/json.hpp>
 #include <iostream>
 #include <cassert>
@@ -42,7 +43,8 @@ void test_characteristic_json() {
     assert(svc_json["characteristics"].size() == 1);
     
     auto& char_json = svc_json["characteristics"][0];
-    assert(char_json["iid"] == 1);
+    // IIDs are reassigned on add and are unique within the accessory
+    assert(char_json["iid"] == 2);
     assert(char_json["format"] == "string");
     assert(char_json["value"] == "Test Device");
     assert(char_json["perms"].size() == 1);
@@ -95,8 +97,99 @@ void test_multi_accessory_json() {
     std::cout << "test_multi_accessory_json passed" << std::endl;
 }
 
+void test_cached_json_matches() {
+    AttributeDatabase db;
+    auto acc = std::make_shared<Accessory>(1);
+    auto svc = std::make_shared<Service>(0x43, "Lightbulb");
+
+    auto on_char = std::make_shared<Characteristic>(0x25, Format::Bool, std::vector{Permission::PairedRead, Permission::Notify});
+    on_char->set_value(false);
+    svc->add_characteristic(on_char);
+
+    auto brightness = std::make_shared<Characteristic>(0x08, Format::Int, std::vector{Permission::PairedRead, Permission::PairedWrite});
+    brightness->set_value(int32_t(10));
+    brightness->set_min_value(0);
+    brightness->set_max_value(100);
+    brightness->set_unit("percentage");
+    svc->add_characteristic(brightness);
+
+    auto write_only = std::make_shared<Characteristic>(0x26, Format::String, std::vector{Permission::PairedWrite});
+    write_only->set_description("contains \"value\":\"\u0001\"");
+    svc->add_characteristic(write_only);
+
+    auto data_char = std::make_shared<Characteristic>(0x114, Format::Data, std::vector{Permission::PairedRead});
+    data_char->set_value(std::vector<uint8_t>{0xDE, 0xAD, 0xBE, 0xEF});
+    svc->add_characteristic(data_char);
+
+    acc->add_service(svc);
+    db.add_accessory(acc);
+
+    assert(db.to_cached_json_string() == db.to_json_string());
+
+    // Value changes are picked up without invalidating the template
+    on_char->set_value(true);
+    brightness->set_value(int32_t(75));
+    std::string cached = db.to_cached_json_string();
+    assert(cached == db.to_json_string());
+    assert(json::parse(cached)["accessories"][0]["services"][0]["characteristics"][1]["value"] == 75);
+
+    // Metadata is part of the template and needs an explicit invalidation
+    brightness->set_max_value(50);
+    assert(db.to_cached_json_string() != db.to_json_string());
+    db.invalidate_json_cache();
+    assert(db.to_cached_json_string() == db.to_json_string());
+
+    std::cout << "test_cached_json_matches passed" << std::endl;
+}
+
+void test_json_writer() {
+    std::vector<uint8_t> out;
+    JSONWriter w(out);
+    w.begin_object();
+    w.key("characteristics");
+    w.begin_array();
+    for (int i = 0; i < 2; ++i) {
+        w.begin_object();
+        w.key("aid");
+        w.value(uint64_t(1));
+        w.key("iid");
+        w.value(uint64_t(10 + i));
+        w.key("status");
+        w.value(int32_t(-70409));
+        w.end_object();
+    }
+    w.end_array();
+    w.key("s");
+    w.value("quote\" slash\\ ctl\x01\n");
+    w.key("v");
+    w.value(Value(std::vector<uint8_t>{0x01, 0x02, 0x03}));
+    w.key("f");
+    w.value(Value(0.5f));
+    w.key("b");
+    w.value(Value(true));
+    w.key("u8");
+    w.value(Value(uint8_t(200)));
+    w.end_object();
+
+    std::string text(out.begin(), out.end());
+    assert(text.rfind("{\"characteristics\":[{\"aid\":1,\"iid\":10,\"status\":-70409},{", 0) == 0);
+
+    auto j = json::parse(text);
+    assert(j["characteristics"].size() == 2);
+    assert(j["characteristics"][1]["iid"] == 11);
+    assert(j["s"] == "quote\" slash\\ ctl\x01\n");
+    assert(j["v"] == "AQID");
+    assert(j["f"] == 0.5);
+    assert(j["b"] == true);
+    assert(j["u8"] == 200);
+
+    std::cout << "test_json_writer passed" << std::endl;
+}
+
 int main() {
+    test_json_writer();
     test_characteristic_json();
     test_multi_accessory_json();
+    test_cached_json_matches();
     return 0;
 }
@@ -0,0 +1,69 @@
+#include "hap/common/Log.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace hap;
+
+class RecordingSystem : public platform::System {
+public:
+    LogLevel level = LogLevel::Debug;
+    std::vector<std::string> messages;
+    uint64_t millis() override { return 0; }
+    void random_bytes(std::span<uint8_t> buffer) override { std::fill(buffer.begin(), buffer.end(), 0); }
+    void log(LogLevel, std::string_view message) override { messages.emplace_back(message); }
+    LogLevel log_level() const override { return level; }
+};
+
+// Counts evaluations so the test can tell whether a message was built
+static int formatted = 0;
+static std::string message(const char* text) {
+    ++formatted;
+    return text;
+}
+
+void test_runtime_level_skips_formatting() {
+    RecordingSystem system;
+    system.level = platform::System::LogLevel::Warning;
+    RecordingSystem* sys = &system;
+    formatted = 0;
+
+    HAP_LOG_DEBUG(sys, message("debug"));
+    HAP_LOG_INFO(sys, message("info"));
+    assert(formatted == 0);
+    assert(system.messages.empty());
+
+    HAP_LOG_WARNING(sys, message("warning"));
+    HAP_LOG_ERROR(sys, message("error"));
+    assert(formatted == 2);
+    assert(system.messages.size() == 2);
+    assert(system.messages[0] == "warning");
+    assert(!HAP_LOG_ENABLED(sys, Info));
+    assert(HAP_LOG_ENABLED(sys, Error));
+    std::cout << "test_runtime_level_skips_formatting passed" << std::endl;
+}
+
+void test_compile_time_floor() {
+    RecordingSystem system;  // Platform accepts everything
+    RecordingSystem* sys = &system;
+    formatted = 0;
+
+    HAP_LOG_DEBUG(sys, message("debug"));
+    HAP_LOG_INFO(sys, message("info"));
+    HAP_LOG_ERROR(sys, message("error"));
+
+    // Levels below HAP_LOG_LEVEL never reach the platform or get formatted
+    const int expected = (HAP_LOG_LEVEL <= 0) + (HAP_LOG_LEVEL <= 1) + (HAP_LOG_LEVEL <= 3);
+    assert(formatted == expected);
+    assert(static_cast<int>(system.messages.size()) == expected);
+    std::cout << "test_compile_time_floor passed" << std::endl;
+}
+
+int main() {
+    test_runtime_level_skips_formatting();
+    test_compile_time_floor();
+    std::cout << "All Log tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "hap/common/Metrics.hpp"
+#include "hap/common/TaskScheduler.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace hap;
+using namespace hap::common;
+
+void test_histogram() {
+    Metrics metrics(true);
+    metrics.record(Metric::Handler, 0);
+    metrics.record(Metric::Handler, 1);
+    metrics.record(Metric::Handler, 3);
+    metrics.record(Metric::Handler, 100);
+    metrics.record(Metric::Handler, 1000000000);  // Lands in the overflow bucket
+
+    auto snap = metrics.snapshot();
+    const auto& stats = snap[Metric::Handler];
+    assert(stats.count == 5);
+    assert(stats.max_us == 1000000000);
+    assert(stats.buckets[0] == 1);  // 0
+    assert(stats.buckets[1] == 1);  // 1
+    assert(stats.buckets[2] == 1);  // 2..3
+    assert(stats.buckets[7] == 1);  // 64..127
+    assert(stats.buckets[LatencyStats::BUCKETS - 1] == 1);
+    assert(stats.percentile_us(50) == 3);
+    assert(stats.percentile_us(80) == 127);
+    assert(stats.percentile_us(100) == 1000000000);
+    assert(snap[Metric::Encrypt].count == 0);
+
+    metrics.reset();
+    assert(metrics.snapshot()[Metric::Handler].count == 0);
+    std::cout << "test_histogram passed" << std::endl;
+}
+
+void test_disabled_and_hook() {
+    std::vector<Metric> traced;
+    Metrics metrics(false, [&](Metric metric, uint64_t) { traced.push_back(metric); });
+
+    { Metrics::Scope timer(&metrics, Metric::Decrypt); }
+    { Metrics::Scope timer(nullptr, Metric::Decrypt); }
+    count(&metrics, Counter::BytesDecrypted, 10);
+    assert(metrics.snapshot()[Metric::Decrypt].count == 0);
+    assert(metrics.snapshot()[Counter::BytesDecrypted] == 0);
+    assert(traced.empty());
+
+    metrics.set_enabled(true);
+    {
+        Metrics::Scope timer(&metrics, Metric::Decrypt);
+        timer.stop();
+        timer.stop();  // Recorded once
+    }
+    count(&metrics, Counter::BytesDecrypted, 10);
+    assert(metrics.snapshot()[Metric::Decrypt].count == 1);
+    assert(metrics.snapshot()[Counter::BytesDecrypted] == 10);
+    assert(traced.size() == 1 && traced[0] == Metric::Decrypt);
+    std::cout << "test_disabled_and_hook passed" << std::endl;
+}
+
+void test_scheduler_lag() {
+    mock::MockSystem system;
+    Metrics metrics(true);
+    TaskScheduler scheduler(&system, &metrics);
+
+    scheduler.schedule_once(10, [] {});
+    scheduler.tick(25);  // 15 ms late
+
+    const auto& lag = metrics.snapshot()[Metric::SchedulerLag];
+    assert(lag.count == 1);
+    assert(lag.max_us == 15000);
+    std::cout << "test_scheduler_lag passed" << std::endl;
+}
+
+int main() {
+    test_histogram();
+    test_disabled_and_hook();
+    test_scheduler_lag();
+    std::cout << "All Metrics tests passed!" << std::endl;
+    return 0;
+}
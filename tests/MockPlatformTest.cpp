@@ -0,0 +1,173 @@
+#include "hap/mock/MockBle.hpp"
+#include "hap/mock/MockNetwork.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace hap;
+using namespace hap::mock;
+
+void test_network_loopback() {
+    MockNetwork network;
+    std::string received;
+    std::vector<uint32_t> closed;
+    network.deliver(1, "dropped before listen");
+
+    network.tcp_listen(8080,
+        [&](uint32_t id, std::span<const uint8_t> data) {
+            received.assign(data.begin(), data.end());
+            std::array<uint8_t, 2> a = {'o', 'k'};
+            std::array<uint8_t, 1> b = {'!'};
+            std::array<std::span<const uint8_t>, 2> parts = {a, b};
+            network.tcp_send_vectored(id, parts);
+        },
+        [&](uint32_t id) { closed.push_back(id); });
+    assert(network.listening() && network.port() == 8080);
+
+    network.deliver(7, "ping");
+    assert(received == "ping");
+    auto sent = network.take_sent(7);
+    assert(std::string(sent.begin(), sent.end()) == "ok!");
+    assert(network.take_sent(7).empty());
+    assert(network.sent_bytes(7) == 3 && network.send_calls(7) == 1);
+
+    // Counting only
+    network.set_capture(false);
+    network.deliver(7, "ping");
+    assert(network.take_sent(7).empty());
+    assert(network.sent_bytes(7) == 6);
+
+    network.set_writable(7, false);
+    assert(!network.tcp_can_send(7));
+    assert(network.tcp_can_send(8));
+
+    network.tcp_disconnect(7);
+    assert(network.closed_by_server(7));
+    network.close(7);
+    assert(closed == std::vector<uint32_t>{7});
+    assert(network.sent_bytes(7) == 0);
+
+    platform::Network::MdnsService service{"Light", "_hap._tcp", 8080, {{"c#", "1"}}};
+    network.mdns_register(service);
+    service.txt_records[0].second = "2";
+    network.mdns_update_txt_record(service);
+    assert(network.mdns_registrations() == 1 && network.mdns_updates() == 1);
+    assert(network.mdns_record().name == "Light");
+    assert(network.mdns_record().txt_records[0].second == "2");
+    std::cout << "test_network_loopback passed" << std::endl;
+}
+
+void test_ble_central() {
+    MockBle ble;
+    std::vector<uint8_t> written;
+    std::vector<uint16_t> disconnected;
+    uint16_t mtu = 0;
+
+    platform::Ble::CharacteristicDefinition ch;
+    ch.uuid = "0025";
+    ch.on_write = [&](uint16_t conn, std::span<const uint8_t> data, bool) {
+        written.assign(data.begin(), data.end());
+        ble.send_indication(conn, "0025", {});
+    };
+    ch.on_read = [](uint16_t) { return std::vector<uint8_t>{0x2A}; };
+    platform::Ble::DescriptorDefinition desc;
+    desc.uuid = "iid";
+    ch.descriptors.push_back(desc);
+    ble.register_service({"0043", true, {ch}, {}});
+    ble.set_disconnect_callback([&](uint16_t conn) { disconnected.push_back(conn); });
+    ble.set_mtu_callback([&](uint16_t, uint16_t value) { mtu = value; });
+    uint16_t confirmed = 0;
+    assert(ble.set_indication_confirm_callback([&](uint16_t conn) { confirmed = conn; }));
+
+    assert(ble.find_characteristic("0025"));
+    assert(!ble.find_characteristic("0026"));
+    assert(ble.find_descriptor("0025", "iid"));
+
+    ble.connect(1);
+    assert(ble.has_connections());
+    ble.negotiate_mtu(1, 185);
+    assert(mtu == 185);
+
+    std::array<uint8_t, 2> pdu = {0x00, 0x03};
+    assert(ble.write(1, "0025", pdu));
+    assert(written.size() == 2);
+    assert(ble.read(1, "0025") == std::vector<uint8_t>{0x2A});
+    assert(!ble.read(1, "0026"));
+    assert(!ble.subscribe(1, "0025"));  // No subscribe callback registered
+
+    auto indications = ble.take_indications();
+    assert(indications.size() == 1 && indications[0].connection_id == 1);
+    ble.set_accept_indications(false);
+    assert(!ble.send_indication(1, "0025", {}));
+    assert(ble.indication_count() == 1);
+    ble.confirm_indication(1);
+    assert(confirmed == 1);
+
+    platform::Ble::Advertisement adv;
+    adv.local_name = "Light";
+    ble.start_timed_advertising(adv, 20, 3000, 1000);
+    assert(ble.advertising() && ble.advertising_interval() == 20);
+    assert(ble.advertisement() == adv);
+    ble.stop_advertising();
+    assert(!ble.advertising());
+
+    ble.disconnect(1);
+    assert(disconnected == std::vector<uint16_t>{1});
+    assert(ble.disconnected_by_server() == std::vector<uint16_t>{1});
+    ble.disconnect(1);  // Already gone: no second callback
+    assert(disconnected.size() == 1);
+    assert(!ble.has_connections());
+    std::cout << "test_ble_central passed" << std::endl;
+}
+
+void test_storage() {
+    MockStorage storage;
+    std::array<uint8_t, 3> value = {1, 2, 3};
+    storage.set("key", value);
+    assert(storage.has("key"));
+    assert(storage.get("key")->size() == 3);
+    storage.begin_batch();
+    storage.remove("key");
+    storage.commit_batch();
+    assert(!storage.has("key") && !storage.get("key"));
+    assert(storage.writes() == 2 && storage.commits() == 1);
+    std::cout << "test_storage passed" << std::endl;
+}
+
+void test_system_is_deterministic() {
+    MockSystem a, b;
+    assert(a.millis() == 0);
+    a.advance(250);
+    a.advance(250);
+    assert(a.millis() == 500);
+    a.set_time(42);
+    assert(a.millis() == 42);
+
+    std::array<uint8_t, 13> ra{}, rb{};
+    a.random_bytes(ra);
+    b.random_bytes(rb);
+    assert(ra == rb);
+    a.random_bytes(ra);
+    assert(ra != rb);
+
+    assert(a.log_level() == platform::System::LogLevel::Error);
+    a.set_capture_logs(true);
+    a.log(platform::System::LogLevel::Info, "dropped");
+    a.log(platform::System::LogLevel::Error, "kept");
+    assert(a.take_logs() == std::vector<std::string>{"kept"});
+    assert(!a.min_free_heap());
+    std::cout << "test_system_is_deterministic passed" << std::endl;
+}
+
+int main() {
+    test_network_loopback();
+    test_ble_central();
+    test_storage();
+    test_system_is_deterministic();
+    std::cout << "All MockPlatform tests passed!" << std::endl;
+    return 0;
+}
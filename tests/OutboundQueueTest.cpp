@@ -0,0 +1,94 @@
+#include "hap/transport/OutboundQueue.hpp"
+#include <cassert>
+#include <iostream>
+
+using namespace hap::transport;
+
+static OutboundQueue::Message make(OutboundQueue::Priority priority, size_t size, uint8_t tag) {
+    OutboundQueue::Message message;
+    message.priority = priority;
+    message.body.assign(size, tag);
+    return message;
+}
+
+void test_responses_first() {
+    OutboundQueue queue;
+    queue.push(make(OutboundQueue::Priority::Event, 10, 1));
+    queue.push(make(OutboundQueue::Priority::Response, 10, 2));
+    queue.push(make(OutboundQueue::Priority::Event, 10, 3));
+    assert(queue.stats().depth == 3);
+    assert(queue.stats().queued_bytes == 30);
+
+    assert(queue.front()->body[0] == 2);
+    queue.pop();
+    assert(queue.front()->body[0] == 1);
+    queue.pop();
+    assert(queue.front()->body[0] == 3);
+    queue.pop(2);
+    assert(queue.empty() && queue.front() == nullptr);
+    assert(queue.stats().sent_messages == 3);
+    assert(queue.stats().sent_events == 2);
+    assert(queue.stats().sent_bytes == 30);
+    assert(queue.stats().sealed_frames == 2);
+    assert(queue.stats().queued_bytes == 0);
+
+    std::cout << "test_responses_first passed" << std::endl;
+}
+
+void test_stale_events_dropped() {
+    OutboundQueue queue(100);
+    queue.push(make(OutboundQueue::Priority::Event, 40, 1));
+    queue.push(make(OutboundQueue::Priority::Event, 40, 2));
+    queue.push(make(OutboundQueue::Priority::Event, 40, 3));  // Evicts event 1
+    assert(queue.stats().dropped_events == 1);
+    assert(queue.front()->body[0] == 2);
+
+    // Responses are always accepted, even beyond the limit
+    queue.push(make(OutboundQueue::Priority::Response, 150, 4));
+    assert(queue.stats().depth == 3);
+    assert(queue.stats().high_water_bytes == 230);
+
+    // No room left next to the response: older events go, then the new one
+    queue.push(make(OutboundQueue::Priority::Event, 10, 5));
+    assert(queue.stats().dropped_events == 4);
+    assert(queue.stats().depth == 1);
+    assert(queue.front()->body[0] == 4);
+
+    std::cout << "test_stale_events_dropped passed" << std::endl;
+}
+
+void test_superseded_events_replaced() {
+    auto event = [](uint8_t tag, std::vector<uint64_t> keys) {
+        auto message = make(OutboundQueue::Priority::Event, 40, tag);
+        message.keys = std::move(keys);
+        return message;
+    };
+    OutboundQueue queue(100);
+    queue.push(event(1, {10}));
+    queue.push(event(2, {11}));
+    queue.push(event(3, {10}));  // Replaces event 1, not the only update for 11
+    assert(queue.stats().replaced_events == 1);
+    assert(queue.stats().dropped_events == 0);
+    assert(queue.front()->body[0] == 2);
+    queue.pop();
+    assert(queue.front()->body[0] == 3);
+
+    // An event carrying more characteristics is only replaced by one with all of them
+    queue.push(event(4, {10, 11}));
+    queue.push(event(5, {11}));  // Falls back to dropping the oldest (3)
+    assert(queue.stats().replaced_events == 1);
+    assert(queue.stats().dropped_events == 1);
+    queue.push(event(6, {10, 11, 12}));  // Supersedes both 4 and 5
+    assert(queue.stats().replaced_events == 3);
+    assert(queue.stats().depth == 1 && queue.front()->body[0] == 6);
+    assert(queue.stats().queued_bytes == 40);
+
+    std::cout << "test_superseded_events_replaced passed" << std::endl;
+}
+
+int main() {
+    test_responses_first();
+    test_stale_events_dropped();
+    test_superseded_events_replaced();
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include "hap/pairing/PairVerify.hpp"
+#include "hap/common/StreamHash.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace hap;
+using namespace hap::pairing;
+
+// Deterministic stand-ins: HKDF is a keyed hash, the AEAD XORs with the key
+// and tags with key ^ nonce. Counts the asymmetric operations.
+class ToyCrypto : public platform::Crypto {
+public:
+    int x25519_ops = 0;
+    int ed25519_ops = 0;
+
+    void sha512(std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
+    void hkdf_sha512(std::span<const uint8_t> key, std::span<const uint8_t> salt,
+                     std::span<const uint8_t> info, std::span<uint8_t> output) override {
+        for (size_t i = 0; i < output.size(); ++i) {
+            common::StreamHash hash;
+            hash.update(key).update(salt).update(info).update(static_cast<uint64_t>(i));
+            output[i] = static_cast<uint8_t>(hash.digest());
+        }
+    }
+    void ed25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 64>) override {}
+    void ed25519_sign(std::span<const uint8_t, 64>, std::span<const uint8_t>,
+                      std::span<uint8_t, 64> signature) override {
+        ++ed25519_ops;
+        std::fill(signature.begin(), signature.end(), 0x5A);
+    }
+    bool ed25519_verify(std::span<const uint8_t, 32>, std::span<const uint8_t>,
+                        std::span<const uint8_t, 64>) override {
+        ++ed25519_ops;
+        return true;
+    }
+    void x25519_generate_keypair(std::span<uint8_t, 32> public_key, std::span<uint8_t, 32> private_key) override {
+        ++x25519_ops;
+        std::fill(public_key.begin(), public_key.end(), 0xA1);
+        std::fill(private_key.begin(), private_key.end(), 0xA2);
+    }
+    void x25519_shared_secret(std::span<const uint8_t, 32> private_key, std::span<const uint8_t, 32> peer,
+                              std::span<uint8_t, 32> shared_secret) override {
+        ++x25519_ops;
+        for (size_t i = 0; i < 32; ++i) shared_secret[i] = private_key[i] ^ peer[i];
+    }
+
+    bool chacha20_poly1305_encrypt_and_tag(std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+                                           std::span<const uint8_t>, std::span<const uint8_t> plaintext,
+                                           std::span<uint8_t> ciphertext, std::span<uint8_t, 16> tag) override {
+        for (size_t i = 0; i < plaintext.size(); ++i) ciphertext[i] = plaintext[i] ^ key[0];
+        for (size_t i = 0; i < 16; ++i) tag[i] = key[i] ^ nonce[i % 12];
+        return true;
+    }
+    bool chacha20_poly1305_decrypt_and_verify(std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+                                              std::span<const uint8_t>, std::span<const uint8_t> ciphertext,
+                                              std::span<const uint8_t, 16> tag, std::span<uint8_t> plaintext) override {
+        for (size_t i = 0; i < 16; ++i) {
+            if (tag[i] != (key[i] ^ nonce[i % 12])) return false;
+        }
+        for (size_t i = 0; i < ciphertext.size(); ++i) plaintext[i] = ciphertext[i] ^ key[0];
+        return true;
+    }
+};
+
+static const std::string kController = "controller-1";
+
+static platform::Storage* paired(mock::MockStorage& storage) {
+    storage.set("accessory_ltsk", std::vector<uint8_t>(64, 0x01));
+    storage.set("accessory_ltpk", std::vector<uint8_t>(32, 0x02));
+    storage.set("pairing_" + kController, std::vector<uint8_t>(32, 0x03));
+    std::string list = "[\"" + kController + "\"]";
+    storage.set("pairing_list", std::vector<uint8_t>(list.begin(), list.end()));
+    return &storage;
+}
+
+struct Fixture {
+    ToyCrypto crypto;
+    mock::MockSystem system;
+    mock::MockStorage storage;
+    PairingStore pairings{paired(storage)};
+    SessionCache cache{&system};
+
+    PairVerify make_verify() {
+        return PairVerify({&crypto, &pairings, "AA:BB:CC:DD:EE:FF", &cache, &system});
+    }
+};
+
+static std::array<uint8_t, 12> nonce_of(const char (&tag)[9]) {
+    std::array<uint8_t, 12> nonce = {};
+    std::copy_n(tag, 8, nonce.begin() + 4);
+    return nonce;
+}
+
+template<size_t N>
+static std::span<const uint8_t> label(const char (&text)[N]) {
+    return std::span(reinterpret_cast<const uint8_t*>(text), N - 1);
+}
+
+// Full M1..M4 exchange, playing the controller with the toy primitives
+static std::array<uint8_t, 32> full_verify(Fixture& f, PairVerify& verify) {
+    std::array<uint8_t, 32> controller_public;
+    controller_public.fill(0xC0);
+
+    std::vector<core::TLV> m1;
+    m1.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M1));
+    m1.emplace_back(static_cast<uint8_t>(TLVType::PublicKey), std::span(controller_public));
+    auto m2 = verify.handle_request(core::TLV8::encode(m1));
+    assert(m2);
+    assert(core::TLV8::find(core::TLV8::parse(*m2), static_cast<uint8_t>(TLVType::PublicKey)));
+
+    std::array<uint8_t, 32> shared = verify.get_shared_secret();
+    std::array<uint8_t, 32> session_key;
+    f.crypto.hkdf_sha512(shared, label("Pair-Verify-Encrypt-Salt"), label("Pair-Verify-Encrypt-Info"), session_key);
+
+    std::vector<core::TLV> sub;
+    sub.emplace_back(static_cast<uint8_t>(TLVType::Identifier), kController);
+    sub.emplace_back(static_cast<uint8_t>(TLVType::Signature), std::vector<uint8_t>(64, 0x77));
+    auto plain = core::TLV8::encode(sub);
+    std::vector<uint8_t> encrypted(plain.size());
+    std::array<uint8_t, 16> tag;
+    f.crypto.chacha20_poly1305_encrypt_and_tag(session_key, nonce_of("PV-Msg03"), {}, plain, encrypted, tag);
+    encrypted.insert(encrypted.end(), tag.begin(), tag.end());
+
+    std::vector<core::TLV> m3;
+    m3.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M3));
+    m3.emplace_back(static_cast<uint8_t>(TLVType::EncryptedData), encrypted);
+    auto m4 = verify.handle_request(core::TLV8::encode(m3));
+    assert(m4 && verify.is_verified() && !verify.is_resumed());
+    return shared;
+}
+
+static std::vector<uint8_t> resume_request(Fixture& f, const std::array<uint8_t, 32>& shared,
+                                           const SessionCache::SessionId& session_id) {
+    std::array<uint8_t, 32> controller_public;
+    controller_public.fill(0xC1);
+    std::array<uint8_t, 40> salt;
+    std::copy_n(controller_public.begin(), 32, salt.begin());
+    std::copy_n(session_id.begin(), 8, salt.begin() + 32);
+
+    std::array<uint8_t, 32> request_key;
+    f.crypto.hkdf_sha512(shared, salt, label("Pair-Resume-Request-Info"), request_key);
+    std::array<uint8_t, 16> tag;
+    f.crypto.chacha20_poly1305_encrypt_and_tag(request_key, nonce_of("PR-Msg01"), {}, {}, {}, tag);
+
+    std::vector<core::TLV> m1;
+    m1.emplace_back(static_cast<uint8_t>(TLVType::State), static_cast<uint8_t>(PairingState::M1));
+    m1.emplace_back(static_cast<uint8_t>(TLVType::Method), static_cast<uint8_t>(PairingMethod::PairResume));
+    m1.emplace_back(static_cast<uint8_t>(TLVType::PublicKey), std::span(controller_public));
+    m1.emplace_back(static_cast<uint8_t>(TLVType::SessionID), std::span(session_id));
+    m1.emplace_back(static_cast<uint8_t>(TLVType::EncryptedData), std::span(tag));
+    return core::TLV8::encode(m1);
+}
+
+static SessionCache::SessionId verified_session_id(ToyCrypto& crypto, const std::array<uint8_t, 32>& shared) {
+    SessionCache::SessionId id;
+    crypto.hkdf_sha512(shared, label("Pair-Verify-ResumeSessionID-Salt"), label("Pair-Verify-ResumeSessionID-Info"), id);
+    return id;
+}
+
+void test_resume_skips_asymmetric_crypto() {
+    Fixture f;
+    auto first = f.make_verify();
+    auto shared = full_verify(f, first);
+    assert(f.cache.size() == 1);
+    auto [a_key, c_key] = first.get_session_keys();
+
+    f.crypto.x25519_ops = f.crypto.ed25519_ops = 0;
+    auto second = f.make_verify();
+    auto m2 = second.handle_request(resume_request(f, shared, verified_session_id(f.crypto, shared)));
+    assert(m2 && second.is_verified() && second.is_resumed());
+    assert(f.crypto.x25519_ops == 0 && f.crypto.ed25519_ops == 0);
+    assert(second.get_controller_id() == kController);
+
+    // Fresh keys, and the new session replaces the consumed one
+    auto [a_key2, c_key2] = second.get_session_keys();
+    assert(a_key2 != a_key && c_key2 != c_key);
+    assert(f.cache.size() == 1);
+
+    auto response = core::TLV8::parse(*m2);
+    auto new_id = core::TLV8::find(response, static_cast<uint8_t>(TLVType::SessionID));
+    assert(new_id && new_id->size() == 8);
+
+    // The old ID is single-use: replaying it falls back to a full verify
+    auto replay = f.make_verify();
+    auto fallback = replay.handle_request(resume_request(f, shared, verified_session_id(f.crypto, shared)));
+    assert(fallback && !replay.is_verified());
+    assert(core::TLV8::find(core::TLV8::parse(*fallback), static_cast<uint8_t>(TLVType::PublicKey)));
+
+    std::cout << "test_resume_skips_asymmetric_crypto passed" << std::endl;
+}
+
+void test_resume_rejected() {
+    Fixture f;
+    auto first = f.make_verify();
+    auto shared = full_verify(f, first);
+    auto id = verified_session_id(f.crypto, shared);
+
+    // Wrong shared secret: authentication error, and the entry is spent
+    std::array<uint8_t, 32> wrong = shared;
+    wrong[0] ^= 0xFF;
+    auto attacker = f.make_verify();
+    auto response = attacker.handle_request(resume_request(f, wrong, id));
+    assert(response && !attacker.is_verified());
+    assert(core::TLV8::find_uint8(core::TLV8::parse(*response), static_cast<uint8_t>(TLVType::Error)) ==
+           static_cast<uint8_t>(TLVError::Authentication));
+    assert(f.cache.size() == 0);
+
+    // Removed pairing: the cached session is not honoured
+    auto again = f.make_verify();
+    shared = full_verify(f, again);
+    f.pairings.remove(kController);
+    auto removed = f.make_verify();
+    removed.handle_request(resume_request(f, shared, verified_session_id(f.crypto, shared)));
+    assert(!removed.is_verified());
+
+    std::cout << "test_resume_rejected passed" << std::endl;
+}
+
+void test_cache_bounds() {
+    mock::MockSystem system;
+    SessionCache cache(&system, 2, 100);
+    std::array<uint8_t, 32> secret{};
+    cache.store({1}, secret, "a");
+    cache.store({2}, secret, "b");
+    cache.store({3}, secret, "a");  // Evicts the oldest
+    assert(cache.size() == 2);
+    assert(!cache.take({1}));
+
+    cache.remove_controller("a");
+    assert(cache.size() == 1);
+
+    system.advance(100);  // Expired
+    assert(!cache.take({2}));
+    assert(cache.size() == 0);
+
+    std::cout << "test_cache_bounds passed" << std::endl;
+}
+
+int main() {
+    test_resume_skips_asymmetric_crypto();
+    test_resume_rejected();
+    test_cache_bounds();
+    return 0;
+}
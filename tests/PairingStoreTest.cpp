@@ -0,0 +1,154 @@
+#include "hap/pairing/PairingStore.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace hap;
+using namespace hap::pairing;
+
+class KeyCrypto : public platform::Crypto {
+public:
+    int generated = 0;
+    void sha512(std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
+    void hkdf_sha512(std::span<const uint8_t>, std::span<const uint8_t>,
+                     std::span<const uint8_t>, std::span<uint8_t>) override {}
+    void ed25519_generate_keypair(std::span<uint8_t, 32> public_key, std::span<uint8_t, 64> private_key) override {
+        ++generated;
+        std::fill(public_key.begin(), public_key.end(), 0x11);
+        std::fill(private_key.begin(), private_key.end(), 0x22);
+    }
+    void ed25519_sign(std::span<const uint8_t, 64>, std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
+    bool ed25519_verify(std::span<const uint8_t, 32>, std::span<const uint8_t>,
+                        std::span<const uint8_t, 64>) override { return true; }
+    void x25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 32>) override {}
+    void x25519_shared_secret(std::span<const uint8_t, 32>, std::span<const uint8_t, 32>,
+                              std::span<uint8_t, 32>) override {}
+    bool chacha20_poly1305_encrypt_and_tag(std::span<const uint8_t, 32>, std::span<const uint8_t, 12>,
+                                           std::span<const uint8_t>, std::span<const uint8_t>,
+                                           std::span<uint8_t>, std::span<uint8_t, 16>) override { return true; }
+    bool chacha20_poly1305_decrypt_and_verify(std::span<const uint8_t, 32>, std::span<const uint8_t, 12>,
+                                              std::span<const uint8_t>, std::span<const uint8_t>,
+                                              std::span<const uint8_t, 16>, std::span<uint8_t>) override { return true; }
+};
+
+static std::array<uint8_t, 32> key_of(uint8_t value) {
+    std::array<uint8_t, 32> key;
+    key.fill(value);
+    return key;
+}
+
+void test_write_through_and_reload() {
+    mock::MockStorage storage;
+    {
+        PairingStore store(&storage);
+        assert(!store.is_paired());
+        assert(store.add("controller-a", key_of(0xAA)) == PairingStore::AddResult::Added);
+        assert(store.add("controller-b", key_of(0xBB), 0x00) == PairingStore::AddResult::Added);
+        assert(store.add("controller-a", key_of(0xAC)) == PairingStore::AddResult::Updated);
+        assert(store.size() == 2);
+    }
+
+    // A fresh store sees the same pairings, in order
+    PairingStore store(&storage);
+    auto pairings = store.list();
+    assert(pairings.size() == 2);
+    assert(pairings[0].id() == "controller-a" && pairings[0].ltpk == key_of(0xAC));
+    assert(pairings[1].id() == "controller-b");
+
+    // Lookups are served from memory
+    size_t reads = storage.reads();
+    assert(store.find("controller-b"));
+    assert(!store.find("controller-c"));
+    assert(storage.reads() == reads);
+
+    // Permissions survive a reload
+    assert(!pairings[1].is_admin());
+
+    assert(store.remove("controller-a"));
+    assert(!store.remove("controller-a"));
+    assert(store.is_paired());
+    assert(PairingStore(&storage).size() == 1);
+    assert(store.remove("controller-b"));
+    assert(!store.is_paired() && !PairingStore(&storage).is_paired());
+
+    // Everything lives in one record
+    assert(storage.size() == 1 && storage.has("pairings"));
+
+    std::cout << "test_write_through_and_reload passed" << std::endl;
+}
+
+void test_limits() {
+    mock::MockStorage storage;
+    PairingStore store(&storage);
+    assert(store.add("", key_of(1)) == PairingStore::AddResult::InvalidId);
+    assert(store.add(std::string(PairingStore::kMaxIdLength + 1, 'x'), key_of(1)) == PairingStore::AddResult::InvalidId);
+
+    for (size_t i = 0; i < PairingStore::kMaxPairings; ++i) {
+        assert(store.add("controller-" + std::to_string(i), key_of(static_cast<uint8_t>(i))) == PairingStore::AddResult::Added);
+    }
+    assert(store.add("one-too-many", key_of(0xFF)) == PairingStore::AddResult::Full);
+    assert(store.add("controller-3", key_of(0xFF)) == PairingStore::AddResult::Updated);
+
+    // Removal from the middle keeps the remaining slots packed
+    assert(store.remove("controller-0"));
+    assert(store.list().front().id() == "controller-1");
+    assert(store.add("one-too-many", key_of(0xFF)) == PairingStore::AddResult::Added);
+
+    std::cout << "test_limits passed" << std::endl;
+}
+
+void test_long_term_keys() {
+    mock::MockStorage storage;
+    KeyCrypto crypto;
+    PairingStore store(&storage);
+    assert(!store.long_term_keys());
+
+    auto keys = store.ensure_long_term_keys(crypto);
+    store.ensure_long_term_keys(crypto);
+    assert(crypto.generated == 1);
+    assert(keys.ltpk == key_of(0x11));
+    assert(PairingStore(&storage).long_term_keys()->ltsk[63] == 0x22);
+
+    store.add("controller-a", key_of(0xAA));
+    store.clear();
+    assert(!store.is_paired() && !store.long_term_keys());
+    assert(storage.size() == 0);
+
+    std::cout << "test_long_term_keys passed" << std::endl;
+}
+
+void test_legacy_migration() {
+    mock::MockStorage storage;
+    std::string list = "[\"controller-a\",\"controller-b\",\"missing\"]";
+    storage.set("pairing_list", std::vector<uint8_t>(list.begin(), list.end()));
+    storage.set("pairing_controller-a", std::vector<uint8_t>(32, 0xAA));
+    storage.set("pairing_controller-b", std::vector<uint8_t>(32, 0xBB));
+
+    PairingStore store(&storage);
+    assert(store.size() == 2 && store.is_paired());
+    assert(store.find("controller-b")->ltpk == key_of(0xBB));
+    assert(store.find("controller-a")->is_admin());
+
+    // Legacy keys are replaced by the binary record
+    assert(!storage.has("pairing_list"));
+    assert(!storage.has("pairing_controller-a"));
+    assert(PairingStore(&storage).size() == 2);
+
+    // A torn record keeps the pairings before it
+    auto record = *storage.get("pairings");
+    record.resize(record.size() - 1);
+    storage.set("pairings", record);
+    assert(PairingStore(&storage).size() == 1);
+
+    std::cout << "test_legacy_migration passed" << std::endl;
+}
+
+int main() {
+    test_write_through_and_reload();
+    test_limits();
+    test_long_term_keys();
+    test_legacy_migration();
+    std::cout << "All PairingStore tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "hap/pairing/SRPVerifierCache.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace hap;
+using namespace hap::pairing;
+
+// Counts the expensive SRP steps; the "verifier" is just the password bytes
+class CountingSRP : public platform::CryptoSRP {
+public:
+    bool supports_restore = true;
+    int verifiers = 0;
+    int restores = 0;
+    int public_keys = 0;
+    uint8_t next_salt = 1;
+
+    void sha512(std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
+    void hkdf_sha512(std::span<const uint8_t>, std::span<const uint8_t>,
+                     std::span<const uint8_t>, std::span<uint8_t>) override {}
+    void ed25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 64>) override {}
+    void ed25519_sign(std::span<const uint8_t, 64>, std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
+    bool ed25519_verify(std::span<const uint8_t, 32>, std::span<const uint8_t>,
+                        std::span<const uint8_t, 64>) override { return true; }
+    void x25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 32>) override {}
+    void x25519_shared_secret(std::span<const uint8_t, 32>, std::span<const uint8_t, 32>,
+                              std::span<uint8_t, 32>) override {}
+    bool chacha20_poly1305_encrypt_and_tag(std::span<const uint8_t, 32>, std::span<const uint8_t, 12>,
+                                           std::span<const uint8_t>, std::span<const uint8_t>,
+                                           std::span<uint8_t>, std::span<uint8_t, 16>) override { return true; }
+    bool chacha20_poly1305_decrypt_and_verify(std::span<const uint8_t, 32>, std::span<const uint8_t, 12>,
+                                              std::span<const uint8_t>, std::span<const uint8_t>,
+                                              std::span<const uint8_t, 16>, std::span<uint8_t>) override { return true; }
+
+    std::unique_ptr<platform::SRPSession> srp_new_verifier(std::string_view username, std::string_view password) override {
+        ++verifiers;
+        std::array<uint8_t, 16> salt;
+        salt.fill(next_salt++);
+        return std::make_unique<platform::SRPSession>(salt, std::vector<uint8_t>(password.begin(), password.end()),
+                                                      std::string(username), std::string(password));
+    }
+    std::unique_ptr<platform::SRPSession> srp_restore_verifier(std::string_view username, std::string_view password,
+                                                               std::span<const uint8_t, 16> salt,
+                                                               std::span<const uint8_t> verifier) override {
+        if (!supports_restore) return nullptr;
+        ++restores;
+        std::array<uint8_t, 16> salt_array;
+        std::copy(salt.begin(), salt.end(), salt_array.begin());
+        return std::make_unique<platform::SRPSession>(salt_array, std::vector<uint8_t>(verifier.begin(), verifier.end()),
+                                                      std::string(username), std::string(password));
+    }
+    std::array<uint8_t, 16> srp_get_salt(platform::SRPSession* session) override { return session->salt; }
+    std::vector<uint8_t> srp_get_public_key(platform::SRPSession*) override {
+        ++public_keys;
+        return std::vector<uint8_t>(384, 0xB0);
+    }
+    bool srp_set_client_public_key(platform::SRPSession*, std::span<const uint8_t>) override { return true; }
+    bool srp_verify_client_proof(platform::SRPSession*, std::span<const uint8_t>) override { return true; }
+    std::vector<uint8_t> srp_get_server_proof(platform::SRPSession*) override { return {}; }
+    std::vector<uint8_t> srp_get_session_key(platform::SRPSession*) override { return {}; }
+};
+
+void test_prepared_session() {
+    CountingSRP crypto;
+    mock::MockStorage storage;
+    SRPVerifierCache cache(&crypto, &storage, "123-45-678");
+    assert(!cache.ready());
+
+    cache.prepare();
+    cache.prepare();
+    assert(cache.ready());
+    assert(crypto.verifiers == 1 && crypto.public_keys == 1);
+
+    // M1 only hands the prepared session out
+    auto session = cache.take_session();
+    assert(session && session->server_public_key.size() == 384);
+    assert(crypto.verifiers == 1 && crypto.public_keys == 1);
+    assert(!cache.ready());
+
+    // Later sessions reuse the verifier
+    auto next = cache.take_session();
+    assert(next && next->server_public_key.empty());
+    assert(next->salt == session->salt);
+    assert(crypto.verifiers == 1 && crypto.restores == 1);
+
+    std::cout << "test_prepared_session passed" << std::endl;
+}
+
+void test_nothing_persisted() {
+    CountingSRP crypto;
+    mock::MockStorage storage;
+    storage.set("srp_verifier", std::vector<uint8_t>{1, 2, 3});  // Left behind by an older version
+    std::array<uint8_t, 16> salt;
+    {
+        SRPVerifierCache cache(&crypto, &storage, "123-45-678");
+        assert(!storage.has("srp_verifier"));
+        salt = cache.take_session()->salt;
+    }
+    assert(storage.size() == 0);
+
+    // A reboot derives a fresh verifier for whatever code is configured
+    SRPVerifierCache rebooted(&crypto, &storage, "876-54-321");
+    auto session = rebooted.take_session();
+    assert(session->salt != salt);
+    assert(session->verifier == std::vector<uint8_t>({'8', '7', '6', '-', '5', '4', '-', '3', '2', '1'}));
+    assert(crypto.verifiers == 2);
+    assert(storage.size() == 0);
+
+    std::cout << "test_nothing_persisted passed" << std::endl;
+}
+
+void test_without_restore() {
+    CountingSRP crypto;
+    crypto.supports_restore = false;
+    mock::MockStorage storage;
+    SRPVerifierCache cache(&crypto, &storage, "123-45-678");
+
+    cache.prepare();
+    assert(cache.take_session()->server_public_key.size() == 384);
+    assert(cache.take_session());
+    assert(crypto.verifiers == 2);
+
+    std::cout << "test_without_restore passed" << std::endl;
+}
+
+int main() {
+    test_prepared_session();
+    test_nothing_persisted();
+    test_without_restore();
+    std::cout << "All SRPVerifierCache tests passed!" << std::endl;
+    return 0;
+}
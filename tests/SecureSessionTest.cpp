@@ -0,0 +1,291 @@
+#include "hap/transport/SecureSession.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace hap;
+using namespace hap::transport;
+
+// Toy AEAD: XOR with the first key byte, tag = nonce counter byte + AAD length.
+// Enough to exercise framing, nonces and authentication failures.
+class XorCrypto : public platform::Crypto {
+public:
+    int encrypt_batches = 0;
+    int decrypt_batches = 0;
+
+    void sha512(std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
+    void hkdf_sha512(std::span<const uint8_t>, std::span<const uint8_t>,
+                     std::span<const uint8_t>, std::span<uint8_t>) override {}
+    void ed25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 64>) override {}
+    void ed25519_sign(std::span<const uint8_t, 64>, std::span<const uint8_t>,
+                      std::span<uint8_t, 64>) override {}
+    bool ed25519_verify(std::span<const uint8_t, 32>, std::span<const uint8_t>,
+                        std::span<const uint8_t, 64>) override { return true; }
+    void x25519_generate_keypair(std::span<uint8_t, 32>, std::span<uint8_t, 32>) override {}
+    void x25519_shared_secret(std::span<const uint8_t, 32>, std::span<const uint8_t, 32>,
+                              std::span<uint8_t, 32>) override {}
+
+    bool chacha20_poly1305_encrypt_and_tag(std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+                                           std::span<const uint8_t> aad, std::span<const uint8_t> plaintext,
+                                           std::span<uint8_t> ciphertext, std::span<uint8_t, 16> tag) override {
+        for (size_t i = 0; i < plaintext.size(); ++i) ciphertext[i] = plaintext[i] ^ key[0];
+        std::fill(tag.begin(), tag.end(), static_cast<uint8_t>(nonce[4] + aad.size()));
+        return true;
+    }
+
+    bool chacha20_poly1305_decrypt_and_verify(std::span<const uint8_t, 32> key, std::span<const uint8_t, 12> nonce,
+                                              std::span<const uint8_t> aad, std::span<const uint8_t> ciphertext,
+                                              std::span<const uint8_t, 16> tag, std::span<uint8_t> plaintext) override {
+        uint8_t expected = static_cast<uint8_t>(nonce[4] + aad.size());
+        if (!std::all_of(tag.begin(), tag.end(), [&](uint8_t t) { return t == expected; })) return false;
+        for (size_t i = 0; i < ciphertext.size(); ++i) plaintext[i] = ciphertext[i] ^ key[0];
+        return true;
+    }
+
+    bool chacha20_poly1305_encrypt_batch(std::span<const uint8_t, 32> key, std::span<const AeadSealFrame> frames) override {
+        ++encrypt_batches;
+        return Crypto::chacha20_poly1305_encrypt_batch(key, frames);
+    }
+    bool chacha20_poly1305_decrypt_batch(std::span<const uint8_t, 32> key, std::span<const AeadOpenFrame> frames) override {
+        ++decrypt_batches;
+        return Crypto::chacha20_poly1305_decrypt_batch(key, frames);
+    }
+};
+
+static std::array<uint8_t, 32> key_of(uint8_t b) {
+    std::array<uint8_t, 32> k{};
+    k.fill(b);
+    return k;
+}
+
+// Accessory (a2c) side and controller (c2a) side share keys crosswise
+struct Pair {
+    XorCrypto crypto;
+    SecureSession accessory{&crypto, key_of(0x11), key_of(0x22)};
+    SecureSession controller{&crypto, key_of(0x22), key_of(0x11)};
+};
+
+static std::vector<uint8_t> bytes(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+void test_split_frame() {
+    Pair p;
+    auto frame = p.controller.encrypt_frame(bytes("GET /accessories"));
+
+    std::vector<uint8_t> out;
+    std::span<const uint8_t> f(frame);
+    assert(p.accessory.decrypt_frame_into(f.first(1), out) == 0u);
+    assert(p.accessory.decrypt_frame_into(f.subspan(1, 10), out) == 0u);
+    assert(p.accessory.decrypt_frame_into(f.subspan(11), out) == 16u);
+    assert(std::string(out.begin(), out.end()) == "GET /accessories");
+
+    std::cout << "test_split_frame passed" << std::endl;
+}
+
+void test_surplus_is_kept() {
+    Pair p;
+    auto a = p.controller.encrypt_frame(bytes("first"));
+    auto b = p.controller.encrypt_frame(bytes("second"));
+    std::vector<uint8_t> both = a;
+    both.insert(both.end(), b.begin(), b.end());
+
+    std::vector<uint8_t> out;
+    assert(p.accessory.decrypt_frame_into(both, out) == 5u);
+    // Second frame was retained for the next call
+    assert(p.accessory.decrypt_frame_into({}, out) == 6u);
+    assert(std::string(out.begin(), out.end()) == "firstsecond");
+
+    std::cout << "test_surplus_is_kept passed" << std::endl;
+}
+
+void test_drain_all_frames() {
+    Pair p;
+    std::vector<uint8_t> segment;
+    for (const char* part : {"alpha", "beta", "gamma"}) {
+        auto f = p.controller.encrypt_frame(bytes(part));
+        segment.insert(segment.end(), f.begin(), f.end());
+    }
+    // Trailing partial frame stays buffered
+    auto partial = p.controller.encrypt_frame(bytes("delta"));
+    segment.insert(segment.end(), partial.begin(), partial.begin() + 3);
+
+    std::vector<uint8_t> out;
+    assert(p.accessory.decrypt_all_frames_into(segment, out) == 14u);
+    assert(std::string(out.begin(), out.end()) == "alphabetagamma");
+
+    std::span<const uint8_t> rest(partial);
+    assert(p.accessory.decrypt_all_frames_into(rest.subspan(3), out) == 5u);
+    assert(std::string(out.begin(), out.end()) == "alphabetagammadelta");
+
+    std::cout << "test_drain_all_frames passed" << std::endl;
+}
+
+void test_auth_failure() {
+    Pair p;
+    auto frame = p.controller.encrypt_frame(bytes("tampered"));
+    frame.back() ^= 0xFF;
+
+    std::vector<uint8_t> out;
+    assert(!p.accessory.decrypt_frame_into(frame, out).has_value());
+    assert(out.empty());
+
+    std::cout << "test_auth_failure passed" << std::endl;
+}
+
+void test_encrypt_frames_into() {
+    Pair p;
+    std::string response(2500, 'x');
+    response[0] = 'H';
+    response.back() = '}';
+
+    std::vector<uint8_t> sealed = {0xAA};  // Existing bytes are preserved
+    assert(p.accessory.encrypt_frames_into(bytes(response), sealed));
+    assert(sealed.size() == 1 + SecureSession::sealed_size(response.size()));
+    assert(sealed.size() == 1 + response.size() + 3 * 18);
+    assert(sealed[0] == 0xAA);
+
+    // First frame carries a full 1024-byte payload
+    assert(sealed[1] == 0x00 && sealed[2] == 0x04);
+
+    std::vector<uint8_t> out;
+    auto appended = p.controller.decrypt_all_frames_into(std::span<const uint8_t>(sealed).subspan(1), out);
+    assert(appended.has_value() && *appended == response.size());
+    assert(std::string(out.begin(), out.end()) == response);
+
+    // Nonces keep counting across calls
+    std::vector<uint8_t> next;
+    assert(p.accessory.encrypt_frames_into(bytes("next"), next));
+    out.clear();
+    assert(p.controller.decrypt_frame_into(next, out) == 4u);
+
+    std::cout << "test_encrypt_frames_into passed" << std::endl;
+}
+
+void test_batched_frames() {
+    Pair p;
+    std::string response(SecureSession::BATCH_FRAMES * SecureSession::MAX_FRAME_PAYLOAD * 2 + 7, 'y');
+
+    // 17 frames go to the platform in three batches each way
+    std::vector<uint8_t> sealed;
+    assert(p.accessory.encrypt_frames_into(bytes(response), sealed));
+    assert(p.crypto.encrypt_batches == 3);
+
+    std::vector<uint8_t> out;
+    assert(p.controller.decrypt_all_frames_into(sealed, out) == response.size());
+    assert(p.crypto.decrypt_batches == 3);
+    assert(std::string(out.begin(), out.end()) == response);
+
+    // A bad tag in the second batch keeps the first batch's plaintext only
+    std::vector<uint8_t> again;
+    assert(p.accessory.encrypt_frames_into(bytes(response), again));
+    size_t frame_size = SecureSession::LENGTH_SIZE + SecureSession::MAX_FRAME_PAYLOAD + SecureSession::AUTH_TAG_SIZE;
+    again[frame_size * (SecureSession::BATCH_FRAMES + 1) - 1] ^= 0xFF;
+    out.clear();
+    assert(!p.controller.decrypt_all_frames_into(again, out));
+    assert(out.size() == SecureSession::BATCH_FRAMES * SecureSession::MAX_FRAME_PAYLOAD);
+
+    std::cout << "test_batched_frames passed" << std::endl;
+}
+
+void test_in_place() {
+    Pair p;
+
+    // HTTP: caller lays out <len><plaintext><tag> and gets the plaintext back in the same buffer
+    std::string body = "HTTP/1.1 204 No Content";
+    std::vector<uint8_t> frame(SecureSession::LENGTH_SIZE + body.size() + SecureSession::AUTH_TAG_SIZE);
+    std::copy(body.begin(), body.end(), frame.begin() + SecureSession::LENGTH_SIZE);
+    assert(p.accessory.encrypt_frame_in_place(frame));
+    assert(frame[0] == body.size() && frame[1] == 0);
+    assert(!std::equal(body.begin(), body.end(), frame.begin() + SecureSession::LENGTH_SIZE));
+
+    auto plaintext = p.controller.decrypt_frame_in_place(frame);
+    assert(plaintext && std::string(plaintext->begin(), plaintext->end()) == body);
+    assert(plaintext->data() == frame.data() + SecureSession::LENGTH_SIZE);
+
+    // Interoperates with the streaming decoder
+    std::vector<uint8_t> again(frame.size());
+    std::copy(body.begin(), body.end(), again.begin() + SecureSession::LENGTH_SIZE);
+    assert(p.accessory.encrypt_frame_in_place(again));
+    std::vector<uint8_t> out;
+    assert(p.controller.decrypt_frame_into(again, out) == body.size());
+
+    // Oversized or truncated frames are rejected before touching nonces
+    std::vector<uint8_t> oversized(SecureSession::MAX_FRAME_PAYLOAD + 1 + 18);
+    assert(!p.accessory.encrypt_frame_in_place(oversized));
+    assert(!p.controller.decrypt_frame_in_place(std::span<uint8_t>(again).first(10)));
+
+    // BLE: tag goes after the ciphertext, plaintext replaces it on the way back
+    std::vector<uint8_t> pdu = {0x02, 0x01, 0x07, 0x00, 0x00};
+    std::vector<uint8_t> original = pdu;
+    pdu.resize(pdu.size() + SecureSession::AUTH_TAG_SIZE);
+    assert(p.accessory.encrypt_ble_pdu_in_place(pdu, original.size()) == pdu.size());
+    assert(p.controller.decrypt_ble_pdu_in_place(pdu) == original.size());
+    assert(std::equal(original.begin(), original.end(), pdu.begin()));
+
+    // Vector wrappers stay compatible with the in-place forms
+    auto sealed = p.accessory.encrypt_ble_pdu(original);
+    assert(p.controller.decrypt_ble_pdu(sealed) == original);
+
+    std::cout << "test_in_place passed" << std::endl;
+}
+
+void test_head_and_body() {
+    // Sealing head and body separately must match sealing their concatenation
+    for (size_t head_size : {0u, 90u, 1024u, 1100u}) {
+        for (size_t body_size : {0u, 5u, 934u, 3000u}) {
+            Pair a, b;
+            std::string head(head_size, 'h');
+            std::string body(body_size, 'b');
+
+            std::vector<uint8_t> joined = {0xAA};
+            std::vector<uint8_t> split = {0xAA};
+            assert(a.accessory.encrypt_frames_into(bytes(head + body), joined));
+            assert(b.accessory.encrypt_frames_into(bytes(head), bytes(body), split));
+            assert(split == joined);
+        }
+    }
+
+    // A short response fits in one frame
+    Pair p;
+    std::vector<uint8_t> sealed;
+    assert(p.accessory.encrypt_frames_into(bytes("HTTP/1.1 200 OK\r\n\r\n"), bytes("{}"), sealed));
+    assert(sealed.size() == SecureSession::sealed_size(21));
+    std::vector<uint8_t> out;
+    assert(p.controller.decrypt_all_frames_into(sealed, out) == 21u);
+
+    std::cout << "test_head_and_body passed" << std::endl;
+}
+
+void test_oversized_frame() {
+    Pair p;
+    // A length prefix past MAX_FRAME_PAYLOAD is refused at once instead of buffered
+    std::vector<uint8_t> header = {0xFF, 0xFF, 0x00, 0x00};
+    std::vector<uint8_t> out;
+    assert(!p.controller.decrypt_all_frames_into(header, out));
+    assert(!p.controller.has_partial_frame());
+
+    // Partial frames of a valid size are still kept
+    std::vector<uint8_t> sealed;
+    assert(p.accessory.encrypt_frames_into(bytes("hello"), sealed));
+    assert(p.controller.decrypt_all_frames_into(std::span<const uint8_t>(sealed).first(4), out) == 0u);
+    assert(p.controller.has_partial_frame());
+    assert(p.controller.decrypt_all_frames_into(std::span<const uint8_t>(sealed).subspan(4), out) == 5u);
+    assert(!p.controller.has_partial_frame());
+
+    std::cout << "test_oversized_frame passed" << std::endl;
+}
+
+int main() {
+    test_split_frame();
+    test_surplus_is_kept();
+    test_drain_all_frames();
+    test_auth_failure();
+    test_encrypt_frames_into();
+    test_batched_frames();
+    test_in_place();
+    test_head_and_body();
+    test_oversized_frame();
+    return 0;
+}
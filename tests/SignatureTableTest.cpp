@@ -0,0 +1,55 @@
+#include "hap/transport/ble/SignatureTable.hpp"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+using namespace hap::transport::ble;
+
+void test_lookup() {
+    SignatureTable table;
+    std::vector<uint8_t> a = {1, 2, 3};
+    std::vector<uint8_t> b = {4, 5};
+    table.add(20, b);
+    table.add(10, a);
+    table.add(30, {});
+    table.seal();
+
+    assert(table.size() == 3);
+    auto found_a = table.find(10);
+    assert(found_a && std::vector<uint8_t>(found_a->begin(), found_a->end()) == a);
+    auto found_b = table.find(20);
+    assert(found_b && std::vector<uint8_t>(found_b->begin(), found_b->end()) == b);
+    auto found_empty = table.find(30);
+    assert(found_empty && found_empty->empty());
+    assert(!table.find(15).has_value());
+    assert(!table.find(40).has_value());
+
+    std::cout << "test_lookup passed" << std::endl;
+}
+
+void test_first_duplicate_wins() {
+    SignatureTable table;
+    std::vector<uint8_t> first = {0xAA};
+    std::vector<uint8_t> second = {0xBB, 0xBB};
+    table.add(7, first);
+    table.add(3, second);
+    table.add(7, second);
+    table.seal();
+
+    assert(table.size() == 2);
+    auto found = table.find(7);
+    assert(found && found->size() == 1 && (*found)[0] == 0xAA);
+
+    table.clear();
+    table.seal();
+    assert(table.size() == 0);
+    assert(!table.find(7).has_value());
+
+    std::cout << "test_first_duplicate_wins passed" << std::endl;
+}
+
+int main() {
+    test_lookup();
+    test_first_duplicate_wins();
+    return 0;
+}
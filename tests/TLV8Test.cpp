@@ -3,6 +3,7 @@
 #include <iostream>
 #include <vector>
 #include <numeric>
+#include <algorithm>
 
 using namespace hap::core;
 
@@ -70,9 +71,102 @@ void test_helpers() {
     std::cout << "test_helpers passed" << std::endl;
 }
 
+void test_view_points_into_input() {
+    std::vector<TLV> input;
+    input.emplace_back(1, uint8_t(7));
+    input.emplace_back(2, "Hello");
+    auto encoded = TLV8::encode(input);
+
+    TLV8View view(encoded);
+    assert(view.find_uint8(1) == 7);
+    assert(view.find_string(2) == "Hello");
+    assert(!view.find(3).has_value());
+
+    // Unfragmented values are not copied
+    auto value = view.find(2);
+    assert(value && value->data() == encoded.data() + 3 + 2);
+
+    size_t items = 0;
+    for (auto item : view) {
+        assert(item.type == input[items].type);
+        assert(std::equal(item.value.begin(), item.value.end(), input[items].value.begin(), input[items].value.end()));
+        ++items;
+    }
+    assert(items == 2);
+
+    std::cout << "test_view_points_into_input passed" << std::endl;
+}
+
+void test_view_fragmentation() {
+    std::vector<uint8_t> large_data(600);
+    std::iota(large_data.begin(), large_data.end(), 0);
+
+    std::vector<TLV> input;
+    input.emplace_back(10, large_data);
+    input.emplace_back(11, uint8_t(1));
+    auto encoded = TLV8::encode(input);
+
+    TLV8View view(encoded);
+    auto value = view.find(10);
+    assert(value && value->size() == 600);
+    assert(std::equal(value->begin(), value->end(), large_data.begin()));
+    assert(view.find_uint8(11) == 1);
+
+    size_t items = 0;
+    for (auto item : view) {
+        (void)item;
+        ++items;
+    }
+    assert(items == 2);
+
+    std::cout << "test_view_fragmentation passed" << std::endl;
+}
+
+void test_view_truncated_input() {
+    // Second item claims 5 bytes but only 2 follow
+    std::vector<uint8_t> encoded = {1, 1, 0x2A, 2, 5, 'a', 'b'};
+
+    TLV8View view(encoded);
+    auto parsed = TLV8::parse(encoded);
+    assert(parsed.size() == 1);
+    assert(view.find_uint8(1) == 42);
+    assert(!view.find(2).has_value());
+
+    std::cout << "test_view_truncated_input passed" << std::endl;
+}
+
+void test_writer() {
+    std::vector<uint8_t> large_data(300, 0xAB);
+    std::vector<uint8_t> out;
+    out.reserve(TLV8Writer::encoded_size(1) + TLV8Writer::encoded_size(0) + TLV8Writer::encoded_size(large_data.size()));
+    const auto* start = out.data();
+
+    TLV8Writer(out)
+        .add(6, uint8_t(2))
+        .add(0xFF, std::span<const uint8_t>{})
+        .add(5, large_data);
+
+    assert(out.data() == start);
+    assert(out.size() == 3 + 2 + (2 + 255) + (2 + 45));
+    assert(TLV8Writer::encoded_size(255) == 257);
+    assert(TLV8Writer::encoded_size(256) == 260);
+
+    auto decoded = TLV8::parse(out);
+    assert(decoded.size() == 3);
+    assert(decoded[0].type == 6 && decoded[0].value == std::vector<uint8_t>{2});
+    assert(decoded[1].type == 0xFF && decoded[1].value.empty());
+    assert(decoded[2].type == 5 && decoded[2].value == large_data);
+
+    std::cout << "test_writer passed" << std::endl;
+}
+
 int main() {
     test_simple_encode_decode();
     test_fragmentation();
     test_helpers();
+    test_view_points_into_input();
+    test_view_fragmentation();
+    test_view_truncated_input();
+    test_writer();
     return 0;
 }
@@ -0,0 +1,91 @@
+#include "hap/common/TaskScheduler.hpp"
+#include "hap/mock/MockSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace hap;
+using namespace hap::common;
+
+void test_order_and_deadline() {
+    mock::MockSystem system;
+    TaskScheduler scheduler(&system);
+    std::vector<int> ran;
+
+    assert(!scheduler.next_deadline_ms().has_value());
+    scheduler.schedule_once(50, [&] { ran.push_back(3); });
+    scheduler.schedule_once(10, [&] { ran.push_back(1); });
+    scheduler.schedule_once(10, [&] { ran.push_back(2); });  // Same deadline: FIFO
+    assert(scheduler.task_count() == 3);
+    assert(scheduler.next_deadline_ms() == 10u);
+
+    scheduler.tick(9);
+    assert(ran.empty());
+    scheduler.tick(10);
+    assert((ran == std::vector<int>{1, 2}));
+    assert(scheduler.next_deadline_ms() == 50u);
+    scheduler.tick(100);
+    assert((ran == std::vector<int>{1, 2, 3}));
+    assert(scheduler.task_count() == 0);
+
+    std::cout << "test_order_and_deadline passed" << std::endl;
+}
+
+void test_cancel_and_periodic() {
+    mock::MockSystem system;
+    TaskScheduler scheduler(&system);
+    int periodic_runs = 0;
+    bool cancelled_ran = false;
+
+    auto periodic = scheduler.schedule_periodic(10, [&] { ++periodic_runs; });
+    auto once = scheduler.schedule_once(5, [&] { cancelled_ran = true; });
+    assert(scheduler.cancel(once));
+    assert(!scheduler.cancel(once));
+    assert(scheduler.next_deadline_ms() == 10u);  // Stale entry skipped
+
+    scheduler.tick(10);
+    scheduler.tick(20);
+    assert(periodic_runs == 2);
+    assert(!cancelled_ran);
+    assert(scheduler.next_deadline_ms() == 30u);
+
+    assert(scheduler.cancel(periodic));
+    scheduler.tick(30);
+    assert(periodic_runs == 2);
+    assert(!scheduler.next_deadline_ms().has_value());
+
+    std::cout << "test_cancel_and_periodic passed" << std::endl;
+}
+
+void test_schedule_from_callback() {
+    mock::MockSystem system;
+    TaskScheduler scheduler(&system);
+    int runs = 0;
+
+    // Work scheduled while ticking runs on the next tick, not the current one
+    scheduler.schedule_once(0, [&] {
+        ++runs;
+        scheduler.schedule_once(0, [&] { ++runs; });
+    });
+    scheduler.tick(0);
+    assert(runs == 1);
+    scheduler.tick(0);
+    assert(runs == 2);
+
+    // A periodic task can cancel itself
+    TaskScheduler::TaskId self = TaskScheduler::INVALID_TASK_ID;
+    self = scheduler.schedule_periodic(5, [&] { scheduler.cancel(self); });
+    scheduler.tick(5);
+    assert(scheduler.task_count() == 0);
+
+    std::cout << "test_schedule_from_callback passed" << std::endl;
+}
+
+int main() {
+    test_order_and_deadline();
+    test_cancel_and_periodic();
+    test_schedule_from_callback();
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "hap/transport/TimedWriteTable.hpp"
+#include <cassert>
+#include <iostream>
+
+using namespace hap::transport;
+
+void test_prepare_and_take() {
+    TimedWriteTable table;
+    table.prepare(1, 1000);
+    table.prepare(2, 2000, {0xAA, 0xBB});
+    assert(table.size() == 2);
+    assert(table.contains(1, 1000) && table.contains(2, 500));
+    assert(!table.contains(3, 0));
+
+    // Validation does not consume; take does
+    assert(table.contains(1, 10));
+    auto payload = table.take(2, 1500);
+    assert(payload && payload->size() == 2 && (*payload)[0] == 0xAA);
+    assert(!table.take(2, 1500));
+    assert(table.size() == 1);
+
+    // Re-preparing a key moves its deadline instead of adding an entry
+    table.prepare(1, 5000);
+    assert(table.size() == 1 && table.contains(1, 4000));
+
+    std::cout << "test_prepare_and_take passed" << std::endl;
+}
+
+void test_expiry() {
+    TimedWriteTable table;
+    table.prepare(1, 100);
+    table.prepare(2, 300, {1, 2, 3});
+    table.prepare(3, 200);
+    assert(table.next_expiry() == 100u);
+
+    // Expired entries are never handed out, even before expire() runs
+    assert(!table.contains(1, 101));
+    assert(!table.take(1, 101));
+    assert(table.size() == 2);
+
+    assert(table.expire(250) == 1);
+    assert(table.size() == 1 && table.next_expiry() == 300u);
+    assert(table.expire(301) == 1);
+    assert(table.size() == 0 && !table.next_expiry());
+
+    std::cout << "test_expiry passed" << std::endl;
+}
+
+void test_capacity() {
+    TimedWriteTable table;
+    for (uint64_t pid = 0; pid < TimedWriteTable::CAPACITY; ++pid) {
+        table.prepare(pid, 1000 + pid);
+    }
+    assert(table.size() == TimedWriteTable::CAPACITY);
+
+    // Full: the write closest to expiring makes room
+    table.prepare(100, 5000);
+    assert(table.size() == TimedWriteTable::CAPACITY);
+    assert(!table.contains(0, 0));
+    assert(table.contains(100, 0) && table.contains(1, 0));
+
+    table.clear();
+    assert(table.size() == 0 && !table.contains(100, 0));
+
+    std::cout << "test_capacity passed" << std::endl;
+}
+
+int main() {
+    test_prepare_and_take();
+    test_expiry();
+    test_capacity();
+    return 0;
+}
@@ -2,12 +2,17 @@
 #include "hap/HAP.hpp"
 #include "hap/core/Characteristic.hpp"
 #include "hap/core/Service.hpp"
+#include "hap/mock/MockNetwork.hpp"
+#include "hap/mock/MockStorage.hpp"
+#include "hap/mock/MockSystem.hpp"
 #include "hap/platform/CryptoSRP.hpp"
 
+#include <cassert>
 #include <iostream>
+#include <string>
 #include <vector>
 
-// Dummy implementations for verification
+// Dummy crypto for verification; the rest of the platform is hap/mock
 class DummyCrypto : public hap::platform::CryptoSRP {
 public:
   void sha512(std::span<const uint8_t>, std::span<uint8_t, 64>) override {}
@@ -73,39 +78,11 @@ public:
   }
 };
 
-class DummyNetwork : public hap::platform::Network {
-public:
-  void mdns_register(const MdnsService &) override {}
-  void mdns_update_txt_record(const MdnsService &) override {}
-  void tcp_listen(uint16_t, ReceiveCallback, DisconnectCallback) override {}
-  void tcp_send(ConnectionId, std::span<const uint8_t>) override {}
-  void tcp_disconnect(ConnectionId) override {}
-};
-
-class DummyStorage : public hap::platform::Storage {
-public:
-  void set(std::string_view, std::span<const uint8_t>) override {}
-  std::optional<std::vector<uint8_t>> get(std::string_view) override {
-    return std::nullopt;
-  }
-  void remove(std::string_view) override {}
-  bool has(std::string_view) override { return false; }
-};
-
-class DummySystem : public hap::platform::System {
-public:
-  uint64_t millis() override { return 0; }
-  void random_bytes(std::span<uint8_t>) override {}
-  void log(LogLevel, std::string_view msg) override {
-    std::cout << "[LOG] " << msg << std::endl;
-  }
-};
-
 int main() {
   DummyCrypto crypto;
-  DummyNetwork network;
-  DummyStorage storage;
-  DummySystem system;
+  hap::mock::MockNetwork network;
+  hap::mock::MockStorage storage;
+  hap::mock::MockSystem system;
 
   hap::AccessoryServer::Config config;
   config.crypto = &crypto;
@@ -116,6 +93,7 @@ int main() {
   config.setup_code = "123-45-678";
   config.device_name = "Test Lightbulb";
   config.port = 8080;
+  config.enable_metrics = true;
 
   hap::AccessoryServer server(config);
 
@@ -134,6 +112,60 @@ int main() {
   server.add_accessory(acc);
 
   server.start();
+  assert(network.mdns_registrations() == 1);
+
+  // Two structure changes in a burst bump c# twice but publish once
+  server.add_accessory(std::make_shared<hap::core::Accessory>(2));
+  server.add_accessory(std::make_shared<hap::core::Accessory>(3));
+  server.tick();
+  assert(network.mdns_updates() == 0);
+  system.advance(1000);
+  server.tick();
+  assert(network.mdns_registrations() == 1 && network.mdns_updates() == 1);
+
+  // Nothing changed since: no republish
+  system.advance(1000);
+  server.tick();
+  assert(network.mdns_updates() == 1);
+
+  // Plaintext Pair Verify is answered without the router: TLV8 straight after a fixed head
+  std::vector<uint8_t> m1 = {0x06, 0x01, 0x01, 0x03, 0x20};
+  m1.resize(m1.size() + 32, 0x11);
+  std::string request = "POST /pair-verify HTTP/1.1\r\nHost: test\r\n"
+                        "Content-Type: application/pairing+tlv8\r\nContent-Length: " +
+                        std::to_string(m1.size()) + "\r\n\r\n";
+  request.append(m1.begin(), m1.end());
+  network.deliver(1, request);
+  auto sent = network.take_sent(1);
+  std::string response(sent.begin(), sent.end());
+  assert(response.rfind("HTTP/1.1 200 OK\r\nContent-Type: application/pairing+tlv8\r\n", 0) == 0);
+  assert(server.metrics()[hap::common::Counter::PairingFastPath] == 1);
+
+  auto diagnostics = server.diagnostics();
+  assert(diagnostics.connections.size() == 1);
+  assert(diagnostics.connections[0].bytes_received == request.size());
+  assert(diagnostics.connections[0].outbound.sent_bytes == network.sent_bytes(1));
+  assert(diagnostics.connections[0].outbound.sealed_frames == 0);
+  assert(diagnostics.connections[0].subscriptions == 0);
+  assert(!diagnostics.min_free_heap);
+
+  // A peer that stops reading is retried with a doubling backoff, not on every tick
+  network.set_writable(1, false);
+  network.deliver(1, request);
+  assert(network.take_sent(1).empty());
+  assert(server.next_deadline_ms() == system.millis());
+  server.tick();
+  uint64_t first = *server.next_deadline_ms() - system.millis();
+  assert(first > 0);
+  system.advance(first);
+  server.tick();
+  uint64_t second = *server.next_deadline_ms() - system.millis();
+  assert(second == 2 * first);
+  network.set_writable(1, true);
+  system.advance(second);
+  server.tick();
+  assert(!network.take_sent(1).empty());
+
   server.stop();
 
   std::cout << "Architecture verification successful!" << std::endl;
@@ -0,0 +1,90 @@
+#include "hap/common/WorkQueue.hpp"
+#include "hap/core/Characteristic.hpp"
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace hap;
+using namespace hap::common;
+
+void test_inline_storage() {
+    // The closure Characteristic::set_value dispatches must fit inline
+    auto cb = std::make_shared<const core::Characteristic::EventCallback>();
+    core::Value value = std::string("hello");
+    core::EventSource source;
+    WorkQueue::Task task([cb, value, source]() {});
+    assert(task.is_inline());
+
+    std::array<uint8_t, 256> big{};
+    WorkQueue::Task heap_task([big]() { (void)big; });
+    assert(heap_task && !heap_task.is_inline());
+
+    WorkQueue::Task moved(std::move(heap_task));
+    assert(moved && !heap_task);
+
+    std::cout << "test_inline_storage passed" << std::endl;
+}
+
+void test_fifo_and_full() {
+    WorkQueue queue(4);
+    assert(queue.capacity() == 4);
+    std::vector<int> ran;
+
+    for (int i = 0; i < 4; ++i) {
+        assert(queue.try_push(WorkQueue::Task([&ran, i]() { ran.push_back(i); })));
+    }
+    WorkQueue::Task overflow([&ran]() { ran.push_back(99); });
+    assert(!queue.try_push(std::move(overflow)));
+    assert(overflow);  // Left intact for the fallback path
+
+    assert(queue.drain() == 4);
+    assert((ran == std::vector<int>{0, 1, 2, 3}));
+    assert(queue.empty());
+
+    // Slots are reused after draining
+    assert(queue.try_push(std::move(overflow)));
+    assert(queue.drain() == 1);
+    assert(ran.back() == 99);
+
+    std::cout << "test_fifo_and_full passed" << std::endl;
+}
+
+void test_multi_producer() {
+    WorkQueue queue(1024);
+    std::atomic<int> sum{0};
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 200;
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&queue, &sum]() {
+            for (int i = 0; i < kPerThread; ++i) {
+                while (!queue.try_push(WorkQueue::Task([&sum]() { sum.fetch_add(1); }))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    size_t executed = 0;
+    while (executed < kThreads * kPerThread) {
+        executed += queue.drain();
+    }
+    for (auto& producer : producers) producer.join();
+
+    assert(sum.load() == kThreads * kPerThread);
+    assert(queue.empty());
+
+    std::cout << "test_multi_producer passed" << std::endl;
+}
+
+int main() {
+    test_inline_storage();
+    test_fifo_and_full();
+    test_multi_producer();
+    return 0;
+}